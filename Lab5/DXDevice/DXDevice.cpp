@@ -1,7 +1,9 @@
 #include "DXDevice.h"
+#include "../Engine/Profiling/StartupTimeline.h"
 
 
 DXDevice::DXDevice() {
+	StartupPhase phase("Create device");
 	UINT creationFlags = 0;
 	#if defined(_DEBUG)
 		creationFlags = D3D11_CREATE_DEVICE_DEBUG;
@@ -36,6 +38,8 @@ DXDevice::DXDevice() {
 	if (!found) {
 		throw std::runtime_error("Failed to find suitable device");
 	}
+	stateContext = new DXStateContext(deviceContext);
+	graphicsDevice = new DXGraphicsDevice(device, stateContext);
 	initializeDxgi();
 }
 
@@ -86,21 +90,31 @@ void DXDevice::initializeDxgi() {
 ID3D11RenderTargetView* unBindRtvs[5] = {0, 0, 0, 0, 0};
 ID3D11ShaderResourceView* unBindresourceViews[5] = {0, 0, 0, 0, 0};
 
-void DXDevice::unBindRenderTargets(ID3D11DeviceContext* context)
+void DXDevice::unBindRenderTargets(DXStateContext* context)
 {
-	context->OMSetRenderTargets(5, unBindRtvs, NULL);
-	context->PSSetShaderResources(0, 5, unBindresourceViews);
+	context->setRenderTargets(5, unBindRtvs, NULL);
+	context->setPixelShaderResources(0, 5, unBindresourceViews);
 }
 
 ID3D11DeviceContext* DXDevice::getDeviceContext() {
 	return deviceContext;
 }
 
+DXStateContext* DXDevice::getStateContext() {
+	return stateContext;
+}
+
+GraphicsDevice* DXDevice::getGraphicsDevice() {
+	return graphicsDevice;
+}
+
 
 DXDevice::~DXDevice() {
 	dxgiDevice->Release();
 	dxgiAdapter->Release();
 	dxgiFactory->Release();
+	delete graphicsDevice;
+	delete stateContext;
 	deviceContext->Flush();
 	deviceContext->Release();
 	device->Release();
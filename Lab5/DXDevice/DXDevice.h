@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <stdexcept>
 #include "DXSwapChain.h"
+#include "DXStateContext.h"
+#include "DXGraphicsDevice.h"
 #include "../Window/Window.h"
 #include <map>
 
@@ -15,6 +17,8 @@ private:
 	ID3D11Device* device = nullptr;
 	D3D_FEATURE_LEVEL featureLevel;
 	ID3D11DeviceContext* deviceContext = nullptr;
+	DXStateContext* stateContext = nullptr;
+	DXGraphicsDevice* graphicsDevice = nullptr;
 	IDXGIDevice* dxgiDevice = nullptr;
 	IDXGIAdapter* dxgiAdapter = nullptr;
 	IDXGIFactory* dxgiFactory = nullptr;
@@ -22,8 +26,16 @@ private:
 public:
 	DXSwapChain* getSwapChain(Window* window, const char* possibleName = nullptr);
 	ID3D11DeviceContext* getDeviceContext();
+	/*
+	 * Immediate context with redundant state filtering, bindings go through it
+	 */
+	DXStateContext* getStateContext();
+	/*
+	 * The device behind the GraphicsDevice interface, for code that also runs on other backends
+	 */
+	GraphicsDevice* getGraphicsDevice();
 	ID3D11Device* getDevice();
-	static void unBindRenderTargets(ID3D11DeviceContext* context);
+	static void unBindRenderTargets(DXStateContext* context);
 private:
 	DXSwapChain* createSwapChain(Window* window, const char* possibleName = nullptr);
 	void initializeDxgi();
@@ -0,0 +1,139 @@
+#include "DXGraphicsDevice.h"
+#include <cstring>
+#include <stdexcept>
+#include "DXResourceTracking.h"
+
+namespace
+{
+    /*
+     * The buffer classes create their buffers through the device, the bind flags tell which one did
+     */
+    const char* getBufferOwner(uint32_t bindFlags)
+    {
+        if (bindFlags & GRAPHICS_BIND_CONSTANT_BUFFER)
+        {
+            return "Constant buffers";
+        }
+        if (bindFlags & GRAPHICS_BIND_VERTEX_BUFFER)
+        {
+            return "Vertex buffers";
+        }
+        if (bindFlags & GRAPHICS_BIND_INDEX_BUFFER)
+        {
+            return "Index buffers";
+        }
+        return "Structured buffers";
+    }
+}
+
+DXGraphicsDevice::DXGraphicsDevice(ID3D11Device* device, DXStateContext* immediateContext) : device(device),
+    immediateContext(immediateContext)
+{
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+    {
+        capabilities.constantBufferOffsets = options.ConstantBufferOffsetting;
+        capabilities.constantBufferPartialUpdates = options.ConstantBufferPartialUpdate;
+        capabilities.constantBufferNoOverwrite = options.MapNoOverwriteOnDynamicConstantBuffer;
+    }
+}
+
+const GraphicsCapabilities& DXGraphicsDevice::getCapabilities() const
+{
+    return capabilities;
+}
+
+GraphicsBuffer DXGraphicsDevice::createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                              const char* bufferName)
+{
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = desc.dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+    bufferDesc.ByteWidth = desc.size;
+    bufferDesc.CPUAccessFlags = desc.dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
+    if (desc.bindFlags & GRAPHICS_BIND_VERTEX_BUFFER)
+    {
+        bufferDesc.BindFlags |= D3D11_BIND_VERTEX_BUFFER;
+    }
+    if (desc.bindFlags & GRAPHICS_BIND_INDEX_BUFFER)
+    {
+        bufferDesc.BindFlags |= D3D11_BIND_INDEX_BUFFER;
+    }
+    if (desc.bindFlags & GRAPHICS_BIND_CONSTANT_BUFFER)
+    {
+        bufferDesc.BindFlags |= D3D11_BIND_CONSTANT_BUFFER;
+    }
+    if (desc.bindFlags & GRAPHICS_BIND_SHADER_RESOURCE)
+    {
+        bufferDesc.BindFlags |= D3D11_BIND_SHADER_RESOURCE;
+        bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        bufferDesc.StructureByteStride = desc.stride;
+    }
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = pInitData;
+    ID3D11Buffer* buffer = nullptr;
+    if (FAILED(device->CreateBuffer(&bufferDesc, pInitData ? &initData : nullptr, &buffer)))
+    {
+        throw std::runtime_error("Failed to create buffer");
+    }
+
+    trackBuffer(buffer, bufferName, getBufferOwner(desc.bindFlags));
+    GraphicsBuffer result;
+    result.buffer = buffer;
+    result.size = desc.size;
+    if (desc.bindFlags & GRAPHICS_BIND_SHADER_RESOURCE)
+    {
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+        srvDesc.Buffer.FirstElement = 0;
+        srvDesc.Buffer.NumElements = desc.size / desc.stride;
+        ID3D11ShaderResourceView* view = nullptr;
+        if (FAILED(device->CreateShaderResourceView(buffer, &srvDesc, &view)))
+        {
+            releaseTracked(buffer);
+            throw std::runtime_error("Failed to create buffer view");
+        }
+        trackView(view, bufferName, getBufferOwner(desc.bindFlags));
+        result.shaderResourceView = view;
+    }
+#if defined(_DEBUG)
+    if (bufferName)
+    {
+        buffer->SetPrivateData(WKPDID_D3DDebugObjectName, strlen(bufferName) * sizeof(char), bufferName);
+    }
+#endif
+    return result;
+}
+
+void DXGraphicsDevice::releaseBuffer(GraphicsBuffer& buffer)
+{
+    releaseTracked((ID3D11ShaderResourceView*)buffer.shaderResourceView);
+    releaseTracked((ID3D11Buffer*)buffer.buffer);
+    buffer = GraphicsBuffer();
+}
+
+StateHandle DXGraphicsDevice::createFence()
+{
+    D3D11_QUERY_DESC queryDesc = {};
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    ID3D11Query* query = nullptr;
+    if (FAILED(device->CreateQuery(&queryDesc, &query)))
+    {
+        throw std::runtime_error("Failed to create fence query");
+    }
+    return query;
+}
+
+void DXGraphicsDevice::releaseFence(StateHandle fence)
+{
+    if (fence)
+    {
+        ((ID3D11Query*)fence)->Release();
+    }
+}
+
+GraphicsContext* DXGraphicsDevice::getImmediateContext()
+{
+    return immediateContext;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <d3d11.h>
+#include "DXStateContext.h"
+#include "../Engine/Device/GraphicsDevice.h"
+
+/*
+ * D3D11 GraphicsDevice, buffers and fences are native objects and the immediate context is the one of the device
+ */
+class DXGraphicsDevice : public GraphicsDevice
+{
+public:
+    DXGraphicsDevice(ID3D11Device* device, DXStateContext* immediateContext);
+
+private:
+    ID3D11Device* device;
+    DXStateContext* immediateContext;
+    GraphicsCapabilities capabilities;
+
+public:
+    const GraphicsCapabilities& getCapabilities() const override;
+    GraphicsBuffer createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                const char* bufferName = nullptr) override;
+    void releaseBuffer(GraphicsBuffer& buffer) override;
+    StateHandle createFence() override;
+    void releaseFence(StateHandle fence) override;
+    GraphicsContext* getImmediateContext() override;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <d3d11_1.h>
+#include "../Utils/Profiler.h"
+
+/*
+ * Forwards profiler zones as events of a device context, PIX, RenderDoc and the Visual Studio graphics debugger show
+ * them around the calls made inside the zone. Does nothing when the context has no annotation interface.
+ */
+class DXProfilerAnnotation : public IProfilerAnnotation
+{
+public:
+    explicit DXProfilerAnnotation(ID3D11DeviceContext* context)
+    {
+        if (FAILED(context->QueryInterface(IID_PPV_ARGS(&annotation))))
+        {
+            annotation = nullptr;
+        }
+    }
+
+    DXProfilerAnnotation(const DXProfilerAnnotation&) = delete;
+    DXProfilerAnnotation& operator=(const DXProfilerAnnotation&) = delete;
+
+private:
+    ID3DUserDefinedAnnotation* annotation = nullptr;
+
+public:
+    void beginEvent(const ProfileZoneDesc* zone) override
+    {
+        if (annotation)
+        {
+            annotation->BeginEvent(zone->wideName);
+        }
+    }
+
+    void endEvent() override
+    {
+        if (annotation)
+        {
+            annotation->EndEvent();
+        }
+    }
+
+    ~DXProfilerAnnotation()
+    {
+        if (annotation)
+        {
+            annotation->Release();
+        }
+    }
+};
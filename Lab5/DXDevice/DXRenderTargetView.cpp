@@ -1,6 +1,9 @@
 #include "DXRenderTargetView.h"
 #include <sstream>
 #include <stdexcept>
+#include "DXResourceTracking.h"
+
+#define DX_RENDER_TARGET_VIEW_OWNER "Render target views"
 
 D3D11_TEXTURE2D_DESC depthTextureDesc{
     800, 600, 1, 1, DXGI_FORMAT_D24_UNORM_S8_UINT, {1, 0}, D3D11_USAGE_DEFAULT, D3D11_BIND_DEPTH_STENCIL, 0, 0
@@ -19,8 +22,8 @@ DXRenderTargetView::DXRenderTargetView(ID3D11Device* device, uint32_t colorAttac
                                                                             }), depthCreatedInside(true),
                                                                             colorCreatedInside(true)
 {
-    createColorAttachment(colorAttachmentCount, width, height);
-    createDepthAttachment(width, height);
+    createColorAttachment(colorAttachmentCount, width, height, name);
+    createDepthAttachment(width, height, name);
     createRenderTarget(name);
     createDepthStencilView(name);
     createShaderResourceViews(name);
@@ -31,7 +34,7 @@ DXRenderTargetView::DXRenderTargetView(ID3D11Device* device, std::vector<ID3D11T
     colorAttachments(colorAttachment), vp(D3D11_VIEWPORT{(FLOAT)width, (FLOAT)height, 0.0, 1.0f}),
     depthCreatedInside(true)
 {
-    createDepthAttachment(width, height);
+    createDepthAttachment(width, height, name);
     createRenderTarget(name);
     createDepthStencilView(name);
 }
@@ -51,7 +54,7 @@ DXRenderTargetView::DXRenderTargetView(ID3D11Device* device, ID3D11Texture2D* te
                                                            depthCreatedInside(true)
 {
     colorAttachments.push_back(textureArray);
-    createDepthAttachment(width, height);
+    createDepthAttachment(width, height, name);
     createRenderTargetForTextureArray(elementAmount, name);
     createDepthStencilView(name);
 }
@@ -81,22 +84,22 @@ void DXRenderTargetView::clearDepthAttachments(ID3D11DeviceContext* context)
     context->ClearDepthStencilView(depthView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 }
 
-void DXRenderTargetView::bind(ID3D11DeviceContext* context, uint32_t width, uint32_t height, int curImage,
+void DXRenderTargetView::bind(DXStateContext* context, uint32_t width, uint32_t height, int curImage,
                               bool bindDepthImages)
 {
     vp.Width = (FLOAT)width;
     vp.Height = (FLOAT)height;
     vp.TopLeftX = 0;
     vp.TopLeftY = 0;
-    context->RSSetViewports(1, &vp);
+    context->setViewport(vp);
     if (curImage < 0)
     {
-        context->OMSetRenderTargets((UINT)renderTargetViews.size(), renderTargetViews.data(),
-                                    bindDepthImages ? depthView : nullptr);
+        context->setRenderTargets((UINT)renderTargetViews.size(), renderTargetViews.data(),
+                                  bindDepthImages ? depthView : nullptr);
     }
     else
     {
-        context->OMSetRenderTargets(1, &renderTargetViews[curImage], bindDepthImages ? depthView : nullptr);
+        context->setRenderTargets(1, &renderTargetViews[curImage], bindDepthImages ? depthView : nullptr);
     }
 }
 
@@ -111,6 +114,7 @@ void DXRenderTargetView::createRenderTarget(const char* name)
         {
             throw std::runtime_error("Failed to create render target view");
         }
+        trackView(renderTargetViews[i], name, DX_RENDER_TARGET_VIEW_OWNER);
 #if defined(_DEBUG)
         if (name)
         {
@@ -142,6 +146,7 @@ void DXRenderTargetView::createRenderTargetForTextureArray(uint32_t imagesAmount
         {
             throw std::runtime_error("Failed to create render target view");
         }
+        trackView(renderTargetViews[i], name, DX_RENDER_TARGET_VIEW_OWNER);
 #if defined(_DEBUG)
         if (name)
         {
@@ -158,8 +163,8 @@ void DXRenderTargetView::createRenderTargetForTextureArray(uint32_t imagesAmount
 
 void DXRenderTargetView::resize(uint32_t width, uint32_t height, const char* name)
 {
-    createColorAttachment(colorAttachments.size(), width, height);
-    createDepthAttachment(width, height);
+    createColorAttachment(colorAttachments.size(), width, height, name);
+    createDepthAttachment(width, height, name);
     createRenderTarget(name);
     createDepthStencilView(name);
     createShaderResourceViews(name);
@@ -169,7 +174,7 @@ void DXRenderTargetView::resize(std::vector<ID3D11Texture2D*> colorAttachment, u
                                 const char* name)
 {
     DXRenderTargetView::colorAttachments = colorAttachment;
-    createDepthAttachment(width, height);
+    createDepthAttachment(width, height, name);
     createRenderTarget(name);
     createDepthStencilView(name);
 }
@@ -187,22 +192,23 @@ void DXRenderTargetView::resize(ID3D11Texture2D* textureArray, uint32_t width, u
                                 const char* name)
 {
     colorAttachments[0] = textureArray;
-    createDepthAttachment(width, height);
+    createDepthAttachment(width, height, name);
     createRenderTargetForTextureArray(elementAmount, name);
     createDepthStencilView(name);
 }
 
-std::vector<ID3D11RenderTargetView*> DXRenderTargetView::getRenderTargetViews() const
+const std::vector<ID3D11RenderTargetView*>& DXRenderTargetView::getRenderTargetViews() const
 {
     return renderTargetViews;
 }
 
-std::vector<ID3D11ShaderResourceView*> DXRenderTargetView::getResourceViews() const
+const std::vector<ID3D11ShaderResourceView*>& DXRenderTargetView::getResourceViews() const
 {
     return resourceViews;
 }
 
-void DXRenderTargetView::createColorAttachment(uint32_t colorAttachmentCount, uint32_t width, uint32_t height)
+void DXRenderTargetView::createColorAttachment(uint32_t colorAttachmentCount, uint32_t width, uint32_t height,
+                                               const char* name)
 {
     colorTextureDesc.Width = width;
     colorTextureDesc.Height = height;
@@ -213,10 +219,11 @@ void DXRenderTargetView::createColorAttachment(uint32_t colorAttachmentCount, ui
         {
             throw std::runtime_error("Failed to create color attachment");
         }
+        trackTexture(colorAttachments[i], name, DX_RENDER_TARGET_VIEW_OWNER);
     }
 }
 
-void DXRenderTargetView::createDepthAttachment(uint32_t width, uint32_t height)
+void DXRenderTargetView::createDepthAttachment(uint32_t width, uint32_t height, const char* name)
 {
     depthTextureDesc.Width = width;
     depthTextureDesc.Height = height;
@@ -224,6 +231,7 @@ void DXRenderTargetView::createDepthAttachment(uint32_t width, uint32_t height)
     {
         throw std::runtime_error("Failed to create depth attachment");
     }
+    trackTexture(depthAttachment, name, DX_RENDER_TARGET_VIEW_OWNER);
 }
 
 void DXRenderTargetView::createDepthStencilView(const char* name)
@@ -232,6 +240,7 @@ void DXRenderTargetView::createDepthStencilView(const char* name)
     {
         throw std::runtime_error("Failed to create depth stencil view");
     }
+    trackView(depthView, name, DX_RENDER_TARGET_VIEW_OWNER);
 #if defined(_DEBUG)
     if (name)
     {
@@ -263,6 +272,7 @@ void DXRenderTargetView::createShaderResourceViews(const char* name)
             {
                 throw std::runtime_error("Failed to create shader resource view");
             }
+            trackView(pResourceView, name, DX_RENDER_TARGET_VIEW_OWNER);
             if (finalName.length())
             {
                 finalName = name;
@@ -283,25 +293,25 @@ DXRenderTargetView::~DXRenderTargetView()
 
 void DXRenderTargetView::destroy()
 {
-    depthView->Release();
+    releaseTracked(depthView);
     for (auto resourceView : resourceViews)
     {
-        resourceView->Release();
+        releaseTracked(resourceView);
     }
     for (auto& item : renderTargetViews)
     {
-        item->Release();
+        releaseTracked(item);
     }
     if (colorCreatedInside)
     {
         for (auto& item : colorAttachments)
         {
-            item->Release();
+            releaseTracked(item);
         }
     }
     if (depthCreatedInside)
     {
-        depthAttachment->Release();
+        releaseTracked(depthAttachment);
     }
     resourceViews.clear();
 }
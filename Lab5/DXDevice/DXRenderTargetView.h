@@ -3,6 +3,7 @@
 #include <d3d11.h>
 #include <cstdint>
 #include <vector>
+#include "DXStateContext.h"
 
 class DXRenderTargetView
 {
@@ -23,19 +24,19 @@ private:
 	bool colorCreatedInside = false;
 	bool depthCreatedInside = false;
 public:
-	void bind(ID3D11DeviceContext* context, uint32_t width, uint32_t height, int curImage, bool bindDepthImages = true);
+	void bind(DXStateContext* context, uint32_t width, uint32_t height, int curImage, bool bindDepthImages = true);
 	void clearColorAttachments(ID3D11DeviceContext* context, float r, float g, float b, float a, int currentImage);
 	void clearDepthAttachments(ID3D11DeviceContext* context);
 	void resize(uint32_t width, uint32_t height, const char* name = nullptr);
 	void resize(std::vector <ID3D11Texture2D*> colorAttachment, uint32_t width, uint32_t height, const char* name = nullptr);
 	void resize(std::vector <ID3D11Texture2D*> colorAttachment, ID3D11Texture2D* depthAttachment, uint32_t width, uint32_t height, const char* name = nullptr);
 	void resize(ID3D11Texture2D* textureArray, uint32_t width, uint32_t height, uint32_t elementAmount,  const char* name = nullptr);
-	std::vector<ID3D11RenderTargetView*> getRenderTargetViews() const;
-	std::vector<ID3D11ShaderResourceView*> getResourceViews() const;
+	const std::vector<ID3D11RenderTargetView*>& getRenderTargetViews() const;
+	const std::vector<ID3D11ShaderResourceView*>& getResourceViews() const;
 
 private:
-	void createColorAttachment(uint32_t colorAttachmentCount, uint32_t width, uint32_t height);
-	void createDepthAttachment(uint32_t width, uint32_t height);
+	void createColorAttachment(uint32_t colorAttachmentCount, uint32_t width, uint32_t height, const char* name = nullptr);
+	void createDepthAttachment(uint32_t width, uint32_t height, const char* name = nullptr);
 	void createRenderTarget(const char* name = nullptr);
 	void createRenderTargetForTextureArray(uint32_t imagesAmount, const char* name = nullptr);
 
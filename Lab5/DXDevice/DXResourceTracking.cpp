@@ -0,0 +1,59 @@
+#include "DXResourceTracking.h"
+
+#include "../Utils/DXGIFormatSize.h"
+
+void trackTexture(ID3D11Texture2D* texture, const char* name, const char* owner)
+{
+    D3D11_TEXTURE2D_DESC desc;
+    texture->GetDesc(&desc);
+    ResourceRecord record;
+    record.name = name ? name : "Unnamed texture";
+    record.owner = owner;
+    record.category = desc.BindFlags & (D3D11_BIND_RENDER_TARGET | D3D11_BIND_DEPTH_STENCIL)
+                          ? RESOURCE_CATEGORY_RENDER_TARGET
+                          : RESOURCE_CATEGORY_TEXTURE;
+    record.format = desc.Format;
+    record.width = desc.Width;
+    record.height = desc.Height;
+    record.arraySize = desc.ArraySize;
+    // GetDesc reports the real amount of mips, also when the texture was created with 0
+    record.mipLevels = desc.MipLevels;
+    // Tiled textures are mapped into a tile pool, the pool buffer is what holds the memory
+    if (!(desc.MiscFlags & D3D11_RESOURCE_MISC_TILED))
+    {
+        record.bytes = getDXGITextureBytes(desc.Format, desc.Width, desc.Height, desc.ArraySize, desc.MipLevels) *
+            desc.SampleDesc.Count;
+    }
+    ResourceRegistry::getShared().add(texture, record);
+}
+
+void trackBuffer(ID3D11Buffer* buffer, const char* name, const char* owner)
+{
+    D3D11_BUFFER_DESC desc;
+    buffer->GetDesc(&desc);
+    ResourceRecord record;
+    record.name = name ? name : "Unnamed buffer";
+    record.owner = owner;
+    record.category = RESOURCE_CATEGORY_BUFFER;
+    record.width = desc.ByteWidth;
+    record.bytes = desc.ByteWidth;
+    ResourceRegistry::getShared().add(buffer, record);
+}
+
+void trackView(ID3D11View* view, const char* name, const char* owner)
+{
+    ResourceRecord record;
+    record.name = name ? name : "Unnamed view";
+    record.owner = owner;
+    record.category = RESOURCE_CATEGORY_VIEW;
+    ResourceRegistry::getShared().add(view, record);
+}
+
+void releaseTracked(IUnknown* object)
+{
+    if (object)
+    {
+        ResourceRegistry::getShared().remove(object);
+        object->Release();
+    }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <d3d11.h>
+#include "../Engine/Resources/ResourceRegistry.h"
+
+/*
+ * Records D3D11 objects in the shared resource registry, sizes and formats are read from the object itself. name may
+ * be null. Objects registered here are released with releaseTracked, which takes them out of the registry.
+ */
+void trackTexture(ID3D11Texture2D* texture, const char* name, const char* owner);
+void trackBuffer(ID3D11Buffer* buffer, const char* name, const char* owner);
+void trackView(ID3D11View* view, const char* name, const char* owner);
+/*
+ * Unregisters and releases the reference the creator holds, null is ignored
+ */
+void releaseTracked(IUnknown* object);
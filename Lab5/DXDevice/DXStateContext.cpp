@@ -0,0 +1,403 @@
+#include "DXStateContext.h"
+#include <stdexcept>
+#include <thread>
+
+#define DX_STATE_CONTEXT_MAX_SLOTS D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT
+#define DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT
+// Widest window a constant buffer range can show, for whole buffers bound next to ranges
+#define DX_STATE_CONTEXT_WHOLE_BUFFER_CONSTANTS D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT
+
+namespace
+{
+    template <typename T>
+    const StateHandle* toHandles(uint32_t amount, T* const* pObjects,
+                                 StateHandle (&handles)[DX_STATE_CONTEXT_MAX_SLOTS])
+    {
+        for (uint32_t i = 0; i < amount && i < DX_STATE_CONTEXT_MAX_SLOTS; i++)
+        {
+            handles[i] = pObjects ? pObjects[i] : nullptr;
+        }
+        return handles;
+    }
+
+    template <typename T>
+    T* const* fromHandles(uint32_t amount, const StateHandle* pHandles, T* (&objects)[DX_STATE_CONTEXT_MAX_SLOTS])
+    {
+        for (uint32_t i = 0; i < amount && i < DX_STATE_CONTEXT_MAX_SLOTS; i++)
+        {
+            objects[i] = pHandles ? (T*)pHandles[i] : nullptr;
+        }
+        return objects;
+    }
+}
+
+DXStateContext::DXStateContext(ID3D11DeviceContext* context) : context(context)
+{
+    if (FAILED(context->QueryInterface(IID_PPV_ARGS(&context1))))
+    {
+        context1 = nullptr;
+    }
+}
+
+ID3D11DeviceContext* DXStateContext::getContext() const
+{
+    return context;
+}
+
+void DXStateContext::setShader(StateTrackerStage stage, StateHandle shader)
+{
+    if (!tracker.setShader(stage, shader))
+    {
+        return;
+    }
+    if (stage == STATE_TRACKER_VERTEX_STAGE)
+    {
+        context->VSSetShader((ID3D11VertexShader*)shader, nullptr, 0);
+    }
+    else
+    {
+        context->PSSetShader((ID3D11PixelShader*)shader, nullptr, 0);
+    }
+}
+
+void DXStateContext::setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                        const StateHandle* pViews)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    if (!tracker.setShaderResources(stage, start, amount, pViews, issueStart, issueAmount))
+    {
+        return;
+    }
+    ID3D11ShaderResourceView* views[DX_STATE_CONTEXT_MAX_SLOTS];
+    fromHandles(issueAmount, pViews + (issueStart - start), views);
+    if (stage == STATE_TRACKER_VERTEX_STAGE)
+    {
+        context->VSSetShaderResources(issueStart, issueAmount, views);
+    }
+    else
+    {
+        context->PSSetShaderResources(issueStart, issueAmount, views);
+    }
+}
+
+void DXStateContext::setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                 const StateHandle* pSamplers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    if (!tracker.setSamplers(stage, start, amount, pSamplers, issueStart, issueAmount))
+    {
+        return;
+    }
+    ID3D11SamplerState* samplers[DX_STATE_CONTEXT_MAX_SLOTS];
+    fromHandles(issueAmount, pSamplers + (issueStart - start), samplers);
+    if (stage == STATE_TRACKER_VERTEX_STAGE)
+    {
+        context->VSSetSamplers(issueStart, issueAmount, samplers);
+    }
+    else
+    {
+        context->PSSetSamplers(issueStart, issueAmount, samplers);
+    }
+}
+
+void DXStateContext::setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                        const StateConstantBuffer* pBuffers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    if (!tracker.setConstantBuffers(stage, start, amount, pBuffers, issueStart, issueAmount))
+    {
+        return;
+    }
+    ID3D11Buffer* buffers[DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS];
+    UINT firstConstants[DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS];
+    UINT constantsAmounts[DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS];
+    bool ranged = false;
+    for (uint32_t i = 0; i < issueAmount && i < DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS; i++)
+    {
+        const StateConstantBuffer& binding = pBuffers[issueStart - start + i];
+        buffers[i] = (ID3D11Buffer*)binding.buffer;
+        firstConstants[i] = binding.firstConstant;
+        constantsAmounts[i] = binding.constantsAmount ? binding.constantsAmount
+                                                      : DX_STATE_CONTEXT_WHOLE_BUFFER_CONSTANTS;
+        ranged |= binding.constantsAmount != 0;
+    }
+    if (!ranged)
+    {
+        if (stage == STATE_TRACKER_VERTEX_STAGE)
+        {
+            context->VSSetConstantBuffers(issueStart, issueAmount, buffers);
+        }
+        else
+        {
+            context->PSSetConstantBuffers(issueStart, issueAmount, buffers);
+        }
+        return;
+    }
+    if (!context1)
+    {
+        throw std::runtime_error("Constant buffer ranges need the D3D11.1 runtime");
+    }
+    if (stage == STATE_TRACKER_VERTEX_STAGE)
+    {
+        context1->VSSetConstantBuffers1(issueStart, issueAmount, buffers, firstConstants, constantsAmounts);
+    }
+    else
+    {
+        context1->PSSetConstantBuffers1(issueStart, issueAmount, buffers, firstConstants, constantsAmounts);
+    }
+}
+
+void DXStateContext::setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView)
+{
+    if (!tracker.setRenderTargets(amount, pViews, depthView))
+    {
+        return;
+    }
+    ID3D11RenderTargetView* views[DX_STATE_CONTEXT_MAX_SLOTS];
+    context->OMSetRenderTargets(amount, pViews ? fromHandles(amount, pViews, views) : nullptr,
+                                (ID3D11DepthStencilView*)depthView);
+}
+
+void DXStateContext::setDepthStencilState(StateHandle state, uint32_t stencilRef)
+{
+    if (tracker.setDepthStencilState(state, stencilRef))
+    {
+        context->OMSetDepthStencilState((ID3D11DepthStencilState*)state, stencilRef);
+    }
+}
+
+void DXStateContext::setRasterizerState(StateHandle state)
+{
+    if (tracker.setRasterizerState(state))
+    {
+        context->RSSetState((ID3D11RasterizerState*)state);
+    }
+}
+
+void DXStateContext::setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask)
+{
+    if (tracker.setBlendState(state, pBlendFactor, sampleMask))
+    {
+        context->OMSetBlendState((ID3D11BlendState*)state, pBlendFactor, sampleMask);
+    }
+}
+
+void DXStateContext::setViewport(const StateViewport& viewport)
+{
+    if (tracker.setViewport(viewport))
+    {
+        D3D11_VIEWPORT nativeViewport = {
+            viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth
+        };
+        context->RSSetViewports(1, &nativeViewport);
+    }
+}
+
+void DXStateContext::setInputLayout(StateHandle layout)
+{
+    if (tracker.setInputLayout(layout))
+    {
+        context->IASetInputLayout((ID3D11InputLayout*)layout);
+    }
+}
+
+void DXStateContext::setPrimitiveTopology(uint32_t topology)
+{
+    if (tracker.setPrimitiveTopology(topology))
+    {
+        context->IASetPrimitiveTopology((D3D11_PRIMITIVE_TOPOLOGY)topology);
+    }
+}
+
+void DXStateContext::setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset)
+{
+    if (tracker.setVertexBuffer(slot, buffer, stride, offset))
+    {
+        ID3D11Buffer* buffers[] = {(ID3D11Buffer*)buffer};
+        UINT strides[] = {stride};
+        UINT offsets[] = {offset};
+        context->IASetVertexBuffers(slot, 1, buffers, strides, offsets);
+    }
+}
+
+void DXStateContext::setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset)
+{
+    if (tracker.setIndexBuffer(buffer, format, offset))
+    {
+        context->IASetIndexBuffer((ID3D11Buffer*)buffer, (DXGI_FORMAT)format, offset);
+    }
+}
+
+void DXStateContext::clearRenderTarget(StateHandle view, const float* pColor)
+{
+    context->ClearRenderTargetView((ID3D11RenderTargetView*)view, pColor);
+}
+
+void DXStateContext::clearDepthStencil(StateHandle view, float depth, uint8_t stencil)
+{
+    context->ClearDepthStencilView((ID3D11DepthStencilView*)view, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, depth,
+                                   stencil);
+}
+
+void DXStateContext::draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    context->Draw(vertexCount, startVertex);
+}
+
+void DXStateContext::drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    context->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void DXStateContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex,
+                                          int32_t baseVertex, uint32_t startInstance)
+{
+    context->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void* DXStateContext::map(StateHandle buffer, GraphicsMapMode mode)
+{
+    D3D11_MAPPED_SUBRESOURCE mappedResource = {};
+    D3D11_MAP mapType = mode == GRAPHICS_MAP_WRITE_DISCARD ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+    if (FAILED(context->Map((ID3D11Buffer*)buffer, 0, mapType, 0, &mappedResource)))
+    {
+        throw std::runtime_error("Failed to map buffer");
+    }
+    return mappedResource.pData;
+}
+
+void DXStateContext::unmap(StateHandle buffer)
+{
+    context->Unmap((ID3D11Buffer*)buffer, 0);
+}
+
+void DXStateContext::updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData)
+{
+    if (size == 0)
+    {
+        context->UpdateSubresource((ID3D11Buffer*)buffer, 0, nullptr, pData, 0, 0);
+        return;
+    }
+    D3D11_BOX box = {};
+    box.left = offset;
+    box.right = offset + size;
+    box.bottom = 1;
+    box.back = 1;
+    context->UpdateSubresource((ID3D11Buffer*)buffer, 0, &box, pData, 0, 0);
+}
+
+void DXStateContext::signalFence(StateHandle fence)
+{
+    context->End((ID3D11Query*)fence);
+}
+
+bool DXStateContext::isFenceDone(StateHandle fence, bool wait)
+{
+    HRESULT res = context->GetData((ID3D11Query*)fence, nullptr, 0, wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH);
+    while (wait && res == S_FALSE)
+    {
+        std::this_thread::yield();
+        res = context->GetData((ID3D11Query*)fence, nullptr, 0, 0);
+    }
+    if (FAILED(res))
+    {
+        throw std::runtime_error("Failed to read fence");
+    }
+    return res == S_OK;
+}
+
+void DXStateContext::invalidate()
+{
+    tracker.invalidate();
+}
+
+void DXStateContext::beginFrame()
+{
+    tracker.beginFrame();
+}
+
+const StateTrackerStats& DXStateContext::getLastFrameStats() const
+{
+    return tracker.getLastFrameStats();
+}
+
+void DXStateContext::setVertexShader(ID3D11VertexShader* shader)
+{
+    setShader(STATE_TRACKER_VERTEX_STAGE, shader);
+}
+
+void DXStateContext::setPixelShader(ID3D11PixelShader* shader)
+{
+    setShader(STATE_TRACKER_PIXEL_STAGE, shader);
+}
+
+void DXStateContext::setVertexShaderResources(uint32_t start, uint32_t amount,
+                                              ID3D11ShaderResourceView* const* pViews)
+{
+    StateHandle handles[DX_STATE_CONTEXT_MAX_SLOTS];
+    setShaderResources(STATE_TRACKER_VERTEX_STAGE, start, amount, toHandles(amount, pViews, handles));
+}
+
+void DXStateContext::setPixelShaderResources(uint32_t start, uint32_t amount,
+                                             ID3D11ShaderResourceView* const* pViews)
+{
+    StateHandle handles[DX_STATE_CONTEXT_MAX_SLOTS];
+    setShaderResources(STATE_TRACKER_PIXEL_STAGE, start, amount, toHandles(amount, pViews, handles));
+}
+
+void DXStateContext::setVertexSamplers(uint32_t start, uint32_t amount, ID3D11SamplerState* const* pSamplers)
+{
+    StateHandle handles[DX_STATE_CONTEXT_MAX_SLOTS];
+    setSamplers(STATE_TRACKER_VERTEX_STAGE, start, amount, toHandles(amount, pSamplers, handles));
+}
+
+void DXStateContext::setPixelSamplers(uint32_t start, uint32_t amount, ID3D11SamplerState* const* pSamplers)
+{
+    StateHandle handles[DX_STATE_CONTEXT_MAX_SLOTS];
+    setSamplers(STATE_TRACKER_PIXEL_STAGE, start, amount, toHandles(amount, pSamplers, handles));
+}
+
+void DXStateContext::setVertexConstantBuffers(uint32_t start, uint32_t amount, ID3D11Buffer* const* pBuffers)
+{
+    StateConstantBuffer bindings[DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS];
+    for (uint32_t i = 0; i < amount && i < DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS; i++)
+    {
+        bindings[i] = {pBuffers ? pBuffers[i] : nullptr, 0, 0};
+    }
+    setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, start, amount, bindings);
+}
+
+void DXStateContext::setPixelConstantBuffers(uint32_t start, uint32_t amount, ID3D11Buffer* const* pBuffers)
+{
+    StateConstantBuffer bindings[DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS];
+    for (uint32_t i = 0; i < amount && i < DX_STATE_CONTEXT_CONSTANT_BUFFER_SLOTS; i++)
+    {
+        bindings[i] = {pBuffers ? pBuffers[i] : nullptr, 0, 0};
+    }
+    setConstantBuffers(STATE_TRACKER_PIXEL_STAGE, start, amount, bindings);
+}
+
+void DXStateContext::setRenderTargets(uint32_t amount, ID3D11RenderTargetView* const* pViews,
+                                      ID3D11DepthStencilView* depthView)
+{
+    StateHandle handles[DX_STATE_CONTEXT_MAX_SLOTS];
+    setRenderTargets(amount, pViews ? toHandles(amount, pViews, handles) : nullptr, (StateHandle)depthView);
+}
+
+void DXStateContext::setViewport(const D3D11_VIEWPORT& viewport)
+{
+    setViewport(StateViewport{
+        viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth
+    });
+}
+
+DXStateContext::~DXStateContext()
+{
+    if (context1)
+    {
+        context1->Release();
+    }
+}
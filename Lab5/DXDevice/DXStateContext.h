@@ -0,0 +1,72 @@
+#pragma once
+
+#include <d3d11_1.h>
+#include "StateTracker.h"
+#include "../Engine/Device/GraphicsContext.h"
+
+/*
+ * D3D11 GraphicsContext, handles are the native objects. Bindings go through a StateTracker so calls that would set
+ * what the context already has never reach D3D11. Code that binds through getContext or outside of the engine has
+ * to invalidate afterwards.
+ */
+class DXStateContext : public GraphicsContext
+{
+public:
+    DXStateContext(ID3D11DeviceContext* context);
+
+private:
+    ID3D11DeviceContext* context;
+    // nullptr before the D3D11.1 runtime, constant buffer ranges need it
+    ID3D11DeviceContext1* context1 = nullptr;
+    StateTracker tracker;
+
+public:
+    ID3D11DeviceContext* getContext() const;
+
+    void setShader(StateTrackerStage stage, StateHandle shader) override;
+    void setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateHandle* pViews) override;
+    void setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount, const StateHandle* pSamplers) override;
+    void setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateConstantBuffer* pBuffers) override;
+    void setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView) override;
+    void setDepthStencilState(StateHandle state, uint32_t stencilRef) override;
+    void setRasterizerState(StateHandle state) override;
+    void setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask) override;
+    void setViewport(const StateViewport& viewport) override;
+    void setInputLayout(StateHandle layout) override;
+    void setPrimitiveTopology(uint32_t topology) override;
+    void setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset) override;
+    void setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset) override;
+
+    void clearRenderTarget(StateHandle view, const float* pColor) override;
+    void clearDepthStencil(StateHandle view, float depth, uint8_t stencil) override;
+    void draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void* map(StateHandle buffer, GraphicsMapMode mode) override;
+    void unmap(StateHandle buffer) override;
+    void updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData) override;
+    void signalFence(StateHandle fence) override;
+    bool isFenceDone(StateHandle fence, bool wait) override;
+
+    void invalidate() override;
+    void beginFrame() override;
+    const StateTrackerStats& getLastFrameStats() const override;
+
+    /*
+     * Typed shortcuts for D3D11 code
+     */
+    void setVertexShader(ID3D11VertexShader* shader);
+    void setPixelShader(ID3D11PixelShader* shader);
+    void setVertexShaderResources(uint32_t start, uint32_t amount, ID3D11ShaderResourceView* const* pViews);
+    void setPixelShaderResources(uint32_t start, uint32_t amount, ID3D11ShaderResourceView* const* pViews);
+    void setVertexSamplers(uint32_t start, uint32_t amount, ID3D11SamplerState* const* pSamplers);
+    void setPixelSamplers(uint32_t start, uint32_t amount, ID3D11SamplerState* const* pSamplers);
+    void setVertexConstantBuffers(uint32_t start, uint32_t amount, ID3D11Buffer* const* pBuffers);
+    void setPixelConstantBuffers(uint32_t start, uint32_t amount, ID3D11Buffer* const* pBuffers);
+    void setRenderTargets(uint32_t amount, ID3D11RenderTargetView* const* pViews, ID3D11DepthStencilView* depthView);
+    void setViewport(const D3D11_VIEWPORT& viewport);
+    ~DXStateContext();
+};
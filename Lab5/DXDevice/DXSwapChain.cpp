@@ -25,7 +25,7 @@ void DXSwapChain::resize(uint32_t width, uint32_t height) {
 	rtv->resize(swapChainTextures , width, height, name);
 }
 
-void DXSwapChain::bind(ID3D11DeviceContext* context, uint32_t width, uint32_t height) {
+void DXSwapChain::bind(DXStateContext* context, uint32_t width, uint32_t height) {
 	rtv->bind(context, width, height, curImageCounter);
 	curImageCounter++;
 	if (curImageCounter >= DX_SWAPCHAIN_DEFAULT_BUFFER_AMOUNT) {
@@ -45,6 +45,11 @@ uint32_t DXSwapChain::getCurrentImage() const
 	return curImageCounter;
 }
 
+ID3D11RenderTargetView* DXSwapChain::getCurrentRenderTargetView() const
+{
+	return rtv->getRenderTargetViews()[curImageCounter];
+}
+
 DXSwapChain::~DXSwapChain() {
 	destroy();
 }
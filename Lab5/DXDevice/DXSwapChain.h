@@ -21,10 +21,12 @@ private:
 	const char* name;
 public:
 	void resize(uint32_t width, uint32_t height);
-	void bind(ID3D11DeviceContext* context, uint32_t width, uint32_t height);
+	void bind(DXStateContext* context, uint32_t width, uint32_t height);
 	void clearRenderTargets(ID3D11DeviceContext* context, float r, float g, float b, float a);
 	void present(bool vsync);
 	uint32_t getCurrentImage() const;
+	// View of the image the next bind binds
+	ID3D11RenderTargetView* getCurrentRenderTargetView() const;
 
 	~DXSwapChain();
 private:
@@ -0,0 +1,83 @@
+#include "DXTimestampQueries.h"
+
+#include <stdexcept>
+
+DXTimestampQueries::DXTimestampQueries(ID3D11Device* device, const std::vector<ID3D11DeviceContext*>& contexts,
+                                       uint32_t timestampsAmount) :
+    contexts(contexts), timestampsAmount(timestampsAmount)
+{
+    D3D11_QUERY_DESC disjointDesc = {D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+    D3D11_QUERY_DESC timestampDesc = {D3D11_QUERY_TIMESTAMP, 0};
+    timestampQueries.resize(GPU_TIMER_FRAMES_IN_FLIGHT * timestampsAmount, nullptr);
+    for (uint32_t slot = 0; slot < GPU_TIMER_FRAMES_IN_FLIGHT; slot++)
+    {
+        if (FAILED(device->CreateQuery(&disjointDesc, &disjointQueries[slot])))
+        {
+            throw std::runtime_error("Failed to create timestamp disjoint query");
+        }
+    }
+    for (auto& query : timestampQueries)
+    {
+        if (FAILED(device->CreateQuery(&timestampDesc, &query)))
+        {
+            throw std::runtime_error("Failed to create timestamp query");
+        }
+    }
+}
+
+void DXTimestampQueries::beginFrame(uint32_t frameSlot)
+{
+    contexts[0]->Begin(disjointQueries[frameSlot]);
+}
+
+void DXTimestampQueries::endFrame(uint32_t frameSlot)
+{
+    contexts[0]->End(disjointQueries[frameSlot]);
+}
+
+void DXTimestampQueries::writeTimestamp(uint32_t context, uint32_t frameSlot, uint32_t timestamp)
+{
+    contexts[context]->End(timestampQueries[frameSlot * timestampsAmount + timestamp]);
+}
+
+GpuQueryStatus DXTimestampQueries::readFrequency(uint32_t frameSlot, uint64_t* pFrequencyOutput)
+{
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT data;
+    // Present flushes every frame, flushing here as well would only add work to the frame being built
+    if (contexts[0]->GetData(disjointQueries[frameSlot], &data, sizeof(data), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+    {
+        return GPU_QUERY_NOT_READY;
+    }
+    *pFrequencyOutput = data.Frequency;
+    return data.Disjoint ? GPU_QUERY_DISJOINT : GPU_QUERY_READY;
+}
+
+bool DXTimestampQueries::readTimestamp(uint32_t frameSlot, uint32_t timestamp, uint64_t* pTimestampOutput)
+{
+    UINT64 data;
+    if (contexts[0]->GetData(timestampQueries[frameSlot * timestampsAmount + timestamp], &data, sizeof(data),
+                             D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+    {
+        return false;
+    }
+    *pTimestampOutput = data;
+    return true;
+}
+
+DXTimestampQueries::~DXTimestampQueries()
+{
+    for (auto query : disjointQueries)
+    {
+        if (query)
+        {
+            query->Release();
+        }
+    }
+    for (auto query : timestampQueries)
+    {
+        if (query)
+        {
+            query->Release();
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <d3d11.h>
+#include <vector>
+#include "../Engine/Profiling/GpuTimer.h"
+
+/*
+ * D3D11 timestamp queries, one disjoint query and a set of timestamps per frame slot. Timestamps of passes recorded on
+ * deferred contexts are ended there and resolve when their command list executes, the results are only read on the
+ * immediate context.
+ */
+class DXTimestampQueries : public GpuTimestampQueries
+{
+public:
+    /*
+     * contexts[0] is the immediate context, the rest are the recording contexts of the render graph
+     */
+    DXTimestampQueries(ID3D11Device* device, const std::vector<ID3D11DeviceContext*>& contexts,
+                       uint32_t timestampsAmount);
+    DXTimestampQueries(const DXTimestampQueries&) = delete;
+    DXTimestampQueries& operator=(const DXTimestampQueries&) = delete;
+
+private:
+    std::vector<ID3D11DeviceContext*> contexts;
+    uint32_t timestampsAmount;
+    ID3D11Query* disjointQueries[GPU_TIMER_FRAMES_IN_FLIGHT] = {};
+    // Frame slot after frame slot
+    std::vector<ID3D11Query*> timestampQueries;
+
+public:
+    void beginFrame(uint32_t frameSlot) override;
+    void endFrame(uint32_t frameSlot) override;
+    void writeTimestamp(uint32_t context, uint32_t frameSlot, uint32_t timestamp) override;
+    GpuQueryStatus readFrequency(uint32_t frameSlot, uint64_t* pFrequencyOutput) override;
+    bool readTimestamp(uint32_t frameSlot, uint32_t timestamp, uint64_t* pTimestampOutput) override;
+    ~DXTimestampQueries();
+};
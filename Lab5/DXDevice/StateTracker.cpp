@@ -0,0 +1,240 @@
+#include "StateTracker.h"
+
+bool StateViewport::operator==(const StateViewport& other) const
+{
+    return x == other.x && y == other.y && width == other.width && height == other.height &&
+        minDepth == other.minDepth && maxDepth == other.maxDepth;
+}
+
+bool StateConstantBuffer::operator==(const StateConstantBuffer& other) const
+{
+    return buffer == other.buffer && firstConstant == other.firstConstant &&
+        constantsAmount == other.constantsAmount;
+}
+
+bool StateTracker::RenderTargets::operator==(const RenderTargets& other) const
+{
+    for (uint32_t i = 0; i < STATE_TRACKER_RENDER_TARGET_SLOTS; i++)
+    {
+        if (views[i] != other.views[i])
+        {
+            return false;
+        }
+    }
+    return depthView == other.depthView;
+}
+
+bool StateTracker::DepthStencil::operator==(const DepthStencil& other) const
+{
+    return state == other.state && stencilRef == other.stencilRef;
+}
+
+bool StateTracker::Blend::operator==(const Blend& other) const
+{
+    return state == other.state && blendFactor[0] == other.blendFactor[0] &&
+        blendFactor[1] == other.blendFactor[1] && blendFactor[2] == other.blendFactor[2] &&
+        blendFactor[3] == other.blendFactor[3] && sampleMask == other.sampleMask;
+}
+
+bool StateTracker::VertexBuffer::operator==(const VertexBuffer& other) const
+{
+    return buffer == other.buffer && stride == other.stride && offset == other.offset;
+}
+
+bool StateTracker::IndexBuffer::operator==(const IndexBuffer& other) const
+{
+    return buffer == other.buffer && format == other.format && offset == other.offset;
+}
+
+template <typename T>
+bool StateTracker::track(Tracked<T>& cached, const T& value)
+{
+    if (cached.known && cached.value == value)
+    {
+        return count(false);
+    }
+    cached.value = value;
+    cached.known = true;
+    return count(true);
+}
+
+template <typename T>
+bool StateTracker::trackSlots(Tracked<T>* pCache, uint32_t slotsAmount, uint32_t start, uint32_t amount,
+                              const T* pValues, uint32_t& issueStart, uint32_t& issueAmount)
+{
+    issueStart = start;
+    issueAmount = amount;
+    if (start + amount > slotsAmount)
+    {
+        // Past the tracked slots, forget the overlapping part and let the call through as is
+        for (uint32_t i = start; i < slotsAmount; i++)
+        {
+            pCache[i].known = false;
+        }
+        return count(true);
+    }
+    uint32_t firstChanged = amount;
+    uint32_t lastChanged = 0;
+    for (uint32_t i = 0; i < amount; i++)
+    {
+        Tracked<T>& cached = pCache[start + i];
+        if (!cached.known || !(cached.value == pValues[i]))
+        {
+            firstChanged = firstChanged == amount ? i : firstChanged;
+            lastChanged = i;
+            cached.value = pValues[i];
+            cached.known = true;
+        }
+    }
+    if (firstChanged == amount)
+    {
+        return count(false);
+    }
+    issueStart = start + firstChanged;
+    issueAmount = lastChanged - firstChanged + 1;
+    return count(true);
+}
+
+bool StateTracker::count(bool issue)
+{
+    if (issue)
+    {
+        frameStats.issuedCalls++;
+    }
+    else
+    {
+        frameStats.filteredCalls++;
+    }
+    return issue;
+}
+
+bool StateTracker::setShader(StateTrackerStage stage, StateHandle shader)
+{
+    return track(stages[stage].shader, shader);
+}
+
+bool StateTracker::setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                      const StateHandle* pViews, uint32_t& issueStart, uint32_t& issueAmount)
+{
+    return trackSlots(stages[stage].shaderResources, STATE_TRACKER_SHADER_RESOURCE_SLOTS, start, amount, pViews,
+                      issueStart, issueAmount);
+}
+
+bool StateTracker::setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                               const StateHandle* pSamplers, uint32_t& issueStart, uint32_t& issueAmount)
+{
+    return trackSlots(stages[stage].samplers, STATE_TRACKER_SAMPLER_SLOTS, start, amount, pSamplers, issueStart,
+                      issueAmount);
+}
+
+bool StateTracker::setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                      const StateConstantBuffer* pBuffers, uint32_t& issueStart,
+                                      uint32_t& issueAmount)
+{
+    return trackSlots(stages[stage].constantBuffers, STATE_TRACKER_CONSTANT_BUFFER_SLOTS, start, amount, pBuffers,
+                      issueStart, issueAmount);
+}
+
+bool StateTracker::setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView)
+{
+    RenderTargets targets{};
+    for (uint32_t i = 0; i < amount && i < STATE_TRACKER_RENDER_TARGET_SLOTS; i++)
+    {
+        targets.views[i] = pViews ? pViews[i] : nullptr;
+    }
+    targets.depthView = depthView;
+    if (!track(renderTargets, targets))
+    {
+        return false;
+    }
+    invalidateShaderResources();
+    return true;
+}
+
+bool StateTracker::setDepthStencilState(StateHandle state, uint32_t stencilRef)
+{
+    return track(depthStencil, DepthStencil{state, stencilRef});
+}
+
+bool StateTracker::setRasterizerState(StateHandle state)
+{
+    return track(rasterizerState, state);
+}
+
+bool StateTracker::setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask)
+{
+    Blend newBlend{state, {1.0f, 1.0f, 1.0f, 1.0f}, sampleMask};
+    if (pBlendFactor)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            newBlend.blendFactor[i] = pBlendFactor[i];
+        }
+    }
+    return track(blend, newBlend);
+}
+
+bool StateTracker::setViewport(const StateViewport& newViewport)
+{
+    return track(viewport, newViewport);
+}
+
+bool StateTracker::setInputLayout(StateHandle layout)
+{
+    return track(inputLayout, layout);
+}
+
+bool StateTracker::setPrimitiveTopology(uint32_t topology)
+{
+    return track(primitiveTopology, topology);
+}
+
+bool StateTracker::setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset)
+{
+    if (slot >= STATE_TRACKER_VERTEX_BUFFER_SLOTS)
+    {
+        return count(true);
+    }
+    return track(vertexBuffers[slot], VertexBuffer{buffer, stride, offset});
+}
+
+bool StateTracker::setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset)
+{
+    return track(indexBuffer, IndexBuffer{buffer, format, offset});
+}
+
+void StateTracker::invalidate()
+{
+    StateTrackerStats stats = frameStats;
+    StateTrackerStats lastStats = lastFrameStats;
+    *this = StateTracker();
+    frameStats = stats;
+    lastFrameStats = lastStats;
+}
+
+void StateTracker::invalidateShaderResources()
+{
+    for (auto& stage : stages)
+    {
+        for (auto& shaderResource : stage.shaderResources)
+        {
+            shaderResource.known = false;
+        }
+    }
+}
+
+void StateTracker::beginFrame()
+{
+    lastFrameStats = frameStats;
+    frameStats = StateTrackerStats();
+}
+
+const StateTrackerStats& StateTracker::getFrameStats() const
+{
+    return frameStats;
+}
+
+const StateTrackerStats& StateTracker::getLastFrameStats() const
+{
+    return lastFrameStats;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+
+#define STATE_TRACKER_SHADER_RESOURCE_SLOTS 16
+#define STATE_TRACKER_SAMPLER_SLOTS 16
+#define STATE_TRACKER_CONSTANT_BUFFER_SLOTS 14
+#define STATE_TRACKER_RENDER_TARGET_SLOTS 8
+#define STATE_TRACKER_VERTEX_BUFFER_SLOTS 16
+
+/*
+ * Opaque API object, the tracker only compares the pointers
+ */
+typedef const void* StateHandle;
+
+enum StateTrackerStage
+{
+    STATE_TRACKER_VERTEX_STAGE = 0,
+    STATE_TRACKER_PIXEL_STAGE,
+    STATE_TRACKER_STAGES_AMOUNT
+};
+
+struct StateViewport
+{
+    float x;
+    float y;
+    float width;
+    float height;
+    float minDepth;
+    float maxDepth;
+
+    bool operator==(const StateViewport& other) const;
+};
+
+/*
+ * constantsAmount 0 binds the whole buffer, otherwise the window of 16 byte constants starting at firstConstant
+ */
+struct StateConstantBuffer
+{
+    StateHandle buffer;
+    uint32_t firstConstant;
+    uint32_t constantsAmount;
+
+    bool operator==(const StateConstantBuffer& other) const;
+};
+
+struct StateTrackerStats
+{
+    uint32_t issuedCalls = 0;
+    uint32_t filteredCalls = 0;
+};
+
+/*
+ * Cache of the pipeline bindings last sent to the API. Every set call compares against the cache, updates it and
+ * returns whether the call has to reach the API. Everything starts unknown, so the first call of each kind is always
+ * issued, invalidate returns to that state after code outside of the tracker changed the pipeline.
+ */
+class StateTracker
+{
+private:
+    template <typename T>
+    struct Tracked
+    {
+        T value{};
+        bool known = false;
+    };
+
+    struct StageState
+    {
+        Tracked<StateHandle> shader;
+        Tracked<StateHandle> shaderResources[STATE_TRACKER_SHADER_RESOURCE_SLOTS];
+        Tracked<StateHandle> samplers[STATE_TRACKER_SAMPLER_SLOTS];
+        Tracked<StateConstantBuffer> constantBuffers[STATE_TRACKER_CONSTANT_BUFFER_SLOTS];
+    };
+
+    struct RenderTargets
+    {
+        StateHandle views[STATE_TRACKER_RENDER_TARGET_SLOTS];
+        StateHandle depthView;
+
+        bool operator==(const RenderTargets& other) const;
+    };
+
+    struct DepthStencil
+    {
+        StateHandle state;
+        uint32_t stencilRef;
+
+        bool operator==(const DepthStencil& other) const;
+    };
+
+    struct Blend
+    {
+        StateHandle state;
+        float blendFactor[4];
+        uint32_t sampleMask;
+
+        bool operator==(const Blend& other) const;
+    };
+
+    struct VertexBuffer
+    {
+        StateHandle buffer;
+        uint32_t stride;
+        uint32_t offset;
+
+        bool operator==(const VertexBuffer& other) const;
+    };
+
+    struct IndexBuffer
+    {
+        StateHandle buffer;
+        uint32_t format;
+        uint32_t offset;
+
+        bool operator==(const IndexBuffer& other) const;
+    };
+
+    StageState stages[STATE_TRACKER_STAGES_AMOUNT];
+    Tracked<RenderTargets> renderTargets;
+    Tracked<DepthStencil> depthStencil;
+    Tracked<StateHandle> rasterizerState;
+    Tracked<Blend> blend;
+    Tracked<StateViewport> viewport;
+    Tracked<StateHandle> inputLayout;
+    Tracked<uint32_t> primitiveTopology;
+    Tracked<VertexBuffer> vertexBuffers[STATE_TRACKER_VERTEX_BUFFER_SLOTS];
+    Tracked<IndexBuffer> indexBuffer;
+    StateTrackerStats frameStats;
+    StateTrackerStats lastFrameStats;
+
+public:
+    bool setShader(StateTrackerStage stage, StateHandle shader);
+    /*
+     * Slot ranges report the smallest sub-range that differs from the cache through issueStart and issueAmount.
+     * Ranges past the tracked slots are always issued and pValues is not read for them.
+     */
+    bool setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount, const StateHandle* pViews,
+                            uint32_t& issueStart, uint32_t& issueAmount);
+    bool setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount, const StateHandle* pSamplers,
+                     uint32_t& issueStart, uint32_t& issueAmount);
+    bool setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateConstantBuffer* pBuffers, uint32_t& issueStart, uint32_t& issueAmount);
+    /*
+     * Slots past amount are unbound, as the API does. Changing the targets forgets the shader resources, the
+     * D3D11 runtime silently unbinds shader resources of textures that become render targets.
+     */
+    bool setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView);
+    bool setDepthStencilState(StateHandle state, uint32_t stencilRef);
+    bool setRasterizerState(StateHandle state);
+    /*
+     * nullptr pBlendFactor means {1, 1, 1, 1}
+     */
+    bool setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask);
+    bool setViewport(const StateViewport& newViewport);
+    bool setInputLayout(StateHandle layout);
+    bool setPrimitiveTopology(uint32_t topology);
+    bool setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset);
+    bool setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset);
+    /*
+     * Forgets every cached binding, call after code that binds past the tracker
+     */
+    void invalidate();
+    void invalidateShaderResources();
+    /*
+     * Closes the counters of the previous frame
+     */
+    void beginFrame();
+    const StateTrackerStats& getFrameStats() const;
+    const StateTrackerStats& getLastFrameStats() const;
+
+private:
+    template <typename T>
+    bool track(Tracked<T>& cached, const T& value);
+    template <typename T>
+    bool trackSlots(Tracked<T>* pCache, uint32_t slotsAmount, uint32_t start, uint32_t amount, const T* pValues,
+                    uint32_t& issueStart, uint32_t& issueAmount);
+    bool count(bool issue);
+};
@@ -1,45 +1,67 @@
 #include "ConstantBuffer.h"
-#include <stdexcept>
 
-ConstantBuffer::ConstantBuffer(ID3D11Device* device, void* initData, size_t initDataSize, const char* bufferName)
-{
-    size_t cBufferSize;
-    for (cBufferSize = initDataSize; cBufferSize % 16 != 0; cBufferSize++);
-
-
-	D3D11_BUFFER_DESC bufferDesc = {};
-	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	bufferDesc.ByteWidth = (UINT)cBufferSize;
-	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-	bufferDesc.CPUAccessFlags = 0;
-	bufferDesc.MiscFlags = 0;
+uint64_t ConstantBufferBase::uploadedBytes = 0;
 
-	D3D11_SUBRESOURCE_DATA init_data = {};
-	init_data.pSysMem = initData;
+ConstantBufferBase::ConstantBufferBase(GraphicsDevice* device, const void* initData, uint32_t dataSize,
+                                       const char* bufferName) : device(device), dataSize(dataSize)
+{
+	GraphicsBufferDesc bufferDesc;
+	bufferDesc.size = dataSize;
+	bufferDesc.bindFlags = GRAPHICS_BIND_CONSTANT_BUFFER;
+	buffer = device->createBuffer(bufferDesc, initData, bufferName);
+	partialUpdates = device->getCapabilities().constantBufferPartialUpdates;
+}
 
-    if (FAILED(device->CreateBuffer(&bufferDesc, &init_data, &buffer))) {
-        throw std::runtime_error("Failed to create constant buffer");
+bool ConstantBufferBase::findChangedRegisters(const void* pOld, const void* pNew, uint32_t size,
+                                              uint32_t& firstRegister, uint32_t& endRegister)
+{
+    const uint8_t* oldBytes = (const uint8_t*)pOld;
+    const uint8_t* newBytes = (const uint8_t*)pNew;
+    uint32_t registersAmount = size / 16;
+    firstRegister = registersAmount;
+    endRegister = 0;
+    for (uint32_t i = 0; i < registersAmount; i++)
+    {
+        if (memcmp(oldBytes + i * 16, newBytes + i * 16, 16) != 0)
+        {
+            firstRegister = firstRegister == registersAmount ? i : firstRegister;
+            endRegister = i + 1;
+        }
     }
-    
-	#if defined(_DEBUG)
-		if (bufferName) {
-			buffer->SetPrivateData(WKPDID_D3DDebugObjectName, strlen(bufferName) * sizeof(char), bufferName);
-		}
-	#endif
+    return endRegister != 0;
 }
 
-void ConstantBuffer::updateData(ID3D11DeviceContext* context, void* newData)
+void ConstantBufferBase::upload(GraphicsContext* context, const void* pData, uint32_t firstRegister,
+                                uint32_t endRegister)
 {
-    context->UpdateSubresource(buffer, NULL, nullptr, newData, NULL, NULL);
+    if (!partialUpdates || (firstRegister == 0 && endRegister * 16 == dataSize))
+    {
+        context->updateBuffer(buffer.buffer, 0, 0, pData);
+        uploadedBytes += dataSize;
+        return;
+    }
+    uint32_t offset = firstRegister * 16;
+    uint32_t size = (endRegister - firstRegister) * 16;
+    context->updateBuffer(buffer.buffer, offset, size, (const uint8_t*)pData + offset);
+    uploadedBytes += size;
 }
 
-void ConstantBuffer::bindToVertexShader(ID3D11DeviceContext* context, uint32_t slot) {
-    context->VSSetConstantBuffers(slot, 1, &buffer);
+void ConstantBufferBase::bindToVertexShader(GraphicsContext* context, uint32_t slot) {
+    StateConstantBuffer binding = {buffer.buffer, 0, 0};
+    context->setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, slot, 1, &binding);
 }
-void ConstantBuffer::bindToPixelShader(ID3D11DeviceContext* context, uint32_t slot) {
-    context->PSSetConstantBuffers(slot, 1, &buffer);
+void ConstantBufferBase::bindToPixelShader(GraphicsContext* context, uint32_t slot) {
+    StateConstantBuffer binding = {buffer.buffer, 0, 0};
+    context->setConstantBuffers(STATE_TRACKER_PIXEL_STAGE, slot, 1, &binding);
 }
 
-ConstantBuffer::~ConstantBuffer() {
-	buffer->Release();
-}
\ No newline at end of file
+uint64_t ConstantBufferBase::takeUploadedBytes()
+{
+    uint64_t bytes = uploadedBytes;
+    uploadedBytes = 0;
+    return bytes;
+}
+
+ConstantBufferBase::~ConstantBufferBase() {
+	device->releaseBuffer(buffer);
+}
@@ -1,18 +1,71 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <d3d11.h>
+#include <cstring>
+#include <type_traits>
+#include "../Engine/Device/GraphicsDevice.h"
 
-class ConstantBuffer
+/*
+ * HLSL packs cbuffer members into 16 byte registers, a member may only cross a register boundary when it starts at one
+ */
+#define CONSTANT_BUFFER_CHECK_PACKING(type, member) \
+	static_assert(offsetof(type, member) % 16 == 0 || offsetof(type, member) / 16 == \
+		(offsetof(type, member) + sizeof(((type*)nullptr)->member) - 1) / 16, \
+		#type "::" #member " straddles a 16 byte register")
+
+class ConstantBufferBase
+{
+protected:
+	ConstantBufferBase(GraphicsDevice* device, const void* initData, uint32_t dataSize, const char* bufferName);
+
+	GraphicsDevice* device;
+	GraphicsBuffer buffer;
+	uint32_t dataSize;
+	bool partialUpdates = false;
+	static uint64_t uploadedBytes;
+
+	/*
+	 * Range of 16 byte registers [firstRegister, endRegister) that differs, false when nothing does
+	 */
+	static bool findChangedRegisters(const void* pOld, const void* pNew, uint32_t size, uint32_t& firstRegister,
+		uint32_t& endRegister);
+	void upload(GraphicsContext* context, const void* pData, uint32_t firstRegister, uint32_t endRegister);
+public:
+	void bindToVertexShader(GraphicsContext* context, uint32_t slot = 0);
+	void bindToPixelShader(GraphicsContext* context, uint32_t slot = 0);
+	/*
+	 * Bytes every constant buffer uploaded since the previous call
+	 */
+	static uint64_t takeUploadedBytes();
+	~ConstantBufferBase();
+};
+
+/*
+ * Keeps a copy of the last uploaded T and only sends the registers that changed since, unchanged data costs a compare
+ */
+template <typename T>
+class ConstantBuffer : public ConstantBufferBase
 {
+	static_assert(sizeof(T) % 16 == 0, "Constant buffer data has to fill whole 16 byte registers");
+	static_assert(std::is_trivially_copyable<T>::value, "Constant buffer data is copied bytewise");
 public:
-	ConstantBuffer(ID3D11Device* device, void* initData, size_t initDataSize, const char* bufferName = nullptr);
+	ConstantBuffer(GraphicsDevice* device, const T& initData, const char* bufferName = nullptr)
+		: ConstantBufferBase(device, &initData, sizeof(T), bufferName), uploaded(initData)
+	{
+	}
 private:
-	ID3D11Buffer* buffer;
+	T uploaded;
 public:
-	void updateData(ID3D11DeviceContext* context, void* newData);
-	void bindToVertexShader(ID3D11DeviceContext* context, uint32_t slot = 0);
-	void bindToPixelShader(ID3D11DeviceContext* context, uint32_t slot = 0);
-	~ConstantBuffer();
+	void updateData(GraphicsContext* context, const T& newData)
+	{
+		uint32_t firstRegister;
+		uint32_t endRegister;
+		if (!findChangedRegisters(&uploaded, &newData, sizeof(T), firstRegister, endRegister))
+		{
+			return;
+		}
+		upload(context, &newData, firstRegister, endRegister);
+		uploaded = newData;
+	}
 };
-
@@ -0,0 +1,134 @@
+#include "ConstantRing.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    uint32_t alignToRing(uint32_t size)
+    {
+        return (size + CONSTANT_RING_ALIGNMENT - 1) & ~(uint32_t)(CONSTANT_RING_ALIGNMENT - 1);
+    }
+}
+
+ConstantRing::ConstantRing(GraphicsDevice* device, uint32_t capacity, const char* bufferName) : device(device),
+    allocator(alignToRing(capacity > 0 ? capacity : 1), CONSTANT_RING_ALIGNMENT)
+{
+    const GraphicsCapabilities& capabilities = device->getCapabilities();
+    if (!capabilities.constantBufferOffsets)
+    {
+        throw std::runtime_error("Constant buffer offsets are not supported");
+    }
+    noOverwriteSupported = capabilities.constantBufferNoOverwrite;
+
+    GraphicsBufferDesc bufferDesc;
+    bufferDesc.size = (uint32_t)allocator.getCapacity();
+    bufferDesc.bindFlags = GRAPHICS_BIND_CONSTANT_BUFFER;
+    bufferDesc.dynamic = true;
+    buffer = device->createBuffer(bufferDesc, nullptr, bufferName);
+    for (auto& fence : fences)
+    {
+        fence = device->createFence();
+    }
+}
+
+void ConstantRing::map(GraphicsContext* context)
+{
+    pollFences(context, false);
+    if (!noOverwriteSupported)
+    {
+        discardNextMap = true;
+    }
+    if (discardNextMap)
+    {
+        // The driver renames the memory, the GPU keeps reading the old copy
+        allocator.reset();
+    }
+    pMappedData = (uint8_t*)context->map(buffer.buffer, discardNextMap ? GRAPHICS_MAP_WRITE_DISCARD
+                                                                       : GRAPHICS_MAP_WRITE_NO_OVERWRITE);
+    discardNextMap = false;
+    mappedContext = context;
+}
+
+ConstantRingAllocation ConstantRing::push(const void* data, uint32_t size)
+{
+    if (!pMappedData)
+    {
+        throw std::runtime_error("Constant ring is not mapped");
+    }
+    uint32_t alignedSize = alignToRing(size);
+    uint64_t offset = allocator.allocate(alignedSize);
+    while (offset == RING_SUBALLOCATOR_FULL && allocator.hasPendingFrames())
+    {
+        pollFences(mappedContext, true);
+        offset = allocator.allocate(alignedSize);
+    }
+    if (offset == RING_SUBALLOCATOR_FULL)
+    {
+        throw std::runtime_error("Constant ring is too small for one frame");
+    }
+    memcpy(pMappedData + offset, data, size);
+    return {(uint32_t)(offset / 16), alignedSize / 16};
+}
+
+void ConstantRing::unmap()
+{
+    mappedContext->unmap(buffer.buffer);
+    mappedContext = nullptr;
+    pMappedData = nullptr;
+}
+
+void ConstantRing::endFrame(GraphicsContext* context)
+{
+    uint64_t frame = frameIndex + 1;
+    // The fence of this frame is still pending for the frame CONSTANT_RING_FENCES_AMOUNT earlier
+    while (completedFrame + CONSTANT_RING_FENCES_AMOUNT < frame)
+    {
+        pollFences(context, true);
+    }
+    context->signalFence(fences[frame % CONSTANT_RING_FENCES_AMOUNT]);
+    allocator.finishFrame(frame);
+    frameIndex = frame;
+}
+
+void ConstantRing::bindToVertexShader(GraphicsContext* context, const ConstantRingAllocation& allocation,
+                                      uint32_t slot)
+{
+    StateConstantBuffer binding = {buffer.buffer, allocation.firstConstant, allocation.constantsAmount};
+    context->setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, slot, 1, &binding);
+}
+
+void ConstantRing::bindToPixelShader(GraphicsContext* context, const ConstantRingAllocation& allocation,
+                                     uint32_t slot)
+{
+    StateConstantBuffer binding = {buffer.buffer, allocation.firstConstant, allocation.constantsAmount};
+    context->setConstantBuffers(STATE_TRACKER_PIXEL_STAGE, slot, 1, &binding);
+}
+
+uint64_t ConstantRing::getUsedBytes() const
+{
+    return allocator.getUsedBytes();
+}
+
+void ConstantRing::pollFences(GraphicsContext* context, bool wait)
+{
+    while (completedFrame < frameIndex)
+    {
+        if (!context->isFenceDone(fences[(completedFrame + 1) % CONSTANT_RING_FENCES_AMOUNT], wait))
+        {
+            break;
+        }
+        completedFrame++;
+        // Waiting is only needed for the oldest frame, the rest is picked up when already done
+        wait = false;
+    }
+    allocator.releaseCompleted(completedFrame);
+}
+
+ConstantRing::~ConstantRing()
+{
+    for (auto fence : fences)
+    {
+        device->releaseFence(fence);
+    }
+    device->releaseBuffer(buffer);
+}
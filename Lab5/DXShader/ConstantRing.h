@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include "../Engine/Device/GraphicsDevice.h"
+#include "../Utils/RingSuballocator.h"
+
+// Constant buffer offsets and sizes are counted in 16 byte constants and have to be multiples of 16 of them
+#define CONSTANT_RING_ALIGNMENT 256
+#define CONSTANT_RING_FENCES_AMOUNT 8
+
+struct ConstantRingAllocation
+{
+    uint32_t firstConstant = 0;
+    uint32_t constantsAmount = 0;
+};
+
+/*
+ * Per frame constants packed into one large dynamic buffer. map opens the whole buffer once per frame with
+ * GRAPHICS_MAP_WRITE_NO_OVERWRITE, push copies constants into space the GPU no longer reads and the draws bind their
+ * window of the buffer (*SSetConstantBuffers1 on D3D11). Frames are fenced, space comes back once the GPU passed the
+ * frame that used it. Devices without NO_OVERWRITE on constant buffers get a WRITE_DISCARD map and a fresh ring
+ * every frame.
+ */
+class ConstantRing
+{
+public:
+    ConstantRing(GraphicsDevice* device, uint32_t capacity, const char* bufferName = nullptr);
+
+private:
+    GraphicsDevice* device;
+    GraphicsBuffer buffer;
+    StateHandle fences[CONSTANT_RING_FENCES_AMOUNT] = {};
+    RingSuballocator allocator;
+    bool noOverwriteSupported = false;
+    bool discardNextMap = true;
+    GraphicsContext* mappedContext = nullptr;
+    uint8_t* pMappedData = nullptr;
+    uint64_t frameIndex = 0;
+    uint64_t completedFrame = 0;
+
+public:
+    /*
+     * Opens the buffer for push, on the immediate context
+     */
+    void map(GraphicsContext* context);
+    ConstantRingAllocation push(const void* data, uint32_t size);
+
+    template <typename T>
+    ConstantRingAllocation push(const T& data)
+    {
+        return push(&data, sizeof(T));
+    }
+
+    /*
+     * Closes the buffer before anything draws with this frame's constants
+     */
+    void unmap();
+    /*
+     * Fences this frame's constants after every draw that uses them was submitted
+     */
+    void endFrame(GraphicsContext* context);
+
+    void bindToVertexShader(GraphicsContext* context, const ConstantRingAllocation& allocation, uint32_t slot = 0);
+    void bindToPixelShader(GraphicsContext* context, const ConstantRingAllocation& allocation, uint32_t slot = 0);
+    uint64_t getUsedBytes() const;
+    ~ConstantRing();
+
+private:
+    /*
+     * Releases the frames the GPU finished, with wait blocks until the oldest pending one is done
+     */
+    void pollFences(GraphicsContext* context, bool wait);
+};
@@ -1,5 +1,8 @@
 #include "D3DInclude.h"
 
+#include <algorithm>
+#include "../Utils/ThreadCounters.h"
+
 HRESULT D3DInclude::Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes) {
     FILE* pFile = nullptr;
     fopen_s(&pFile, pFileName, "rb");
@@ -12,16 +15,25 @@ HRESULT D3DInclude::Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID
     fseek(pFile, 0, SEEK_SET);
 
     char* buffer = new char[size];
-    fread(buffer, 1, size, pFile);
+    size_t bytesRead = fread(buffer, 1, size, pFile);
     fclose(pFile);
+    ThreadCounting::addBytesRead(bytesRead);
 
     *ppData = buffer;
     *pBytes = size;
 
+    if (std::find(openedFiles.begin(), openedFiles.end(), pFileName) == openedFiles.end()) {
+        openedFiles.push_back(pFileName);
+    }
+
     return S_OK;
 }
 
 HRESULT D3DInclude::Close(LPCVOID pData) {
-    free(const_cast<void*>(pData));
+    delete[] (const char*)pData;
     return S_OK;
+}
+
+const std::vector<std::string>& D3DInclude::getOpenedFiles() const {
+    return openedFiles;
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <fstream>
+#include <string>
+#include <vector>
 #include <d3dcompiler.h>
 
 class D3DInclude : public ID3DInclude {
@@ -8,4 +10,12 @@ public:
     HRESULT __stdcall Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes);
 
     HRESULT __stdcall Close(LPCVOID pData);
+
+    /*
+     * Every file successfully opened by the compiler, in the order of the first open
+     */
+    const std::vector<std::string>& getOpenedFiles() const;
+
+private:
+    std::vector<std::string> openedFiles;
 };
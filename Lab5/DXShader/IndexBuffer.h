@@ -1,47 +1,38 @@
 #pragma once
 
-#include <d3d11.h>
-#include <string>
-#include <stdexcept>
+#include <cstdint>
+#include "../Engine/Device/GraphicsDevice.h"
 
 class IndexBuffer
 {
-    friend class Shader;
-
 public:
-    IndexBuffer(ID3D11Device* device, uint32_t* indices, uint32_t indicesCount, const char* bufferName = nullptr) : device(device),
-        indexCount(indicesCount)
+    IndexBuffer(GraphicsDevice* device, const uint32_t* indices, uint32_t indicesCount,
+                const char* bufferName = nullptr) : device(device), indexCount(indicesCount)
     {
-        D3D11_BUFFER_DESC iBufferDesc;
-        memset(&iBufferDesc, 0, sizeof(iBufferDesc));
-        iBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        iBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-        iBufferDesc.ByteWidth = sizeof(DWORD) * indicesCount;
-
-        D3D11_SUBRESOURCE_DATA indexData;
-        indexData.pSysMem = indices;
-        if (!FAILED(device->CreateBuffer(&iBufferDesc, &indexData, &buffer)))
-        {
-#if defined(_DEBUG)
-            if (bufferName)
-            {
-                buffer->SetPrivateData(WKPDID_D3DDebugObjectName, strlen(bufferName) * sizeof(char), bufferName);
-            }
-#endif
-        }else
-        {
-            throw std::runtime_error("Failed to create index buffer");
-        }
+        GraphicsBufferDesc bufferDesc;
+        bufferDesc.size = sizeof(uint32_t) * indicesCount;
+        bufferDesc.bindFlags = GRAPHICS_BIND_INDEX_BUFFER;
+        buffer = device->createBuffer(bufferDesc, indices, bufferName);
     }
 
 private:
-    ID3D11Buffer* buffer = nullptr;
-    ID3D11Device* device;
-    unsigned int indexCount;
+    GraphicsBuffer buffer;
+    GraphicsDevice* device;
+    uint32_t indexCount;
 
 public:
+    void bind(GraphicsContext* context)
+    {
+        context->setIndexBuffer(buffer.buffer, GRAPHICS_FORMAT_R32_UINT, 0);
+    }
+
+    uint32_t getIndexCount() const
+    {
+        return indexCount;
+    }
+
     ~IndexBuffer()
     {
-        buffer->Release();
+        device->releaseBuffer(buffer);
     }
 };
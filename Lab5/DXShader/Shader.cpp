@@ -1,51 +1,138 @@
 #include "Shader.h"
 #include <map>
 #include <iostream>
+#include <chrono>
+#include <cstring>
 #include "D3DInclude.h"
+#include "ShaderPack.h"
+#include "../Utils/FileSystemUtils.h"
+
+namespace
+{
+    const char* getShaderTarget(ShaderType shaderType)
+    {
+        return shaderType == VERTEX_SHADER ? "vs_5_0" : "ps_5_0";
+    }
+
+    ID3DBlob* makeBlob(const void* pBytecode, size_t size)
+    {
+        ID3DBlob* blob = nullptr;
+        if (FAILED(D3DCreateBlob(size, &blob)))
+        {
+            throw std::runtime_error("Failed to allocate shader blob");
+        }
+        memcpy(blob->GetBufferPointer(), pBytecode, size);
+        return blob;
+    }
+
+    ID3DBlob* makeBlob(const std::vector<uint8_t>& bytecode)
+    {
+        return makeBlob(bytecode.data(), bytecode.size());
+    }
+
+    CompiledShaderStage compileStage(const ShaderStageRequest& request)
+    {
+        std::vector<D3D_SHADER_MACRO> macros;
+        for (auto& define : request.defines)
+        {
+            macros.push_back({define.first.c_str(), define.second.c_str()});
+        }
+        macros.push_back({nullptr, nullptr});
+        CompiledShaderStage stage;
+        ID3DBlob* blob = Shader::compileShader(request.sourcePath.c_str(), macros.data(), request.entryPoint.c_str(),
+                                               request.target.c_str(), &stage.includedFiles,
+                                               request.allowPrecompiled);
+        const uint8_t* pBytecode = (const uint8_t*)blob->GetBufferPointer();
+        stage.bytecode.assign(pBytecode, pBytecode + blob->GetBufferSize());
+        blob->Release();
+        return stage;
+    }
+}
 
 Shader* Shader::loadShader(ID3D11Device* device, ShaderCreateInfo* pCreateInfos, uint32_t shaderAmount)
 {
-    std::map<ShaderType, ID3DBlob*> shadersBinaries;
-    ID3DBlob* errorBlob = nullptr;
-    ID3DBlob* tempBlob = nullptr;
-    uint32_t compileFlags = 0;
-    uint32_t vertexShaderIndex = 0;
-    uint32_t pixelShaderIndex = 0;
-#if defined(_DEBUG)
-    compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-    D3DInclude includeObj;
+    std::vector<ID3DBlob*> binaries(shaderAmount);
     for (uint32_t i = 0; i < shaderAmount; i++)
     {
-        if (FAILED(
-            D3DCompileFromFile(pCreateInfos[i].pathToShader, nullptr, &includeObj, "main", pCreateInfos[i].shaderType ==
-                VERTEX_SHADER ? "vs_5_0" : "ps_5_0", compileFlags, NULL, &tempBlob,
-                &errorBlob)))
+        binaries[i] = compileShader(pCreateInfos[i].pathToShader, pCreateInfos[i].defines, "main",
+                                    getShaderTarget(pCreateInfos[i].shaderType));
+    }
+    return createShader(device, pCreateInfos, binaries.data(), shaderAmount);
+}
+
+std::shared_future<Shader*> Shader::loadShaderAsync(ID3D11Device* device, const ShaderCreateInfo* pCreateInfos,
+                                                    uint32_t shaderAmount, const ShaderVertexInput* pInputs,
+                                                    uint32_t inputsAmount)
+{
+    return buildProgram(device, describeProgram(pCreateInfos, shaderAmount, pInputs, inputsAmount));
+}
+
+ShaderProgramDesc Shader::describeProgram(const ShaderCreateInfo* pCreateInfos, uint32_t shaderAmount,
+                                          const ShaderVertexInput* pInputs, uint32_t inputsAmount)
+{
+    ShaderProgramDesc programDesc;
+    programDesc.stages.resize(shaderAmount);
+    for (uint32_t i = 0; i < shaderAmount; i++)
+    {
+        programDesc.stages[i].sourcePath = pCreateInfos[i].pathToShader;
+        for (const D3D_SHADER_MACRO* define = pCreateInfos[i].defines; define && define->Name; define++)
         {
-            if (errorBlob != nullptr)
-            {
-                for (size_t i = 0; i < errorBlob->GetBufferSize(); i += sizeof(char))
-                {
-                    std::cerr << *(((char*)errorBlob->GetBufferPointer()) + i);
-                }
-                std::cerr << std::endl;
-            }
-            throw std::runtime_error("Failed to compile shader");
+            programDesc.stages[i].defines.emplace_back(define->Name, define->Definition ? define->Definition : "");
         }
-        if (tempBlob == nullptr)
+        programDesc.stages[i].target = getShaderTarget(pCreateInfos[i].shaderType);
+        programDesc.shaderTypes.push_back(pCreateInfos[i].shaderType);
+        programDesc.shaderNames.push_back(pCreateInfos[i].shaderName ? pCreateInfos[i].shaderName : "");
+    }
+    programDesc.vertexInputs.assign(pInputs, pInputs + inputsAmount);
+    return programDesc;
+}
+
+std::shared_future<Shader*> Shader::buildProgram(ID3D11Device* device, const ShaderProgramDesc& programDesc)
+{
+    return getBuildQueue().buildProgram<Shader*>(programDesc.stages, [device, programDesc](
+        const std::vector<ShaderStageResult>& stages)
         {
-            throw std::runtime_error("Failed to compile shader");
-        }
+            return createProgram(device, programDesc, stages);
+        });
+}
+
+Shader* Shader::createProgram(ID3D11Device* device, const ShaderProgramDesc& programDesc,
+                              const std::vector<ShaderStageResult>& stages)
+{
+    std::vector<ShaderCreateInfo> createInfos(stages.size());
+    std::vector<ID3DBlob*> binaries(stages.size());
+    for (uint32_t i = 0; i < stages.size(); i++)
+    {
+        createInfos[i].pathToShader = nullptr;
+        createInfos[i].shaderType = programDesc.shaderTypes[i];
+        createInfos[i].shaderName = programDesc.shaderNames[i].empty() ? nullptr : programDesc.shaderNames[i].c_str();
+        binaries[i] = makeBlob(stages[i]->bytecode);
+    }
+    Shader* shader = createShader(device, createInfos.data(), binaries.data(), (uint32_t)binaries.size());
+    if (!programDesc.vertexInputs.empty())
+    {
+        shader->makeInputLayout(device, programDesc.vertexInputs.data(), (uint32_t)programDesc.vertexInputs.size());
+    }
+    return shader;
+}
+
+Shader* Shader::createShader(ID3D11Device* device, const ShaderCreateInfo* pCreateInfos, ID3DBlob** pBinaries,
+                             uint32_t shaderAmount)
+{
+    std::map<ShaderType, ID3DBlob*> shadersBinaries;
+    uint32_t vertexShaderIndex = 0;
+    uint32_t pixelShaderIndex = 0;
+    for (uint32_t i = 0; i < shaderAmount; i++)
+    {
         if (pCreateInfos[i].shaderType == VERTEX_SHADER)
         {
             vertexShaderIndex = i;
         }
         else if (pCreateInfos[i].shaderType == PIXEL_SHADER)
         {
-            pixelShaderIndex == i;
+            pixelShaderIndex = i;
         }
-        shadersBinaries[pCreateInfos[i].shaderType] = tempBlob;
-        tempBlob = nullptr;
+        shadersBinaries[pCreateInfos[i].shaderType] = pBinaries[i];
     }
     ID3D11VertexShader* vertexShader;
     ID3D11PixelShader* pixelShader;
@@ -73,13 +160,118 @@ Shader* Shader::loadShader(ID3D11Device* device, ShaderCreateInfo* pCreateInfos,
     if (pCreateInfos[pixelShaderIndex].shaderName)
     {
         pixelShader->SetPrivateData(WKPDID_D3DDebugObjectName,
-                                    strlen(pCreateInfos[pixelShaderIndex].shaderName) * sizeof(wchar_t),
+                                    strlen(pCreateInfos[pixelShaderIndex].shaderName) * sizeof(char),
                                     pCreateInfos[pixelShaderIndex].shaderName);
     }
 #endif
     return new Shader(vertexShader, pixelShader, shadersBinaries[VERTEX_SHADER], shadersBinaries[PIXEL_SHADER]);
 }
 
+ID3DBlob* Shader::compileShader(const wchar_t* pathToShader, const D3D_SHADER_MACRO* defines, const char* entryPoint,
+                                const char* target, std::vector<std::string>* pIncludedFilesOutput,
+                                bool allowPrecompiled)
+{
+    uint32_t compileFlags = 0;
+#if defined(_DEBUG)
+    compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+    ShaderCacheRequest request;
+    for (const wchar_t* symbol = pathToShader; *symbol; symbol++)
+    {
+        request.sourcePath.push_back((char)*symbol);
+    }
+    for (const D3D_SHADER_MACRO* define = defines; define && define->Name; define++)
+    {
+        request.defines.emplace_back(define->Name, define->Definition ? define->Definition : "");
+    }
+    request.entryPoint = entryPoint;
+    request.target = target;
+    request.flags = compileFlags;
+    request.compilerTag = std::to_string(D3D_COMPILER_VERSION);
+
+#if !defined(_DEBUG)
+    // The pack holds Release bytecode only, Debug builds always compile with debug information
+    const ShaderPackReader* pPack = allowPrecompiled ? getPack() : nullptr;
+    if (pPack)
+    {
+        const uint8_t* pPackedBytecode = nullptr;
+        size_t packedSize = 0;
+        if (pPack->find(ShaderPack::makeKey(request.sourcePath, request.defines, entryPoint, target), &pPackedBytecode,
+                        &packedSize))
+        {
+            return makeBlob(pPackedBytecode, packedSize);
+        }
+        std::cerr << request.sourcePath << " (" << target << ") is missing from " SHADER_PACK_FILE_NAME
+            ", add it to Shaders/ShaderPack.txt" << std::endl;
+    }
+#endif
+
+    ID3DBlob* blob = nullptr;
+    std::vector<uint8_t> bytecode;
+    if (getCache().load(request, bytecode, pIncludedFilesOutput))
+    {
+        return makeBlob(bytecode);
+    }
+
+    auto compileStart = std::chrono::steady_clock::now();
+    ID3DBlob* errorBlob = nullptr;
+    D3DInclude includeObj;
+    if (FAILED(D3DCompileFromFile(pathToShader, defines, &includeObj, entryPoint, target, compileFlags, NULL, &blob,
+        &errorBlob)) || blob == nullptr)
+    {
+        if (errorBlob != nullptr)
+        {
+            for (size_t i = 0; i < errorBlob->GetBufferSize(); i += sizeof(char))
+            {
+                std::cerr << *(((char*)errorBlob->GetBufferPointer()) + i);
+            }
+            std::cerr << std::endl;
+            errorBlob->Release();
+        }
+        throw std::runtime_error("Failed to compile shader");
+    }
+    double compileMilliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - compileStart).count();
+    getCache().store(request, includeObj.getOpenedFiles(), blob->GetBufferPointer(), blob->GetBufferSize(),
+                     compileMilliseconds);
+    if (pIncludedFilesOutput)
+    {
+        *pIncludedFilesOutput = includeObj.getOpenedFiles();
+    }
+    return blob;
+}
+
+const ShaderPackReader* Shader::getPack()
+{
+    static ShaderPackReader pack;
+    static bool packLoaded = []()
+    {
+        std::wstring directory = FileSystemUtils::getCurrentDirectoryPath();
+        try
+        {
+            return pack.open(std::string(directory.begin(), directory.end()) + SHADER_PACK_FILE_NAME);
+        }
+        catch (const std::exception& exception)
+        {
+            std::cerr << SHADER_PACK_FILE_NAME ": " << exception.what() << std::endl;
+            return false;
+        }
+    }();
+    return packLoaded ? &pack : nullptr;
+}
+
+ShaderCache& Shader::getCache()
+{
+    static ShaderCache cache(SHADER_CACHE_DIRECTORY);
+    return cache;
+}
+
+ShaderBuildQueue& Shader::getBuildQueue()
+{
+    static ShaderBuildQueue queue(compileStage, JobSystem::getShared());
+    return queue;
+}
+
 Shader::Shader(ID3D11VertexShader* vertexShader, ID3D11PixelShader* pixelShader,
                ID3DBlob* vertexShaderData, ID3DBlob* pixelShaderData) : vertexShader(vertexShader),
                                                                         pixelShader(pixelShader),
@@ -88,7 +280,7 @@ Shader::Shader(ID3D11VertexShader* vertexShader, ID3D11PixelShader* pixelShader,
 {
 }
 
-void Shader::makeInputLayout(ID3D11Device* device, ShaderVertexInput* pInputs, uint32_t inputsAmount)
+void Shader::makeInputLayout(ID3D11Device* device, const ShaderVertexInput* pInputs, uint32_t inputsAmount)
 {
     if (shaderInputs.empty())
     {
@@ -114,23 +306,46 @@ void Shader::makeInputLayout(ID3D11Device* device, ShaderVertexInput* pInputs, u
 
 
 
-void Shader::bind(ID3D11DeviceContext* deviceContext)
+void Shader::bind(GraphicsContext* context)
+{
+    context->setShader(STATE_TRACKER_VERTEX_STAGE, vertexShader);
+    context->setShader(STATE_TRACKER_PIXEL_STAGE, pixelShader);
+}
+
+void Shader::draw(GraphicsContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer)
+{
+    bindGeometry(context, indexBuffer, vertexBuffer);
+    context->drawIndexed(indexBuffer->getIndexCount(), 0, 0);
+}
+
+void Shader::drawInstanced(GraphicsContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer,
+                           uint32_t instanceCount)
+{
+    bindGeometry(context, indexBuffer, vertexBuffer);
+    context->drawIndexedInstanced(indexBuffer->getIndexCount(), instanceCount, 0, 0, 0);
+}
+
+GraphicsProgram Shader::getProgram() const
 {
-    deviceContext->VSSetShader(vertexShader, nullptr, 0);
-    deviceContext->PSSetShader(pixelShader, nullptr, 0);
+    return {vertexShader, pixelShader, inputLayout};
 }
 
-void Shader::draw(ID3D11DeviceContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer)
+void Shader::bindGeometry(GraphicsContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer)
 {
-    UINT stride = vertexBuffer->vertexSize;
-    UINT offset = 0;
+    vertexBuffer->bind(context);
+    context->setInputLayout(inputLayout);
+    indexBuffer->bind(context);
+    context->setPrimitiveTopology(GRAPHICS_TOPOLOGY_TRIANGLE_LIST);
+}
 
-    context->IASetVertexBuffers(0, 1, &vertexBuffer->buffer,
-                                &stride, &offset);
-    context->IASetInputLayout(inputLayout);
-    context->IASetIndexBuffer(indexBuffer->buffer, DXGI_FORMAT_R32_UINT, 0);
-    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->DrawIndexed(indexBuffer->indexCount, 0, 0);
+void Shader::swap(Shader& other)
+{
+    std::swap(pixelShader, other.pixelShader);
+    std::swap(vertexShader, other.vertexShader);
+    std::swap(shaderInputs, other.shaderInputs);
+    std::swap(vertexShaderData, other.vertexShaderData);
+    std::swap(pixelShaderData, other.pixelShaderData);
+    std::swap(inputLayout, other.inputLayout);
 }
 
 Shader::~Shader()
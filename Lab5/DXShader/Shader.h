@@ -3,9 +3,16 @@
 #include <d3dcompiler.h>
 #include <d3d11.h>
 #include <cstdint>
+#include <future>
 #include <vector>
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "ShaderCache.h"
+#include "ShaderPack.h"
+#include "ShaderBuildQueue.h"
+#include "../Engine/Device/GraphicsContext.h"
+
+#define SHADER_CACHE_DIRECTORY "ShaderCache"
 
 enum ShaderType {
 	VERTEX_SHADER,
@@ -16,6 +23,7 @@ struct ShaderCreateInfo {
 	const wchar_t* pathToShader;
 	ShaderType shaderType;
 	const char* shaderName = nullptr;
+	const D3D_SHADER_MACRO* defines = nullptr;
 };
 
 
@@ -26,10 +34,48 @@ struct ShaderVertexInput {
 	DXGI_FORMAT inputFormat;
 };
 
+/*
+ * Owning copy of a ShaderCreateInfo set, enough to build the same shader again at any time
+ */
+struct ShaderProgramDesc {
+	std::vector<ShaderStageRequest> stages;
+	std::vector<ShaderType> shaderTypes;
+	std::vector<std::string> shaderNames;
+	std::vector<ShaderVertexInput> vertexInputs;
+};
+
 class Shader
 {
 public:
 	static Shader* loadShader(ID3D11Device* device, ShaderCreateInfo* pCreateInfos, uint32_t shaderAmount);
+	/*
+	 * Compiles the stages on the shader build queue and creates the shader (and input layout when inputs are given)
+	 * on a worker thread as soon as all of them are ready
+	 */
+	static std::shared_future<Shader*> loadShaderAsync(ID3D11Device* device, const ShaderCreateInfo* pCreateInfos, uint32_t shaderAmount,
+	                                                   const ShaderVertexInput* pInputs = nullptr, uint32_t inputsAmount = 0);
+	static ShaderProgramDesc describeProgram(const ShaderCreateInfo* pCreateInfos, uint32_t shaderAmount,
+	                                         const ShaderVertexInput* pInputs = nullptr, uint32_t inputsAmount = 0);
+	static std::shared_future<Shader*> buildProgram(ID3D11Device* device, const ShaderProgramDesc& programDesc);
+	/*
+	 * Creates the program from its compiled stages, given in the order of programDesc.stages
+	 */
+	static Shader* createProgram(ID3D11Device* device, const ShaderProgramDesc& programDesc,
+	                             const std::vector<ShaderStageResult>& stages);
+	static Shader* createShader(ID3D11Device* device, const ShaderCreateInfo* pCreateInfos, ID3DBlob** pBinaries, uint32_t shaderAmount);
+	/*
+	 * Returns the precompiled stage from the shader pack in Release builds, otherwise compiles it through the
+	 * bytecode cache, throws with the compiler output on failure.
+	 * pIncludedFilesOutput receives every file the stage included, stages taken from the pack report none.
+	 */
+	static ID3DBlob* compileShader(const wchar_t* pathToShader, const D3D_SHADER_MACRO* defines, const char* entryPoint, const char* target,
+	                               std::vector<std::string>* pIncludedFilesOutput = nullptr, bool allowPrecompiled = true);
+	/*
+	 * SHADER_PACK_FILE_NAME next to the executable, nullptr when it does not exist
+	 */
+	static const ShaderPackReader* getPack();
+	static ShaderCache& getCache();
+	static ShaderBuildQueue& getBuildQueue();
 public:
 	Shader(ID3D11VertexShader* vertexShader, ID3D11PixelShader* pixelShader, ID3DBlob* vertexShaderData, ID3DBlob* pixelShaderData);
 private:
@@ -40,9 +86,20 @@ private:
 	ID3DBlob* pixelShaderData;
 	ID3D11InputLayout* inputLayout = nullptr;
 public:
-	void makeInputLayout(ID3D11Device* device, ShaderVertexInput* pInputs, uint32_t inputsAmount);
-	void bind(ID3D11DeviceContext* deviceContext);
-	void draw(ID3D11DeviceContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer);
+	void makeInputLayout(ID3D11Device* device, const ShaderVertexInput* pInputs, uint32_t inputsAmount);
+	void bind(GraphicsContext* context);
+	void draw(GraphicsContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer);
+	void drawInstanced(GraphicsContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer, uint32_t instanceCount);
+	/*
+	 * Handles of the current GPU objects, they change when the shader is swapped
+	 */
+	GraphicsProgram getProgram() const;
+	/*
+	 * Exchanges the GPU objects of both shaders, pointers held to this shader keep working with the new code
+	 */
+	void swap(Shader& other);
 	~Shader();
+private:
+	void bindGeometry(GraphicsContext* context, IndexBuffer* indexBuffer, VertexBuffer* vertexBuffer);
 };
 
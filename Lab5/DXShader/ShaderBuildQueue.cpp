@@ -0,0 +1,118 @@
+#include "ShaderBuildQueue.h"
+
+ShaderBuildQueue::ShaderBuildQueue(Compiler compiler, JobSystem& jobs) : compiler(std::move(compiler)), jobs(jobs)
+{
+}
+
+std::shared_future<ShaderStageResult> ShaderBuildQueue::buildStage(const ShaderStageRequest& request)
+{
+    return findOrStartStage(request)->future;
+}
+
+void ShaderBuildQueue::invalidateStage(const ShaderStageRequest& request)
+{
+    std::lock_guard<std::mutex> lock(stagesMutex);
+    stages.erase(makeStageKey(request));
+}
+
+void ShaderBuildQueue::waitIdle()
+{
+    jobs.wait(pendingBuilds);
+}
+
+uint32_t ShaderBuildQueue::getCompiledStagesAmount() const
+{
+    return compiledStages.load();
+}
+
+uint32_t ShaderBuildQueue::getSharedStagesAmount() const
+{
+    return sharedStages.load();
+}
+
+ShaderBuildQueue::~ShaderBuildQueue()
+{
+    // Jobs still running reference the queue
+    waitIdle();
+}
+
+std::string ShaderBuildQueue::makeStageKey(const ShaderStageRequest& request)
+{
+    std::string key(request.sourcePath.begin(), request.sourcePath.end());
+    for (auto& define : request.defines)
+    {
+        key += '\n' + define.first + '=' + define.second;
+    }
+    key += '\n' + request.entryPoint + '\n' + request.target;
+    return key;
+}
+
+std::shared_ptr<ShaderBuildQueue::StageBuild> ShaderBuildQueue::findOrStartStage(const ShaderStageRequest& request)
+{
+    std::string key = makeStageKey(request);
+    std::shared_ptr<StageBuild> stage;
+    {
+        std::lock_guard<std::mutex> lock(stagesMutex);
+        auto found = stages.find(key);
+        if (found != stages.end())
+        {
+            sharedStages++;
+            return found->second;
+        }
+        stage = std::make_shared<StageBuild>();
+        stage->request = request;
+        stage->future = stage->promise.get_future().share();
+        stages[key] = stage;
+    }
+
+    jobs.submit([this, stage]()
+    {
+        ShaderStageResult result;
+        std::exception_ptr error;
+        try
+        {
+            result = std::make_shared<const CompiledShaderStage>(compiler(stage->request));
+            compiledStages++;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        std::vector<std::function<void(StageBuild&)>> continuations;
+        {
+            std::lock_guard<std::mutex> lock(stage->mutex);
+            stage->finished = true;
+            stage->result = result;
+            stage->error = error;
+            continuations.swap(stage->continuations);
+        }
+        if (error)
+        {
+            stage->promise.set_exception(error);
+        }
+        else
+        {
+            stage->promise.set_value(result);
+        }
+        for (auto& continuation : continuations)
+        {
+            continuation(*stage);
+        }
+    }, &pendingBuilds);
+    return stage;
+}
+
+void ShaderBuildQueue::whenStageFinished(const ShaderStageRequest& request,
+                                         std::function<void(StageBuild&)> continuation)
+{
+    std::shared_ptr<StageBuild> stage = findOrStartStage(request);
+    {
+        std::lock_guard<std::mutex> lock(stage->mutex);
+        if (!stage->finished)
+        {
+            stage->continuations.push_back(std::move(continuation));
+            return;
+        }
+    }
+    continuation(*stage);
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../Utils/JobSystem.h"
+
+struct ShaderStageRequest
+{
+    std::wstring sourcePath;
+    std::vector<std::pair<std::string, std::string>> defines;
+    std::string entryPoint = "main";
+    std::string target;
+    // Look the stage up in the shader pack before compiling, hot reload turns it off to pick up edited sources
+    bool allowPrecompiled = true;
+};
+
+struct CompiledShaderStage
+{
+    std::vector<uint8_t> bytecode;
+    std::vector<std::string> includedFiles;
+};
+
+typedef std::shared_ptr<const CompiledShaderStage> ShaderStageResult;
+
+/*
+ * Schedules shader stage compilations as jobs. Identical stage requests are compiled once and shared, a program
+ * runs its create callback as a job as soon as the last of its stages is compiled, so nothing blocks a worker while
+ * waiting for another job.
+ */
+class ShaderBuildQueue
+{
+public:
+    typedef std::function<CompiledShaderStage(const ShaderStageRequest& request)> Compiler;
+
+public:
+    ShaderBuildQueue(Compiler compiler, JobSystem& jobs);
+
+private:
+    struct StageBuild
+    {
+        // Read by the compile job, which only captures the build
+        ShaderStageRequest request;
+        std::promise<ShaderStageResult> promise;
+        std::mutex mutex;
+        bool finished = false;
+        ShaderStageResult result;
+        std::exception_ptr error;
+        std::vector<std::function<void(StageBuild&)>> continuations;
+        std::shared_future<ShaderStageResult> future;
+    };
+
+    Compiler compiler;
+    JobSystem& jobs;
+    // Stage compilations and program creations that did not finish yet
+    JobCounter pendingBuilds;
+    std::mutex stagesMutex;
+    std::map<std::string, std::shared_ptr<StageBuild>> stages;
+    std::atomic<uint32_t> compiledStages{0};
+    std::atomic<uint32_t> sharedStages{0};
+
+public:
+    std::shared_future<ShaderStageResult> buildStage(const ShaderStageRequest& request);
+
+    /*
+     * create receives the compiled stages in the order of stageRequests and runs as a job
+     */
+    template <typename T>
+    std::shared_future<T> buildProgram(const std::vector<ShaderStageRequest>& stageRequests,
+                                       std::function<T(const std::vector<ShaderStageResult>&)> create)
+    {
+        struct ProgramBuild
+        {
+            std::promise<T> promise;
+            std::vector<ShaderStageResult> stages;
+            std::atomic<uint32_t> remainingStages{0};
+            std::atomic<bool> failed{false};
+            std::function<T(const std::vector<ShaderStageResult>&)> create;
+        };
+        auto program = std::make_shared<ProgramBuild>();
+        program->stages.resize(stageRequests.size());
+        program->remainingStages = (uint32_t)stageRequests.size() + 1;
+        program->create = std::move(create);
+        std::shared_future<T> result = program->promise.get_future().share();
+
+        auto stageFinished = [this, program]()
+        {
+            if (--program->remainingStages == 0 && !program->failed)
+            {
+                jobs.submit([program]()
+                {
+                    try
+                    {
+                        program->promise.set_value(program->create(program->stages));
+                    }
+                    catch (...)
+                    {
+                        program->promise.set_exception(std::current_exception());
+                    }
+                }, &pendingBuilds);
+            }
+        };
+        for (uint32_t i = 0; i < stageRequests.size(); i++)
+        {
+            whenStageFinished(stageRequests[i], [program, i, stageFinished](StageBuild& stage)
+            {
+                if (stage.error)
+                {
+                    if (!program->failed.exchange(true))
+                    {
+                        program->promise.set_exception(stage.error);
+                    }
+                    return;
+                }
+                program->stages[i] = stage.result;
+                stageFinished();
+            });
+        }
+        // The extra count keeps the program from starting while continuations are still being registered
+        stageFinished();
+        return result;
+    }
+
+    /*
+     * Drops the shared result of a stage so the next request compiles it again, builds already waiting on it
+     * are not affected
+     */
+    void invalidateStage(const ShaderStageRequest& request);
+    /*
+     * Runs jobs on the calling thread until every build started so far finished
+     */
+    void waitIdle();
+    uint32_t getCompiledStagesAmount() const;
+    uint32_t getSharedStagesAmount() const;
+    ~ShaderBuildQueue();
+
+private:
+    static std::string makeStageKey(const ShaderStageRequest& request);
+    std::shared_ptr<StageBuild> findOrStartStage(const ShaderStageRequest& request);
+    void whenStageFinished(const ShaderStageRequest& request, std::function<void(StageBuild&)> continuation);
+};
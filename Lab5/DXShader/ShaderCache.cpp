@@ -0,0 +1,241 @@
+#include "ShaderCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "../Utils/ContentHash.h"
+#include "../Utils/ThreadCounters.h"
+
+namespace
+{
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::atomic<uint64_t> nextTemporaryFile{0};
+
+    /*
+     * Writes a sibling temporary file and renames it over path, so a reader or a crash never sees a partial file
+     * and two processes storing the same entry each replace it whole
+     */
+    bool replaceFile(const std::string& path, const void* pData, size_t size)
+    {
+        ContentHash tag;
+        tag.update((uint64_t)std::chrono::steady_clock::now().time_since_epoch().count());
+        tag.update((uint64_t)std::hash<std::thread::id>()(std::this_thread::get_id()));
+        tag.update(nextTemporaryFile++);
+        std::string temporaryPath = path + "." + ContentHash::toHex(tag.digest()) + ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.write((const char*)pData, (std::streamsize)size) || !(file.flush()))
+            {
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+        if (error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    struct ShaderCacheManifest
+    {
+        uint64_t contentKey = 0;
+        double compileMilliseconds = 0;
+        std::vector<std::string> includedFiles;
+    };
+
+    bool readManifest(const std::string& path, ShaderCacheManifest& manifestOutput)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+        std::string line;
+        int version = 0;
+        if (!std::getline(file, line) || sscanf(line.c_str(), "shadercache %d", &version) != 1 ||
+            version != SHADER_CACHE_VERSION)
+        {
+            return false;
+        }
+        if (!std::getline(file, line) || line.compare(0, 8, "content ") != 0)
+        {
+            return false;
+        }
+        // A damaged manifest is a miss, the next store replaces it
+        if (line.size() != 8 + 16 || line.find_first_not_of("0123456789abcdef", 8) != std::string::npos)
+        {
+            return false;
+        }
+        manifestOutput.contentKey = strtoull(line.c_str() + 8, nullptr, 16);
+        if (!std::getline(file, line) || sscanf(line.c_str(), "compile %lf", &manifestOutput.compileMilliseconds) != 1)
+        {
+            return false;
+        }
+        while (std::getline(file, line))
+        {
+            if (line.compare(0, 8, "include ") == 0)
+            {
+                manifestOutput.includedFiles.push_back(line.substr(8));
+            }
+        }
+        return true;
+    }
+}
+
+bool ShaderCache::readFile(const std::string& path, std::vector<uint8_t>& contentOutput)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    contentOutput.resize((size_t)size);
+    if (size != 0 && !file.read((char*)contentOutput.data(), size))
+    {
+        return false;
+    }
+    ThreadCounting::addBytesRead((uint64_t)size);
+    return true;
+}
+
+ShaderCache::ShaderCache(const std::string& directory) : directory(directory)
+{
+}
+
+bool ShaderCache::load(const ShaderCacheRequest& request, std::vector<uint8_t>& bytecodeOutput,
+                       std::vector<std::string>* pIncludedFilesOutput)
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t requestKey = hashRequest(request);
+    ShaderCacheManifest manifest;
+    uint64_t contentKey;
+    if (!readManifest(makePath(requestKey, ".manifest"), manifest) ||
+        !hashContent(requestKey, request.sourcePath, manifest.includedFiles, contentKey) ||
+        contentKey != manifest.contentKey || !readFile(makePath(contentKey, ".cso"), bytecodeOutput) ||
+        bytecodeOutput.empty())
+    {
+        misses++;
+        return false;
+    }
+    if (pIncludedFilesOutput)
+    {
+        *pIncludedFilesOutput = manifest.includedFiles;
+    }
+    hits++;
+    loadMicroseconds += (uint64_t)(millisecondsSince(start) * 1000.0);
+    savedMicroseconds += (uint64_t)(manifest.compileMilliseconds * 1000.0);
+    return true;
+}
+
+void ShaderCache::store(const ShaderCacheRequest& request, const std::vector<std::string>& includedFiles,
+                        const void* pBytecode, size_t bytecodeSize, double compileMilliseconds)
+{
+    compileMicroseconds += (uint64_t)(compileMilliseconds * 1000.0);
+    uint64_t requestKey = hashRequest(request);
+    uint64_t contentKey;
+    if (!hashContent(requestKey, request.sourcePath, includedFiles, contentKey))
+    {
+        return;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // Bytecode goes first, a manifest must never point at a blob that is not on disk yet
+    if (!replaceFile(makePath(contentKey, ".cso"), pBytecode, bytecodeSize))
+    {
+        return;
+    }
+
+    std::ostringstream manifest;
+    manifest << "shadercache " << SHADER_CACHE_VERSION << "\n";
+    manifest << "content " << ContentHash::toHex(contentKey) << "\n";
+    manifest << "compile " << compileMilliseconds << "\n";
+    for (auto& includedFile : includedFiles)
+    {
+        manifest << "include " << includedFile << "\n";
+    }
+    std::string manifestText = manifest.str();
+    replaceFile(makePath(requestKey, ".manifest"), manifestText.data(), manifestText.size());
+}
+
+ShaderCacheStats ShaderCache::getStats() const
+{
+    return {
+        hits.load(), misses.load(), loadMicroseconds.load() / 1000.0, compileMicroseconds.load() / 1000.0,
+        savedMicroseconds.load() / 1000.0
+    };
+}
+
+void ShaderCache::logStats() const
+{
+    ShaderCacheStats stats = getStats();
+    std::cout << "Shader cache: " << stats.hits << " hits, " << stats.misses << " misses, " <<
+        stats.compileMilliseconds << " ms compiling, " << stats.loadMilliseconds << " ms loading, " <<
+        stats.savedMilliseconds - stats.loadMilliseconds << " ms saved" << std::endl;
+}
+
+uint64_t ShaderCache::hashRequest(const ShaderCacheRequest& request)
+{
+    ContentHash hash;
+    hash.update((uint64_t)SHADER_CACHE_VERSION);
+    hash.update(request.sourcePath);
+    hash.update((uint64_t)request.defines.size());
+    for (auto& define : request.defines)
+    {
+        hash.update(define.first);
+        hash.update(define.second);
+    }
+    hash.update(request.entryPoint);
+    hash.update(request.target);
+    hash.update((uint64_t)request.flags);
+    hash.update(request.compilerTag);
+    return hash.digest();
+}
+
+bool ShaderCache::hashContent(uint64_t requestKey, const std::string& sourcePath,
+                              const std::vector<std::string>& includedFiles, uint64_t& contentKeyOutput)
+{
+    ContentHash hash;
+    hash.update(requestKey);
+    std::vector<uint8_t> content;
+    if (!readFile(sourcePath, content))
+    {
+        return false;
+    }
+    hash.update((uint64_t)content.size());
+    hash.update(content.data(), content.size());
+    for (auto& includedFile : includedFiles)
+    {
+        if (!readFile(includedFile, content))
+        {
+            return false;
+        }
+        hash.update(includedFile);
+        hash.update((uint64_t)content.size());
+        hash.update(content.data(), content.size());
+    }
+    contentKeyOutput = hash.digest();
+    return true;
+}
+
+std::string ShaderCache::makePath(uint64_t key, const char* extension) const
+{
+    return directory + "/" + ContentHash::toHex(key) + extension;
+}
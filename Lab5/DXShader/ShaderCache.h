@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define SHADER_CACHE_VERSION 1
+
+/*
+ * Everything that selects a compilation, the include files are discovered by the compiler and are not part of it
+ */
+struct ShaderCacheRequest
+{
+    std::string sourcePath;
+    std::vector<std::pair<std::string, std::string>> defines;
+    std::string entryPoint;
+    std::string target;
+    uint32_t flags = 0;
+    std::string compilerTag;
+};
+
+struct ShaderCacheStats
+{
+    uint32_t hits;
+    uint32_t misses;
+    double loadMilliseconds;
+    double compileMilliseconds;
+    // Compile time recorded for the entries that were served from the cache instead
+    double savedMilliseconds;
+};
+
+/*
+ * On-disk bytecode cache. Every request has a manifest named after the hash of the request that lists the include
+ * files of the last compilation, the bytecode itself is stored under the hash of the request plus the contents of
+ * the source and of every listed include, so editing any of them turns the lookup into a miss.
+ */
+class ShaderCache
+{
+public:
+    static bool readFile(const std::string& path, std::vector<uint8_t>& contentOutput);
+
+public:
+    explicit ShaderCache(const std::string& directory);
+
+private:
+    std::string directory;
+    std::atomic<uint32_t> hits{0};
+    std::atomic<uint32_t> misses{0};
+    std::atomic<uint64_t> loadMicroseconds{0};
+    std::atomic<uint64_t> compileMicroseconds{0};
+    std::atomic<uint64_t> savedMicroseconds{0};
+
+public:
+    /*
+     * Returns true and fills bytecodeOutput (and the include list of the entry when requested) when a valid entry
+     * exists, otherwise counts a miss
+     */
+    bool load(const ShaderCacheRequest& request, std::vector<uint8_t>& bytecodeOutput,
+              std::vector<std::string>* pIncludedFilesOutput = nullptr);
+    /*
+     * includedFiles are paths in the form the include handler opened them, compileMilliseconds is what a later
+     * hit reports as saved
+     */
+    void store(const ShaderCacheRequest& request, const std::vector<std::string>& includedFiles,
+               const void* pBytecode, size_t bytecodeSize, double compileMilliseconds);
+    ShaderCacheStats getStats() const;
+    void logStats() const;
+
+private:
+    static uint64_t hashRequest(const ShaderCacheRequest& request);
+    static bool hashContent(uint64_t requestKey, const std::string& sourcePath,
+                            const std::vector<std::string>& includedFiles, uint64_t& contentKeyOutput);
+    std::string makePath(uint64_t key, const char* extension) const;
+};
@@ -0,0 +1,67 @@
+#include "ShaderDependencyGraph.h"
+
+#include <filesystem>
+
+void ShaderDependencyGraph::setDependencies(uint32_t programId, const std::vector<std::string>& dependencies)
+{
+    removeProgram(programId);
+    for (auto& path : dependencies)
+    {
+        auto file = files.find(path);
+        if (file == files.end())
+        {
+            file = files.emplace(path, WatchedFile{readWriteTime(path), {}}).first;
+        }
+        file->second.programs.insert(programId);
+    }
+    programFiles[programId] = dependencies;
+}
+
+void ShaderDependencyGraph::removeProgram(uint32_t programId)
+{
+    auto program = programFiles.find(programId);
+    if (program == programFiles.end())
+    {
+        return;
+    }
+    for (auto& path : program->second)
+    {
+        auto file = files.find(path);
+        if (file != files.end())
+        {
+            file->second.programs.erase(programId);
+            if (file->second.programs.empty())
+            {
+                files.erase(file);
+            }
+        }
+    }
+    programFiles.erase(program);
+}
+
+std::vector<uint32_t> ShaderDependencyGraph::pollChanges()
+{
+    std::set<uint32_t> changedPrograms;
+    for (auto& file : files)
+    {
+        int64_t writeTime = readWriteTime(file.first);
+        if (writeTime != file.second.writeTime)
+        {
+            file.second.writeTime = writeTime;
+            changedPrograms.insert(file.second.programs.begin(), file.second.programs.end());
+        }
+    }
+    return std::vector<uint32_t>(changedPrograms.begin(), changedPrograms.end());
+}
+
+uint32_t ShaderDependencyGraph::getFilesAmount() const
+{
+    return (uint32_t)files.size();
+}
+
+int64_t ShaderDependencyGraph::readWriteTime(const std::string& path)
+{
+    std::error_code error;
+    auto writeTime = std::filesystem::last_write_time(path, error);
+    return error ? -1 : (int64_t)writeTime.time_since_epoch().count();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Maps source and include files to the programs built from them and detects edits by polling write times
+ */
+class ShaderDependencyGraph
+{
+private:
+    struct WatchedFile
+    {
+        int64_t writeTime;
+        std::set<uint32_t> programs;
+    };
+
+    std::map<std::string, WatchedFile> files;
+    std::map<uint32_t, std::vector<std::string>> programFiles;
+
+public:
+    /*
+     * Replaces the file list of the program, write times of newly watched files are taken as unchanged
+     */
+    void setDependencies(uint32_t programId, const std::vector<std::string>& dependencies);
+    void removeProgram(uint32_t programId);
+    /*
+     * Returns every program depending on a file written (or removed) since the previous poll
+     */
+    std::vector<uint32_t> pollChanges();
+    uint32_t getFilesAmount() const;
+
+private:
+    static int64_t readWriteTime(const std::string& path);
+};
@@ -0,0 +1,149 @@
+#include "ShaderHotReload.h"
+
+#include <iostream>
+
+namespace
+{
+    bool isReady(const std::shared_future<Shader*>& future)
+    {
+        return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+}
+
+ShaderHotReload::ShaderHotReload(ID3D11Device* device) : device(device), lastPoll(std::chrono::steady_clock::now())
+{
+}
+
+void ShaderHotReload::watch(const std::shared_future<Shader*>& shader, const ShaderProgramDesc& programDesc,
+                            ReloadCallback onReload)
+{
+    WatchedShader watchedShader;
+    watchedShader.shader = shader;
+    watchedShader.programDesc = programDesc;
+    watchedShader.onReload = std::move(onReload);
+    watchedShaders.push_back(std::move(watchedShader));
+}
+
+void ShaderHotReload::update()
+{
+    for (uint32_t i = 0; i < watchedShaders.size(); i++)
+    {
+        WatchedShader& watchedShader = watchedShaders[i];
+        if (!watchedShader.dependenciesKnown && isReady(watchedShader.shader) && !watchedShader.rebuild.valid())
+        {
+            updateDependencies(i);
+        }
+        if (!isReady(watchedShader.rebuild))
+        {
+            continue;
+        }
+        try
+        {
+            Shader* rebuiltShader = watchedShader.rebuild.get();
+            watchedShader.shader.get()->swap(*rebuiltShader);
+            delete rebuiltShader;
+            if (watchedShader.onReload)
+            {
+                watchedShader.onReload();
+            }
+        }
+        catch (const std::exception& exception)
+        {
+            std::cerr << "Shader reload failed, keeping the previous version: " << exception.what() << std::endl;
+        }
+        watchedShader.rebuild = std::shared_future<Shader*>();
+        // Includes may have changed with the edit
+        watchedShader.dependenciesKnown = false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll < std::chrono::milliseconds(SHADER_RELOAD_POLL_INTERVAL_MS))
+    {
+        return;
+    }
+    lastPoll = now;
+    for (uint32_t programId : dependencies.pollChanges())
+    {
+        watchedShaders[programId].reloadRequested = true;
+    }
+    startRebuilds();
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+    for (auto& watchedShader : watchedShaders)
+    {
+        if (watchedShader.rebuild.valid())
+        {
+            try
+            {
+                delete watchedShader.rebuild.get();
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+    }
+}
+
+void ShaderHotReload::updateDependencies(uint32_t index)
+{
+    WatchedShader& watchedShader = watchedShaders[index];
+    auto& stages = watchedShader.programDesc.stages;
+    std::vector<std::vector<std::string>> stageIncludes(stages.size());
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        std::shared_future<ShaderStageResult> stage = Shader::getBuildQueue().buildStage(stages[i]);
+        if (stage.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            // Another reload invalidated the shared stage, try again on a later frame instead of blocking
+            return;
+        }
+        try
+        {
+            stageIncludes[i] = stage.get()->includedFiles;
+        }
+        catch (const std::exception&)
+        {
+            // The broken edit may sit in an include, keep watching the includes of the last good compile so fixing
+            // it triggers the next rebuild
+            if (i < watchedShader.stageIncludes.size())
+            {
+                stageIncludes[i] = watchedShader.stageIncludes[i];
+            }
+        }
+    }
+    std::vector<std::string> files;
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        files.emplace_back(stages[i].sourcePath.begin(), stages[i].sourcePath.end());
+        files.insert(files.end(), stageIncludes[i].begin(), stageIncludes[i].end());
+    }
+    watchedShader.stageIncludes = std::move(stageIncludes);
+    dependencies.setDependencies(index, files);
+    watchedShader.dependenciesKnown = true;
+}
+
+void ShaderHotReload::startRebuilds()
+{
+    // Invalidate everything first so stages shared by several shaders are compiled once, not once per shader
+    for (auto& watchedShader : watchedShaders)
+    {
+        if (watchedShader.reloadRequested && !watchedShader.rebuild.valid())
+        {
+            for (auto& stageRequest : watchedShader.programDesc.stages)
+            {
+                stageRequest.allowPrecompiled = false;
+                Shader::getBuildQueue().invalidateStage(stageRequest);
+            }
+        }
+    }
+    for (auto& watchedShader : watchedShaders)
+    {
+        if (watchedShader.reloadRequested && !watchedShader.rebuild.valid())
+        {
+            watchedShader.reloadRequested = false;
+            watchedShader.rebuild = Shader::buildProgram(device, watchedShader.programDesc);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+#include "Shader.h"
+#include "ShaderDependencyGraph.h"
+
+#define SHADER_RELOAD_POLL_INTERVAL_MS 500
+
+/*
+ * Watches the sources and includes of registered shaders and rebuilds the affected ones on the shader build queue.
+ * Finished rebuilds are swapped into the existing Shader objects by update(), a failed rebuild keeps the old code.
+ */
+class ShaderHotReload
+{
+public:
+    typedef std::function<void()> ReloadCallback;
+
+public:
+    explicit ShaderHotReload(ID3D11Device* device);
+
+private:
+    struct WatchedShader
+    {
+        std::shared_future<Shader*> shader;
+        ShaderProgramDesc programDesc;
+        ReloadCallback onReload;
+        std::shared_future<Shader*> rebuild;
+        // Includes of every stage from its last successful compile
+        std::vector<std::vector<std::string>> stageIncludes;
+        bool dependenciesKnown = false;
+        bool reloadRequested = false;
+    };
+
+    ID3D11Device* device;
+    std::vector<WatchedShader> watchedShaders;
+    ShaderDependencyGraph dependencies;
+    std::chrono::steady_clock::time_point lastPoll;
+
+public:
+    /*
+     * onReload runs inside update() right after the new code was swapped in
+     */
+    void watch(const std::shared_future<Shader*>& shader, const ShaderProgramDesc& programDesc,
+               ReloadCallback onReload = nullptr);
+    /*
+     * Call once per frame on the render thread before anything is drawn
+     */
+    void update();
+    ~ShaderHotReload();
+
+private:
+    void updateDependencies(uint32_t index);
+    void startRebuilds();
+};
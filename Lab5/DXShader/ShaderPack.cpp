@@ -0,0 +1,226 @@
+#include "ShaderPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "../Utils/ContentHash.h"
+
+namespace
+{
+    uint64_t alignOffset(uint64_t offset)
+    {
+        return (offset + SHADER_PACK_ALIGNMENT - 1) / SHADER_PACK_ALIGNMENT * SHADER_PACK_ALIGNMENT;
+    }
+
+    std::vector<std::string> split(const std::string& value, char separator)
+    {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        for (size_t end = value.find(separator); end != std::string::npos; end = value.find(separator, start))
+        {
+            parts.push_back(value.substr(start, end - start));
+            start = end + 1;
+        }
+        parts.push_back(value.substr(start));
+        return parts;
+    }
+}
+
+uint64_t ShaderPack::makeKey(const std::string& sourcePath,
+                             const std::vector<std::pair<std::string, std::string>>& defines,
+                             const std::string& entryPoint, const std::string& target)
+{
+    ContentHash hash;
+    hash.update(std::string("shaderpack"));
+    hash.update(sourcePath);
+    hash.update((uint64_t)defines.size());
+    for (auto& define : defines)
+    {
+        hash.update(define.first);
+        hash.update(define.second);
+    }
+    hash.update(entryPoint);
+    hash.update(target);
+    return hash.digest();
+}
+
+bool ShaderPack::parseManifest(const std::string& text, std::vector<ShaderPackSource>& sourcesOutput,
+                               std::string& errorOutput)
+{
+    std::istringstream lines(text);
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(lines, line); lineNumber++)
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream tokens(line);
+        ShaderPackSource source;
+        if (!(tokens >> source.sourcePath))
+        {
+            continue;
+        }
+        if (!(tokens >> source.target))
+        {
+            errorOutput = "line " + std::to_string(lineNumber) + ": missing target for " + source.sourcePath;
+            return false;
+        }
+        std::vector<ShaderPackSource> expanded = {source};
+        std::string define;
+        while (tokens >> define)
+        {
+            size_t separator = define.find('=');
+            if (separator == 0 || separator == std::string::npos)
+            {
+                errorOutput = "line " + std::to_string(lineNumber) + ": expected NAME=VALUE, got " + define;
+                return false;
+            }
+            std::string name = define.substr(0, separator);
+            std::vector<std::string> values = split(define.substr(separator + 1), ',');
+            std::vector<ShaderPackSource> combinations;
+            for (auto& partial : expanded)
+            {
+                for (auto& value : values)
+                {
+                    combinations.push_back(partial);
+                    combinations.back().defines.emplace_back(name, value);
+                }
+            }
+            expanded = std::move(combinations);
+        }
+        sourcesOutput.insert(sourcesOutput.end(), expanded.begin(), expanded.end());
+    }
+    return true;
+}
+
+void ShaderPackWriter::add(uint64_t key, const void* pData, size_t size)
+{
+    for (auto& entry : entries)
+    {
+        if (entry.first == key)
+        {
+            throw std::runtime_error("Shader pack already contains key " + ContentHash::toHex(key));
+        }
+    }
+    const uint8_t* bytes = (const uint8_t*)pData;
+    entries.emplace_back(key, std::vector<uint8_t>(bytes, bytes + size));
+}
+
+std::vector<uint8_t> ShaderPackWriter::serialize() const
+{
+    std::vector<const std::pair<uint64_t, std::vector<uint8_t>>*> sortedEntries;
+    for (auto& entry : entries)
+    {
+        sortedEntries.push_back(&entry);
+    }
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [](auto* a, auto* b) { return a->first < b->first; });
+
+    ShaderPackHeader header{SHADER_PACK_MAGIC, SHADER_PACK_VERSION, (uint32_t)entries.size(), 0};
+    std::vector<ShaderPackEntry> tableOfContents;
+    uint64_t offset = alignOffset(sizeof(ShaderPackHeader) + sizeof(ShaderPackEntry) * entries.size());
+    for (auto* entry : sortedEntries)
+    {
+        tableOfContents.push_back({entry->first, offset, entry->second.size()});
+        offset = alignOffset(offset + entry->second.size());
+    }
+
+    std::vector<uint8_t> pack((size_t)offset, 0);
+    memcpy(pack.data(), &header, sizeof(header));
+    if (!tableOfContents.empty())
+    {
+        memcpy(pack.data() + sizeof(header), tableOfContents.data(),
+               sizeof(ShaderPackEntry) * tableOfContents.size());
+    }
+    for (size_t i = 0; i < sortedEntries.size(); i++)
+    {
+        if (!sortedEntries[i]->second.empty())
+        {
+            memcpy(pack.data() + tableOfContents[i].offset, sortedEntries[i]->second.data(),
+                   sortedEntries[i]->second.size());
+        }
+    }
+    return pack;
+}
+
+bool ShaderPackWriter::write(const std::string& path) const
+{
+    std::vector<uint8_t> pack = serialize();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file && file.write((const char*)pack.data(), pack.size());
+}
+
+bool ShaderPackReader::open(const std::string& path)
+{
+    if (!file.open(path))
+    {
+        return false;
+    }
+    openMemory(file.data(), file.size());
+    return true;
+}
+
+void ShaderPackReader::openMemory(const uint8_t* pPackData, size_t size)
+{
+    pData = nullptr;
+    dataSize = 0;
+    entries.clear();
+    ShaderPackHeader header;
+    if (size < sizeof(header))
+    {
+        throw std::runtime_error("Shader pack is truncated");
+    }
+    memcpy(&header, pPackData, sizeof(header));
+    if (header.magic != SHADER_PACK_MAGIC)
+    {
+        throw std::runtime_error("Not a shader pack");
+    }
+    if (header.version != SHADER_PACK_VERSION)
+    {
+        throw std::runtime_error("Unsupported shader pack version " + std::to_string(header.version));
+    }
+    if ((size - sizeof(header)) / sizeof(ShaderPackEntry) < header.entriesAmount)
+    {
+        throw std::runtime_error("Shader pack table of contents is truncated");
+    }
+    // Copied rather than cast in place, a pack in memory is only byte aligned
+    std::vector<ShaderPackEntry> tableOfContents(header.entriesAmount);
+    if (!tableOfContents.empty())
+    {
+        memcpy(tableOfContents.data(), pPackData + sizeof(header), sizeof(ShaderPackEntry) * tableOfContents.size());
+    }
+    for (uint32_t i = 0; i < header.entriesAmount; i++)
+    {
+        const ShaderPackEntry& entry = tableOfContents[i];
+        if (entry.offset > size || entry.size > size - entry.offset)
+        {
+            throw std::runtime_error("Shader pack entry " + std::to_string(i) + " is out of bounds");
+        }
+        if (i > 0 && tableOfContents[i - 1].key >= entry.key)
+        {
+            throw std::runtime_error("Shader pack table of contents is not sorted");
+        }
+    }
+    pData = pPackData;
+    dataSize = size;
+    entries = std::move(tableOfContents);
+}
+
+bool ShaderPackReader::find(uint64_t key, const uint8_t** ppBytecode, size_t* pSize) const
+{
+    auto found = std::lower_bound(entries.begin(), entries.end(), key, [](const ShaderPackEntry& entry, uint64_t value)
+    {
+        return entry.key < value;
+    });
+    if (found == entries.end() || found->key != key)
+    {
+        return false;
+    }
+    *ppBytecode = pData + found->offset;
+    *pSize = (size_t)found->size;
+    return true;
+}
+
+uint32_t ShaderPackReader::getEntriesAmount() const
+{
+    return (uint32_t)entries.size();
+}
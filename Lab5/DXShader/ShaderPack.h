@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../Utils/MappedFile.h"
+
+#define SHADER_PACK_MAGIC 0x4B505348 // "HSPK"
+#define SHADER_PACK_VERSION 1
+#define SHADER_PACK_ALIGNMENT 16
+#define SHADER_PACK_FILE_NAME "Shaders.pack"
+
+/*
+ * File layout: header, entriesAmount table of contents entries sorted by key, then the bytecode blobs, each one
+ * starting at a SHADER_PACK_ALIGNMENT aligned offset from the beginning of the file
+ */
+struct ShaderPackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entriesAmount;
+    uint32_t reserved;
+};
+
+struct ShaderPackEntry
+{
+    uint64_t key;
+    uint64_t offset;
+    uint64_t size;
+};
+
+/*
+ * One stage to precompile, as listed in the pack manifest
+ */
+struct ShaderPackSource
+{
+    std::string sourcePath;
+    std::string target;
+    std::vector<std::pair<std::string, std::string>> defines;
+};
+
+namespace ShaderPack
+{
+    /*
+     * Key of a stage inside the pack, built from the same values the runtime requests the stage with
+     */
+    uint64_t makeKey(const std::string& sourcePath, const std::vector<std::pair<std::string, std::string>>& defines,
+                     const std::string& entryPoint, const std::string& target);
+    /*
+     * Manifest lines are "<source path> <target> [NAME=VALUE[,VALUE...]]...", '#' starts a comment. A define with
+     * several comma separated values expands into one stage per value, several such defines into every combination.
+     * Returns false and a message with the line number on malformed input.
+     */
+    bool parseManifest(const std::string& text, std::vector<ShaderPackSource>& sourcesOutput,
+                       std::string& errorOutput);
+}
+
+class ShaderPackWriter
+{
+private:
+    std::vector<std::pair<uint64_t, std::vector<uint8_t>>> entries;
+
+public:
+    /*
+     * Throws when the key is already in the pack
+     */
+    void add(uint64_t key, const void* pData, size_t size);
+    std::vector<uint8_t> serialize() const;
+    bool write(const std::string& path) const;
+};
+
+/*
+ * Maps a pack and looks stages up with a binary search over the table of contents, blobs are returned in place.
+ * The table of contents is copied out, so the pack data needs no particular alignment.
+ */
+class ShaderPackReader
+{
+private:
+    MappedFile file;
+    const uint8_t* pData = nullptr;
+    size_t dataSize = 0;
+    std::vector<ShaderPackEntry> entries;
+
+public:
+    /*
+     * Returns false when the file is missing, throws when it exists but is not a valid pack
+     */
+    bool open(const std::string& path);
+    /*
+     * Uses a pack that is already in memory, pData must outlive the reader. Throws when it is not a valid pack.
+     */
+    void openMemory(const uint8_t* pPackData, size_t size);
+    bool find(uint64_t key, const uint8_t** ppBytecode, size_t* pSize) const;
+    uint32_t getEntriesAmount() const;
+};
@@ -0,0 +1,92 @@
+#include "ShaderPermutationCache.h"
+#include "ShaderHotReload.h"
+
+#include <stdexcept>
+
+ShaderPermutationCache::ShaderPermutationCache(ID3D11Device* device, const ShaderCreateInfo* pCreateInfos,
+                                               uint32_t shaderAmount, const ShaderVertexInput* pInputs,
+                                               uint32_t inputsAmount) : device(device),
+                                                                        createInfos(pCreateInfos,
+                                                                            pCreateInfos + shaderAmount),
+                                                                        vertexInputs(pInputs, pInputs + inputsAmount)
+{
+}
+
+void ShaderPermutationCache::addPermutation(const ShaderPermutation& permutation)
+{
+    permutations[permutation.key] = permutation;
+}
+
+void ShaderPermutationCache::setHotReload(ShaderHotReload* pHotReload)
+{
+    hotReload = pHotReload;
+}
+
+void ShaderPermutationCache::compileAll()
+{
+    for (auto& permutation : permutations)
+    {
+        if (!shaders.count(permutation.first))
+        {
+            shaders[permutation.first] = compile(permutation.second);
+        }
+    }
+}
+
+Shader* ShaderPermutationCache::getShader(uint32_t key)
+{
+    auto shader = shaders.find(key);
+    if (shader != shaders.end())
+    {
+        return shader->second.get();
+    }
+    auto permutation = permutations.find(key);
+    if (permutation == permutations.end())
+    {
+        throw std::runtime_error("Unknown shader permutation");
+    }
+    return (shaders[key] = compile(permutation->second)).get();
+}
+
+ShaderPermutationCache::~ShaderPermutationCache()
+{
+    for (auto& shader : shaders)
+    {
+        try
+        {
+            delete shader.second.get();
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+}
+
+std::shared_future<Shader*> ShaderPermutationCache::compile(const ShaderPermutation& permutation)
+{
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (auto& define : permutation.defines)
+    {
+        macros.push_back({define.first.c_str(), define.second.c_str()});
+    }
+    macros.push_back({nullptr, nullptr});
+
+    // describeProgram copies the defines, so the macros only have to outlive this call
+    std::vector<ShaderCreateInfo> permutationInfos = createInfos;
+    for (auto& info : permutationInfos)
+    {
+        if (info.shaderType == permutation.shaderType)
+        {
+            info.defines = macros.data();
+        }
+    }
+    ShaderProgramDesc programDesc = Shader::describeProgram(permutationInfos.data(),
+                                                            (uint32_t)permutationInfos.size(), vertexInputs.data(),
+                                                            (uint32_t)vertexInputs.size());
+    std::shared_future<Shader*> shader = Shader::buildProgram(device, programDesc);
+    if (hotReload)
+    {
+        hotReload->watch(shader, programDesc);
+    }
+    return shader;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+#include "Shader.h"
+
+class ShaderHotReload;
+
+/*
+ * The defines only reach the stage of shaderType, the other stages compile once and are shared by every permutation
+ */
+struct ShaderPermutation
+{
+    uint32_t key;
+    ShaderType shaderType;
+    std::vector<std::pair<std::string, std::string>> defines;
+};
+
+/*
+ * Compiles one Shader per permutation of preprocessor defines over the same sources and caches them by key,
+ * so mode switches are a lookup instead of a per-pixel branch.
+ */
+class ShaderPermutationCache
+{
+public:
+    ShaderPermutationCache(ID3D11Device* device, const ShaderCreateInfo* pCreateInfos, uint32_t shaderAmount,
+                           const ShaderVertexInput* pInputs, uint32_t inputsAmount);
+
+private:
+    ID3D11Device* device;
+    std::vector<ShaderCreateInfo> createInfos;
+    std::vector<ShaderVertexInput> vertexInputs;
+    std::map<uint32_t, ShaderPermutation> permutations;
+    std::map<uint32_t, std::shared_future<Shader*>> shaders;
+    ShaderHotReload* hotReload = nullptr;
+
+public:
+    void addPermutation(const ShaderPermutation& permutation);
+    /*
+     * Permutations compiled after this call are registered for hot reload
+     */
+    void setHotReload(ShaderHotReload* pHotReload);
+    /*
+     * Queues every registered permutation that is not built yet on the shader build queue and returns immediately
+     */
+    void compileAll();
+    /*
+     * Waits for the permutation if it is still being compiled
+     */
+    Shader* getShader(uint32_t key);
+    ~ShaderPermutationCache();
+
+private:
+    std::shared_future<Shader*> compile(const ShaderPermutation& permutation);
+};
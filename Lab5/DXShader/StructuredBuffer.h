@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "../Engine/Device/GraphicsDevice.h"
+
+class StructuredBuffer
+{
+public:
+    StructuredBuffer(GraphicsDevice* device, uint32_t elementSize, uint32_t elementCapacity,
+                     const char* bufferName = nullptr) : device(device), elementSize(elementSize),
+                                                         bufferName(bufferName)
+    {
+        create(elementCapacity);
+    }
+
+private:
+    GraphicsDevice* device;
+    GraphicsBuffer buffer;
+    uint32_t elementSize;
+    uint32_t elementCapacity = 0;
+    const char* bufferName;
+
+public:
+    /*
+     * Maps the buffer with WRITE_DISCARD so the caller can pack elements straight into it,
+     * the buffer grows when elementCount exceeds current capacity.
+     */
+    void* map(GraphicsContext* context, uint32_t elementCount)
+    {
+        if (elementCount > elementCapacity)
+        {
+            device->releaseBuffer(buffer);
+            create(elementCount > elementCapacity * 2 ? elementCount : elementCapacity * 2);
+        }
+        return context->map(buffer.buffer, GRAPHICS_MAP_WRITE_DISCARD);
+    }
+
+    void unmap(GraphicsContext* context)
+    {
+        context->unmap(buffer.buffer);
+    }
+
+    void updateData(GraphicsContext* context, const void* data, uint32_t elementCount)
+    {
+        void* mappedData = map(context, elementCount);
+        memcpy(mappedData, data, (size_t)elementCount * elementSize);
+        unmap(context);
+    }
+
+    void bindToVertexShader(GraphicsContext* context, uint32_t slot = 0)
+    {
+        context->setShaderResources(STATE_TRACKER_VERTEX_STAGE, slot, 1, &buffer.shaderResourceView);
+    }
+
+    void bindToPixelShader(GraphicsContext* context, uint32_t slot = 0)
+    {
+        context->setShaderResources(STATE_TRACKER_PIXEL_STAGE, slot, 1, &buffer.shaderResourceView);
+    }
+
+    uint32_t getCapacity() const
+    {
+        return elementCapacity;
+    }
+
+    ~StructuredBuffer()
+    {
+        device->releaseBuffer(buffer);
+    }
+
+private:
+    void create(uint32_t capacity)
+    {
+        elementCapacity = capacity > 0 ? capacity : 1;
+        GraphicsBufferDesc bufferDesc;
+        bufferDesc.size = elementSize * elementCapacity;
+        bufferDesc.bindFlags = GRAPHICS_BIND_SHADER_RESOURCE;
+        bufferDesc.stride = elementSize;
+        bufferDesc.dynamic = true;
+        buffer = device->createBuffer(bufferDesc, nullptr, bufferName);
+    }
+};
@@ -0,0 +1,300 @@
+#include "AssetDecoders.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "../tiny_obj_loader.h"
+#include "../../STB/stb_image.h"
+
+#define DDS_MAGIC 0x20534444u
+#define DDS_HEADER_SIZE 124u
+#define DDS_HEADER_DX10_SIZE 20u
+#define DDS_PIXEL_FORMAT_FOURCC 0x4u
+#define DDS_PIXEL_FORMAT_RGB 0x40u
+#define DDS_CAPS2_CUBEMAP 0x200u
+#define DDS_CAPS2_VOLUME 0x200000u
+#define DDS_DIMENSION_TEXTURE2D 3u
+#define DDS_MISC_TEXTURECUBE 0x4u
+
+namespace
+{
+    // Field offsets of DDS_HEADER in 32 bit words
+    enum DdsHeaderField
+    {
+        DDS_FIELD_HEIGHT = 2,
+        DDS_FIELD_WIDTH = 3,
+        DDS_FIELD_MIP_MAP_COUNT = 6,
+        DDS_FIELD_PIXEL_FLAGS = 19,
+        DDS_FIELD_FOURCC = 20,
+        DDS_FIELD_RGB_BIT_COUNT = 21,
+        DDS_FIELD_R_MASK = 22,
+        DDS_FIELD_G_MASK = 23,
+        DDS_FIELD_B_MASK = 24,
+        DDS_FIELD_A_MASK = 25,
+        DDS_FIELD_CAPS2 = 27
+    };
+
+    constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+    {
+        return (uint32_t)(uint8_t)a | (uint32_t)(uint8_t)b << 8 | (uint32_t)(uint8_t)c << 16 |
+            (uint32_t)(uint8_t)d << 24;
+    }
+
+    uint32_t readWord(const std::vector<uint8_t>& file, size_t offset)
+    {
+        uint32_t word;
+        memcpy(&word, file.data() + offset, sizeof(word));
+        return word;
+    }
+
+    DXGI_FORMAT getLegacyDdsFormat(const uint32_t* header)
+    {
+        uint32_t flags = header[DDS_FIELD_PIXEL_FLAGS];
+        if (flags & DDS_PIXEL_FORMAT_FOURCC)
+        {
+            switch (header[DDS_FIELD_FOURCC])
+            {
+            case makeFourCC('D', 'X', 'T', '1'):
+                return DXGI_FORMAT_BC1_UNORM;
+            case makeFourCC('D', 'X', 'T', '2'):
+            case makeFourCC('D', 'X', 'T', '3'):
+                return DXGI_FORMAT_BC2_UNORM;
+            case makeFourCC('D', 'X', 'T', '4'):
+            case makeFourCC('D', 'X', 'T', '5'):
+                return DXGI_FORMAT_BC3_UNORM;
+            case makeFourCC('A', 'T', 'I', '1'):
+            case makeFourCC('B', 'C', '4', 'U'):
+                return DXGI_FORMAT_BC4_UNORM;
+            case makeFourCC('B', 'C', '4', 'S'):
+                return DXGI_FORMAT_BC4_SNORM;
+            case makeFourCC('A', 'T', 'I', '2'):
+            case makeFourCC('B', 'C', '5', 'U'):
+                return DXGI_FORMAT_BC5_UNORM;
+            case makeFourCC('B', 'C', '5', 'S'):
+                return DXGI_FORMAT_BC5_SNORM;
+            // D3DFMT values written as FourCC
+            case 36:
+                return DXGI_FORMAT_R16G16B16A16_UNORM;
+            case 113:
+                return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case 114:
+                return DXGI_FORMAT_R32_FLOAT;
+            case 116:
+                return DXGI_FORMAT_R32G32B32A32_FLOAT;
+            default:
+                return DXGI_FORMAT_UNKNOWN;
+            }
+        }
+        if ((flags & DDS_PIXEL_FORMAT_RGB) && header[DDS_FIELD_RGB_BIT_COUNT] == 32)
+        {
+            uint32_t red = header[DDS_FIELD_R_MASK];
+            uint32_t alpha = header[DDS_FIELD_A_MASK];
+            if (red == 0x000000FFu && header[DDS_FIELD_G_MASK] == 0x0000FF00u && header[DDS_FIELD_B_MASK] ==
+                0x00FF0000u)
+            {
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            }
+            if (red == 0x00FF0000u && header[DDS_FIELD_G_MASK] == 0x0000FF00u && header[DDS_FIELD_B_MASK] ==
+                0x000000FFu)
+            {
+                return alpha ? DXGI_FORMAT_B8G8R8A8_UNORM : DXGI_FORMAT_B8G8R8X8_UNORM;
+            }
+        }
+        return DXGI_FORMAT_UNKNOWN;
+    }
+
+    /*
+     * Bytes per 4x4 block for block compressed formats, bytes per pixel otherwise, 0 for formats the decoder
+     * does not handle
+     */
+    uint32_t getFormatBytes(DXGI_FORMAT format, bool* pBlockCompressedOutput)
+    {
+        *pBlockCompressedOutput = false;
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            *pBlockCompressedOutput = true;
+            return 8;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            *pBlockCompressedOutput = true;
+            return 16;
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 16;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+        case DXGI_FORMAT_R32G32_FLOAT:
+            return 8;
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+        case DXGI_FORMAT_R16G16_FLOAT:
+        case DXGI_FORMAT_R32_FLOAT:
+            return 4;
+        case DXGI_FORMAT_R8G8_UNORM:
+        case DXGI_FORMAT_R16_FLOAT:
+            return 2;
+        case DXGI_FORMAT_R8_UNORM:
+            return 1;
+        default:
+            return 0;
+        }
+    }
+}
+
+void AssetDecoders::decodeObj(const std::vector<uint8_t>& file, MeshAsset& meshOutput)
+{
+    tinyobj::attrib_t attributes;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string error;
+    // Without a material reader mtllib lines are skipped, the engine assigns its own materials
+    std::istringstream stream(std::string((const char*)file.data(), file.size()));
+    if (!tinyobj::LoadObj(&attributes, &shapes, &materials, &error, &stream))
+    {
+        throw std::runtime_error("Failed to decode obj: " + error);
+    }
+
+    meshOutput.vertices.clear();
+    meshOutput.indices.clear();
+    uint32_t vertexIndex = 0;
+    for (auto& shape : shapes)
+    {
+        for (auto& index : shape.mesh.indices)
+        {
+            float vertex[MESH_ASSET_VERTEX_FLOATS] = {};
+            memcpy(vertex, &attributes.vertices[index.vertex_index * 3], sizeof(float) * 3);
+            if (index.texcoord_index >= 0)
+            {
+                memcpy(vertex + 3, &attributes.texcoords[index.texcoord_index * 2], sizeof(float) * 2);
+            }
+            if (index.normal_index >= 0)
+            {
+                memcpy(vertex + 5, &attributes.normals[index.normal_index * 3], sizeof(float) * 3);
+            }
+            meshOutput.vertices.insert(meshOutput.vertices.end(), vertex, vertex + MESH_ASSET_VERTEX_FLOATS);
+            meshOutput.indices.push_back(vertexIndex++);
+        }
+    }
+}
+
+void AssetDecoders::decodeStbImage(const std::vector<uint8_t>& file, ImageAsset& imageOutput)
+{
+    int width, height, componentsAmount;
+    bool hdr = stbi_is_hdr_from_memory(file.data(), (int)file.size()) != 0;
+    void* pixels = hdr
+                       ? (void*)stbi_loadf_from_memory(file.data(), (int)file.size(), &width, &height,
+                                                       &componentsAmount, 4)
+                       : (void*)stbi_load_from_memory(file.data(), (int)file.size(), &width, &height,
+                                                      &componentsAmount, 4);
+    if (!pixels)
+    {
+        throw std::runtime_error(std::string("Failed to decode image: ") + stbi_failure_reason());
+    }
+    uint32_t pixelSize = hdr ? sizeof(float) * 4 : 4;
+    imageOutput = ImageAsset();
+    imageOutput.width = (uint32_t)width;
+    imageOutput.height = (uint32_t)height;
+    imageOutput.format = hdr ? DXGI_FORMAT_R32G32B32A32_FLOAT : DXGI_FORMAT_R8G8B8A8_UNORM;
+    imageOutput.data.assign((const uint8_t*)pixels, (const uint8_t*)pixels + (size_t)width * height * pixelSize);
+    imageOutput.subresources.push_back({0, width * pixelSize, width * height * pixelSize});
+    stbi_image_free(pixels);
+}
+
+void AssetDecoders::decodeDds(const std::vector<uint8_t>& file, ImageAsset& imageOutput)
+{
+    if (file.size() < sizeof(uint32_t) + DDS_HEADER_SIZE || readWord(file, 0) != DDS_MAGIC)
+    {
+        throw std::runtime_error("Failed to decode dds: not a dds file");
+    }
+    uint32_t header[DDS_HEADER_SIZE / sizeof(uint32_t)];
+    memcpy(header, file.data() + sizeof(uint32_t), DDS_HEADER_SIZE);
+    size_t dataOffset = sizeof(uint32_t) + DDS_HEADER_SIZE;
+
+    imageOutput = ImageAsset();
+    imageOutput.width = header[DDS_FIELD_WIDTH];
+    imageOutput.height = header[DDS_FIELD_HEIGHT];
+    imageOutput.mipLevels = header[DDS_FIELD_MIP_MAP_COUNT] ? header[DDS_FIELD_MIP_MAP_COUNT] : 1;
+    if ((header[DDS_FIELD_PIXEL_FLAGS] & DDS_PIXEL_FORMAT_FOURCC) &&
+        header[DDS_FIELD_FOURCC] == makeFourCC('D', 'X', '1', '0'))
+    {
+        if (file.size() < dataOffset + DDS_HEADER_DX10_SIZE)
+        {
+            throw std::runtime_error("Failed to decode dds: truncated header");
+        }
+        imageOutput.format = (DXGI_FORMAT)readWord(file, dataOffset);
+        if (readWord(file, dataOffset + 4) != DDS_DIMENSION_TEXTURE2D)
+        {
+            throw std::runtime_error("Failed to decode dds: only 2D textures are supported");
+        }
+        imageOutput.cubemap = (readWord(file, dataOffset + 8) & DDS_MISC_TEXTURECUBE) != 0;
+        imageOutput.arraySize = readWord(file, dataOffset + 12);
+        imageOutput.arraySize = imageOutput.arraySize ? imageOutput.arraySize : 1;
+        imageOutput.arraySize *= imageOutput.cubemap ? 6 : 1;
+        dataOffset += DDS_HEADER_DX10_SIZE;
+    }
+    else
+    {
+        if (header[DDS_FIELD_CAPS2] & DDS_CAPS2_VOLUME)
+        {
+            throw std::runtime_error("Failed to decode dds: only 2D textures are supported");
+        }
+        imageOutput.format = getLegacyDdsFormat(header);
+        // Legacy cubemaps missing a face are rejected by the size check below
+        imageOutput.cubemap = (header[DDS_FIELD_CAPS2] & DDS_CAPS2_CUBEMAP) != 0;
+        imageOutput.arraySize = imageOutput.cubemap ? 6 : 1;
+    }
+
+    bool blockCompressed;
+    uint32_t formatBytes = getFormatBytes(imageOutput.format, &blockCompressed);
+    if (formatBytes == 0)
+    {
+        throw std::runtime_error("Failed to decode dds: unsupported format " +
+                                 std::to_string((uint32_t)imageOutput.format));
+    }
+    size_t offset = 0;
+    for (uint32_t slice = 0; slice < imageOutput.arraySize; slice++)
+    {
+        uint32_t width = imageOutput.width;
+        uint32_t height = imageOutput.height;
+        for (uint32_t mip = 0; mip < imageOutput.mipLevels; mip++)
+        {
+            uint32_t rowPitch, rowsAmount;
+            if (blockCompressed)
+            {
+                rowPitch = (width + 3) / 4 * formatBytes;
+                rowsAmount = (height + 3) / 4;
+            }
+            else
+            {
+                rowPitch = width * formatBytes;
+                rowsAmount = height;
+            }
+            imageOutput.subresources.push_back({offset, rowPitch, rowPitch * rowsAmount});
+            offset += (size_t)rowPitch * rowsAmount;
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+    }
+    if (file.size() < dataOffset + offset)
+    {
+        throw std::runtime_error("Failed to decode dds: truncated pixel data");
+    }
+    imageOutput.data.assign(file.begin() + dataOffset, file.begin() + dataOffset + offset);
+}
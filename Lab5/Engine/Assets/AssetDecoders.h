@@ -0,0 +1,55 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Floats per MeshAsset vertex: position, uv and normal
+#define MESH_ASSET_VERTEX_FLOATS 8u
+
+struct MeshAsset
+{
+    // Every OBJ face corner becomes its own vertex, indices run from 0 upwards
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+};
+
+struct ImageSubresource
+{
+    size_t offset;
+    uint32_t rowPitch;
+    uint32_t slicePitch;
+};
+
+struct ImageAsset
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipLevels = 1;
+    // Six faces per cube
+    uint32_t arraySize = 1;
+    bool cubemap = false;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    std::vector<uint8_t> data;
+    // Mips of array slice 0 first, the order D3D11 expects initial data in
+    std::vector<ImageSubresource> subresources;
+};
+
+/*
+ * CPU side decoding of asset files already read into memory, every decoder throws std::runtime_error on data it
+ * cannot handle and is safe to call from several threads at once
+ */
+namespace AssetDecoders
+{
+    void decodeObj(const std::vector<uint8_t>& file, MeshAsset& meshOutput);
+    /*
+     * Radiance HDR files decode to DXGI_FORMAT_R32G32B32A32_FLOAT, other stb_image formats to
+     * DXGI_FORMAT_R8G8B8A8_UNORM
+     */
+    void decodeStbImage(const std::vector<uint8_t>& file, ImageAsset& imageOutput);
+    /*
+     * Keeps the stored format and mips, uncompressed and block compressed 2D textures, arrays and cubemaps
+     */
+    void decodeDds(const std::vector<uint8_t>& file, ImageAsset& imageOutput);
+}
@@ -0,0 +1,180 @@
+#include "AssetManager.h"
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include "../../DXShader/Shader.h"
+#include "../../Utils/ThreadCounters.h"
+
+namespace
+{
+    double getMilliseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+    {
+        // Stages a load never reached keep the default time point
+        if (from == std::chrono::steady_clock::time_point() || to < from)
+        {
+            return 0;
+        }
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    const char* getTypeName(AssetType type)
+    {
+        switch (type)
+        {
+        case ASSET_TYPE_MESH:
+            return "mesh";
+        case ASSET_TYPE_IMAGE:
+            return "image";
+        default:
+            return "shader";
+        }
+    }
+
+    bool hasExtension(const std::string& path, const std::string& extension)
+    {
+        if (path.size() < extension.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < extension.size(); i++)
+        {
+            if (tolower((unsigned char)path[path.size() - extension.size() + i]) != extension[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+AssetManager::AssetManager(JobSystem& jobs, const std::string& rootDirectory)
+    : jobs(jobs), rootDirectory(rootDirectory)
+{
+}
+
+AssetHandle<MeshAssetResult> AssetManager::loadMesh(const std::string& path)
+{
+    return requestFile<MeshAssetResult>(path, ASSET_TYPE_MESH, [](const std::vector<uint8_t>& file)
+    {
+        auto mesh = std::make_shared<MeshAsset>();
+        AssetDecoders::decodeObj(file, *mesh);
+        return MeshAssetResult(mesh);
+    });
+}
+
+AssetHandle<ImageAssetResult> AssetManager::loadImage(const std::string& path)
+{
+    bool dds = hasExtension(path, ".dds");
+    return requestFile<ImageAssetResult>(path, ASSET_TYPE_IMAGE, [dds](const std::vector<uint8_t>& file)
+    {
+        auto image = std::make_shared<ImageAsset>();
+        if (dds)
+        {
+            AssetDecoders::decodeDds(file, *image);
+        }
+        else
+        {
+            AssetDecoders::decodeStbImage(file, *image);
+        }
+        return ImageAssetResult(image);
+    });
+}
+
+AssetHandle<Shader*> AssetManager::loadShader(ID3D11Device* device, const std::string& name,
+                                              const ShaderProgramDesc& programDesc)
+{
+    return request<Shader*>(name, ASSET_TYPE_SHADER, [device, &programDesc](TypedEntry<Shader*>& entry)
+    {
+        // The stages compile on the build queue, the phase only gets the time from request to the created shader
+        entry.startupPhase = StartupTimeline::getShared().addPhase("Shader " + entry.name);
+        TypedEntry<Shader*>* pEntry = &entry;
+        entry.future = Shader::getBuildQueue().buildProgram<Shader*>(programDesc.stages, [device, programDesc, pEntry](
+            const std::vector<ShaderStageResult>& stages)
+            {
+                Shader* shader = Shader::createProgram(device, programDesc, stages);
+                pEntry->finishedTime = Clock::now();
+                StartupTimeline::getShared().setPhaseTimes(pEntry->startupPhase, pEntry->requested,
+                                                           pEntry->finishedTime);
+                return shader;
+            });
+    });
+}
+
+std::vector<AssetLoadStats> AssetManager::getStats()
+{
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    std::vector<AssetLoadStats> stats(entries.size());
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        Entry& entry = *entries[i];
+        stats[i].name = entry.name;
+        stats[i].type = entry.type;
+        stats[i].finished = entry.isSettled();
+        if (!stats[i].finished)
+        {
+            continue;
+        }
+        stats[i].failed = entry.hasFailed();
+        stats[i].queuedMilliseconds = getMilliseconds(entry.requested, entry.readStarted);
+        stats[i].readMilliseconds = getMilliseconds(entry.readStarted, entry.readFinished);
+        stats[i].decodeMilliseconds = getMilliseconds(entry.readFinished, entry.finishedTime);
+        stats[i].totalMilliseconds = getMilliseconds(entry.requested, entry.finishedTime);
+    }
+    return stats;
+}
+
+uint32_t AssetManager::getSharedRequestsAmount() const
+{
+    return sharedRequests.load(std::memory_order_relaxed);
+}
+
+void AssetManager::logStats()
+{
+    std::vector<AssetLoadStats> stats = getStats();
+    std::cout << "Assets: " << stats.size() << " requested, " << getSharedRequestsAmount() << " shared requests" <<
+        std::endl;
+    for (auto& asset : stats)
+    {
+        std::cout << "  " << getTypeName(asset.type) << " " << asset.name << ": ";
+        if (!asset.finished || asset.failed)
+        {
+            std::cout << (asset.failed ? "failed" : "loading") << std::endl;
+            continue;
+        }
+        if (asset.type != ASSET_TYPE_SHADER)
+        {
+            std::cout << asset.queuedMilliseconds << " ms queued, " << asset.readMilliseconds << " ms reading, " <<
+                asset.decodeMilliseconds << " ms decoding, ";
+        }
+        std::cout << asset.totalMilliseconds << " ms total" << std::endl;
+    }
+}
+
+AssetManager::~AssetManager()
+{
+    for (auto& entry : entries)
+    {
+        jobs.wait(entry->loading);
+        // Shader builds run on the build queue, their last access to the entry happens before the result is set
+        entry->waitSettled();
+    }
+}
+
+bool AssetManager::readFile(const std::string& path, std::vector<uint8_t>& contentOutput)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        return false;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    contentOutput.resize((size_t)size);
+    if (size != 0 && !file.read((char*)contentOutput.data(), size))
+    {
+        return false;
+    }
+    ThreadCounting::addBytesRead((uint64_t)size);
+    return true;
+}
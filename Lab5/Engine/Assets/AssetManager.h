@@ -0,0 +1,305 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "AssetDecoders.h"
+#include "../Profiling/StartupTimeline.h"
+#include "../../Utils/JobSystem.h"
+
+#define ASSET_NO_HANDLE 0xFFFFFFFFu
+
+struct ID3D11Device;
+class Shader;
+struct ShaderProgramDesc;
+
+enum AssetType
+{
+    ASSET_TYPE_MESH,
+    ASSET_TYPE_IMAGE,
+    ASSET_TYPE_SHADER
+};
+
+typedef std::shared_ptr<const MeshAsset> MeshAssetResult;
+typedef std::shared_ptr<const ImageAsset> ImageAssetResult;
+
+/*
+ * T is what the load produces, handles of different asset types cannot be mixed up
+ */
+template <typename T>
+struct AssetHandle
+{
+    uint32_t index = ASSET_NO_HANDLE;
+
+    bool isValid() const
+    {
+        return index != ASSET_NO_HANDLE;
+    }
+};
+
+/*
+ * Milliseconds, filled once the load finished. Shader loads only report the total, a shader whose stages failed to
+ * compile reports none.
+ */
+struct AssetLoadStats
+{
+    std::string name;
+    AssetType type;
+    bool finished = false;
+    bool failed = false;
+    // Until a worker picked the read up
+    double queuedMilliseconds = 0;
+    double readMilliseconds = 0;
+    double decodeMilliseconds = 0;
+    double totalMilliseconds = 0;
+};
+
+/*
+ * Loads assets on the job system. A file is read by one job and decoded by the next, so the reads and decodes of
+ * every requested asset overlap with each other and with whatever the calling thread does meanwhile. Requesting a
+ * name again returns the handle of the first request. Nothing here touches the device context, the results are
+ * turned into GPU objects by the thread that owns it.
+ */
+class AssetManager
+{
+public:
+    /*
+     * Asset paths are relative to rootDirectory
+     */
+    AssetManager(JobSystem& jobs, const std::string& rootDirectory);
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        std::string name;
+        AssetType type;
+        // Jobs of this load that did not finish yet
+        JobCounter loading;
+        Clock::time_point requested;
+        Clock::time_point readStarted;
+        Clock::time_point readFinished;
+        // Written before the result is published
+        Clock::time_point finishedTime;
+        // Phases of the shared startup timeline, the load ends with startupPhase
+        uint32_t readPhase = STARTUP_NO_PHASE;
+        uint32_t startupPhase = STARTUP_NO_PHASE;
+
+        virtual ~Entry() = default;
+        virtual bool isSettled() const = 0;
+        virtual void waitSettled() const = 0;
+        virtual bool hasFailed() const = 0;
+    };
+
+    template <typename T>
+    struct TypedEntry : Entry
+    {
+        std::promise<T> promise;
+        std::shared_future<T> future;
+
+        bool isSettled() const override
+        {
+            return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+
+        void waitSettled() const override
+        {
+            future.wait();
+        }
+
+        bool hasFailed() const override
+        {
+            try
+            {
+                future.get();
+                return false;
+            }
+            catch (...)
+            {
+                return true;
+            }
+        }
+    };
+
+    JobSystem& jobs;
+    std::string rootDirectory;
+    std::mutex entriesMutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::map<std::string, uint32_t> entryIndices;
+    std::atomic<uint32_t> sharedRequests{0};
+
+public:
+    /*
+     * Wavefront OBJ
+     */
+    AssetHandle<MeshAssetResult> loadMesh(const std::string& path);
+    /*
+     * DDS by extension, everything else through stb_image
+     */
+    AssetHandle<ImageAssetResult> loadImage(const std::string& path);
+    /*
+     * Compiles the program on the shader build queue, the shader is created on the worker that finishes the last
+     * stage. The caller owns the shader.
+     */
+    AssetHandle<Shader*> loadShader(ID3D11Device* device, const std::string& name,
+                                    const ShaderProgramDesc& programDesc);
+
+    /*
+     * Runs jobs on the calling thread until the asset is loaded, rethrows the load error
+     */
+    template <typename T>
+    T get(AssetHandle<T> handle)
+    {
+        TypedEntry<T>& entry = getEntry(handle);
+        jobs.wait(entry.loading);
+        return entry.future.get();
+    }
+
+    template <typename T>
+    std::shared_future<T> getFuture(AssetHandle<T> handle)
+    {
+        return getEntry(handle).future;
+    }
+
+    template <typename T>
+    bool isReady(AssetHandle<T> handle)
+    {
+        return getEntry(handle).isSettled();
+    }
+
+    /*
+     * Phase the load finishes in, for startup work that waits on the asset to depend on
+     */
+    template <typename T>
+    uint32_t getStartupPhase(AssetHandle<T> handle)
+    {
+        return getEntry(handle).startupPhase;
+    }
+
+    std::vector<AssetLoadStats> getStats();
+    uint32_t getSharedRequestsAmount() const;
+    /*
+     * One line per asset with its latencies
+     */
+    void logStats();
+    /*
+     * Waits for every load so no job is left referencing the manager
+     */
+    ~AssetManager();
+
+private:
+    template <typename T>
+    TypedEntry<T>& getEntry(AssetHandle<T> handle)
+    {
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        return static_cast<TypedEntry<T>&>(*entries[handle.index]);
+    }
+
+    /*
+     * Returns the existing entry for name, otherwise creates one and calls start with it. start may replace the
+     * future of the entry.
+     */
+    template <typename T>
+    AssetHandle<T> request(const std::string& name, AssetType type, const std::function<void(TypedEntry<T>&)>& start)
+    {
+        AssetHandle<T> handle;
+        {
+            std::lock_guard<std::mutex> lock(entriesMutex);
+            std::string key = std::to_string((uint32_t)type) + ":" + name;
+            auto existing = entryIndices.find(key);
+            if (existing != entryIndices.end())
+            {
+                sharedRequests.fetch_add(1, std::memory_order_relaxed);
+                handle.index = existing->second;
+                return handle;
+            }
+            handle.index = (uint32_t)entries.size();
+            entryIndices[key] = handle.index;
+            entries.push_back(std::make_unique<TypedEntry<T>>());
+            TypedEntry<T>* entry = static_cast<TypedEntry<T>*>(entries.back().get());
+            entry->name = name;
+            entry->type = type;
+            entry->requested = Clock::now();
+            entry->future = entry->promise.get_future().share();
+            // start only queues work, so a concurrent request for the same name sees the final future
+            start(*entry);
+        }
+        return handle;
+    }
+
+    /*
+     * Reads the file in one job and hands its contents to decode in a second one
+     */
+    template <typename T>
+    AssetHandle<T> requestFile(const std::string& path, AssetType type,
+                               std::function<T(const std::vector<uint8_t>& file)> decode)
+    {
+        // Jobs capture little in place, the decoder is shared by pointer
+        auto pDecode = std::make_shared<std::function<T(const std::vector<uint8_t>& file)>>(std::move(decode));
+        return request<T>(path, type, [this, path, pDecode](TypedEntry<T>& entry)
+        {
+            StartupTimeline& timeline = StartupTimeline::getShared();
+            entry.readPhase = timeline.addPhase("Read " + path);
+            entry.startupPhase = timeline.addPhase("Decode " + path);
+            timeline.addDependency(entry.startupPhase, entry.readPhase);
+            TypedEntry<T>* pEntry = &entry;
+            jobs.submit([this, pEntry, pDecode]()
+            {
+                const std::string& path = pEntry->name;
+                StartupTimeline::getShared().beginPhase(pEntry->readPhase);
+                pEntry->readStarted = Clock::now();
+                auto file = std::make_shared<std::vector<uint8_t>>();
+                bool read = readFile(rootDirectory + path, *file);
+                StartupTimeline::getShared().endPhase(pEntry->readPhase);
+                if (!read)
+                {
+                    pEntry->readFinished = pEntry->readStarted;
+                    finish<T>(*pEntry, [&path]() -> T
+                    {
+                        throw std::runtime_error("Failed to read asset " + path);
+                    });
+                    return;
+                }
+                pEntry->readFinished = Clock::now();
+                jobs.submit([pEntry, file, pDecode]()
+                {
+                    StartupTimeline::getShared().beginPhase(pEntry->startupPhase);
+                    finish<T>(*pEntry, [&]()
+                    {
+                        return (*pDecode)(*file);
+                    });
+                    StartupTimeline::getShared().endPhase(pEntry->startupPhase);
+                }, &pEntry->loading);
+            }, &pEntry->loading);
+        });
+    }
+
+    template <typename T>
+    static void finish(TypedEntry<T>& entry, const std::function<T()>& produce)
+    {
+        try
+        {
+            T result = produce();
+            entry.finishedTime = Clock::now();
+            entry.promise.set_value(std::move(result));
+        }
+        catch (...)
+        {
+            entry.finishedTime = Clock::now();
+            entry.promise.set_exception(std::current_exception());
+        }
+    }
+
+    static bool readFile(const std::string& path, std::vector<uint8_t>& contentOutput);
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <DirectXMath.h>
+#include "CameraMath.h"
 #include "../../Window/WindowInputSystem.h"
 using namespace DirectX;
 
@@ -18,6 +19,8 @@ public:
         keys.push_back({ DIK_D, KEY_DOWN });
         keys.push_back({ DIK_C,  KEY_DOWN });
         keys.push_back({ DIK_SPACE, KEY_DOWN });
+        keys.push_back({ INPUT_MOUSE_RIGHT, KEY_PRESSED });
+        keys.push_back({ INPUT_MOUSE_RIGHT, KEY_UP });
 
         position = XMFLOAT3(-10.02, -0.09446, -0.76995);
         updateViewMatrix();
@@ -33,10 +36,13 @@ private:
     bool rotating = false;
     float oldPosX = 0;
     float oldPosY = 0;
+    float fovDegrees = 90.0f;
+    float nearPlane = 0.001f;
+    float farPlane = 2000.0f;
 public:
     void changePosition(float dx, float dy, float dz) {
-        focus = XMFLOAT3(focus.x + dx * cosf(phi) - dz * sinf(phi), focus.y + dy, focus.z + dx * sinf(phi) + dz * cosf(phi));
-        position = XMFLOAT3(position.x + dx * cosf(phi) - dz * sinf(phi), position.y + dy, position.z + dx * sinf(phi) + dz * cosf(phi));
+        focus = CameraMath::moveAlongHeading(focus, phi, dx, dy, dz);
+        position = CameraMath::moveAlongHeading(position, phi, dx, dy, dz);
 
         updateViewMatrix();
     }
@@ -45,9 +51,8 @@ public:
         if (r < 1.0f) {
             r = 1.0f;
         }
-        position = XMFLOAT3(focus.x - cosf(theta) * cosf(phi) * r,
-            focus.y - sinf(theta) * r,
-            focus.z - cosf(theta) * sinf(phi) * r);
+        XMFLOAT3 offset = CameraMath::orbitOffset(r, theta, phi);
+        position = XMFLOAT3(focus.x - offset.x, focus.y - offset.y, focus.z - offset.z);
 
         updateViewMatrix();
     }
@@ -59,9 +64,8 @@ public:
         phi -= dphi;
         theta -= dtheta;
         theta = min(max(theta, -XM_PIDIV2), XM_PIDIV2);
-        focus = XMFLOAT3(cosf(theta) * cosf(phi) * r + position.x,
-            sinf(theta) * r + position.y,
-            cosf(theta) * sinf(phi) * r + position.z);
+        XMFLOAT3 offset = CameraMath::orbitOffset(r, theta, phi);
+        focus = XMFLOAT3(position.x + offset.x, position.y + offset.y, position.z + offset.z);
 
         updateViewMatrix();
     }
@@ -70,42 +74,63 @@ public:
         return viewMatrix;
     }
 
-    void mouseMove(uint32_t x, uint32_t y) override {
+    XMMATRIX getProjectionMatrix(float aspectRatio) {
+        return CameraMath::projectionMatrix(fovDegrees, aspectRatio, nearPlane, farPlane);
+    }
+
+    float getFov() {
+        return fovDegrees;
+    }
+
+    float getNearPlane() {
+        return nearPlane;
+    }
+
+    float getFarPlane() {
+        return farPlane;
+    }
+
+    void mouseMove(int32_t x, int32_t y) override {
         if (rotating) {
             rotate((x-oldPosX)/100, (y-oldPosY)/100);
         }
         oldPosX = (float)x;
         oldPosY = (float)y;
     }
-    void mouseKey(uint32_t key) override {
-        rotating = key == WM_RBUTTONDOWN ? true : key == WM_RBUTTONUP ? false : rotating;
-    }
 
-    void keyEvent(WindowKey key) override {
+    void keyEvents(const WindowKey* pKeys, uint32_t keysAmount) override {
         float sens = 0.11f;
         float dx = 0,  dy = 0, dz = 0;
-        switch (key.key) {
-        case DIK_W:
-            dx = sens;
-            break;
-        case DIK_S:
-            dx = -1*sens;
-            break;
-        case DIK_A:
-            dz = sens;
-            break;
-        case DIK_D:
-            dz = -1*sens;
-            break;
-        case DIK_C:
-            dy = -1*sens;
-            break;
-        case DIK_SPACE:
-            dy = sens;
-        default:
-            break;
+        for (uint32_t i = 0; i < keysAmount; i++) {
+            switch (pKeys[i].key) {
+            case DIK_W:
+                dx += sens;
+                break;
+            case DIK_S:
+                dx -= sens;
+                break;
+            case DIK_A:
+                dz += sens;
+                break;
+            case DIK_D:
+                dz -= sens;
+                break;
+            case DIK_C:
+                dy -= sens;
+                break;
+            case DIK_SPACE:
+                dy += sens;
+                break;
+            case INPUT_MOUSE_RIGHT:
+                rotating = pKeys[i].action == KEY_PRESSED;
+                break;
+            default:
+                break;
+            }
+        }
+        if (dx != 0 || dy != 0 || dz != 0) {
+            changePosition(dx, dy, dz);
         }
-        changePosition(dx, dy, dz);
     }
     WindowKey* getKeys(uint32_t* pKeysAmountOut) override {
         *pKeysAmountOut = (uint32_t)keys.size();
@@ -114,14 +139,7 @@ public:
 
 private:
     void updateViewMatrix() {
-        float upTheta = theta + XM_PIDIV2;
-        XMFLOAT3 up = XMFLOAT3(cosf(upTheta) * cosf(phi), sinf(upTheta), cosf(upTheta) * sinf(phi));
-
-        viewMatrix = DirectX::XMMatrixLookAtLH(
-            DirectX::XMVectorSet(position.x, position.y, position.z, 0.0f),
-            DirectX::XMVectorSet(focus.x, focus.y, focus.z, 0.0f),
-            DirectX::XMVectorSet(up.x, up.y, up.z, 0.0f)
-        );
+        viewMatrix = CameraMath::viewMatrix(position, focus, theta, phi);
     }
 };
 
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cmath>
+#include <DirectXMath.h>
+
+/*
+ * The orbit and matrix math of Camera without its input handling, so tools off Windows can run and time it.
+ * phi turns around the vertical axis, theta is the pitch, both in radians.
+ */
+namespace CameraMath
+{
+    /*
+     * From the eye to the point it looks at, r away
+     */
+    inline DirectX::XMFLOAT3 orbitOffset(float r, float theta, float phi)
+    {
+        return DirectX::XMFLOAT3(cosf(theta) * cosf(phi) * r, sinf(theta) * r, cosf(theta) * sinf(phi) * r);
+    }
+
+    /*
+     * point moved dx forward, dy up and dz to the side of a camera heading phi
+     */
+    inline DirectX::XMFLOAT3 moveAlongHeading(const DirectX::XMFLOAT3& point, float phi, float dx, float dy,
+                                              float dz)
+    {
+        return DirectX::XMFLOAT3(point.x + dx * cosf(phi) - dz * sinf(phi), point.y + dy,
+                                 point.z + dx * sinf(phi) + dz * cosf(phi));
+    }
+
+    inline DirectX::XMMATRIX viewMatrix(const DirectX::XMFLOAT3& position, const DirectX::XMFLOAT3& focus,
+                                        float theta, float phi)
+    {
+        float upTheta = theta + DirectX::XM_PIDIV2;
+        return DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(position.x, position.y, position.z, 0.0f),
+                                         DirectX::XMVectorSet(focus.x, focus.y, focus.z, 0.0f),
+                                         DirectX::XMVectorSet(cosf(upTheta) * cosf(phi), sinf(upTheta),
+                                                              cosf(upTheta) * sinf(phi), 0.0f));
+    }
+
+    inline DirectX::XMMATRIX projectionMatrix(float fovDegrees, float aspectRatio, float nearPlane, float farPlane)
+    {
+        return DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(fovDegrees), aspectRatio, nearPlane,
+                                                 farPlane);
+    }
+}
@@ -1,9 +1,14 @@
 ﻿#pragma once
 
+#include "../DXShader/ConstantBuffer.h"
 #include "../DXShader/Shader.h"
+#include "../DXShader/ShaderHotReload.h"
 #include "../DXDevice/DXDevice.h"
-#include "../Utils/FileSystemUtils.h"
-#include "../STB/stb_image.h"
+#include "../DXDevice/DXProfilerAnnotation.h"
+#include "../DXDevice/DXResourceTracking.h"
+#include "Assets/AssetDecoders.h"
+
+#define CUBEMAP_GENERATOR_OWNER "Cubemap generator"
 
 struct HDRCubemap
 {
@@ -22,6 +27,15 @@ struct HDRCubemap
     ID3D11ShaderResourceView* brdfSRV;
 };
 
+enum CubemapStage
+{
+    CUBEMAP_STAGE_CONVERT = 1,
+    CUBEMAP_STAGE_IRRADIANCE = 2,
+    CUBEMAP_STAGE_PREFILTER = 4,
+    CUBEMAP_STAGE_BRDF = 8,
+    CUBEMAP_STAGES_ALL = 15
+};
+
 struct Quad
 {
     VertexBuffer* quadMeshVertex;
@@ -33,17 +47,26 @@ struct ViewMat
     XMMATRIX viewProjMatrix;
 };
 
+CONSTANT_BUFFER_CHECK_PACKING(ViewMat, viewProjMatrix);
+
 struct RoughnessBufferData
 {
     XMFLOAT4 roughness;
 };
 
+CONSTANT_BUFFER_CHECK_PACKING(RoughnessBufferData, roughness);
+
 class CubemapGenerator
 {
 public:
-    CubemapGenerator(DXDevice* device)
-        : device(device)
+    /*
+     * With pShaderReload the generator must outlive the reload service, edited IBL shaders then mark their
+     * stages for renderDirtyStages
+     */
+    CubemapGenerator(DXDevice* device, ShaderHotReload* pShaderReload = nullptr)
+        : device(device), shaderReload(pShaderReload)
     {
+        profilerAnnotation = new DXProfilerAnnotation(device->getDeviceContext());
         loadShaders();
         loadQuad();
         viewMatrices = {
@@ -78,8 +101,8 @@ public:
                 DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)
             ),
         };
-        viewProjMatrixBuff = new ConstantBuffer(device->getDevice(), &data, sizeof(ViewMat));
-        roughnessBuffer = new ConstantBuffer(device->getDevice(), &buffData, sizeof(RoughnessBufferData));
+        viewProjMatrixBuff = new ConstantBuffer<ViewMat>(device->getGraphicsDevice(), data);
+        roughnessBuffer = new ConstantBuffer<RoughnessBufferData>(device->getGraphicsDevice(), buffData);
         D3D11_SAMPLER_DESC desc = {};
         desc.Filter = D3D11_FILTER_ANISOTROPIC;
         desc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -102,89 +125,143 @@ private:
     Shader* irradianceGenerator = nullptr;
     Shader* prefilterShader = nullptr;
     Shader* brdfShader = nullptr;
+    std::shared_future<Shader*> cubemapConvertBuild;
+    std::shared_future<Shader*> irradianceBuild;
+    std::shared_future<Shader*> prefilterBuild;
+    std::shared_future<Shader*> brdfBuild;
+    ShaderHotReload* shaderReload;
+    uint32_t dirtyStages = 0;
+    uint32_t sideSize = 0;
+    uint32_t irradianceSideSize = 32;
+    uint32_t prefilteredSideSize = 128;
     DXDevice* device;
+    DXProfilerAnnotation* profilerAnnotation = nullptr;
 
 
     std::vector<Quad> quads;
 
     ID3D11SamplerState* sampler;
     std::vector<XMMATRIX> viewMatrices;
-    ConstantBuffer* viewProjMatrixBuff = nullptr;
-    ConstantBuffer* roughnessBuffer = nullptr;
+    ConstantBuffer<ViewMat>* viewProjMatrixBuff = nullptr;
+    ConstantBuffer<RoughnessBufferData>* roughnessBuffer = nullptr;
     ViewMat data{};
     RoughnessBufferData buffData{};
     XMMATRIX projectionMatrix = XMMatrixPerspectiveFovLH(XM_PI / 2, 1.0f, 0.1f, 10.0f);
     std::vector<float> prefilteredRoughness = { 0.0f, 0.25f, 0.5f, 0.75f, 1.0f };
 public:
-    void loadHDRCubemap(std::string name, HDRCubemap* pOutput)
+    /*
+     * source is an equirectangular DXGI_FORMAT_R32G32B32A32_FLOAT image
+     */
+    void loadHDRCubemap(const ImageAsset& source, HDRCubemap* pOutput)
     {
-        uint32_t sideSize = 0;
-        loadHDRMap(name, &sideSize, &pOutput->sourceTexture, &pOutput->sourceResourceView);
-        uint32_t irradianceSideSize = 32;
-        uint32_t prefilteredSideSize = 128;
-        ID3D11RenderTargetView* brdfRTV;
-        createCubemap(pOutput,  &brdfRTV, sideSize, irradianceSideSize, prefilteredSideSize);
-        DXRenderTargetView* rtv = new DXRenderTargetView(device->getDevice(), pOutput->cubemapTexture, sideSize,
-                                                         sideSize, 6, "Cube rendertarget view");
-        DXRenderTargetView* irradianceRTV = new DXRenderTargetView(device->getDevice(), pOutput->irradianceTexture,
-                                                                   sideSize,
-                                                                   sideSize, 6, "Cube rendertarget view");
-        renderCube(rtv, pOutput->sourceResourceView, sideSize);
-        renderIrradianceCube(irradianceRTV, pOutput->cubemapSRV, irradianceSideSize);
-        renderPrefilterMap(pOutput->prefilteredTexture, pOutput->cubemapSRV, prefilteredSideSize);
-        renderBRDF(brdfRTV, prefilteredSideSize);
-        rtv->destroy();
-        irradianceRTV->destroy();
-        brdfRTV->Release();
+        loadHDRMap(source, &sideSize, &pOutput->sourceTexture, &pOutput->sourceResourceView);
+        waitForShaders();
+        createCubemap(pOutput, sideSize, irradianceSideSize, prefilteredSideSize);
+        renderStages(pOutput, CUBEMAP_STAGES_ALL);
+    }
+
+    /*
+     * Re-renders the stages whose shaders were reloaded since the last call, the source texture of pCubemap
+     * has to be alive
+     */
+    void renderDirtyStages(HDRCubemap* pCubemap)
+    {
+        if (dirtyStages)
+        {
+            renderStages(pCubemap, dirtyStages);
+            dirtyStages = 0;
+        }
     }
 
 private:
+    void renderStages(HDRCubemap* pCubemap, uint32_t stages)
+    {
+        // Irradiance and prefiltered maps are computed from the converted cubemap
+        if (stages & CUBEMAP_STAGE_CONVERT)
+        {
+            PROFILE_ZONE_ANNOTATED("Convert cubemap", profilerAnnotation);
+            stages |= CUBEMAP_STAGE_IRRADIANCE | CUBEMAP_STAGE_PREFILTER;
+            DXRenderTargetView* rtv = new DXRenderTargetView(device->getDevice(), pCubemap->cubemapTexture, sideSize,
+                                                             sideSize, 6, "Cube rendertarget view");
+            renderCube(rtv, pCubemap->sourceResourceView, sideSize);
+            rtv->destroy();
+        }
+        if (stages & CUBEMAP_STAGE_IRRADIANCE)
+        {
+            PROFILE_ZONE_ANNOTATED("Irradiance map", profilerAnnotation);
+            DXRenderTargetView* irradianceRTV = new DXRenderTargetView(device->getDevice(),
+                                                                       pCubemap->irradianceTexture, sideSize,
+                                                                       sideSize, 6, "Cube rendertarget view");
+            renderIrradianceCube(irradianceRTV, pCubemap->cubemapSRV, irradianceSideSize);
+            irradianceRTV->destroy();
+        }
+        if (stages & CUBEMAP_STAGE_PREFILTER)
+        {
+            PROFILE_ZONE_ANNOTATED("Prefiltered map", profilerAnnotation);
+            renderPrefilterMap(pCubemap->prefilteredTexture, pCubemap->cubemapSRV, prefilteredSideSize);
+        }
+        if (stages & CUBEMAP_STAGE_BRDF)
+        {
+            PROFILE_ZONE_ANNOTATED("BRDF lookup", profilerAnnotation);
+            ID3D11RenderTargetView* brdfRTV;
+            if (FAILED(device->getDevice()->CreateRenderTargetView(pCubemap->brdfTexture, nullptr, &brdfRTV)))
+            {
+                throw std::runtime_error("Failed to create resulting brdf rtv");
+            }
+            trackView(brdfRTV, "BRDF lookup render target view", CUBEMAP_GENERATOR_OWNER);
+            renderBRDF(brdfRTV, prefilteredSideSize);
+            releaseTracked(brdfRTV);
+        }
+    }
+
     void renderCube(DXRenderTargetView* cubeRenderTargetView, ID3D11ShaderResourceView* pSourceResourceView,
                     uint32_t sideSize)
     {
+        DXStateContext* context = device->getStateContext();
         for (uint32_t i = 0; i < 6; i++)
         {
             cubeRenderTargetView->clearColorAttachments(device->getDeviceContext(), 0.25, 0.25, 0.25, 1.0, i);
-            cubeRenderTargetView->bind(device->getDeviceContext(), sideSize, sideSize, i, false);
-            cubemapConvertShader->bind(device->getDeviceContext());
-            device->getDeviceContext()->PSSetShaderResources(0, 1, &pSourceResourceView);
-            device->getDeviceContext()->PSSetSamplers(0, 1, &sampler);
-            device->getDeviceContext()->OMSetDepthStencilState(nullptr, 0);
-            device->getDeviceContext()->RSSetState(nullptr);
-            device->getDeviceContext()->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+            cubeRenderTargetView->bind(context, sideSize, sideSize, i, false);
+            cubemapConvertShader->bind(context);
+            context->setPixelShaderResources(0, 1, &pSourceResourceView);
+            context->setPixelSamplers(0, 1, &sampler);
+            context->setDepthStencilState(nullptr, 0);
+            context->setRasterizerState(nullptr);
+            context->setBlendState(nullptr, nullptr, 0xFFFFFFFF);
             data.viewProjMatrix = XMMatrixMultiply(viewMatrices[i], projectionMatrix);
-            viewProjMatrixBuff->updateData(device->getDeviceContext(), &data);
-            viewProjMatrixBuff->bindToVertexShader(device->getDeviceContext());
-            cubemapConvertShader->draw(device->getDeviceContext(), quads[i].quadMeshIndex, quads[i].quadMeshVertex);
+            viewProjMatrixBuff->updateData(context, data);
+            viewProjMatrixBuff->bindToVertexShader(context);
+            cubemapConvertShader->draw(context, quads[i].quadMeshIndex, quads[i].quadMeshVertex);
         }
-        DXDevice::unBindRenderTargets(device->getDeviceContext());
+        DXDevice::unBindRenderTargets(context);
     }
 
     void renderIrradianceCube(DXRenderTargetView* cubeRenderTargetView, ID3D11ShaderResourceView* pSourceResourceView,
                               uint32_t sideSize)
     {
+        DXStateContext* context = device->getStateContext();
         for (uint32_t i = 0; i < 6; i++)
         {
             cubeRenderTargetView->clearColorAttachments(device->getDeviceContext(), 0.25, 0.25, 0.25, 1.0, i);
-            cubeRenderTargetView->bind(device->getDeviceContext(), sideSize, sideSize, i, false);
-            irradianceGenerator->bind(device->getDeviceContext());
-            device->getDeviceContext()->PSSetShaderResources(0, 1, &pSourceResourceView);
-            device->getDeviceContext()->PSSetSamplers(0, 1, &sampler);
-            device->getDeviceContext()->OMSetDepthStencilState(nullptr, 0);
-            device->getDeviceContext()->RSSetState(nullptr);
-            device->getDeviceContext()->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+            cubeRenderTargetView->bind(context, sideSize, sideSize, i, false);
+            irradianceGenerator->bind(context);
+            context->setPixelShaderResources(0, 1, &pSourceResourceView);
+            context->setPixelSamplers(0, 1, &sampler);
+            context->setDepthStencilState(nullptr, 0);
+            context->setRasterizerState(nullptr);
+            context->setBlendState(nullptr, nullptr, 0xFFFFFFFF);
             data.viewProjMatrix = XMMatrixMultiply(viewMatrices[i], projectionMatrix);
-            viewProjMatrixBuff->updateData(device->getDeviceContext(), &data);
-            viewProjMatrixBuff->bindToVertexShader(device->getDeviceContext());
-            irradianceGenerator->draw(device->getDeviceContext(), quads[i].quadMeshIndex, quads[i].quadMeshVertex);
+            viewProjMatrixBuff->updateData(context, data);
+            viewProjMatrixBuff->bindToVertexShader(context);
+            irradianceGenerator->draw(context, quads[i].quadMeshIndex, quads[i].quadMeshVertex);
         }
-        DXDevice::unBindRenderTargets(device->getDeviceContext());
+        DXDevice::unBindRenderTargets(context);
     }
 
     void renderPrefilterMap(ID3D11Texture2D* cubemap, ID3D11ShaderResourceView* pSourceResourceView,
                             uint32_t sideSize)
     {
-        
+        DXStateContext* context = device->getStateContext();
         for (uint32_t i = 0; i < 6; i++)
         {
             size_t mipSize = sideSize;
@@ -192,7 +269,7 @@ private:
             {
 
                 auto rtv = createPrefilteredRTV(cubemap, i, j);
-                device->getDeviceContext()->OMSetRenderTargets(1, &rtv, nullptr);
+                context->setRenderTargets(1, &rtv, nullptr);
                 D3D11_VIEWPORT viewport;
                 viewport.TopLeftX = 0;
                 viewport.TopLeftY = 0;
@@ -200,31 +277,32 @@ private:
                 viewport.Height = mipSize;
                 viewport.MinDepth = 0.0f;
                 viewport.MaxDepth = 1.0f;
-                device->getDeviceContext()->RSSetViewports(1, &viewport);
-                prefilterShader->bind(device->getDeviceContext());
-                device->getDeviceContext()->PSSetShaderResources(0, 1, &pSourceResourceView);
-                device->getDeviceContext()->PSSetSamplers(0, 1, &sampler);
-                device->getDeviceContext()->OMSetDepthStencilState(nullptr, 0);
-                device->getDeviceContext()->RSSetState(nullptr);
+                context->setViewport(viewport);
+                prefilterShader->bind(context);
+                context->setPixelShaderResources(0, 1, &pSourceResourceView);
+                context->setPixelSamplers(0, 1, &sampler);
+                context->setDepthStencilState(nullptr, 0);
+                context->setRasterizerState(nullptr);
                 buffData.roughness =  XMFLOAT4(prefilteredRoughness[j], prefilteredRoughness[j], prefilteredRoughness[j], prefilteredRoughness[j]);
-                roughnessBuffer->updateData(device->getDeviceContext(), &buffData);
-                roughnessBuffer->bindToPixelShader(device->getDeviceContext());
-                device->getDeviceContext()->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
+                roughnessBuffer->updateData(context, buffData);
+                roughnessBuffer->bindToPixelShader(context);
+                context->setBlendState(nullptr, nullptr, 0xFFFFFFFF);
                 data.viewProjMatrix = XMMatrixMultiply(viewMatrices[i], projectionMatrix);
-                viewProjMatrixBuff->updateData(device->getDeviceContext(), &data);
-                viewProjMatrixBuff->bindToVertexShader(device->getDeviceContext());
-                prefilterShader->draw(device->getDeviceContext(), quads[i].quadMeshIndex, quads[i].quadMeshVertex);
-                rtv->Release();
+                viewProjMatrixBuff->updateData(context, data);
+                viewProjMatrixBuff->bindToVertexShader(context);
+                prefilterShader->draw(context, quads[i].quadMeshIndex, quads[i].quadMeshVertex);
+                releaseTracked(rtv);
                 mipSize>>=1;
             }
             
         }
-        DXDevice::unBindRenderTargets(device->getDeviceContext());
+        DXDevice::unBindRenderTargets(context);
     }
 
     void renderBRDF(ID3D11RenderTargetView* brdfRTV, uint32_t prefilteredSideSize)
     {
-        device->getDeviceContext()->OMSetRenderTargets(1, &brdfRTV, nullptr);
+        DXStateContext* context = device->getStateContext();
+        context->setRenderTargets(1, &brdfRTV, nullptr);
         
         D3D11_VIEWPORT viewport;
         viewport.TopLeftX = 0;
@@ -233,15 +311,15 @@ private:
         viewport.Height = prefilteredSideSize;
         viewport.MinDepth = 0.0f;
         viewport.MaxDepth = 1.0f;
-        device->getDeviceContext()->RSSetViewports(1, &viewport);
+        context->setViewport(viewport);
 
-        device->getDeviceContext()->OMSetDepthStencilState(nullptr, 0);
-        device->getDeviceContext()->RSSetState(nullptr);
-        device->getDeviceContext()->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
-        device->getDeviceContext()->IASetInputLayout(nullptr);
-        device->getDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        brdfShader->bind(device->getDeviceContext());
-        device->getDeviceContext()->Draw(6, 0);
+        context->setDepthStencilState(nullptr, 0);
+        context->setRasterizerState(nullptr);
+        context->setBlendState(nullptr, nullptr, 0xFFFFFFFF);
+        context->setInputLayout(nullptr);
+        context->setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+        brdfShader->bind(context);
+        context->draw(6, 0);
 
     }
 
@@ -260,11 +338,12 @@ private:
         {
             throw std::runtime_error("Failed to create prefiltered rtv");
         }
+        trackView(res, "Prefiltered map render target view", CUBEMAP_GENERATOR_OWNER);
 
         return res;
     }
 
-    void createCubemap(HDRCubemap* pOutput, ID3D11RenderTargetView** brdfRTV, uint32_t size, uint32_t irradianceSideSize, uint32_t prefilteredSideSize)
+    void createCubemap(HDRCubemap* pOutput, uint32_t size, uint32_t irradianceSideSize, uint32_t prefilteredSideSize)
     {
         D3D11_TEXTURE2D_DESC textureDesc = {};
 
@@ -283,6 +362,7 @@ private:
         {
             throw std::runtime_error("Failed to create resulting cubemap texture");
         }
+        trackTexture(pOutput->cubemapTexture, "Environment cubemap", CUBEMAP_GENERATOR_OWNER);
 
         D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
         shaderResourceViewDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
@@ -295,6 +375,7 @@ private:
         {
             throw std::runtime_error("Failed to create shader resource view cubemap");
         }
+        trackView(pOutput->cubemapSRV, "Environment cubemap", CUBEMAP_GENERATOR_OWNER);
         textureDesc.Width = irradianceSideSize;
         textureDesc.Height = irradianceSideSize;
 
@@ -302,11 +383,13 @@ private:
         {
             throw std::runtime_error("Failed to create resulting cubemap texture");
         }
+        trackTexture(pOutput->irradianceTexture, "Irradiance map", CUBEMAP_GENERATOR_OWNER);
         if (FAILED(device->getDevice()->CreateShaderResourceView(pOutput->irradianceTexture, &shaderResourceViewDesc,
             &pOutput->irradianceSRV)))
         {
             throw std::runtime_error("Failed to create shader resource view cubemap");
         }
+        trackView(pOutput->irradianceSRV, "Irradiance map", CUBEMAP_GENERATOR_OWNER);
         textureDesc.Width = prefilteredSideSize;
         textureDesc.Height = prefilteredSideSize;
         textureDesc.MipLevels = prefilteredRoughness.size();
@@ -315,11 +398,13 @@ private:
         {
             throw std::runtime_error("Failed to create resulting cubemap texture");
         }
+        trackTexture(pOutput->prefilteredTexture, "Prefiltered map", CUBEMAP_GENERATOR_OWNER);
         if (FAILED(device->getDevice()->CreateShaderResourceView(pOutput->prefilteredTexture, &shaderResourceViewDesc,
             &pOutput->prefilteredSRV)))
         {
             throw std::runtime_error("Failed to create shader resource view cubemap");
         }
+        trackView(pOutput->prefilteredSRV, "Prefiltered map", CUBEMAP_GENERATOR_OWNER);
         
         D3D11_TEXTURE2D_DESC brdftextureDesc = {};
 
@@ -338,19 +423,10 @@ private:
         {
             throw std::runtime_error("Failed to create resulting brdf texture");
         }
+        trackTexture(pOutput->brdfTexture, "BRDF lookup", CUBEMAP_GENERATOR_OWNER);
     
 
     
-        D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc;
-        renderTargetViewDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-        renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
-        renderTargetViewDesc.Texture2D.MipSlice = 0;
-
-        if (FAILED(device->getDevice()->CreateRenderTargetView(pOutput->brdfTexture, &renderTargetViewDesc, brdfRTV)))
-        {
-            throw std::runtime_error("Failed to create resulting brdf rtv");
-        }
-   
         D3D11_SHADER_RESOURCE_VIEW_DESC brdfshaderResourceViewDesc;
         brdfshaderResourceViewDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
         brdfshaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
@@ -361,28 +437,22 @@ private:
        {
            throw std::runtime_error("Failed to create resulting brdf srv");
        }
+       trackView(pOutput->brdfSRV, "BRDF lookup", CUBEMAP_GENERATOR_OWNER);
     }
 
-    void loadHDRMap(std::string name, uint32_t* pSizeOutput, ID3D11Texture2D** ppTextureResult,
+    void loadHDRMap(const ImageAsset& source, uint32_t* pSizeOutput, ID3D11Texture2D** ppTextureResult,
                     ID3D11ShaderResourceView** ppResourceViewRes)
     {
-        auto workDir = FileSystemUtils::getCurrentDirectoryPath();
-
-        std::string filePath(workDir.begin(), workDir.end());
-        filePath += name;
-        int width, height, nrComponents;
-        float* data = stbi_loadf(filePath.c_str(), &width, &height, &nrComponents, 4);
-
-        if (!data)
+        if (source.format != DXGI_FORMAT_R32G32B32A32_FLOAT || source.arraySize != 1)
         {
-            throw std::runtime_error("Failed to load hdr");
+            throw std::runtime_error("Failed to load hdr: expected a single float RGBA image");
         }
 
-        *pSizeOutput = min(width, height);
+        *pSizeOutput = min(source.width, source.height);
         D3D11_TEXTURE2D_DESC textureDesc = {};
 
-        textureDesc.Width = width;
-        textureDesc.Height = height;
+        textureDesc.Width = source.width;
+        textureDesc.Height = source.height;
         textureDesc.MipLevels = 1;
         textureDesc.ArraySize = 1;
         textureDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
@@ -393,26 +463,30 @@ private:
         textureDesc.MiscFlags = 0;
 
         D3D11_SUBRESOURCE_DATA initData;
-        initData.pSysMem = data;
-        initData.SysMemPitch = width * sizeof(float) * 4;
-        initData.SysMemSlicePitch = width * height * sizeof(float) * 4;
+        initData.pSysMem = source.data.data() + source.subresources[0].offset;
+        initData.SysMemPitch = source.subresources[0].rowPitch;
+        initData.SysMemSlicePitch = source.subresources[0].slicePitch;
 
         HRESULT result = device->getDevice()->CreateTexture2D(&textureDesc, &initData, ppTextureResult);
 
         if (SUCCEEDED(result))
         {
+            trackTexture(*ppTextureResult, "Environment source", CUBEMAP_GENERATOR_OWNER);
             D3D11_SHADER_RESOURCE_VIEW_DESC descSRV = {};
             descSRV.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
             descSRV.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
             descSRV.Texture2D.MipLevels = 1;
             descSRV.Texture2D.MostDetailedMip = 0;
             result = device->getDevice()->CreateShaderResourceView(*ppTextureResult, &descSRV, ppResourceViewRes);
+            if (SUCCEEDED(result))
+            {
+                trackView(*ppResourceViewRes, "Environment source", CUBEMAP_GENERATOR_OWNER);
+            }
         }
         else
         {
             throw std::runtime_error("Failed to create cubemap texture");
         }
-        stbi_image_free(data);
     }
 
     void loadShaders()
@@ -425,67 +499,87 @@ private:
         createInfos[1].shaderName = "HDRToCube";
         createInfos[1].pathToShader = L"Shaders/CubemapGen/HDRToCubePS.hlsl";
         createInfos[1].shaderType = ShaderType::PIXEL_SHADER;
-        cubemapConvertShader = Shader::loadShader(device->getDevice(), createInfos, 2);
         ShaderVertexInput vertexInputs[1];
         vertexInputs[0].inputFormat = DXGI_FORMAT_R32G32B32_FLOAT;
         vertexInputs[0].variableIndex = 0;
         vertexInputs[0].vertexSize = sizeof(float) * 3;
         vertexInputs[0].shaderVariableName = "POSITION";
-        cubemapConvertShader->makeInputLayout(device->getDevice(), vertexInputs, 1);
+        cubemapConvertBuild = loadStageShader(createInfos, vertexInputs, 1, CUBEMAP_STAGE_CONVERT);
         createInfos[1].shaderName = "irradianceCube";
         createInfos[1].pathToShader = L"Shaders/CubemapGen/irradianceCube.hlsl";
-        irradianceGenerator = Shader::loadShader(device->getDevice(), createInfos, 2);
-        irradianceGenerator->makeInputLayout(device->getDevice(), vertexInputs, 1);
+        irradianceBuild = loadStageShader(createInfos, vertexInputs, 1, CUBEMAP_STAGE_IRRADIANCE);
         createInfos[1].shaderName = "prefilterer";
         createInfos[1].pathToShader = L"Shaders/CubemapGen/prefilterCube.hlsl";
-        prefilterShader = Shader::loadShader(device->getDevice(), createInfos, 2);
-        prefilterShader->makeInputLayout(device->getDevice(), vertexInputs, 1);
+        prefilterBuild = loadStageShader(createInfos, vertexInputs, 1, CUBEMAP_STAGE_PREFILTER);
 
         createInfos[0].shaderName = "brdfVS";
         createInfos[0].pathToShader = L"Shaders/CubemapGen/brdfVS.hlsl";
 
         createInfos[1].shaderName = "brdfPS";
         createInfos[1].pathToShader = L"Shaders/CubemapGen/brdfPS.hlsl";
-        brdfShader = Shader::loadShader(device->getDevice(), createInfos, 2);
+        brdfBuild = loadStageShader(createInfos, nullptr, 0, CUBEMAP_STAGE_BRDF);
+    }
+
+    std::shared_future<Shader*> loadStageShader(ShaderCreateInfo* pCreateInfos, ShaderVertexInput* pInputs,
+                                                uint32_t inputsAmount, CubemapStage stage)
+    {
+        ShaderProgramDesc programDesc = Shader::describeProgram(pCreateInfos, 2, pInputs, inputsAmount);
+        std::shared_future<Shader*> shader = Shader::buildProgram(device->getDevice(), programDesc);
+        if (shaderReload)
+        {
+            shaderReload->watch(shader, programDesc, [this, stage]()
+            {
+                dirtyStages |= stage;
+            });
+        }
+        return shader;
+    }
+
+    void waitForShaders()
+    {
+        cubemapConvertShader = cubemapConvertBuild.get();
+        irradianceGenerator = irradianceBuild.get();
+        prefilterShader = prefilterBuild.get();
+        brdfShader = brdfBuild.get();
     }
 
     void loadQuad()
     {
         quads.push_back({
-            new VertexBuffer(device->getDevice(), sizeof(quadVerticesXPos),
+            new VertexBuffer(device->getGraphicsDevice(), sizeof(quadVerticesXPos),
                              sizeof(float) * 3, quadVerticesXPos),
-            new IndexBuffer(device->getDevice(), quadIndicesXPos, 6)
+            new IndexBuffer(device->getGraphicsDevice(), quadIndicesXPos, 6)
         });
 
         quads.push_back({
-            new VertexBuffer(device->getDevice(), sizeof(quadVerticesXNeg),
+            new VertexBuffer(device->getGraphicsDevice(), sizeof(quadVerticesXNeg),
                              sizeof(float) * 3, quadVerticesXNeg),
-            new IndexBuffer(device->getDevice(), quadIndicesXNeg, 6)
+            new IndexBuffer(device->getGraphicsDevice(), quadIndicesXNeg, 6)
         });
 
         quads.push_back({
-            new VertexBuffer(device->getDevice(), sizeof(quadVerticesYPos),
+            new VertexBuffer(device->getGraphicsDevice(), sizeof(quadVerticesYPos),
                              sizeof(float) * 3, quadVerticesYPos),
-            new IndexBuffer(device->getDevice(), quadIndicesYPos, 6),
+            new IndexBuffer(device->getGraphicsDevice(), quadIndicesYPos, 6),
 
         });
 
         quads.push_back({
-            new VertexBuffer(device->getDevice(), sizeof(quadVerticesYNeg),
+            new VertexBuffer(device->getGraphicsDevice(), sizeof(quadVerticesYNeg),
                              sizeof(float) * 3, quadVerticesYNeg),
-            new IndexBuffer(device->getDevice(), quadIndicesYNeg, 6)
+            new IndexBuffer(device->getGraphicsDevice(), quadIndicesYNeg, 6)
         });
 
         quads.push_back({
-            new VertexBuffer(device->getDevice(), sizeof(quadVerticesZPos),
+            new VertexBuffer(device->getGraphicsDevice(), sizeof(quadVerticesZPos),
                              sizeof(float) * 3, quadVerticesZPos),
-            new IndexBuffer(device->getDevice(), quadIndicesZPos, 6),
+            new IndexBuffer(device->getGraphicsDevice(), quadIndicesZPos, 6),
         });
 
         quads.push_back({
-            new VertexBuffer(device->getDevice(), sizeof(quadVerticesZNeg),
+            new VertexBuffer(device->getGraphicsDevice(), sizeof(quadVerticesZNeg),
                              sizeof(float) * 3, quadVerticesZNeg),
-            new IndexBuffer(device->getDevice(), quadIndicesZNeg, 6)
+            new IndexBuffer(device->getGraphicsDevice(), quadIndicesZNeg, 6)
         });
     }
 
@@ -499,10 +593,12 @@ public:
         }
         sampler->Release();
         delete viewProjMatrixBuff;
+        delete roughnessBuffer;
         delete irradianceGenerator;
         delete cubemapConvertShader;
         delete prefilterShader;
         delete brdfShader;
+        delete profilerAnnotation;
     }
 
 private:
@@ -0,0 +1,397 @@
+#include "FrustumCuller.h"
+
+#include <cmath>
+#include "../../Utils/CpuFeatures.h"
+#include "../../Utils/JobSystem.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define CULLING_TARGET_AVX2
+#else
+#include <immintrin.h>
+#define CULLING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define CULLING_MIN_OBJECTS_PER_THREAD 4096
+
+namespace
+{
+    struct BoundsView
+    {
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* radius;
+        const float* extentX;
+        const float* extentY;
+        const float* extentZ;
+    };
+
+    typedef uint32_t (*CullKernel)(const FrustumPlanes& planes, const BoundsView& bounds,
+                                   const CullingParameters& parameters, uint32_t begin, uint32_t end,
+                                   uint32_t* pVisibleOutput);
+
+    inline uint32_t firstBit(uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (uint32_t)index;
+#else
+        return (uint32_t)__builtin_ctz(mask);
+#endif
+    }
+
+    inline uint32_t writeMask(uint32_t mask, uint32_t baseIndex, uint32_t* pVisibleOutput)
+    {
+        uint32_t written = 0;
+        while (mask)
+        {
+            pVisibleOutput[written++] = baseIndex + firstBit(mask);
+            mask &= mask - 1;
+        }
+        return written;
+    }
+
+    uint32_t cullScalar(const FrustumPlanes& planes, const BoundsView& bounds, const CullingParameters& parameters,
+                        uint32_t begin, uint32_t end, uint32_t* pVisibleOutput)
+    {
+        uint32_t written = 0;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            float x = bounds.x[i];
+            float y = bounds.y[i];
+            float z = bounds.z[i];
+            bool visible = true;
+            for (uint32_t p = 0; p < FRUSTUM_PLANES_AMOUNT && visible; p++)
+            {
+                float distance = planes.a[p] * x + planes.b[p] * y + planes.c[p] * z + planes.d[p];
+                float radius = bounds.radius
+                                   ? bounds.radius[i]
+                                   : fabsf(planes.a[p]) * bounds.extentX[i] + fabsf(planes.b[p]) * bounds.extentY[i] +
+                                   fabsf(planes.c[p]) * bounds.extentZ[i];
+                visible = distance >= -radius;
+            }
+            if (visible && parameters.maxDistance > 0)
+            {
+                float radius = bounds.radius
+                                   ? bounds.radius[i]
+                                   : sqrtf(bounds.extentX[i] * bounds.extentX[i] +
+                                       bounds.extentY[i] * bounds.extentY[i] +
+                                       bounds.extentZ[i] * bounds.extentZ[i]);
+                float dx = x - parameters.cameraPosition[0];
+                float dy = y - parameters.cameraPosition[1];
+                float dz = z - parameters.cameraPosition[2];
+                float limit = parameters.maxDistance + radius;
+                visible = dx * dx + dy * dy + dz * dz <= limit * limit;
+            }
+            if (visible)
+            {
+                pVisibleOutput[written++] = i;
+            }
+        }
+        return written;
+    }
+
+    uint32_t cullSSE(const FrustumPlanes& planes, const BoundsView& bounds, const CullingParameters& parameters,
+                     uint32_t begin, uint32_t end, uint32_t* pVisibleOutput)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 allSet = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        const __m128 cameraX = _mm_set1_ps(parameters.cameraPosition[0]);
+        const __m128 cameraY = _mm_set1_ps(parameters.cameraPosition[1]);
+        const __m128 cameraZ = _mm_set1_ps(parameters.cameraPosition[2]);
+        const __m128 maxDistance = _mm_set1_ps(parameters.maxDistance);
+        uint32_t written = 0;
+        uint32_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(bounds.x + i);
+            __m128 y = _mm_loadu_ps(bounds.y + i);
+            __m128 z = _mm_loadu_ps(bounds.z + i);
+            __m128 radius = zero;
+            __m128 extentX = zero;
+            __m128 extentY = zero;
+            __m128 extentZ = zero;
+            if (bounds.radius)
+            {
+                radius = _mm_loadu_ps(bounds.radius + i);
+            }
+            else
+            {
+                extentX = _mm_loadu_ps(bounds.extentX + i);
+                extentY = _mm_loadu_ps(bounds.extentY + i);
+                extentZ = _mm_loadu_ps(bounds.extentZ + i);
+            }
+            __m128 visible = allSet;
+            for (uint32_t p = 0; p < FRUSTUM_PLANES_AMOUNT; p++)
+            {
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.a[p]), x), _mm_mul_ps(_mm_set1_ps(planes.b[p]), y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.c[p]), z), _mm_set1_ps(planes.d[p])));
+                __m128 planeRadius = radius;
+                if (!bounds.radius)
+                {
+                    planeRadius = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(planes.a[p])), extentX),
+                                   _mm_mul_ps(_mm_set1_ps(fabsf(planes.b[p])), extentY)),
+                        _mm_mul_ps(_mm_set1_ps(fabsf(planes.c[p])), extentZ));
+                }
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, _mm_sub_ps(zero, planeRadius)));
+            }
+            if (parameters.maxDistance > 0)
+            {
+                if (!bounds.radius)
+                {
+                    radius = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, extentX),
+                                                               _mm_mul_ps(extentY, extentY)),
+                                                    _mm_mul_ps(extentZ, extentZ)));
+                }
+                __m128 dx = _mm_sub_ps(x, cameraX);
+                __m128 dy = _mm_sub_ps(y, cameraY);
+                __m128 dz = _mm_sub_ps(z, cameraZ);
+                __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                                    _mm_mul_ps(dz, dz));
+                __m128 limit = _mm_add_ps(maxDistance, radius);
+                visible = _mm_and_ps(visible, _mm_cmple_ps(distanceSquared, _mm_mul_ps(limit, limit)));
+            }
+            written += writeMask((uint32_t)_mm_movemask_ps(visible), i, pVisibleOutput + written);
+        }
+        return written + cullScalar(planes, bounds, parameters, i, end, pVisibleOutput + written);
+    }
+
+    CULLING_TARGET_AVX2 uint32_t cullAVX2(const FrustumPlanes& planes, const BoundsView& bounds,
+                                          const CullingParameters& parameters, uint32_t begin, uint32_t end,
+                                          uint32_t* pVisibleOutput)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 allSet = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        const __m256 cameraX = _mm256_set1_ps(parameters.cameraPosition[0]);
+        const __m256 cameraY = _mm256_set1_ps(parameters.cameraPosition[1]);
+        const __m256 cameraZ = _mm256_set1_ps(parameters.cameraPosition[2]);
+        const __m256 maxDistance = _mm256_set1_ps(parameters.maxDistance);
+        uint32_t written = 0;
+        uint32_t i = begin;
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(bounds.x + i);
+            __m256 y = _mm256_loadu_ps(bounds.y + i);
+            __m256 z = _mm256_loadu_ps(bounds.z + i);
+            __m256 radius = zero;
+            __m256 extentX = zero;
+            __m256 extentY = zero;
+            __m256 extentZ = zero;
+            if (bounds.radius)
+            {
+                radius = _mm256_loadu_ps(bounds.radius + i);
+            }
+            else
+            {
+                extentX = _mm256_loadu_ps(bounds.extentX + i);
+                extentY = _mm256_loadu_ps(bounds.extentY + i);
+                extentZ = _mm256_loadu_ps(bounds.extentZ + i);
+            }
+            __m256 visible = allSet;
+            for (uint32_t p = 0; p < FRUSTUM_PLANES_AMOUNT; p++)
+            {
+                __m256 distance = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.a[p]), x),
+                                  _mm256_mul_ps(_mm256_set1_ps(planes.b[p]), y)),
+                    _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.c[p]), z), _mm256_set1_ps(planes.d[p])));
+                __m256 planeRadius = radius;
+                if (!bounds.radius)
+                {
+                    planeRadius = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fabsf(planes.a[p])), extentX),
+                                      _mm256_mul_ps(_mm256_set1_ps(fabsf(planes.b[p])), extentY)),
+                        _mm256_mul_ps(_mm256_set1_ps(fabsf(planes.c[p])), extentZ));
+                }
+                visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, _mm256_sub_ps(zero, planeRadius),
+                                                               _CMP_GE_OQ));
+            }
+            if (parameters.maxDistance > 0)
+            {
+                if (!bounds.radius)
+                {
+                    radius = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentX, extentX),
+                                                                        _mm256_mul_ps(extentY, extentY)),
+                                                          _mm256_mul_ps(extentZ, extentZ)));
+                }
+                __m256 dx = _mm256_sub_ps(x, cameraX);
+                __m256 dy = _mm256_sub_ps(y, cameraY);
+                __m256 dz = _mm256_sub_ps(z, cameraZ);
+                __m256 distanceSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                                       _mm256_mul_ps(dz, dz));
+                __m256 limit = _mm256_add_ps(maxDistance, radius);
+                visible = _mm256_and_ps(visible, _mm256_cmp_ps(distanceSquared, _mm256_mul_ps(limit, limit),
+                                                               _CMP_LE_OQ));
+            }
+            written += writeMask((uint32_t)_mm256_movemask_ps(visible), i, pVisibleOutput + written);
+        }
+        return written + cullScalar(planes, bounds, parameters, i, end, pVisibleOutput + written);
+    }
+
+    CullKernel selectKernel(CullingInstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+        case CULLING_AVX2:
+            return cullAVX2;
+        case CULLING_SSE:
+            return cullSSE;
+        default:
+            return cullScalar;
+        }
+    }
+
+    void normalizePlane(FrustumPlanes& planes, uint32_t index, float a, float b, float c, float d)
+    {
+        float length = sqrtf(a * a + b * b + c * c);
+        planes.a[index] = a / length;
+        planes.b[index] = b / length;
+        planes.c[index] = c / length;
+        planes.d[index] = d / length;
+    }
+}
+
+void BoundingSpheres::push(float x, float y, float z, float r)
+{
+    centerX.push_back(x);
+    centerY.push_back(y);
+    centerZ.push_back(z);
+    radius.push_back(r);
+}
+
+void BoundingSpheres::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+}
+
+uint32_t BoundingSpheres::size() const
+{
+    return (uint32_t)centerX.size();
+}
+
+void BoundingBoxes::push(float x, float y, float z, float ex, float ey, float ez)
+{
+    centerX.push_back(x);
+    centerY.push_back(y);
+    centerZ.push_back(z);
+    extentX.push_back(ex);
+    extentY.push_back(ey);
+    extentZ.push_back(ez);
+}
+
+void BoundingBoxes::clear()
+{
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    extentX.clear();
+    extentY.clear();
+    extentZ.clear();
+}
+
+uint32_t BoundingBoxes::size() const
+{
+    return (uint32_t)centerX.size();
+}
+
+void FrustumCuller::extractPlanes(const float* viewProjection, FrustumPlanes& planesOutput)
+{
+    auto m = [viewProjection](uint32_t row, uint32_t column) { return viewProjection[row * 4 + column]; };
+    // Clip space is v * M, so every plane is a combination of the matrix columns
+    normalizePlane(planesOutput, 0, m(0, 3) + m(0, 0), m(1, 3) + m(1, 0), m(2, 3) + m(2, 0), m(3, 3) + m(3, 0));
+    normalizePlane(planesOutput, 1, m(0, 3) - m(0, 0), m(1, 3) - m(1, 0), m(2, 3) - m(2, 0), m(3, 3) - m(3, 0));
+    normalizePlane(planesOutput, 2, m(0, 3) + m(0, 1), m(1, 3) + m(1, 1), m(2, 3) + m(2, 1), m(3, 3) + m(3, 1));
+    normalizePlane(planesOutput, 3, m(0, 3) - m(0, 1), m(1, 3) - m(1, 1), m(2, 3) - m(2, 1), m(3, 3) - m(3, 1));
+    normalizePlane(planesOutput, 4, m(0, 2), m(1, 2), m(2, 2), m(3, 2));
+    normalizePlane(planesOutput, 5, m(0, 3) - m(0, 2), m(1, 3) - m(1, 2), m(2, 3) - m(2, 2), m(3, 3) - m(3, 2));
+}
+
+FrustumCuller::FrustumCuller()
+{
+    instructionSet = CpuFeatures::supportsAVX2() ? CULLING_AVX2 : CULLING_SSE;
+}
+
+void FrustumCuller::cullSpheres(const FrustumPlanes& planes, const BoundingSpheres& spheres,
+                                const CullingParameters& parameters, std::vector<uint32_t>& visibleIndicesOutput)
+{
+    BoundsView bounds = {
+        spheres.centerX.data(), spheres.centerY.data(), spheres.centerZ.data(), spheres.radius.data(),
+        nullptr, nullptr, nullptr
+    };
+    cull(planes, &bounds, spheres.size(), parameters, visibleIndicesOutput);
+}
+
+void FrustumCuller::cullBoxes(const FrustumPlanes& planes, const BoundingBoxes& boxes,
+                              const CullingParameters& parameters, std::vector<uint32_t>& visibleIndicesOutput)
+{
+    BoundsView bounds = {
+        boxes.centerX.data(), boxes.centerY.data(), boxes.centerZ.data(), nullptr,
+        boxes.extentX.data(), boxes.extentY.data(), boxes.extentZ.data()
+    };
+    cull(planes, &bounds, boxes.size(), parameters, visibleIndicesOutput);
+}
+
+void FrustumCuller::cull(const FrustumPlanes& planes, const void* pBounds, uint32_t objectsAmount,
+                         const CullingParameters& parameters, std::vector<uint32_t>& visibleIndicesOutput)
+{
+    const BoundsView& bounds = *(const BoundsView*)pBounds;
+    CullKernel kernel = selectKernel(instructionSet);
+
+    uint32_t chunksAmount = parameters.jobs ? parameters.jobs->getThreadsAmount() : 1;
+    if (objectsAmount / chunksAmount < CULLING_MIN_OBJECTS_PER_THREAD)
+    {
+        chunksAmount = objectsAmount / CULLING_MIN_OBJECTS_PER_THREAD;
+        chunksAmount = chunksAmount ? chunksAmount : 1;
+    }
+
+    if (chunksAmount == 1)
+    {
+        visibleIndicesOutput.resize(objectsAmount);
+        uint32_t written = kernel(planes, bounds, parameters, 0, objectsAmount, visibleIndicesOutput.data());
+        visibleIndicesOutput.resize(written);
+        return;
+    }
+
+    // Chunks are aligned to 8 objects so every job stays on the vector path, results are joined in chunk order
+    uint32_t chunkSize = ((objectsAmount + chunksAmount - 1) / chunksAmount + 7) & ~7u;
+    chunkResults.resize(chunksAmount);
+    chunkWrittenAmounts.assign(chunksAmount, 0);
+    parameters.jobs->parallelFor(chunksAmount, 1, [&](uint32_t first, uint32_t last)
+    {
+        for (uint32_t chunk = first; chunk < last; chunk++)
+        {
+            uint32_t begin = chunk * chunkSize < objectsAmount ? chunk * chunkSize : objectsAmount;
+            uint32_t end = begin + chunkSize < objectsAmount ? begin + chunkSize : objectsAmount;
+            chunkResults[chunk].resize(end - begin);
+            chunkWrittenAmounts[chunk] = kernel(planes, bounds, parameters, begin, end, chunkResults[chunk].data());
+        }
+    });
+
+    visibleIndicesOutput.clear();
+    for (uint32_t chunk = 0; chunk < chunksAmount; chunk++)
+    {
+        visibleIndicesOutput.insert(visibleIndicesOutput.end(), chunkResults[chunk].begin(),
+                                    chunkResults[chunk].begin() + chunkWrittenAmounts[chunk]);
+    }
+}
+
+void FrustumCuller::setInstructionSet(CullingInstructionSet set)
+{
+    if (set == CULLING_AVX2 && !CpuFeatures::supportsAVX2())
+    {
+        set = CULLING_SSE;
+    }
+    instructionSet = set;
+}
+
+CullingInstructionSet FrustumCuller::getInstructionSet() const
+{
+    return instructionSet;
+}
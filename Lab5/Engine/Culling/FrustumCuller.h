@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define FRUSTUM_PLANES_AMOUNT 6
+
+class JobSystem;
+
+/*
+ * Planes are stored as separate coefficient arrays, a point is inside when a*x + b*y + c*z + d >= 0
+ */
+struct FrustumPlanes
+{
+    float a[FRUSTUM_PLANES_AMOUNT];
+    float b[FRUSTUM_PLANES_AMOUNT];
+    float c[FRUSTUM_PLANES_AMOUNT];
+    float d[FRUSTUM_PLANES_AMOUNT];
+};
+
+struct BoundingSpheres
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    void push(float x, float y, float z, float r);
+    void clear();
+    uint32_t size() const;
+};
+
+struct BoundingBoxes
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX;
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    void push(float x, float y, float z, float ex, float ey, float ez);
+    void clear();
+    uint32_t size() const;
+};
+
+struct CullingParameters
+{
+    float cameraPosition[3] = {0, 0, 0};
+    // Objects further than maxDistance from the camera are culled, zero or less disables the test
+    float maxDistance = 0;
+    // Culls on the calling thread alone when nullptr
+    JobSystem* jobs = nullptr;
+};
+
+enum CullingInstructionSet
+{
+    CULLING_SCALAR,
+    CULLING_SSE,
+    CULLING_AVX2
+};
+
+class FrustumCuller
+{
+public:
+    /*
+     * Extracts planes from a row-major view-projection matrix that transforms row vectors (DirectXMath convention)
+     */
+    static void extractPlanes(const float* viewProjection, FrustumPlanes& planesOutput);
+
+public:
+    FrustumCuller();
+
+private:
+    CullingInstructionSet instructionSet;
+    std::vector<std::vector<uint32_t>> chunkResults;
+    std::vector<uint32_t> chunkWrittenAmounts;
+
+public:
+    void cullSpheres(const FrustumPlanes& planes, const BoundingSpheres& spheres, const CullingParameters& parameters,
+                     std::vector<uint32_t>& visibleIndicesOutput);
+    void cullBoxes(const FrustumPlanes& planes, const BoundingBoxes& boxes, const CullingParameters& parameters,
+                   std::vector<uint32_t>& visibleIndicesOutput);
+    void setInstructionSet(CullingInstructionSet set);
+    CullingInstructionSet getInstructionSet() const;
+
+private:
+    void cull(const FrustumPlanes& planes, const void* pBounds, uint32_t objectsAmount,
+              const CullingParameters& parameters, std::vector<uint32_t>& visibleIndicesOutput);
+};
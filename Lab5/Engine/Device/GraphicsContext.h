@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include "../../DXDevice/StateTracker.h"
+
+// Backend values, DXGI_FORMAT_R32_UINT and D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST for D3D11
+#define GRAPHICS_FORMAT_R32_UINT 42u
+#define GRAPHICS_TOPOLOGY_TRIANGLE_LIST 4u
+
+enum GraphicsMapMode
+{
+    GRAPHICS_MAP_WRITE_DISCARD,
+    // Only writes ranges the GPU does not read, the caller tracks which ones with fences
+    GRAPHICS_MAP_WRITE_NO_OVERWRITE
+};
+
+/*
+ * Shader stages and input layout that draw together
+ */
+struct GraphicsProgram
+{
+    StateHandle vertexShader = nullptr;
+    StateHandle pixelShader = nullptr;
+    StateHandle inputLayout = nullptr;
+};
+
+/*
+ * Everything a frame sends to the graphics API. Objects are the opaque handles a GraphicsDevice created, every
+ * binding goes through a StateTracker first so the same frame costs the same API calls on every implementation.
+ */
+class GraphicsContext
+{
+public:
+    virtual ~GraphicsContext() = default;
+
+    virtual void setShader(StateTrackerStage stage, StateHandle shader) = 0;
+    virtual void setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                    const StateHandle* pViews) = 0;
+    virtual void setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                             const StateHandle* pSamplers) = 0;
+    virtual void setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                    const StateConstantBuffer* pBuffers) = 0;
+    virtual void setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView) = 0;
+    virtual void setDepthStencilState(StateHandle state, uint32_t stencilRef) = 0;
+    virtual void setRasterizerState(StateHandle state) = 0;
+    virtual void setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask) = 0;
+    virtual void setViewport(const StateViewport& viewport) = 0;
+    virtual void setInputLayout(StateHandle layout) = 0;
+    virtual void setPrimitiveTopology(uint32_t topology) = 0;
+    virtual void setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset) = 0;
+    virtual void setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset) = 0;
+
+    virtual void clearRenderTarget(StateHandle view, const float* pColor) = 0;
+    virtual void clearDepthStencil(StateHandle view, float depth, uint8_t stencil) = 0;
+    virtual void draw(uint32_t vertexCount, uint32_t startVertex) = 0;
+    virtual void drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) = 0;
+    virtual void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex,
+                                      int32_t baseVertex, uint32_t startInstance) = 0;
+
+    virtual void* map(StateHandle buffer, GraphicsMapMode mode) = 0;
+    virtual void unmap(StateHandle buffer) = 0;
+    /*
+     * size 0 replaces the whole buffer, otherwise bytes [offset, offset + size) of it with pData
+     */
+    virtual void updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData) = 0;
+    virtual void signalFence(StateHandle fence) = 0;
+    /*
+     * With wait blocks until the GPU passed the fence, throws when the device can no longer report it
+     */
+    virtual bool isFenceDone(StateHandle fence, bool wait) = 0;
+
+    /*
+     * Forgets every cached binding, call after code that binds past the context
+     */
+    virtual void invalidate() = 0;
+    virtual void beginFrame() = 0;
+    virtual const StateTrackerStats& getLastFrameStats() const = 0;
+
+    void setProgram(const GraphicsProgram& program)
+    {
+        setShader(STATE_TRACKER_VERTEX_STAGE, program.vertexShader);
+        setShader(STATE_TRACKER_PIXEL_STAGE, program.pixelShader);
+        setInputLayout(program.inputLayout);
+    }
+};
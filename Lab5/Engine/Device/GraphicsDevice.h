@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include "GraphicsContext.h"
+
+enum GraphicsBindFlags
+{
+    GRAPHICS_BIND_VERTEX_BUFFER = 1,
+    GRAPHICS_BIND_INDEX_BUFFER = 2,
+    GRAPHICS_BIND_CONSTANT_BUFFER = 4,
+    // Structured buffer read in shaders, stride is the element size
+    GRAPHICS_BIND_SHADER_RESOURCE = 8
+};
+
+struct GraphicsBufferDesc
+{
+    uint32_t size = 0;
+    uint32_t bindFlags = 0;
+    uint32_t stride = 0;
+    // Written through map instead of updateBuffer
+    bool dynamic = false;
+};
+
+struct GraphicsBuffer
+{
+    StateHandle buffer = nullptr;
+    // Only for GRAPHICS_BIND_SHADER_RESOURCE buffers
+    StateHandle shaderResourceView = nullptr;
+    uint32_t size = 0;
+};
+
+struct GraphicsCapabilities
+{
+    // Constant buffers bound as windows of a larger buffer
+    bool constantBufferOffsets = false;
+    // updateBuffer with a range on constant buffers
+    bool constantBufferPartialUpdates = false;
+    // GRAPHICS_MAP_WRITE_NO_OVERWRITE on dynamic constant buffers
+    bool constantBufferNoOverwrite = false;
+};
+
+/*
+ * Creates the objects a frame uses and owns the immediate context. Creation and release happen on one thread.
+ */
+class GraphicsDevice
+{
+public:
+    virtual ~GraphicsDevice() = default;
+
+    virtual const GraphicsCapabilities& getCapabilities() const = 0;
+    /*
+     * pInitData may be nullptr for dynamic buffers
+     */
+    virtual GraphicsBuffer createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                        const char* bufferName = nullptr) = 0;
+    /*
+     * Releases the buffer and its view and clears the handles
+     */
+    virtual void releaseBuffer(GraphicsBuffer& buffer) = 0;
+    virtual StateHandle createFence() = 0;
+    virtual void releaseFence(StateHandle fence) = 0;
+    virtual GraphicsContext* getImmediateContext() = 0;
+};
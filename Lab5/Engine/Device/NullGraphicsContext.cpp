@@ -0,0 +1,187 @@
+#include "NullGraphicsContext.h"
+#include <cstring>
+#include <stdexcept>
+#include "NullGraphicsDevice.h"
+
+namespace
+{
+    NullBuffer* toBuffer(StateHandle buffer)
+    {
+        NullBuffer* nullBuffer = (NullBuffer*)buffer;
+        if (!nullBuffer || nullBuffer->released)
+        {
+            throw std::runtime_error("Null device buffer is not alive");
+        }
+        return nullBuffer;
+    }
+}
+
+void NullGraphicsContext::setShader(StateTrackerStage stage, StateHandle shader)
+{
+    tracker.setShader(stage, shader);
+}
+
+void NullGraphicsContext::setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                             const StateHandle* pViews)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    tracker.setShaderResources(stage, start, amount, pViews, issueStart, issueAmount);
+}
+
+void NullGraphicsContext::setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                      const StateHandle* pSamplers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    tracker.setSamplers(stage, start, amount, pSamplers, issueStart, issueAmount);
+}
+
+void NullGraphicsContext::setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                             const StateConstantBuffer* pBuffers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    tracker.setConstantBuffers(stage, start, amount, pBuffers, issueStart, issueAmount);
+}
+
+void NullGraphicsContext::setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView)
+{
+    tracker.setRenderTargets(amount, pViews, depthView);
+}
+
+void NullGraphicsContext::setDepthStencilState(StateHandle state, uint32_t stencilRef)
+{
+    tracker.setDepthStencilState(state, stencilRef);
+}
+
+void NullGraphicsContext::setRasterizerState(StateHandle state)
+{
+    tracker.setRasterizerState(state);
+}
+
+void NullGraphicsContext::setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask)
+{
+    tracker.setBlendState(state, pBlendFactor, sampleMask);
+}
+
+void NullGraphicsContext::setViewport(const StateViewport& viewport)
+{
+    tracker.setViewport(viewport);
+}
+
+void NullGraphicsContext::setInputLayout(StateHandle layout)
+{
+    tracker.setInputLayout(layout);
+}
+
+void NullGraphicsContext::setPrimitiveTopology(uint32_t topology)
+{
+    tracker.setPrimitiveTopology(topology);
+}
+
+void NullGraphicsContext::setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset)
+{
+    tracker.setVertexBuffer(slot, buffer, stride, offset);
+}
+
+void NullGraphicsContext::setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset)
+{
+    tracker.setIndexBuffer(buffer, format, offset);
+}
+
+void NullGraphicsContext::clearRenderTarget(StateHandle view, const float* pColor)
+{
+    frameStats.clearCalls++;
+}
+
+void NullGraphicsContext::clearDepthStencil(StateHandle view, float depth, uint8_t stencil)
+{
+    frameStats.clearCalls++;
+}
+
+void NullGraphicsContext::draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    frameStats.drawCalls++;
+    frameStats.drawnInstances++;
+}
+
+void NullGraphicsContext::drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    frameStats.drawCalls++;
+    frameStats.drawnIndices += indexCount;
+    frameStats.drawnInstances++;
+}
+
+void NullGraphicsContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex,
+                                               int32_t baseVertex, uint32_t startInstance)
+{
+    frameStats.drawCalls++;
+    frameStats.drawnIndices += indexCount * instanceCount;
+    frameStats.drawnInstances += instanceCount;
+}
+
+void* NullGraphicsContext::map(StateHandle buffer, GraphicsMapMode mode)
+{
+    NullBuffer* nullBuffer = toBuffer(buffer);
+    if (!nullBuffer->desc.dynamic)
+    {
+        throw std::runtime_error("Only dynamic buffers can be mapped");
+    }
+    frameStats.mapCalls++;
+    return nullBuffer->data.data();
+}
+
+void NullGraphicsContext::unmap(StateHandle buffer)
+{
+    toBuffer(buffer);
+}
+
+void NullGraphicsContext::updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData)
+{
+    NullBuffer* nullBuffer = toBuffer(buffer);
+    if (size == 0)
+    {
+        offset = 0;
+        size = (uint32_t)nullBuffer->data.size();
+    }
+    if (offset + size > nullBuffer->data.size())
+    {
+        throw std::runtime_error("Buffer update out of range");
+    }
+    memcpy(nullBuffer->data.data() + offset, pData, size);
+    frameStats.updateCalls++;
+    frameStats.uploadedBytes += size;
+}
+
+void NullGraphicsContext::signalFence(StateHandle fence)
+{
+    frameStats.fenceSignals++;
+}
+
+bool NullGraphicsContext::isFenceDone(StateHandle fence, bool wait)
+{
+    return true;
+}
+
+void NullGraphicsContext::invalidate()
+{
+    tracker.invalidate();
+}
+
+void NullGraphicsContext::beginFrame()
+{
+    tracker.beginFrame();
+    lastFrameStats = frameStats;
+    frameStats = {};
+}
+
+const StateTrackerStats& NullGraphicsContext::getLastFrameStats() const
+{
+    return tracker.getLastFrameStats();
+}
+
+const NullGraphicsStats& NullGraphicsContext::getLastFrameCalls() const
+{
+    return lastFrameStats;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include "GraphicsContext.h"
+
+/*
+ * Calls of one frame that are not bindings, the StateTracker counts those
+ */
+struct NullGraphicsStats
+{
+    uint32_t drawCalls = 0;
+    uint32_t drawnIndices = 0;
+    uint32_t drawnInstances = 0;
+    uint32_t clearCalls = 0;
+    uint32_t mapCalls = 0;
+    uint32_t updateCalls = 0;
+    uint64_t uploadedBytes = 0;
+    uint32_t fenceSignals = 0;
+};
+
+/*
+ * GraphicsContext without a GPU, every call lands in counters. Bindings are filtered by a StateTracker like on real
+ * devices, maps write into memory of the NullGraphicsDevice and fences are done as soon as they are signaled.
+ */
+class NullGraphicsContext : public GraphicsContext
+{
+private:
+    StateTracker tracker;
+    NullGraphicsStats frameStats;
+    NullGraphicsStats lastFrameStats;
+
+public:
+    void setShader(StateTrackerStage stage, StateHandle shader) override;
+    void setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateHandle* pViews) override;
+    void setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount, const StateHandle* pSamplers) override;
+    void setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateConstantBuffer* pBuffers) override;
+    void setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView) override;
+    void setDepthStencilState(StateHandle state, uint32_t stencilRef) override;
+    void setRasterizerState(StateHandle state) override;
+    void setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask) override;
+    void setViewport(const StateViewport& viewport) override;
+    void setInputLayout(StateHandle layout) override;
+    void setPrimitiveTopology(uint32_t topology) override;
+    void setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset) override;
+    void setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset) override;
+
+    void clearRenderTarget(StateHandle view, const float* pColor) override;
+    void clearDepthStencil(StateHandle view, float depth, uint8_t stencil) override;
+    void draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void* map(StateHandle buffer, GraphicsMapMode mode) override;
+    void unmap(StateHandle buffer) override;
+    void updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData) override;
+    void signalFence(StateHandle fence) override;
+    bool isFenceDone(StateHandle fence, bool wait) override;
+
+    void invalidate() override;
+    void beginFrame() override;
+    const StateTrackerStats& getLastFrameStats() const override;
+    const NullGraphicsStats& getLastFrameCalls() const;
+};
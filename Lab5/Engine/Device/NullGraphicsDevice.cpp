@@ -0,0 +1,90 @@
+#include "NullGraphicsDevice.h"
+#include <cstring>
+
+NullGraphicsDevice::NullGraphicsDevice()
+{
+    capabilities.constantBufferOffsets = true;
+    capabilities.constantBufferPartialUpdates = true;
+    capabilities.constantBufferNoOverwrite = true;
+}
+
+const GraphicsCapabilities& NullGraphicsDevice::getCapabilities() const
+{
+    return capabilities;
+}
+
+GraphicsBuffer NullGraphicsDevice::createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                                const char* bufferName)
+{
+    buffers.push_back(std::make_unique<NullBuffer>());
+    NullBuffer* nullBuffer = buffers.back().get();
+    nullBuffer->desc = desc;
+    nullBuffer->data.resize(desc.size);
+    if (pInitData)
+    {
+        memcpy(nullBuffer->data.data(), pInitData, desc.size);
+    }
+    if (bufferName)
+    {
+        nullBuffer->name = bufferName;
+    }
+    liveBuffersAmount++;
+    liveBufferBytes += desc.size;
+
+    GraphicsBuffer buffer;
+    buffer.buffer = nullBuffer;
+    if (desc.bindFlags & GRAPHICS_BIND_SHADER_RESOURCE)
+    {
+        buffer.shaderResourceView = &nullBuffer->shaderResourceView;
+    }
+    buffer.size = desc.size;
+    return buffer;
+}
+
+void NullGraphicsDevice::releaseBuffer(GraphicsBuffer& buffer)
+{
+    NullBuffer* nullBuffer = (NullBuffer*)buffer.buffer;
+    if (nullBuffer && !nullBuffer->released)
+    {
+        liveBuffersAmount--;
+        liveBufferBytes -= nullBuffer->desc.size;
+        nullBuffer->released = true;
+        std::vector<uint8_t>().swap(nullBuffer->data);
+    }
+    buffer = {};
+}
+
+StateHandle NullGraphicsDevice::createFence()
+{
+    return createObject("Fence");
+}
+
+void NullGraphicsDevice::releaseFence(StateHandle fence)
+{
+}
+
+GraphicsContext* NullGraphicsDevice::getImmediateContext()
+{
+    return &immediateContext;
+}
+
+NullGraphicsContext* NullGraphicsDevice::getNullContext()
+{
+    return &immediateContext;
+}
+
+StateHandle NullGraphicsDevice::createObject(const char* objectName)
+{
+    objects.push_back(std::make_unique<std::string>(objectName ? objectName : ""));
+    return objects.back().get();
+}
+
+uint32_t NullGraphicsDevice::getLiveBuffersAmount() const
+{
+    return liveBuffersAmount;
+}
+
+uint64_t NullGraphicsDevice::getLiveBufferBytes() const
+{
+    return liveBufferBytes;
+}
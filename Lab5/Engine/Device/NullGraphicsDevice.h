@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GraphicsDevice.h"
+#include "NullGraphicsContext.h"
+
+/*
+ * Buffer of the NullGraphicsDevice, its handle is the address of this object
+ */
+struct NullBuffer
+{
+    GraphicsBufferDesc desc;
+    std::vector<uint8_t> data;
+    std::string name;
+    // Handle of the structured buffer view, only compared by the trackers
+    uint8_t shaderResourceView = 0;
+    bool released = false;
+};
+
+/*
+ * GraphicsDevice that needs no GPU so frames run headless for CPU profiling. Buffers live in system memory and
+ * count towards the resource totals. Released objects stay allocated until the device is destroyed so a handle is
+ * never reused while some tracker still caches it.
+ */
+class NullGraphicsDevice : public GraphicsDevice
+{
+public:
+    NullGraphicsDevice();
+
+private:
+    GraphicsCapabilities capabilities;
+    NullGraphicsContext immediateContext;
+    std::vector<std::unique_ptr<NullBuffer>> buffers;
+    std::vector<std::unique_ptr<std::string>> objects;
+    uint32_t liveBuffersAmount = 0;
+    uint64_t liveBufferBytes = 0;
+
+public:
+    const GraphicsCapabilities& getCapabilities() const override;
+    GraphicsBuffer createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                const char* bufferName = nullptr) override;
+    void releaseBuffer(GraphicsBuffer& buffer) override;
+    StateHandle createFence() override;
+    void releaseFence(StateHandle fence) override;
+    GraphicsContext* getImmediateContext() override;
+    NullGraphicsContext* getNullContext();
+
+    /*
+     * Stand-in for objects only a real API creates, shaders, views and pipeline states
+     */
+    StateHandle createObject(const char* objectName);
+    uint32_t getLiveBuffersAmount() const;
+    uint64_t getLiveBufferBytes() const;
+};
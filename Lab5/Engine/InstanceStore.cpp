@@ -0,0 +1,111 @@
+#include "InstanceStore.h"
+
+#include <cmath>
+#include <cstring>
+
+uint32_t InstanceStore::addInstance(const XMMATRIX& transform, float metallicValue, float roughnessValue,
+                                    const XMFLOAT3& albedoValue)
+{
+    XMFLOAT4X4 storedTransform;
+    XMStoreFloat4x4(&storedTransform, transform);
+    transforms.push_back(storedTransform);
+    metallic.push_back(metallicValue);
+    roughness.push_back(roughnessValue);
+    albedo.push_back(albedoValue);
+    bounds.push(0, 0, 0, 0);
+    writeBounds((uint32_t)transforms.size() - 1, storedTransform);
+    return (uint32_t)transforms.size() - 1;
+}
+
+void InstanceStore::setTransform(uint32_t index, const XMMATRIX& transform)
+{
+    XMStoreFloat4x4(&transforms[index], transform);
+    writeBounds(index, transforms[index]);
+}
+
+void InstanceStore::setMaterial(uint32_t index, float metallicValue, float roughnessValue)
+{
+    metallic[index] = metallicValue;
+    roughness[index] = roughnessValue;
+}
+
+void InstanceStore::setMeshBoundingRadius(float radius)
+{
+    meshBoundingRadius = radius;
+    for (uint32_t i = 0; i < size(); i++)
+    {
+        writeBounds(i, transforms[i]);
+    }
+}
+
+const BoundingSpheres& InstanceStore::getBounds() const
+{
+    return bounds;
+}
+
+void InstanceStore::reserve(uint32_t instancesAmount)
+{
+    transforms.reserve(instancesAmount);
+    metallic.reserve(instancesAmount);
+    roughness.reserve(instancesAmount);
+    albedo.reserve(instancesAmount);
+    bounds.centerX.reserve(instancesAmount);
+    bounds.centerY.reserve(instancesAmount);
+    bounds.centerZ.reserve(instancesAmount);
+    bounds.radius.reserve(instancesAmount);
+}
+
+void InstanceStore::clear()
+{
+    transforms.clear();
+    metallic.clear();
+    roughness.clear();
+    albedo.clear();
+    bounds.clear();
+}
+
+uint32_t InstanceStore::size() const
+{
+    return (uint32_t)transforms.size();
+}
+
+void InstanceStore::pack(InstanceData* pOutput) const
+{
+    const uint32_t instancesAmount = size();
+    for (uint32_t i = 0; i < instancesAmount; i++)
+    {
+        InstanceData& instance = pOutput[i];
+        memcpy(&instance.worldMatrix, &transforms[i], sizeof(XMFLOAT4X4));
+        instance.albedo = albedo[i];
+        instance.metallic = metallic[i];
+        instance.roughness = roughness[i];
+    }
+}
+
+void InstanceStore::pack(const uint32_t* pIndices, uint32_t indicesAmount, InstanceData* pOutput) const
+{
+    for (uint32_t i = 0; i < indicesAmount; i++)
+    {
+        uint32_t index = pIndices[i];
+        InstanceData& instance = pOutput[i];
+        memcpy(&instance.worldMatrix, &transforms[index], sizeof(XMFLOAT4X4));
+        instance.albedo = albedo[index];
+        instance.metallic = metallic[index];
+        instance.roughness = roughness[index];
+    }
+}
+
+void InstanceStore::writeBounds(uint32_t index, const XMFLOAT4X4& transform)
+{
+    float maxScaleSquared = 0;
+    for (uint32_t row = 0; row < 3; row++)
+    {
+        float scaleSquared = transform.m[row][0] * transform.m[row][0] + transform.m[row][1] * transform.m[row][1] +
+            transform.m[row][2] * transform.m[row][2];
+        maxScaleSquared = scaleSquared > maxScaleSquared ? scaleSquared : maxScaleSquared;
+    }
+    bounds.centerX[index] = transform._41;
+    bounds.centerY[index] = transform._42;
+    bounds.centerZ[index] = transform._43;
+    bounds.radius[index] = meshBoundingRadius * sqrtf(maxScaleSquared);
+}
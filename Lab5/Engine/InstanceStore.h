@@ -0,0 +1,52 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "Culling/FrustumCuller.h"
+
+using namespace DirectX;
+
+/*
+ * GPU side layout of one instance, must match InstanceData in Shaders/Lighting/VertexShader.hlsl
+ */
+struct InstanceData
+{
+    XMFLOAT4X4 worldMatrix;
+    XMFLOAT3 albedo;
+    float metallic;
+    float roughness;
+    float padding[3];
+};
+
+/*
+ * Structure of arrays storage for instanced meshes, every attribute lives in its own stream
+ * and is interleaved into InstanceData only when the frame is packed for upload.
+ */
+class InstanceStore
+{
+private:
+    std::vector<XMFLOAT4X4> transforms;
+    std::vector<float> metallic;
+    std::vector<float> roughness;
+    std::vector<XMFLOAT3> albedo;
+    BoundingSpheres bounds;
+    float meshBoundingRadius = 1.0f;
+
+public:
+    uint32_t addInstance(const XMMATRIX& transform, float metallicValue, float roughnessValue,
+                         const XMFLOAT3& albedoValue);
+    void setTransform(uint32_t index, const XMMATRIX& transform);
+    void setMaterial(uint32_t index, float metallicValue, float roughnessValue);
+    void setMeshBoundingRadius(float radius);
+    const BoundingSpheres& getBounds() const;
+    void reserve(uint32_t instancesAmount);
+    void clear();
+    uint32_t size() const;
+
+    void pack(InstanceData* pOutput) const;
+    void pack(const uint32_t* pIndices, uint32_t indicesAmount, InstanceData* pOutput) const;
+
+private:
+    void writeBounds(uint32_t index, const XMFLOAT4X4& transform);
+};
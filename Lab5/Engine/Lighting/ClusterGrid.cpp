@@ -0,0 +1,251 @@
+#include "ClusterGrid.h"
+
+#include <cmath>
+#include <emmintrin.h>
+#include "../../Utils/JobSystem.h"
+
+#define CLUSTER_MIN_LIGHTS_PER_THREAD 1024
+
+namespace
+{
+    inline uint32_t clusterIndex(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return x + y * CLUSTER_GRID_X + z * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+    }
+
+    inline float minOf(float a, float b)
+    {
+        return a < b ? a : b;
+    }
+
+    inline float maxOf(float a, float b)
+    {
+        return a > b ? a : b;
+    }
+}
+
+uint32_t ClusterGrid::getClustersAmount()
+{
+    return CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+}
+
+void ClusterGrid::build(const ClusterGridParameters& gridParameters)
+{
+    parameters = gridParameters;
+    const uint32_t clustersAmount = getClustersAmount();
+    minX.resize(clustersAmount);
+    minY.resize(clustersAmount);
+    minZ.resize(clustersAmount);
+    maxX.resize(clustersAmount);
+    maxY.resize(clustersAmount);
+    maxZ.resize(clustersAmount);
+    ranges.resize(clustersAmount);
+
+    float nearPlane = maxOf(parameters.nearPlane, CLUSTER_MIN_NEAR_PLANE);
+    float depthRange = logf(parameters.farPlane / nearPlane);
+    depthScale = CLUSTER_GRID_Z / depthRange;
+    depthBias = CLUSTER_GRID_Z * logf(nearPlane) / depthRange;
+
+    float tanHalfY = tanf(parameters.fovYRadians * 0.5f);
+    float tanHalfX = tanHalfY * parameters.aspectRatio;
+    for (uint32_t z = 0; z < CLUSTER_GRID_Z; z++)
+    {
+        // The first slice also covers everything between the camera and the clustering near plane
+        float sliceNear = z == 0 ? 0.0f : nearPlane * powf(parameters.farPlane / nearPlane, (float)z / CLUSTER_GRID_Z);
+        float sliceFar = nearPlane * powf(parameters.farPlane / nearPlane, (float)(z + 1) / CLUSTER_GRID_Z);
+        for (uint32_t y = 0; y < CLUSTER_GRID_Y; y++)
+        {
+            float ndcTop = 1.0f - 2.0f * y / CLUSTER_GRID_Y;
+            float ndcBottom = 1.0f - 2.0f * (y + 1) / CLUSTER_GRID_Y;
+            for (uint32_t x = 0; x < CLUSTER_GRID_X; x++)
+            {
+                float ndcLeft = -1.0f + 2.0f * x / CLUSTER_GRID_X;
+                float ndcRight = -1.0f + 2.0f * (x + 1) / CLUSTER_GRID_X;
+                float xs[4] = {
+                    ndcLeft * sliceNear * tanHalfX, ndcRight * sliceNear * tanHalfX,
+                    ndcLeft * sliceFar * tanHalfX, ndcRight * sliceFar * tanHalfX
+                };
+                float ys[4] = {
+                    ndcTop * sliceNear * tanHalfY, ndcBottom * sliceNear * tanHalfY,
+                    ndcTop * sliceFar * tanHalfY, ndcBottom * sliceFar * tanHalfY
+                };
+                uint32_t index = clusterIndex(x, y, z);
+                minX[index] = minOf(minOf(xs[0], xs[1]), minOf(xs[2], xs[3]));
+                maxX[index] = maxOf(maxOf(xs[0], xs[1]), maxOf(xs[2], xs[3]));
+                minY[index] = minOf(minOf(ys[0], ys[1]), minOf(ys[2], ys[3]));
+                maxY[index] = maxOf(maxOf(ys[0], ys[1]), maxOf(ys[2], ys[3]));
+                minZ[index] = sliceNear;
+                maxZ[index] = sliceFar;
+            }
+        }
+    }
+}
+
+bool ClusterGrid::isBuiltFor(const ClusterGridParameters& gridParameters) const
+{
+    return !minX.empty() && parameters.fovYRadians == gridParameters.fovYRadians &&
+        parameters.aspectRatio == gridParameters.aspectRatio && parameters.nearPlane == gridParameters.nearPlane &&
+        parameters.farPlane == gridParameters.farPlane;
+}
+
+void ClusterGrid::assignLights(const float* viewMatrix, const ClusterLight* pLights, uint32_t lightsAmount,
+                               JobSystem* pJobs)
+{
+    lightX.clear();
+    lightY.clear();
+    lightZ.clear();
+    lightRadius.clear();
+    activeLights.clear();
+    for (uint32_t i = 0; i < lightsAmount; i++)
+    {
+        const ClusterLight& light = pLights[i];
+        if (light.radius <= 0)
+        {
+            continue;
+        }
+        const float* p = light.position;
+        float z = p[0] * viewMatrix[2] + p[1] * viewMatrix[6] + p[2] * viewMatrix[10] + viewMatrix[14];
+        if (z + light.radius < 0 || z - light.radius > parameters.farPlane)
+        {
+            continue;
+        }
+        lightX.push_back(p[0] * viewMatrix[0] + p[1] * viewMatrix[4] + p[2] * viewMatrix[8] + viewMatrix[12]);
+        lightY.push_back(p[0] * viewMatrix[1] + p[1] * viewMatrix[5] + p[2] * viewMatrix[9] + viewMatrix[13]);
+        lightZ.push_back(z);
+        lightRadius.push_back(light.radius);
+        activeLights.push_back(i);
+    }
+
+    sliceIndices.resize(CLUSTER_GRID_Z);
+    sliceCounts.resize(CLUSTER_GRID_Z);
+    uint32_t activeLightsAmount = (uint32_t)activeLights.size();
+    if (!pJobs || pJobs->getThreadsAmount() <= 1 || activeLightsAmount < CLUSTER_MIN_LIGHTS_PER_THREAD)
+    {
+        for (uint32_t z = 0; z < CLUSTER_GRID_Z; z++)
+        {
+            assignSlice(z, activeLightsAmount);
+        }
+    }
+    else
+    {
+        pJobs->parallelFor(CLUSTER_GRID_Z, 1, [this, activeLightsAmount](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t z = begin; z < end; z++)
+            {
+                assignSlice(z, activeLightsAmount);
+            }
+        });
+    }
+
+    lightIndices.clear();
+    for (uint32_t z = 0; z < CLUSTER_GRID_Z; z++)
+    {
+        uint32_t offset = (uint32_t)lightIndices.size();
+        for (uint32_t tile = 0; tile < CLUSTER_GRID_X * CLUSTER_GRID_Y; tile++)
+        {
+            ClusterRange& range = ranges[z * CLUSTER_GRID_X * CLUSTER_GRID_Y + tile];
+            range.offset = offset;
+            range.count = sliceCounts[z][tile];
+            offset += range.count;
+        }
+        lightIndices.insert(lightIndices.end(), sliceIndices[z].begin(), sliceIndices[z].end());
+    }
+}
+
+void ClusterGrid::assignSlice(uint32_t slice, uint32_t activeLightsAmount)
+{
+    thread_local std::vector<float> candidateX;
+    thread_local std::vector<float> candidateY;
+    thread_local std::vector<float> candidateZ;
+    thread_local std::vector<float> candidateRadiusSquared;
+    thread_local std::vector<uint32_t> candidateIndices;
+    candidateX.clear();
+    candidateY.clear();
+    candidateZ.clear();
+    candidateRadiusSquared.clear();
+    candidateIndices.clear();
+
+    uint32_t firstCluster = clusterIndex(0, 0, slice);
+    float sliceNear = minZ[firstCluster];
+    float sliceFar = maxZ[firstCluster];
+    for (uint32_t i = 0; i < activeLightsAmount; i++)
+    {
+        if (lightZ[i] + lightRadius[i] >= sliceNear && lightZ[i] - lightRadius[i] <= sliceFar)
+        {
+            candidateX.push_back(lightX[i]);
+            candidateY.push_back(lightY[i]);
+            candidateZ.push_back(lightZ[i]);
+            candidateRadiusSquared.push_back(lightRadius[i] * lightRadius[i]);
+            candidateIndices.push_back(activeLights[i]);
+        }
+    }
+    // Pad to a multiple of 4 with lights that can never pass the overlap test
+    while (candidateX.size() % 4)
+    {
+        candidateX.push_back(1e18f);
+        candidateY.push_back(1e18f);
+        candidateZ.push_back(1e18f);
+        candidateRadiusSquared.push_back(0);
+        candidateIndices.push_back(0);
+    }
+
+    std::vector<uint32_t>& indices = sliceIndices[slice];
+    std::vector<uint32_t>& counts = sliceCounts[slice];
+    indices.clear();
+    counts.assign(CLUSTER_GRID_X * CLUSTER_GRID_Y, 0);
+    const __m128 zero = _mm_setzero_ps();
+    const uint32_t candidatesAmount = (uint32_t)candidateX.size();
+    for (uint32_t tile = 0; tile < CLUSTER_GRID_X * CLUSTER_GRID_Y; tile++)
+    {
+        uint32_t cluster = firstCluster + tile;
+        __m128 boxMinX = _mm_set1_ps(minX[cluster]);
+        __m128 boxMinY = _mm_set1_ps(minY[cluster]);
+        __m128 boxMinZ = _mm_set1_ps(minZ[cluster]);
+        __m128 boxMaxX = _mm_set1_ps(maxX[cluster]);
+        __m128 boxMaxY = _mm_set1_ps(maxY[cluster]);
+        __m128 boxMaxZ = _mm_set1_ps(maxZ[cluster]);
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < candidatesAmount; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(candidateX.data() + i);
+            __m128 y = _mm_loadu_ps(candidateY.data() + i);
+            __m128 z = _mm_loadu_ps(candidateZ.data() + i);
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(boxMinX, x), _mm_sub_ps(x, boxMaxX)), zero);
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(boxMinY, y), _mm_sub_ps(y, boxMaxY)), zero);
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(boxMinZ, z), _mm_sub_ps(z, boxMaxZ)), zero);
+            __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                                                _mm_mul_ps(dz, dz));
+            int mask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared,
+                                                    _mm_loadu_ps(candidateRadiusSquared.data() + i)));
+            for (uint32_t lane = 0; mask; lane++, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    indices.push_back(candidateIndices[i + lane]);
+                    count++;
+                }
+            }
+        }
+        counts[tile] = count;
+    }
+}
+
+const std::vector<ClusterRange>& ClusterGrid::getRanges() const
+{
+    return ranges;
+}
+
+const std::vector<uint32_t>& ClusterGrid::getLightIndices() const
+{
+    return lightIndices;
+}
+
+float ClusterGrid::getDepthScale() const
+{
+    return depthScale;
+}
+
+float ClusterGrid::getDepthBias() const
+{
+    return depthBias;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+#define CLUSTER_MIN_NEAR_PLANE 0.1f
+
+class JobSystem;
+
+/*
+ * Must match PointLight in Shaders/Lighting/PBRPixelShader.hlsl
+ */
+struct ClusterLight
+{
+    float position[3];
+    float intensity;
+    float radius;
+    float padding[3];
+};
+
+struct ClusterRange
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct ClusterGridParameters
+{
+    float fovYRadians;
+    float aspectRatio;
+    float nearPlane;
+    float farPlane;
+};
+
+/*
+ * Froxel grid over the view frustum, CLUSTER_GRID_X * CLUSTER_GRID_Y screen tiles and CLUSTER_GRID_Z exponential
+ * depth slices. Every cluster keeps a view space AABB, lights are binned against them on the CPU and the result
+ * is a compact list of light indices with an (offset, count) range per cluster.
+ */
+class ClusterGrid
+{
+public:
+    static uint32_t getClustersAmount();
+
+private:
+    ClusterGridParameters parameters{};
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> minZ;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+    std::vector<float> maxZ;
+    float depthScale = 0;
+    float depthBias = 0;
+
+    std::vector<float> lightX;
+    std::vector<float> lightY;
+    std::vector<float> lightZ;
+    std::vector<float> lightRadius;
+    std::vector<uint32_t> activeLights;
+    std::vector<std::vector<uint32_t>> sliceIndices;
+    std::vector<std::vector<uint32_t>> sliceCounts;
+    std::vector<ClusterRange> ranges;
+    std::vector<uint32_t> lightIndices;
+
+public:
+    void build(const ClusterGridParameters& gridParameters);
+    bool isBuiltFor(const ClusterGridParameters& gridParameters) const;
+    /*
+     * viewMatrix is row-major and transforms row vectors (DirectXMath convention), depth slices are assigned as
+     * jobs of pJobs when there is one
+     */
+    void assignLights(const float* viewMatrix, const ClusterLight* pLights, uint32_t lightsAmount,
+                      JobSystem* pJobs = nullptr);
+
+    const std::vector<ClusterRange>& getRanges() const;
+    const std::vector<uint32_t>& getLightIndices() const;
+    float getDepthScale() const;
+    float getDepthBias() const;
+
+private:
+    void assignSlice(uint32_t slice, uint32_t activeLightsAmount);
+};
@@ -0,0 +1,209 @@
+#include "GpuTimer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include "../../Utils/FrameArena.h"
+
+GpuTimer::GpuTimer(GpuTimestampQueries* pQueries, uint32_t maxPasses, uint32_t contextsAmount) :
+    queries(pQueries), maxPasses(maxPasses)
+{
+    searchStarts.resize(contextsAmount, 0);
+    openPasses.resize(contextsAmount, GPU_TIMER_NO_PASS);
+    for (auto& frame : frames)
+    {
+        frame.timedPasses.resize(maxPasses, 0);
+    }
+}
+
+uint32_t GpuTimer::getTimestampsAmount(uint32_t maxPasses)
+{
+    return GPU_TIMER_PASS_BEGIN(maxPasses);
+}
+
+void GpuTimer::setPasses(const std::vector<const ProfileZoneDesc*>& zones)
+{
+    passZones = zones;
+}
+
+void GpuTimer::beginFrame()
+{
+    if (frameOpen)
+    {
+        throw std::runtime_error("GPU timer frame begins before the previous one ended");
+    }
+    // Frames finish in submission order, the first one still running ends the read back
+    while (collectedFramesAmount < framesAmount)
+    {
+        uint32_t slot = (uint32_t)(collectedFramesAmount % GPU_TIMER_FRAMES_IN_FLIGHT);
+        if (!collect(slot))
+        {
+            if (framesAmount - collectedFramesAmount < GPU_TIMER_FRAMES_IN_FLIGHT)
+            {
+                break;
+            }
+            // The slot is needed for the new frame, waiting for it would stall the CPU on the GPU
+            droppedFramesAmount++;
+        }
+        collectedFramesAmount++;
+    }
+    uint32_t slot = (uint32_t)(framesAmount % GPU_TIMER_FRAMES_IN_FLIGHT);
+    std::fill(frames[slot].timedPasses.begin(), frames[slot].timedPasses.end(), (uint8_t)0);
+    std::fill(searchStarts.begin(), searchStarts.end(), 0u);
+    std::fill(openPasses.begin(), openPasses.end(), GPU_TIMER_NO_PASS);
+    queries->beginFrame(slot);
+    queries->writeTimestamp(0, slot, GPU_TIMER_FRAME_BEGIN);
+    frameOpen = true;
+}
+
+void GpuTimer::beginPass(uint32_t context, const ProfileZoneDesc* zone)
+{
+    if (!frameOpen)
+    {
+        return;
+    }
+    // A context runs its passes in graph order, so a pass that appears twice is told apart by its position
+    uint32_t passesAmount = passZones.size() < maxPasses ? (uint32_t)passZones.size() : maxPasses;
+    for (uint32_t i = searchStarts[context]; i < passesAmount; i++)
+    {
+        if (passZones[i] == zone)
+        {
+            searchStarts[context] = i + 1;
+            openPasses[context] = i;
+            queries->writeTimestamp(context, (uint32_t)(framesAmount % GPU_TIMER_FRAMES_IN_FLIGHT),
+                                    GPU_TIMER_PASS_BEGIN(i));
+            return;
+        }
+    }
+}
+
+void GpuTimer::endPass(uint32_t context)
+{
+    uint32_t pass = openPasses[context];
+    if (pass == GPU_TIMER_NO_PASS)
+    {
+        return;
+    }
+    uint32_t slot = (uint32_t)(framesAmount % GPU_TIMER_FRAMES_IN_FLIGHT);
+    queries->writeTimestamp(context, slot, GPU_TIMER_PASS_END(pass));
+    // Every pass has its own byte, contexts recording in parallel never write the same one
+    frames[slot].timedPasses[pass] = 1;
+    openPasses[context] = GPU_TIMER_NO_PASS;
+}
+
+void GpuTimer::endFrame()
+{
+    if (!frameOpen)
+    {
+        throw std::runtime_error("GPU timer frame ends before it began");
+    }
+    uint32_t slot = (uint32_t)(framesAmount % GPU_TIMER_FRAMES_IN_FLIGHT);
+    queries->writeTimestamp(0, slot, GPU_TIMER_FRAME_END);
+    queries->endFrame(slot);
+    frames[slot].zones = passZones;
+    frameOpen = false;
+    framesAmount++;
+}
+
+void GpuTimer::getTimings(std::vector<GpuPassTiming>& timingsOutput) const
+{
+    timingsOutput.resize(passStats.size() + 1);
+    timingsOutput[0].name = "Frame";
+    timingsOutput[0].summary = frameMilliseconds.getSummary();
+    for (size_t i = 0; i < passStats.size(); i++)
+    {
+        timingsOutput[i + 1].name = passStats[i].zone->name;
+        timingsOutput[i + 1].summary = passStats[i].milliseconds.getSummary();
+    }
+}
+
+uint64_t GpuTimer::getDroppedFramesAmount() const
+{
+    return droppedFramesAmount;
+}
+
+uint64_t GpuTimer::getDisjointFramesAmount() const
+{
+    return disjointFramesAmount;
+}
+
+bool GpuTimer::collect(uint32_t frameSlot)
+{
+    uint64_t frequency;
+    GpuQueryStatus status = queries->readFrequency(frameSlot, &frequency);
+    if (status == GPU_QUERY_NOT_READY)
+    {
+        return false;
+    }
+    if (status == GPU_QUERY_DISJOINT || frequency == 0)
+    {
+        disjointFramesAmount++;
+        return true;
+    }
+    // Everything is read before any statistic changes, a frame that is not ready is read again as a whole
+    const FrameSlot& frame = frames[frameSlot];
+    uint32_t passesAmount = frame.zones.size() < maxPasses ? (uint32_t)frame.zones.size() : maxPasses;
+    FrameVector<uint64_t> timestamps(GPU_TIMER_PASS_BEGIN(passesAmount), 0);
+    for (uint32_t i = 0; i < timestamps.size(); i++)
+    {
+        bool timed = i < GPU_TIMER_PASS_BEGIN(0) || frame.timedPasses[(i - GPU_TIMER_PASS_BEGIN(0)) / 2];
+        if (timed && !queries->readTimestamp(frameSlot, i, &timestamps[i]))
+        {
+            return false;
+        }
+    }
+    double millisecondsPerTick = 1000.0 / (double)frequency;
+    if (timestamps[GPU_TIMER_FRAME_END] >= timestamps[GPU_TIMER_FRAME_BEGIN])
+    {
+        frameMilliseconds.add(
+            (double)(timestamps[GPU_TIMER_FRAME_END] - timestamps[GPU_TIMER_FRAME_BEGIN]) * millisecondsPerTick);
+    }
+    for (uint32_t i = 0; i < passesAmount; i++)
+    {
+        uint64_t begin = timestamps[GPU_TIMER_PASS_BEGIN(i)];
+        uint64_t end = timestamps[GPU_TIMER_PASS_END(i)];
+        if (frame.timedPasses[i] && end >= begin)
+        {
+            getPassStats(frame.zones[i]).add((double)(end - begin) * millisecondsPerTick);
+        }
+    }
+    return true;
+}
+
+RollingTimingStats& GpuTimer::getPassStats(const ProfileZoneDesc* zone)
+{
+    for (auto& stats : passStats)
+    {
+        if (stats.zone == zone)
+        {
+            return stats.milliseconds;
+        }
+    }
+    passStats.push_back({zone, RollingTimingStats()});
+    return passStats.back().milliseconds;
+}
+
+void writeGpuTimingsCsv(const std::string& path, const std::vector<GpuPassTiming>& timings)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open GPU timings file " + path);
+    }
+    file << "pass,samples,last_ms,min_ms,avg_ms,p99_ms\n";
+    for (auto& timing : timings)
+    {
+        // Pass names are plain text, quotes keep commas in them from splitting the row
+        std::string name;
+        for (char c : timing.name)
+        {
+            name += c == '"' ? "\"\"" : std::string(1, c);
+        }
+        file << '"' << name << "\"," << timing.summary.samplesAmount << ',' << timing.summary.last << ',' <<
+            timing.summary.min << ',' << timing.summary.average << ',' << timing.summary.p99 << '\n';
+    }
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write GPU timings file " + path);
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TimingStats.h"
+#include "../../Utils/Profiler.h"
+
+// Frames whose queries may still be on the GPU, a frame is given up when its slot is needed again
+#define GPU_TIMER_FRAMES_IN_FLIGHT 4u
+#define GPU_TIMER_NO_PASS 0xFFFFFFFFu
+// Timestamps around the whole frame come first, then a begin and an end per pass
+#define GPU_TIMER_FRAME_BEGIN 0u
+#define GPU_TIMER_FRAME_END 1u
+#define GPU_TIMER_PASS_BEGIN(pass) (2u + 2u * (pass))
+#define GPU_TIMER_PASS_END(pass) (3u + 2u * (pass))
+
+enum GpuQueryStatus
+{
+    GPU_QUERY_NOT_READY = 0,
+    // The clock changed frequency during the frame, its timestamps are meaningless
+    GPU_QUERY_DISJOINT = 1,
+    GPU_QUERY_READY = 2
+};
+
+/*
+ * Query sets of the graphics API, one per frame slot. Reads never wait for the GPU.
+ */
+class GpuTimestampQueries
+{
+public:
+    virtual ~GpuTimestampQueries() = default;
+    virtual void beginFrame(uint32_t frameSlot) = 0;
+    virtual void endFrame(uint32_t frameSlot) = 0;
+    /*
+     * Context is the render graph context the pass is recorded on
+     */
+    virtual void writeTimestamp(uint32_t context, uint32_t frameSlot, uint32_t timestamp) = 0;
+    /*
+     * Ticks per second of the timestamps of the frame
+     */
+    virtual GpuQueryStatus readFrequency(uint32_t frameSlot, uint64_t* pFrequencyOutput) = 0;
+    virtual bool readTimestamp(uint32_t frameSlot, uint32_t timestamp, uint64_t* pTimestampOutput) = 0;
+};
+
+struct GpuPassTiming
+{
+    std::string name;
+    // Milliseconds
+    TimingSummary summary;
+};
+
+/*
+ * Times the frame and every render graph pass on the GPU. The frames go around a ring of query sets, a frame is
+ * read back when it comes around again, a few frames after it was submitted, so the CPU never waits for the GPU.
+ * Contexts record their passes in parallel, each context on one thread at a time.
+ */
+class GpuTimer
+{
+public:
+    GpuTimer(GpuTimestampQueries* pQueries, uint32_t maxPasses, uint32_t contextsAmount);
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+private:
+    struct PassStats
+    {
+        const ProfileZoneDesc* zone;
+        RollingTimingStats milliseconds;
+    };
+
+    struct FrameSlot
+    {
+        // The passes at the end of the frame, in execution order
+        std::vector<const ProfileZoneDesc*> zones;
+        std::vector<uint8_t> timedPasses;
+    };
+
+    GpuTimestampQueries* queries;
+    uint32_t maxPasses;
+    std::vector<const ProfileZoneDesc*> passZones;
+    FrameSlot frames[GPU_TIMER_FRAMES_IN_FLIGHT];
+    // Frames begun and frames read back or given up, the ones in between are in flight
+    uint64_t framesAmount = 0;
+    uint64_t collectedFramesAmount = 0;
+    bool frameOpen = false;
+    // Per context: where the search for the next pass starts and the pass open on it
+    std::vector<uint32_t> searchStarts;
+    std::vector<uint32_t> openPasses;
+    RollingTimingStats frameMilliseconds;
+    std::vector<PassStats> passStats;
+    uint64_t droppedFramesAmount = 0;
+    uint64_t disjointFramesAmount = 0;
+
+public:
+    /*
+     * Timestamps every frame slot needs
+     */
+    static uint32_t getTimestampsAmount(uint32_t maxPasses);
+
+    /*
+     * The passes of the compiled graph in execution order, passes past maxPasses are not timed
+     */
+    void setPasses(const std::vector<const ProfileZoneDesc*>& zones);
+    /*
+     * Reads back every finished frame, then starts timing a new one
+     */
+    void beginFrame();
+    void beginPass(uint32_t context, const ProfileZoneDesc* zone);
+    void endPass(uint32_t context);
+    void endFrame();
+    /*
+     * The whole frame first, then the passes in the order they were first timed. Reuses what timingsOutput holds, so
+     * refreshing the same vector every frame allocates nothing once the names fit.
+     */
+    void getTimings(std::vector<GpuPassTiming>& timingsOutput) const;
+    uint64_t getDroppedFramesAmount() const;
+    uint64_t getDisjointFramesAmount() const;
+
+private:
+    /*
+     * False while the frame is still on the GPU
+     */
+    bool collect(uint32_t frameSlot);
+    RollingTimingStats& getPassStats(const ProfileZoneDesc* zone);
+};
+
+/*
+ * One row per timing: name, samples, last, min, average and p99 milliseconds. Throws std::runtime_error when the
+ * file cannot be written.
+ */
+void writeGpuTimingsCsv(const std::string& path, const std::vector<GpuPassTiming>& timings);
@@ -0,0 +1,309 @@
+#include "StartupTimeline.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    std::atomic<uint32_t> nextThreadIndex{0};
+    thread_local uint32_t threadIndex = STARTUP_NO_THREAD;
+
+    uint32_t getThreadIndex()
+    {
+        if (threadIndex == STARTUP_NO_THREAD)
+        {
+            threadIndex = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+        }
+        return threadIndex;
+    }
+}
+
+StartupTimeline::StartupTimeline() : startTime(Clock::now())
+{
+}
+
+StartupTimeline& StartupTimeline::getShared()
+{
+    static StartupTimeline timeline;
+    return timeline;
+}
+
+void StartupTimeline::start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // The thread that starts the timeline is thread 0 when it is the first to use one
+    getThreadIndex();
+    startTime = Clock::now();
+}
+
+uint32_t StartupTimeline::addPhase(const std::string& name)
+{
+    if (finished.load(std::memory_order_acquire))
+    {
+        return STARTUP_NO_PHASE;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished.load(std::memory_order_relaxed))
+    {
+        return STARTUP_NO_PHASE;
+    }
+    phases.emplace_back();
+    phases.back().name = name;
+    beginCounters.emplace_back();
+    return (uint32_t)phases.size() - 1;
+}
+
+void StartupTimeline::addDependency(uint32_t phase, uint32_t dependency)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isValidLocked(phase) && dependency < phases.size() && dependency != phase)
+    {
+        phases[phase].dependencies.push_back(dependency);
+    }
+}
+
+void StartupTimeline::beginPhase(uint32_t phase)
+{
+    ThreadCounters counters = ThreadCounting::get();
+    uint32_t thread = getThreadIndex();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isValidLocked(phase) || phases[phase].started)
+    {
+        return;
+    }
+    StartupPhaseRecord& record = phases[phase];
+    record.started = true;
+    record.threadIndex = thread;
+    record.previousOnThread = thread < lastPhaseOnThread.size() ? lastPhaseOnThread[thread] : STARTUP_NO_PHASE;
+    record.startMilliseconds = getMilliseconds(Clock::now());
+    beginCounters[phase] = counters;
+}
+
+void StartupTimeline::endPhase(uint32_t phase)
+{
+    Clock::time_point end = Clock::now();
+    ThreadCounters counters = ThreadCounting::get();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isValidLocked(phase) || !phases[phase].started || phases[phase].finished)
+    {
+        return;
+    }
+    StartupPhaseRecord& record = phases[phase];
+    const ThreadCounters& begin = beginCounters[phase];
+    record.finished = true;
+    record.endMilliseconds = getMilliseconds(end);
+    record.cpuMilliseconds = counters.cpuMilliseconds - begin.cpuMilliseconds;
+    record.bytesRead = counters.bytesRead - begin.bytesRead;
+    record.allocationsAmount = counters.allocationsAmount - begin.allocationsAmount;
+    record.allocatedBytes = counters.allocatedBytes - begin.allocatedBytes;
+    if (record.threadIndex >= lastPhaseOnThread.size())
+    {
+        lastPhaseOnThread.resize(record.threadIndex + 1, STARTUP_NO_PHASE);
+    }
+    lastPhaseOnThread[record.threadIndex] = phase;
+}
+
+void StartupTimeline::setPhaseTimes(uint32_t phase, Clock::time_point begin, Clock::time_point end)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!isValidLocked(phase) || phases[phase].started)
+    {
+        return;
+    }
+    StartupPhaseRecord& record = phases[phase];
+    record.started = true;
+    record.finished = true;
+    record.startMilliseconds = getMilliseconds(begin);
+    record.endMilliseconds = std::max(getMilliseconds(end), record.startMilliseconds);
+}
+
+bool StartupTimeline::isFinished() const
+{
+    return finished.load(std::memory_order_acquire);
+}
+
+bool StartupTimeline::finish()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    finishMilliseconds = getMilliseconds(Clock::now());
+    finished.store(true, std::memory_order_release);
+    return true;
+}
+
+std::vector<StartupPhaseRecord> StartupTimeline::getPhases() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return phases;
+}
+
+std::vector<uint32_t> StartupTimeline::getCriticalPath() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return getCriticalPathLocked();
+}
+
+void StartupTimeline::writeReport(std::ostream& stream) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    double totalMilliseconds = finished.load(std::memory_order_relaxed) ? finishMilliseconds
+                                                                       : getMilliseconds(Clock::now());
+    std::vector<uint32_t> criticalPath = getCriticalPathLocked();
+    std::vector<bool> critical(phases.size(), false);
+    for (uint32_t phase : criticalPath)
+    {
+        critical[phase] = true;
+    }
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < phases.size(); i++)
+    {
+        if (phases[i].started)
+        {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        return phases[a].startMilliseconds < phases[b].startMilliseconds;
+    });
+
+    std::ios::fmtflags flags = stream.flags();
+    stream << std::fixed << std::setprecision(1);
+    stream << "Startup: " << totalMilliseconds << (finished.load(std::memory_order_relaxed) ?
+        " ms to the first present, " : " ms so far, ") << phases.size() << " phases" << std::endl;
+    stream << std::setw(9) << "start ms" << std::setw(10) << "wall ms" << std::setw(10) << "cpu ms" <<
+        std::setw(11) << "read KB" << std::setw(9) << "allocs" << std::setw(11) << "alloc KB" << std::setw(8) <<
+        "thread" << "  phase" << std::endl;
+    for (uint32_t phase : order)
+    {
+        const StartupPhaseRecord& record = phases[phase];
+        stream << std::setw(9) << record.startMilliseconds << std::setw(10);
+        if (record.finished)
+        {
+            stream << record.endMilliseconds - record.startMilliseconds;
+        }
+        else
+        {
+            stream << "open";
+        }
+        if (record.threadIndex == STARTUP_NO_THREAD)
+        {
+            stream << std::setw(10) << "-" << std::setw(11) << "-" << std::setw(9) << "-" << std::setw(11) << "-" <<
+                std::setw(8) << "-";
+        }
+        else
+        {
+            stream << std::setw(10) << record.cpuMilliseconds << std::setw(11) << record.bytesRead / 1024.0 <<
+                std::setw(9) << record.allocationsAmount << std::setw(11) << record.allocatedBytes / 1024.0 <<
+                std::setw(8) << record.threadIndex;
+        }
+        stream << (critical[phase] ? "  * " : "    ") << record.name;
+        for (size_t i = 0; i < record.dependencies.size(); i++)
+        {
+            stream << (i ? ", " : " (after ") << phases[record.dependencies[i]].name;
+        }
+        stream << (record.dependencies.empty() ? "" : ")") << std::endl;
+    }
+    for (const StartupPhaseRecord& record : phases)
+    {
+        if (!record.started)
+        {
+            stream << "  never ran: " << record.name << std::endl;
+        }
+    }
+
+    // Each phase of the path is only charged for the time after its predecessor ended, the rest ran in parallel
+    double pathMilliseconds = 0;
+    double previousEnd = 0;
+    std::ostringstream steps;
+    steps << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < criticalPath.size(); i++)
+    {
+        const StartupPhaseRecord& record = phases[criticalPath[i]];
+        double charged = record.endMilliseconds - std::max(record.startMilliseconds, i ? previousEnd : 0.0);
+        charged = std::max(charged, 0.0);
+        pathMilliseconds += charged;
+        previousEnd = record.endMilliseconds;
+        steps << (i ? " > " : "") << record.name << " " << charged;
+    }
+    stream << "Critical path: " << pathMilliseconds << " ms in phases, " << totalMilliseconds - pathMilliseconds <<
+        " ms outside of them" << std::endl;
+    stream << "  " << steps.str() << std::endl;
+    stream.flags(flags);
+}
+
+double StartupTimeline::getMilliseconds(Clock::time_point time) const
+{
+    return std::chrono::duration<double, std::milli>(time - startTime).count();
+}
+
+bool StartupTimeline::isValidLocked(uint32_t phase) const
+{
+    return phase < phases.size() && !finished.load(std::memory_order_relaxed);
+}
+
+std::vector<uint32_t> StartupTimeline::getCriticalPathLocked() const
+{
+    std::vector<uint32_t> path;
+    uint32_t current = STARTUP_NO_PHASE;
+    for (uint32_t i = 0; i < phases.size(); i++)
+    {
+        if (phases[i].finished && (current == STARTUP_NO_PHASE ||
+            phases[i].endMilliseconds > phases[current].endMilliseconds))
+        {
+            current = i;
+        }
+    }
+    std::vector<bool> visited(phases.size(), false);
+    while (current != STARTUP_NO_PHASE)
+    {
+        path.push_back(current);
+        visited[current] = true;
+        const StartupPhaseRecord& record = phases[current];
+        uint32_t latest = STARTUP_NO_PHASE;
+        auto consider = [&](uint32_t candidate)
+        {
+            if (candidate == STARTUP_NO_PHASE || visited[candidate] || !phases[candidate].finished ||
+                phases[candidate].endMilliseconds > record.endMilliseconds)
+            {
+                return;
+            }
+            if (latest == STARTUP_NO_PHASE || phases[candidate].endMilliseconds > phases[latest].endMilliseconds)
+            {
+                latest = candidate;
+            }
+        };
+        consider(record.previousOnThread);
+        for (uint32_t dependency : record.dependencies)
+        {
+            consider(dependency);
+        }
+        current = latest;
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+StartupPhase::StartupPhase(const std::string& name) : phase(StartupTimeline::getShared().addPhase(name))
+{
+    StartupTimeline::getShared().beginPhase(phase);
+}
+
+uint32_t StartupPhase::getId() const
+{
+    return phase;
+}
+
+void StartupPhase::dependsOn(uint32_t dependency)
+{
+    StartupTimeline::getShared().addDependency(phase, dependency);
+}
+
+StartupPhase::~StartupPhase()
+{
+    StartupTimeline::getShared().endPhase(phase);
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../../Utils/ThreadCounters.h"
+
+#define STARTUP_NO_PHASE 0xFFFFFFFFu
+// Phases timed from outside of any one thread
+#define STARTUP_NO_THREAD 0xFFFFFFFFu
+
+/*
+ * Times relative to StartupTimeline::start, the counters are those of the thread that ran the phase
+ */
+struct StartupPhaseRecord
+{
+    std::string name;
+    // Phases this one waited for, the phase ended last on the same thread is implied
+    std::vector<uint32_t> dependencies;
+    uint32_t threadIndex = STARTUP_NO_THREAD;
+    uint32_t previousOnThread = STARTUP_NO_PHASE;
+    bool started = false;
+    bool finished = false;
+    double startMilliseconds = 0;
+    double endMilliseconds = 0;
+    double cpuMilliseconds = 0;
+    uint64_t bytesRead = 0;
+    uint64_t allocationsAmount = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+/*
+ * Phases of the work between start and the first presented frame, any thread may add and run them. finish freezes
+ * the timeline, calls after it are ignored so the instrumented code keeps running unchanged once startup is over.
+ * Phases of one thread must not overlap, the critical path treats them as running one after another.
+ */
+class StartupTimeline
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    StartupTimeline();
+    StartupTimeline(const StartupTimeline&) = delete;
+    StartupTimeline& operator=(const StartupTimeline&) = delete;
+
+    static StartupTimeline& getShared();
+
+private:
+    mutable std::mutex mutex;
+    Clock::time_point startTime;
+    std::vector<StartupPhaseRecord> phases;
+    // Counters of the running thread when each phase began
+    std::vector<ThreadCounters> beginCounters;
+    // Phase that ended last on each thread, by thread index
+    std::vector<uint32_t> lastPhaseOnThread;
+    std::atomic<bool> finished{false};
+    double finishMilliseconds = 0;
+
+public:
+    /*
+     * Zero of every phase time, the shared timeline starts when it is first used otherwise
+     */
+    void start();
+    /*
+     * Declares a phase without running it, so others can depend on it before it starts
+     */
+    uint32_t addPhase(const std::string& name);
+    void addDependency(uint32_t phase, uint32_t dependency);
+    /*
+     * Runs the phase on the calling thread
+     */
+    void beginPhase(uint32_t phase);
+    void endPhase(uint32_t phase);
+    /*
+     * For work measured elsewhere, the phase gets no thread and no counters
+     */
+    void setPhaseTimes(uint32_t phase, Clock::time_point begin, Clock::time_point end);
+    bool isFinished() const;
+    /*
+     * Returns true on the call that froze the timeline
+     */
+    bool finish();
+
+    std::vector<StartupPhaseRecord> getPhases() const;
+    /*
+     * From the first phase to the one that ended last, every step the predecessor that ended last
+     */
+    std::vector<uint32_t> getCriticalPath() const;
+    /*
+     * Table of the phases in start order followed by the critical path
+     */
+    void writeReport(std::ostream& stream) const;
+
+private:
+    double getMilliseconds(Clock::time_point time) const;
+    bool isValidLocked(uint32_t phase) const;
+    std::vector<uint32_t> getCriticalPathLocked() const;
+};
+
+/*
+ * Adds and runs a phase for the lifetime of the object
+ */
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const std::string& name);
+    StartupPhase(const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+private:
+    uint32_t phase;
+
+public:
+    uint32_t getId() const;
+    void dependsOn(uint32_t dependency);
+    ~StartupPhase();
+};
@@ -0,0 +1,55 @@
+#include "TimingStats.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include "../../Utils/FrameArena.h"
+
+RollingTimingStats::RollingTimingStats(uint32_t window)
+{
+    if (window == 0)
+    {
+        throw std::runtime_error("Timing statistics need a window of at least one sample");
+    }
+    samples.resize(window);
+}
+
+void RollingTimingStats::add(double sample)
+{
+    samples[next] = sample;
+    next = (next + 1) % (uint32_t)samples.size();
+    if (samplesAmount < samples.size())
+    {
+        samplesAmount++;
+    }
+}
+
+TimingSummary RollingTimingStats::getSummary() const
+{
+    TimingSummary summary;
+    summary.samplesAmount = samplesAmount;
+    if (samplesAmount == 0)
+    {
+        return summary;
+    }
+    summary.last = samples[(next + (uint32_t)samples.size() - 1) % (uint32_t)samples.size()];
+    // Until the window fills up the samples are the first ones of the vector
+    FrameVector<double> sorted(samples.begin(), samples.begin() + samplesAmount);
+    double sum = 0;
+    summary.min = sorted[0];
+    for (double sample : sorted)
+    {
+        sum += sample;
+        summary.min = sample < summary.min ? sample : summary.min;
+    }
+    summary.average = sum / samplesAmount;
+    uint32_t rank = (samplesAmount * 99 + 99) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + (rank - 1), sorted.end());
+    summary.p99 = sorted[rank - 1];
+    return summary;
+}
+
+void RollingTimingStats::clear()
+{
+    next = 0;
+    samplesAmount = 0;
+}
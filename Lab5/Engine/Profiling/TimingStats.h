@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Samples a rolling window keeps, about four seconds at 60 frames per second
+#define TIMING_STATS_WINDOW 240u
+
+struct TimingSummary
+{
+    uint32_t samplesAmount = 0;
+    double last = 0;
+    double min = 0;
+    double average = 0;
+    // Nearest rank, the smallest sample at least 99% of the window does not exceed
+    double p99 = 0;
+};
+
+/*
+ * Statistics over the most recent samples of one measurement, older samples are overwritten
+ */
+class RollingTimingStats
+{
+public:
+    explicit RollingTimingStats(uint32_t window = TIMING_STATS_WINDOW);
+
+private:
+    std::vector<double> samples;
+    uint32_t next = 0;
+    uint32_t samplesAmount = 0;
+
+public:
+    void add(double sample);
+    TimingSummary getSummary() const;
+    void clear();
+};
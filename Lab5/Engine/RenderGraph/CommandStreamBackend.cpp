@@ -0,0 +1,106 @@
+#include "CommandStreamBackend.h"
+
+#include <stdexcept>
+
+CommandStreamBackend::CommandStreamBackend(uint32_t recordingContextsAmount, uint64_t textureSize) :
+    recordingContextsAmount(recordingContextsAmount), textureSize(textureSize),
+    contextStreams(recordingContextsAmount + 1), commandLists(recordingContextsAmount)
+{
+}
+
+uint64_t CommandStreamBackend::getTextureSize(const RenderGraphTextureDesc&)
+{
+    return textureSize;
+}
+
+void CommandStreamBackend::realize(const RenderGraph&)
+{
+}
+
+uint32_t CommandStreamBackend::getRecordingContextsAmount()
+{
+    return recordingContextsAmount;
+}
+
+void CommandStreamBackend::beginRecording(RenderGraphContext context)
+{
+    if (context == RENDER_GRAPH_IMMEDIATE_CONTEXT || context > recordingContextsAmount)
+    {
+        throw std::runtime_error("Command stream recording started on an invalid context");
+    }
+    contextStreams[context].clear();
+}
+
+void CommandStreamBackend::finishRecording(RenderGraphContext context, uint32_t list)
+{
+    commandLists[list] = std::move(contextStreams[context]);
+    contextStreams[context].clear();
+}
+
+void CommandStreamBackend::submitRecording(uint32_t list)
+{
+    submitted.insert(submitted.end(), commandLists[list].begin(), commandLists[list].end());
+    commandLists[list].clear();
+}
+
+void CommandStreamBackend::acquireTexture(RenderGraphContext context, RenderGraphResource resource, bool aliased)
+{
+    append(context, COMMAND_STREAM_ACQUIRE_TEXTURE, resource, aliased ? "aliased" : "");
+}
+
+void CommandStreamBackend::unbindRenderTargets(RenderGraphContext context)
+{
+    append(context, COMMAND_STREAM_UNBIND_RENDER_TARGETS, 0, "");
+}
+
+void CommandStreamBackend::unbindShaderResources(RenderGraphContext context)
+{
+    append(context, COMMAND_STREAM_UNBIND_SHADER_RESOURCES, 0, "");
+}
+
+void CommandStreamBackend::bindPassTargets(RenderGraphContext context,
+                                           const std::vector<RenderGraphResource>& targets)
+{
+    for (auto target : targets)
+    {
+        append(context, COMMAND_STREAM_BIND_TARGET, target, "");
+    }
+}
+
+void CommandStreamBackend::beginPass(RenderGraphContext context, const ProfileZoneDesc* zone)
+{
+    append(context, COMMAND_STREAM_BEGIN_PASS, 0, zone->name);
+}
+
+void CommandStreamBackend::endPass(RenderGraphContext context)
+{
+    append(context, COMMAND_STREAM_END_PASS, 0, "");
+}
+
+void CommandStreamBackend::record(RenderGraphContext context, uint32_t value, const std::string& name)
+{
+    append(context, COMMAND_STREAM_PASS_COMMAND, value, name);
+}
+
+const std::vector<CommandStreamEntry>& CommandStreamBackend::getSubmittedStream() const
+{
+    return submitted;
+}
+
+void CommandStreamBackend::clearSubmittedStream()
+{
+    submitted.clear();
+}
+
+void CommandStreamBackend::append(RenderGraphContext context, CommandStreamOp op, uint32_t value,
+                                  const std::string& name)
+{
+    if (context == RENDER_GRAPH_IMMEDIATE_CONTEXT)
+    {
+        submitted.push_back({op, value, name});
+    }
+    else
+    {
+        contextStreams[context].push_back({op, value, name});
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RenderGraph.h"
+
+enum CommandStreamOp
+{
+    COMMAND_STREAM_ACQUIRE_TEXTURE,
+    COMMAND_STREAM_UNBIND_RENDER_TARGETS,
+    COMMAND_STREAM_UNBIND_SHADER_RESOURCES,
+    // One entry per bound target
+    COMMAND_STREAM_BIND_TARGET,
+    COMMAND_STREAM_BEGIN_PASS,
+    COMMAND_STREAM_END_PASS,
+    // Written by passes through record
+    COMMAND_STREAM_PASS_COMMAND
+};
+
+struct CommandStreamEntry
+{
+    CommandStreamOp op;
+    uint32_t value;
+    std::string name;
+};
+
+/*
+ * Render graph backend without a graphics API. Every context appends to its own in-memory command stream, the
+ * immediate context and submitted command lists append to the submitted stream, so the submitted stream of a
+ * parallel execution can be compared against a serial one. Every texture takes textureSize heap bytes.
+ */
+class CommandStreamBackend : public RenderGraphBackend
+{
+public:
+    CommandStreamBackend(uint32_t recordingContextsAmount, uint64_t textureSize = RENDER_GRAPH_HEAP_ALIGNMENT);
+
+private:
+    uint32_t recordingContextsAmount;
+    uint64_t textureSize;
+    // Index 0 is unused, the immediate context writes straight into submitted
+    std::vector<std::vector<CommandStreamEntry>> contextStreams;
+    std::vector<std::vector<CommandStreamEntry>> commandLists;
+    std::vector<CommandStreamEntry> submitted;
+
+public:
+    uint64_t getTextureSize(const RenderGraphTextureDesc& desc) override;
+    void realize(const RenderGraph& graph) override;
+    uint32_t getRecordingContextsAmount() override;
+    void beginRecording(RenderGraphContext context) override;
+    void finishRecording(RenderGraphContext context, uint32_t list) override;
+    void submitRecording(uint32_t list) override;
+    void acquireTexture(RenderGraphContext context, RenderGraphResource resource, bool aliased) override;
+    void unbindRenderTargets(RenderGraphContext context) override;
+    void unbindShaderResources(RenderGraphContext context) override;
+    void bindPassTargets(RenderGraphContext context, const std::vector<RenderGraphResource>& targets) override;
+    void beginPass(RenderGraphContext context, const ProfileZoneDesc* zone) override;
+    void endPass(RenderGraphContext context) override;
+
+    /*
+     * Appends a COMMAND_STREAM_PASS_COMMAND entry, called by pass execute functions
+     */
+    void record(RenderGraphContext context, uint32_t value, const std::string& name = std::string());
+    const std::vector<CommandStreamEntry>& getSubmittedStream() const;
+    void clearSubmittedStream();
+
+private:
+    void append(RenderGraphContext context, CommandStreamOp op, uint32_t value, const std::string& name);
+};
@@ -0,0 +1,472 @@
+#include "DXRenderGraphBackend.h"
+
+#include <stdexcept>
+#include <string>
+#include "../../DXDevice/DXResourceTracking.h"
+#include "../../Utils/DXGIFormatSize.h"
+
+#define DX_RENDER_GRAPH_OWNER "Render graph"
+
+namespace
+{
+    /*
+     * 0 for the formats without a standard tile shape
+     */
+    uint32_t getTiledBytesPerPixel(DXGI_FORMAT format)
+    {
+        if (isDXGIFormatBlockCompressed(format) || isDXGIFormatPacked(format))
+        {
+            return 0;
+        }
+        uint32_t bitsPerPixel = getDXGIFormatBitsPerPixel(format);
+        uint32_t bytesPerPixel = bitsPerPixel / 8;
+        if (bitsPerPixel % 8 || bytesPerPixel == 0 || bytesPerPixel & (bytesPerPixel - 1))
+        {
+            return 0;
+        }
+        return bytesPerPixel;
+    }
+
+    /*
+     * Standard 64KB tile shapes of 2D textures
+     */
+    void getTileShape(uint32_t bytesPerPixel, uint32_t& tileWidth, uint32_t& tileHeight)
+    {
+        switch (bytesPerPixel)
+        {
+        case 1:
+            tileWidth = 256;
+            tileHeight = 256;
+            break;
+        case 2:
+            tileWidth = 256;
+            tileHeight = 128;
+            break;
+        case 4:
+            tileWidth = 128;
+            tileHeight = 128;
+            break;
+        case 8:
+            tileWidth = 128;
+            tileHeight = 64;
+            break;
+        default:
+            tileWidth = 64;
+            tileHeight = 64;
+            break;
+        }
+    }
+
+    void releaseView(IUnknown* view)
+    {
+        if (view)
+        {
+            view->Release();
+        }
+    }
+
+    void trackGraphView(ID3D11View* view, const std::string& name)
+    {
+        if (view)
+        {
+            trackView(view, name.c_str(), DX_RENDER_GRAPH_OWNER);
+        }
+    }
+}
+
+DXRenderGraphBackend::DXRenderGraphBackend(ID3D11Device* device, DXStateContext* stateContext,
+                                           ID3DUserDefinedAnnotation* annotation, uint32_t recordingContextsAmount) :
+    device(device), immediateContext(stateContext->getContext())
+{
+    GraphContext immediate;
+    immediate.stateContext = stateContext;
+    immediate.annotation = annotation;
+    immediateContext->QueryInterface(IID_PPV_ARGS(&immediate.context2));
+    contexts.push_back(immediate);
+
+    D3D11_FEATURE_DATA_D3D11_OPTIONS1 options = {};
+    if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS1, &options, sizeof(options))) &&
+        options.TiledResourcesTier != D3D11_TILED_RESOURCES_NOT_SUPPORTED &&
+        SUCCEEDED(device->QueryInterface(IID_PPV_ARGS(&device2))) && immediate.context2)
+    {
+        tiledResourcesSupported = true;
+    }
+
+    for (uint32_t i = 0; i < recordingContextsAmount; i++)
+    {
+        ID3D11DeviceContext* deferredContext;
+        if (FAILED(device->CreateDeferredContext(0, &deferredContext)))
+        {
+            throw std::runtime_error("Failed to create render graph recording context");
+        }
+        GraphContext recordingContext;
+        recordingContext.stateContext = new DXStateContext(deferredContext);
+        deferredContext->QueryInterface(IID_PPV_ARGS(&recordingContext.context2));
+        deferredContext->QueryInterface(IID_PPV_ARGS(&recordingContext.annotation));
+        contexts.push_back(recordingContext);
+    }
+    commandLists.resize(recordingContextsAmount, nullptr);
+
+    std::vector<ID3D11DeviceContext*> timedContexts;
+    for (auto& graphContext : contexts)
+    {
+        timedContexts.push_back(graphContext.stateContext->getContext());
+    }
+    timestampQueries = new DXTimestampQueries(device, timedContexts,
+                                              GpuTimer::getTimestampsAmount(DX_RENDER_GRAPH_TIMED_PASSES_AMOUNT));
+    gpuTimer = new GpuTimer(timestampQueries, DX_RENDER_GRAPH_TIMED_PASSES_AMOUNT, (uint32_t)contexts.size());
+}
+
+uint64_t DXRenderGraphBackend::getTextureSize(const RenderGraphTextureDesc& desc)
+{
+    uint32_t bytesPerPixel = getTiledBytesPerPixel((DXGI_FORMAT)desc.format);
+    if (!tiledResourcesSupported || bytesPerPixel == 0 || (desc.usage & RENDER_GRAPH_USAGE_DEPTH_STENCIL))
+    {
+        return 0;
+    }
+    uint32_t tileWidth;
+    uint32_t tileHeight;
+    getTileShape(bytesPerPixel, tileWidth, tileHeight);
+    uint64_t tilesAmount = (uint64_t)((desc.width + tileWidth - 1) / tileWidth) *
+        ((desc.height + tileHeight - 1) / tileHeight);
+    return tilesAmount * DX_RENDER_GRAPH_TILE_SIZE;
+}
+
+void DXRenderGraphBackend::realize(const RenderGraph& graph)
+{
+    releaseTextures();
+    std::vector<const ProfileZoneDesc*> passZones;
+    for (auto& pass : graph.getCompiledPasses())
+    {
+        passZones.push_back(pass.profileZone);
+    }
+    gpuTimer->setPasses(passZones);
+    if (graph.getHeapSize() > tilePoolSize)
+    {
+        createTilePool(graph.getHeapSize());
+    }
+    textures.resize(graph.getResourcesAmount());
+    for (uint32_t i = 0; i < graph.getResourcesAmount(); i++)
+    {
+        const RenderGraphResourceInfo& info = graph.getResource(i);
+        if (info.imported || !info.used)
+        {
+            continue;
+        }
+        GraphTexture& graphTexture = textures[i];
+        graphTexture.desc = info.desc;
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = info.desc.width;
+        desc.Height = info.desc.height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = (DXGI_FORMAT)info.desc.format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = (info.desc.usage & RENDER_GRAPH_USAGE_RENDER_TARGET ? D3D11_BIND_RENDER_TARGET : 0) |
+            (info.desc.usage & RENDER_GRAPH_USAGE_SHADER_RESOURCE ? D3D11_BIND_SHADER_RESOURCE : 0) |
+            (info.desc.usage & RENDER_GRAPH_USAGE_DEPTH_STENCIL ? D3D11_BIND_DEPTH_STENCIL : 0);
+        desc.MiscFlags = info.size ? D3D11_RESOURCE_MISC_TILED : 0;
+        if (FAILED(device->CreateTexture2D(&desc, nullptr, &graphTexture.texture)))
+        {
+            throw std::runtime_error("Failed to create render graph texture " + info.name);
+        }
+        trackTexture(graphTexture.texture, info.name.c_str(), DX_RENDER_GRAPH_OWNER);
+#if defined(_DEBUG)
+        graphTexture.texture->SetPrivateData(WKPDID_D3DDebugObjectName, (UINT)info.name.length(), info.name.c_str());
+#endif
+        if (info.size)
+        {
+            UINT tilesAmount = 0;
+            device2->GetResourceTiling(graphTexture.texture, &tilesAmount, nullptr, nullptr, nullptr, 0, nullptr);
+            if (tilesAmount * DX_RENDER_GRAPH_TILE_SIZE > info.size)
+            {
+                throw std::runtime_error("Render graph texture " + info.name + " needs more tiles than reserved");
+            }
+            D3D11_TILED_RESOURCE_COORDINATE startCoordinate = {};
+            D3D11_TILE_REGION_SIZE regionSize = {};
+            regionSize.NumTiles = tilesAmount;
+            UINT poolStartOffset = (UINT)(info.heapOffset / DX_RENDER_GRAPH_TILE_SIZE);
+            if (FAILED(contexts[RENDER_GRAPH_IMMEDIATE_CONTEXT].context2->UpdateTileMappings(
+                graphTexture.texture, 1, &startCoordinate, &regionSize, tilePool, 1, nullptr, &poolStartOffset,
+                &tilesAmount, 0)))
+            {
+                throw std::runtime_error("Failed to map render graph texture " + info.name);
+            }
+        }
+        if (info.desc.usage & RENDER_GRAPH_USAGE_RENDER_TARGET &&
+            FAILED(device->CreateRenderTargetView(graphTexture.texture, nullptr, &graphTexture.renderTargetView)))
+        {
+            throw std::runtime_error("Failed to create render target view for " + info.name);
+        }
+        if (info.desc.usage & RENDER_GRAPH_USAGE_SHADER_RESOURCE &&
+            FAILED(device->CreateShaderResourceView(graphTexture.texture, nullptr, &graphTexture.shaderResourceView)))
+        {
+            throw std::runtime_error("Failed to create shader resource view for " + info.name);
+        }
+        if (info.desc.usage & RENDER_GRAPH_USAGE_DEPTH_STENCIL &&
+            FAILED(device->CreateDepthStencilView(graphTexture.texture, nullptr, &graphTexture.depthStencilView)))
+        {
+            throw std::runtime_error("Failed to create depth stencil view for " + info.name);
+        }
+        trackGraphView(graphTexture.renderTargetView, info.name);
+        trackGraphView(graphTexture.shaderResourceView, info.name);
+        trackGraphView(graphTexture.depthStencilView, info.name);
+    }
+}
+
+uint32_t DXRenderGraphBackend::getRecordingContextsAmount()
+{
+    return (uint32_t)commandLists.size();
+}
+
+void DXRenderGraphBackend::beginRecording(RenderGraphContext context)
+{
+    // Deferred contexts start every command list from the default state
+    contexts[context].stateContext->invalidate();
+}
+
+void DXRenderGraphBackend::finishRecording(RenderGraphContext context, uint32_t list)
+{
+    if (commandLists[list])
+    {
+        commandLists[list]->Release();
+        commandLists[list] = nullptr;
+    }
+    if (FAILED(contexts[context].stateContext->getContext()->FinishCommandList(FALSE, &commandLists[list])))
+    {
+        throw std::runtime_error("Failed to finish render graph command list");
+    }
+}
+
+void DXRenderGraphBackend::submitRecording(uint32_t list)
+{
+    immediateContext->ExecuteCommandList(commandLists[list], FALSE);
+    commandLists[list]->Release();
+    commandLists[list] = nullptr;
+    // Executing without restoring leaves the immediate context in the default state
+    contexts[RENDER_GRAPH_IMMEDIATE_CONTEXT].stateContext->invalidate();
+}
+
+void DXRenderGraphBackend::acquireTexture(RenderGraphContext context, RenderGraphResource resource, bool aliased)
+{
+    if (!aliased)
+    {
+        return;
+    }
+    // The memory still holds the texture that used it before, order the accesses and start from defined contents
+    GraphTexture& graphTexture = textures[resource];
+    GraphContext& graphContext = contexts[context];
+    if (graphContext.context2)
+    {
+        graphContext.context2->TiledResourceBarrier(nullptr, graphTexture.texture);
+    }
+    if (graphTexture.renderTargetView)
+    {
+        float clearColor[4] = {0, 0, 0, 0};
+        graphContext.stateContext->getContext()->ClearRenderTargetView(graphTexture.renderTargetView, clearColor);
+    }
+}
+
+void DXRenderGraphBackend::unbindRenderTargets(RenderGraphContext context)
+{
+    contexts[context].stateContext->setRenderTargets(0, (const StateHandle*)nullptr, nullptr);
+}
+
+void DXRenderGraphBackend::unbindShaderResources(RenderGraphContext context)
+{
+    ID3D11ShaderResourceView* resources[DX_RENDER_GRAPH_UNBIND_SLOTS_AMOUNT] = {};
+    contexts[context].stateContext->setPixelShaderResources(0, DX_RENDER_GRAPH_UNBIND_SLOTS_AMOUNT, resources);
+}
+
+void DXRenderGraphBackend::bindPassTargets(RenderGraphContext context,
+                                           const std::vector<RenderGraphResource>& targets)
+{
+    ID3D11RenderTargetView* views[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+    uint32_t viewsAmount = 0;
+    ID3D11DepthStencilView* depthView = nullptr;
+    for (auto target : targets)
+    {
+        const GraphTexture& graphTexture = textures[target];
+        if (graphTexture.depthStencilView)
+        {
+            depthView = graphTexture.depthStencilView;
+        }
+        else if (graphTexture.renderTargetView)
+        {
+            views[viewsAmount++] = graphTexture.renderTargetView;
+        }
+        else
+        {
+            throw std::runtime_error("Render graph pass writes a texture without a target view");
+        }
+    }
+    DXStateContext* stateContext = contexts[context].stateContext;
+    stateContext->setRenderTargets(viewsAmount, views, depthView);
+
+    const RenderGraphTextureDesc& desc = textures[targets.front()].desc;
+    D3D11_VIEWPORT viewport = {0, 0, (FLOAT)desc.width, (FLOAT)desc.height, 0.0f, 1.0f};
+    stateContext->setViewport(viewport);
+}
+
+void DXRenderGraphBackend::beginPass(RenderGraphContext context, const ProfileZoneDesc* zone)
+{
+    if (contexts[context].annotation)
+    {
+        contexts[context].annotation->BeginEvent(zone->wideName);
+    }
+    gpuTimer->beginPass(context, zone);
+}
+
+void DXRenderGraphBackend::endPass(RenderGraphContext context)
+{
+    gpuTimer->endPass(context);
+    if (contexts[context].annotation)
+    {
+        contexts[context].annotation->EndEvent();
+    }
+}
+
+DXStateContext* DXRenderGraphBackend::getStateContext(RenderGraphContext context) const
+{
+    return contexts[context].stateContext;
+}
+
+void DXRenderGraphBackend::beginFrame()
+{
+    for (auto& graphContext : contexts)
+    {
+        graphContext.stateContext->beginFrame();
+    }
+    gpuTimer->beginFrame();
+}
+
+void DXRenderGraphBackend::endFrame()
+{
+    gpuTimer->endFrame();
+}
+
+StateTrackerStats DXRenderGraphBackend::getLastFrameStateStats() const
+{
+    StateTrackerStats stats;
+    for (auto& graphContext : contexts)
+    {
+        stats.issuedCalls += graphContext.stateContext->getLastFrameStats().issuedCalls;
+        stats.filteredCalls += graphContext.stateContext->getLastFrameStats().filteredCalls;
+    }
+    return stats;
+}
+
+void DXRenderGraphBackend::getGpuTimings(std::vector<GpuPassTiming>& timingsOutput) const
+{
+    gpuTimer->getTimings(timingsOutput);
+}
+
+ID3D11Texture2D* DXRenderGraphBackend::getTexture(RenderGraphResource resource) const
+{
+    return textures[resource].texture;
+}
+
+ID3D11RenderTargetView* DXRenderGraphBackend::getRenderTargetView(RenderGraphResource resource) const
+{
+    return textures[resource].renderTargetView;
+}
+
+ID3D11ShaderResourceView* DXRenderGraphBackend::getShaderResourceView(RenderGraphResource resource) const
+{
+    return textures[resource].shaderResourceView;
+}
+
+ID3D11DepthStencilView* DXRenderGraphBackend::getDepthStencilView(RenderGraphResource resource) const
+{
+    return textures[resource].depthStencilView;
+}
+
+void DXRenderGraphBackend::setImportedRenderTarget(RenderGraphResource resource, ID3D11RenderTargetView* view,
+                                                   uint32_t width, uint32_t height)
+{
+    GraphTexture& graphTexture = textures[resource];
+    graphTexture.imported = true;
+    graphTexture.renderTargetView = view;
+    graphTexture.desc.width = width;
+    graphTexture.desc.height = height;
+}
+
+void DXRenderGraphBackend::bindRenderTargets(RenderGraphContext context,
+                                             std::initializer_list<RenderGraphResource> targets,
+                                             RenderGraphResource depthStencil)
+{
+    ID3D11RenderTargetView* views[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+    uint32_t viewsAmount = 0;
+    for (auto target : targets)
+    {
+        views[viewsAmount++] = textures[target].renderTargetView;
+    }
+    ID3D11DepthStencilView* depthView = depthStencil == RENDER_GRAPH_NO_RESOURCE
+                                            ? nullptr
+                                            : textures[depthStencil].depthStencilView;
+    DXStateContext* stateContext = contexts[context].stateContext;
+    stateContext->setRenderTargets(viewsAmount, views, depthView);
+
+    const RenderGraphTextureDesc& desc = textures[viewsAmount ? *targets.begin() : depthStencil].desc;
+    D3D11_VIEWPORT viewport = {0, 0, (FLOAT)desc.width, (FLOAT)desc.height, 0.0f, 1.0f};
+    stateContext->setViewport(viewport);
+}
+
+void DXRenderGraphBackend::createTilePool(uint64_t size)
+{
+    if (tilePool)
+    {
+        releaseTracked(tilePool);
+        tilePool = nullptr;
+    }
+    D3D11_BUFFER_DESC desc = {};
+    desc.ByteWidth = (UINT)size;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_TILE_POOL;
+    if (FAILED(device->CreateBuffer(&desc, nullptr, &tilePool)))
+    {
+        throw std::runtime_error("Failed to create render graph tile pool");
+    }
+    trackBuffer(tilePool, "Tile pool", DX_RENDER_GRAPH_OWNER);
+    tilePoolSize = size;
+}
+
+void DXRenderGraphBackend::releaseTextures()
+{
+    for (auto& graphTexture : textures)
+    {
+        if (graphTexture.imported)
+        {
+            continue;
+        }
+        releaseTracked(graphTexture.renderTargetView);
+        releaseTracked(graphTexture.shaderResourceView);
+        releaseTracked(graphTexture.depthStencilView);
+        releaseTracked(graphTexture.texture);
+    }
+    textures.clear();
+}
+
+DXRenderGraphBackend::~DXRenderGraphBackend()
+{
+    releaseTextures();
+    for (auto commandList : commandLists)
+    {
+        releaseView(commandList);
+    }
+    for (uint32_t i = 0; i < contexts.size(); i++)
+    {
+        releaseView(contexts[i].context2);
+        if (i != RENDER_GRAPH_IMMEDIATE_CONTEXT)
+        {
+            releaseView(contexts[i].annotation);
+            contexts[i].stateContext->getContext()->Release();
+            delete contexts[i].stateContext;
+        }
+    }
+    delete gpuTimer;
+    delete timestampQueries;
+    releaseTracked(tilePool);
+    releaseView(device2);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <d3d11_2.h>
+#include <initializer_list>
+#include <vector>
+#include "RenderGraph.h"
+#include "../../DXDevice/DXStateContext.h"
+#include "../../DXDevice/DXTimestampQueries.h"
+
+#define DX_RENDER_GRAPH_UNBIND_SLOTS_AMOUNT 8
+#define DX_RENDER_GRAPH_TILE_SIZE 65536ull
+// Passes of one frame that get GPU timestamps
+#define DX_RENDER_GRAPH_TIMED_PASSES_AMOUNT 32u
+
+/*
+ * D3D11 side of the render graph. When the device supports tiled resources every color texture is a tiled
+ * resource mapped into one shared tile pool at the offset the graph assigned, so textures with disjoint lifetimes
+ * use the same memory. Depth stencil textures, and everything on devices without tiled resources, get their own
+ * memory. Recording contexts are deferred contexts, their command lists are executed without restoring the
+ * immediate context state. Every pass is timed on the GPU between beginFrame and endFrame.
+ */
+class DXRenderGraphBackend : public RenderGraphBackend
+{
+public:
+    DXRenderGraphBackend(ID3D11Device* device, DXStateContext* stateContext, ID3DUserDefinedAnnotation* annotation,
+                         uint32_t recordingContextsAmount = 0);
+
+private:
+    struct GraphContext
+    {
+        DXStateContext* stateContext = nullptr;
+        ID3D11DeviceContext2* context2 = nullptr;
+        ID3DUserDefinedAnnotation* annotation = nullptr;
+    };
+
+    struct GraphTexture
+    {
+        RenderGraphTextureDesc desc;
+        ID3D11Texture2D* texture = nullptr;
+        ID3D11RenderTargetView* renderTargetView = nullptr;
+        ID3D11ShaderResourceView* shaderResourceView = nullptr;
+        ID3D11DepthStencilView* depthStencilView = nullptr;
+        // Views of imported textures belong to whoever imported them
+        bool imported = false;
+    };
+
+    ID3D11Device* device;
+    ID3D11DeviceContext* immediateContext;
+    ID3D11Device2* device2 = nullptr;
+    bool tiledResourcesSupported = false;
+    // Index 0 is the immediate context, the rest wrap deferred contexts
+    std::vector<GraphContext> contexts;
+    std::vector<ID3D11CommandList*> commandLists;
+    ID3D11Buffer* tilePool = nullptr;
+    uint64_t tilePoolSize = 0;
+    std::vector<GraphTexture> textures;
+    DXTimestampQueries* timestampQueries = nullptr;
+    GpuTimer* gpuTimer = nullptr;
+
+public:
+    uint64_t getTextureSize(const RenderGraphTextureDesc& desc) override;
+    void realize(const RenderGraph& graph) override;
+    uint32_t getRecordingContextsAmount() override;
+    void beginRecording(RenderGraphContext context) override;
+    void finishRecording(RenderGraphContext context, uint32_t list) override;
+    void submitRecording(uint32_t list) override;
+    void acquireTexture(RenderGraphContext context, RenderGraphResource resource, bool aliased) override;
+    void unbindRenderTargets(RenderGraphContext context) override;
+    void unbindShaderResources(RenderGraphContext context) override;
+    void bindPassTargets(RenderGraphContext context, const std::vector<RenderGraphResource>& targets) override;
+    void beginPass(RenderGraphContext context, const ProfileZoneDesc* zone) override;
+    void endPass(RenderGraphContext context) override;
+
+    /*
+     * Context passes bind through, draws and clears go to its getContext
+     */
+    DXStateContext* getStateContext(RenderGraphContext context) const;
+    /*
+     * Starts the state call counters of a new frame on every context
+     */
+    void beginFrame();
+    /*
+     * Closes the GPU timing of the frame, after the last pass and before present
+     */
+    void endFrame();
+    StateTrackerStats getLastFrameStateStats() const;
+    /*
+     * GPU milliseconds of the frame and of every pass over the last frames read back, refreshes timingsOutput in place
+     */
+    void getGpuTimings(std::vector<GpuPassTiming>& timingsOutput) const;
+
+    ID3D11Texture2D* getTexture(RenderGraphResource resource) const;
+    ID3D11RenderTargetView* getRenderTargetView(RenderGraphResource resource) const;
+    ID3D11ShaderResourceView* getShaderResourceView(RenderGraphResource resource) const;
+    ID3D11DepthStencilView* getDepthStencilView(RenderGraphResource resource) const;
+    /*
+     * View the graph binds for an imported texture, set after the graph is compiled and whenever it changes
+     */
+    void setImportedRenderTarget(RenderGraphResource resource, ID3D11RenderTargetView* view, uint32_t width,
+                                 uint32_t height);
+    /*
+     * Binds the render targets and sets the viewport to the size of the first one
+     */
+    void bindRenderTargets(RenderGraphContext context, std::initializer_list<RenderGraphResource> targets,
+                           RenderGraphResource depthStencil = RENDER_GRAPH_NO_RESOURCE);
+    ~DXRenderGraphBackend();
+
+private:
+    void createTilePool(uint64_t size);
+    void releaseTextures();
+};
@@ -0,0 +1,457 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include "../../Utils/FrameArena.h"
+#include "../../Utils/JobSystem.h"
+
+namespace
+{
+    uint64_t alignHeapOffset(uint64_t offset)
+    {
+        return (offset + RENDER_GRAPH_HEAP_ALIGNMENT - 1) / RENDER_GRAPH_HEAP_ALIGNMENT * RENDER_GRAPH_HEAP_ALIGNMENT;
+    }
+
+    bool contains(const std::vector<RenderGraphResource>& list, RenderGraphResource resource)
+    {
+        return std::find(list.begin(), list.end(), resource) != list.end();
+    }
+
+    bool lifetimesOverlap(const RenderGraphResourceInfo& a, const RenderGraphResourceInfo& b)
+    {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    }
+
+    bool memoryOverlaps(uint64_t offset, uint64_t size, const RenderGraphResourceInfo& other)
+    {
+        return offset < other.heapOffset + other.size && other.heapOffset < offset + size;
+    }
+}
+
+RenderGraphResource RenderGraph::createTexture(const std::string& name, const RenderGraphTextureDesc& desc)
+{
+    RenderGraphResourceInfo resource;
+    resource.name = name;
+    resource.desc = desc;
+    resources.push_back(resource);
+    compiled = false;
+    return (RenderGraphResource)resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::importTexture(const std::string& name)
+{
+    RenderGraphResourceInfo resource;
+    resource.name = name;
+    resource.imported = true;
+    resources.push_back(resource);
+    compiled = false;
+    return (RenderGraphResource)resources.size() - 1;
+}
+
+uint32_t RenderGraph::addPass(const RenderGraphPassDesc& pass)
+{
+    for (auto resource : pass.reads)
+    {
+        if (resource >= resources.size())
+        {
+            throw std::runtime_error("Render graph pass " + pass.name + " reads an unknown resource");
+        }
+    }
+    for (auto resource : pass.writes)
+    {
+        if (resource >= resources.size())
+        {
+            throw std::runtime_error("Render graph pass " + pass.name + " writes an unknown resource");
+        }
+    }
+    passes.push_back(pass);
+    compiled = false;
+    return (uint32_t)passes.size() - 1;
+}
+
+void RenderGraph::compile(RenderGraphBackend& backend)
+{
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        for (auto resource : passes[i].reads)
+        {
+            bool written = resources[resource].imported;
+            for (uint32_t writer = 0; writer < i && !written; writer++)
+            {
+                written = contains(passes[writer].writes, resource);
+            }
+            if (!written)
+            {
+                throw std::runtime_error("Render graph pass " + passes[i].name + " reads " +
+                    resources[resource].name + " before any pass writes it");
+            }
+        }
+    }
+    cullPasses();
+    computeLifetimes();
+    placeTransientTextures(backend);
+    computeUnbinds();
+    compiled = true;
+    backend.realize(*this);
+}
+
+void RenderGraph::execute(RenderGraphBackend& backend, JobSystem* pJobs)
+{
+    if (!compiled)
+    {
+        throw std::runtime_error("Render graph is executed before it is compiled");
+    }
+    uint32_t contextsAmount = pJobs ? backend.getRecordingContextsAmount() : 0;
+    uint32_t first = 0;
+    while (first < compiledPasses.size())
+    {
+        if (contextsAmount == 0 || passes[compiledPasses[first].pass].immediate)
+        {
+            executePass(backend, RENDER_GRAPH_IMMEDIATE_CONTEXT, first);
+            first++;
+            continue;
+        }
+        uint32_t end = first;
+        while (end < compiledPasses.size() && !passes[compiledPasses[end].pass].immediate)
+        {
+            end++;
+        }
+        recordPasses(backend, *pJobs, first, end, contextsAmount);
+        first = end;
+    }
+    // Leave nothing bound, the next frame and code outside of the graph start from a clean state
+    backend.unbindRenderTargets(RENDER_GRAPH_IMMEDIATE_CONTEXT);
+    backend.unbindShaderResources(RENDER_GRAPH_IMMEDIATE_CONTEXT);
+}
+
+void RenderGraph::reset()
+{
+    resources.clear();
+    passes.clear();
+    culledPasses.clear();
+    compiledPasses.clear();
+    heapSize = 0;
+    compiled = false;
+}
+
+bool RenderGraph::isCompiled() const
+{
+    return compiled;
+}
+
+bool RenderGraph::isPassCulled(uint32_t pass) const
+{
+    return culledPasses[pass];
+}
+
+const RenderGraphResourceInfo& RenderGraph::getResource(RenderGraphResource resource) const
+{
+    return resources[resource];
+}
+
+uint32_t RenderGraph::getResourcesAmount() const
+{
+    return (uint32_t)resources.size();
+}
+
+const std::vector<RenderGraphCompiledPass>& RenderGraph::getCompiledPasses() const
+{
+    return compiledPasses;
+}
+
+uint64_t RenderGraph::getHeapSize() const
+{
+    return heapSize;
+}
+
+RenderGraphStats RenderGraph::getStats() const
+{
+    RenderGraphStats stats{};
+    stats.passesAmount = (uint32_t)passes.size();
+    stats.culledPassesAmount = (uint32_t)(passes.size() - compiledPasses.size());
+    for (auto& resource : resources)
+    {
+        if (!resource.imported && resource.used)
+        {
+            stats.transientTexturesAmount++;
+            stats.transientBytes += resource.size;
+        }
+    }
+    stats.heapBytes = heapSize;
+    return stats;
+}
+
+void RenderGraph::cullPasses()
+{
+    culledPasses.assign(passes.size(), true);
+    std::vector<uint32_t> alivePasses;
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        bool writesImported = false;
+        for (auto resource : passes[i].writes)
+        {
+            writesImported |= resources[resource].imported;
+        }
+        if (passes[i].sideEffects || writesImported)
+        {
+            culledPasses[i] = false;
+            alivePasses.push_back(i);
+        }
+    }
+    while (!alivePasses.empty())
+    {
+        uint32_t pass = alivePasses.back();
+        alivePasses.pop_back();
+        for (auto resource : passes[pass].reads)
+        {
+            for (uint32_t writer = 0; writer < pass; writer++)
+            {
+                if (culledPasses[writer] && contains(passes[writer].writes, resource))
+                {
+                    culledPasses[writer] = false;
+                    alivePasses.push_back(writer);
+                }
+            }
+        }
+    }
+
+    compiledPasses.clear();
+    for (uint32_t i = 0; i < passes.size(); i++)
+    {
+        if (!culledPasses[i])
+        {
+            RenderGraphCompiledPass compiledPass;
+            compiledPass.pass = i;
+            compiledPass.profileZone = Profiler::registerZone(passes[i].name);
+            compiledPass.bindWrites = passes[i].immediate && !passes[i].writes.empty();
+            compiledPasses.push_back(compiledPass);
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes()
+{
+    for (auto& resource : resources)
+    {
+        resource.used = false;
+        resource.firstPass = 0;
+        resource.lastPass = 0;
+    }
+    for (uint32_t i = 0; i < compiledPasses.size(); i++)
+    {
+        const RenderGraphPassDesc& pass = passes[compiledPasses[i].pass];
+        for (auto* accesses : {&pass.reads, &pass.writes})
+        {
+            for (auto resource : *accesses)
+            {
+                RenderGraphResourceInfo& info = resources[resource];
+                if (!info.used)
+                {
+                    info.used = true;
+                    info.firstPass = i;
+                    if (!info.imported)
+                    {
+                        compiledPasses[i].acquiredResources.push_back(resource);
+                    }
+                }
+                info.lastPass = i;
+            }
+        }
+    }
+}
+
+void RenderGraph::placeTransientTextures(RenderGraphBackend& backend)
+{
+    std::vector<RenderGraphResource> order;
+    for (uint32_t i = 0; i < resources.size(); i++)
+    {
+        RenderGraphResourceInfo& info = resources[i];
+        info.heapOffset = 0;
+        info.size = 0;
+        info.aliased = false;
+        if (!info.imported && info.used)
+        {
+            info.size = backend.getTextureSize(info.desc);
+            if (info.size)
+            {
+                order.push_back(i);
+            }
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [this](RenderGraphResource a, RenderGraphResource b)
+    {
+        if (resources[a].firstPass != resources[b].firstPass)
+        {
+            return resources[a].firstPass < resources[b].firstPass;
+        }
+        return resources[a].size > resources[b].size;
+    });
+
+    // Greedy first fit, a texture goes to the lowest offset that does not overlap any texture alive at the same time
+    heapSize = 0;
+    std::vector<RenderGraphResource> placed;
+    for (auto resource : order)
+    {
+        RenderGraphResourceInfo& info = resources[resource];
+        std::vector<uint64_t> candidates = {0};
+        for (auto other : placed)
+        {
+            if (lifetimesOverlap(info, resources[other]))
+            {
+                candidates.push_back(alignHeapOffset(resources[other].heapOffset + resources[other].size));
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        for (auto offset : candidates)
+        {
+            bool fits = true;
+            for (auto other : placed)
+            {
+                if (lifetimesOverlap(info, resources[other]) && memoryOverlaps(offset, info.size, resources[other]))
+                {
+                    fits = false;
+                    break;
+                }
+            }
+            if (fits)
+            {
+                info.heapOffset = offset;
+                break;
+            }
+        }
+        for (auto other : placed)
+        {
+            info.aliased |= memoryOverlaps(info.heapOffset, info.size, resources[other]);
+        }
+        placed.push_back(resource);
+        heapSize = std::max(heapSize, alignHeapOffset(info.heapOffset + info.size));
+    }
+}
+
+void RenderGraph::executePass(RenderGraphBackend& backend, RenderGraphContext context, uint32_t compiledPass)
+{
+    const RenderGraphCompiledPass& passInfo = compiledPasses[compiledPass];
+    if (passInfo.unbindRenderTargets)
+    {
+        backend.unbindRenderTargets(context);
+    }
+    if (passInfo.unbindShaderResources)
+    {
+        backend.unbindShaderResources(context);
+    }
+    for (auto resource : passInfo.acquiredResources)
+    {
+        backend.acquireTexture(context, resource, resources[resource].aliased);
+    }
+    RenderGraphPassDesc& pass = passes[passInfo.pass];
+    if (passInfo.bindWrites)
+    {
+        backend.bindPassTargets(context, pass.writes);
+    }
+    ProfileZone zone(passInfo.profileZone);
+    backend.beginPass(context, passInfo.profileZone);
+    if (pass.execute)
+    {
+        pass.execute(context);
+    }
+    backend.endPass(context);
+}
+
+void RenderGraph::recordPasses(RenderGraphBackend& backend, JobSystem& jobs, uint32_t first, uint32_t end,
+                               uint32_t contextsAmount)
+{
+    uint32_t passesAmount = end - first;
+    uint32_t chunksAmount = std::min(contextsAmount, passesAmount);
+    // The jobs only capture their chunk, small enough for std::function to store in place
+    struct Chunk
+    {
+        RenderGraph* graph;
+        RenderGraphBackend* pBackend;
+        uint32_t index;
+        uint32_t first;
+        uint32_t end;
+        std::exception_ptr error;
+    };
+
+    FrameVector<Chunk> chunks(chunksAmount);
+    JobCounter recorded;
+    for (uint32_t chunk = 0; chunk < chunksAmount; chunk++)
+    {
+        Chunk* pChunk = &chunks[chunk];
+        *pChunk = {this, &backend, chunk, first + passesAmount * chunk / chunksAmount,
+                   first + passesAmount * (chunk + 1) / chunksAmount, nullptr};
+        jobs.submit([pChunk]()
+        {
+            RenderGraphContext context = pChunk->index + 1;
+            pChunk->pBackend->beginRecording(context);
+            try
+            {
+                for (uint32_t i = pChunk->first; i < pChunk->end; i++)
+                {
+                    pChunk->graph->executePass(*pChunk->pBackend, context, i);
+                }
+            }
+            catch (...)
+            {
+                pChunk->error = std::current_exception();
+            }
+            // Closed even after a failure so the context starts clean next time
+            try
+            {
+                pChunk->pBackend->finishRecording(context, pChunk->index);
+            }
+            catch (...)
+            {
+                if (!pChunk->error)
+                {
+                    pChunk->error = std::current_exception();
+                }
+            }
+        }, &recorded);
+    }
+    jobs.wait(recorded);
+    for (auto& chunk : chunks)
+    {
+        if (chunk.error)
+        {
+            std::rethrow_exception(chunk.error);
+        }
+    }
+    for (uint32_t chunk = 0; chunk < chunksAmount; chunk++)
+    {
+        backend.submitRecording(chunk);
+    }
+}
+
+void RenderGraph::computeUnbinds()
+{
+    std::vector<bool> boundTargets(resources.size(), false);
+    std::vector<bool> boundShaderResources(resources.size(), false);
+    for (auto& compiledPass : compiledPasses)
+    {
+        const RenderGraphPassDesc& pass = passes[compiledPass.pass];
+        for (auto resource : pass.reads)
+        {
+            compiledPass.unbindRenderTargets |= boundTargets[resource];
+        }
+        for (auto resource : pass.writes)
+        {
+            compiledPass.unbindShaderResources |= boundShaderResources[resource];
+        }
+        if (compiledPass.unbindShaderResources)
+        {
+            boundShaderResources.assign(resources.size(), false);
+        }
+        // Binding the targets of a pass replaces all of the previous ones
+        boundTargets.assign(resources.size(), false);
+        for (auto resource : pass.writes)
+        {
+            boundTargets[resource] = true;
+        }
+        for (auto resource : pass.reads)
+        {
+            boundShaderResources[resource] = true;
+        }
+    }
+}
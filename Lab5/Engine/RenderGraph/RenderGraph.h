@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "../../Utils/Profiler.h"
+
+#define RENDER_GRAPH_NO_RESOURCE 0xFFFFFFFFu
+#define RENDER_GRAPH_HEAP_ALIGNMENT 65536ull
+#define RENDER_GRAPH_IMMEDIATE_CONTEXT 0u
+
+class JobSystem;
+
+typedef uint32_t RenderGraphResource;
+/*
+ * Backend context a pass records into, RENDER_GRAPH_IMMEDIATE_CONTEXT executes right away
+ */
+typedef uint32_t RenderGraphContext;
+
+enum RenderGraphUsage
+{
+    RENDER_GRAPH_USAGE_RENDER_TARGET = 1,
+    RENDER_GRAPH_USAGE_SHADER_RESOURCE = 2,
+    RENDER_GRAPH_USAGE_DEPTH_STENCIL = 4
+};
+
+/*
+ * format is a backend value (DXGI_FORMAT for D3D11), the graph only compares it
+ */
+struct RenderGraphTextureDesc
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0;
+    uint32_t usage = 0;
+};
+
+/*
+ * reads are sampled in shaders, writes are bound as render target or depth stencil. A pass that blends into or
+ * depth tests against a texture only writes it, every earlier writer of a texture is kept alive by its readers.
+ * execute may run on a worker thread and has to issue everything through the context it gets. immediate passes
+ * run on the calling thread in order with the recorded ones, for passes that read results back on the CPU or use
+ * code that only knows the immediate context. Recorded passes leave the immediate context without state, so the
+ * graph binds the writes of an immediate pass before it runs.
+ */
+struct RenderGraphPassDesc
+{
+    std::string name;
+    std::vector<RenderGraphResource> reads;
+    std::vector<RenderGraphResource> writes;
+    bool sideEffects = false;
+    bool immediate = false;
+    std::function<void(RenderGraphContext context)> execute;
+};
+
+struct RenderGraphResourceInfo
+{
+    std::string name;
+    RenderGraphTextureDesc desc;
+    bool imported = false;
+    // Filled by compile, indices into the compiled pass list
+    bool used = false;
+    uint32_t firstPass = 0;
+    uint32_t lastPass = 0;
+    // Placement in the transient heap, size 0 means the backend gives the texture its own memory
+    uint64_t heapOffset = 0;
+    uint64_t size = 0;
+    // Shares memory with a texture that died earlier in the frame, contents are undefined on first use
+    bool aliased = false;
+};
+
+struct RenderGraphCompiledPass
+{
+    uint32_t pass;
+    const ProfileZoneDesc* profileZone = nullptr;
+    bool unbindRenderTargets = false;
+    bool unbindShaderResources = false;
+    // Immediate pass with writes, the graph binds them as its targets
+    bool bindWrites = false;
+    // Transient textures used for the first time in this pass
+    std::vector<RenderGraphResource> acquiredResources;
+};
+
+struct RenderGraphStats
+{
+    uint32_t passesAmount;
+    uint32_t culledPassesAmount;
+    uint32_t transientTexturesAmount;
+    // Sum of the heap placed texture sizes against the heap that holds them after aliasing
+    uint64_t transientBytes;
+    uint64_t heapBytes;
+};
+
+class RenderGraph;
+
+/*
+ * Everything the graph needs from the graphics API
+ */
+class RenderGraphBackend
+{
+public:
+    virtual ~RenderGraphBackend() = default;
+    /*
+     * Heap bytes the texture occupies, 0 when it cannot be placed in the shared heap
+     */
+    virtual uint64_t getTextureSize(const RenderGraphTextureDesc& desc) = 0;
+    /*
+     * Creates the textures of a freshly compiled graph
+     */
+    virtual void realize(const RenderGraph& graph) = 0;
+    /*
+     * Contexts 1 to getRecordingContextsAmount record command lists, each on one thread at a time. 0 keeps the
+     * whole graph on the immediate context.
+     */
+    virtual uint32_t getRecordingContextsAmount() = 0;
+    virtual void beginRecording(RenderGraphContext context) = 0;
+    /*
+     * Closes what context recorded into command list slot list, list is below getRecordingContextsAmount
+     */
+    virtual void finishRecording(RenderGraphContext context, uint32_t list) = 0;
+    /*
+     * Plays command list slot list back on the immediate context
+     */
+    virtual void submitRecording(uint32_t list) = 0;
+    virtual void acquireTexture(RenderGraphContext context, RenderGraphResource resource, bool aliased) = 0;
+    virtual void unbindRenderTargets(RenderGraphContext context) = 0;
+    virtual void unbindShaderResources(RenderGraphContext context) = 0;
+    /*
+     * Binds targets as render targets or depth stencil by their usage, the viewport covers the first one
+     */
+    virtual void bindPassTargets(RenderGraphContext context, const std::vector<RenderGraphResource>& targets) = 0;
+    /*
+     * The zone is named after the pass, the graph already times the pass on the CPU
+     */
+    virtual void beginPass(RenderGraphContext context, const ProfileZoneDesc* zone) = 0;
+    virtual void endPass(RenderGraphContext context) = 0;
+};
+
+/*
+ * Frame graph of declared passes. compile culls the passes that contribute neither to an imported texture nor to
+ * a side effect, computes the lifetime of every transient texture, packs the transient textures into one heap so
+ * that textures with disjoint lifetimes share memory and records where render targets and shader resources have
+ * to be unbound before a pass. Passes run in declaration order, so every read must follow a write.
+ */
+class RenderGraph
+{
+private:
+    std::vector<RenderGraphResourceInfo> resources;
+    std::vector<RenderGraphPassDesc> passes;
+    std::vector<bool> culledPasses;
+    std::vector<RenderGraphCompiledPass> compiledPasses;
+    uint64_t heapSize = 0;
+    bool compiled = false;
+
+public:
+    RenderGraphResource createTexture(const std::string& name, const RenderGraphTextureDesc& desc);
+    /*
+     * Texture owned outside of the graph, writing it keeps a pass alive
+     */
+    RenderGraphResource importTexture(const std::string& name);
+    uint32_t addPass(const RenderGraphPassDesc& pass);
+    /*
+     * Throws when a pass reads a transient texture no earlier pass writes
+     */
+    void compile(RenderGraphBackend& backend);
+    /*
+     * With pJobs every run of non immediate passes is split into contiguous chunks, one per recording context,
+     * recorded in parallel as jobs and submitted in pass order
+     */
+    void execute(RenderGraphBackend& backend, JobSystem* pJobs = nullptr);
+    /*
+     * Drops every pass and resource so the graph can be declared again
+     */
+    void reset();
+
+    bool isCompiled() const;
+    bool isPassCulled(uint32_t pass) const;
+    const RenderGraphResourceInfo& getResource(RenderGraphResource resource) const;
+    uint32_t getResourcesAmount() const;
+    const std::vector<RenderGraphCompiledPass>& getCompiledPasses() const;
+    uint64_t getHeapSize() const;
+    RenderGraphStats getStats() const;
+
+private:
+    void cullPasses();
+    void computeLifetimes();
+    void placeTransientTextures(RenderGraphBackend& backend);
+    void computeUnbinds();
+    void executePass(RenderGraphBackend& backend, RenderGraphContext context, uint32_t compiledPass);
+    /*
+     * Records compiled passes [first, end) on the recording contexts and submits them
+     */
+    void recordPasses(RenderGraphBackend& backend, JobSystem& jobs, uint32_t first, uint32_t end,
+                      uint32_t contextsAmount);
+};
@@ -1,47 +1,69 @@
 #include "Renderer.h"
 
 #include <iostream>
-#include <random>
+#include <utility>
 
 #include "../ImGUI/imgui.h"
 #include "../ImGUI/imgui_impl_dx11.h"
 #include "../ImGUI/imgui_impl_win32.h"
 
-#include "tiny_obj_loader.h"
-#include "../STB/stb_image.h"
+#include "Profiling/StartupTimeline.h"
+#include "Resources/ResourceRegistry.h"
+#include "../Utils/FileSystemUtils.h"
+#include "../Utils/ThreadCounters.h"
 
 #define PI 3.14159265359
 
 DXSwapChain* Renderer::swapChain = nullptr;
-Renderer* Renderer::instance = nullptr;
 
-void Renderer::resizeCallback(uint32_t width, uint32_t height)
+Renderer::Renderer(Window* window) : engineWindow(window)
 {
-    if (swapChain)
     {
-        swapChain->resize(width, height);
-        instance->toneMapper->resize(width, height);
+        StartupPhase phase("Request assets");
+        requestAssets();
     }
-}
-
-Renderer::Renderer(Window* window) : engineWindow(window)
-{
-    instance = this;
-    swapChain = device.getSwapChain(window, "Lab5 default swap chain");
-    window->addResizeCallback(resizeCallback);
+    {
+        StartupPhase phase("Create swap chain");
+        swapChain = device.getSwapChain(window, "Lab5 default swap chain");
+    }
+    // The swap chain follows the size of the frame packets, the window may resize while a frame is drawn
+    swapChainWidth = window->getWidth();
+    swapChainHeight = window->getHeight();
     window->getInputSystem()->addKeyCallback(&camera);
     window->getInputSystem()->addMouseCallback(&camera);
+    keys.push_back({DIK_F1, KEY_PRESSED});
+    keys.push_back({DIK_F2, KEY_PRESSED});
+    keys.push_back({DIK_F3, KEY_PRESSED});
     window->getInputSystem()->addKeyCallback(this);
-    loadShader();
-    loadSphere();
-    loadConstants();
-    window->getInputSystem()->addKeyCallback(this);
-    keys.push_back({DIK_F1, KEY_DOWN});
-    keys.push_back({DIK_F2, KEY_DOWN});
-    keys.push_back({DIK_F3, KEY_DOWN});
+    shaderReload = new ShaderHotReload(device.getDevice());
+    {
+        StartupPhase phase("Request shaders");
+        loadShader();
+    }
+    {
+        StartupPhase phase("Create cubemap generator");
+        // The IBL shaders compile while the rest is set up, the generator and the source texture stay alive so
+        // reloaded IBL shaders can re-render their stages
+        cubemapGenerator = new CubemapGenerator(&device, shaderReload);
+    }
     device.getDeviceContext()->QueryInterface(IID_PPV_ARGS(&annotation));
-    toneMapper = new ToneMapper(device.getDevice(), annotation);
-    toneMapper->initialize(window->getWidth(), window->getHeight(), DX_SWAPCHAIN_DEFAULT_BUFFER_AMOUNT);
+    profilerAnnotation = new DXProfilerAnnotation(device.getDeviceContext());
+    {
+        StartupPhase phase("Initialize tone mapper");
+        toneMapper = new ToneMapper(device.getDevice(), device.getGraphicsDevice(), annotation);
+        toneMapper->initialize();
+    }
+    StartupTimeline& timeline = StartupTimeline::getShared();
+    uint32_t statesPhase = timeline.addPhase("Create pipeline states");
+    timeline.beginPhase(statesPhase);
+    // The thread that submits records passes too while it waits for the jobs
+    uint32_t recordingContextsAmount = JobSystem::getShared().getThreadsAmount();
+    if (recordingContextsAmount > RENDERER_MAX_RECORDING_CONTEXTS)
+    {
+        recordingContextsAmount = RENDERER_MAX_RECORDING_CONTEXTS;
+    }
+    renderGraphBackend = new DXRenderGraphBackend(device.getDevice(), device.getStateContext(), annotation,
+                                                  recordingContextsAmount);
 
     D3D11_SAMPLER_DESC desc = {};
 
@@ -96,94 +118,179 @@ Renderer::Renderer(Window* window) : engineWindow(window)
     {
         throw std::runtime_error("Failed to create depth state");
     }
+    timeline.endPhase(statesPhase);
     loadImgui();
+    loadSphere();
     loadCubeMap();
+    {
+        StartupPhase phase("Wait for first shaders");
+        phase.dependsOn(assets->getStartupPhase(cubeMapShaderLoad));
+        constructedPhase = phase.getId();
+        // Only the permutation the first frame draws with is awaited, the rest keep compiling in the background
+        shader = pbrShaders->getShader(pbrMode);
+        drawnPbrMode = pbrMode;
+        sceneState = scene->getState();
+        cubeMapShader = assets->get(cubeMapShaderLoad);
+    }
+    Shader::getCache().logStats();
+    assets->logStats();
+    delete assets;
+    assets = nullptr;
 }
 
-void calcSkyboxSize(SkyboxConfig& config, uint32_t width, uint32_t height, float fovDeg)
+void Renderer::requestAssets()
 {
-    float n = 0.01f;
-    float fov = XMConvertToRadians(fovDeg);
-    float halfW = tanf(fov / 2) * n;
-    float halfH = height / float(width) * halfW;
-    config.size.x = sqrtf(n * n + halfH * halfH + halfW * halfW) * 1.1f;
+    std::wstring directory = FileSystemUtils::getCurrentDirectoryPath();
+    assets = new AssetManager(JobSystem::getShared(), std::string(directory.begin(), directory.end()));
+    sphereMesh = assets->loadMesh("sphere.wvf");
+    environmentMap = assets->loadImage("hdr_room2.hdr");
 }
 
-void Renderer::drawFrame()
+void Renderer::buildFramePacket(FramePacket& packet)
 {
+    PROFILE_ZONE("Build frame packet");
+    engineWindow->getInputSystem()->update();
     drawGui();
-    shaderConstant.cameraMatrix = camera.getViewMatrix();
-
-    XMMATRIX mProjection = DirectX::XMMatrixPerspectiveFovLH(XMConvertToRadians(90),
-                                                             (float)engineWindow->getWidth() / (float)engineWindow->
-                                                             getHeight(), 0.001f, 2000.0f);
-    shaderConstant.cameraMatrix = XMMatrixMultiply(shaderConstant.cameraMatrix, mProjection);
-    skyboxConfig.cameraMatrix = shaderConstant.cameraMatrix;
-    skyboxConfig.cameraPosition = camera.getPosition();
-    calcSkyboxSize(skyboxConfig, engineWindow->getWidth(), engineWindow->getHeight(), 90);
-
-    lightConstantData.cameraPosition = camera.getPosition();
-    constantBuffer->updateData(device.getDeviceContext(), &shaderConstant);
-    lightConstant->updateData(device.getDeviceContext(), &lightConstantData);
-    pbrConfiguration->updateData(device.getDeviceContext(), &configuration);
-    skyboxConfigConstant->updateData(device.getDeviceContext(), &skyboxConfig);
-
-#ifdef _DEBUG
-    annotation->BeginEvent(L"Clear render targets");
-#endif
-    
-    toneMapper->clearRenderTarget(device.getDeviceContext(), swapChain->getCurrentImage());
-#ifdef _DEBUG
-    annotation->EndEvent();
-    annotation->EndEvent();
-#endif
-#ifdef _DEBUG
-    annotation->BeginEvent(L"Rendering skybox");
-#endif
-    toneMapper->getRendertargetView()->bind(device.getDeviceContext(), engineWindow->getWidth(),
-                                            engineWindow->getHeight(), swapChain->getCurrentImage());
-    cubeMapShader->bind(device.getDeviceContext());
-    device.getDeviceContext()->PSSetSamplers(0, 1, &sampler);
-    skyboxConfigConstant->bindToVertexShader(device.getDeviceContext());
-    device.getDeviceContext()->PSSetShaderResources(0, 1, &cubemap.cubemapSRV);
-    device.getDeviceContext()->OMSetDepthStencilState(skyboxDepthState, 1);
-    device.getDeviceContext()->RSSetState(skyboxRasterState);
-    cubeMapShader->draw(device.getDeviceContext(), sphereIndex, sphereVertex);
-
-    toneMapper->getRendertargetView()->clearDepthAttachments(device.getDeviceContext());
-#ifdef _DEBUG
-    annotation->EndEvent();
-#endif
-#ifdef _DEBUG
-    annotation->BeginEvent(L"Rendering pbr light");
-#endif
-    shader->bind(device.getDeviceContext());
-    ID3D11SamplerState* samplers[] = {sampler, avgSampler};
-    
-    device.getDeviceContext()->PSSetSamplers(0, 2, samplers);
-    ID3D11ShaderResourceView* resources[] = {cubemap.irradianceSRV, cubemap.prefilteredSRV, cubemap.brdfSRV};
-    
-    device.getDeviceContext()->PSSetShaderResources(0, 3, resources);
-
-    constantBuffer->bindToVertexShader(device.getDeviceContext());
-    lightConstant->bindToPixelShader(device.getDeviceContext());
-    pbrConfiguration->bindToPixelShader(device.getDeviceContext(), 1);
-    device.getDeviceContext()->OMSetDepthStencilState(defaultDepthState, 1);
-    device.getDeviceContext()->RSSetState(defaultRasterState);
-    shader->draw(device.getDeviceContext(), sphereIndex, sphereVertex);
-#ifdef _DEBUG
-    annotation->EndEvent();
-#endif
-    toneMapper->makeBrightnessMaps(device.getDeviceContext(), swapChain->getCurrentImage());
-    swapChain->clearRenderTargets(device.getDeviceContext(), 0, 0, 0, 1.0f);
-    device.getDeviceContext()->PSSetSamplers(0, 1, &sampler);
-
-    swapChain->bind(device.getDeviceContext(), engineWindow->getWidth(), engineWindow->getHeight());
-    toneMapper->postProcessToneMap(device.getDeviceContext(), swapChain->getCurrentImage());
-    ImGui::Render();
-    ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-    DXDevice::unBindRenderTargets(device.getDeviceContext());
-    swapChain->present(true);
+    packet.view = getSceneView();
+    packet.scene = sceneState;
+    packet.pbrMode = pbrMode;
+    packet.ui.capture(ImGui::GetDrawData());
+}
+
+void Renderer::drawFrame(const FramePacket& packet)
+{
+    PROFILE_ZONE_ANNOTATED("Draw frame", profilerAnnotation);
+    // Scratch of the frame three frames ago is free again
+    FrameArena::getShared().beginFrame();
+    const SceneView& view = packet.view;
+    if (view.width == 0 || view.height == 0)
+    {
+        // Minimized, there is nothing to present to
+        return;
+    }
+    // Startup ends with the first present
+    StartupTimeline& timeline = StartupTimeline::getShared();
+    uint32_t firstFramePhase = STARTUP_NO_PHASE;
+    if (!timeline.isFinished())
+    {
+        firstFramePhase = timeline.addPhase("First frame");
+        timeline.addDependency(firstFramePhase, constructedPhase);
+        timeline.beginPhase(firstFramePhase);
+    }
+    if (view.width != swapChainWidth || view.height != swapChainHeight)
+    {
+        swapChain->resize(view.width, view.height);
+        swapChainWidth = view.width;
+        swapChainHeight = view.height;
+        renderGraphDirty = true;
+    }
+    currentPacket = &packet;
+    renderGraphBackend->beginFrame();
+    uint64_t constantUploadBytes = ConstantBufferBase::takeUploadedBytes();
+    shaderReload->update();
+    cubemapGenerator->renderDirtyStages(&cubemap);
+    scene->applyState(packet.scene);
+    if (packet.pbrMode != drawnPbrMode)
+    {
+        shader = pbrShaders->getShader(packet.pbrMode);
+        drawnPbrMode = packet.pbrMode;
+    }
+    {
+        PROFILE_ZONE_ANNOTATED("Prepare scene", profilerAnnotation);
+        scene->prepareFrame(device.getStateContext(), view);
+        updateSceneResources();
+    }
+
+    if (renderGraphDirty)
+    {
+        buildRenderGraph();
+    }
+    // Tone mapping binds the image the swap chain is at through the swap chain, the UI pass gets it from the graph
+    renderGraphBackend->setImportedRenderTarget(backBuffer, swapChain->getCurrentRenderTargetView(), swapChainWidth,
+                                                swapChainHeight);
+    renderGraph.execute(*renderGraphBackend, &JobSystem::getShared());
+    scene->finishFrame(device.getStateContext());
+    renderGraphBackend->endFrame();
+    {
+        PROFILE_ZONE("Present");
+        swapChain->present(true);
+    }
+    if (firstFramePhase != STARTUP_NO_PHASE)
+    {
+        timeline.endPhase(firstFramePhase);
+        if (timeline.finish())
+        {
+            timeline.writeReport(std::cout);
+        }
+    }
+    publishFrameStats(constantUploadBytes);
+    currentPacket = nullptr;
+}
+
+void Renderer::drawFrame()
+{
+    buildFramePacket(localPacket);
+    drawFrame(localPacket);
+}
+
+void Renderer::getFrameStats(RendererFrameStats& statsOutput)
+{
+    std::lock_guard<std::mutex> lock(frameStatsMutex);
+    if (frameStatsPublished)
+    {
+        std::swap(statsOutput, frameStats);
+        frameStatsPublished = false;
+    }
+}
+
+void Renderer::publishFrameStats(uint64_t constantUploadBytes)
+{
+    RendererFrameStats& stats = drawnFrameStats;
+    uint64_t allocationsAmount = ThreadCounting::getProcessAllocationsAmount();
+    stats.heapAllocationsAmount = allocationsAmount - publishedAllocationsAmount;
+    publishedAllocationsAmount = allocationsAmount;
+    stats.frameArena = FrameArena::getShared().getStats();
+    stats.visibleInstancesAmount = scene->getVisibleInstancesAmount();
+    stats.instancesAmount = scene->getInstancesAmount();
+    stats.stateStats = renderGraphBackend->getLastFrameStateStats();
+    stats.constantRingUsedBytes = scene->getConstantRingUsedBytes();
+    stats.constantUploadBytes = constantUploadBytes;
+    stats.clusterLightReferencesAmount = scene->getClusterLightReferencesAmount();
+    renderGraphBackend->getGpuTimings(stats.gpuTimings);
+    std::lock_guard<std::mutex> lock(frameStatsMutex);
+    std::swap(frameStats, stats);
+    frameStatsPublished = true;
+}
+
+SceneView Renderer::getSceneView()
+{
+    SceneView view;
+    view.viewMatrix = camera.getViewMatrix();
+    view.projectionMatrix = camera.getProjectionMatrix((float)engineWindow->getWidth() /
+                                                       (float)engineWindow->getHeight());
+    view.cameraPosition = camera.getPosition();
+    view.fov = camera.getFov();
+    view.nearPlane = camera.getNearPlane();
+    view.farPlane = camera.getFarPlane();
+    view.width = engineWindow->getWidth();
+    view.height = engineWindow->getHeight();
+    return view;
+}
+
+void Renderer::updateSceneResources()
+{
+    sceneResources.pbrProgram = shader->getProgram();
+    sceneResources.skyboxProgram = cubeMapShader->getProgram();
+    sceneResources.samplers[0] = sampler;
+    sceneResources.samplers[1] = avgSampler;
+    sceneResources.environmentView = cubemap.cubemapSRV;
+    sceneResources.lightingViews[0] = cubemap.irradianceSRV;
+    sceneResources.lightingViews[1] = cubemap.prefilteredSRV;
+    sceneResources.lightingViews[2] = cubemap.brdfSRV;
+    sceneResources.skyboxDepthState = skyboxDepthState;
+    sceneResources.skyboxRasterState = skyboxRasterState;
+    sceneResources.defaultDepthState = defaultDepthState;
+    sceneResources.defaultRasterState = defaultRasterState;
 }
 
 
@@ -192,77 +299,191 @@ void Renderer::loadShader()
     std::vector<ShaderCreateInfo> shadersInfos;
     shadersInfos.push_back({L"Shaders/Lighting/VertexShader.hlsl", VERTEX_SHADER, "Lab5 cube vertex shader"});
     shadersInfos.push_back({L"Shaders/Lighting/PBRPixelShader.hlsl", PIXEL_SHADER, "Lab5 cube pixel shader"});
-    shader = Shader::loadShader(device.getDevice(), shadersInfos.data(), (uint32_t)shadersInfos.size());
     std::vector<ShaderVertexInput> vertexInputs;
     vertexInputs.push_back({"POSITION", 0, sizeof(float) * 3, DXGI_FORMAT_R32G32B32_FLOAT});
     vertexInputs.push_back({"UV", 0, sizeof(float) * 2, DXGI_FORMAT_R32G32_FLOAT});
     vertexInputs.push_back({"NORMAL", 0, sizeof(float) * 3, DXGI_FORMAT_R32G32B32_FLOAT});
     vertexInputs.push_back({"COLOR", 0, sizeof(float) * 3, DXGI_FORMAT_R32G32B32A32_FLOAT});
 
-    shader->makeInputLayout(device.getDevice(), vertexInputs.data(), (uint32_t)vertexInputs.size());
+    pbrShaders = new ShaderPermutationCache(device.getDevice(), shadersInfos.data(), (uint32_t)shadersInfos.size(),
+                                            vertexInputs.data(), (uint32_t)vertexInputs.size());
+    for (uint32_t mode = 0; mode < PBR_MODES_AMOUNT; mode++)
+    {
+        pbrShaders->addPermutation({mode, PIXEL_SHADER, {{"PBR_MODE", std::to_string(mode)}}});
+    }
+    pbrShaders->setHotReload(shaderReload);
+    pbrShaders->compileAll();
 
 
     shadersInfos.clear();
     shadersInfos.push_back({L"Shaders/Skybox/skyboxVS.hlsl", VERTEX_SHADER, "Lab5 skybox vertex shader"});
     shadersInfos.push_back({L"Shaders/Skybox/skyboxPS.hlsl", PIXEL_SHADER, "Lab5 skybox pixel shader"});
-    cubeMapShader = Shader::loadShader(device.getDevice(), shadersInfos.data(), shadersInfos.size());;
-    cubeMapShader->makeInputLayout(device.getDevice(), vertexInputs.data(), vertexInputs.size());
+    ShaderProgramDesc skyboxProgram = Shader::describeProgram(shadersInfos.data(), (uint32_t)shadersInfos.size(),
+                                                              vertexInputs.data(), (uint32_t)vertexInputs.size());
+    cubeMapShaderLoad = assets->loadShader(device.getDevice(), "skybox", skyboxProgram);
+    shaderReload->watch(assets->getFuture(cubeMapShaderLoad), skyboxProgram);
 }
 
 void Renderer::loadSphere()
 {
+    StartupPhase phase("Load sphere");
+    phase.dependsOn(assets->getStartupPhase(sphereMesh));
+    MeshAssetResult mesh = assets->get(sphereMesh);
+    const float color[] = {0.541f, 0.0f, 0.82745f};
     std::vector<float> vertices;
-    std::vector<uint32_t> indices;
-    float color[] = {0.541, 0, 0.82745};
-    makesphere3(vertices, indices, color);
-    sphereVertex = new VertexBuffer(device.getDevice(), vertices.size() * sizeof(float), sizeof(float)*11,
-                                              vertices.data(),
-                                              "Sphere vertex buffer");
-    sphereIndex = new IndexBuffer(device.getDevice(), indices.data(), indices.size(),
-                                            "Sphere index buffer");
+    SceneRenderer::addVertexColor(mesh->vertices, color, vertices);
+    scene = new SceneRenderer(device.getGraphicsDevice(), vertices, mesh->indices);
+}
+
+void Renderer::buildRenderGraph()
+{
+    uint32_t width = swapChainWidth;
+    uint32_t height = swapChainHeight;
+    renderGraph.reset();
+    RenderGraphResource hdrFrame = renderGraph.createTexture("HDR frame", {
+                                                                 width, height, DXGI_FORMAT_R16G16B16A16_FLOAT,
+                                                                 RENDER_GRAPH_USAGE_RENDER_TARGET |
+                                                                 RENDER_GRAPH_USAGE_SHADER_RESOURCE
+                                                             });
+    RenderGraphResource depth = renderGraph.createTexture("Depth", {
+                                                              width, height, DXGI_FORMAT_D24_UNORM_S8_UINT,
+                                                              RENDER_GRAPH_USAGE_DEPTH_STENCIL
+                                                          });
+    backBuffer = renderGraph.importTexture("Back buffer");
+
+    RenderGraphPassDesc pass;
+    pass.name = "Rendering skybox";
+    pass.writes = {hdrFrame, depth};
+    pass.execute = [this, hdrFrame, depth](RenderGraphContext context)
+    {
+        drawSkybox(context, hdrFrame, depth);
+    };
+    renderGraph.addPass(pass);
+
+    pass.name = "Rendering pbr light";
+    pass.execute = [this, hdrFrame, depth](RenderGraphContext context)
+    {
+        drawSpheres(context, hdrFrame, depth);
+    };
+    renderGraph.addPass(pass);
+
+    BrightnessMaps brightnessMaps = toneMapper->addBrightnessPasses(renderGraph, renderGraphBackend, hdrFrame,
+                                                                    width, height);
+
+    // Reads the brightness back on the CPU, everything declared before it is submitted by then
+    pass.name = "Calculating adaptation";
+    pass.reads = {brightnessMaps.avg};
+    pass.writes = {};
+    pass.sideEffects = true;
+    pass.immediate = true;
+    pass.execute = [this, brightnessMaps](RenderGraphContext context)
+    {
+        toneMapper->adaptToBrightness(renderGraphBackend->getStateContext(context)->getContext(),
+                                      renderGraphBackend, brightnessMaps);
+    };
+    renderGraph.addPass(pass);
+
+    pass.name = "Postprocess: tone mapping";
+    pass.reads = {hdrFrame, brightnessMaps.avg, brightnessMaps.min, brightnessMaps.max};
+    pass.writes = {backBuffer};
+    pass.sideEffects = false;
+    pass.immediate = false;
+    pass.execute = [this, hdrFrame, brightnessMaps](RenderGraphContext context)
+    {
+        DXStateContext* stateContext = renderGraphBackend->getStateContext(context);
+        swapChain->clearRenderTargets(stateContext->getContext(), 0, 0, 0, 1.0f);
+        stateContext->setPixelSamplers(0, 1, &sampler);
+        swapChain->bind(stateContext, swapChainWidth, swapChainHeight);
+        toneMapper->postProcessToneMap(stateContext, renderGraphBackend, hdrFrame, brightnessMaps);
+    };
+    renderGraph.addPass(pass);
+
+    // The ImGui backend only knows the immediate context, the UI itself was built on the main thread. The graph binds
+    // the back buffer for it, the command lists submitted before leave the immediate context without state.
+    pass.name = "Rendering UI";
+    pass.reads = {};
+    pass.writes = {backBuffer};
+    pass.immediate = true;
+    pass.execute = [this](RenderGraphContext context)
+    {
+        if (const ImDrawData* drawData = currentPacket->ui.get())
+        {
+            ImGui_ImplDX11_RenderDrawData(const_cast<ImDrawData*>(drawData));
+        }
+        renderGraphBackend->getStateContext(context)->invalidate();
+    };
+    renderGraph.addPass(pass);
+
+    renderGraph.compile(*renderGraphBackend);
+    renderGraphDirty = false;
+    RenderGraphStats stats = renderGraph.getStats();
+    std::cout << "Render graph: " << stats.passesAmount - stats.culledPassesAmount << " passes ("
+        << stats.culledPassesAmount << " culled), " << stats.transientTexturesAmount << " transient textures, "
+        << stats.transientBytes / (1024 * 1024) << " MB aliased into a " << stats.heapBytes / (1024 * 1024)
+        << " MB heap" << std::endl;
+}
+
+void Renderer::drawSkybox(RenderGraphContext graphContext, RenderGraphResource hdrFrame, RenderGraphResource depth)
+{
+    renderGraphBackend->bindRenderTargets(graphContext, {hdrFrame}, depth);
+    scene->drawSkybox(renderGraphBackend->getStateContext(graphContext), sceneResources,
+                      renderGraphBackend->getRenderTargetView(hdrFrame),
+                      renderGraphBackend->getDepthStencilView(depth));
+}
+
+void Renderer::drawSpheres(RenderGraphContext graphContext, RenderGraphResource hdrFrame, RenderGraphResource depth)
+{
+    renderGraphBackend->bindRenderTargets(graphContext, {hdrFrame}, depth);
+    scene->drawSpheres(renderGraphBackend->getStateContext(graphContext), sceneResources);
 }
 
 void Renderer::release()
 {
-    delete sphereVertex;
-    delete sphereIndex;
-    delete constantBuffer;
-    delete shader;
+    delete shaderReload;
+    cubemapGenerator->destroy();
+    delete cubemapGenerator;
+    releaseTracked(cubemap.sourceTexture);
+    releaseTracked(cubemap.sourceResourceView);
+    delete scene;
+    delete pbrShaders;
     delete swapChain;
+    renderGraph.reset();
+    delete renderGraphBackend;
     toneMapper->destroy();
     delete toneMapper;
     sampler->Release();
     skyboxDepthState->Release();
     skyboxRasterState->Release();
-    cubemap.cubemapSRV->Release();
-    cubemap.cubemapTexture->Release();
+    releaseTracked(cubemap.cubemapSRV);
+    releaseTracked(cubemap.cubemapTexture);
     
-    cubemap.irradianceSRV->Release();
-    cubemap.irradianceTexture->Release();
+    releaseTracked(cubemap.irradianceSRV);
+    releaseTracked(cubemap.irradianceTexture);
     
-    cubemap.prefilteredSRV->Release();
-    cubemap.prefilteredTexture->Release();
-    cubemap.brdfTexture->Release();
-    cubemap.brdfSRV->Release();
+    releaseTracked(cubemap.prefilteredSRV);
+    releaseTracked(cubemap.prefilteredTexture);
+    releaseTracked(cubemap.brdfTexture);
+    releaseTracked(cubemap.brdfSRV);
     
     annotation->Release();
+    delete profilerAnnotation;
 
     ImGui_ImplWin32_Shutdown();
     ImGui_ImplDX11_Shutdown();
     ImGui::DestroyContext();
     delete cubeMapShader;
-    delete lightConstant;
-    delete pbrConfiguration;
-    delete skyboxConfigConstant;
 }
 
-void Renderer::keyEvent(WindowKey key)
+void Renderer::keyEvents(const WindowKey* pKeys, uint32_t keysAmount)
 {
-    uint32_t index = key.key - DIK_F1;
-    lightConstantData.sources[index].intensity *= 100;
-    if (lightConstantData.sources[index].intensity > 1000000)
+    for (uint32_t i = 0; i < keysAmount; i++)
     {
-        lightConstantData.sources[index].intensity = 1;
+        PointLightSource& light = sceneState.mainLights[pKeys[i].key - DIK_F1];
+        light.intensity *= 100;
+        if (light.intensity > 1000000)
+        {
+            light.intensity = 1;
+        }
     }
 }
 
@@ -275,133 +496,164 @@ WindowKey* Renderer::getKeys(uint32_t* pKeysAmountOut)
 
 
 
-void Renderer::makesphere3(std::vector<float>& verticesOutput, std::vector<uint32_t>& indicesOutput, float* defaultColor)
-{
-    tinyobj::attrib_t inattrib;
-    std::vector<tinyobj::shape_t> inshapes;
-    std::vector<tinyobj::material_t> materials;
-    
-    auto workDir = FileSystemUtils::getCurrentDirectoryPath();
-    workDir+=L"sphere.wvf";
-    std::string s( workDir.begin(), workDir.end() );
-    std::string warn;
-    std::string err;
-    bool ret = tinyobj::LoadObj(&inattrib, &inshapes, &materials, &err, s.c_str());
-    if (!err.empty()) {
-        std::cerr << err << std::endl;
-        return;
-    }
-    
-    uint32_t idCounter = 0;
-    for (auto shape : inshapes)
-    {
-        for (auto index : shape.mesh.indices)
-        {
-            verticesOutput.push_back(inattrib.vertices[index.vertex_index*3]);
-            verticesOutput.push_back(inattrib.vertices[index.vertex_index*3+1]);
-            verticesOutput.push_back(inattrib.vertices[index.vertex_index*3+2]);
-
-            verticesOutput.push_back(inattrib.texcoords[index.texcoord_index*2]);
-            verticesOutput.push_back(inattrib.texcoords[index.texcoord_index*2+1]);
-            
-            verticesOutput.push_back(inattrib.normals[index.normal_index*3]);
-            verticesOutput.push_back(inattrib.normals[index.normal_index*3+1]);
-            verticesOutput.push_back(inattrib.normals[index.normal_index*3+2]);
-
-            verticesOutput.push_back(defaultColor[0]);
-            verticesOutput.push_back(defaultColor[1]);
-            verticesOutput.push_back(defaultColor[2]);
-
-            indicesOutput.push_back(idCounter);
-            idCounter++;
-        }
-    }
-
-}
-
 void Renderer::drawGui()
 {
     ImGui_ImplDX11_NewFrame();
     ImGui_ImplWin32_NewFrame();
     ImGui::NewFrame();
+    // Edits only the main thread copy of the scene state, the scene applies it when the packet is drawn
+    SceneSettings& settings = sceneState.settings;
+    PointLightSource* lights = sceneState.mainLights;
+    getFrameStats(guiFrameStats);
+    const RendererFrameStats& stats = guiFrameStats;
     ImGui::Begin("PBR configuration: ");
     ImGui::Text("Light pbr configuration: ");
-    ImGui::SliderFloat("Ambient intensity", &configuration.ambientIntensity, 0, 50);
+    ImGui::SliderFloat("Ambient intensity", &sceneState.configuration.ambientIntensity, 0, 50);
+    ImGui::Combo("Mode", &pbrMode, "default\0normal distribution\0geometry function\0fresnel function");
 
-    static int currentItem = 0;
-    if (ImGui::Combo("Mode", &currentItem, "default\0normal distribution\0geometry function\0fresnel function"))
+    ImGui::Text("Mesh configuration");
+    ImGui::SliderInt("Material grid size", &settings.materialGridSize, 1, 64);
+    if (settings.materialGridSize == 1)
     {
-        configuration.fresnelFunction = 0;
-        configuration.geometryFunction = 0;
-        configuration.normalDistribution = 0;
-        configuration.defaultFunction = 0;
-        switch (currentItem)
-        {
-        case 0:
-            configuration.defaultFunction = 1;
-            break;
-        case 1:
-            configuration.normalDistribution = 1;
-            break;
-        case 2:
-            configuration.geometryFunction = 1;
-            break;
-        case 3:
-            configuration.fresnelFunction = 1;
-            break;
-        }
+        ImGui::SliderFloat("Metallic value", &settings.sphereMetallic, 0.001, 1);
+        ImGui::SliderFloat("Roughness value", &settings.sphereRoughness, 0.001, 1);
     }
-
-    ImGui::Text("Mesh configuration");
-    ImGui::SliderFloat("Metallic value", &configuration.metallic, 0.001, 1);
-    ImGui::SliderFloat("Roughness value", &configuration.roughness, 0.001, 1);
+    else
+    {
+        ImGui::SliderFloat("Grid spacing", &settings.materialGridSpacing, 2.0f, 10.0f);
+    }
+    ImGui::SliderFloat("Cull distance (0 - off)", &settings.cullDistance, 0, 500);
+    ImGui::Text("Visible instances: %u / %u", stats.visibleInstancesAmount, stats.instancesAmount);
+    ImGui::Text("State calls: %u issued, %u filtered", stats.stateStats.issuedCalls, stats.stateStats.filteredCalls);
+    ImGui::Text("Constant ring: %llu KB in flight", (unsigned long long)(stats.constantRingUsedBytes / 1024));
+    ImGui::Text("Constant buffer uploads: %llu bytes", (unsigned long long)stats.constantUploadBytes);
+    ImGui::Text("Heap allocations: %llu per frame", (unsigned long long)stats.heapAllocationsAmount);
+    ImGui::Text("Frame arena: %llu KB on %u threads", (unsigned long long)(stats.frameArena.capacityBytes / 1024),
+                stats.frameArena.threadsAmount);
     ImGui::Text("Lights configuration");
     float lightsPosition[3][3];
     for (uint32_t i = 0; i < 3; i++)
     {
-        lightsPosition[i][0] = lightConstantData.sources[i].position.x;
-        lightsPosition[i][1] = lightConstantData.sources[i].position.y;
-        lightsPosition[i][2] = lightConstantData.sources[i].position.z;
+        lightsPosition[i][0] = lights[i].position.x;
+        lightsPosition[i][1] = lights[i].position.y;
+        lightsPosition[i][2] = lights[i].position.z;
     }
     ImGui::DragFloat3("Light 1 position", lightsPosition[0]);
-    ImGui::SliderFloat("Light 1 intensity", &lightConstantData.sources[0].intensity, 0, 10000);
+    ImGui::SliderFloat("Light 1 intensity", &lights[0].intensity, 0, 10000);
     ImGui::DragFloat3("Light 2 position", lightsPosition[1]);
-    ImGui::SliderFloat("Light 2 intensity", &lightConstantData.sources[1].intensity, 0, 10000);
+    ImGui::SliderFloat("Light 2 intensity", &lights[1].intensity, 0, 10000);
     ImGui::DragFloat3("Light 3 position", lightsPosition[2]);
-    ImGui::SliderFloat("Light 3 intensity", &lightConstantData.sources[2].intensity, 0, 10000);
+    ImGui::SliderFloat("Light 3 intensity", &lights[2].intensity, 0, 10000);
     for (uint32_t i = 0; i < 3; i++)
     {
-        lightConstantData.sources[i].position.x = lightsPosition[i][0];
-        lightConstantData.sources[i].position.y = lightsPosition[i][1];
-        lightConstantData.sources[i].position.z = lightsPosition[i][2];
+        lights[i].position.x = lightsPosition[i][0];
+        lights[i].position.y = lightsPosition[i][1];
+        lights[i].position.z = lightsPosition[i][2];
     }
+    ImGui::SliderInt("Scattered lights", &settings.scatteredLightsAmount, 0, 65536);
+    ImGui::SliderFloat("Scattered lights intensity", &settings.scatteredLightsIntensity, 0, 100);
+    ImGui::Text("Clustered light references: %u", stats.clusterLightReferencesAmount);
     ImGui::End();
-}
 
+    ImGui::Begin("GPU timings");
+    if (ImGui::BeginTable("GPU passes", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("Last ms");
+        ImGui::TableSetupColumn("Min ms");
+        ImGui::TableSetupColumn("Avg ms");
+        ImGui::TableSetupColumn("P99 ms");
+        ImGui::TableHeadersRow();
+        for (auto& timing : stats.gpuTimings)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(timing.name.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", timing.summary.last);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", timing.summary.min);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", timing.summary.average);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", timing.summary.p99);
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::Button("Write " RENDERER_GPU_TIMINGS_CSV))
+    {
+        try
+        {
+            writeGpuTimingsCsv(RENDERER_GPU_TIMINGS_CSV, stats.gpuTimings);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    ImGui::End();
 
-void Renderer::loadConstants()
-{
-    ZeroMemory(&shaderConstant, sizeof(ShaderConstant));
-    shaderConstant.worldMatrix = DirectX::XMMatrixIdentity()*XMMatrixScaling(3, 3, 3);
-    constantBuffer = new ConstantBuffer(device.getDevice(), &shaderConstant, sizeof(ShaderConstant),
-                                        "Camera and mesh transform matrices");
-
-    lightConstantData.sources[0].position = XMFLOAT3(0, 5, 0);
-    lightConstantData.sources[1].position = XMFLOAT3(-5, 0, 0);
-    lightConstantData.sources[2].position = XMFLOAT3(0, -5, -5);
-
-    lightConstant = new ConstantBuffer(device.getDevice(), &lightConstantData, sizeof(lightConstantData),
-                                       "Light sources infos");
-
-    pbrConfiguration = new ConstantBuffer(device.getDevice(), &pbrConfiguration, sizeof(PBRConfiguration),
-                                          "PBR configuration buffer");
-    skyboxConfig.worldMatrix = DirectX::XMMatrixIdentity();
-    skyboxConfigConstant = new ConstantBuffer(device.getDevice(), &skyboxConfig, sizeof(SkyboxConfig),
-                                              "Skybox configuration");
+    ResourceRegistry& resources = ResourceRegistry::getShared();
+    ImGui::Begin("GPU memory");
+    ImGui::Text("Total: %.2f MB, peak %.2f MB", resources.getBytes() / (1024.0 * 1024.0),
+                resources.getPeakBytes() / (1024.0 * 1024.0));
+    if (ImGui::BeginTable("Categories", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Category");
+        ImGui::TableSetupColumn("Resources");
+        ImGui::TableSetupColumn("MB");
+        ImGui::TableHeadersRow();
+        for (uint32_t i = 0; i < RESOURCE_CATEGORIES_AMOUNT; i++)
+        {
+            ResourceTotal total = resources.getTotal((ResourceCategory)i);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(getResourceCategoryName((ResourceCategory)i));
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", total.resourcesAmount);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", total.bytes / (1024.0 * 1024.0));
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::BeginTable("Owners", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Owner");
+        ImGui::TableSetupColumn("Resources");
+        ImGui::TableSetupColumn("MB");
+        ImGui::TableHeadersRow();
+        resources.getOwnerTotals(guiOwnerTotals);
+        for (auto& owner : guiOwnerTotals)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(owner.owner.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", owner.total.resourcesAmount);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", owner.total.bytes / (1024.0 * 1024.0));
+        }
+        ImGui::EndTable();
+    }
+    if (ImGui::Button("Write " RENDERER_GPU_RESOURCES_CSV))
+    {
+        try
+        {
+            resources.writeCsv(RENDERER_GPU_RESOURCES_CSV);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    ImGui::End();
+    ImGui::Render();
 }
 
+
 void Renderer::loadImgui()
 {
+    StartupPhase phase("Load ImGui");
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
@@ -421,10 +673,8 @@ void Renderer::loadImgui()
 
 void Renderer::loadCubeMap()
 {
-    CubemapGenerator generator(&device);
-    generator.loadHDRCubemap("hdr_room2.hdr", &cubemap);
-
-    cubemap.sourceTexture->Release();
-    cubemap.sourceResourceView->Release();
-    generator.destroy();
+    // Includes the waits for the IBL shaders, the generator compiles them on the build queue
+    StartupPhase phase("Load cube map");
+    phase.dependsOn(assets->getStartupPhase(environmentMap));
+    cubemapGenerator->loadHDRCubemap(*assets->get(environmentMap), &cubemap);
 }
@@ -2,50 +2,57 @@
 #include "ToneMapper.h"
 #include "../DXDevice/DXSwapChain.h"
 #include "../DXDevice/DXDevice.h"
+#include "../DXDevice/DXProfilerAnnotation.h"
 #include "../DXShader/Shader.h"
-#include "../DXShader/ConstantBuffer.h"
+#include "../DXShader/ShaderPermutationCache.h"
+#include "../DXShader/ShaderHotReload.h"
+#include "SceneRenderer.h"
 #include "Camera/Camera.h"
 #include <d3d11_1.h>
 #include "CubemapGenerator.h"
-struct PBRConfiguration
-{
-    int defaultFunction = 1;
-    int normalDistribution = 0;
-    int fresnelFunction = 0;
-    int geometryFunction = 0;
-
-    float metallic = 0.9;
-    float roughness = 0.03;
-    float ambientIntensity = 15.0f;
-    float alignment;
-};
+#include "Assets/AssetManager.h"
+#include "RenderGraph/RenderGraph.h"
+#include "RenderGraph/DXRenderGraphBackend.h"
+#include "Resources/ResourceRegistry.h"
+#include "Threading/FramePacket.h"
+#include "../Utils/FrameArena.h"
+#include "../Utils/JobSystem.h"
+#include <mutex>
 
+#define RENDERER_MAX_RECORDING_CONTEXTS 4u
+// Written next to the executable by the GPU timings and GPU memory panels
+#define RENDERER_GPU_TIMINGS_CSV "gpu_timings.csv"
+#define RENDERER_GPU_RESOURCES_CSV "gpu_resources.csv"
 
-struct ShaderConstant
+/*
+ * Values must match the PBR_MODE defines in Shaders/Lighting/PBRPixelShader.hlsl
+ */
+enum PBRMode
 {
-    XMMATRIX worldMatrix;
-    XMMATRIX cameraMatrix;
+    PBR_MODE_DEFAULT,
+    PBR_MODE_NORMAL_DISTRIBUTION,
+    PBR_MODE_GEOMETRY_FUNCTION,
+    PBR_MODE_FRESNEL_FUNCTION,
+    PBR_MODES_AMOUNT
 };
 
-struct SkyboxConfig
+/*
+ * Numbers of the last drawn frame the UI shows
+ */
+struct RendererFrameStats
 {
-    XMMATRIX worldMatrix;
-    XMMATRIX cameraMatrix;
-    XMFLOAT4 size;
-    XMFLOAT3 cameraPosition;
-
-};
-
-struct PointLightSource
-{
-    XMFLOAT3 position;
-    float intensity = 0;
-};
-
-struct LightConstant
-{
-    PointLightSource sources[3];
-    XMFLOAT3 cameraPosition;
+    uint32_t visibleInstancesAmount = 0;
+    uint32_t instancesAmount = 0;
+    StateTrackerStats stateStats{};
+    uint64_t constantRingUsedBytes = 0;
+    // Bytes the constant buffers uploaded during the frame before it
+    uint64_t constantUploadBytes = 0;
+    uint32_t clusterLightReferencesAmount = 0;
+    // Heap allocations of every thread since the frame before, the UI of the main thread included
+    uint64_t heapAllocationsAmount = 0;
+    FrameArenaStats frameArena;
+    // Frame first, then the render graph passes
+    std::vector<GpuPassTiming> gpuTimings;
 };
 
 struct Vertex
@@ -60,8 +67,6 @@ class Renderer : public IWindowKeyCallback
 {
 private:
     static DXSwapChain* swapChain;
-    static void resizeCallback(uint32_t width, uint32_t height);
-    static Renderer* instance;
 
 public:
     Renderer(Window* window);
@@ -71,23 +76,51 @@ private:
     DXDevice device;
     std::vector<WindowKey> keys;
     Shader* shader;
+    ShaderPermutationCache* pbrShaders = nullptr;
+    ShaderHotReload* shaderReload = nullptr;
+    CubemapGenerator* cubemapGenerator = nullptr;
     Shader* cubeMapShader;
-    ShaderConstant shaderConstant{};
-    alignas(256) LightConstant lightConstantData{};
-    PBRConfiguration configuration;
-    SkyboxConfig skyboxConfig{};
-    ConstantBuffer* constantBuffer;
-    ConstantBuffer* lightConstant;
-    ConstantBuffer* pbrConfiguration;
-    ConstantBuffer* skyboxConfigConstant;
+    // Only alive while the constructor runs, decoded data is dropped once the GPU objects exist
+    AssetManager* assets = nullptr;
+    AssetHandle<MeshAssetResult> sphereMesh;
+    AssetHandle<ImageAssetResult> environmentMap;
+    AssetHandle<Shader*> cubeMapShaderLoad;
+    // Last startup phase of the constructor, the first frame follows it
+    uint32_t constructedPhase = STARTUP_NO_PHASE;
+    SceneRenderer* scene = nullptr;
+    SceneResources sceneResources;
+    // Main thread: what the UI and the keys edit, copied into every frame packet
+    SceneState sceneState;
+    int pbrMode = PBR_MODE_DEFAULT;
+    // Thread that draws: what the current packet is applied to
+    int drawnPbrMode = PBR_MODE_DEFAULT;
+    uint32_t swapChainWidth = 0;
+    uint32_t swapChainHeight = 0;
+    const FramePacket* currentPacket = nullptr;
+    // Published by the thread that draws, read by the UI
+    std::mutex frameStatsMutex;
+    RendererFrameStats frameStats;
+    // Whether frameStats holds a frame the UI has not taken yet
+    bool frameStatsPublished = false;
+    // Filled without the lock, then swapped with frameStats. The three copies trade places and keep their capacity, so
+    // neither publishing nor reading copies or allocates
+    RendererFrameStats drawnFrameStats;
+    uint64_t publishedAllocationsAmount = 0;
+    // Main thread: what the UI shows, refreshed in place
+    RendererFrameStats guiFrameStats;
+    std::vector<ResourceOwnerTotal> guiOwnerTotals;
+    // Used when one thread builds and draws the frames
+    FramePacket localPacket;
     ToneMapper* toneMapper;
+    RenderGraph renderGraph;
+    DXRenderGraphBackend* renderGraphBackend = nullptr;
+    RenderGraphResource backBuffer = RENDER_GRAPH_NO_RESOURCE;
+    bool renderGraphDirty = true;
     ID3D11SamplerState* sampler;
     ID3D11SamplerState* avgSampler;
-    
-    VertexBuffer* sphereVertex = nullptr;
-    IndexBuffer* sphereIndex = nullptr;
     Camera camera;
     ID3DUserDefinedAnnotation* annotation;
+    DXProfilerAnnotation* profilerAnnotation = nullptr;
     
     HDRCubemap cubemap;
 
@@ -97,16 +130,47 @@ private:
     ID3D11DepthStencilState* defaultDepthState;
     ID3D11RasterizerState* defaultRasterState;
 public:
+    /*
+     * Main thread: dispatches the input of the frame, runs the UI and copies the camera, the scene state and the UI
+     * draw data into packet
+     */
+    void buildFramePacket(FramePacket& packet);
+    /*
+     * Only on the thread that owns the device context, resizes the swap chain to the size of the packet
+     */
+    void drawFrame(const FramePacket& packet);
+    /*
+     * Builds and draws a frame on the calling thread
+     */
     void drawFrame();
+    /*
+     * Swaps the stats of the last drawn frame into statsOutput, which is left as it is when no frame was drawn since
+     * the last call. Only the UI reads them.
+     */
+    void getFrameStats(RendererFrameStats& statsOutput);
     void release();
-    void keyEvent(WindowKey key) override;
+    void keyEvents(const WindowKey* pKeys, uint32_t keysAmount) override;
     WindowKey* getKeys(uint32_t* pKeysAmountOut) override;
-    void makesphere3(std::vector<float>& verticesOutput, std::vector<uint32_t>& indicesOutput, float* defaultColor);
 private:
     void drawGui();
+    /*
+     * Starts reading and decoding the files the renderer needs, everything else is set up while they load
+     */
+    void requestAssets();
     void loadShader();
     void loadSphere();
-    void loadConstants();
     void loadImgui();
     void loadCubeMap();
+    /*
+     * Declares the frame passes for the current window size, rebuilt after every resize
+     */
+    void buildRenderGraph();
+    /*
+     * Hands the current shaders, views and states to the scene, reloads replace them between frames
+     */
+    void updateSceneResources();
+    SceneView getSceneView();
+    void publishFrameStats(uint64_t constantUploadBytes);
+    void drawSkybox(RenderGraphContext graphContext, RenderGraphResource hdrFrame, RenderGraphResource depth);
+    void drawSpheres(RenderGraphContext graphContext, RenderGraphResource hdrFrame, RenderGraphResource depth);
 };
@@ -0,0 +1,184 @@
+#include "ResourceRegistry.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include "../../Utils/DXGIFormatSize.h"
+
+namespace
+{
+    void writeCsvString(std::ostream& stream, const std::string& text)
+    {
+        stream << '"';
+        for (char c : text)
+        {
+            stream << c;
+            if (c == '"')
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+}
+
+ResourceRegistry& ResourceRegistry::getShared()
+{
+    // Never destroyed, resources released during static destruction still find it
+    static ResourceRegistry* registry = new ResourceRegistry();
+    return *registry;
+}
+
+void ResourceRegistry::add(const void* resource, const ResourceRecord& record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto existing = records.find(resource);
+    if (existing != records.end())
+    {
+        removeLocked(existing);
+    }
+    ResourceRecord& added = records[resource];
+    added = record;
+    added.serial = nextSerial++;
+    totals[record.category].resourcesAmount++;
+    totals[record.category].bytes += record.bytes;
+    ResourceTotal& ownerTotal = ownerTotals[record.owner];
+    ownerTotal.resourcesAmount++;
+    ownerTotal.bytes += record.bytes;
+    bytes += record.bytes;
+    peakBytes = bytes > peakBytes ? bytes : peakBytes;
+}
+
+void ResourceRegistry::remove(const void* resource)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto existing = records.find(resource);
+    if (existing != records.end())
+    {
+        removeLocked(existing);
+    }
+}
+
+std::vector<ResourceRecord> ResourceRegistry::getRecords() const
+{
+    std::vector<ResourceRecord> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.reserve(records.size());
+        for (auto& record : records)
+        {
+            result.push_back(record.second);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const ResourceRecord& a, const ResourceRecord& b)
+    {
+        return a.serial < b.serial;
+    });
+    return result;
+}
+
+ResourceTotal ResourceRegistry::getTotal(ResourceCategory category) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals[category];
+}
+
+std::map<std::string, ResourceTotal> ResourceRegistry::getOwnerTotals() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return ownerTotals;
+}
+
+void ResourceRegistry::getOwnerTotals(std::vector<ResourceOwnerTotal>& totalsOutput) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    totalsOutput.resize(ownerTotals.size());
+    size_t i = 0;
+    for (auto& ownerTotal : ownerTotals)
+    {
+        // Copied into the capacity the name already has
+        totalsOutput[i].owner = ownerTotal.first;
+        totalsOutput[i].total = ownerTotal.second;
+        i++;
+    }
+}
+
+uint64_t ResourceRegistry::getBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytes;
+}
+
+uint64_t ResourceRegistry::getPeakBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return peakBytes;
+}
+
+uint32_t ResourceRegistry::reportLeaks(std::ostream& stream) const
+{
+    std::vector<ResourceRecord> leaked = getRecords();
+    for (auto& record : leaked)
+    {
+        stream << "Leaked " << getResourceCategoryName(record.category) << " \"" << record.name << "\" of " <<
+            record.owner << ", " << record.bytes << " bytes" << std::endl;
+    }
+    return (uint32_t)leaked.size();
+}
+
+void ResourceRegistry::writeCsv(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open resource report " + path);
+    }
+    file << "name,owner,category,format,width,height,array_size,mip_levels,bytes\n";
+    for (auto& record : getRecords())
+    {
+        writeCsvString(file, record.name);
+        file << ',';
+        writeCsvString(file, record.owner);
+        file << ',' << getResourceCategoryName(record.category) << ',' <<
+            (record.format ? getDXGIFormatName((DXGI_FORMAT)record.format) : "") << ',' << record.width << ',' <<
+            record.height << ',' << record.arraySize << ',' << record.mipLevels << ',' << record.bytes << '\n';
+    }
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write resource report " + path);
+    }
+}
+
+void ResourceRegistry::removeLocked(std::unordered_map<const void*, ResourceRecord>::iterator record)
+{
+    totals[record->second.category].resourcesAmount--;
+    totals[record->second.category].bytes -= record->second.bytes;
+    auto ownerTotal = ownerTotals.find(record->second.owner);
+    if (--ownerTotal->second.resourcesAmount == 0)
+    {
+        ownerTotals.erase(ownerTotal);
+    }
+    else
+    {
+        ownerTotal->second.bytes -= record->second.bytes;
+    }
+    bytes -= record->second.bytes;
+    records.erase(record);
+}
+
+const char* getResourceCategoryName(ResourceCategory category)
+{
+    switch (category)
+    {
+    case RESOURCE_CATEGORY_TEXTURE:
+        return "texture";
+    case RESOURCE_CATEGORY_RENDER_TARGET:
+        return "render target";
+    case RESOURCE_CATEGORY_BUFFER:
+        return "buffer";
+    case RESOURCE_CATEGORY_VIEW:
+        return "view";
+    default:
+        return "unknown";
+    }
+}
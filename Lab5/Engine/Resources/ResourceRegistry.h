@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum ResourceCategory
+{
+    RESOURCE_CATEGORY_TEXTURE = 0,
+    // Textures bound as render target or depth stencil
+    RESOURCE_CATEGORY_RENDER_TARGET = 1,
+    RESOURCE_CATEGORY_BUFFER = 2,
+    // Views own no memory of their own, they are counted so that leaked views show up
+    RESOURCE_CATEGORY_VIEW = 3,
+    RESOURCE_CATEGORIES_AMOUNT = 4
+};
+
+struct ResourceRecord
+{
+    std::string name;
+    // Subsystem that created the resource
+    std::string owner;
+    ResourceCategory category = RESOURCE_CATEGORY_TEXTURE;
+    // DXGI_FORMAT value, 0 for buffers
+    uint32_t format = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t arraySize = 0;
+    uint32_t mipLevels = 0;
+    // Memory the resource holds, 0 when it lives in memory owned by another record
+    uint64_t bytes = 0;
+    // Registration order
+    uint64_t serial = 0;
+};
+
+struct ResourceTotal
+{
+    uint32_t resourcesAmount = 0;
+    uint64_t bytes = 0;
+};
+
+struct ResourceOwnerTotal
+{
+    std::string owner;
+    ResourceTotal total;
+};
+
+/*
+ * Inventory of the GPU objects alive, keyed by the address of the object. Every creation adds a record and every
+ * final release removes it, so whatever is left at shutdown leaked. Thread safe.
+ */
+class ResourceRegistry
+{
+public:
+    ResourceRegistry() = default;
+    ResourceRegistry(const ResourceRegistry&) = delete;
+    ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+
+    /*
+     * The registry the device wrappers record into
+     */
+    static ResourceRegistry& getShared();
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<const void*, ResourceRecord> records;
+    ResourceTotal totals[RESOURCE_CATEGORIES_AMOUNT];
+    // Kept up to date by add and remove, owners without resources are dropped
+    std::map<std::string, ResourceTotal> ownerTotals;
+    uint64_t nextSerial = 0;
+    uint64_t bytes = 0;
+    uint64_t peakBytes = 0;
+
+public:
+    /*
+     * A record already under the address is replaced
+     */
+    void add(const void* resource, const ResourceRecord& record);
+    /*
+     * Addresses that were never added are ignored
+     */
+    void remove(const void* resource);
+    /*
+     * In registration order
+     */
+    std::vector<ResourceRecord> getRecords() const;
+    ResourceTotal getTotal(ResourceCategory category) const;
+    std::map<std::string, ResourceTotal> getOwnerTotals() const;
+    /*
+     * Ordered by owner. Reuses what totalsOutput holds, so refreshing the same vector every frame allocates nothing
+     * while the owners stay the same.
+     */
+    void getOwnerTotals(std::vector<ResourceOwnerTotal>& totalsOutput) const;
+    uint64_t getBytes() const;
+    uint64_t getPeakBytes() const;
+    /*
+     * Writes one line per resource still registered and returns how many there are
+     */
+    uint32_t reportLeaks(std::ostream& stream) const;
+    /*
+     * One row per resource, throws std::runtime_error when the file cannot be written
+     */
+    void writeCsv(const std::string& path) const;
+
+private:
+    void removeLocked(std::unordered_map<const void*, ResourceRecord>::iterator record);
+};
+
+const char* getResourceCategoryName(ResourceCategory category);
@@ -0,0 +1,345 @@
+#include "SceneRenderer.h"
+
+#include <cmath>
+#include <random>
+#include "Assets/AssetDecoders.h"
+#include "../Utils/JobSystem.h"
+#include "../Utils/Profiler.h"
+
+namespace
+{
+    void calcSkyboxSize(SkyboxConfig& config, uint32_t width, uint32_t height, float fovDeg)
+    {
+        float n = 0.01f;
+        float fov = XMConvertToRadians(fovDeg);
+        float halfW = tanf(fov / 2) * n;
+        float halfH = height / float(width) * halfW;
+        config.size.x = sqrtf(n * n + halfH * halfH + halfW * halfW) * 1.1f;
+    }
+}
+
+SceneRenderer::SceneRenderer(GraphicsDevice* device, const std::vector<float>& vertices,
+                             const std::vector<uint32_t>& indices) : device(device)
+{
+    sphereVertex = new VertexBuffer(device, vertices.size() * sizeof(float), sizeof(float) * SCENE_VERTEX_FLOATS,
+                                    vertices.data(), "Sphere vertex buffer");
+    sphereIndex = new IndexBuffer(device, indices.data(), (uint32_t)indices.size(), "Sphere index buffer");
+
+    shaderConstant = {};
+    shaderConstant.worldMatrix = XMMatrixIdentity();
+    constantRing = new ConstantRing(device, SCENE_CONSTANT_RING_SIZE, "Per frame constants ring");
+    buildMaterialGrid();
+    instanceBuffer = new StructuredBuffer(device, sizeof(InstanceData), sphereInstances.size(),
+                                          "Sphere instances buffer");
+
+    lights.resize(SCENE_MAIN_LIGHTS);
+    lights[0].position = XMFLOAT3(0, 5, 0);
+    lights[1].position = XMFLOAT3(-5, 0, 0);
+    lights[2].position = XMFLOAT3(0, -5, -5);
+
+    lightConstant = new ConstantBuffer<LightConstant>(device, lightConstantData, "Light sources infos");
+    lightsBuffer = new StructuredBuffer(device, sizeof(PointLightSource), (uint32_t)lights.size(),
+                                        "Point lights buffer");
+    clusterRangesBuffer = new StructuredBuffer(device, sizeof(ClusterRange), ClusterGrid::getClustersAmount(),
+                                               "Light cluster ranges");
+    lightIndicesBuffer = new StructuredBuffer(device, sizeof(uint32_t), 1024, "Light cluster indices");
+
+    pbrConfiguration = new ConstantBuffer<PBRConfiguration>(device, configuration, "PBR configuration buffer");
+    skyboxConfig.worldMatrix = XMMatrixIdentity();
+}
+
+void SceneRenderer::prepareFrame(GraphicsContext* context, const SceneView& view)
+{
+    shaderConstant.cameraMatrix = XMMatrixMultiply(view.viewMatrix, view.projectionMatrix);
+    skyboxConfig.cameraMatrix = shaderConstant.cameraMatrix;
+    skyboxConfig.cameraPosition = view.cameraPosition;
+    calcSkyboxSize(skyboxConfig, view.width, view.height, view.fov);
+
+    lightConstantData.cameraPosition = view.cameraPosition;
+    updateLights(context, view);
+    lightConstant->updateData(context, lightConstantData);
+    pbrConfiguration->updateData(context, configuration);
+    constantRing->map(context);
+    cameraConstants = constantRing->push(shaderConstant);
+    skyboxConstants = constantRing->push(skyboxConfig);
+    constantRing->unmap();
+    uploadInstances(context, view);
+}
+
+void SceneRenderer::finishFrame(GraphicsContext* context)
+{
+    constantRing->endFrame(context);
+}
+
+void SceneRenderer::drawSkybox(GraphicsContext* context, const SceneResources& resources, StateHandle colorView,
+                               StateHandle depthView)
+{
+    float clearColor[4] = {0.25f, 0.25f, 0.25f, 1.0f};
+    context->clearRenderTarget(colorView, clearColor);
+    context->clearDepthStencil(depthView, 1.0f, 0);
+    context->setProgram(resources.skyboxProgram);
+    context->setSamplers(STATE_TRACKER_PIXEL_STAGE, 0, 1, resources.samplers);
+    constantRing->bindToVertexShader(context, skyboxConstants);
+    context->setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 1, &resources.environmentView);
+    context->setDepthStencilState(resources.skyboxDepthState, 1);
+    context->setRasterizerState(resources.skyboxRasterState);
+    bindMesh(context);
+    context->drawIndexed(sphereIndex->getIndexCount(), 0, 0);
+
+    context->clearDepthStencil(depthView, 1.0f, 0);
+}
+
+void SceneRenderer::drawSpheres(GraphicsContext* context, const SceneResources& resources)
+{
+    context->setProgram(resources.pbrProgram);
+    context->setSamplers(STATE_TRACKER_PIXEL_STAGE, 0, 2, resources.samplers);
+    context->setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 3, resources.lightingViews);
+
+    constantRing->bindToVertexShader(context, cameraConstants);
+    lightConstant->bindToPixelShader(context);
+    pbrConfiguration->bindToPixelShader(context, 1);
+    instanceBuffer->bindToVertexShader(context);
+    lightsBuffer->bindToPixelShader(context, 3);
+    clusterRangesBuffer->bindToPixelShader(context, 4);
+    lightIndicesBuffer->bindToPixelShader(context, 5);
+    context->setDepthStencilState(resources.defaultDepthState, 1);
+    context->setRasterizerState(resources.defaultRasterState);
+    bindMesh(context);
+    context->drawIndexedInstanced(sphereIndex->getIndexCount(), (uint32_t)visibleInstances.size(), 0, 0, 0);
+}
+
+SceneSettings& SceneRenderer::getSettings()
+{
+    return settings;
+}
+
+PBRConfiguration& SceneRenderer::getConfiguration()
+{
+    return configuration;
+}
+
+std::vector<PointLightSource>& SceneRenderer::getLights()
+{
+    return lights;
+}
+
+void SceneRenderer::buildMaterialGrid()
+{
+    XMFLOAT3 albedo = XMFLOAT3(0.541, 0, 0.82745);
+    sphereInstances.clear();
+    int gridSize = settings.materialGridSize;
+    float spacing = settings.materialGridSpacing;
+    if (gridSize <= 1)
+    {
+        sphereInstances.addInstance(XMMatrixScaling(3, 3, 3), settings.sphereMetallic, settings.sphereRoughness,
+                                    albedo);
+        return;
+    }
+    sphereInstances.reserve(gridSize * gridSize);
+    float step = 1.0f / (gridSize - 1);
+    float offset = (gridSize - 1) * spacing * 0.5f;
+    for (int row = 0; row < gridSize; row++)
+    {
+        for (int column = 0; column < gridSize; column++)
+        {
+            XMMATRIX transform = XMMatrixTranslation(0, row * spacing - offset, column * spacing - offset);
+            float metallic = column * step > 0.001f ? column * step : 0.001f;
+            float roughness = row * step > 0.05f ? row * step : 0.05f;
+            sphereInstances.addInstance(transform, metallic, roughness, albedo);
+        }
+    }
+}
+
+void SceneRenderer::scatterLights()
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> positionDistribution(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> intensityDistribution(0.5f, 1.0f);
+    lights.resize(SCENE_MAIN_LIGHTS + settings.scatteredLightsAmount);
+    for (uint32_t i = SCENE_MAIN_LIGHTS; i < lights.size(); i++)
+    {
+        lights[i].position = XMFLOAT3(positionDistribution(generator), positionDistribution(generator),
+                                      positionDistribution(generator));
+        lights[i].intensity = settings.scatteredLightsIntensity * intensityDistribution(generator);
+    }
+}
+
+SceneState SceneRenderer::getState() const
+{
+    SceneState state;
+    state.settings = settings;
+    state.configuration = configuration;
+    for (uint32_t i = 0; i < SCENE_MAIN_LIGHTS; i++)
+    {
+        state.mainLights[i] = lights[i];
+    }
+    return state;
+}
+
+void SceneRenderer::applyState(const SceneState& state)
+{
+    const SceneSettings& next = state.settings;
+    bool materialChanged = next.materialGridSize != settings.materialGridSize ||
+        next.materialGridSpacing != settings.materialGridSpacing || next.sphereMetallic != settings.sphereMetallic ||
+        next.sphereRoughness != settings.sphereRoughness;
+    bool lightsChanged = next.scatteredLightsAmount != settings.scatteredLightsAmount ||
+        next.scatteredLightsIntensity != settings.scatteredLightsIntensity;
+    settings = next;
+    configuration = state.configuration;
+    for (uint32_t i = 0; i < SCENE_MAIN_LIGHTS; i++)
+    {
+        lights[i].position = state.mainLights[i].position;
+        lights[i].intensity = state.mainLights[i].intensity;
+    }
+    if (materialChanged)
+    {
+        buildMaterialGrid();
+    }
+    if (lightsChanged)
+    {
+        scatterLights();
+    }
+}
+
+uint32_t SceneRenderer::getVisibleInstancesAmount() const
+{
+    return (uint32_t)visibleInstances.size();
+}
+
+uint32_t SceneRenderer::getInstancesAmount() const
+{
+    return sphereInstances.size();
+}
+
+uint32_t SceneRenderer::getClusterLightReferencesAmount() const
+{
+    return (uint32_t)clusterGrid.getLightIndices().size();
+}
+
+uint64_t SceneRenderer::getConstantRingUsedBytes() const
+{
+    return constantRing->getUsedBytes();
+}
+
+void SceneRenderer::updateLights(GraphicsContext* context, const SceneView& view)
+{
+    PROFILE_ZONE("Assign lights to clusters");
+    for (auto& light : lights)
+    {
+        light.radius = light.intensity > 0 ? sqrtf(light.intensity / LIGHT_ATTENUATION_CUTOFF) : 0;
+    }
+
+    ClusterGridParameters gridParameters = {
+        XMConvertToRadians(view.fov), (float)view.width / (float)view.height, view.nearPlane, view.farPlane
+    };
+    if (!clusterGrid.isBuiltFor(gridParameters))
+    {
+        clusterGrid.build(gridParameters);
+    }
+    XMFLOAT4X4 viewMatrix;
+    XMStoreFloat4x4(&viewMatrix, view.viewMatrix);
+    clusterGrid.assignLights(&viewMatrix._11, (const ClusterLight*)lights.data(), (uint32_t)lights.size(),
+                             &JobSystem::getShared());
+
+    auto& ranges = clusterGrid.getRanges();
+    auto& indices = clusterGrid.getLightIndices();
+    lightsBuffer->updateData(context, lights.data(), (uint32_t)lights.size());
+    clusterRangesBuffer->updateData(context, ranges.data(), (uint32_t)ranges.size());
+    if (!indices.empty())
+    {
+        lightIndicesBuffer->updateData(context, indices.data(), (uint32_t)indices.size());
+    }
+
+    lightConstantData.lightsAmount = (uint32_t)lights.size();
+    lightConstantData.clusterScale = XMFLOAT4((float)CLUSTER_GRID_X / view.width,
+                                              (float)CLUSTER_GRID_Y / view.height,
+                                              clusterGrid.getDepthScale(), clusterGrid.getDepthBias());
+    lightConstantData.clusterDimensions[0] = CLUSTER_GRID_X;
+    lightConstantData.clusterDimensions[1] = CLUSTER_GRID_Y;
+    lightConstantData.clusterDimensions[2] = CLUSTER_GRID_Z;
+}
+
+void SceneRenderer::uploadInstances(GraphicsContext* context, const SceneView& view)
+{
+    PROFILE_ZONE("Cull instances");
+    XMFLOAT4X4 viewProjection;
+    XMStoreFloat4x4(&viewProjection, shaderConstant.cameraMatrix);
+    FrustumCuller::extractPlanes(&viewProjection._11, frustumPlanes);
+
+    CullingParameters parameters;
+    parameters.cameraPosition[0] = view.cameraPosition.x;
+    parameters.cameraPosition[1] = view.cameraPosition.y;
+    parameters.cameraPosition[2] = view.cameraPosition.z;
+    parameters.maxDistance = settings.cullDistance;
+    parameters.jobs = &JobSystem::getShared();
+    culler.cullSpheres(frustumPlanes, sphereInstances.getBounds(), parameters, visibleInstances);
+
+    InstanceData* instances = (InstanceData*)instanceBuffer->map(context, (uint32_t)visibleInstances.size());
+    sphereInstances.pack(visibleInstances.data(), (uint32_t)visibleInstances.size(), instances);
+    instanceBuffer->unmap(context);
+}
+
+void SceneRenderer::bindMesh(GraphicsContext* context)
+{
+    sphereVertex->bind(context);
+    sphereIndex->bind(context);
+    context->setPrimitiveTopology(GRAPHICS_TOPOLOGY_TRIANGLE_LIST);
+}
+
+void SceneRenderer::makeSphere(uint32_t segments, std::vector<float>& verticesOutput,
+                               std::vector<uint32_t>& indicesOutput)
+{
+    const float pi = 3.14159265359f;
+    const uint32_t rings = segments / 2;
+    for (uint32_t ring = 0; ring <= rings; ring++)
+    {
+        float theta = pi * ring / rings;
+        for (uint32_t segment = 0; segment <= segments; segment++)
+        {
+            float phi = 2 * pi * segment / segments;
+            float normal[3] = {sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)};
+            float vertex[SCENE_VERTEX_FLOATS] = {
+                normal[0], normal[1], normal[2],
+                (float)segment / segments, (float)ring / rings,
+                normal[0], normal[1], normal[2],
+                0.541f, 0.0f, 0.82745f
+            };
+            verticesOutput.insert(verticesOutput.end(), vertex, vertex + SCENE_VERTEX_FLOATS);
+        }
+    }
+    for (uint32_t ring = 0; ring < rings; ring++)
+    {
+        for (uint32_t segment = 0; segment < segments; segment++)
+        {
+            uint32_t first = ring * (segments + 1) + segment;
+            uint32_t second = first + segments + 1;
+            uint32_t quad[6] = {first, first + 1, second, second, first + 1, second + 1};
+            indicesOutput.insert(indicesOutput.end(), quad, quad + 6);
+        }
+    }
+}
+
+void SceneRenderer::addVertexColor(const std::vector<float>& meshVertices, const float* pColor,
+                                   std::vector<float>& verticesOutput)
+{
+    verticesOutput.reserve(verticesOutput.size() +
+        meshVertices.size() / MESH_ASSET_VERTEX_FLOATS * SCENE_VERTEX_FLOATS);
+    for (size_t i = 0; i < meshVertices.size(); i += MESH_ASSET_VERTEX_FLOATS)
+    {
+        verticesOutput.insert(verticesOutput.end(), &meshVertices[i], &meshVertices[i] + MESH_ASSET_VERTEX_FLOATS);
+        verticesOutput.insert(verticesOutput.end(), pColor, pColor + 3);
+    }
+}
+
+SceneRenderer::~SceneRenderer()
+{
+    delete sphereVertex;
+    delete sphereIndex;
+    delete instanceBuffer;
+    delete lightsBuffer;
+    delete clusterRangesBuffer;
+    delete lightIndicesBuffer;
+    delete constantRing;
+    delete lightConstant;
+    delete pbrConfiguration;
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "Device/GraphicsDevice.h"
+#include "../DXShader/ConstantBuffer.h"
+#include "../DXShader/ConstantRing.h"
+#include "../DXShader/IndexBuffer.h"
+#include "../DXShader/StructuredBuffer.h"
+#include "../DXShader/VertexBuffer.h"
+#include "InstanceStore.h"
+#include "Culling/FrustumCuller.h"
+#include "Lighting/ClusterGrid.h"
+
+using namespace DirectX;
+
+#define SCENE_CONSTANT_RING_SIZE (1024u * 1024u)
+// Position, uv, normal and color, the layout of the scene vertex shaders
+#define SCENE_VERTEX_FLOATS 11u
+#define LIGHT_ATTENUATION_CUTOFF 0.01f
+// Lights placed by hand, the scattered ones follow them
+#define SCENE_MAIN_LIGHTS 3u
+
+struct PBRConfiguration
+{
+    float ambientIntensity = 15.0f;
+    float alignment[3];
+};
+
+CONSTANT_BUFFER_CHECK_PACKING(PBRConfiguration, ambientIntensity);
+CONSTANT_BUFFER_CHECK_PACKING(PBRConfiguration, alignment);
+
+struct ShaderConstant
+{
+    XMMATRIX worldMatrix;
+    XMMATRIX cameraMatrix;
+};
+
+struct SkyboxConfig
+{
+    XMMATRIX worldMatrix;
+    XMMATRIX cameraMatrix;
+    XMFLOAT4 size;
+    XMFLOAT3 cameraPosition;
+
+};
+
+CONSTANT_BUFFER_CHECK_PACKING(SkyboxConfig, size);
+CONSTANT_BUFFER_CHECK_PACKING(SkyboxConfig, cameraPosition);
+
+struct PointLightSource
+{
+    XMFLOAT3 position;
+    float intensity = 0;
+    float radius = 0;
+    float padding[3];
+};
+
+static_assert(sizeof(PointLightSource) == sizeof(ClusterLight), "Point light layout must match cluster light");
+
+struct LightConstant
+{
+    XMFLOAT3 cameraPosition;
+    uint32_t lightsAmount;
+    XMFLOAT4 clusterScale;
+    uint32_t clusterDimensions[4];
+};
+
+CONSTANT_BUFFER_CHECK_PACKING(LightConstant, cameraPosition);
+CONSTANT_BUFFER_CHECK_PACKING(LightConstant, lightsAmount);
+CONSTANT_BUFFER_CHECK_PACKING(LightConstant, clusterScale);
+CONSTANT_BUFFER_CHECK_PACKING(LightConstant, clusterDimensions);
+
+/*
+ * Camera of the frame, fov in degrees
+ */
+struct SceneView
+{
+    XMMATRIX viewMatrix;
+    XMMATRIX projectionMatrix;
+    XMFLOAT3 cameraPosition;
+    float fov;
+    float nearPlane;
+    float farPlane;
+    uint32_t width;
+    uint32_t height;
+};
+
+/*
+ * Objects the scene draws with that its owner creates on the device, the programs change when shaders are reloaded
+ */
+struct SceneResources
+{
+    GraphicsProgram pbrProgram;
+    GraphicsProgram skyboxProgram;
+    // Anisotropic wrap and linear clamp
+    StateHandle samplers[2] = {};
+    StateHandle environmentView = nullptr;
+    // Irradiance, prefiltered environment and BRDF lookup
+    StateHandle lightingViews[3] = {};
+    StateHandle skyboxDepthState = nullptr;
+    StateHandle skyboxRasterState = nullptr;
+    StateHandle defaultDepthState = nullptr;
+    StateHandle defaultRasterState = nullptr;
+};
+
+struct SceneSettings
+{
+    float sphereMetallic = 0.9f;
+    float sphereRoughness = 0.03f;
+    int materialGridSize = 1;
+    float materialGridSpacing = 2.5f;
+    float cullDistance = 0;
+    int scatteredLightsAmount = 0;
+    float scatteredLightsIntensity = 5.0f;
+};
+
+/*
+ * What the UI edits, a copy of it travels with every frame so the UI never touches the scene being drawn
+ */
+struct SceneState
+{
+    SceneSettings settings;
+    PBRConfiguration configuration{};
+    PointLightSource mainLights[SCENE_MAIN_LIGHTS];
+};
+
+/*
+ * The frame of the sphere scene on any GraphicsDevice: culling, light clustering, constant and instance uploads
+ * and the skybox and sphere draws. Window, UI and post processing stay with the owner.
+ */
+class SceneRenderer
+{
+public:
+    /*
+     * vertices hold SCENE_VERTEX_FLOATS floats per vertex, the mesh is drawn for the skybox and every sphere
+     */
+    SceneRenderer(GraphicsDevice* device, const std::vector<float>& vertices, const std::vector<uint32_t>& indices);
+
+private:
+    GraphicsDevice* device;
+    VertexBuffer* sphereVertex = nullptr;
+    IndexBuffer* sphereIndex = nullptr;
+    SceneSettings settings;
+    ShaderConstant shaderConstant{};
+    alignas(256) LightConstant lightConstantData{};
+    PBRConfiguration configuration;
+    SkyboxConfig skyboxConfig{};
+    ConstantBuffer<LightConstant>* lightConstant = nullptr;
+    ConstantBuffer<PBRConfiguration>* pbrConfiguration = nullptr;
+    // Constants that change every frame, written with one map per frame
+    ConstantRing* constantRing = nullptr;
+    ConstantRingAllocation cameraConstants;
+    ConstantRingAllocation skyboxConstants;
+
+    InstanceStore sphereInstances;
+    StructuredBuffer* instanceBuffer = nullptr;
+    FrustumCuller culler;
+    FrustumPlanes frustumPlanes{};
+    std::vector<uint32_t> visibleInstances;
+    std::vector<PointLightSource> lights;
+    ClusterGrid clusterGrid;
+    StructuredBuffer* lightsBuffer = nullptr;
+    StructuredBuffer* clusterRangesBuffer = nullptr;
+    StructuredBuffer* lightIndicesBuffer = nullptr;
+
+public:
+    /*
+     * Uploads everything the draws of this frame read, on the immediate context
+     */
+    void prepareFrame(GraphicsContext* context, const SceneView& view);
+    /*
+     * After every draw of the frame was submitted
+     */
+    void finishFrame(GraphicsContext* context);
+    /*
+     * Clears both views, draws the skybox and clears depth again, the views must be bound as render targets
+     */
+    void drawSkybox(GraphicsContext* context, const SceneResources& resources, StateHandle colorView,
+                    StateHandle depthView);
+    void drawSpheres(GraphicsContext* context, const SceneResources& resources);
+
+    SceneSettings& getSettings();
+    PBRConfiguration& getConfiguration();
+    std::vector<PointLightSource>& getLights();
+    /*
+     * Apply changed material and light settings
+     */
+    void buildMaterialGrid();
+    void scatterLights();
+    SceneState getState() const;
+    /*
+     * Rebuilds the material grid and the scattered lights only when their settings differ from the current ones
+     */
+    void applyState(const SceneState& state);
+
+    uint32_t getVisibleInstancesAmount() const;
+    uint32_t getInstancesAmount() const;
+    uint32_t getClusterLightReferencesAmount() const;
+    uint64_t getConstantRingUsedBytes() const;
+    ~SceneRenderer();
+
+    /*
+     * Unit UV sphere in the SCENE_VERTEX_FLOATS layout, clockwise seen from outside like the sphere model
+     */
+    static void makeSphere(uint32_t segments, std::vector<float>& verticesOutput,
+                           std::vector<uint32_t>& indicesOutput);
+    /*
+     * Decoded mesh vertices, MESH_ASSET_VERTEX_FLOATS each, to the SCENE_VERTEX_FLOATS layout with one color for all
+     */
+    static void addVertexColor(const std::vector<float>& meshVertices, const float* pColor,
+                               std::vector<float>& verticesOutput);
+
+private:
+    void updateLights(GraphicsContext* context, const SceneView& view);
+    void uploadInstances(GraphicsContext* context, const SceneView& view);
+    void bindMesh(GraphicsContext* context);
+};
@@ -0,0 +1,240 @@
+#include "SoftwareEnvironment.h"
+
+#include <cmath>
+
+namespace
+{
+    float fraction(float value)
+    {
+        return value - floorf(value);
+    }
+
+    float random(float x, float y)
+    {
+        float dt = x * 12.9898f + y * 78.233f;
+        float sn = fmodf(dt, 3.14f);
+        return fraction(sinf(sn) * 43758.5453f);
+    }
+
+    void hammersley2d(uint32_t i, uint32_t N, float* pOutput)
+    {
+        uint32_t bits = (i << 16u) | (i >> 16u);
+        bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+        bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+        bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+        bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+        pOutput[0] = (float)i / (float)N;
+        pOutput[1] = (float)bits * 2.3283064365386963e-10f;
+    }
+
+    Float3 importanceSampleGGX(const float* Xi, float roughness, const Float3& normal)
+    {
+        float alpha = roughness * roughness;
+        float phi = 2.0f * SOFTWARE_PI * Xi[0] + random(normal.x, normal.z) * 0.1f;
+        float cosTheta = sqrtf((1.0f - Xi[1]) / (1.0f + (alpha * alpha - 1.0f) * Xi[1]));
+        float sinTheta = sqrtf(fmaxf(1.0f - cosTheta * cosTheta, 0.0f));
+        Float3 H(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta);
+
+        Float3 up = fabsf(normal.z) < 0.999f ? Float3(0.0f, 0.0f, 1.0f) : Float3(1.0f, 0.0f, 0.0f);
+        Float3 tangentX = normalize(cross(up, normal));
+        Float3 tangentY = normalize(cross(normal, tangentX));
+
+        return normalize(tangentX * H.x + tangentY * H.y + normal * H.z);
+    }
+
+    float distributeGGX(float dotNH, float roughness)
+    {
+        float alpha = roughness * roughness;
+        float alpha2 = alpha * alpha;
+        float denom = dotNH * dotNH * (alpha2 - 1.0f) + 1.0f;
+        return alpha2 / (SOFTWARE_PI * denom * denom);
+    }
+
+    float schlickSmithGGX(float dotNL, float dotNV, float roughness)
+    {
+        float k = (roughness * roughness) / 2.0f;
+        float GL = dotNL / (dotNL * (1.0f - k) + k);
+        float GV = dotNV / (dotNV * (1.0f - k) + k);
+        return GL * GV;
+    }
+
+    void writeTexel(float* pTexel, const Float3& color)
+    {
+        pTexel[0] = color.x;
+        pTexel[1] = color.y;
+        pTexel[2] = color.z;
+        pTexel[3] = 1.0f;
+    }
+}
+
+template <typename Function>
+void SoftwareEnvironment::forEachCubeTexel(uint32_t size, JobSystem& jobs, const Function& function)
+{
+    jobs.parallelFor(SOFTWARE_CUBE_FACES * size, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t row = begin; row < end; row++)
+        {
+            for (uint32_t x = 0; x < size; x++)
+            {
+                function(row / size, x, row % size);
+            }
+        }
+    });
+}
+
+void SoftwareEnvironment::projectEquirect(const SoftwareTexture& equirect, SoftwareTexture& cubemap,
+                                          JobSystem& jobs)
+{
+    uint32_t size = cubemap.getWidth();
+    SoftwareSampler sampler;
+    sampler.wrap = true;
+    forEachCubeTexel(size, jobs, [&](uint32_t face, uint32_t x, uint32_t y)
+    {
+        Float3 pos = SoftwareTexture::cubeDirection(face, x, y, size);
+        float u = 1 - atan2f(pos.z, pos.x) / (2 * SOFTWARE_PI);
+        float v = -atan2f(pos.y, sqrtf(pos.x * pos.x + pos.z * pos.z)) / SOFTWARE_PI + 0.5f;
+        float* texel = cubemap.getTexels(face) + ((size_t)y * size + x) * 4;
+        equirect.sample(&sampler, u, v, 0, texel);
+        texel[3] = 1.0f;
+    });
+}
+
+void SoftwareEnvironment::makeSky(SoftwareTexture& cubemap, JobSystem& jobs)
+{
+    uint32_t size = cubemap.getWidth();
+    const Float3 sunDirection = normalize(Float3(0.5f, 0.6f, 0.3f));
+    const Float3 zenith(0.08f, 0.16f, 0.4f);
+    const Float3 horizon(0.45f, 0.42f, 0.38f);
+    const Float3 ground(0.06f, 0.05f, 0.04f);
+    forEachCubeTexel(size, jobs, [&](uint32_t face, uint32_t x, uint32_t y)
+    {
+        Float3 direction = SoftwareTexture::cubeDirection(face, x, y, size);
+        Float3 color = direction.y >= 0 ? lerp(horizon, zenith, sqrtf(direction.y)) : lerp(horizon, ground,
+            saturate(-direction.y * 8.0f));
+        float sun = dot(direction, sunDirection);
+        if (sun > 0.995f)
+        {
+            color += Float3(40.0f, 36.0f, 30.0f);
+        }
+        writeTexel(cubemap.getTexels(face) + ((size_t)y * size + x) * 4, color);
+    });
+}
+
+void SoftwareEnvironment::convolveIrradiance(const SoftwareTexture& cubemap, SoftwareTexture& irradiance,
+                                             JobSystem& jobs)
+{
+    uint32_t size = irradiance.getWidth();
+    forEachCubeTexel(size, jobs, [&](uint32_t face, uint32_t x, uint32_t y)
+    {
+        Float3 normal = SoftwareTexture::cubeDirection(face, x, y, size);
+        Float3 dir = fabsf(normal.z) < 0.999f ? Float3(0.0f, 0.0f, 1.0f) : Float3(1.0f, 0.0f, 0.0f);
+        Float3 tangent = normalize(cross(dir, normal));
+        Float3 binormal = cross(normal, tangent);
+        Float3 sum;
+        const uint32_t N1 = SOFTWARE_IRRADIANCE_PHI_SAMPLES;
+        const uint32_t N2 = SOFTWARE_IRRADIANCE_THETA_SAMPLES;
+        for (uint32_t i = 0; i < N1; i++)
+        {
+            for (uint32_t j = 0; j < N2; j++)
+            {
+                float phi = i * (2 * SOFTWARE_PI / N1);
+                float theta = j * (SOFTWARE_PI / 2 / N2);
+                Float3 tangentSample(sinf(theta) * cosf(phi), sinf(theta) * sinf(phi), cosf(theta));
+                Float3 sampleVec = tangent * tangentSample.x + binormal * tangentSample.y + normal * tangentSample.z;
+                float color[4];
+                cubemap.sampleCube(nullptr, sampleVec, 0, color);
+                sum += Float3(color) * (cosf(theta) * sinf(theta));
+            }
+        }
+        writeTexel(irradiance.getTexels(face) + ((size_t)y * size + x) * 4, sum * (SOFTWARE_PI / (N1 * N2)));
+    });
+}
+
+void SoftwareEnvironment::prefilter(const SoftwareTexture& cubemap, const float* pRoughness,
+                                    SoftwareTexture& prefiltered, JobSystem& jobs)
+{
+    // prefilterCube.hlsl picks source levels for a 128 texel cube whatever the source size is
+    const float envMapDim = 128;
+    for (uint32_t mip = 0; mip < prefiltered.getMipsAmount(); mip++)
+    {
+        uint32_t size = prefiltered.getWidth(mip);
+        float roughness = pRoughness[mip];
+        forEachCubeTexel(size, jobs, [&](uint32_t face, uint32_t x, uint32_t y)
+        {
+            Float3 N = SoftwareTexture::cubeDirection(face, x, y, size);
+            Float3 V = N;
+            Float3 color;
+            float totalWeight = 0.0f;
+            for (uint32_t i = 0; i < SOFTWARE_PREFILTER_SAMPLES; i++)
+            {
+                float Xi[2];
+                hammersley2d(i, SOFTWARE_PREFILTER_SAMPLES, Xi);
+                Float3 H = importanceSampleGGX(Xi, roughness, N);
+                Float3 L = H * (2.0f * dot(V, H)) - V;
+                float dotNL = clampValue(dot(N, L), 0.0f, 1.0f);
+                if (dotNL > 0.0f)
+                {
+                    float dotNH = clampValue(dot(N, H), 0.0f, 1.0f);
+                    float dotVH = clampValue(dot(V, H), 0.0f, 1.0f);
+
+                    float pdf = distributeGGX(dotNH, roughness) * dotNH / (4.0f * dotVH) + 0.0001f;
+                    float omegaS = 1.0f / ((float)SOFTWARE_PREFILTER_SAMPLES * pdf);
+                    float omegaP = 4.0f * SOFTWARE_PI / (6.0f * envMapDim * envMapDim);
+                    float mipLevel = roughness == 0.0f ? 0.0f : fmaxf(0.5f * log2f(omegaS / omegaP) + 1.0f, 0.0f);
+                    float sample[4];
+                    cubemap.sampleCube(nullptr, L, mipLevel, sample);
+                    color += Float3(sample) * dotNL;
+                    totalWeight += dotNL;
+                }
+            }
+            float* texel = prefiltered.getTexels(face, mip) + ((size_t)y * size + x) * 4;
+            writeTexel(texel, totalWeight > 0 ? color / totalWeight : color);
+        });
+    }
+}
+
+void SoftwareEnvironment::integrateBRDF(SoftwareTexture& lookup, JobSystem& jobs)
+{
+    uint32_t width = lookup.getWidth();
+    uint32_t height = lookup.getHeight();
+    jobs.parallelFor(height, 1, [&](uint32_t begin, uint32_t end)
+    {
+        const Float3 N(0.0f, 0.0f, 1.0f);
+        for (uint32_t y = begin; y < end; y++)
+        {
+            float roughness = (y + 0.5f) / height;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                float NoV = (x + 0.5f) / width;
+                Float3 V(sqrtf(1.0f - NoV * NoV), 0.0f, NoV);
+                float scale = 0;
+                float bias = 0;
+                for (uint32_t i = 0; i < SOFTWARE_BRDF_SAMPLES; i++)
+                {
+                    float Xi[2];
+                    hammersley2d(i, SOFTWARE_BRDF_SAMPLES, Xi);
+                    Float3 H = importanceSampleGGX(Xi, roughness, N);
+                    Float3 L = H * (2.0f * dot(V, H)) - V;
+
+                    float dotNL = fmaxf(dot(N, L), 0.0f);
+                    float dotNV = fmaxf(dot(N, V), 0.0f);
+                    float dotVH = fmaxf(dot(V, H), 0.0f);
+                    float dotNH = fmaxf(dot(H, N), 0.0f);
+                    if (dotNL > 0.0f)
+                    {
+                        float G = schlickSmithGGX(dotNL, dotNV, roughness);
+                        float G_Vis = (G * dotVH) / (dotNH * dotNV);
+                        float Fc = powf(1.0f - dotVH, 5.0f);
+                        scale += (1.0f - Fc) * G_Vis;
+                        bias += Fc * G_Vis;
+                    }
+                }
+                float* texel = lookup.getTexels() + ((size_t)y * width + x) * 4;
+                texel[0] = scale / SOFTWARE_BRDF_SAMPLES;
+                texel[1] = bias / SOFTWARE_BRDF_SAMPLES;
+                texel[2] = 0.0f;
+                texel[3] = 1.0f;
+            }
+        }
+    });
+}
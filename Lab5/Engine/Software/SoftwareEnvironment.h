@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include "../../Utils/JobSystem.h"
+#include "SoftwareTexture.h"
+
+// The GPU shaders take 1000 x 250 irradiance and 1024 prefilter samples, the CPU gets away with far fewer
+#define SOFTWARE_IRRADIANCE_PHI_SAMPLES 128u
+#define SOFTWARE_IRRADIANCE_THETA_SAMPLES 32u
+#define SOFTWARE_PREFILTER_SAMPLES 256u
+#define SOFTWARE_BRDF_SAMPLES 1024u
+
+/*
+ * The image based lighting the CubemapGenerator renders, computed on the CPU with the same math as the
+ * Shaders/CubemapGen passes: the environment cube from an equirectangular image, its irradiance, the prefiltered
+ * levels and the BRDF lookup. Rows are spread over the jobs of a JobSystem.
+ */
+class SoftwareEnvironment
+{
+public:
+    /*
+     * HDRToCubePS, equirect is a 4 channel texture and cubemap a 4 channel cube
+     */
+    static void projectEquirect(const SoftwareTexture& equirect, SoftwareTexture& cubemap,
+                                JobSystem& jobs);
+    /*
+     * Stand-in when there is no HDR image, a sky gradient with a bright sun over dark ground
+     */
+    static void makeSky(SoftwareTexture& cubemap, JobSystem& jobs);
+    /*
+     * irradianceCube.hlsl into level 0 of irradiance
+     */
+    static void convolveIrradiance(const SoftwareTexture& cubemap, SoftwareTexture& irradiance,
+                                   JobSystem& jobs);
+    /*
+     * prefilterCube.hlsl, level i of prefiltered is filtered with pRoughness[i]
+     */
+    static void prefilter(const SoftwareTexture& cubemap, const float* pRoughness, SoftwareTexture& prefiltered,
+                          JobSystem& jobs);
+    /*
+     * brdfPS.hlsl, the scale and bias of the split sum in the first two channels
+     */
+    static void integrateBRDF(SoftwareTexture& lookup, JobSystem& jobs);
+
+private:
+    /*
+     * Runs function(face, x, y) for every texel of one level of a cube, rows in parallel
+     */
+    template <typename Function>
+    static void forEachCubeTexel(uint32_t size, JobSystem& jobs, const Function& function);
+};
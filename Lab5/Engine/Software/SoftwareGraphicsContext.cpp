@@ -0,0 +1,318 @@
+#include "SoftwareGraphicsContext.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    SoftwareBuffer* toBuffer(StateHandle buffer)
+    {
+        SoftwareBuffer* softwareBuffer = (SoftwareBuffer*)buffer;
+        if (!softwareBuffer || softwareBuffer->released)
+        {
+            throw std::runtime_error("Software device buffer is not alive");
+        }
+        return softwareBuffer;
+    }
+}
+
+SoftwareGraphicsContext::SoftwareGraphicsContext(SoftwareRasterizer& rasterizer, JobSystem& jobSystem) :
+    rasterizer(rasterizer), jobSystem(jobSystem)
+{
+}
+
+void SoftwareGraphicsContext::setShader(StateTrackerStage stage, StateHandle shader)
+{
+    tracker.setShader(stage, shader);
+    if (stage == STATE_TRACKER_VERTEX_STAGE)
+    {
+        vertexShader = (const SoftwareVertexShader*)shader;
+    }
+    else
+    {
+        pixelShader = (const SoftwarePixelShader*)shader;
+    }
+}
+
+void SoftwareGraphicsContext::setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                                 const StateHandle* pViews)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    tracker.setShaderResources(stage, start, amount, pViews, issueStart, issueAmount);
+    for (uint32_t i = 0; i < amount && start + i < STATE_TRACKER_SHADER_RESOURCE_SLOTS; i++)
+    {
+        bindings.stages[stage].shaderResources[start + i] = (const SoftwareView*)pViews[i];
+    }
+}
+
+void SoftwareGraphicsContext::setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                          const StateHandle* pSamplers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    tracker.setSamplers(stage, start, amount, pSamplers, issueStart, issueAmount);
+    for (uint32_t i = 0; i < amount && start + i < STATE_TRACKER_SAMPLER_SLOTS; i++)
+    {
+        bindings.stages[stage].samplers[start + i] = (const SoftwareSampler*)pSamplers[i];
+    }
+}
+
+void SoftwareGraphicsContext::setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                                 const StateConstantBuffer* pBuffers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    tracker.setConstantBuffers(stage, start, amount, pBuffers, issueStart, issueAmount);
+    for (uint32_t i = 0; i < amount && start + i < STATE_TRACKER_CONSTANT_BUFFER_SLOTS; i++)
+    {
+        bindings.stages[stage].constantBuffers[start + i] = pBuffers[i];
+    }
+}
+
+void SoftwareGraphicsContext::setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView)
+{
+    tracker.setRenderTargets(amount, pViews, depthView);
+    colorView = amount > 0 && pViews ? (const SoftwareView*)pViews[0] : nullptr;
+    this->depthView = (const SoftwareView*)depthView;
+}
+
+void SoftwareGraphicsContext::setDepthStencilState(StateHandle state, uint32_t stencilRef)
+{
+    tracker.setDepthStencilState(state, stencilRef);
+    depthState = (const SoftwareDepthState*)state;
+}
+
+void SoftwareGraphicsContext::setRasterizerState(StateHandle state)
+{
+    tracker.setRasterizerState(state);
+    rasterState = (const SoftwareRasterState*)state;
+}
+
+void SoftwareGraphicsContext::setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask)
+{
+    tracker.setBlendState(state, pBlendFactor, sampleMask);
+}
+
+void SoftwareGraphicsContext::setViewport(const StateViewport& viewport)
+{
+    tracker.setViewport(viewport);
+    this->viewport = viewport;
+}
+
+void SoftwareGraphicsContext::setInputLayout(StateHandle layout)
+{
+    tracker.setInputLayout(layout);
+}
+
+void SoftwareGraphicsContext::setPrimitiveTopology(uint32_t topology)
+{
+    tracker.setPrimitiveTopology(topology);
+    this->topology = topology;
+}
+
+void SoftwareGraphicsContext::setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset)
+{
+    tracker.setVertexBuffer(slot, buffer, stride, offset);
+    if (slot == 0)
+    {
+        vertexBuffer = (const SoftwareBuffer*)buffer;
+        vertexStride = stride;
+        vertexOffset = offset;
+    }
+}
+
+void SoftwareGraphicsContext::setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset)
+{
+    if (buffer && format != GRAPHICS_FORMAT_R32_UINT)
+    {
+        throw std::runtime_error("Software device only reads 32 bit indices");
+    }
+    tracker.setIndexBuffer(buffer, format, offset);
+    indexBuffer = (const SoftwareBuffer*)buffer;
+    indexOffset = offset;
+}
+
+void SoftwareGraphicsContext::clearRenderTarget(StateHandle view, const float* pColor)
+{
+    const SoftwareView* softwareView = (const SoftwareView*)view;
+    if (softwareView && softwareView->texture)
+    {
+        softwareView->texture->clear(pColor);
+    }
+}
+
+void SoftwareGraphicsContext::clearDepthStencil(StateHandle view, float depth, uint8_t stencil)
+{
+    const SoftwareView* softwareView = (const SoftwareView*)view;
+    if (softwareView && softwareView->texture)
+    {
+        softwareView->texture->clear(&depth);
+    }
+}
+
+void SoftwareGraphicsContext::draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    sequentialIndices.resize(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        sequentialIndices[i] = startVertex + i;
+    }
+    execute(sequentialIndices.data(), vertexCount, 1, 0);
+}
+
+void SoftwareGraphicsContext::drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    drawIndexedInstanced(indexCount, 1, startIndex, baseVertex, 0);
+}
+
+void SoftwareGraphicsContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex,
+                                                   int32_t baseVertex, uint32_t startInstance)
+{
+    if (startInstance != 0)
+    {
+        throw std::runtime_error("Software device draws from instance 0 only");
+    }
+    const SoftwareBuffer* buffer = toBuffer(indexBuffer);
+    uint64_t end = indexOffset + ((uint64_t)startIndex + indexCount) * sizeof(uint32_t);
+    if (end > buffer->data.size())
+    {
+        throw std::runtime_error("Draw reads past the index buffer");
+    }
+    const uint32_t* indices = (const uint32_t*)(buffer->data.data() + indexOffset) + startIndex;
+    execute(indices, indexCount, instanceCount, baseVertex);
+}
+
+void* SoftwareGraphicsContext::map(StateHandle buffer, GraphicsMapMode mode)
+{
+    SoftwareBuffer* softwareBuffer = toBuffer(buffer);
+    if (!softwareBuffer->desc.dynamic)
+    {
+        throw std::runtime_error("Only dynamic buffers can be mapped");
+    }
+    return softwareBuffer->data.data();
+}
+
+void SoftwareGraphicsContext::unmap(StateHandle buffer)
+{
+    toBuffer(buffer);
+}
+
+void SoftwareGraphicsContext::updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData)
+{
+    SoftwareBuffer* softwareBuffer = toBuffer(buffer);
+    if (size == 0)
+    {
+        offset = 0;
+        size = (uint32_t)softwareBuffer->data.size();
+    }
+    if ((uint64_t)offset + size > softwareBuffer->data.size())
+    {
+        throw std::runtime_error("Buffer update out of range");
+    }
+    memcpy(softwareBuffer->data.data() + offset, pData, size);
+}
+
+void SoftwareGraphicsContext::signalFence(StateHandle fence)
+{
+}
+
+bool SoftwareGraphicsContext::isFenceDone(StateHandle fence, bool wait)
+{
+    return true;
+}
+
+void SoftwareGraphicsContext::invalidate()
+{
+    tracker.invalidate();
+}
+
+void SoftwareGraphicsContext::beginFrame()
+{
+    tracker.beginFrame();
+    rasterizer.beginFrame();
+}
+
+const StateTrackerStats& SoftwareGraphicsContext::getLastFrameStats() const
+{
+    return tracker.getLastFrameStats();
+}
+
+const SoftwareRasterizerStats& SoftwareGraphicsContext::getLastFrameRasterStats() const
+{
+    return rasterizer.getLastFrameStats();
+}
+
+void SoftwareGraphicsContext::execute(const uint32_t* pIndices, uint32_t indicesAmount, uint32_t instancesAmount,
+                                      int32_t baseVertex)
+{
+    if (!vertexShader)
+    {
+        throw std::runtime_error("Software draw without a vertex shader");
+    }
+    if (topology != GRAPHICS_TOPOLOGY_TRIANGLE_LIST)
+    {
+        throw std::runtime_error("Software device only draws triangle lists");
+    }
+    if (indicesAmount < 3 || instancesAmount == 0)
+    {
+        return;
+    }
+    uint32_t minIndex = pIndices[0];
+    uint32_t maxIndex = pIndices[0];
+    for (uint32_t i = 1; i < indicesAmount; i++)
+    {
+        minIndex = pIndices[i] < minIndex ? pIndices[i] : minIndex;
+        maxIndex = pIndices[i] > maxIndex ? pIndices[i] : maxIndex;
+    }
+    const uint8_t* vertexData = nullptr;
+    if (vertexBuffer)
+    {
+        const SoftwareBuffer* buffer = toBuffer(vertexBuffer);
+        int64_t first = (int64_t)vertexOffset + ((int64_t)baseVertex + minIndex) * vertexStride;
+        int64_t end = (int64_t)vertexOffset + ((int64_t)baseVertex + maxIndex + 1) * vertexStride;
+        if (first < 0 || end > (int64_t)buffer->data.size())
+        {
+            throw std::runtime_error("Draw reads past the vertex buffer");
+        }
+        vertexData = buffer->data.data() + first;
+    }
+    uint32_t verticesPerInstance = maxIndex - minIndex + 1;
+    uint64_t verticesAmount = (uint64_t)verticesPerInstance * instancesAmount;
+    shadedVertices.resize(verticesAmount);
+    const SoftwareVertexShader* shader = vertexShader;
+    uint32_t stride = vertexStride;
+    jobSystem.parallelFor((uint32_t)verticesAmount, 1024, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t v = begin; v < end; v++)
+        {
+            uint32_t local = v % verticesPerInstance;
+            const float* input = vertexData ? (const float*)(vertexData + (size_t)local * stride) : nullptr;
+            shader->shade(bindings, input, (uint32_t)((int32_t)(minIndex + local) + baseVertex),
+                          v / verticesPerInstance, shadedVertices[v]);
+        }
+    });
+
+    localIndices.resize(indicesAmount);
+    for (uint32_t i = 0; i < indicesAmount; i++)
+    {
+        localIndices[i] = pIndices[i] - minIndex;
+    }
+
+    SoftwareDrawState state;
+    if (depthState)
+    {
+        state.depth = *depthState;
+    }
+    if (rasterState)
+    {
+        state.raster = *rasterState;
+    }
+    state.pixelShader = pixelShader;
+    state.bindings = &bindings;
+    state.varyingsAmount = vertexShader->getVaryingsAmount();
+    rasterizer.setTargets(colorView ? colorView->texture : nullptr, depthView ? depthView->texture : nullptr,
+                          viewport);
+    rasterizer.drawIndexed(state, shadedVertices.data(), verticesPerInstance, localIndices.data(), indicesAmount,
+                           instancesAmount);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../Device/GraphicsContext.h"
+#include "SoftwareRasterizer.h"
+
+/*
+ * GraphicsContext that draws on the CPU. Handles are the objects of the SoftwareGraphicsDevice, draws run the C++
+ * shader ports through the SoftwareRasterizer and return once the targets are written, so fences are done as soon as
+ * they are signaled. Bindings still go through a StateTracker, a frame reports the same binding calls as on a GPU.
+ * Only triangle lists, R32_UINT indices, the first render target and vertex buffer slot 0 are supported.
+ */
+class SoftwareGraphicsContext : public GraphicsContext
+{
+public:
+    SoftwareGraphicsContext(SoftwareRasterizer& rasterizer, JobSystem& jobSystem);
+
+private:
+    SoftwareRasterizer& rasterizer;
+    JobSystem& jobSystem;
+    StateTracker tracker;
+    const SoftwareVertexShader* vertexShader = nullptr;
+    const SoftwarePixelShader* pixelShader = nullptr;
+    SoftwareBindings bindings;
+    const SoftwareView* colorView = nullptr;
+    const SoftwareView* depthView = nullptr;
+    const SoftwareDepthState* depthState = nullptr;
+    const SoftwareRasterState* rasterState = nullptr;
+    StateViewport viewport{};
+    uint32_t topology = GRAPHICS_TOPOLOGY_TRIANGLE_LIST;
+    const SoftwareBuffer* vertexBuffer = nullptr;
+    uint32_t vertexStride = 0;
+    uint32_t vertexOffset = 0;
+    const SoftwareBuffer* indexBuffer = nullptr;
+    uint32_t indexOffset = 0;
+    std::vector<SoftwareVertex> shadedVertices;
+    std::vector<uint32_t> sequentialIndices;
+    // Indices of the draw relative to the first vertex it shades
+    std::vector<uint32_t> localIndices;
+
+public:
+    void setShader(StateTrackerStage stage, StateHandle shader) override;
+    void setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateHandle* pViews) override;
+    void setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount, const StateHandle* pSamplers) override;
+    void setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateConstantBuffer* pBuffers) override;
+    void setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView) override;
+    void setDepthStencilState(StateHandle state, uint32_t stencilRef) override;
+    void setRasterizerState(StateHandle state) override;
+    void setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask) override;
+    void setViewport(const StateViewport& viewport) override;
+    void setInputLayout(StateHandle layout) override;
+    void setPrimitiveTopology(uint32_t topology) override;
+    void setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset) override;
+    void setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset) override;
+
+    void clearRenderTarget(StateHandle view, const float* pColor) override;
+    void clearDepthStencil(StateHandle view, float depth, uint8_t stencil) override;
+    void draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void* map(StateHandle buffer, GraphicsMapMode mode) override;
+    void unmap(StateHandle buffer) override;
+    void updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData) override;
+    void signalFence(StateHandle fence) override;
+    bool isFenceDone(StateHandle fence, bool wait) override;
+
+    void invalidate() override;
+    void beginFrame() override;
+    const StateTrackerStats& getLastFrameStats() const override;
+    const SoftwareRasterizerStats& getLastFrameRasterStats() const;
+
+private:
+    /*
+     * Shades every vertex the indices reach once per instance, then rasterizes
+     */
+    void execute(const uint32_t* pIndices, uint32_t indicesAmount, uint32_t instancesAmount, int32_t baseVertex);
+};
@@ -0,0 +1,126 @@
+#include "SoftwareGraphicsDevice.h"
+
+#include <cstring>
+
+SoftwareGraphicsDevice::SoftwareGraphicsDevice(JobSystem& jobSystem) : rasterizer(jobSystem),
+    immediateContext(rasterizer, jobSystem)
+{
+    capabilities.constantBufferOffsets = true;
+    capabilities.constantBufferPartialUpdates = true;
+    capabilities.constantBufferNoOverwrite = true;
+}
+
+const GraphicsCapabilities& SoftwareGraphicsDevice::getCapabilities() const
+{
+    return capabilities;
+}
+
+GraphicsBuffer SoftwareGraphicsDevice::createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                                    const char* bufferName)
+{
+    buffers.push_back(std::make_unique<SoftwareBuffer>());
+    SoftwareBuffer* softwareBuffer = buffers.back().get();
+    softwareBuffer->desc = desc;
+    softwareBuffer->data.resize(desc.size);
+    if (pInitData)
+    {
+        memcpy(softwareBuffer->data.data(), pInitData, desc.size);
+    }
+
+    GraphicsBuffer buffer;
+    buffer.buffer = softwareBuffer;
+    if (desc.bindFlags & GRAPHICS_BIND_SHADER_RESOURCE)
+    {
+        views.push_back(std::make_unique<SoftwareView>());
+        views.back()->buffer = softwareBuffer;
+        buffer.shaderResourceView = views.back().get();
+    }
+    buffer.size = desc.size;
+    return buffer;
+}
+
+void SoftwareGraphicsDevice::releaseBuffer(GraphicsBuffer& buffer)
+{
+    SoftwareBuffer* softwareBuffer = (SoftwareBuffer*)buffer.buffer;
+    if (softwareBuffer && !softwareBuffer->released)
+    {
+        softwareBuffer->released = true;
+        std::vector<uint8_t>().swap(softwareBuffer->data);
+    }
+    buffer = {};
+}
+
+StateHandle SoftwareGraphicsDevice::createFence()
+{
+    objects.push_back(std::make_unique<uint8_t>());
+    return objects.back().get();
+}
+
+void SoftwareGraphicsDevice::releaseFence(StateHandle fence)
+{
+}
+
+GraphicsContext* SoftwareGraphicsDevice::getImmediateContext()
+{
+    return &immediateContext;
+}
+
+SoftwareGraphicsContext* SoftwareGraphicsDevice::getSoftwareContext()
+{
+    return &immediateContext;
+}
+
+SoftwareRasterizer& SoftwareGraphicsDevice::getRasterizer()
+{
+    return rasterizer;
+}
+
+SoftwareTexture* SoftwareGraphicsDevice::createTexture(uint32_t width, uint32_t height, uint32_t channelsAmount,
+                                                       uint32_t mipsAmount, uint32_t facesAmount)
+{
+    textures.push_back(std::make_unique<SoftwareTexture>(width, height, channelsAmount, mipsAmount, facesAmount));
+    return textures.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createView(SoftwareTexture* texture)
+{
+    views.push_back(std::make_unique<SoftwareView>());
+    views.back()->texture = texture;
+    return views.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createSampler(const SoftwareSampler& sampler)
+{
+    samplers.push_back(std::make_unique<SoftwareSampler>(sampler));
+    return samplers.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createDepthState(const SoftwareDepthState& state)
+{
+    depthStates.push_back(std::make_unique<SoftwareDepthState>(state));
+    return depthStates.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createRasterState(const SoftwareRasterState& state)
+{
+    rasterStates.push_back(std::make_unique<SoftwareRasterState>(state));
+    return rasterStates.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createVertexShader(std::unique_ptr<SoftwareVertexShader> shader)
+{
+    vertexShaders.push_back(std::move(shader));
+    return vertexShaders.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createPixelShader(std::unique_ptr<SoftwarePixelShader> shader)
+{
+    pixelShaders.push_back(std::move(shader));
+    return pixelShaders.back().get();
+}
+
+StateHandle SoftwareGraphicsDevice::createInputLayout()
+{
+    objects.push_back(std::make_unique<uint8_t>());
+    return objects.back().get();
+}
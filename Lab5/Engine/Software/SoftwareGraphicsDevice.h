@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../Device/GraphicsDevice.h"
+#include "SoftwareGraphicsContext.h"
+#include "SoftwareRasterizer.h"
+
+/*
+ * GraphicsDevice that renders on the CPU, for reference images and machines without a GPU. Next to buffers it creates
+ * the objects a real API would, textures and their views, samplers, pipeline states and shaders, as the plain structs
+ * the SoftwareGraphicsContext reads. Objects live until the device is destroyed so a handle is never reused while
+ * some tracker still caches it.
+ */
+class SoftwareGraphicsDevice : public GraphicsDevice
+{
+public:
+    /*
+     * The vertex shading, setup and raster jobs run on jobSystem
+     */
+    explicit SoftwareGraphicsDevice(JobSystem& jobSystem);
+
+private:
+    GraphicsCapabilities capabilities;
+    SoftwareRasterizer rasterizer;
+    SoftwareGraphicsContext immediateContext;
+    std::vector<std::unique_ptr<SoftwareBuffer>> buffers;
+    std::vector<std::unique_ptr<SoftwareTexture>> textures;
+    std::vector<std::unique_ptr<SoftwareView>> views;
+    std::vector<std::unique_ptr<SoftwareSampler>> samplers;
+    std::vector<std::unique_ptr<SoftwareDepthState>> depthStates;
+    std::vector<std::unique_ptr<SoftwareRasterState>> rasterStates;
+    std::vector<std::unique_ptr<SoftwareVertexShader>> vertexShaders;
+    std::vector<std::unique_ptr<SoftwarePixelShader>> pixelShaders;
+    std::vector<std::unique_ptr<uint8_t>> objects;
+
+public:
+    const GraphicsCapabilities& getCapabilities() const override;
+    GraphicsBuffer createBuffer(const GraphicsBufferDesc& desc, const void* pInitData,
+                                const char* bufferName = nullptr) override;
+    void releaseBuffer(GraphicsBuffer& buffer) override;
+    StateHandle createFence() override;
+    void releaseFence(StateHandle fence) override;
+    GraphicsContext* getImmediateContext() override;
+    SoftwareGraphicsContext* getSoftwareContext();
+    SoftwareRasterizer& getRasterizer();
+
+    /*
+     * See SoftwareTexture, the device owns it
+     */
+    SoftwareTexture* createTexture(uint32_t width, uint32_t height, uint32_t channelsAmount, uint32_t mipsAmount = 1,
+                                   uint32_t facesAmount = 1);
+    /*
+     * Shader resource, render target or depth view of the whole texture
+     */
+    StateHandle createView(SoftwareTexture* texture);
+    StateHandle createSampler(const SoftwareSampler& sampler);
+    StateHandle createDepthState(const SoftwareDepthState& state);
+    StateHandle createRasterState(const SoftwareRasterState& state);
+    StateHandle createVertexShader(std::unique_ptr<SoftwareVertexShader> shader);
+    StateHandle createPixelShader(std::unique_ptr<SoftwarePixelShader> shader);
+    /*
+     * Vertex shaders read their input directly, the layout only has to be a distinct handle
+     */
+    StateHandle createInputLayout();
+};
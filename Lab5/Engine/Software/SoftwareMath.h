@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cmath>
+
+#define SOFTWARE_PI 3.14159265359f
+
+/*
+ * float3 of the shader ports, only the operations the HLSL code uses
+ */
+struct Float3
+{
+    float x = 0;
+    float y = 0;
+    float z = 0;
+
+    Float3() = default;
+    Float3(float x, float y, float z) : x(x), y(y), z(z)
+    {
+    }
+
+    explicit Float3(const float* pValues) : x(pValues[0]), y(pValues[1]), z(pValues[2])
+    {
+    }
+};
+
+inline Float3 operator+(const Float3& a, const Float3& b)
+{
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+inline Float3 operator-(const Float3& a, const Float3& b)
+{
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+inline Float3 operator-(const Float3& a)
+{
+    return {-a.x, -a.y, -a.z};
+}
+
+inline Float3 operator*(const Float3& a, const Float3& b)
+{
+    return {a.x * b.x, a.y * b.y, a.z * b.z};
+}
+
+inline Float3 operator*(const Float3& a, float s)
+{
+    return {a.x * s, a.y * s, a.z * s};
+}
+
+inline Float3 operator*(float s, const Float3& a)
+{
+    return {a.x * s, a.y * s, a.z * s};
+}
+
+inline Float3 operator/(const Float3& a, float s)
+{
+    return a * (1.0f / s);
+}
+
+inline Float3& operator+=(Float3& a, const Float3& b)
+{
+    a = a + b;
+    return a;
+}
+
+inline float dot(const Float3& a, const Float3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+inline Float3 cross(const Float3& a, const Float3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+inline float length(const Float3& a)
+{
+    return sqrtf(dot(a, a));
+}
+
+inline Float3 normalize(const Float3& a)
+{
+    float squared = dot(a, a);
+    return squared > 0 ? a * (1.0f / sqrtf(squared)) : a;
+}
+
+inline Float3 reflect(const Float3& incident, const Float3& normal)
+{
+    return incident - normal * (2.0f * dot(incident, normal));
+}
+
+inline Float3 lerp(const Float3& a, const Float3& b, float t)
+{
+    return a + (b - a) * t;
+}
+
+/*
+ * NaN saturates to 0 like on the GPU
+ */
+inline float saturate(float value)
+{
+    return value > 0 ? (value < 1 ? value : 1) : 0;
+}
+
+inline float clampValue(float value, float low, float high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
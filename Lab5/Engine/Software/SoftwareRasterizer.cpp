@@ -0,0 +1,550 @@
+#include "SoftwareRasterizer.h"
+
+#include <cmath>
+#include <emmintrin.h>
+#include <stdexcept>
+
+// Fan of a triangle clipped by every plane, each plane adds at most one vertex
+#define SOFTWARE_CLIP_PLANES_AMOUNT 7
+#define SOFTWARE_CLIP_MAX_VERTICES (3 + SOFTWARE_CLIP_PLANES_AMOUNT)
+#define SOFTWARE_CLIP_MIN_W 1e-5f
+
+namespace
+{
+    /*
+     * Inside is a * x + b * y + c * z + d * w + e >= 0
+     */
+    const float clipPlanes[SOFTWARE_CLIP_PLANES_AMOUNT][5] = {
+        {0, 0, 0, 1, -SOFTWARE_CLIP_MIN_W},
+        {0, 0, 1, 0, 0},
+        {0, 0, -1, 1, 0},
+        {1, 0, 0, SOFTWARE_GUARD_BAND, 0},
+        {-1, 0, 0, SOFTWARE_GUARD_BAND, 0},
+        {0, 1, 0, SOFTWARE_GUARD_BAND, 0},
+        {0, -1, 0, SOFTWARE_GUARD_BAND, 0}
+    };
+
+    inline float planeDistance(const float* plane, const float* position)
+    {
+        return plane[0] * position[0] + plane[1] * position[1] + plane[2] * position[2] + plane[3] * position[3] +
+            plane[4];
+    }
+
+    void lerpVertex(const SoftwareVertex& a, const SoftwareVertex& b, float t, uint32_t varyingsAmount,
+                    SoftwareVertex& output)
+    {
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            output.position[i] = a.position[i] + (b.position[i] - a.position[i]) * t;
+        }
+        for (uint32_t i = 0; i < varyingsAmount; i++)
+        {
+            output.varyings[i] = a.varyings[i] + (b.varyings[i] - a.varyings[i]) * t;
+        }
+    }
+
+    /*
+     * Sutherland-Hodgman against one plane, returns the vertices left in pOutput
+     */
+    uint32_t clipPolygon(const float* plane, const SoftwareVertex* pInput, uint32_t inputAmount,
+                         uint32_t varyingsAmount, SoftwareVertex* pOutput)
+    {
+        uint32_t outputAmount = 0;
+        for (uint32_t i = 0; i < inputAmount; i++)
+        {
+            const SoftwareVertex& current = pInput[i];
+            const SoftwareVertex& next = pInput[(i + 1) % inputAmount];
+            float currentDistance = planeDistance(plane, current.position);
+            float nextDistance = planeDistance(plane, next.position);
+            if (currentDistance >= 0)
+            {
+                pOutput[outputAmount++] = current;
+            }
+            if ((currentDistance >= 0) != (nextDistance >= 0))
+            {
+                float t = currentDistance / (currentDistance - nextDistance);
+                lerpVertex(current, next, t, varyingsAmount, pOutput[outputAmount++]);
+            }
+        }
+        return outputAmount;
+    }
+
+    inline int32_t clampInt(int32_t value, int32_t low, int32_t high)
+    {
+        return value < low ? low : (value > high ? high : value);
+    }
+
+    inline bool passesDepth(SoftwareDepthFunc depthFunc, float depth, float stored)
+    {
+        switch (depthFunc)
+        {
+        case SOFTWARE_DEPTH_LESS:
+            return depth < stored;
+        case SOFTWARE_DEPTH_LESS_EQUAL:
+            return depth <= stored;
+        default:
+            return true;
+        }
+    }
+
+    void addStats(SoftwareRasterizerStats& target, const SoftwareRasterizerStats& source)
+    {
+        target.submittedTriangles += source.submittedTriangles;
+        target.culledTriangles += source.culledTriangles;
+        target.clippedTriangles += source.clippedTriangles;
+        target.binnedTriangles += source.binnedTriangles;
+        target.shadedPixels += source.shadedPixels;
+        target.stolenTiles += source.stolenTiles;
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem& jobSystem) : jobSystem(jobSystem)
+{
+    workerStats.resize(jobSystem.getThreadsAmount());
+}
+
+void SoftwareRasterizer::setTargets(SoftwareTexture* colorTarget, SoftwareTexture* depthTarget,
+                                    const StateViewport& viewport)
+{
+    if ((colorTarget && colorTarget->getChannelsAmount() != 4) ||
+        (depthTarget && depthTarget->getChannelsAmount() != 1))
+    {
+        throw std::runtime_error("Software render targets need 4 color channels and 1 depth channel");
+    }
+    this->colorTarget = colorTarget;
+    this->depthTarget = depthTarget;
+    this->viewport = viewport;
+
+    int32_t width = INT32_MAX;
+    int32_t height = INT32_MAX;
+    for (SoftwareTexture* target : {colorTarget, depthTarget})
+    {
+        if (target)
+        {
+            width = (int32_t)target->getWidth() < width ? (int32_t)target->getWidth() : width;
+            height = (int32_t)target->getHeight() < height ? (int32_t)target->getHeight() : height;
+        }
+    }
+    if (!colorTarget && !depthTarget)
+    {
+        width = 0;
+        height = 0;
+    }
+    scissor[0] = clampInt((int32_t)floorf(viewport.x), 0, width);
+    scissor[1] = clampInt((int32_t)floorf(viewport.y), 0, height);
+    scissor[2] = clampInt((int32_t)ceilf(viewport.x + viewport.width), scissor[0], width);
+    scissor[3] = clampInt((int32_t)ceilf(viewport.y + viewport.height), scissor[1], height);
+    tilesX = (uint32_t)(width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+    tilesY = (uint32_t)(height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+}
+
+void SoftwareRasterizer::drawIndexed(const SoftwareDrawState& state, const SoftwareVertex* pVertices,
+                                     uint32_t verticesPerInstance, const uint32_t* pIndices, uint32_t indicesAmount,
+                                     uint32_t instancesAmount)
+{
+    uint64_t trianglesAmount = (uint64_t)(indicesAmount / 3) * instancesAmount;
+    if (trianglesAmount == 0 || scissor[0] == scissor[2] || scissor[1] == scissor[3])
+    {
+        return;
+    }
+    jobsAmount = (uint32_t)((trianglesAmount + SOFTWARE_TRIANGLES_PER_JOB - 1) / SOFTWARE_TRIANGLES_PER_JOB);
+    if (jobs.size() < jobsAmount)
+    {
+        jobs.resize(jobsAmount);
+    }
+    jobSystem.parallelFor(jobsAmount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            uint64_t first = (uint64_t)i * SOFTWARE_TRIANGLES_PER_JOB;
+            uint64_t last = first + SOFTWARE_TRIANGLES_PER_JOB < trianglesAmount
+                                ? first + SOFTWARE_TRIANGLES_PER_JOB
+                                : trianglesAmount;
+            setupJob(state, pVertices, verticesPerInstance, pIndices, indicesAmount, (uint32_t)first,
+                     (uint32_t)last, jobs[i]);
+        }
+    });
+    binTriangles();
+
+    uint32_t workersAmount = jobSystem.getThreadsAmount();
+    scheduler.reset(tilesX * tilesY, workersAmount);
+    for (auto& stats : workerStats)
+    {
+        stats = {};
+    }
+    // One job per scheduler slot, whichever thread runs it
+    jobSystem.parallelFor(workersAmount, 1, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t worker = begin; worker < end; worker++)
+        {
+            uint32_t tile;
+            while (scheduler.next(worker, tile))
+            {
+                rasterizeTile(state, tile, workerStats[worker]);
+            }
+        }
+    });
+
+    for (uint32_t i = 0; i < jobsAmount; i++)
+    {
+        addStats(frameStats, jobs[i].stats);
+    }
+    for (auto& stats : workerStats)
+    {
+        addStats(frameStats, stats);
+    }
+    frameStats.stolenTiles += scheduler.getStolenTilesAmount();
+}
+
+uint32_t SoftwareRasterizer::getThreadsAmount() const
+{
+    return jobSystem.getThreadsAmount();
+}
+
+void SoftwareRasterizer::beginFrame()
+{
+    lastFrameStats = frameStats;
+    frameStats = {};
+}
+
+const SoftwareRasterizerStats& SoftwareRasterizer::getLastFrameStats() const
+{
+    return lastFrameStats;
+}
+
+void SoftwareRasterizer::setupJob(const SoftwareDrawState& state, const SoftwareVertex* pVertices,
+                                  uint32_t verticesPerInstance, const uint32_t* pIndices, uint32_t indicesAmount,
+                                  uint32_t firstTriangle, uint32_t lastTriangle, SetupJob& job) const
+{
+    job.triangles.clear();
+    job.varyings.clear();
+    job.bins.clear();
+    job.stats = {};
+
+    uint32_t trianglesPerInstance = indicesAmount / 3;
+    uint32_t varyingsAmount = state.varyingsAmount;
+    SoftwareVertex clipBuffers[2][SOFTWARE_CLIP_MAX_VERTICES];
+    for (uint32_t t = firstTriangle; t < lastTriangle; t++)
+    {
+        job.stats.submittedTriangles++;
+        uint32_t instance = t / trianglesPerInstance;
+        const uint32_t* indices = pIndices + (t % trianglesPerInstance) * 3;
+        const SoftwareVertex* instanceVertices = pVertices + (size_t)instance * verticesPerInstance;
+        const SoftwareVertex* vertices[3] = {
+            instanceVertices + indices[0], instanceVertices + indices[1], instanceVertices + indices[2]
+        };
+
+        // Trivial cases first, nearly every triangle is either fully inside or fully outside one plane
+        uint32_t outsideAny = 0;
+        bool rejected = false;
+        for (uint32_t p = 0; p < SOFTWARE_CLIP_PLANES_AMOUNT && !rejected; p++)
+        {
+            uint32_t outside = 0;
+            for (uint32_t v = 0; v < 3; v++)
+            {
+                outside += planeDistance(clipPlanes[p], vertices[v]->position) < 0 ? 1 : 0;
+            }
+            rejected = outside == 3;
+            outsideAny += outside;
+        }
+        if (rejected)
+        {
+            job.stats.culledTriangles++;
+            continue;
+        }
+        if (outsideAny == 0)
+        {
+            setupTriangle(state, vertices, job);
+            continue;
+        }
+
+        job.stats.clippedTriangles++;
+        uint32_t polygonAmount = 3;
+        for (uint32_t v = 0; v < 3; v++)
+        {
+            clipBuffers[0][v] = *vertices[v];
+        }
+        uint32_t current = 0;
+        for (uint32_t p = 0; p < SOFTWARE_CLIP_PLANES_AMOUNT && polygonAmount >= 3; p++)
+        {
+            polygonAmount = clipPolygon(clipPlanes[p], clipBuffers[current], polygonAmount, varyingsAmount,
+                                        clipBuffers[1 - current]);
+            current = 1 - current;
+        }
+        for (uint32_t v = 1; v + 1 < polygonAmount; v++)
+        {
+            const SoftwareVertex* fan[3] = {&clipBuffers[current][0], &clipBuffers[current][v],
+                                            &clipBuffers[current][v + 1]};
+            setupTriangle(state, fan, job);
+        }
+    }
+}
+
+void SoftwareRasterizer::setupTriangle(const SoftwareDrawState& state, const SoftwareVertex* pVertices[3],
+                                       SetupJob& job) const
+{
+    float screenX[3];
+    float screenY[3];
+    float screenZ[3];
+    float inverseW[3];
+    for (uint32_t v = 0; v < 3; v++)
+    {
+        const float* position = pVertices[v]->position;
+        inverseW[v] = 1.0f / position[3];
+        screenX[v] = viewport.x + (position[0] * inverseW[v] + 1.0f) * 0.5f * viewport.width;
+        screenY[v] = viewport.y + (1.0f - position[1] * inverseW[v]) * 0.5f * viewport.height;
+        screenZ[v] = viewport.minDepth + position[2] * inverseW[v] * (viewport.maxDepth - viewport.minDepth);
+    }
+
+    // Positive when the triangle runs clockwise on screen, y points down
+    double area = ((double)screenX[1] - screenX[0]) * ((double)screenY[2] - screenY[0]) -
+        ((double)screenX[2] - screenX[0]) * ((double)screenY[1] - screenY[0]);
+    bool frontFace = (area > 0) != state.raster.frontCounterClockwise;
+    if (area == 0 || (state.raster.cullMode == SOFTWARE_CULL_BACK && !frontFace) ||
+        (state.raster.cullMode == SOFTWARE_CULL_FRONT && frontFace))
+    {
+        job.stats.culledTriangles++;
+        return;
+    }
+    uint32_t order[3] = {0, 1, 2};
+    if (area < 0)
+    {
+        order[1] = 2;
+        order[2] = 1;
+        area = -area;
+    }
+
+    float minX = screenX[0];
+    float maxX = screenX[0];
+    float minY = screenY[0];
+    float maxY = screenY[0];
+    for (uint32_t v = 1; v < 3; v++)
+    {
+        minX = screenX[v] < minX ? screenX[v] : minX;
+        maxX = screenX[v] > maxX ? screenX[v] : maxX;
+        minY = screenY[v] < minY ? screenY[v] : minY;
+        maxY = screenY[v] > maxY ? screenY[v] : maxY;
+    }
+    SetupTriangle triangle;
+    triangle.minX = clampInt((int32_t)floorf(minX), scissor[0], scissor[2]);
+    triangle.maxX = clampInt((int32_t)ceilf(maxX), scissor[0], scissor[2]);
+    triangle.minY = clampInt((int32_t)floorf(minY), scissor[1], scissor[3]);
+    triangle.maxY = clampInt((int32_t)ceilf(maxY), scissor[1], scissor[3]);
+    if (triangle.minX == triangle.maxX || triangle.minY == triangle.maxY)
+    {
+        job.stats.culledTriangles++;
+        return;
+    }
+
+    for (uint32_t e = 0; e < 3; e++)
+    {
+        // Edge e runs between the two vertices other than e and is positive on the side of e
+        uint32_t a = order[(e + 1) % 3];
+        uint32_t b = order[(e + 2) % 3];
+        double edgeA = (double)screenY[a] - screenY[b];
+        double edgeB = (double)screenX[b] - screenX[a];
+        triangle.edgeA[e] = edgeA;
+        triangle.edgeB[e] = edgeB;
+        triangle.edgeC[e] = -(edgeA * screenX[a] + edgeB * screenY[a]);
+        triangle.topLeft[e] = edgeA > 0 || (edgeA == 0 && edgeB > 0) ? 0xFFFFFFFFu : 0;
+        triangle.z[e] = screenZ[order[e]];
+        triangle.inverseW[e] = inverseW[order[e]];
+    }
+    triangle.inverseArea = 1.0 / area;
+
+    triangle.varyingsOffset = (uint32_t)job.varyings.size();
+    for (uint32_t v = 0; v < 3; v++)
+    {
+        const SoftwareVertex* vertex = pVertices[order[v]];
+        for (uint32_t i = 0; i < state.varyingsAmount; i++)
+        {
+            job.varyings.push_back(vertex->varyings[i] * inverseW[order[v]]);
+        }
+    }
+
+    uint32_t triangleIndex = (uint32_t)job.triangles.size();
+    job.triangles.push_back(triangle);
+    uint32_t firstTileX = triangle.minX / SOFTWARE_TILE_SIZE;
+    uint32_t lastTileX = (triangle.maxX - 1) / SOFTWARE_TILE_SIZE;
+    uint32_t firstTileY = triangle.minY / SOFTWARE_TILE_SIZE;
+    uint32_t lastTileY = (triangle.maxY - 1) / SOFTWARE_TILE_SIZE;
+    for (uint32_t tileY = firstTileY; tileY <= lastTileY; tileY++)
+    {
+        for (uint32_t tileX = firstTileX; tileX <= lastTileX; tileX++)
+        {
+            job.bins.push_back({tileY * tilesX + tileX, triangleIndex});
+        }
+    }
+    job.stats.binnedTriangles += (uint64_t)(lastTileX - firstTileX + 1) * (lastTileY - firstTileY + 1);
+}
+
+void SoftwareRasterizer::binTriangles()
+{
+    uint32_t tilesAmount = tilesX * tilesY;
+    tileOffsets.assign(tilesAmount + 1, 0);
+    for (uint32_t i = 0; i < jobsAmount; i++)
+    {
+        for (const BinEntry& entry : jobs[i].bins)
+        {
+            tileOffsets[entry.tile + 1]++;
+        }
+    }
+    for (uint32_t tile = 0; tile < tilesAmount; tile++)
+    {
+        tileOffsets[tile + 1] += tileOffsets[tile];
+    }
+    tileReferences.resize(tileOffsets[tilesAmount]);
+    tileCursors.assign(tileOffsets.begin(), tileOffsets.end() - 1);
+    // Jobs hold consecutive triangles, walking them in order keeps every bin in submission order
+    for (uint32_t i = 0; i < jobsAmount; i++)
+    {
+        for (const BinEntry& entry : jobs[i].bins)
+        {
+            tileReferences[tileCursors[entry.tile]++] = {i, entry.triangle};
+        }
+    }
+}
+
+void SoftwareRasterizer::rasterizeTile(const SoftwareDrawState& state, uint32_t tile,
+                                       SoftwareRasterizerStats& stats) const
+{
+    uint32_t first = tileOffsets[tile];
+    uint32_t end = tileOffsets[tile + 1];
+    if (first == end)
+    {
+        return;
+    }
+    int32_t tileX = (int32_t)(tile % tilesX) * SOFTWARE_TILE_SIZE;
+    int32_t tileY = (int32_t)(tile / tilesX) * SOFTWARE_TILE_SIZE;
+    int32_t tileBounds[4] = {tileX, tileY, tileX + SOFTWARE_TILE_SIZE, tileY + SOFTWARE_TILE_SIZE};
+    for (uint32_t i = first; i < end; i++)
+    {
+        const SetupJob& job = jobs[tileReferences[i].job];
+        const SetupTriangle& triangle = job.triangles[tileReferences[i].triangle];
+        rasterizeTriangle(state, triangle, job.varyings.data() + triangle.varyingsOffset, tileBounds, stats);
+    }
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const SoftwareDrawState& state, const SetupTriangle& triangle,
+                                           const float* pVaryings, const int32_t* pTileBounds,
+                                           SoftwareRasterizerStats& stats) const
+{
+    int32_t x0 = triangle.minX > pTileBounds[0] ? triangle.minX : pTileBounds[0];
+    int32_t y0 = triangle.minY > pTileBounds[1] ? triangle.minY : pTileBounds[1];
+    int32_t x1 = triangle.maxX < pTileBounds[2] ? triangle.maxX : pTileBounds[2];
+    int32_t y1 = triangle.maxY < pTileBounds[3] ? triangle.maxY : pTileBounds[3];
+    if (x0 >= x1 || y0 >= y1)
+    {
+        return;
+    }
+
+    const uint32_t varyingsAmount = state.varyingsAmount;
+    const float* varyings[3] = {pVaryings, pVaryings + varyingsAmount, pVaryings + 2 * varyingsAmount};
+    const bool depthTest = depthTarget && state.depth.depthEnable;
+    const bool depthWrite = depthTest && state.depth.depthWrite;
+    const float depthLow = viewport.minDepth < viewport.maxDepth ? viewport.minDepth : viewport.maxDepth;
+    const float depthHigh = viewport.minDepth < viewport.maxDepth ? viewport.maxDepth : viewport.minDepth;
+    const uint32_t targetWidth = colorTarget ? colorTarget->getWidth() : 0;
+    const uint32_t depthWidth = depthTarget ? depthTarget->getWidth() : 0;
+    float* colorTexels = colorTarget ? colorTarget->getTexels() : nullptr;
+    float* depthTexels = depthTarget ? depthTarget->getTexels() : nullptr;
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 laneOffsets = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 inverseArea = _mm_set1_ps((float)triangle.inverseArea);
+    __m128 steps[3];
+    __m128 topLeft[3];
+    for (uint32_t e = 0; e < 3; e++)
+    {
+        steps[e] = _mm_set1_ps((float)(triangle.edgeA[e] * 4));
+        topLeft[e] = _mm_castsi128_ps(_mm_set1_epi32((int32_t)triangle.topLeft[e]));
+    }
+    const __m128 z0 = _mm_set1_ps(triangle.z[0]);
+    const __m128 z1 = _mm_set1_ps(triangle.z[1]);
+    const __m128 z2 = _mm_set1_ps(triangle.z[2]);
+
+    alignas(16) float barycentrics[3][4];
+    alignas(16) float depths[4];
+    float interpolated[SOFTWARE_MAX_VARYINGS];
+    float color[4];
+    for (int32_t y = y0; y < y1; y++)
+    {
+        // Row starts in double, the absolute values get large for triangles reaching into the guard band
+        __m128 edges[3];
+        for (uint32_t e = 0; e < 3; e++)
+        {
+            double rowStart = triangle.edgeA[e] * (x0 + 0.5) + triangle.edgeB[e] * (y + 0.5) + triangle.edgeC[e];
+            edges[e] = _mm_add_ps(_mm_set1_ps((float)rowStart),
+                                  _mm_mul_ps(laneOffsets, _mm_set1_ps((float)triangle.edgeA[e])));
+        }
+        for (int32_t x = x0; x < x1; x += 4)
+        {
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                __m128 covered = _mm_or_ps(_mm_cmpgt_ps(edges[e], zero),
+                                           _mm_and_ps(_mm_cmpeq_ps(edges[e], zero), topLeft[e]));
+                inside = _mm_and_ps(inside, covered);
+            }
+            int32_t remaining = x1 - x;
+            uint32_t mask = (uint32_t)_mm_movemask_ps(inside) & (remaining >= 4 ? 0xFu : (1u << remaining) - 1);
+            if (mask)
+            {
+                __m128 b0 = _mm_mul_ps(edges[0], inverseArea);
+                __m128 b1 = _mm_mul_ps(edges[1], inverseArea);
+                __m128 b2 = _mm_mul_ps(edges[2], inverseArea);
+                _mm_store_ps(barycentrics[0], b0);
+                _mm_store_ps(barycentrics[1], b1);
+                _mm_store_ps(barycentrics[2], b2);
+                _mm_store_ps(depths, _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, z0), _mm_mul_ps(b1, z1)),
+                                                _mm_mul_ps(b2, z2)));
+                for (uint32_t lane = 0; lane < 4; lane++)
+                {
+                    if (!(mask & (1u << lane)))
+                    {
+                        continue;
+                    }
+                    int32_t pixelX = x + (int32_t)lane;
+                    float depth = clampValue(depths[lane], depthLow, depthHigh);
+                    float* storedDepth = depthTexels ? depthTexels + (size_t)y * depthWidth + pixelX : nullptr;
+                    if (depthTest && !passesDepth(state.depth.depthFunc, depth, *storedDepth))
+                    {
+                        continue;
+                    }
+                    if (state.pixelShader)
+                    {
+                        float w0 = barycentrics[0][lane];
+                        float w1 = barycentrics[1][lane];
+                        float w2 = barycentrics[2][lane];
+                        float clipW = 1.0f / (w0 * triangle.inverseW[0] + w1 * triangle.inverseW[1] +
+                            w2 * triangle.inverseW[2]);
+                        for (uint32_t i = 0; i < varyingsAmount; i++)
+                        {
+                            interpolated[i] = (w0 * varyings[0][i] + w1 * varyings[1][i] + w2 * varyings[2][i]) *
+                                clipW;
+                        }
+                        float position[4] = {pixelX + 0.5f, y + 0.5f, depth, clipW};
+                        state.pixelShader->shade(*state.bindings, position, interpolated, color);
+                        if (colorTexels)
+                        {
+                            float* texel = colorTexels + ((size_t)y * targetWidth + pixelX) * 4;
+                            texel[0] = color[0];
+                            texel[1] = color[1];
+                            texel[2] = color[2];
+                            texel[3] = color[3];
+                        }
+                        stats.shadedPixels++;
+                    }
+                    if (depthWrite)
+                    {
+                        *storedDepth = depth;
+                    }
+                }
+            }
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                edges[e] = _mm_add_ps(edges[e], steps[e]);
+            }
+        }
+    }
+}
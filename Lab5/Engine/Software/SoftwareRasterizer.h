@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../../Utils/JobSystem.h"
+#include "SoftwareShader.h"
+#include "TileScheduler.h"
+
+#define SOFTWARE_TILE_SIZE 64
+#define SOFTWARE_TRIANGLES_PER_JOB 2048u
+// Clip space x and y are kept within this many viewports, so screen coordinates stay small enough for floats
+#define SOFTWARE_GUARD_BAND 8.0f
+
+enum SoftwareCullMode
+{
+    SOFTWARE_CULL_NONE,
+    SOFTWARE_CULL_FRONT,
+    SOFTWARE_CULL_BACK
+};
+
+enum SoftwareDepthFunc
+{
+    SOFTWARE_DEPTH_LESS,
+    SOFTWARE_DEPTH_LESS_EQUAL,
+    SOFTWARE_DEPTH_ALWAYS
+};
+
+/*
+ * Defaults are the D3D11 defaults a nullptr state stands for
+ */
+struct SoftwareDepthState
+{
+    bool depthEnable = true;
+    bool depthWrite = true;
+    SoftwareDepthFunc depthFunc = SOFTWARE_DEPTH_LESS;
+};
+
+struct SoftwareRasterState
+{
+    SoftwareCullMode cullMode = SOFTWARE_CULL_BACK;
+    bool frontCounterClockwise = false;
+};
+
+struct SoftwareDrawState
+{
+    SoftwareDepthState depth;
+    SoftwareRasterState raster;
+    const SoftwarePixelShader* pixelShader = nullptr;
+    const SoftwareBindings* bindings = nullptr;
+    uint32_t varyingsAmount = 0;
+};
+
+struct SoftwareRasterizerStats
+{
+    uint64_t submittedTriangles = 0;
+    uint64_t culledTriangles = 0;
+    // Triangles that crossed a clip plane and were split
+    uint64_t clippedTriangles = 0;
+    // Triangle references over all tile bins
+    uint64_t binnedTriangles = 0;
+    uint64_t shadedPixels = 0;
+    uint32_t stolenTiles = 0;
+};
+
+/*
+ * Sort-middle tile rasterizer. A draw is set up in parallel jobs, each clips its triangles against the near, far and
+ * guard band planes, culls them and bins them into SOFTWARE_TILE_SIZE tiles. Bins are merged in job order, so every
+ * tile sees the triangles in submission order. Tiles are then rasterized in parallel through a TileScheduler, edge
+ * functions of 4 pixels at a time with SSE2, depth tested and shaded with the pixel shader of the draw. Coverage
+ * follows the D3D11 top-left rule, depth is interpolated linearly in screen space and the varyings perspective
+ * correct. Blending is not supported, the pixel shader output replaces the target.
+ */
+class SoftwareRasterizer
+{
+public:
+    explicit SoftwareRasterizer(JobSystem& jobSystem);
+
+private:
+    struct SetupTriangle
+    {
+        double edgeA[3];
+        double edgeB[3];
+        double edgeC[3];
+        double inverseArea;
+        float z[3];
+        float inverseW[3];
+        // Edges where pixels centered exactly on them are covered
+        uint32_t topLeft[3];
+        int32_t minX;
+        int32_t minY;
+        int32_t maxX;
+        int32_t maxY;
+        uint32_t varyingsOffset;
+    };
+
+    struct BinEntry
+    {
+        uint32_t tile;
+        uint32_t triangle;
+    };
+
+    struct SetupJob
+    {
+        std::vector<SetupTriangle> triangles;
+        // varyingsAmount values per vertex, divided by clip space w
+        std::vector<float> varyings;
+        std::vector<BinEntry> bins;
+        SoftwareRasterizerStats stats;
+    };
+
+    struct TileReference
+    {
+        uint32_t job;
+        uint32_t triangle;
+    };
+
+    JobSystem& jobSystem;
+    TileScheduler scheduler;
+    SoftwareTexture* colorTarget = nullptr;
+    SoftwareTexture* depthTarget = nullptr;
+    StateViewport viewport{};
+    // Pixels the viewport and the targets share, maximum exclusive
+    int32_t scissor[4] = {};
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    std::vector<SetupJob> jobs;
+    uint32_t jobsAmount = 0;
+    // Bin of tile t is tileReferences[tileOffsets[t], tileOffsets[t + 1])
+    std::vector<uint32_t> tileOffsets;
+    std::vector<uint32_t> tileCursors;
+    std::vector<TileReference> tileReferences;
+    std::vector<SoftwareRasterizerStats> workerStats;
+    SoftwareRasterizerStats frameStats;
+    SoftwareRasterizerStats lastFrameStats;
+
+public:
+    /*
+     * Either target may be nullptr, the viewport is clamped to the targets
+     */
+    void setTargets(SoftwareTexture* colorTarget, SoftwareTexture* depthTarget, const StateViewport& viewport);
+    /*
+     * Every 3 indices form a triangle of pVertices, instance i reads the verticesPerInstance vertices starting at
+     * i * verticesPerInstance. Returns after every pixel of the draw was written.
+     */
+    void drawIndexed(const SoftwareDrawState& state, const SoftwareVertex* pVertices, uint32_t verticesPerInstance,
+                     const uint32_t* pIndices, uint32_t indicesAmount, uint32_t instancesAmount);
+    uint32_t getThreadsAmount() const;
+
+    void beginFrame();
+    const SoftwareRasterizerStats& getLastFrameStats() const;
+
+private:
+    void setupJob(const SoftwareDrawState& state, const SoftwareVertex* pVertices, uint32_t verticesPerInstance,
+                  const uint32_t* pIndices, uint32_t indicesAmount, uint32_t firstTriangle, uint32_t lastTriangle,
+                  SetupJob& job) const;
+    void setupTriangle(const SoftwareDrawState& state, const SoftwareVertex* pVertices[3], SetupJob& job) const;
+    void binTriangles();
+    void rasterizeTile(const SoftwareDrawState& state, uint32_t tile, SoftwareRasterizerStats& stats) const;
+    void rasterizeTriangle(const SoftwareDrawState& state, const SetupTriangle& triangle, const float* pVaryings,
+                           const int32_t* pTileBounds, SoftwareRasterizerStats& stats) const;
+};
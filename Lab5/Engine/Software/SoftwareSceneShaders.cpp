@@ -0,0 +1,405 @@
+#include "SoftwareSceneShaders.h"
+
+#include <cmath>
+
+// Varyings of the scene vertex shader, VS_OUTPUT of Shaders/Lighting/VertexShader.hlsl without SV_POSITION
+#define SCENE_VARYING_WORLD_POSITION 0
+#define SCENE_VARYING_NORMAL 4
+#define SCENE_VARYING_UV 7
+#define SCENE_VARYING_COLOR 9
+#define SCENE_VARYING_MATERIAL 12
+#define SCENE_VARYINGS_AMOUNT 14
+
+#define SKYBOX_VARYING_NORMAL 0
+#define SKYBOX_VARYING_UV 3
+#define SKYBOX_VARYINGS_AMOUNT 6
+
+#define MAPPING_VARYINGS_AMOUNT 2
+
+namespace
+{
+    /*
+     * HLSL side layouts, matrices are read like the column major cbuffers so mul(matrix, vector) is the row vector
+     * times the matrix the CPU wrote
+     */
+    struct TransformData
+    {
+        float worldMatrix[16];
+        float cameraMatrix[16];
+    };
+
+    struct SkyboxTransformData
+    {
+        float worldMatrix[16];
+        float cameraMatrix[16];
+        float size[4];
+        float cameraPosition[3];
+    };
+
+    struct InstanceRecord
+    {
+        float worldMatrix[16];
+        float albedo[3];
+        float metallic;
+        float roughness;
+        float padding[3];
+    };
+
+    struct PointLight
+    {
+        float position[3];
+        float intensity;
+        float radius;
+        float padding[3];
+    };
+
+    struct LightData
+    {
+        float cameraPosition[3];
+        uint32_t lightsAmount;
+        float clusterScale[4];
+        uint32_t clusterDimensions[4];
+    };
+
+    struct Configuration
+    {
+        float ambientIntensity;
+        float alignment[3];
+    };
+
+    struct ClusterRange
+    {
+        uint32_t offset;
+        uint32_t amount;
+    };
+
+    void transform(const float* vector, const float* matrix, float* pOutput)
+    {
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            pOutput[column] = vector[0] * matrix[column] + vector[1] * matrix[4 + column] +
+                vector[2] * matrix[8 + column] + vector[3] * matrix[12 + column];
+        }
+    }
+
+    float distributeGGX(const Float3& normals, const Float3& halfWayVector, float roughness)
+    {
+        float a = roughness * roughness;
+        float NdotH = fmaxf(dot(normals, halfWayVector), 0.0f);
+        float NdotH2 = NdotH * NdotH;
+
+        float nom = a;
+        float denom = (NdotH2 * (nom - 1.0f) + 1.0f);
+        denom = SOFTWARE_PI * denom * denom;
+
+        return nom / denom;
+    }
+
+    float schlickGeometryGGX(float dotWorldViewVector, float roughness)
+    {
+        float roughnessKoef = ((roughness + 1.0f) * (roughness + 1.0f)) / 8.0f;
+        float numerator = dotWorldViewVector;
+        float denominator = dotWorldViewVector * (1.0f - roughnessKoef) + roughnessKoef;
+        return numerator / denominator;
+    }
+
+    float smithGeometry(const Float3& processedNormals, const Float3& worldViewVector, const Float3& lightPosition,
+                        float roughness)
+    {
+        float worldViewVectorDot = fmaxf(dot(processedNormals, worldViewVector), 0.0f);
+        float lightDot = fmaxf(dot(processedNormals, lightPosition), 0.0f);
+        float ggx2 = schlickGeometryGGX(worldViewVectorDot, roughness);
+        float ggx1 = schlickGeometryGGX(lightDot, roughness);
+        return ggx1 * ggx2;
+    }
+
+    Float3 fresnelFunctionMetal(const Float3& objColor, const Float3& startFresnelSchlick, const Float3& h,
+                                const Float3& worldViewVector, float metallic)
+    {
+        Float3 f = startFresnelSchlick * (1 - metallic) + objColor * metallic;
+        return f + (Float3(1.0f, 1.0f, 1.0f) - f) * powf(1.0f - fmaxf(dot(h, worldViewVector), 0.0f), 5);
+    }
+
+    Float3 fresnelSchlickRoughness(float cosTheta, const Float3& F0, float roughness)
+    {
+        Float3 smooth(fmaxf(1.0f - roughness, F0.x), fmaxf(1.0f - roughness, F0.y), fmaxf(1.0f - roughness, F0.z));
+        return F0 + (smooth - F0) * powf(1.0f - cosTheta, 5.0f);
+    }
+
+    Float3 processPointLight(const PointLight& light, const Float3& normals, const Float3& fragmentPosition,
+                             const Float3& worldViewVector, const Float3& startFresnelSchlick, float roughness,
+                             float metallic, const Float3& albedo, uint32_t mode)
+    {
+        Float3 lightPosition(light.position);
+        Float3 processedLightPos = normalize(lightPosition - fragmentPosition);
+        Float3 halfWay = normalize((worldViewVector + processedLightPos) / 2.0f);
+
+        if (mode == SOFTWARE_PBR_MODE_NORMAL_DISTRIBUTION)
+        {
+            float halfWayGGX = distributeGGX(normals, halfWay, roughness);
+            return {halfWayGGX, halfWayGGX, halfWayGGX};
+        }
+        if (mode == SOFTWARE_PBR_MODE_GEOMETRY_FUNCTION)
+        {
+            float geometrySmith = smithGeometry(normals, worldViewVector, processedLightPos, roughness);
+            return {geometrySmith, geometrySmith, geometrySmith};
+        }
+        Float3 fresnelSchlick = fresnelFunctionMetal(albedo, startFresnelSchlick, halfWay, worldViewVector, metallic);
+        float denominator = 4.0f * fmaxf(dot(normals, worldViewVector), 0.0f) *
+            fmaxf(dot(normals, processedLightPos), 0.0f) + 0.0001f;
+        if (mode == SOFTWARE_PBR_MODE_FRESNEL_FUNCTION)
+        {
+            return fresnelSchlick / denominator;
+        }
+        float distance = length(lightPosition - fragmentPosition);
+        float falloff = saturate(1.0f - powf(distance / light.radius, 4));
+        float attenuation = falloff * falloff / fmaxf(distance * distance, 1.0f);
+        Float3 radiance = Float3(1, 1, 1) * light.intensity * attenuation;
+
+        float halfWayGGX = distributeGGX(normals, halfWay, roughness);
+        float geometrySmith = smithGeometry(normals, worldViewVector, processedLightPos, roughness);
+        Float3 specular = fresnelSchlick * (halfWayGGX * geometrySmith / denominator);
+
+        Float3 finalFresnelSchlick = Float3(1, 1, 1) - fresnelSchlick;
+        finalFresnelSchlick = finalFresnelSchlick * (1.0f - metallic + 0.001f);
+
+        float NdotL = fmaxf(dot(normals, processedLightPos), 0.0f);
+        return (finalFresnelSchlick * albedo / SOFTWARE_PI + specular) * radiance * NdotL;
+    }
+
+    Float3 prefilteredReflection(const SoftwareBindings& bindings, const Float3& R, float roughness)
+    {
+        const float maxReflectionLod = 9.0f;
+        float lod = roughness * maxReflectionLod;
+        float lodf = floorf(lod);
+        float lodc = ceilf(lod);
+        float a[4];
+        float b[4];
+        bindings.sampleCube(STATE_TRACKER_PIXEL_STAGE, 1, 1, R, lodf, a);
+        bindings.sampleCube(STATE_TRACKER_PIXEL_STAGE, 1, 1, R, lodc, b);
+        return lerp(Float3(a), Float3(b), lod - lodf);
+    }
+
+    ClusterRange findClusterRange(const SoftwareBindings& bindings, const LightData& lightData,
+                                  const float* pScreenPosition)
+    {
+        float slice = logf(pScreenPosition[3]) * lightData.clusterScale[2] - lightData.clusterScale[3];
+        float coordinates[3] = {
+            pScreenPosition[0] * lightData.clusterScale[0], pScreenPosition[1] * lightData.clusterScale[1],
+            fmaxf(slice, 0.0f)
+        };
+        uint32_t cluster[3];
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            cluster[i] = coordinates[i] > 0 ? (uint32_t)coordinates[i] : 0;
+            uint32_t last = lightData.clusterDimensions[i] - 1;
+            cluster[i] = cluster[i] < last ? cluster[i] : last;
+        }
+        return bindings.getElement<ClusterRange>(STATE_TRACKER_PIXEL_STAGE, 4, cluster[0] +
+                                                 cluster[1] * lightData.clusterDimensions[0] + cluster[2] *
+                                                 lightData.clusterDimensions[0] * lightData.clusterDimensions[1]);
+    }
+}
+
+uint32_t SoftwareSceneVertexShader::getVaryingsAmount() const
+{
+    return SCENE_VARYINGS_AMOUNT;
+}
+
+void SoftwareSceneVertexShader::shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId,
+                                      uint32_t instanceId, SoftwareVertex& output) const
+{
+    InstanceRecord instance = bindings.getElement<InstanceRecord>(STATE_TRACKER_VERTEX_STAGE, 0, instanceId);
+    const TransformData& transformData = bindings.getConstants<TransformData>(STATE_TRACKER_VERTEX_STAGE, 0);
+    float* varyings = output.varyings;
+
+    float position[4] = {pInput[0], pInput[1], pInput[2], 1.0f};
+    float instancePosition[4];
+    transform(position, instance.worldMatrix, instancePosition);
+    float* worldPos = varyings + SCENE_VARYING_WORLD_POSITION;
+    transform(instancePosition, transformData.worldMatrix, worldPos);
+    transform(worldPos, transformData.cameraMatrix, output.position);
+
+    varyings[SCENE_VARYING_UV] = pInput[3];
+    varyings[SCENE_VARYING_UV + 1] = pInput[4];
+    float normal[4] = {pInput[5], pInput[6], pInput[7], 0.0f};
+    float instanceNormal[4];
+    float worldNormal[4];
+    transform(normal, instance.worldMatrix, instanceNormal);
+    transform(instanceNormal, transformData.worldMatrix, worldNormal);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        varyings[SCENE_VARYING_NORMAL + i] = worldNormal[i];
+        varyings[SCENE_VARYING_COLOR + i] = instance.albedo[i];
+    }
+    varyings[SCENE_VARYING_MATERIAL] = instance.metallic;
+    varyings[SCENE_VARYING_MATERIAL + 1] = instance.roughness;
+}
+
+SoftwarePBRPixelShader::SoftwarePBRPixelShader(uint32_t mode) : mode(mode)
+{
+}
+
+void SoftwarePBRPixelShader::shade(const SoftwareBindings& bindings, const float* pPosition, const float* pVaryings,
+                                   float* pColor) const
+{
+    const LightData& lightData = bindings.getConstants<LightData>(STATE_TRACKER_PIXEL_STAGE, 0);
+    const Configuration& configuration = bindings.getConstants<Configuration>(STATE_TRACKER_PIXEL_STAGE, 1);
+    Float3 worldPos(pVaryings + SCENE_VARYING_WORLD_POSITION);
+    Float3 color(pVaryings + SCENE_VARYING_COLOR);
+
+    Float3 normal = normalize(Float3(pVaryings + SCENE_VARYING_NORMAL));
+    Float3 worldViewVector = normalize(Float3(lightData.cameraPosition) - worldPos);
+
+    float surfaceMetallic = pVaryings[SCENE_VARYING_MATERIAL];
+    float surfaceRoughness = pVaryings[SCENE_VARYING_MATERIAL + 1];
+    Float3 startFresnelSchlick(0.04f, 0.04f, 0.04f);
+    startFresnelSchlick = lerp(startFresnelSchlick, color, surfaceMetallic);
+
+    Float3 Lo;
+    ClusterRange clusterRange = findClusterRange(bindings, lightData, pPosition);
+    for (uint32_t i = 0; i < clusterRange.amount; i++)
+    {
+        uint32_t lightIndex = bindings.getElement<uint32_t>(STATE_TRACKER_PIXEL_STAGE, 5, clusterRange.offset + i);
+        PointLight light = bindings.getElement<PointLight>(STATE_TRACKER_PIXEL_STAGE, 3, lightIndex);
+        Lo += processPointLight(light, normal, worldPos, worldViewVector, startFresnelSchlick, surfaceRoughness,
+                                surfaceMetallic, color, mode);
+    }
+    Float3 R = reflect(-worldViewVector, normal);
+    float brdf[4];
+    bindings.sample(STATE_TRACKER_PIXEL_STAGE, 2, 1, fmaxf(dot(normal, worldViewVector), 0.0f), surfaceRoughness,
+                    0, brdf);
+    Float3 reflection = prefilteredReflection(bindings, R, surfaceRoughness);
+    float irradianceSample[4];
+    bindings.sampleCube(STATE_TRACKER_PIXEL_STAGE, 0, 1, normal, 0, irradianceSample);
+    Float3 irradiance(irradianceSample);
+
+    Float3 diffuse = irradiance * color;
+
+    Float3 F = fresnelSchlickRoughness(fmaxf(dot(normal, worldViewVector), 0.0f), startFresnelSchlick,
+                                       surfaceRoughness);
+
+    Float3 specular = reflection * (F * brdf[0] + Float3(brdf[1], brdf[1], brdf[1]));
+
+    // Ambient part
+    Float3 kD = Float3(1, 1, 1) - F;
+    kD = kD * (1.0f - surfaceMetallic);
+    Float3 ambient = kD * diffuse + specular;
+    Float3 rescolor = ambient * configuration.ambientIntensity + Lo;
+
+    pColor[0] = rescolor.x;
+    pColor[1] = rescolor.y;
+    pColor[2] = rescolor.z;
+    pColor[3] = 1.0f;
+}
+
+uint32_t SoftwareSkyboxVertexShader::getVaryingsAmount() const
+{
+    return SKYBOX_VARYINGS_AMOUNT;
+}
+
+void SoftwareSkyboxVertexShader::shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId,
+                                       uint32_t instanceId, SoftwareVertex& output) const
+{
+    const SkyboxTransformData& transformData = bindings.getConstants<SkyboxTransformData>(
+        STATE_TRACKER_VERTEX_STAGE, 0);
+    float position[4];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        position[i] = transformData.cameraPosition[i] + pInput[i] * transformData.size[0];
+        output.varyings[SKYBOX_VARYING_UV + i] = pInput[i];
+        output.varyings[SKYBOX_VARYING_NORMAL + i] = pInput[5 + i];
+    }
+    position[3] = 1.0f;
+    float worldPosition[4];
+    transform(position, transformData.worldMatrix, worldPosition);
+    transform(worldPosition, transformData.cameraMatrix, output.position);
+    output.position[2] = 0.0f;
+}
+
+void SoftwareSkyboxPixelShader::shade(const SoftwareBindings& bindings, const float* pPosition,
+                                      const float* pVaryings, float* pColor) const
+{
+    float sample[4];
+    bindings.sampleCube(STATE_TRACKER_PIXEL_STAGE, 0, 0, Float3(pVaryings + SKYBOX_VARYING_UV), 0, sample);
+    pColor[0] = sample[0] * 10;
+    pColor[1] = sample[1] * 10;
+    pColor[2] = sample[2] * 10;
+    pColor[3] = 10;
+}
+
+uint32_t SoftwareMappingVertexShader::getVaryingsAmount() const
+{
+    return MAPPING_VARYINGS_AMOUNT;
+}
+
+void SoftwareMappingVertexShader::shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId,
+                                        uint32_t instanceId, SoftwareVertex& output) const
+{
+    static const float corners[6][2] = {{1, 1}, {1, -1}, {-1, -1}, {-1, 1}, {1, 1}, {-1, -1}};
+    float x = vertexId < 6 ? corners[vertexId][0] : 0;
+    float y = vertexId < 6 ? corners[vertexId][1] : 0;
+    output.position[0] = x;
+    output.position[1] = y;
+    output.position[2] = 0;
+    output.position[3] = vertexId < 6 ? 1.0f : 0.0f;
+    output.varyings[0] = x * 0.5f + 0.5f;
+    output.varyings[1] = 0.5f - y * 0.5f;
+}
+
+void SoftwareToneMapPixelShader::shade(const SoftwareBindings& bindings, const float* pPosition,
+                                       const float* pVaryings, float* pColor) const
+{
+    const float A = 0.1f;
+    const float B = 0.50f;
+    const float C = 0.1f;
+    const float D = 0.20f;
+    const float E = 0.02f;
+    const float F = 0.30f;
+    const float W = 11.2f;
+    auto uncharted2Tonemap = [&](float x)
+    {
+        return ((x * (A * x + C * B) + D * E) / (x * (A * x + B) + D * F)) - E / F;
+    };
+
+    const SoftwareToneMapConstants& constants = bindings.getConstants<SoftwareToneMapConstants>(
+        STATE_TRACKER_PIXEL_STAGE, 0);
+    float color[4];
+    float minimum[4];
+    float maximum[4];
+    bindings.sample(STATE_TRACKER_PIXEL_STAGE, 0, 0, pVaryings[0], pVaryings[1], 0, color);
+    bindings.sample(STATE_TRACKER_PIXEL_STAGE, 2, 0, 0.5f, 0.5f, 0, minimum);
+    bindings.sample(STATE_TRACKER_PIXEL_STAGE, 3, 0, 0.5f, 0.5f, 0, maximum);
+
+    float avg = expf(constants.adapt[0]) - 1.0f;
+    float keyValue = 1.03f - 2.0f / (2.0f + logf(avg + 1.0f));
+    float exposure = keyValue / clampValue(avg, minimum[0], maximum[0]);
+    float whiteScale = 1.0f / uncharted2Tonemap(W);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        pColor[i] = uncharted2Tonemap(exposure * color[i]) * whiteScale;
+    }
+    pColor[3] = 1.0f;
+}
+
+void SoftwareToneMapPixelShader::measureBrightness(const SoftwareTexture& frame, float& averageLogOutput,
+                                                   float& minimumOutput, float& maximumOutput)
+{
+    const float* texels = frame.getTexels();
+    uint64_t pixelsAmount = (uint64_t)frame.getWidth() * frame.getHeight();
+    uint32_t channels = frame.getChannelsAmount();
+    double logSum = 0;
+    float minimum = INFINITY;
+    float maximum = 0;
+    for (uint64_t i = 0; i < pixelsAmount; i++)
+    {
+        const float* texel = texels + i * channels;
+        float brightness = channels == 4 ? texel[0] * 0.2126f + texel[1] * 0.7151f + texel[2] * 0.0722f : texel[0];
+        logSum += logf(brightness + 1.0f);
+        minimum = brightness < minimum ? brightness : minimum;
+        maximum = brightness > maximum ? brightness : maximum;
+    }
+    averageLogOutput = pixelsAmount > 0 ? (float)(logSum / pixelsAmount) : 0;
+    minimumOutput = pixelsAmount > 0 ? minimum : 0;
+    maximumOutput = maximum;
+}
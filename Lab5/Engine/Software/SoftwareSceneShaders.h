@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include "SoftwareShader.h"
+
+#define SOFTWARE_PBR_MODE_DEFAULT 0
+#define SOFTWARE_PBR_MODE_NORMAL_DISTRIBUTION 1
+#define SOFTWARE_PBR_MODE_GEOMETRY_FUNCTION 2
+#define SOFTWARE_PBR_MODE_FRESNEL_FUNCTION 3
+
+/*
+ * C++ ports of the shaders the scene frame and the tone mapping draw with. Each class follows its HLSL file line by
+ * line, registers and constant layouts are the same, so the SceneRenderer binds them like the compiled shaders.
+ * Sample without an explicit level reads level 0, there are no pixel quads to take derivatives from.
+ */
+
+/*
+ * Shaders/Lighting/VertexShader.hlsl
+ */
+class SoftwareSceneVertexShader : public SoftwareVertexShader
+{
+public:
+    uint32_t getVaryingsAmount() const override;
+    void shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId, uint32_t instanceId,
+               SoftwareVertex& output) const override;
+};
+
+/*
+ * Shaders/Lighting/PBRPixelShader.hlsl, mode is one of the PBR_MODE permutations
+ */
+class SoftwarePBRPixelShader : public SoftwarePixelShader
+{
+public:
+    explicit SoftwarePBRPixelShader(uint32_t mode = SOFTWARE_PBR_MODE_DEFAULT);
+
+private:
+    uint32_t mode;
+
+public:
+    void shade(const SoftwareBindings& bindings, const float* pPosition, const float* pVaryings,
+               float* pColor) const override;
+};
+
+/*
+ * Shaders/Skybox/skyboxVS.hlsl
+ */
+class SoftwareSkyboxVertexShader : public SoftwareVertexShader
+{
+public:
+    uint32_t getVaryingsAmount() const override;
+    void shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId, uint32_t instanceId,
+               SoftwareVertex& output) const override;
+};
+
+/*
+ * Shaders/Skybox/skyboxPS.hlsl
+ */
+class SoftwareSkyboxPixelShader : public SoftwarePixelShader
+{
+public:
+    void shade(const SoftwareBindings& bindings, const float* pPosition, const float* pVaryings,
+               float* pColor) const override;
+};
+
+/*
+ * Shaders/ToneMap/mappingVS.hlsl, the fullscreen pair of triangles from the vertex id
+ */
+class SoftwareMappingVertexShader : public SoftwareVertexShader
+{
+public:
+    uint32_t getVaryingsAmount() const override;
+    void shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId, uint32_t instanceId,
+               SoftwareVertex& output) const override;
+};
+
+/*
+ * cbuffer adaptBuffer of Shaders/ToneMap/tonemapPS.hlsl
+ */
+struct SoftwareToneMapConstants
+{
+    float adapt[4];
+};
+
+/*
+ * Shaders/ToneMap/tonemapPS.hlsl
+ */
+class SoftwareToneMapPixelShader : public SoftwarePixelShader
+{
+public:
+    void shade(const SoftwareBindings& bindings, const float* pPosition, const float* pVaryings,
+               float* pColor) const override;
+
+    /*
+     * Stands in for the brightness and downsample passes of the ToneMapper: the mean of log(brightness + 1) over
+     * the frame and its smallest and largest brightness
+     */
+    static void measureBrightness(const SoftwareTexture& frame, float& averageLogOutput, float& minimumOutput,
+                                  float& maximumOutput);
+};
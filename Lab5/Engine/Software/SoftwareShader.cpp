@@ -0,0 +1,83 @@
+#include "SoftwareShader.h"
+
+namespace
+{
+    alignas(16) const uint8_t zeroConstants[SOFTWARE_MAX_CONSTANT_BYTES] = {};
+
+    void writeZeros(float* pOutput)
+    {
+        pOutput[0] = pOutput[1] = pOutput[2] = pOutput[3] = 0;
+    }
+}
+
+const void* SoftwareBindings::getConstants(StateTrackerStage stage, uint32_t slot, uint32_t size) const
+{
+    if (slot >= STATE_TRACKER_CONSTANT_BUFFER_SLOTS)
+    {
+        return zeroConstants;
+    }
+    const StateConstantBuffer& binding = stages[stage].constantBuffers[slot];
+    const SoftwareBuffer* buffer = (const SoftwareBuffer*)binding.buffer;
+    uint64_t offset = (uint64_t)binding.firstConstant * 16;
+    if (!buffer || buffer->released || offset >= buffer->data.size())
+    {
+        return zeroConstants;
+    }
+    uint64_t windowSize = buffer->data.size() - offset;
+    if (binding.constantsAmount > 0 && (uint64_t)binding.constantsAmount * 16 < windowSize)
+    {
+        windowSize = (uint64_t)binding.constantsAmount * 16;
+    }
+    return windowSize < size ? zeroConstants : buffer->data.data() + offset;
+}
+
+const void* SoftwareBindings::getElement(StateTrackerStage stage, uint32_t slot, uint32_t index,
+                                         uint32_t size) const
+{
+    const SoftwareView* view = slot < STATE_TRACKER_SHADER_RESOURCE_SLOTS ? stages[stage].shaderResources[slot]
+                                                                          : nullptr;
+    if (!view || !view->buffer || view->buffer->released)
+    {
+        return nullptr;
+    }
+    uint64_t offset = (uint64_t)index * size;
+    if (offset + size > view->buffer->data.size())
+    {
+        return nullptr;
+    }
+    return view->buffer->data.data() + offset;
+}
+
+void SoftwareBindings::sample(StateTrackerStage stage, uint32_t textureSlot, uint32_t samplerSlot, float u, float v,
+                              float lod, float* pOutput) const
+{
+    const SoftwareStageBindings& bindings = stages[stage];
+    const SoftwareView* view = textureSlot < STATE_TRACKER_SHADER_RESOURCE_SLOTS
+                                   ? bindings.shaderResources[textureSlot]
+                                   : nullptr;
+    if (!view || !view->texture)
+    {
+        writeZeros(pOutput);
+        return;
+    }
+    const SoftwareSampler* sampler = samplerSlot < STATE_TRACKER_SAMPLER_SLOTS ? bindings.samplers[samplerSlot]
+                                                                               : nullptr;
+    view->texture->sample(sampler, u, v, lod, pOutput);
+}
+
+void SoftwareBindings::sampleCube(StateTrackerStage stage, uint32_t textureSlot, uint32_t samplerSlot,
+                                  const Float3& direction, float lod, float* pOutput) const
+{
+    const SoftwareStageBindings& bindings = stages[stage];
+    const SoftwareView* view = textureSlot < STATE_TRACKER_SHADER_RESOURCE_SLOTS
+                                   ? bindings.shaderResources[textureSlot]
+                                   : nullptr;
+    if (!view || !view->texture || view->texture->getFacesAmount() != SOFTWARE_CUBE_FACES)
+    {
+        writeZeros(pOutput);
+        return;
+    }
+    const SoftwareSampler* sampler = samplerSlot < STATE_TRACKER_SAMPLER_SLOTS ? bindings.samplers[samplerSlot]
+                                                                               : nullptr;
+    view->texture->sampleCube(sampler, direction, lod, pOutput);
+}
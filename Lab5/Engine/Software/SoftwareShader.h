@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../../DXDevice/StateTracker.h"
+#include "../Device/GraphicsDevice.h"
+#include "SoftwareTexture.h"
+
+#define SOFTWARE_MAX_VARYINGS 16u
+// Largest constant buffer window a shader reads, unbound and short windows read zeros like on the GPU
+#define SOFTWARE_MAX_CONSTANT_BYTES 4096u
+
+/*
+ * Buffer of the SoftwareGraphicsDevice, its handle is the address of this object
+ */
+struct SoftwareBuffer
+{
+    GraphicsBufferDesc desc;
+    std::vector<uint8_t> data;
+    bool released = false;
+};
+
+/*
+ * Shader resource, render target and depth views are all this, a texture or a structured buffer
+ */
+struct SoftwareView
+{
+    SoftwareTexture* texture = nullptr;
+    const SoftwareBuffer* buffer = nullptr;
+};
+
+/*
+ * Shaded vertex, clip space position and the outputs the pixel shader reads
+ */
+struct SoftwareVertex
+{
+    float position[4];
+    float varyings[SOFTWARE_MAX_VARYINGS];
+};
+
+struct SoftwareStageBindings
+{
+    StateConstantBuffer constantBuffers[STATE_TRACKER_CONSTANT_BUFFER_SLOTS] = {};
+    const SoftwareView* shaderResources[STATE_TRACKER_SHADER_RESOURCE_SLOTS] = {};
+    const SoftwareSampler* samplers[STATE_TRACKER_SAMPLER_SLOTS] = {};
+};
+
+/*
+ * What the shaders of one draw read, the bindings of the context as they were set. Buffers are resolved on every read,
+ * which follows D3D11 rules for unbound slots, released buffers and out of range windows and elements, they return
+ * zeros.
+ */
+struct SoftwareBindings
+{
+    SoftwareStageBindings stages[STATE_TRACKER_STAGES_AMOUNT];
+
+    const void* getConstants(StateTrackerStage stage, uint32_t slot, uint32_t size) const;
+
+    template <typename T>
+    const T& getConstants(StateTrackerStage stage, uint32_t slot) const
+    {
+        static_assert(sizeof(T) <= SOFTWARE_MAX_CONSTANT_BYTES, "Constant buffer is larger than the zero block");
+        return *(const T*)getConstants(stage, slot, sizeof(T));
+    }
+
+    /*
+     * Element of a structured buffer view, nullptr when it is out of range or the slot holds no buffer
+     */
+    const void* getElement(StateTrackerStage stage, uint32_t slot, uint32_t index, uint32_t size) const;
+
+    template <typename T>
+    T getElement(StateTrackerStage stage, uint32_t slot, uint32_t index) const
+    {
+        const T* element = (const T*)getElement(stage, slot, index, sizeof(T));
+        return element ? *element : T{};
+    }
+
+    /*
+     * The sampler of samplerSlot filters the texture of textureSlot, pOutput receives 4 values
+     */
+    void sample(StateTrackerStage stage, uint32_t textureSlot, uint32_t samplerSlot, float u, float v, float lod,
+                float* pOutput) const;
+    void sampleCube(StateTrackerStage stage, uint32_t textureSlot, uint32_t samplerSlot, const Float3& direction,
+                    float lod, float* pOutput) const;
+};
+
+/*
+ * C++ port of a vertex shader. Called concurrently from the rasterizer workers, implementations keep no state.
+ */
+class SoftwareVertexShader
+{
+public:
+    virtual ~SoftwareVertexShader() = default;
+
+    virtual uint32_t getVaryingsAmount() const = 0;
+    /*
+     * pInput is the vertex in the bound vertex buffer, nullptr when none is bound
+     */
+    virtual void shade(const SoftwareBindings& bindings, const float* pInput, uint32_t vertexId, uint32_t instanceId,
+                       SoftwareVertex& output) const = 0;
+};
+
+/*
+ * C++ port of a pixel shader, called concurrently like SoftwareVertexShader
+ */
+class SoftwarePixelShader
+{
+public:
+    virtual ~SoftwarePixelShader() = default;
+
+    /*
+     * pPosition is SV_Position, the pixel center, depth and clip space w. pVaryings are perspective corrected.
+     */
+    virtual void shade(const SoftwareBindings& bindings, const float* pPosition, const float* pVaryings,
+                       float* pColor) const = 0;
+};
@@ -0,0 +1,258 @@
+#include "SoftwareTexture.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    int32_t addressTexel(int32_t coordinate, int32_t size, bool wrap)
+    {
+        if (wrap)
+        {
+            coordinate %= size;
+            return coordinate < 0 ? coordinate + size : coordinate;
+        }
+        return coordinate < 0 ? 0 : (coordinate >= size ? size - 1 : coordinate);
+    }
+}
+
+SoftwareTexture::SoftwareTexture(uint32_t width, uint32_t height, uint32_t channelsAmount, uint32_t mipsAmount,
+                                 uint32_t facesAmount) : channelsAmount(channelsAmount), facesAmount(facesAmount)
+{
+    if (width == 0 || height == 0 || (channelsAmount != 1 && channelsAmount != 4) ||
+        (facesAmount != 1 && facesAmount != SOFTWARE_CUBE_FACES))
+    {
+        throw std::runtime_error("Unsupported software texture layout");
+    }
+    uint32_t fullChain = 1;
+    for (uint32_t size = width > height ? width : height; size > 1; size >>= 1)
+    {
+        fullChain++;
+    }
+    this->mipsAmount = mipsAmount == 0 || mipsAmount > fullChain ? fullChain : mipsAmount;
+
+    levels.resize(this->mipsAmount * facesAmount);
+    for (uint32_t face = 0; face < facesAmount; face++)
+    {
+        for (uint32_t mip = 0; mip < this->mipsAmount; mip++)
+        {
+            Level& level = levels[face * this->mipsAmount + mip];
+            level.width = width >> mip > 0 ? width >> mip : 1;
+            level.height = height >> mip > 0 ? height >> mip : 1;
+            level.texels.resize((size_t)level.width * level.height * channelsAmount);
+        }
+    }
+}
+
+uint32_t SoftwareTexture::getWidth(uint32_t mip) const
+{
+    return levels[mip].width;
+}
+
+uint32_t SoftwareTexture::getHeight(uint32_t mip) const
+{
+    return levels[mip].height;
+}
+
+uint32_t SoftwareTexture::getChannelsAmount() const
+{
+    return channelsAmount;
+}
+
+uint32_t SoftwareTexture::getMipsAmount() const
+{
+    return mipsAmount;
+}
+
+uint32_t SoftwareTexture::getFacesAmount() const
+{
+    return facesAmount;
+}
+
+float* SoftwareTexture::getTexels(uint32_t face, uint32_t mip)
+{
+    return levels[face * mipsAmount + mip].texels.data();
+}
+
+const float* SoftwareTexture::getTexels(uint32_t face, uint32_t mip) const
+{
+    return levels[face * mipsAmount + mip].texels.data();
+}
+
+void SoftwareTexture::clear(const float* pValue)
+{
+    for (auto& level : levels)
+    {
+        for (size_t i = 0; i < level.texels.size(); i += channelsAmount)
+        {
+            for (uint32_t c = 0; c < channelsAmount; c++)
+            {
+                level.texels[i + c] = pValue[c];
+            }
+        }
+    }
+}
+
+void SoftwareTexture::generateMips()
+{
+    for (uint32_t face = 0; face < facesAmount; face++)
+    {
+        for (uint32_t mip = 1; mip < mipsAmount; mip++)
+        {
+            const Level& source = levels[face * mipsAmount + mip - 1];
+            Level& target = levels[face * mipsAmount + mip];
+            for (uint32_t y = 0; y < target.height; y++)
+            {
+                for (uint32_t x = 0; x < target.width; x++)
+                {
+                    uint32_t x0 = x * 2 < source.width ? x * 2 : source.width - 1;
+                    uint32_t y0 = y * 2 < source.height ? y * 2 : source.height - 1;
+                    uint32_t x1 = x0 + 1 < source.width ? x0 + 1 : x0;
+                    uint32_t y1 = y0 + 1 < source.height ? y0 + 1 : y0;
+                    for (uint32_t c = 0; c < channelsAmount; c++)
+                    {
+                        float sum = source.texels[((size_t)y0 * source.width + x0) * channelsAmount + c] +
+                            source.texels[((size_t)y0 * source.width + x1) * channelsAmount + c] +
+                            source.texels[((size_t)y1 * source.width + x0) * channelsAmount + c] +
+                            source.texels[((size_t)y1 * source.width + x1) * channelsAmount + c];
+                        target.texels[((size_t)y * target.width + x) * channelsAmount + c] = sum * 0.25f;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SoftwareTexture::sample(const SoftwareSampler* pSampler, float u, float v, float lod, float* pOutput,
+                             uint32_t face) const
+{
+    float maxLod = (float)(mipsAmount - 1);
+    lod = lod < 0 ? 0 : (lod > maxLod ? maxLod : lod);
+    bool linear = !pSampler || pSampler->linear;
+    uint32_t mip = (uint32_t)(linear ? floorf(lod) : floorf(lod + 0.5f));
+    sampleLevel(pSampler, u, v, mip, face, pOutput);
+    float fraction = lod - mip;
+    if (linear && fraction > 0 && mip + 1 < mipsAmount)
+    {
+        float next[4];
+        sampleLevel(pSampler, u, v, mip + 1, face, next);
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            pOutput[c] += (next[c] - pOutput[c]) * fraction;
+        }
+    }
+}
+
+void SoftwareTexture::sampleCube(const SoftwareSampler* pSampler, const Float3& direction, float lod,
+                                 float* pOutput) const
+{
+    float absX = fabsf(direction.x);
+    float absY = fabsf(direction.y);
+    float absZ = fabsf(direction.z);
+    uint32_t face;
+    float u;
+    float v;
+    float major;
+    if (absX >= absY && absX >= absZ)
+    {
+        face = direction.x >= 0 ? 0 : 1;
+        major = absX;
+        u = direction.x >= 0 ? -direction.z : direction.z;
+        v = -direction.y;
+    }
+    else if (absY >= absZ)
+    {
+        face = direction.y >= 0 ? 2 : 3;
+        major = absY;
+        u = direction.x;
+        v = direction.y >= 0 ? direction.z : -direction.z;
+    }
+    else
+    {
+        face = direction.z >= 0 ? 4 : 5;
+        major = absZ;
+        u = direction.z >= 0 ? direction.x : -direction.x;
+        v = -direction.y;
+    }
+    if (major <= 0)
+    {
+        pOutput[0] = pOutput[1] = pOutput[2] = 0;
+        pOutput[3] = 1;
+        return;
+    }
+    // Faces do not filter across their edges, clamping hides the seams well enough for a reference image
+    SoftwareSampler faceSampler = pSampler ? *pSampler : SoftwareSampler();
+    faceSampler.wrap = false;
+    sample(&faceSampler, (u / major + 1) * 0.5f, (v / major + 1) * 0.5f, lod, pOutput,
+           face < facesAmount ? face : 0);
+}
+
+Float3 SoftwareTexture::cubeDirection(uint32_t face, uint32_t x, uint32_t y, uint32_t size)
+{
+    float s = 2.0f * (x + 0.5f) / size - 1.0f;
+    float t = 2.0f * (y + 0.5f) / size - 1.0f;
+    switch (face)
+    {
+    case 0:
+        return normalize(Float3(1, -t, -s));
+    case 1:
+        return normalize(Float3(-1, -t, s));
+    case 2:
+        return normalize(Float3(s, 1, t));
+    case 3:
+        return normalize(Float3(s, -1, -t));
+    case 4:
+        return normalize(Float3(s, -t, 1));
+    default:
+        return normalize(Float3(-s, -t, -1));
+    }
+}
+
+void SoftwareTexture::sampleLevel(const SoftwareSampler* pSampler, float u, float v, uint32_t mip, uint32_t face,
+                                  float* pOutput) const
+{
+    const Level& level = levels[face * mipsAmount + mip];
+    int32_t width = (int32_t)level.width;
+    int32_t height = (int32_t)level.height;
+    bool wrap = pSampler && pSampler->wrap;
+    const float* texels = level.texels.data();
+    float values[4] = {0, 0, 0, 1};
+
+    if (pSampler && !pSampler->linear)
+    {
+        int32_t x = addressTexel((int32_t)floorf(u * width), width, wrap);
+        int32_t y = addressTexel((int32_t)floorf(v * height), height, wrap);
+        const float* texel = texels + ((size_t)y * width + x) * channelsAmount;
+        for (uint32_t c = 0; c < channelsAmount; c++)
+        {
+            values[c] = texel[c];
+        }
+    }
+    else
+    {
+        float x = u * width - 0.5f;
+        float y = v * height - 0.5f;
+        float xFloor = floorf(x);
+        float yFloor = floorf(y);
+        float fx = x - xFloor;
+        float fy = y - yFloor;
+        int32_t x0 = addressTexel((int32_t)xFloor, width, wrap);
+        int32_t x1 = addressTexel((int32_t)xFloor + 1, width, wrap);
+        int32_t y0 = addressTexel((int32_t)yFloor, height, wrap);
+        int32_t y1 = addressTexel((int32_t)yFloor + 1, height, wrap);
+        const float* t00 = texels + ((size_t)y0 * width + x0) * channelsAmount;
+        const float* t10 = texels + ((size_t)y0 * width + x1) * channelsAmount;
+        const float* t01 = texels + ((size_t)y1 * width + x0) * channelsAmount;
+        const float* t11 = texels + ((size_t)y1 * width + x1) * channelsAmount;
+        for (uint32_t c = 0; c < channelsAmount; c++)
+        {
+            float top = t00[c] + (t10[c] - t00[c]) * fx;
+            float bottom = t01[c] + (t11[c] - t01[c]) * fx;
+            values[c] = top + (bottom - top) * fy;
+        }
+    }
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        pOutput[c] = values[c];
+    }
+}
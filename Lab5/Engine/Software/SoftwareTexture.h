@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "SoftwareMath.h"
+
+#define SOFTWARE_CUBE_FACES 6u
+
+struct SoftwareSampler
+{
+    // Bilinear inside a level and linear between levels, otherwise the nearest texel of the nearest level
+    bool linear = true;
+    // Wraps coordinates outside of [0, 1], otherwise clamps them to the edge texels
+    bool wrap = false;
+};
+
+/*
+ * Float texture of the software device, 1 channel for depth and 4 for colors. Levels are stored face by face,
+ * cubes have SOFTWARE_CUBE_FACES faces addressed like D3D11 TextureCube.
+ */
+class SoftwareTexture
+{
+public:
+    /*
+     * mipsAmount 0 makes the full chain
+     */
+    SoftwareTexture(uint32_t width, uint32_t height, uint32_t channelsAmount, uint32_t mipsAmount = 1,
+                    uint32_t facesAmount = 1);
+
+private:
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<float> texels;
+    };
+
+    uint32_t channelsAmount;
+    uint32_t mipsAmount;
+    uint32_t facesAmount;
+    std::vector<Level> levels;
+
+public:
+    uint32_t getWidth(uint32_t mip = 0) const;
+    uint32_t getHeight(uint32_t mip = 0) const;
+    uint32_t getChannelsAmount() const;
+    uint32_t getMipsAmount() const;
+    uint32_t getFacesAmount() const;
+    float* getTexels(uint32_t face = 0, uint32_t mip = 0);
+    const float* getTexels(uint32_t face = 0, uint32_t mip = 0) const;
+
+    /*
+     * Fills every level of every face, pValue holds channelsAmount values
+     */
+    void clear(const float* pValue);
+    /*
+     * Box filters level 0 of every face down the chain
+     */
+    void generateMips();
+    /*
+     * Writes 4 values, missing channels read 0 and alpha 1. pSampler nullptr samples linear and clamped.
+     */
+    void sample(const SoftwareSampler* pSampler, float u, float v, float lod, float* pOutput,
+                uint32_t face = 0) const;
+    void sampleCube(const SoftwareSampler* pSampler, const Float3& direction, float lod, float* pOutput) const;
+
+    /*
+     * Direction through the center of texel (x, y) of a cube face with size texels per side
+     */
+    static Float3 cubeDirection(uint32_t face, uint32_t x, uint32_t y, uint32_t size);
+
+private:
+    void sampleLevel(const SoftwareSampler* pSampler, float u, float v, uint32_t mip, uint32_t face,
+                     float* pOutput) const;
+};
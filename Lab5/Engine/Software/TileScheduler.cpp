@@ -0,0 +1,50 @@
+#include "TileScheduler.h"
+
+void TileScheduler::reset(uint32_t tilesAmount, uint32_t workersAmount)
+{
+    if (workersAmount == 0)
+    {
+        workersAmount = 1;
+    }
+    if (workersAmount != this->workersAmount)
+    {
+        ranges.reset(new TileRange[workersAmount]);
+        this->workersAmount = workersAmount;
+    }
+    for (uint32_t worker = 0; worker < workersAmount; worker++)
+    {
+        ranges[worker].next.store((uint32_t)((uint64_t)tilesAmount * worker / workersAmount),
+                                  std::memory_order_relaxed);
+        ranges[worker].end = (uint32_t)((uint64_t)tilesAmount * (worker + 1) / workersAmount);
+    }
+    stolenTiles.store(0, std::memory_order_relaxed);
+}
+
+bool TileScheduler::next(uint32_t worker, uint32_t& tileOutput)
+{
+    for (uint32_t i = 0; i < workersAmount; i++)
+    {
+        TileRange& range = ranges[(worker + i) % workersAmount];
+        // Cheap check first, a drained range is not incremented any further
+        if (range.next.load(std::memory_order_relaxed) >= range.end)
+        {
+            continue;
+        }
+        uint32_t tile = range.next.fetch_add(1, std::memory_order_relaxed);
+        if (tile < range.end)
+        {
+            if (i > 0)
+            {
+                stolenTiles.fetch_add(1, std::memory_order_relaxed);
+            }
+            tileOutput = tile;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t TileScheduler::getStolenTilesAmount() const
+{
+    return stolenTiles.load(std::memory_order_relaxed);
+}
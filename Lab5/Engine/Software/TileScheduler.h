@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/*
+ * Hands out the tiles of one raster pass to a fixed set of workers. Every worker starts on its own contiguous range
+ * of tiles, so neighbouring tiles stay on one core, and steals from the other ranges once its own is drained. Tiles
+ * are claimed with one atomic increment, a tile is returned to exactly one worker.
+ */
+class TileScheduler
+{
+private:
+    struct alignas(64) TileRange
+    {
+        std::atomic<uint32_t> next{0};
+        uint32_t end = 0;
+    };
+
+    std::unique_ptr<TileRange[]> ranges;
+    uint32_t workersAmount = 0;
+    std::atomic<uint32_t> stolenTiles{0};
+
+public:
+    /*
+     * Not thread safe, call before the workers start
+     */
+    void reset(uint32_t tilesAmount, uint32_t workersAmount);
+    /*
+     * Claims the next tile for worker, false once every range is drained
+     */
+    bool next(uint32_t worker, uint32_t& tileOutput);
+    uint32_t getStolenTilesAmount() const;
+};
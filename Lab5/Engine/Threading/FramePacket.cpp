@@ -0,0 +1,61 @@
+#include "FramePacket.h"
+
+#include <cstring>
+
+namespace
+{
+    /*
+     * ImVector assignment frees and allocates every time, resize keeps the capacity
+     */
+    template <typename T>
+    void copyImVector(ImVector<T>& destination, const ImVector<T>& source)
+    {
+        destination.resize(source.Size);
+        if (source.Size > 0)
+        {
+            memcpy(destination.Data, source.Data, (size_t)source.Size * sizeof(T));
+        }
+    }
+}
+
+void UiDrawData::capture(const ImDrawData* source)
+{
+    drawData.Clear();
+    if (!source || !source->Valid)
+    {
+        return;
+    }
+    for (int i = 0; i < source->CmdLists.Size; i++)
+    {
+        const ImDrawList* sourceList = source->CmdLists[i];
+        if (i == lists.Size)
+        {
+            lists.push_back(IM_NEW(ImDrawList)(sourceList->_Data));
+        }
+        // The same copy CloneOutput makes
+        ImDrawList* list = lists[i];
+        copyImVector(list->CmdBuffer, sourceList->CmdBuffer);
+        copyImVector(list->IdxBuffer, sourceList->IdxBuffer);
+        copyImVector(list->VtxBuffer, sourceList->VtxBuffer);
+        list->Flags = sourceList->Flags;
+        drawData.CmdLists.push_back(list);
+    }
+    drawData.CmdListsCount = source->CmdListsCount;
+    drawData.TotalIdxCount = source->TotalIdxCount;
+    drawData.TotalVtxCount = source->TotalVtxCount;
+    drawData.DisplayPos = source->DisplayPos;
+    drawData.DisplaySize = source->DisplaySize;
+    drawData.FramebufferScale = source->FramebufferScale;
+    drawData.OwnerViewport = source->OwnerViewport;
+    drawData.Valid = true;
+}
+
+const ImDrawData* UiDrawData::get() const
+{
+    return drawData.Valid ? &drawData : nullptr;
+}
+
+UiDrawData::~UiDrawData()
+{
+    lists.clear_delete();
+}
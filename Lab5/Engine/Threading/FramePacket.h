@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include "../SceneRenderer.h"
+#include "../../ImGUI/imgui.h"
+
+/*
+ * Deep copy of the draw data of one ImGui frame, the lists ImGui hands out are rewritten by its next frame. The copy
+ * is made and freed on the thread that runs ImGui, other threads only read it. Every capture refills the lists and
+ * buffers of the previous ones, so a UI that does not grow is copied without allocating.
+ */
+class UiDrawData
+{
+public:
+    UiDrawData() = default;
+    UiDrawData(const UiDrawData&) = delete;
+    UiDrawData& operator=(const UiDrawData&) = delete;
+
+private:
+    // Its lists are the first ones of lists
+    ImDrawData drawData;
+    // Owned by this object, kept between captures
+    ImVector<ImDrawList*> lists;
+
+public:
+    /*
+     * Replaces the previous copy, source is the result of ImGui::Render
+     */
+    void capture(const ImDrawData* source);
+    /*
+     * nullptr before the first valid capture
+     */
+    const ImDrawData* get() const;
+    ~UiDrawData();
+};
+
+/*
+ * Everything the render thread needs to draw one frame, filled on the main thread and only read once submitted
+ */
+struct FramePacket
+{
+    // Counts the submitted packets, assigned by the queue
+    uint64_t frameIndex = 0;
+    // Camera matrices and the window size the frame is rendered at
+    SceneView view{};
+    SceneState scene;
+    int pbrMode = 0;
+    UiDrawData ui;
+};
@@ -0,0 +1,93 @@
+#include "FramePacketQueue.h"
+
+#include <stdexcept>
+
+FramePacketQueue::FramePacketQueue(uint32_t packetsAmount) : submitted(packetsAmount), released(packetsAmount)
+{
+    if (packetsAmount == 0)
+    {
+        throw std::runtime_error("Frame packet queue needs at least one packet");
+    }
+    for (uint32_t i = 0; i < packetsAmount; i++)
+    {
+        packets.push_back(std::make_unique<FramePacket>());
+        released.push(packets.back().get());
+    }
+}
+
+FramePacket* FramePacketQueue::tryAcquire()
+{
+    FramePacket* packet = nullptr;
+    released.pop(packet);
+    return packet;
+}
+
+void FramePacketQueue::submit(FramePacket* packet)
+{
+    packet->frameIndex = submittedAmount++;
+    // Cannot fail, at most every packet is queued
+    submitted.push(packet);
+    wakeConsumer();
+}
+
+void FramePacketQueue::close()
+{
+    closed.store(true, std::memory_order_release);
+    wakeConsumer();
+}
+
+const FramePacket* FramePacketQueue::waitNext()
+{
+    FramePacket* packet = nullptr;
+    for (;;)
+    {
+        if (closed.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        if (submitted.pop(packet))
+        {
+            return packet;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        consumerSleeping.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in wakeConsumer: either the producer sees the flag or this sees what it published
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!closed.load(std::memory_order_relaxed) && submitted.isEmpty())
+        {
+            wakeUp.wait(lock);
+        }
+        consumerSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void FramePacketQueue::release(const FramePacket* packet)
+{
+    // The packets belong to the queue, they are only handed out as const to the consumer
+    released.push(const_cast<FramePacket*>(packet));
+    if (releaseCallback)
+    {
+        releaseCallback();
+    }
+}
+
+void FramePacketQueue::setReleaseCallback(const std::function<void()>& callback)
+{
+    releaseCallback = callback;
+}
+
+uint32_t FramePacketQueue::getPacketsAmount() const
+{
+    return (uint32_t)packets.size();
+}
+
+void FramePacketQueue::wakeConsumer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumerSleeping.load(std::memory_order_relaxed))
+    {
+        // The consumer holds the mutex from raising the flag until it waits, so the notification cannot be lost
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "FramePacket.h"
+#include "../../Utils/SpscQueue.h"
+
+// Packets the main thread may run ahead of the render thread, one being drawn and one being filled
+#define FRAME_PACKETS_IN_FLIGHT 2u
+
+/*
+ * Hands frame packets from the main thread to the render thread. The packets are allocated once and circulate
+ * through two lock-free SPSC queues, submitted ones to the render thread and drawn ones back to be filled again.
+ * The producer is never blocked, with every packet in flight acquiring fails so the main thread can keep handling
+ * window messages. Only the consumer sleeps, and only while nothing is submitted.
+ */
+class FramePacketQueue
+{
+public:
+    explicit FramePacketQueue(uint32_t packetsAmount = FRAME_PACKETS_IN_FLIGHT);
+    FramePacketQueue(const FramePacketQueue&) = delete;
+    FramePacketQueue& operator=(const FramePacketQueue&) = delete;
+
+private:
+    std::vector<std::unique_ptr<FramePacket>> packets;
+    SpscQueue<FramePacket*> submitted;
+    SpscQueue<FramePacket*> released;
+    std::function<void()> releaseCallback;
+    uint64_t submittedAmount = 0;
+    std::atomic<bool> closed{false};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<bool> consumerSleeping{false};
+
+public:
+    /*
+     * Producer only, nullptr while every packet is in flight. The packet still holds the frame it carried before.
+     */
+    FramePacket* tryAcquire();
+    /*
+     * Producer only, the packet must not be touched until it is acquired again
+     */
+    void submit(FramePacket* packet);
+    /*
+     * Producer only, waitNext returns nullptr from then on and packets not taken yet are dropped
+     */
+    void close();
+
+    /*
+     * Consumer only, blocks until a packet is submitted, nullptr once the queue is closed
+     */
+    const FramePacket* waitNext();
+    /*
+     * Consumer only, hands a drawn packet back to the producer
+     */
+    void release(const FramePacket* packet);
+
+    /*
+     * Called on the consumer thread after every release, so a producer waiting for a packet can be woken. Set it
+     * before the consumer starts.
+     */
+    void setReleaseCallback(const std::function<void()>& callback);
+    uint32_t getPacketsAmount() const;
+
+private:
+    void wakeConsumer();
+};
@@ -0,0 +1,54 @@
+#include "RenderThread.h"
+
+#include "../../Utils/Profiler.h"
+
+RenderThread::RenderThread(FramePacketQueue& queue, const std::function<void(const FramePacket& packet)>& drawFrame)
+    : queue(queue), drawFrame(drawFrame)
+{
+    thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::stop()
+{
+    if (thread.joinable())
+    {
+        queue.close();
+        thread.join();
+    }
+}
+
+bool RenderThread::hasFailed() const
+{
+    return failed.load(std::memory_order_acquire);
+}
+
+void RenderThread::rethrowError() const
+{
+    if (hasFailed())
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+RenderThread::~RenderThread()
+{
+    stop();
+}
+
+void RenderThread::run()
+{
+    Profiler::setThreadName("Render thread");
+    try
+    {
+        while (const FramePacket* packet = queue.waitNext())
+        {
+            drawFrame(*packet);
+            queue.release(packet);
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+        failed.store(true, std::memory_order_release);
+    }
+}
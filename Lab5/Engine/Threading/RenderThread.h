@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include "FramePacketQueue.h"
+
+/*
+ * Draws the packets of a queue on its own thread until the queue is closed, the device context must only be used
+ * from drawFrame while the thread runs. An exception thrown by drawFrame stops the thread, the producer learns about
+ * it through hasFailed.
+ */
+class RenderThread
+{
+public:
+    RenderThread(FramePacketQueue& queue, const std::function<void(const FramePacket& packet)>& drawFrame);
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+private:
+    FramePacketQueue& queue;
+    std::function<void(const FramePacket& packet)> drawFrame;
+    // Written before failed is raised
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+    std::thread thread;
+
+public:
+    /*
+     * Closes the queue and waits for the frame being drawn, packets still queued are dropped
+     */
+    void stop();
+    bool hasFailed() const;
+    /*
+     * Rethrows on the calling thread what stopped the render thread, nothing while it runs
+     */
+    void rethrowError() const;
+    ~RenderThread();
+
+private:
+    void run();
+};
@@ -1,12 +1,14 @@
 ﻿#include "ToneMapper.h"
 
-#include "../DXDevice/DXDevice.h"
+#include <string>
+#include "../DXShader/Shader.h"
+#include "../DXDevice/DXResourceTracking.h"
 
 
 void ToneMapper::destroy()
 {
-    destroyScaledBrighnessMaps();
-    delete rtv;
+    waitForShaders();
+    releaseTracked(readAvgTexture);
     samplerAvg->Release();
     samplerMin->Release();
     samplerMax->Release();
@@ -17,10 +19,8 @@ void ToneMapper::destroy()
     tonemapPS->Release();
 }
 
-void ToneMapper::initialize(uint32_t width,
-                            uint32_t height, uint32_t imageInSwapChain)
+void ToneMapper::initialize()
 {
-    createTextures(width, height, imageInSwapChain);
     HRESULT result = 0;
 
     D3D11_SAMPLER_DESC desc = {};
@@ -73,334 +73,198 @@ void ToneMapper::initialize(uint32_t width,
     if (SUCCEEDED(result))
     {
         adaptData.adapt = DirectX::XMFLOAT4(0.0f, 0.5f, 0.0f, 0.0f);
-        constantBuffer = new ConstantBuffer(device, &adaptData, sizeof(AdaptData), "Adapt data");
+        constantBuffer = new ConstantBuffer<AdaptData>(graphicsDevice, adaptData, "Adapt data");
+
+        D3D11_TEXTURE2D_DESC textureDesc = {};
+        textureDesc.Width = 1;
+        textureDesc.Height = 1;
+        textureDesc.MipLevels = 0;
+        textureDesc.ArraySize = 1;
+        textureDesc.Format = DXGI_FORMAT_R32_FLOAT;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.Usage = D3D11_USAGE_STAGING;
+        textureDesc.BindFlags = 0;
+        textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        textureDesc.MiscFlags = 0;
+        result = device->CreateTexture2D(&textureDesc, NULL, &readAvgTexture);
+        if (SUCCEEDED(result))
+        {
+            trackTexture(readAvgTexture, "Average brightness readback", "Tone mapper");
+        }
     }
-    loadShaders();
-}
-
-void ToneMapper::destroyScaledBrighnessMaps()
-{
-    for (auto& scaledFrame : scaledFrames)
+    if (FAILED(result))
     {
-        scaledFrame.avg.shaderResourceView->Release();
-        scaledFrame.avg.renderTargetView->Release();
-        scaledFrame.avg.texture->Release();
-        scaledFrame.min.shaderResourceView->Release();
-        scaledFrame.min.renderTargetView->Release();
-        scaledFrame.min.texture->Release();
-        scaledFrame.max.shaderResourceView->Release();
-        scaledFrame.max.renderTargetView->Release();
-        scaledFrame.max.texture->Release();
+        throw std::runtime_error("Failed to initialize tone mapper");
     }
-    readAvgTexture->Release();
-
-    scaledFrames.clear();
-    scaledTexturesAmount = 0;
-}
-
-void ToneMapper::resize(uint32_t width, uint32_t height)
-{
-    destroyScaledBrighnessMaps();
-    createTextures(width, height, 0);
 }
 
-void ToneMapper::makeBrightnessMaps(ID3D11DeviceContext* deviceContext, uint32_t currentImage)
+BrightnessMaps ToneMapper::addBrightnessPasses(RenderGraph& graph, DXRenderGraphBackend* backend,
+                                               RenderGraphResource hdrFrame, uint32_t width, uint32_t height)
 {
-#ifdef _DEBUG
-    annotations->BeginEvent(L"HDR");
-#endif
-#ifdef _DEBUG
-    annotations->EndEvent();
-    annotations->BeginEvent(L"Rendering brightness maps");
-#endif
-
-    for (int i = scaledTexturesAmount; i >= 0; i--)
+    // The passes may be recorded on several threads at once, pick the shaders up before that
+    waitForShaders();
+    int levelsAmount = 0;
+    for (uint32_t minSide = width < height ? width : height; minSide >>= 1;)
     {
-        if (i == scaledTexturesAmount)
+        levelsAmount++;
+    }
+    BrightnessMaps sources = {hdrFrame, hdrFrame, hdrFrame};
+    for (int level = levelsAmount; level >= 0; level--)
+    {
+        uint32_t size = 1u << level;
+        RenderGraphTextureDesc desc{
+            size, size, DXGI_FORMAT_R32_FLOAT, RENDER_GRAPH_USAGE_RENDER_TARGET | RENDER_GRAPH_USAGE_SHADER_RESOURCE
+        };
+        std::string sizeName = std::to_string(size);
+        BrightnessMaps maps = {
+            graph.createTexture("Average brightness " + sizeName, desc),
+            graph.createTexture("Minimum brightness " + sizeName, desc),
+            graph.createTexture("Maximum brightness " + sizeName, desc)
+        };
+        bool fromFrame = level == levelsAmount;
+        RenderGraphPassDesc pass;
+        pass.name = fromFrame ? "Rendering brightness maps" : "Downsampling brightness maps " + sizeName;
+        if (fromFrame)
         {
-            ID3D11RenderTargetView* views[] = {
-                scaledFrames[i].avg.renderTargetView,
-                scaledFrames[i].min.renderTargetView,
-                scaledFrames[i].max.renderTargetView
-            };
-            deviceContext->OMSetRenderTargets(3, views, nullptr);
+            pass.reads = {hdrFrame};
         }
         else
         {
-            ID3D11RenderTargetView* views[] = {
-                scaledFrames[i].avg.renderTargetView, scaledFrames[i].min.renderTargetView,
-                scaledFrames[i].max.renderTargetView
-            };
-            deviceContext->OMSetRenderTargets(3, views, nullptr);
+            pass.reads = {sources.avg, sources.min, sources.max};
         }
-
-        ID3D11SamplerState* samplers[] = {samplerAvg, samplerMin, samplerMax};
-        deviceContext->PSSetSamplers(0, 3, samplers);
-
-        D3D11_VIEWPORT viewport;
-        viewport.TopLeftX = 0;
-        viewport.TopLeftY = 0;
-        viewport.Width = (FLOAT)pow(2, i);
-        viewport.Height = (FLOAT)pow(2, i);
-        viewport.MinDepth = 0.0f;
-        viewport.MaxDepth = 1.0f;
-        deviceContext->RSSetViewports(1, &viewport);
-
-        ID3D11ShaderResourceView* resources[] = {
-            i == scaledTexturesAmount
-                ? rtv->getResourceViews()[currentImage]
-                : scaledFrames[i + 1].avg.shaderResourceView,
-            i == scaledTexturesAmount
-                ? rtv->getResourceViews()[currentImage]
-                : scaledFrames[i + 1].min.shaderResourceView,
-            i == scaledTexturesAmount
-                ? rtv->getResourceViews()[currentImage]
-                : scaledFrames[i + 1].max.shaderResourceView
+        pass.writes = {maps.avg, maps.min, maps.max};
+        pass.execute = [this, backend, sources, maps, fromFrame](RenderGraphContext context)
+        {
+            backend->bindRenderTargets(context, {maps.avg, maps.min, maps.max});
+            ID3D11ShaderResourceView* resources[] = {
+                backend->getShaderResourceView(sources.avg),
+                backend->getShaderResourceView(sources.min),
+                backend->getShaderResourceView(sources.max)
+            };
+            makeBrightnessMap(backend->getStateContext(context), resources, fromFrame);
         };
-        deviceContext->PSSetShaderResources(0, 3, resources);
-        deviceContext->OMSetDepthStencilState(nullptr, 0);
-        deviceContext->RSSetState(nullptr);
-        deviceContext->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
-        deviceContext->IASetInputLayout(nullptr);
-        deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-        deviceContext->VSSetShader(mappingVS, nullptr, 0);
-        deviceContext->PSSetShader(i == scaledTexturesAmount ? brightnessPS : downsamplePS, nullptr, 0);
-        deviceContext->Draw(6, 0);
-
-        DXDevice::unBindRenderTargets(deviceContext);
+        graph.addPass(pass);
+        sources = maps;
     }
-#ifdef _DEBUG
-    annotations->EndEvent();
-#endif
+    return sources;
 }
 
-void ToneMapper::postProcessToneMap(ID3D11DeviceContext* deviceContext, uint32_t currentImage)
+void ToneMapper::makeBrightnessMap(DXStateContext* deviceContext, ID3D11ShaderResourceView* const* pSources,
+                                   bool fromFrame)
 {
-#ifdef _DEBUG
-    annotations->BeginEvent(L"Tone mapping");
-#endif
+    waitForShaders();
+    ID3D11SamplerState* samplers[] = {samplerAvg, samplerMin, samplerMax};
+    deviceContext->setPixelSamplers(0, 3, samplers);
+    deviceContext->setPixelShaderResources(0, 3, pSources);
+    deviceContext->setDepthStencilState(nullptr, 0);
+    deviceContext->setRasterizerState(nullptr);
+    deviceContext->setBlendState(nullptr, nullptr, 0xFFFFFFFF);
+    deviceContext->setInputLayout(nullptr);
+    deviceContext->setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext->setVertexShader(mappingVS);
+    deviceContext->setPixelShader(fromFrame ? brightnessPS : downsamplePS);
+    deviceContext->draw(6, 0);
+}
 
+void ToneMapper::adaptToBrightness(DXStateContext* deviceContext, DXRenderGraphBackend* backend,
+                                   const BrightnessMaps& brightnessMaps)
+{
+    ID3D11DeviceContext* context = deviceContext->getContext();
     auto time = std::chrono::high_resolution_clock::now();
     float dtime = std::chrono::duration<float, std::milli>(time - lastFrameTime).count() * 0.001;
     lastFrameTime = time;
-#ifdef _DEBUG
-    annotations->BeginEvent(L"Calculating adaptation");
-#endif
 
-    deviceContext->CopyResource(readAvgTexture, scaledFrames[0].avg.texture);
+    context->CopyResource(readAvgTexture, backend->getTexture(brightnessMaps.avg));
     D3D11_MAPPED_SUBRESOURCE ResourceDesc = {};
-    if (FAILED(deviceContext->Map(readAvgTexture, 0, D3D11_MAP_READ, 0, &ResourceDesc)))
+    if (FAILED(context->Map(readAvgTexture, 0, D3D11_MAP_READ, 0, &ResourceDesc)))
     {
         throw std::runtime_error("Failed to read values from brightness buffer");
     }
 
-    float avg;
+    float avg = adapt;
     if (ResourceDesc.pData)
     {
         float* pData = reinterpret_cast<float*>(ResourceDesc.pData);
         avg = *((float*)ResourceDesc.pData);
     }
-    deviceContext->Unmap(readAvgTexture, 0);
+    context->Unmap(readAvgTexture, 0);
 
     adapt += (avg - adapt) * (1.0f - exp(-dtime / s));
 
 
     adaptData.adapt = DirectX::XMFLOAT4(adapt, 0.0f, 0.0f, 0.0f);
 
-    constantBuffer->updateData(deviceContext, &adaptData);
-#ifdef _DEBUG
-    annotations->EndEvent();
-    annotations->BeginEvent(L"Postprocess: tone mapping");
-#endif
-
-    ID3D11ShaderResourceView* resources[] = {
-        rtv->getResourceViews()[currentImage],
-        scaledFrames[0].avg.shaderResourceView,
-        scaledFrames[0].min.shaderResourceView,
-        scaledFrames[0].max.shaderResourceView
-    };
-    deviceContext->PSSetShaderResources(0, 4, resources);
-    deviceContext->OMSetDepthStencilState(nullptr, 0);
-    deviceContext->RSSetState(nullptr);
-    deviceContext->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFF);
-    deviceContext->IASetInputLayout(nullptr);
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    constantBuffer->bindToPixelShader(deviceContext);
-    deviceContext->VSSetShader(mappingVS, nullptr, 0);
-    deviceContext->PSSetShader(tonemapPS, nullptr, 0);
-    deviceContext->Draw(6, 0);
-#ifdef _DEBUG
-    annotations->EndEvent();
-    annotations->EndEvent();
-    annotations->EndEvent();
-#endif
-}
-
-DXRenderTargetView* ToneMapper::getRendertargetView()
-{
-    return rtv;
-}
-
-void ToneMapper::clearRenderTarget(ID3D11DeviceContext* deviceContext, uint32_t currentImage)
-{
-    rtv->clearColorAttachments(deviceContext, 0.25f, 0.25f, 0.25f, 1.0f, currentImage);
-    rtv->clearDepthAttachments(deviceContext);
-    float color[4] = {0.25f, 0.25f, 0.25f, 1.0f};
-    for (auto& scaledFrame : scaledFrames)
-    {
-        deviceContext->ClearRenderTargetView(scaledFrame.avg.renderTargetView, color);
-    }
-#ifdef _DEBUG
-    annotations->BeginEvent(L"Rendering main frame");
-#endif
+    constantBuffer->updateData(deviceContext, adaptData);
 }
 
-void ToneMapper::createTextures(uint32_t width, uint32_t height, uint32_t imagesInSwapChainAmount)
+void ToneMapper::postProcessToneMap(DXStateContext* deviceContext, DXRenderGraphBackend* backend,
+                                    RenderGraphResource hdrFrame, const BrightnessMaps& brightnessMaps)
 {
-    if (!rtv)
-    {
-        rtv = new DXRenderTargetView(device, imagesInSwapChainAmount, width, height,
-                                     "Frame for brightness map postprocess");
-    }
-    else
-    {
-        rtv->destroy();
-        rtv->resize(width, height);
-    }
-    int minSide = min(width, height);
-
-    while (minSide >>= 1)
-    {
-        scaledTexturesAmount++;
-    }
-    for (int i = 0; i < scaledTexturesAmount + 1; i++)
-    {
-        ScaledFrame scaledFrame;
-        createSquareTexture(scaledFrame.avg, i);
-        createSquareTexture(scaledFrame.min, i);
-        createSquareTexture(scaledFrame.max, i);
-        scaledFrames.push_back(scaledFrame);
-    }
-    D3D11_TEXTURE2D_DESC textureDesc = {};
-
-    textureDesc.Width = 1;
-    textureDesc.Height = 1;
-    textureDesc.MipLevels = 0;
-    textureDesc.ArraySize = 1;
-    textureDesc.Format = DXGI_FORMAT_R32_FLOAT;
-    textureDesc.SampleDesc.Count = 1;
-    textureDesc.Usage = D3D11_USAGE_STAGING;
-    textureDesc.BindFlags = 0;
-    textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-    textureDesc.MiscFlags = 0;
+    waitForShaders();
 
-    device->CreateTexture2D(&textureDesc, NULL, &readAvgTexture);
+    ID3D11ShaderResourceView* resources[] = {
+        backend->getShaderResourceView(hdrFrame),
+        backend->getShaderResourceView(brightnessMaps.avg),
+        backend->getShaderResourceView(brightnessMaps.min),
+        backend->getShaderResourceView(brightnessMaps.max)
+    };
+    deviceContext->setPixelShaderResources(0, 4, resources);
+    deviceContext->setDepthStencilState(nullptr, 0);
+    deviceContext->setRasterizerState(nullptr);
+    deviceContext->setBlendState(nullptr, nullptr, 0xFFFFFFFF);
+    deviceContext->setInputLayout(nullptr);
+    deviceContext->setPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    constantBuffer->bindToPixelShader(deviceContext);
+    deviceContext->setVertexShader(mappingVS);
+    deviceContext->setPixelShader(tonemapPS);
+    deviceContext->draw(6, 0);
 }
 
-
-void ToneMapper::createSquareTexture(Texture& text, uint32_t len)
+void ToneMapper::loadShaders()
 {
-    D3D11_TEXTURE2D_DESC desc;
-    desc.Format = DXGI_FORMAT_R32_FLOAT;
-    desc.ArraySize = 1;
-    desc.MipLevels = 1;
-    desc.Usage = D3D11_USAGE_DEFAULT;
-    desc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
-    desc.CPUAccessFlags = 0;
-    desc.MiscFlags = 0;
-    desc.SampleDesc.Count = 1;
-    desc.SampleDesc.Quality = 0;
-    desc.Height = pow(2, len);
-    desc.Width = pow(2, len);
-    HRESULT result = device->CreateTexture2D(&desc, nullptr, &text.texture);
-    if (SUCCEEDED(result))
-    {
-        D3D11_SHADER_RESOURCE_VIEW_DESC descSRV = {};
-        descSRV.Format = DXGI_FORMAT_R32_FLOAT;
-        descSRV.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        descSRV.Texture2D.MipLevels = 1;
-        descSRV.Texture2D.MostDetailedMip = 0;
-        result = device->CreateShaderResourceView(text.texture, &descSRV, &text.shaderResourceView);
-        if (FAILED(result))
+    std::vector<ShaderStageRequest> stageRequests;
+    stageRequests.push_back({L"Shaders/ToneMap/mappingVS.hlsl", {}, "main", "vs_5_0"});
+    stageRequests.push_back({L"Shaders/ToneMap/brightnessPS.hlsl", {}, "main", "ps_5_0"});
+    stageRequests.push_back({L"Shaders/ToneMap/downsamplePS.hlsl", {}, "main", "ps_5_0"});
+    stageRequests.push_back({L"Shaders/ToneMap/toneMapPS.hlsl", {}, "main", "ps_5_0"});
+    ID3D11Device* shaderDevice = device;
+    shadersBuild = Shader::getBuildQueue().buildProgram<ToneMapperShaders>(stageRequests, [shaderDevice](
+        const std::vector<ShaderStageResult>& stages)
         {
-            throw std::runtime_error("Failed to create shader resource view");
-        }
-    }
-    else
-    {
-        throw std::runtime_error("Failed to create texture");
-    }
-
-
-    result = device->CreateRenderTargetView(text.texture, nullptr, &text.renderTargetView);
-    if (FAILED(result))
-    {
-        throw std::runtime_error("Failed to create render target view");
-    }
+            ToneMapperShaders shaders{};
+            HRESULT result = shaderDevice->CreateVertexShader(stages[0]->bytecode.data(),
+                                                              stages[0]->bytecode.size(), NULL, &shaders.mappingVS);
+            if (SUCCEEDED(result))
+            {
+                result = shaderDevice->CreatePixelShader(stages[1]->bytecode.data(), stages[1]->bytecode.size(),
+                                                         NULL, &shaders.brightnessPS);
+            }
+            if (SUCCEEDED(result))
+            {
+                result = shaderDevice->CreatePixelShader(stages[2]->bytecode.data(), stages[2]->bytecode.size(),
+                                                         NULL, &shaders.downsamplePS);
+            }
+            if (SUCCEEDED(result))
+            {
+                result = shaderDevice->CreatePixelShader(stages[3]->bytecode.data(), stages[3]->bytecode.size(),
+                                                         NULL, &shaders.tonemapPS);
+            }
+            if (FAILED(result))
+            {
+                throw std::runtime_error("Failed to initialize shaders");
+            }
+            return shaders;
+        });
 }
 
-void ToneMapper::loadShaders()
+void ToneMapper::waitForShaders()
 {
-    HRESULT result = 0;
-    ID3DBlob* vertexShaderBuffer = nullptr;
-    ID3DBlob* pixelShaderBuffer = nullptr;
-    int flags = 0;
-#ifdef _DEBUG
-    flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-
-    if (SUCCEEDED(result))
-    {
-        result = D3DCompileFromFile(L"Shaders/ToneMap/brightnessPS.hlsl", NULL, NULL, "main", "ps_5_0", flags, 0,
-                                    &pixelShaderBuffer, NULL);
-        if (SUCCEEDED(result))
-        {
-            result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(),
-                                               pixelShaderBuffer->GetBufferSize(), NULL, &brightnessPS);
-        }
-    }
-
-    pixelShaderBuffer->Release();
-
-    if (SUCCEEDED(result))
-    {
-        result = D3DCompileFromFile(L"Shaders/ToneMap/mappingVS.hlsl", NULL, NULL, "main", "vs_5_0", flags, 0,
-                                    &vertexShaderBuffer,
-                                    NULL);
-        if (SUCCEEDED(result))
-        {
-            result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(),
-                                                vertexShaderBuffer->GetBufferSize(), NULL, &mappingVS);
-        }
-    }
-    if (SUCCEEDED(result))
-    {
-        result = D3DCompileFromFile(L"Shaders/ToneMap/downsamplePS.hlsl", NULL, NULL, "main", "ps_5_0", flags, 0,
-                                    &pixelShaderBuffer, NULL);
-        if (SUCCEEDED(result))
-        {
-            result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(),
-                                               pixelShaderBuffer->GetBufferSize(), NULL, &downsamplePS);
-        }
-    }
-
-    vertexShaderBuffer->Release();
-    pixelShaderBuffer->Release();
-    if (SUCCEEDED(result))
-    {
-        result = D3DCompileFromFile(L"Shaders/ToneMap/toneMapPS.hlsl", NULL, NULL, "main", "ps_5_0", flags, 0,
-                                    &pixelShaderBuffer,
-                                    NULL);
-        if (SUCCEEDED(result))
-        {
-            result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(),
-                                               pixelShaderBuffer->GetBufferSize(), NULL, &tonemapPS);
-        }
-    }
-
-    pixelShaderBuffer->Release();
-    if (FAILED(result))
+    if (mappingVS == nullptr)
     {
-        throw std::runtime_error("Failed to initialize shaders");
+        ToneMapperShaders shaders = shadersBuild.get();
+        mappingVS = shaders.mappingVS;
+        brightnessPS = shaders.brightnessPS;
+        downsamplePS = shaders.downsamplePS;
+        tonemapPS = shaders.tonemapPS;
     }
 }
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <chrono>
+#include <future>
 #include <d3d11.h>
 #include <d3d11_1.h>
 #include <DirectXMath.h>
@@ -8,21 +9,25 @@
 #include <d3dcompiler.h>
 #include <stdexcept>
 
-#include "../DXDevice/DXRenderTargetView.h"
 #include "../DXShader/ConstantBuffer.h"
+#include "RenderGraph/DXRenderGraphBackend.h"
 
-struct Texture
+/*
+ * 1x1 average, minimum and maximum brightness of the frame, the last level of the brightness chain
+ */
+struct BrightnessMaps
 {
-    ID3D11Texture2D* texture = nullptr;
-    ID3D11RenderTargetView* renderTargetView = nullptr;
-    ID3D11ShaderResourceView* shaderResourceView = nullptr;
+    RenderGraphResource avg;
+    RenderGraphResource min;
+    RenderGraphResource max;
 };
 
-struct ScaledFrame
+struct ToneMapperShaders
 {
-    Texture min;
-    Texture avg;
-    Texture max;
+    ID3D11VertexShader* mappingVS;
+    ID3D11PixelShader* brightnessPS;
+    ID3D11PixelShader* downsamplePS;
+    ID3D11PixelShader* tonemapPS;
 };
 
 struct AdaptData
@@ -30,30 +35,33 @@ struct AdaptData
     DirectX::XMFLOAT4 adapt;
 };
 
+CONSTANT_BUFFER_CHECK_PACKING(AdaptData, adapt);
+
 class ToneMapper
 {
 public:
-    ToneMapper(ID3D11Device* device, ID3DUserDefinedAnnotation* annotations)
+    ToneMapper(ID3D11Device* device, GraphicsDevice* graphicsDevice, ID3DUserDefinedAnnotation* annotations)
         : device(device),
+          graphicsDevice(graphicsDevice),
           annotations(annotations)
     {
+        loadShaders();
     }
 
 private:
     ID3D11Device* device;
-    DXRenderTargetView* rtv;
-    uint32_t scaledTexturesAmount = 0;
-    std::vector<ScaledFrame> scaledFrames;
+    GraphicsDevice* graphicsDevice;
     ID3D11SamplerState* samplerAvg;
     ID3D11SamplerState* samplerMin;
     ID3D11SamplerState* samplerMax;
-    ConstantBuffer* constantBuffer;
+    ConstantBuffer<AdaptData>* constantBuffer;
     AdaptData adaptData{};
 
-    ID3D11VertexShader* mappingVS;
-    ID3D11PixelShader* brightnessPS;
-    ID3D11PixelShader* downsamplePS;
-    ID3D11PixelShader* tonemapPS;
+    std::shared_future<ToneMapperShaders> shadersBuild;
+    ID3D11VertexShader* mappingVS = nullptr;
+    ID3D11PixelShader* brightnessPS = nullptr;
+    ID3D11PixelShader* downsamplePS = nullptr;
+    ID3D11PixelShader* tonemapPS = nullptr;
     std::chrono::time_point<std::chrono::steady_clock> lastFrameTime;
     ID3D11Texture2D* readAvgTexture;
     ID3DUserDefinedAnnotation* annotations;
@@ -61,20 +69,31 @@ private:
     float s = 0.5f;
 
 public:
-    void initialize(uint32_t width, uint32_t height, uint32_t imagesInSwapChainAmount);
-
-    
-    void resize(uint32_t width, uint32_t height);
-    void makeBrightnessMaps(ID3D11DeviceContext* deviceContext, uint32_t currentImage);
-    void postProcessToneMap(ID3D11DeviceContext* deviceContext, uint32_t currentImage);
+    void initialize();
 
-    DXRenderTargetView* getRendertargetView();
+    /*
+     * Declares the passes that reduce hdrFrame to 1x1 brightness maps, one power of two level per pass
+     */
+    BrightnessMaps addBrightnessPasses(RenderGraph& graph, DXRenderGraphBackend* backend,
+                                       RenderGraphResource hdrFrame, uint32_t width, uint32_t height);
+    /*
+     * Reads the average brightness back and moves the adaptation towards it, needs the immediate context
+     */
+    void adaptToBrightness(DXStateContext* deviceContext, DXRenderGraphBackend* backend,
+                           const BrightnessMaps& brightnessMaps);
+    /*
+     * Draws hdrFrame into the currently bound render target
+     */
+    void postProcessToneMap(DXStateContext* deviceContext, DXRenderGraphBackend* backend,
+                            RenderGraphResource hdrFrame, const BrightnessMaps& brightnessMaps);
 
-    void clearRenderTarget(ID3D11DeviceContext* deviceContext, uint32_t currentImage);
     void destroy();
 private:
-    void createTextures(uint32_t width, uint32_t height, uint32_t imagesInSwapChainAmount);
-    void createSquareTexture(Texture& text, uint32_t len);
+    void makeBrightnessMap(DXStateContext* deviceContext, ID3D11ShaderResourceView* const* pSources,
+                           bool fromFrame);
+    /*
+     * Starts compiling on the shader build queue, the shaders are picked up by waitForShaders on first use
+     */
     void loadShaders();
-    void destroyScaledBrighnessMaps();
+    void waitForShaders();
 };
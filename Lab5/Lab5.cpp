@@ -1,17 +1,22 @@
 #include "Window/Window.h"
 #include "Engine/Renderer.h"
+#include "Engine/Threading/RenderThread.h"
+#include "Engine/Resources/ResourceRegistry.h"
+#include "Engine/Profiling/StartupTimeline.h"
+#include "Utils/Profiler.h"
+#include <cstring>
 #include <iostream>
+#include <sstream>
+
+// Longest sleep of the main thread while every frame packet is being drawn, bounds how late a render thread
+// failure is noticed
+#define LAB5_RENDER_THREAD_WAIT_MS 100u
 
 class TestMouseCB : public IWindowMouseCallback {
 public:
-    void mouseMove(uint32_t x, uint32_t y) override {
+    void mouseMove(int32_t x, int32_t y) override {
         std::cout << "X: " << x << " Y: " << y << std::endl;
     }
-     void mouseKey(uint32_t key) {
-        if (key == WM_LBUTTONDOWN) {
-            std::cout << "LEFT BUTTON" << std::endl;
-        }
-    }
 };
 
 
@@ -19,18 +24,59 @@ public:
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     PSTR lpCmdLine, int nCmdShow)
 {
-    
+    StartupTimeline::getShared().start();
    
    
-    auto window = Window::createWindow(hInstance, 1920, 1080, L"Lab5");
+    // --trace <path> records every profiler zone of the run and writes them as a Chrome trace on exit
+    std::string tracePath;
+    if (const char* traceOption = strstr(lpCmdLine, "--trace ")) {
+        std::istringstream(traceOption + strlen("--trace ")) >> tracePath;
+    }
+    Profiler::setThreadName("Main thread");
+    Profiler::setEnabled(!tracePath.empty());
+    Window* window;
+    {
+        StartupPhase phase("Create window");
+        window = Window::createWindow(hInstance, 1920, 1080, L"Lab5");
+    }
     Renderer* renderer = new Renderer(window);
-    while (!window->isNeedToClose()) {
-        renderer->drawFrame();
+    if (strstr(lpCmdLine, "--render-thread")) {
+        // Input and UI stay on this thread, the device context belongs to the render thread until it stops
+        FramePacketQueue frames;
+        frames.setReleaseCallback([window]() { window->wake(); });
+        RenderThread renderThread(frames, [renderer](const FramePacket& packet) { renderer->drawFrame(packet); });
+        while (!window->isNeedToClose() && !renderThread.hasFailed()) {
+            window->pollEvents();
+            FramePacket* packet = frames.tryAcquire();
+            if (!packet) {
+                window->waitEvents(LAB5_RENDER_THREAD_WAIT_MS);
+                continue;
+            }
+            renderer->buildFramePacket(*packet);
+            frames.submit(packet);
+        }
+        renderThread.stop();
+        renderThread.rethrowError();
+    }
+    else {
+        while (!window->isNeedToClose()) {
+            renderer->drawFrame();
 
-        window->pollEvents();
+            window->pollEvents();
+        }
     }
     renderer->release();
     delete renderer;
+    // Every GPU object is released by now, whatever the registry still holds leaked
+    ResourceRegistry::getShared().reportLeaks(std::cerr);
+    if (!tracePath.empty()) {
+        try {
+            Profiler::writeChromeTrace(tracePath);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
     return 0;
 }
 
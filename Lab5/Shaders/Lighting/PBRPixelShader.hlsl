@@ -1,3 +1,12 @@
+#define PBR_MODE_DEFAULT 0
+#define PBR_MODE_NORMAL_DISTRIBUTION 1
+#define PBR_MODE_GEOMETRY_FUNCTION 2
+#define PBR_MODE_FRESNEL_FUNCTION 3
+
+#ifndef PBR_MODE
+#define PBR_MODE PBR_MODE_DEFAULT
+#endif
+
 TextureCube irradianceTexture : register (t0);
 SamplerState irradianceSampler : register (s0);
 TextureCube prefilteredTexture : register (t1);
@@ -11,31 +20,33 @@ struct PixelShaderInput
     float3 normal: NORMAL;
     float2 uv: UV;
     float3 color: COLOR;
+    nointerpolation float2 material: MATERIAL;
 };
 
 struct PointLight
 {
     float3 position;
     float intensity;
+    float radius;
+    float3 padding;
 };
 
 cbuffer LightData: register(b0)
 {
-    PointLight lightsInfos[3];
     float3 cameraPosition;
+    uint lightsAmount;
+    float4 clusterScale;
+    uint4 clusterDimensions;
 };
 
+StructuredBuffer<PointLight> lights : register(t3);
+StructuredBuffer<uint2> clusterRanges : register(t4);
+StructuredBuffer<uint> lightIndices : register(t5);
+
 cbuffer Configuration: register(b1)
 {
-    int defaultFunction;
-    int normalDistribution;
-    int fresnelFunction;
-    int geometryFunction;
-
-    float metallic;
-    float roughness;
     float ambientIntensity;
-    float alignment;
+    float3 alignment;
 };
 
 
@@ -92,58 +103,37 @@ float3 processPointLight(PointLight light, float3 normals, float3 fragmentPositi
                          float3 startFresnelSchlick, float roughness, float metallic, float3 albedo)
 {
     float3 processedLightPos = normalize(light.position - fragmentPosition);
-    float distance = length(light.position - fragmentPosition);
     float3 halfWay = normalize((worldViewVector + processedLightPos)/2.0f);
-    
-    float attenuation = clamp(1.0 / (distance * distance), 0.01, 1.0f);
-    float3 radiance = float3(1, 1, 1)* light.intensity *attenuation;
 
+#if PBR_MODE == PBR_MODE_NORMAL_DISTRIBUTION
     float halfWayGGX = distributeGGX(normals, halfWay, roughness);
+    return float3(halfWayGGX, halfWayGGX, halfWayGGX);
+#elif PBR_MODE == PBR_MODE_GEOMETRY_FUNCTION
     float geometrySmith = smithGeometry(normals, worldViewVector, processedLightPos, roughness);
-    
-    
+    return float3(geometrySmith, geometrySmith, geometrySmith);
+#else
     float3 fresnelSchlick = fresnelFunctionMetal(albedo, startFresnelSchlick, halfWay, worldViewVector, metallic);
+    float denominator = 4.0 * max(dot(normals, worldViewVector), 0.0) * max(dot(normals, processedLightPos), 0.0) +
+        0.0001;
+#if PBR_MODE == PBR_MODE_FRESNEL_FUNCTION
+    return fresnelSchlick / denominator;
+#else
+    float distance = length(light.position - fragmentPosition);
+    float falloff = saturate(1.0f - pow(distance / light.radius, 4));
+    float attenuation = falloff * falloff / max(distance * distance, 1.0f);
+    float3 radiance = float3(1, 1, 1)* light.intensity *attenuation;
 
-    float3 numerator = float3(0, 0, 0);
-    float denominator = 1;
-    if (defaultFunction)
-    {
-        numerator = halfWayGGX*geometrySmith * fresnelSchlick;
-        denominator = 4.0 * max(dot(normals, worldViewVector), 0.0) * max(dot(normals, processedLightPos), 0.0) +
-            0.0001;
-    }
-    else if (fresnelFunction)
-    {
-        numerator = fresnelSchlick;
-        denominator = 4.0 * max(dot(normals, worldViewVector), 0.0) * max(dot(normals, processedLightPos), 0.0) +
-            0.0001;;
-    }
-    else if (normalDistribution)
-    {
-        numerator = float3(halfWayGGX, halfWayGGX, halfWayGGX);
-        denominator = 1.0f;
-    }
-    else if (geometryFunction)
-    {
-        numerator = float3(geometrySmith, geometrySmith, geometrySmith);
-        denominator = 1.0f;
-    }
-
+    float halfWayGGX = distributeGGX(normals, halfWay, roughness);
+    float geometrySmith = smithGeometry(normals, worldViewVector, processedLightPos, roughness);
+    float3 specular = halfWayGGX * geometrySmith * fresnelSchlick / denominator;
 
-    float3 specular = numerator / denominator;
-    if (defaultFunction)
-    {
-       
-        float3 finalFresnelSchlick = float3(1, 1, 1) - fresnelSchlick;
-        finalFresnelSchlick *= 1.0 - metallic+0.001;
+    float3 finalFresnelSchlick = float3(1, 1, 1) - fresnelSchlick;
+    finalFresnelSchlick *= 1.0 - metallic+0.001;
 
-        float NdotL = max(dot(normals, processedLightPos), 0.0);
-        return (finalFresnelSchlick * albedo / PI + specular) * radiance * NdotL;
-    }
-    else
-    {
-        return specular;
-    }
+    float NdotL = max(dot(normals, processedLightPos), 0.0);
+    return (finalFresnelSchlick * albedo / PI + specular) * radiance * NdotL;
+#endif
+#endif
 }
 
 float3 prefilteredReflection(float3 R, float roughness)
@@ -158,6 +148,15 @@ float3 prefilteredReflection(float3 R, float roughness)
 }
 
 
+uint2 findClusterRange(float4 screenPosition)
+{
+    float slice = log(screenPosition.w) * clusterScale.z - clusterScale.w;
+    uint3 cluster = uint3(screenPosition.xy * clusterScale.xy, max(slice, 0.0f));
+    cluster = min(cluster, clusterDimensions.xyz - 1);
+    return clusterRanges[cluster.x + cluster.y * clusterDimensions.x +
+        cluster.z * clusterDimensions.x * clusterDimensions.y];
+}
+
 float4 main(PixelShaderInput psInput) : SV_Target
 {
     float3 normal = normalize(psInput.normal);
@@ -166,30 +165,33 @@ float4 main(PixelShaderInput psInput) : SV_Target
     
 
     
+    float surfaceMetallic = psInput.material.x;
+    float surfaceRoughness = psInput.material.y;
     float3 startFresnelSchlick = float3(0.04, 0.04, 0.04);
-    startFresnelSchlick = lerp(startFresnelSchlick, psInput.color, metallic);
+    startFresnelSchlick = lerp(startFresnelSchlick, psInput.color, surfaceMetallic);
 
 
     float3 Lo = float3(0, 0, 0);
-    for (uint i = 0; i < 3; i++)
+    uint2 clusterRange = findClusterRange(psInput.position);
+    for (uint i = 0; i < clusterRange.y; i++)
     {
-        Lo += processPointLight(lightsInfos[i], normal, psInput.worldPos, worldViewVector, startFresnelSchlick,
-                                roughness, metallic, psInput.color);
+        Lo += processPointLight(lights[lightIndices[clusterRange.x + i]], normal, psInput.worldPos, worldViewVector,
+                                startFresnelSchlick, surfaceRoughness, surfaceMetallic, psInput.color);
     }
     float3 R = reflect(-worldViewVector, normal); 
-    float2 brdf = brdfTexture.Sample(prefilteredSampler, float2(max(dot(normal, worldViewVector), 0.0f), roughness)).rg;
-    float3 reflection = prefilteredReflection(R, roughness).rgb;	
+    float2 brdf = brdfTexture.Sample(prefilteredSampler, float2(max(dot(normal, worldViewVector), 0.0f), surfaceRoughness)).rg;
+    float3 reflection = prefilteredReflection(R, surfaceRoughness).rgb;	
     float3 irradiance = irradianceTexture.Sample(prefilteredSampler, normal).rgb;
 
     float3 diffuse = irradiance * psInput.color;	
 
-    float3 F = F_SchlickR(max(dot(normal, worldViewVector), 0.0), startFresnelSchlick, roughness);
+    float3 F = F_SchlickR(max(dot(normal, worldViewVector), 0.0), startFresnelSchlick, surfaceRoughness);
 
     float3 specular = reflection * (F * brdf.x + brdf.y);
 
     // Ambient part
     float3 kD = 1.0 - F;
-    kD *= 1.0 - metallic;	  
+    kD *= 1.0 - surfaceMetallic;	  
     float3 ambient = (kD * diffuse + specular);
     float3 rescolor = ambientIntensity*ambient + Lo;
     
@@ -1,10 +1,10 @@
-
 struct VS_INPUT
 {
     float3 position: POSITION;
     float2 uv: UV;
     float3 normal: NORMAL;
     float3 color: COLOR;
+    uint instanceId: SV_InstanceID;
 };
 
 struct VS_OUTPUT
@@ -14,6 +14,16 @@ struct VS_OUTPUT
     float3 normal: NORMAL;
     float2 uv: UV;
     float3 color: COLOR;
+    nointerpolation float2 material: MATERIAL;
+};
+
+struct InstanceData
+{
+    float4x4 worldMatrix;
+    float3 albedo;
+    float metallic;
+    float roughness;
+    float3 padding;
 };
 
 cbuffer TransformData: register(b0)
@@ -22,14 +32,20 @@ cbuffer TransformData: register(b0)
     float4x4 cameraMatrix;
 };
 
+StructuredBuffer<InstanceData> instances : register(t0);
 
 VS_OUTPUT main(VS_INPUT vsInput)
 {
+    InstanceData instance = instances[vsInput.instanceId];
     VS_OUTPUT output = (VS_OUTPUT)0;
-    output.position = mul(cameraMatrix, mul(worldMatrix, float4(vsInput.position, 1.0f)));
-    output.worldPos = mul(worldMatrix, float4(vsInput.position, 1.0f));
+    float4 worldPos = mul(worldMatrix, mul(instance.worldMatrix, float4(vsInput.position, 1.0f)));
+    output.position = mul(cameraMatrix, worldPos);
+    output.worldPos = worldPos;
     output.uv = vsInput.uv;
-    output.normal = mul(float4(vsInput.normal, 0), worldMatrix).xyz;
-    output.color = vsInput.color;
+    // Same order as the position, w = 0 drops the translation. Valid while instances only rotate and scale
+    // uniformly, otherwise the normal needs the inverse transpose.
+    output.normal = mul(worldMatrix, mul(instance.worldMatrix, float4(vsInput.normal, 0))).xyz;
+    output.color = instance.albedo;
+    output.material = float2(instance.metallic, instance.roughness);
     return output;
-}
\ No newline at end of file
+}
@@ -0,0 +1,61 @@
+#include "TestFramework.h"
+
+#include "Utils/DXGIFormatSize.h"
+
+TEST_CASE(texelSizes)
+{
+    CHECK_EQUAL(32u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB));
+    CHECK_EQUAL(64u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_R16G16B16A16_FLOAT));
+    CHECK_EQUAL(32u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_R9G9B9E5_SHAREDEXP));
+    CHECK_EQUAL(4u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_BC1_UNORM));
+    CHECK_EQUAL(8u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_BC7_UNORM_SRGB));
+    // Planar and unknown formats have no texel size
+    CHECK_EQUAL(0u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_NV12));
+    CHECK_EQUAL(0u, getDXGIFormatBitsPerPixel(DXGI_FORMAT_UNKNOWN));
+
+    CHECK(isDXGIFormatBlockCompressed(DXGI_FORMAT_BC1_TYPELESS));
+    CHECK(isDXGIFormatBlockCompressed(DXGI_FORMAT_BC5_SNORM));
+    CHECK(isDXGIFormatBlockCompressed(DXGI_FORMAT_BC6H_UF16));
+    CHECK(!isDXGIFormatBlockCompressed(DXGI_FORMAT_B5G6R5_UNORM));
+    CHECK(isDXGIFormatPacked(DXGI_FORMAT_YUY2));
+    CHECK(!isDXGIFormatPacked(DXGI_FORMAT_R8G8_UNORM));
+
+    CHECK_EQUAL(std::string("BC7_UNORM_SRGB"), getDXGIFormatName(DXGI_FORMAT_BC7_UNORM_SRGB));
+    CHECK_EQUAL(std::string("D24_UNORM_S8_UINT"), getDXGIFormatName(DXGI_FORMAT_D24_UNORM_S8_UINT));
+    CHECK_EQUAL(std::string("UNKNOWN"), getDXGIFormatName((DXGI_FORMAT)9999));
+}
+
+TEST_CASE(surfaceBytes)
+{
+    CHECK_EQUAL(262144u, getDXGISurfaceBytes(DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256));
+    // Rows are whole bytes and packed formats whole texel pairs
+    CHECK_EQUAL(6u, getDXGISurfaceBytes(DXGI_FORMAT_R1_UNORM, 10, 3));
+    CHECK_EQUAL(24u, getDXGISurfaceBytes(DXGI_FORMAT_R8G8_B8G8_UNORM, 5, 2));
+
+    // 8 bytes a block for BC1 and BC4, 16 for the others, partial blocks round up
+    CHECK_EQUAL(32768u, getDXGISurfaceBytes(DXGI_FORMAT_BC1_UNORM, 256, 256));
+    CHECK_EQUAL(48u, getDXGISurfaceBytes(DXGI_FORMAT_BC4_UNORM, 6, 10));
+    CHECK_EQUAL(16u, getDXGISurfaceBytes(DXGI_FORMAT_BC3_UNORM, 4, 4));
+    CHECK_EQUAL(16u, getDXGISurfaceBytes(DXGI_FORMAT_BC7_UNORM, 1, 1));
+    CHECK_EQUAL(64u, getDXGISurfaceBytes(DXGI_FORMAT_BC6H_SF16, 5, 5));
+    CHECK_EQUAL(0u, getDXGISurfaceBytes(DXGI_FORMAT_BC1_UNORM, 0, 4));
+}
+
+TEST_CASE(textureBytes)
+{
+    // 256x256 down to 1x1 is nine mips, a third more than the top one
+    CHECK_EQUAL(349524u, getDXGITextureBytes(DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 0));
+    CHECK_EQUAL(262144u + 65536u, getDXGITextureBytes(DXGI_FORMAT_R8G8B8A8_UNORM, 256, 256, 1, 2));
+    // Mips below 4x4 still take a whole block
+    CHECK_EQUAL(43704u, getDXGITextureBytes(DXGI_FORMAT_BC1_UNORM, 256, 256, 1, 0));
+    CHECK_EQUAL(112u, getDXGITextureBytes(DXGI_FORMAT_BC7_UNORM, 8, 8, 1, 0));
+    // The short side stays at 1 while the long one keeps halving
+    CHECK_EQUAL(92u, getDXGITextureBytes(DXGI_FORMAT_R8G8B8A8_UNORM, 8, 2, 1, 0));
+    // More mips than the chain has stop at 1x1
+    CHECK_EQUAL(84u, getDXGITextureBytes(DXGI_FORMAT_R8G8B8A8_UNORM, 4, 4, 1, 10));
+
+    // Every slice holds the whole chain, a cubemap is six slices
+    CHECK_EQUAL(196608u, getDXGITextureBytes(DXGI_FORMAT_R16G16B16A16_FLOAT, 64, 64, 6, 1));
+    CHECK_EQUAL(262128u, getDXGITextureBytes(DXGI_FORMAT_R16G16B16A16_FLOAT, 64, 64, 6, 0));
+    CHECK_EQUAL(0u, getDXGITextureBytes(DXGI_FORMAT_R16G16B16A16_FLOAT, 64, 64, 0, 0));
+}
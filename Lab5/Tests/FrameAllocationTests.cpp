@@ -0,0 +1,106 @@
+#include "TestFramework.h"
+
+#include <atomic>
+#include <memory>
+#include "Engine/Profiling/TimingStats.h"
+#include "Utils/FrameArena.h"
+#include "Utils/JobSystem.h"
+#include "Utils/ThreadCounters.h"
+
+/*
+ * Linked with AllocationHooks.cpp, every operator new of every thread is counted
+ */
+
+namespace
+{
+    const uint32_t WARM_FRAMES_AMOUNT = 100;
+    const uint32_t FRAMES_AMOUNT = 500;
+    const uint32_t JOBS_PER_FRAME = 64;
+
+    /*
+     * What the engine does on its frame paths that must not touch the heap once warm: frame scratch vectors, arena
+     * resets, jobs through the submit pools and parallelFor, and timing summaries over frame scratch
+     */
+    class FrameWorkload
+    {
+    public:
+        explicit FrameWorkload(uint32_t threadsAmount) : jobs(threadsAmount)
+        {
+        }
+
+        JobSystem jobs;
+        LinearArena scratch;
+        RollingTimingStats timings;
+        std::atomic<uint64_t> workDone{0};
+        double summarySum = 0;
+
+        void runFrame(uint32_t frame)
+        {
+            FrameArena::getShared().beginFrame();
+
+            // Sizes change from frame to frame, within what the warm frames saw
+            FrameVector<uint32_t> visible;
+            for (uint32_t i = 0; i < 1000 + frame % 5 * 200; i++)
+            {
+                visible.push_back(i);
+            }
+
+            scratch.reset();
+            for (uint32_t i = 0; i < 64; i++)
+            {
+                scratch.allocate(256 + frame % 7 * 64, 16);
+            }
+
+            JobCounter counter;
+            std::atomic<uint64_t>* pWorkDone = &workDone;
+            for (uint32_t i = 0; i < JOBS_PER_FRAME; i++)
+            {
+                jobs.submit([pWorkDone]()
+                {
+                    pWorkDone->fetch_add(1, std::memory_order_relaxed);
+                }, &counter);
+            }
+            jobs.parallelFor((uint32_t)visible.size(), 16, [pWorkDone](uint32_t begin, uint32_t end)
+            {
+                pWorkDone->fetch_add(end - begin, std::memory_order_relaxed);
+            });
+            jobs.wait(counter);
+
+            timings.add(frame % 13);
+            summarySum += timings.getSummary().p99;
+        }
+    };
+}
+
+TEST_CASE(allocationsAreCounted)
+{
+    // Without the hooks every other test here would pass without measuring anything
+    uint64_t before = ThreadCounting::getProcessAllocationsAmount();
+    std::unique_ptr<int> allocated(new int(1));
+    CHECK_EQUAL(before + 1, ThreadCounting::getProcessAllocationsAmount());
+    CHECK_EQUAL(1, *allocated);
+}
+
+TEST_CASE(warmFramesAllocateNothing)
+{
+    const uint32_t threadsAmounts[] = {1, 3};
+    for (uint32_t threadsAmount : threadsAmounts)
+    {
+        FrameWorkload workload(threadsAmount);
+        uint32_t frame = 0;
+        for (; frame < WARM_FRAMES_AMOUNT; frame++)
+        {
+            workload.runFrame(frame);
+        }
+        uint64_t warmAllocationsAmount = ThreadCounting::getProcessAllocationsAmount();
+        uint64_t warmWorkDone = workload.workDone.load();
+        for (; frame < WARM_FRAMES_AMOUNT + FRAMES_AMOUNT; frame++)
+        {
+            workload.runFrame(frame);
+        }
+        uint64_t frameAllocationsAmount = ThreadCounting::getProcessAllocationsAmount() - warmAllocationsAmount;
+        CHECK_EQUAL((uint64_t)0, frameAllocationsAmount);
+        CHECK(workload.workDone.load() - warmWorkDone >= (uint64_t)FRAMES_AMOUNT * (JOBS_PER_FRAME + 1000));
+        CHECK(workload.summarySum > 0);
+    }
+}
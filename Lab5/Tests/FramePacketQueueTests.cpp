@@ -0,0 +1,138 @@
+#include "TestFramework.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "Engine/Threading/FramePacketQueue.h"
+
+TEST_CASE(packetsCirculate)
+{
+    CHECK_THROWS(FramePacketQueue(0), std::runtime_error);
+
+    FramePacketQueue queue(2);
+    FramePacket* first = queue.tryAcquire();
+    FramePacket* second = queue.tryAcquire();
+    REQUIRE(first && second && first != second);
+    // The producer is never blocked, it finds out every packet is in flight
+    CHECK(queue.tryAcquire() == nullptr);
+
+    first->pbrMode = 1;
+    queue.submit(first);
+    second->pbrMode = 2;
+    queue.submit(second);
+    const FramePacket* drawn = queue.waitNext();
+    REQUIRE(drawn == first);
+    CHECK_EQUAL(0u, drawn->frameIndex);
+    queue.release(drawn);
+
+    // A released packet comes back with the frame it carried
+    FramePacket* again = queue.tryAcquire();
+    REQUIRE(again == first);
+    CHECK_EQUAL(1, again->pbrMode);
+    CHECK(queue.tryAcquire() == nullptr);
+    queue.submit(again);
+
+    CHECK_EQUAL(1u, queue.waitNext()->frameIndex);
+    CHECK_EQUAL(2u, queue.waitNext()->frameIndex);
+}
+
+TEST_CASE(closeWakesTheConsumer)
+{
+    FramePacketQueue queue;
+    const FramePacket* result = queue.tryAcquire();
+    std::thread consumer([&]()
+    {
+        result = queue.waitNext();
+    });
+    // Gives the consumer time to fall asleep, the test passes either way but only tests the wakeup when it did
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.close();
+    consumer.join();
+    CHECK(result == nullptr);
+
+    // Packets submitted but not taken yet are dropped
+    queue.submit(queue.tryAcquire());
+    CHECK(queue.waitNext() == nullptr);
+}
+
+TEST_CASE(framesArriveInOrderWithoutLostWakeups)
+{
+    const uint64_t framesAmount = 20000;
+    for (uint32_t packetsAmount : {1u, 2u, 3u})
+    {
+        FramePacketQueue queue(packetsAmount);
+        // The producer sleeps while every packet is in flight the way the main thread does, so a lost release or
+        // submit shows up as a timeout instead of a hang
+        std::mutex releaseMutex;
+        std::condition_variable packetReleased;
+        queue.setReleaseCallback([&]()
+        {
+            std::lock_guard<std::mutex> lock(releaseMutex);
+            packetReleased.notify_one();
+        });
+
+        uint64_t drawnAmount = 0;
+        uint64_t mismatchedAmount = 0;
+        std::thread consumer([&]()
+        {
+            while (const FramePacket* packet = queue.waitNext())
+            {
+                mismatchedAmount += packet->frameIndex != drawnAmount || packet->pbrMode != (int)(drawnAmount % 7);
+                drawnAmount++;
+                // Every so often the consumer is slower, and every so often the producer
+                if (drawnAmount % 1000 == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+                queue.release(packet);
+            }
+        });
+
+        uint64_t timeoutsAmount = 0;
+        for (uint64_t frame = 0; frame < framesAmount && timeoutsAmount == 0; frame++)
+        {
+            FramePacket* packet = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(releaseMutex);
+                if (!packetReleased.wait_for(lock, std::chrono::seconds(10), [&]()
+                {
+                    return (packet = queue.tryAcquire()) != nullptr;
+                }))
+                {
+                    timeoutsAmount++;
+                    break;
+                }
+            }
+            packet->pbrMode = (int)(frame % 7);
+            queue.submit(packet);
+            if (frame % 1500 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+
+        // Waits until every packet came back before closing, closing drops what was not drawn yet
+        uint32_t returnedAmount = 0;
+        {
+            std::unique_lock<std::mutex> lock(releaseMutex);
+            std::vector<FramePacket*> returned;
+            packetReleased.wait_for(lock, std::chrono::seconds(10), [&]()
+            {
+                while (FramePacket* packet = queue.tryAcquire())
+                {
+                    returned.push_back(packet);
+                }
+                return returned.size() == packetsAmount;
+            });
+            returnedAmount = (uint32_t)returned.size();
+        }
+        queue.close();
+        consumer.join();
+        CHECK_EQUAL(0u, timeoutsAmount);
+        CHECK_EQUAL(packetsAmount, returnedAmount);
+        CHECK_EQUAL(framesAmount, drawnAmount);
+        CHECK_EQUAL(0u, mismatchedAmount);
+    }
+}
@@ -0,0 +1,298 @@
+#include "TestFramework.h"
+
+#include <stdexcept>
+#include <utility>
+#include "Engine/Profiling/GpuTimer.h"
+
+namespace
+{
+    // A million ticks per second, 1000 ticks are a millisecond
+    const uint64_t TICKS_PER_SECOND = 1000000;
+    const uint64_t TICKS_PER_MILLISECOND = TICKS_PER_SECOND / 1000;
+
+    /*
+     * Timestamps taken from a clock the test advances. Frames finish on the GPU in order and only when the test says
+     * so, until then reading them reports GPU_QUERY_NOT_READY.
+     */
+    class FakeTimestampQueries : public GpuTimestampQueries
+    {
+    public:
+        explicit FakeTimestampQueries(uint32_t timestampsAmount)
+        {
+            for (auto& slot : slots)
+            {
+                slot.timestamps.resize(timestampsAmount, 0);
+                slot.written.resize(timestampsAmount, 0);
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            uint64_t frame = 0;
+            bool disjoint = false;
+            std::vector<uint64_t> timestamps;
+            std::vector<uint8_t> written;
+        };
+
+        Slot slots[GPU_TIMER_FRAMES_IN_FLIGHT];
+        uint64_t framesAmount = 0;
+
+    public:
+        uint64_t clock = 0;
+        uint64_t finishedFramesAmount = 0;
+        // The next frame begun changes clock frequency on the way
+        bool nextFrameDisjoint = false;
+        // Readback of this timestamp fails once, as if its query was still pending
+        uint32_t pendingTimestamp = GPU_TIMER_NO_PASS;
+        uint32_t unwrittenReadsAmount = 0;
+
+        void beginFrame(uint32_t frameSlot) override
+        {
+            Slot& slot = slots[frameSlot];
+            slot.frame = framesAmount++;
+            slot.disjoint = nextFrameDisjoint;
+            nextFrameDisjoint = false;
+            std::fill(slot.written.begin(), slot.written.end(), (uint8_t)0);
+        }
+
+        void endFrame(uint32_t) override
+        {
+        }
+
+        void writeTimestamp(uint32_t, uint32_t frameSlot, uint32_t timestamp) override
+        {
+            slots[frameSlot].timestamps[timestamp] = clock;
+            slots[frameSlot].written[timestamp] = 1;
+        }
+
+        GpuQueryStatus readFrequency(uint32_t frameSlot, uint64_t* pFrequencyOutput) override
+        {
+            if (slots[frameSlot].frame >= finishedFramesAmount)
+            {
+                return GPU_QUERY_NOT_READY;
+            }
+            *pFrequencyOutput = TICKS_PER_SECOND;
+            return slots[frameSlot].disjoint ? GPU_QUERY_DISJOINT : GPU_QUERY_READY;
+        }
+
+        bool readTimestamp(uint32_t frameSlot, uint32_t timestamp, uint64_t* pTimestampOutput) override
+        {
+            if (timestamp == pendingTimestamp)
+            {
+                pendingTimestamp = GPU_TIMER_NO_PASS;
+                return false;
+            }
+            unwrittenReadsAmount += !slots[frameSlot].written[timestamp];
+            *pTimestampOutput = slots[frameSlot].timestamps[timestamp];
+            return true;
+        }
+
+        void advance(double milliseconds)
+        {
+            clock += (uint64_t)(milliseconds * TICKS_PER_MILLISECOND);
+        }
+    };
+
+    const ProfileZoneDesc SHADOWS = {"Shadows", L"Shadows", __FILE__, __LINE__};
+    const ProfileZoneDesc BLUR = {"Blur", L"Blur", __FILE__, __LINE__};
+    const ProfileZoneDesc TONE_MAP = {"Tone map", L"Tone map", __FILE__, __LINE__};
+
+    /*
+     * One frame of 10 ms with a 2 ms shadow pass on context 0
+     */
+    void recordFrame(GpuTimer& timer, FakeTimestampQueries& queries, double shadowMilliseconds = 2.0)
+    {
+        timer.beginFrame();
+        queries.advance(1.0);
+        timer.beginPass(0, &SHADOWS);
+        queries.advance(shadowMilliseconds);
+        timer.endPass(0);
+        queries.advance(9.0 - shadowMilliseconds);
+        timer.endFrame();
+    }
+
+    TimingSummary getSummary(const GpuTimer& timer, const std::string& name)
+    {
+        std::vector<GpuPassTiming> timings;
+        timer.getTimings(timings);
+        for (auto& timing : timings)
+        {
+            if (timing.name == name)
+            {
+                return timing.summary;
+            }
+        }
+        return TimingSummary();
+    }
+}
+
+TEST_CASE(framesAreReadOnceTheGpuFinishedThem)
+{
+    FakeTimestampQueries queries(GpuTimer::getTimestampsAmount(4));
+    GpuTimer timer(&queries, 4, 1);
+    timer.setPasses({&SHADOWS});
+
+    // Frames are only read back at the next beginFrame after the GPU finished them, never waited for
+    recordFrame(timer, queries);
+    recordFrame(timer, queries);
+    recordFrame(timer, queries);
+    CHECK_EQUAL(0u, getSummary(timer, "Frame").samplesAmount);
+    queries.finishedFramesAmount = 2;
+    CHECK_EQUAL(0u, getSummary(timer, "Frame").samplesAmount);
+    recordFrame(timer, queries, 4.0);
+    TimingSummary frame = getSummary(timer, "Frame");
+    CHECK_EQUAL(2u, frame.samplesAmount);
+    CHECK_EQUAL(10.0, frame.last);
+    CHECK_EQUAL(2.0, getSummary(timer, "Shadows").last);
+
+    // A timestamp that is not available yet leaves the whole frame for the next try
+    queries.finishedFramesAmount = 4;
+    queries.pendingTimestamp = GPU_TIMER_PASS_END(0);
+    timer.beginFrame();
+    timer.endFrame();
+    CHECK_EQUAL(2u, getSummary(timer, "Frame").samplesAmount);
+    CHECK_EQUAL(2u, getSummary(timer, "Shadows").samplesAmount);
+    timer.beginFrame();
+    timer.endFrame();
+    CHECK_EQUAL(4u, getSummary(timer, "Frame").samplesAmount);
+    CHECK_EQUAL(4.0, getSummary(timer, "Shadows").last);
+    CHECK_EQUAL(0u, timer.getDroppedFramesAmount());
+    CHECK_EQUAL(0u, queries.unwrittenReadsAmount);
+
+    timer.beginFrame();
+    CHECK_THROWS(timer.beginFrame(), std::runtime_error);
+    timer.endFrame();
+    CHECK_THROWS(timer.endFrame(), std::runtime_error);
+}
+
+TEST_CASE(framesAreDroppedWhenTheRingIsFull)
+{
+    FakeTimestampQueries queries(GpuTimer::getTimestampsAmount(4));
+    GpuTimer timer(&queries, 4, 1);
+    timer.setPasses({&SHADOWS});
+
+    // The GPU falls behind, every frame past the ring takes the slot of the oldest one instead of waiting for it
+    const uint32_t framesAmount = 10;
+    for (uint32_t i = 0; i < framesAmount; i++)
+    {
+        recordFrame(timer, queries, 1.0 + i);
+        uint32_t expectedDrops = i + 1 > GPU_TIMER_FRAMES_IN_FLIGHT ? i + 1 - GPU_TIMER_FRAMES_IN_FLIGHT : 0;
+        CHECK_EQUAL((uint64_t)expectedDrops, timer.getDroppedFramesAmount());
+    }
+    // The frames still in the ring are the last ones, read with their own timestamps
+    queries.finishedFramesAmount = framesAmount;
+    timer.beginFrame();
+    timer.endFrame();
+    TimingSummary shadows = getSummary(timer, "Shadows");
+    CHECK_EQUAL(GPU_TIMER_FRAMES_IN_FLIGHT, shadows.samplesAmount);
+    CHECK_EQUAL(7.0, shadows.min);
+    CHECK_EQUAL(10.0, shadows.last);
+    CHECK_EQUAL(0u, queries.unwrittenReadsAmount);
+}
+
+TEST_CASE(disjointFramesAreSkipped)
+{
+    FakeTimestampQueries queries(GpuTimer::getTimestampsAmount(4));
+    GpuTimer timer(&queries, 4, 1);
+    timer.setPasses({&SHADOWS});
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        queries.nextFrameDisjoint = i == 1 || i == 4;
+        recordFrame(timer, queries, i == 1 || i == 4 ? 50.0 : 2.0);
+        queries.finishedFramesAmount = i + 1;
+    }
+    timer.beginFrame();
+    timer.endFrame();
+    CHECK_EQUAL(2u, timer.getDisjointFramesAmount());
+    TimingSummary shadows = getSummary(timer, "Shadows");
+    CHECK_EQUAL(4u, shadows.samplesAmount);
+    CHECK_EQUAL(2.0, shadows.p99);
+    CHECK_EQUAL(0u, timer.getDroppedFramesAmount());
+}
+
+TEST_CASE(passesAreTimedByPosition)
+{
+    // Blur runs twice on one context and is told apart by its position, the tone map is past maxPasses
+    const uint32_t maxPasses = 3;
+    FakeTimestampQueries queries(GpuTimer::getTimestampsAmount(maxPasses));
+    GpuTimer timer(&queries, maxPasses, 2);
+    timer.setPasses({&SHADOWS, &BLUR, &BLUR, &TONE_MAP});
+
+    timer.beginFrame();
+    timer.beginPass(1, &SHADOWS);
+    queries.advance(2.0);
+    timer.endPass(1);
+    timer.beginPass(0, &BLUR);
+    queries.advance(1.0);
+    timer.endPass(0);
+    timer.beginPass(0, &BLUR);
+    queries.advance(3.0);
+    timer.endPass(0);
+    timer.beginPass(0, &TONE_MAP);
+    queries.advance(4.0);
+    timer.endPass(0);
+    // A pass the context already ran is not timed again
+    timer.beginPass(1, &SHADOWS);
+    timer.endPass(1);
+    timer.endFrame();
+    queries.finishedFramesAmount = 1;
+    timer.beginFrame();
+    timer.endFrame();
+
+    std::vector<GpuPassTiming> timings;
+    timer.getTimings(timings);
+    REQUIRE(timings.size() == 3);
+    CHECK_EQUAL(std::string("Frame"), timings[0].name);
+    CHECK_EQUAL(10.0, timings[0].summary.last);
+    CHECK_EQUAL(std::string("Shadows"), timings[1].name);
+    CHECK_EQUAL(2.0, timings[1].summary.last);
+    // Both blurs feed the same statistics, the tone map has none
+    CHECK_EQUAL(std::string("Blur"), timings[2].name);
+    CHECK_EQUAL(2u, timings[2].summary.samplesAmount);
+    CHECK_EQUAL(1.0, timings[2].summary.min);
+    CHECK_EQUAL(2.0, timings[2].summary.average);
+    CHECK_EQUAL(0u, queries.unwrittenReadsAmount);
+}
+
+TEST_CASE(rollingStatsOverSmallWindows)
+{
+    CHECK_THROWS(RollingTimingStats(0), std::runtime_error);
+    RollingTimingStats empty;
+    CHECK_EQUAL(0u, empty.getSummary().samplesAmount);
+    CHECK_EQUAL(0.0, empty.getSummary().p99);
+
+    // Nearest rank, ceil(0.99 n): the largest sample below 100 samples, then one rank lower every 100
+    const std::pair<uint32_t, double> windows[] = {{1, 1}, {2, 2}, {10, 10}, {99, 99}, {100, 99}, {101, 100},
+                                                   {200, 198}};
+    for (auto& windowP99 : windows)
+    {
+        uint32_t window = windowP99.first;
+        RollingTimingStats stats(window);
+        for (uint32_t i = window; i >= 1; i--)
+        {
+            stats.add(i);
+        }
+        TimingSummary summary = stats.getSummary();
+        CHECK_EQUAL(window, summary.samplesAmount);
+        CHECK_EQUAL(1.0, summary.min);
+        CHECK_EQUAL(1.0, summary.last);
+        CHECK_EQUAL((window + 1) / 2.0, summary.average);
+        CHECK_EQUAL(windowP99.second, summary.p99);
+    }
+
+    // Only the newest samples count once the window is full
+    RollingTimingStats stats(4);
+    for (uint32_t i = 1; i <= 10; i++)
+    {
+        stats.add(i);
+    }
+    TimingSummary summary = stats.getSummary();
+    CHECK_EQUAL(4u, summary.samplesAmount);
+    CHECK_EQUAL(7.0, summary.min);
+    CHECK_EQUAL(10.0, summary.last);
+    CHECK_EQUAL(8.5, summary.average);
+    CHECK_EQUAL(10.0, summary.p99);
+    stats.clear();
+    CHECK_EQUAL(0u, stats.getSummary().samplesAmount);
+}
@@ -0,0 +1,82 @@
+#include "TestFramework.h"
+
+#include "../Tools/HeadlessFrame/HeadlessScene.h"
+
+// A 4 x 4 material grid, the orbiting camera sees all of it
+#define TEST_GRID_SIZE 4
+#define TEST_SCATTERED_LIGHTS 16
+#define TEST_INSTANCES (TEST_GRID_SIZE * TEST_GRID_SIZE)
+// Two triangles per quad of the sphere, 32 segments by 16 rings
+#define TEST_SPHERE_INDICES (HEADLESS_SPHERE_SEGMENTS * HEADLESS_SPHERE_SEGMENTS / 2 * 6)
+// Render targets and viewport, 11 binds for the skybox and 17 for the spheres, see SceneRenderer::drawSkybox and
+// drawSpheres. Programs are vertex shader, pixel shader and layout, a mesh is vertex buffer, index buffer and
+// topology.
+#define TEST_FRAME_BINDS 30u
+
+namespace
+{
+    const NullGraphicsStats& drawFrame(HeadlessScene& headless, uint32_t frame)
+    {
+        NullGraphicsContext* context = headless.getDevice().getNullContext();
+        headless.drawFrame(headless.makeView(frame));
+        context->beginFrame();
+        return context->getLastFrameCalls();
+    }
+}
+
+TEST_CASE(frameRecordsTheSceneCalls)
+{
+    HeadlessScene headless(TEST_GRID_SIZE, TEST_SCATTERED_LIGHTS);
+    const NullGraphicsStats& calls = drawFrame(headless, 0);
+
+    REQUIRE(headless.getScene().getInstancesAmount() == TEST_INSTANCES);
+    CHECK_EQUAL(TEST_INSTANCES, (int)headless.getScene().getVisibleInstancesAmount());
+    // The skybox sphere and one instanced draw of the grid
+    CHECK_EQUAL(2u, calls.drawCalls);
+    CHECK_EQUAL(1u + TEST_INSTANCES, calls.drawnInstances);
+    CHECK_EQUAL((1u + TEST_INSTANCES) * TEST_SPHERE_INDICES, calls.drawnIndices);
+    // Color and depth before the skybox, depth again after it
+    CHECK_EQUAL(3u, calls.clearCalls);
+    // Constant ring, instances, lights, cluster ranges and light indices
+    CHECK_EQUAL(5u, calls.mapCalls);
+    // Only the light constants changed from their initial contents, all three registers of them
+    CHECK_EQUAL(1u, calls.updateCalls);
+    CHECK_EQUAL((uint64_t)sizeof(LightConstant), calls.uploadedBytes);
+    // The constant ring fences its frame
+    CHECK_EQUAL(1u, calls.fenceSignals);
+}
+
+TEST_CASE(firstFrameIssuesEveryNewBinding)
+{
+    HeadlessScene headless(TEST_GRID_SIZE, TEST_SCATTERED_LIGHTS);
+    drawFrame(headless, 0);
+    const StateTrackerStats& stats = headless.getDevice().getNullContext()->getLastFrameStats();
+
+    CHECK_EQUAL(TEST_FRAME_BINDS, stats.issuedCalls + stats.filteredCalls);
+    // The spheres share the input layout of the skybox and bind the same mesh again
+    CHECK_EQUAL(4u, stats.filteredCalls);
+}
+
+TEST_CASE(laterFramesOnlyRebindWhatTheSkyboxChanged)
+{
+    HeadlessScene headless(TEST_GRID_SIZE, TEST_SCATTERED_LIGHTS);
+    drawFrame(headless, 0);
+    uint32_t buffersAmount = headless.getDevice().getLiveBuffersAmount();
+    uint64_t bufferBytes = headless.getDevice().getLiveBufferBytes();
+
+    for (uint32_t frame = 1; frame < 4; frame++)
+    {
+        const NullGraphicsStats& calls = drawFrame(headless, frame);
+        const StateTrackerStats& stats = headless.getDevice().getNullContext()->getLastFrameStats();
+        CHECK_EQUAL(TEST_FRAME_BINDS, stats.issuedCalls + stats.filteredCalls);
+        // Each pass switches shaders, the per draw constants, the first view, depth and raster state. Targets,
+        // viewport, meshes, the layout, samplers and the light buffers stay from the previous frame.
+        CHECK_EQUAL(12u, stats.issuedCalls);
+        // The camera moved, the register holding its position is uploaded
+        CHECK_EQUAL(1u, calls.updateCalls);
+        CHECK_EQUAL((uint64_t)sizeof(XMFLOAT4), calls.uploadedBytes);
+        CHECK_EQUAL(2u, calls.drawCalls);
+    }
+    CHECK_EQUAL(buffersAmount, headless.getDevice().getLiveBuffersAmount());
+    CHECK_EQUAL(bufferBytes, headless.getDevice().getLiveBufferBytes());
+}
@@ -0,0 +1,171 @@
+#include "TestFramework.h"
+
+#include <stdexcept>
+#include <utility>
+#include "Window/InputDispatcher.h"
+
+// Found by argument dependent lookup from the comparisons of std::vector
+static bool operator==(const WindowKey& a, const WindowKey& b)
+{
+    return a.key == b.key && a.action == b.action;
+}
+
+namespace
+{
+    /*
+     * Subscribes to a fixed list of keys and keeps every call it gets, one list of events per call
+     */
+    class RecordingKeyCallback : public IWindowKeyCallback
+    {
+    public:
+        explicit RecordingKeyCallback(std::vector<WindowKey> keys) : keys(std::move(keys))
+        {
+        }
+
+        std::vector<WindowKey> keys;
+        std::vector<std::vector<WindowKey>> calls;
+
+        void keyEvents(const WindowKey* pKeys, uint32_t keysAmount) override
+        {
+            calls.emplace_back(pKeys, pKeys + keysAmount);
+        }
+
+        WindowKey* getKeys(uint32_t* pKeysAmountOut) override
+        {
+            *pKeysAmountOut = (uint32_t)keys.size();
+            return keys.data();
+        }
+
+        /*
+         * The events of the only call since the last take, empty when there was none
+         */
+        std::vector<WindowKey> takeEvents()
+        {
+            std::vector<WindowKey> events = calls.empty() ? std::vector<WindowKey>() : calls.back();
+            CHECK(calls.size() <= 1);
+            calls.clear();
+            return events;
+        }
+    };
+
+    class RecordingMouseCallback : public IWindowMouseCallback
+    {
+    public:
+        std::vector<std::pair<int32_t, int32_t>> moves;
+
+        void mouseMove(int32_t x, int32_t y) override
+        {
+            moves.emplace_back(x, y);
+        }
+    };
+
+    typedef std::vector<WindowKey> Events;
+    typedef std::vector<std::pair<int32_t, int32_t>> Moves;
+
+    InputSnapshot makeSnapshot(std::initializer_list<uint32_t> downKeys)
+    {
+        InputSnapshot snapshot;
+        for (uint32_t key : downKeys)
+        {
+            snapshot.setKey(key, true);
+        }
+        return snapshot;
+    }
+
+    // DIK_W, DIK_F1 and DIK_DELETE, dinput.h is Windows only
+    const uint32_t KEY_W = 0x11;
+    const uint32_t KEY_F1 = 0x3B;
+    const uint32_t KEY_DELETE = 0xD3;
+}
+
+TEST_CASE(edgesFireOnceAndHeldKeysEveryFrame)
+{
+    InputDispatcher dispatcher;
+    RecordingKeyCallback callback({{KEY_W, KEY_DOWN}, {KEY_F1, KEY_PRESSED}, {KEY_F1, KEY_UP}});
+    dispatcher.addKeyCallback(&callback);
+
+    dispatcher.dispatch(makeSnapshot({KEY_W, KEY_F1}));
+    CHECK(callback.takeEvents() == Events({{KEY_W, KEY_DOWN}, {KEY_F1, KEY_PRESSED}}));
+    // Holding F1 gives no more edges, W keeps reporting while it is down
+    dispatcher.dispatch(makeSnapshot({KEY_W, KEY_F1}));
+    CHECK(callback.takeEvents() == Events({{KEY_W, KEY_DOWN}}));
+    dispatcher.dispatch(makeSnapshot({KEY_W}));
+    CHECK(callback.takeEvents() == Events({{KEY_W, KEY_DOWN}, {KEY_F1, KEY_UP}}));
+    // Releasing W reports nothing, it only asked for KEY_DOWN
+    dispatcher.dispatch(makeSnapshot({}));
+    CHECK(callback.calls.empty());
+    dispatcher.dispatch(makeSnapshot({}));
+    CHECK(callback.calls.empty());
+
+    // A press and release on consecutive frames are two edges
+    dispatcher.dispatch(makeSnapshot({KEY_F1}));
+    dispatcher.dispatch(makeSnapshot({}));
+    CHECK(callback.calls == std::vector<Events>({{{KEY_F1, KEY_PRESSED}}, {{KEY_F1, KEY_UP}}}));
+    CHECK_EQUAL(7u, dispatcher.getDispatchedEventsAmount());
+}
+
+TEST_CASE(unmappedKeysAreFiltered)
+{
+    InputDispatcher dispatcher;
+    RecordingKeyCallback callback({{KEY_F1, KEY_PRESSED}, {INPUT_MOUSE_RIGHT, KEY_UP}});
+    dispatcher.addKeyCallback(&callback);
+
+    // Keys nobody subscribed to, and actions on a key nobody asked for, never reach a callback
+    dispatcher.dispatch(makeSnapshot({KEY_W, KEY_DELETE, INPUT_MOUSE_LEFT, INPUT_MOUSE_RIGHT}));
+    CHECK(callback.calls.empty());
+    dispatcher.dispatch(makeSnapshot({KEY_W}));
+    CHECK(callback.takeEvents() == Events({{INPUT_MOUSE_RIGHT, KEY_UP}}));
+    dispatcher.dispatch(makeSnapshot({}));
+    CHECK(callback.calls.empty());
+    CHECK_EQUAL(1u, dispatcher.getDispatchedEventsAmount());
+    CHECK(!dispatcher.getLastSnapshot().isDown(KEY_W));
+
+    RecordingKeyCallback outOfRange({{INPUT_KEYS_AMOUNT, KEY_PRESSED}});
+    CHECK_THROWS(dispatcher.addKeyCallback(&outOfRange), std::runtime_error);
+}
+
+TEST_CASE(eventsAreBatchedPerCallbackAndOrderedByKey)
+{
+    InputDispatcher dispatcher;
+    // Subscribed out of order and spread over several words of the snapshot
+    RecordingKeyCallback first({
+        {INPUT_MOUSE_MIDDLE, KEY_PRESSED}, {KEY_DELETE, KEY_PRESSED}, {KEY_W, KEY_PRESSED}, {KEY_F1, KEY_DOWN}
+    });
+    RecordingKeyCallback second({{KEY_F1, KEY_PRESSED}, {KEY_W, KEY_DOWN}});
+    RecordingKeyCallback idle({{KEY_DELETE, KEY_UP}});
+    dispatcher.addKeyCallback(&first);
+    dispatcher.addKeyCallback(&second);
+    dispatcher.addKeyCallback(&idle);
+
+    dispatcher.dispatch(makeSnapshot({INPUT_MOUSE_MIDDLE, KEY_DELETE, KEY_F1, KEY_W}));
+    CHECK(first.takeEvents() == Events({
+        {KEY_W, KEY_PRESSED}, {KEY_F1, KEY_DOWN}, {KEY_DELETE, KEY_PRESSED}, {INPUT_MOUSE_MIDDLE, KEY_PRESSED}
+    }));
+    CHECK(second.takeEvents() == Events({{KEY_W, KEY_DOWN}, {KEY_F1, KEY_PRESSED}}));
+    // A callback without events this frame is not called at all
+    CHECK(idle.calls.empty());
+
+    dispatcher.dispatch(makeSnapshot({KEY_F1, KEY_W}));
+    CHECK(first.takeEvents() == Events({{KEY_F1, KEY_DOWN}}));
+    CHECK(second.takeEvents() == Events({{KEY_W, KEY_DOWN}}));
+    CHECK(idle.takeEvents() == Events({{KEY_DELETE, KEY_UP}}));
+}
+
+TEST_CASE(mouseMovesOnlyWhenTheCursorMoved)
+{
+    InputDispatcher dispatcher;
+    RecordingMouseCallback mouse;
+    dispatcher.addMouseCallback(&mouse);
+    InputSnapshot snapshot;
+    dispatcher.dispatch(snapshot);
+    snapshot.mouseX = 10;
+    snapshot.mouseY = 20;
+    dispatcher.dispatch(snapshot);
+    dispatcher.dispatch(snapshot);
+    snapshot.setKey(INPUT_MOUSE_LEFT, true);
+    dispatcher.dispatch(snapshot);
+    snapshot.mouseY = 21;
+    dispatcher.dispatch(snapshot);
+    CHECK(mouse.moves == Moves({{10, 20}, {10, 21}}));
+    CHECK(dispatcher.getLastSnapshot().isDown(INPUT_MOUSE_LEFT));
+}
@@ -0,0 +1,285 @@
+#include "TestFramework.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include "Utils/JobSystem.h"
+#include "Utils/WorkStealingDeque.h"
+
+namespace
+{
+    const uint32_t THREADS_AMOUNTS[] = {1, 2, 3, 8};
+
+    /*
+     * Every item has to be taken exactly once, counts start at zero
+     */
+    bool isTakenOnce(const std::unique_ptr<std::atomic<uint32_t>[]>& taken, uint32_t amount)
+    {
+        for (uint32_t i = 0; i < amount; i++)
+        {
+            if (taken[i].load() != 1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE(dequeOwnerIsLifoThievesAreFifo)
+{
+    WorkStealingDeque<uint32_t> deque(2);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        deque.push(i);
+    }
+    uint32_t item = 0;
+    REQUIRE(deque.steal(item));
+    CHECK_EQUAL(0u, item);
+    REQUIRE(deque.pop(item));
+    CHECK_EQUAL(99u, item);
+    REQUIRE(deque.steal(item));
+    CHECK_EQUAL(1u, item);
+
+    uint32_t remaining = 0;
+    while (deque.pop(item))
+    {
+        remaining++;
+    }
+    CHECK_EQUAL(97u, remaining);
+    CHECK(!deque.pop(item));
+    CHECK(!deque.steal(item));
+}
+
+TEST_CASE(dequeItemsAreTakenOnceUnderStealing)
+{
+    const uint32_t itemsAmount = 200000;
+    const uint32_t thievesAmount = 3;
+    for (uint32_t round = 0; round < 5; round++)
+    {
+        // Starts small so the owner grows the buffer while thieves read from the old one
+        WorkStealingDeque<uint32_t> deque(2);
+        std::unique_ptr<std::atomic<uint32_t>[]> taken(new std::atomic<uint32_t>[itemsAmount]);
+        for (uint32_t i = 0; i < itemsAmount; i++)
+        {
+            taken[i].store(0);
+        }
+        std::atomic<bool> ownerDone{false};
+
+        std::vector<std::thread> thieves;
+        for (uint32_t thief = 0; thief < thievesAmount; thief++)
+        {
+            thieves.emplace_back([&]()
+            {
+                uint32_t item = 0;
+                while (!ownerDone.load(std::memory_order_acquire))
+                {
+                    if (deque.steal(item))
+                    {
+                        taken[item].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            });
+        }
+
+        // Bursts of pushes followed by fewer pops keep the deque near empty, where pop and steal race for the last
+        // item
+        uint32_t item = 0;
+        for (uint32_t next = 0; next < itemsAmount;)
+        {
+            uint32_t burst = next % 7 + 1;
+            for (uint32_t i = 0; i < burst && next < itemsAmount; i++)
+            {
+                deque.push(next++);
+            }
+            for (uint32_t i = 0; i < burst / 2 + 1; i++)
+            {
+                if (deque.pop(item))
+                {
+                    taken[item].fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        while (deque.pop(item))
+        {
+            taken[item].fetch_add(1, std::memory_order_relaxed);
+        }
+        ownerDone.store(true, std::memory_order_release);
+        for (auto& thief : thieves)
+        {
+            thief.join();
+        }
+        CHECK(isTakenOnce(taken, itemsAmount));
+        CHECK(!deque.steal(item));
+    }
+}
+
+TEST_CASE(parallelForCoversEveryIndexOnce)
+{
+    const uint32_t counts[] = {1, 2, 63, 1000, 100003};
+    const uint32_t grains[] = {1, 7, 5000};
+    for (uint32_t threadsAmount : THREADS_AMOUNTS)
+    {
+        JobSystem jobs(threadsAmount);
+        for (uint32_t count : counts)
+        {
+            for (uint32_t grain : grains)
+            {
+                std::unique_ptr<std::atomic<uint32_t>[]> taken(new std::atomic<uint32_t>[count]);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    taken[i].store(0);
+                }
+                std::atomic<bool> emptyRange{false};
+                jobs.parallelFor(count, grain, [&](uint32_t begin, uint32_t end)
+                {
+                    if (begin >= end)
+                    {
+                        emptyRange.store(true);
+                    }
+                    for (uint32_t i = begin; i < end; i++)
+                    {
+                        taken[i].fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+                CHECK(isTakenOnce(taken, count));
+                CHECK(!emptyRange.load());
+            }
+        }
+        bool called = false;
+        jobs.parallelFor(0, 1, [&](uint32_t, uint32_t)
+        {
+            called = true;
+        });
+        CHECK(!called);
+    }
+}
+
+TEST_CASE(parallelForNestsAndRethrows)
+{
+    for (uint32_t threadsAmount : THREADS_AMOUNTS)
+    {
+        JobSystem jobs(threadsAmount);
+        for (uint32_t round = 0; round < 20; round++)
+        {
+            // Waiting inside a job runs other jobs instead of blocking the worker
+            std::atomic<uint64_t> sum{0};
+            jobs.parallelFor(64, 1, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    jobs.parallelFor(1000, 1, [&](uint32_t innerBegin, uint32_t innerEnd)
+                    {
+                        sum.fetch_add(innerEnd - innerBegin, std::memory_order_relaxed);
+                    });
+                }
+            });
+            CHECK_EQUAL(64000u, sum.load());
+
+            CHECK_THROWS(jobs.parallelFor(1000, 1, [](uint32_t begin, uint32_t end)
+            {
+                if (begin <= 500 && 500 < end)
+                {
+                    throw std::runtime_error("Range failed");
+                }
+            }), std::runtime_error);
+        }
+    }
+}
+
+TEST_CASE(dependentJobsRunInOrder)
+{
+    for (uint32_t threadsAmount : THREADS_AMOUNTS)
+    {
+        JobSystem jobs(threadsAmount);
+        for (uint32_t round = 0; round < 50; round++)
+        {
+            JobCounter first, second, third;
+            std::atomic<uint32_t> stage{0};
+            std::atomic<uint32_t> earlyJobs{0};
+            for (uint32_t i = 0; i < 20; i++)
+            {
+                jobs.submit([&]()
+                {
+                    if (stage.load() != 0)
+                    {
+                        earlyJobs.fetch_add(1);
+                    }
+                }, &first);
+            }
+            jobs.submitAfter(first, [&]()
+            {
+                stage.store(1);
+            }, &second);
+            jobs.submitAfter(second, [&]()
+            {
+                stage.store(stage.load() == 1 ? 2 : 0);
+            }, &third);
+            jobs.wait(third);
+            CHECK_EQUAL(2u, stage.load());
+            CHECK_EQUAL(0u, earlyJobs.load());
+            CHECK(first.isDone());
+        }
+    }
+}
+
+TEST_CASE(jobsFromManyThreadsAllRun)
+{
+    const uint32_t submittersAmount = 4;
+    const uint32_t jobsPerSubmitter = 2000;
+    for (uint32_t threadsAmount : THREADS_AMOUNTS)
+    {
+        JobSystem jobs(threadsAmount);
+        uint64_t executedBefore = jobs.getStats().executedJobs;
+        for (uint32_t round = 0; round < 10; round++)
+        {
+            // Jobs that submit more jobs push to their worker's deque, the others go through the external queue
+            JobCounter counter;
+            std::atomic<uint32_t> executed{0};
+            std::vector<std::thread> submitters;
+            for (uint32_t submitter = 0; submitter < submittersAmount; submitter++)
+            {
+                submitters.emplace_back([&]()
+                {
+                    for (uint32_t i = 0; i < jobsPerSubmitter / 2; i++)
+                    {
+                        jobs.submit([&]()
+                        {
+                            executed.fetch_add(1, std::memory_order_relaxed);
+                            jobs.submit([&]()
+                            {
+                                executed.fetch_add(1, std::memory_order_relaxed);
+                            }, &counter);
+                        }, &counter);
+                    }
+                });
+            }
+            for (auto& submitter : submitters)
+            {
+                submitter.join();
+            }
+            jobs.wait(counter);
+            CHECK_EQUAL(submittersAmount * jobsPerSubmitter, executed.load());
+        }
+        CHECK_EQUAL(executedBefore + 10 * submittersAmount * jobsPerSubmitter, jobs.getStats().executedJobs);
+
+        // Idle workers fell asleep in between, a single job from outside has to wake one up
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        JobCounter counter;
+        std::atomic<bool> ran{false};
+        jobs.submit([&]()
+        {
+            ran.store(true);
+        }, &counter);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (threadsAmount > 1 && !ran.load() && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        CHECK(threadsAmount == 1 || ran.load());
+        jobs.wait(counter);
+        CHECK(ran.load());
+    }
+}
@@ -0,0 +1,297 @@
+#include "RecordingGraphicsContext.h"
+
+RecordingGraphicsContext::RecordingGraphicsContext(uint32_t mappedBytes) : mappedMemory(mappedBytes)
+{
+}
+
+void RecordingGraphicsContext::nameHandle(StateHandle handle, const std::string& name)
+{
+    namedHandles.push_back(handle);
+    handleNames.push_back(name);
+}
+
+const std::vector<std::string>& RecordingGraphicsContext::getCalls() const
+{
+    return calls;
+}
+
+std::vector<std::string> RecordingGraphicsContext::takeCalls()
+{
+    std::vector<std::string> taken;
+    taken.swap(calls);
+    return taken;
+}
+
+const std::vector<uint8_t>& RecordingGraphicsContext::getMappedMemory() const
+{
+    return mappedMemory;
+}
+
+void RecordingGraphicsContext::holdFences(bool hold)
+{
+    holdingFences = hold;
+}
+
+void RecordingGraphicsContext::completeFence(StateHandle fence)
+{
+    for (size_t i = 0; i < pendingFences.size(); i++)
+    {
+        if (pendingFences[i] == fence)
+        {
+            pendingFences.erase(pendingFences.begin() + i);
+            return;
+        }
+    }
+}
+
+void RecordingGraphicsContext::setShader(StateTrackerStage stage, StateHandle shader)
+{
+    if (tracker.setShader(stage, shader))
+    {
+        calls.push_back(std::string("setShader ") + getStageName(stage) + " " + getName(shader));
+    }
+}
+
+void RecordingGraphicsContext::setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                                  const StateHandle* pViews)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    if (tracker.setShaderResources(stage, start, amount, pViews, issueStart, issueAmount))
+    {
+        calls.push_back(std::string("setShaderResources ") + getStageName(stage) + " " +
+            std::to_string(issueStart) + getNames(issueAmount, pViews ? pViews + (issueStart - start) : nullptr));
+    }
+}
+
+void RecordingGraphicsContext::setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                           const StateHandle* pSamplers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    if (tracker.setSamplers(stage, start, amount, pSamplers, issueStart, issueAmount))
+    {
+        calls.push_back(std::string("setSamplers ") + getStageName(stage) + " " + std::to_string(issueStart) +
+            getNames(issueAmount, pSamplers ? pSamplers + (issueStart - start) : nullptr));
+    }
+}
+
+void RecordingGraphicsContext::setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                                                  const StateConstantBuffer* pBuffers)
+{
+    uint32_t issueStart;
+    uint32_t issueAmount;
+    if (!tracker.setConstantBuffers(stage, start, amount, pBuffers, issueStart, issueAmount))
+    {
+        return;
+    }
+    std::string call = std::string("setConstantBuffers ") + getStageName(stage) + " " + std::to_string(issueStart);
+    for (uint32_t i = 0; i < issueAmount; i++)
+    {
+        const StateConstantBuffer& binding = pBuffers[issueStart - start + i];
+        call += " " + getName(binding.buffer);
+        if (binding.constantsAmount)
+        {
+            call += "[" + std::to_string(binding.firstConstant) + "+" + std::to_string(binding.constantsAmount) + "]";
+        }
+    }
+    calls.push_back(call);
+}
+
+void RecordingGraphicsContext::setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView)
+{
+    if (tracker.setRenderTargets(amount, pViews, depthView))
+    {
+        calls.push_back("setRenderTargets" + getNames(amount, pViews) + " depth " + getName(depthView));
+    }
+}
+
+void RecordingGraphicsContext::setDepthStencilState(StateHandle state, uint32_t stencilRef)
+{
+    if (tracker.setDepthStencilState(state, stencilRef))
+    {
+        calls.push_back("setDepthStencilState " + getName(state) + " " + std::to_string(stencilRef));
+    }
+}
+
+void RecordingGraphicsContext::setRasterizerState(StateHandle state)
+{
+    if (tracker.setRasterizerState(state))
+    {
+        calls.push_back("setRasterizerState " + getName(state));
+    }
+}
+
+void RecordingGraphicsContext::setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask)
+{
+    if (tracker.setBlendState(state, pBlendFactor, sampleMask))
+    {
+        calls.push_back("setBlendState " + getName(state));
+    }
+}
+
+void RecordingGraphicsContext::setViewport(const StateViewport& viewport)
+{
+    if (tracker.setViewport(viewport))
+    {
+        calls.push_back("setViewport " + std::to_string((int)viewport.width) + "x" +
+            std::to_string((int)viewport.height));
+    }
+}
+
+void RecordingGraphicsContext::setInputLayout(StateHandle layout)
+{
+    if (tracker.setInputLayout(layout))
+    {
+        calls.push_back("setInputLayout " + getName(layout));
+    }
+}
+
+void RecordingGraphicsContext::setPrimitiveTopology(uint32_t topology)
+{
+    if (tracker.setPrimitiveTopology(topology))
+    {
+        calls.push_back("setPrimitiveTopology " + std::to_string(topology));
+    }
+}
+
+void RecordingGraphicsContext::setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset)
+{
+    if (tracker.setVertexBuffer(slot, buffer, stride, offset))
+    {
+        calls.push_back("setVertexBuffer " + std::to_string(slot) + " " + getName(buffer) + " " +
+            std::to_string(stride) + " " + std::to_string(offset));
+    }
+}
+
+void RecordingGraphicsContext::setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset)
+{
+    if (tracker.setIndexBuffer(buffer, format, offset))
+    {
+        calls.push_back("setIndexBuffer " + getName(buffer) + " " + std::to_string(format) + " " +
+            std::to_string(offset));
+    }
+}
+
+void RecordingGraphicsContext::clearRenderTarget(StateHandle view, const float*)
+{
+    calls.push_back("clearRenderTarget " + getName(view));
+}
+
+void RecordingGraphicsContext::clearDepthStencil(StateHandle view, float, uint8_t)
+{
+    calls.push_back("clearDepthStencil " + getName(view));
+}
+
+void RecordingGraphicsContext::draw(uint32_t vertexCount, uint32_t startVertex)
+{
+    calls.push_back("draw " + std::to_string(vertexCount) + " " + std::to_string(startVertex));
+}
+
+void RecordingGraphicsContext::drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex)
+{
+    calls.push_back("drawIndexed " + std::to_string(indexCount) + " " + std::to_string(startIndex) + " " +
+        std::to_string(baseVertex));
+}
+
+void RecordingGraphicsContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex,
+                                                    int32_t baseVertex, uint32_t startInstance)
+{
+    calls.push_back("drawIndexedInstanced " + std::to_string(indexCount) + " " + std::to_string(instanceCount) +
+        " " + std::to_string(startIndex) + " " + std::to_string(baseVertex) + " " + std::to_string(startInstance));
+}
+
+void* RecordingGraphicsContext::map(StateHandle buffer, GraphicsMapMode mode)
+{
+    calls.push_back("map " + getName(buffer) + (mode == GRAPHICS_MAP_WRITE_DISCARD ? " discard" : " no overwrite"));
+    return mappedMemory.data();
+}
+
+void RecordingGraphicsContext::unmap(StateHandle buffer)
+{
+    calls.push_back("unmap " + getName(buffer));
+}
+
+void RecordingGraphicsContext::updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void*)
+{
+    calls.push_back("updateBuffer " + getName(buffer) + " " + std::to_string(offset) + " " + std::to_string(size));
+}
+
+void RecordingGraphicsContext::signalFence(StateHandle fence)
+{
+    calls.push_back("signalFence " + getName(fence));
+    if (holdingFences)
+    {
+        pendingFences.push_back(fence);
+    }
+}
+
+bool RecordingGraphicsContext::isFenceDone(StateHandle fence, bool wait)
+{
+    for (auto pendingFence : pendingFences)
+    {
+        if (pendingFence != fence)
+        {
+            continue;
+        }
+        if (!wait)
+        {
+            return false;
+        }
+        calls.push_back("waitFence " + getName(fence));
+        completeFence(fence);
+        return true;
+    }
+    return true;
+}
+
+void RecordingGraphicsContext::invalidate()
+{
+    tracker.invalidate();
+}
+
+void RecordingGraphicsContext::beginFrame()
+{
+    tracker.beginFrame();
+}
+
+const StateTrackerStats& RecordingGraphicsContext::getLastFrameStats() const
+{
+    return tracker.getLastFrameStats();
+}
+
+const StateTrackerStats& RecordingGraphicsContext::getFrameStats() const
+{
+    return tracker.getFrameStats();
+}
+
+std::string RecordingGraphicsContext::getName(StateHandle handle) const
+{
+    if (!handle)
+    {
+        return "null";
+    }
+    for (size_t i = 0; i < namedHandles.size(); i++)
+    {
+        if (namedHandles[i] == handle)
+        {
+            return handleNames[i];
+        }
+    }
+    return "?";
+}
+
+std::string RecordingGraphicsContext::getNames(uint32_t amount, const StateHandle* pHandles) const
+{
+    std::string names;
+    for (uint32_t i = 0; i < amount; i++)
+    {
+        names += " " + getName(pHandles ? pHandles[i] : nullptr);
+    }
+    return names;
+}
+
+const char* RecordingGraphicsContext::getStageName(StateTrackerStage stage)
+{
+    return stage == STATE_TRACKER_VERTEX_STAGE ? "vertex" : "pixel";
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Engine/Device/GraphicsContext.h"
+
+/*
+ * GraphicsContext for tests. Bindings go through a StateTracker the way DXStateContext does it, and every call that
+ * would reach the API is recorded as a line of text, slot ranges as the narrowed range with the bound handles named
+ * through nameHandle. Map hands out scratch memory. Fences are done once signaled unless holdFences is set, then they
+ * stay pending until completeFence or until a call waits for them.
+ */
+class RecordingGraphicsContext : public GraphicsContext
+{
+public:
+    explicit RecordingGraphicsContext(uint32_t mappedBytes = 65536);
+
+private:
+    StateTracker tracker;
+    std::vector<std::string> calls;
+    std::vector<const void*> namedHandles;
+    std::vector<std::string> handleNames;
+    std::vector<uint8_t> mappedMemory;
+    bool holdingFences = false;
+    std::vector<StateHandle> pendingFences;
+
+public:
+    /*
+     * Handles without a name are recorded as '?', nullptr as "null"
+     */
+    void nameHandle(StateHandle handle, const std::string& name);
+    const std::vector<std::string>& getCalls() const;
+    /*
+     * Returns the calls recorded so far and starts a new list
+     */
+    std::vector<std::string> takeCalls();
+    const std::vector<uint8_t>& getMappedMemory() const;
+    void holdFences(bool hold);
+    void completeFence(StateHandle fence);
+
+    void setShader(StateTrackerStage stage, StateHandle shader) override;
+    void setShaderResources(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateHandle* pViews) override;
+    void setSamplers(StateTrackerStage stage, uint32_t start, uint32_t amount, const StateHandle* pSamplers) override;
+    void setConstantBuffers(StateTrackerStage stage, uint32_t start, uint32_t amount,
+                            const StateConstantBuffer* pBuffers) override;
+    void setRenderTargets(uint32_t amount, const StateHandle* pViews, StateHandle depthView) override;
+    void setDepthStencilState(StateHandle state, uint32_t stencilRef) override;
+    void setRasterizerState(StateHandle state) override;
+    void setBlendState(StateHandle state, const float* pBlendFactor, uint32_t sampleMask) override;
+    void setViewport(const StateViewport& viewport) override;
+    void setInputLayout(StateHandle layout) override;
+    void setPrimitiveTopology(uint32_t topology) override;
+    void setVertexBuffer(uint32_t slot, StateHandle buffer, uint32_t stride, uint32_t offset) override;
+    void setIndexBuffer(StateHandle buffer, uint32_t format, uint32_t offset) override;
+
+    void clearRenderTarget(StateHandle view, const float* pColor) override;
+    void clearDepthStencil(StateHandle view, float depth, uint8_t stencil) override;
+    void draw(uint32_t vertexCount, uint32_t startVertex) override;
+    void drawIndexed(uint32_t indexCount, uint32_t startIndex, int32_t baseVertex) override;
+    void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndex, int32_t baseVertex,
+                              uint32_t startInstance) override;
+    void* map(StateHandle buffer, GraphicsMapMode mode) override;
+    void unmap(StateHandle buffer) override;
+    void updateBuffer(StateHandle buffer, uint32_t offset, uint32_t size, const void* pData) override;
+    void signalFence(StateHandle fence) override;
+    bool isFenceDone(StateHandle fence, bool wait) override;
+
+    void invalidate() override;
+    void beginFrame() override;
+    const StateTrackerStats& getLastFrameStats() const override;
+    const StateTrackerStats& getFrameStats() const;
+
+private:
+    std::string getName(StateHandle handle) const;
+    std::string getNames(uint32_t amount, const StateHandle* pHandles) const;
+    static const char* getStageName(StateTrackerStage stage);
+};
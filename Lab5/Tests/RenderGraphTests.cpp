@@ -0,0 +1,453 @@
+#include "TestFramework.h"
+
+#include <stdexcept>
+#include "Engine/RenderGraph/CommandStreamBackend.h"
+#include "Engine/RenderGraph/RenderGraph.h"
+#include "Utils/JobSystem.h"
+
+namespace
+{
+    const RenderGraphTextureDesc colorDesc = {
+        64, 64, 1, RENDER_GRAPH_USAGE_RENDER_TARGET | RENDER_GRAPH_USAGE_SHADER_RESOURCE
+    };
+
+    RenderGraphPassDesc makePass(const std::string& name, std::vector<RenderGraphResource> reads,
+                                 std::vector<RenderGraphResource> writes, bool sideEffects = false)
+    {
+        RenderGraphPassDesc pass;
+        pass.name = name;
+        pass.reads = std::move(reads);
+        pass.writes = std::move(writes);
+        pass.sideEffects = sideEffects;
+        return pass;
+    }
+
+    std::vector<uint32_t> getCompiledPassIndices(const RenderGraph& graph)
+    {
+        std::vector<uint32_t> indices;
+        for (auto& compiledPass : graph.getCompiledPasses())
+        {
+            indices.push_back(compiledPass.pass);
+        }
+        return indices;
+    }
+
+    std::vector<std::string> describeStream(const std::vector<CommandStreamEntry>& stream)
+    {
+        std::vector<std::string> lines;
+        for (auto& entry : stream)
+        {
+            switch (entry.op)
+            {
+            case COMMAND_STREAM_ACQUIRE_TEXTURE:
+                lines.push_back("acquire " + std::to_string(entry.value) + (entry.name.empty() ? "" : " aliased"));
+                break;
+            case COMMAND_STREAM_UNBIND_RENDER_TARGETS:
+                lines.push_back("unbind targets");
+                break;
+            case COMMAND_STREAM_UNBIND_SHADER_RESOURCES:
+                lines.push_back("unbind resources");
+                break;
+            case COMMAND_STREAM_BIND_TARGET:
+                lines.push_back("bind " + std::to_string(entry.value));
+                break;
+            case COMMAND_STREAM_BEGIN_PASS:
+                lines.push_back("begin " + entry.name);
+                break;
+            case COMMAND_STREAM_END_PASS:
+                lines.push_back("end");
+                break;
+            case COMMAND_STREAM_PASS_COMMAND:
+                lines.push_back("draw " + entry.name + " " + std::to_string(entry.value));
+                break;
+            }
+        }
+        return lines;
+    }
+
+    /*
+     * A post processing chain of passesAmount passes, every pass draws twice through the backend and pass
+     * immediatePass, when there is one, runs on the immediate context
+     */
+    void declareChain(RenderGraph& graph, CommandStreamBackend& backend, uint32_t passesAmount,
+                      uint32_t immediatePass = RENDER_GRAPH_NO_RESOURCE)
+    {
+        RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+        RenderGraphResource previous = RENDER_GRAPH_NO_RESOURCE;
+        for (uint32_t i = 0; i < passesAmount; i++)
+        {
+            RenderGraphResource output = i + 1 == passesAmount ? backBuffer :
+                graph.createTexture("Texture " + std::to_string(i), colorDesc);
+            RenderGraphPassDesc pass = makePass("Pass " + std::to_string(i), {}, {output});
+            if (previous != RENDER_GRAPH_NO_RESOURCE)
+            {
+                pass.reads.push_back(previous);
+            }
+            pass.immediate = i == immediatePass;
+            pass.execute = [&backend, i](RenderGraphContext context)
+            {
+                backend.record(context, i, "first");
+                backend.record(context, i, "second");
+            };
+            graph.addPass(pass);
+            previous = output;
+        }
+    }
+
+    /*
+     * No two textures alive in the same pass may share heap bytes
+     */
+    bool isPlacementValid(const RenderGraph& graph)
+    {
+        for (uint32_t a = 0; a < graph.getResourcesAmount(); a++)
+        {
+            for (uint32_t b = a + 1; b < graph.getResourcesAmount(); b++)
+            {
+                const RenderGraphResourceInfo& first = graph.getResource(a);
+                const RenderGraphResourceInfo& second = graph.getResource(b);
+                if (!first.size || !second.size)
+                {
+                    continue;
+                }
+                bool alive = first.firstPass <= second.lastPass && second.firstPass <= first.lastPass;
+                bool shared = first.heapOffset < second.heapOffset + second.size &&
+                    second.heapOffset < first.heapOffset + first.size;
+                if (alive && shared)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE(unusedWritersAreCulled)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource unread = graph.createTexture("Unread", colorDesc);
+    RenderGraphResource chainStart = graph.createTexture("Chain start", colorDesc);
+    RenderGraphResource chainEnd = graph.createTexture("Chain end", colorDesc);
+    RenderGraphResource scene = graph.createTexture("Scene", colorDesc);
+    graph.addPass(makePass("Unread writer", {}, {unread}));
+    graph.addPass(makePass("Dead chain start", {}, {chainStart}));
+    graph.addPass(makePass("Dead chain end", {chainStart}, {chainEnd}));
+    graph.addPass(makePass("Scene", {}, {scene}));
+    graph.addPass(makePass("Readback", {scene}, {}, true));
+    graph.addPass(makePass("Tone map", {scene}, {backBuffer}));
+    graph.addPass(makePass("Nothing", {}, {}));
+    graph.compile(backend);
+
+    CHECK(graph.isPassCulled(0));
+    CHECK(graph.isPassCulled(1));
+    CHECK(graph.isPassCulled(2));
+    CHECK(!graph.isPassCulled(3));
+    CHECK(!graph.isPassCulled(4));
+    CHECK(!graph.isPassCulled(5));
+    CHECK(graph.isPassCulled(6));
+    CHECK(getCompiledPassIndices(graph) == std::vector<uint32_t>({3, 4, 5}));
+
+    // Textures only culled passes touch get no memory
+    CHECK(!graph.getResource(unread).used);
+    CHECK(!graph.getResource(chainStart).used);
+    CHECK(!graph.getResource(chainEnd).used);
+    CHECK_EQUAL(0u, graph.getResource(chainEnd).size);
+    RenderGraphStats stats = graph.getStats();
+    CHECK_EQUAL(7u, stats.passesAmount);
+    CHECK_EQUAL(4u, stats.culledPassesAmount);
+    CHECK_EQUAL(1u, stats.transientTexturesAmount);
+}
+
+TEST_CASE(readersKeepEveryEarlierWriter)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource scene = graph.createTexture("Scene", colorDesc);
+    graph.addPass(makePass("Opaque", {}, {scene}));
+    graph.addPass(makePass("Transparent", {}, {scene}));
+    graph.addPass(makePass("Tone map", {scene}, {backBuffer}));
+    // Writes after the last read do not reach the back buffer
+    graph.addPass(makePass("Late overlay", {}, {scene}));
+    graph.compile(backend);
+
+    CHECK(getCompiledPassIndices(graph) == std::vector<uint32_t>({0, 1, 2}));
+}
+
+TEST_CASE(readBeforeWriteThrows)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource scene = graph.createTexture("Scene", colorDesc);
+    graph.addPass(makePass("Tone map", {scene}, {backBuffer}));
+    graph.addPass(makePass("Scene", {}, {scene}));
+    CHECK_THROWS(graph.compile(backend), std::runtime_error);
+    CHECK(!graph.isCompiled());
+
+    // Imported textures hold contents from before the frame
+    RenderGraph importedGraph;
+    RenderGraphResource history = importedGraph.importTexture("History");
+    RenderGraphResource output = importedGraph.importTexture("Output");
+    importedGraph.addPass(makePass("Resolve", {history}, {output}));
+    importedGraph.compile(backend);
+    CHECK(importedGraph.isCompiled());
+}
+
+TEST_CASE(disjointLifetimesShareHeapRange)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource first = graph.createTexture("First", colorDesc);
+    RenderGraphResource second = graph.createTexture("Second", colorDesc);
+    RenderGraphResource third = graph.createTexture("Third", colorDesc);
+    graph.addPass(makePass("Write first", {}, {first}));
+    graph.addPass(makePass("First to second", {first}, {second}));
+    graph.addPass(makePass("Second to third", {second}, {third}));
+    graph.addPass(makePass("Present", {third}, {backBuffer}));
+    graph.compile(backend);
+
+    // first lives in passes 0-1 and third in 2-3, second overlaps both
+    CHECK_EQUAL(0u, graph.getResource(first).firstPass);
+    CHECK_EQUAL(1u, graph.getResource(first).lastPass);
+    CHECK_EQUAL(2u, graph.getResource(third).firstPass);
+    CHECK_EQUAL(3u, graph.getResource(third).lastPass);
+    CHECK_EQUAL(graph.getResource(first).heapOffset, graph.getResource(third).heapOffset);
+    CHECK(graph.getResource(first).heapOffset != graph.getResource(second).heapOffset);
+    CHECK(!graph.getResource(first).aliased);
+    CHECK(!graph.getResource(second).aliased);
+    CHECK(graph.getResource(third).aliased);
+    CHECK(isPlacementValid(graph));
+
+    RenderGraphStats stats = graph.getStats();
+    CHECK_EQUAL(3 * RENDER_GRAPH_HEAP_ALIGNMENT, stats.transientBytes);
+    CHECK_EQUAL(2 * RENDER_GRAPH_HEAP_ALIGNMENT, stats.heapBytes);
+    CHECK_EQUAL(graph.getHeapSize(), stats.heapBytes);
+}
+
+TEST_CASE(overlappingLifetimesGetTheirOwnRange)
+{
+    RenderGraph graph;
+    // Sizes off the heap alignment still start every texture on an aligned offset
+    CommandStreamBackend backend(0, RENDER_GRAPH_HEAP_ALIGNMENT + 1);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource albedo = graph.createTexture("Albedo", colorDesc);
+    RenderGraphResource normals = graph.createTexture("Normals", colorDesc);
+    RenderGraphResource depth = graph.createTexture("Depth", colorDesc);
+    graph.addPass(makePass("Geometry", {}, {albedo, normals, depth}));
+    graph.addPass(makePass("Lighting", {albedo, normals, depth}, {backBuffer}));
+    graph.compile(backend);
+
+    CHECK(isPlacementValid(graph));
+    for (RenderGraphResource resource : {albedo, normals, depth})
+    {
+        CHECK_EQUAL(0u, graph.getResource(resource).heapOffset % RENDER_GRAPH_HEAP_ALIGNMENT);
+        CHECK(!graph.getResource(resource).aliased);
+    }
+    CHECK_EQUAL(6 * RENDER_GRAPH_HEAP_ALIGNMENT, graph.getHeapSize());
+}
+
+TEST_CASE(longChainPlacementStaysValid)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource scene = graph.createTexture("Scene", colorDesc);
+    graph.addPass(makePass("Scene", {}, {scene}));
+    // A blur pyramid: every level reads the one before it and the scene stays alive until the composite
+    RenderGraphResource previous = scene;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        RenderGraphResource level = graph.createTexture("Level " + std::to_string(i), colorDesc);
+        graph.addPass(makePass("Blur " + std::to_string(i), {previous}, {level}));
+        previous = level;
+    }
+    graph.addPass(makePass("Composite", {scene, previous}, {backBuffer}));
+    graph.compile(backend);
+
+    CHECK(isPlacementValid(graph));
+    // The scene, the level being read and the level being written
+    CHECK_EQUAL(3 * RENDER_GRAPH_HEAP_ALIGNMENT, graph.getHeapSize());
+}
+
+TEST_CASE(unbindsFollowBindings)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource ping = graph.createTexture("Ping", colorDesc);
+    RenderGraphResource pong = graph.createTexture("Pong", colorDesc);
+    RenderGraphResource other = graph.createTexture("Other", colorDesc);
+    graph.addPass(makePass("Write ping", {}, {ping}));
+    graph.addPass(makePass("Ping to pong", {ping}, {pong}));
+    graph.addPass(makePass("Pong to ping", {pong}, {ping}));
+    graph.addPass(makePass("Write other", {}, {other}));
+    graph.addPass(makePass("Composite", {ping, other}, {backBuffer}));
+    graph.compile(backend);
+
+    const std::vector<RenderGraphCompiledPass>& passes = graph.getCompiledPasses();
+    REQUIRE(passes.size() == 5);
+    CHECK(!passes[0].unbindRenderTargets);
+    CHECK(!passes[0].unbindShaderResources);
+    // Ping is still the render target when the next pass samples it
+    CHECK(passes[1].unbindRenderTargets);
+    CHECK(!passes[1].unbindShaderResources);
+    // Ping is still bound as a shader resource when it becomes the render target again
+    CHECK(passes[2].unbindRenderTargets);
+    CHECK(passes[2].unbindShaderResources);
+    // Pong was unbound as a shader resource by the pass before, binding other replaced ping as target
+    CHECK(!passes[3].unbindRenderTargets);
+    CHECK(!passes[3].unbindShaderResources);
+    CHECK(passes[4].unbindRenderTargets);
+    CHECK(!passes[4].unbindShaderResources);
+
+    CHECK(passes[0].acquiredResources == std::vector<RenderGraphResource>({ping}));
+    CHECK(passes[1].acquiredResources == std::vector<RenderGraphResource>({pong}));
+    CHECK(passes[2].acquiredResources.empty());
+    CHECK(passes[3].acquiredResources == std::vector<RenderGraphResource>({other}));
+    CHECK(passes[4].acquiredResources.empty());
+}
+
+TEST_CASE(resetAllowsRedeclaring)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    graph.addPass(makePass("Clear", {}, {backBuffer}));
+    graph.compile(backend);
+    CHECK(graph.isCompiled());
+
+    graph.reset();
+    CHECK(!graph.isCompiled());
+    CHECK_EQUAL(0u, graph.getResourcesAmount());
+    CHECK_EQUAL(0u, graph.getHeapSize());
+    CHECK_THROWS(graph.execute(backend), std::runtime_error);
+}
+
+TEST_CASE(executeRecordsCommandStream)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource first = graph.createTexture("First", colorDesc);
+    RenderGraphResource second = graph.createTexture("Second", colorDesc);
+    RenderGraphResource third = graph.createTexture("Third", colorDesc);
+    RenderGraphResource unused = graph.createTexture("Unused", colorDesc);
+    const char* names[] = {"Write first", "Unused", "First to second", "Second to third", "Present"};
+    graph.addPass(makePass(names[0], {}, {first}));
+    graph.addPass(makePass(names[1], {}, {unused}));
+    graph.addPass(makePass(names[2], {first}, {second}));
+    graph.addPass(makePass(names[3], {second}, {third}));
+    graph.addPass(makePass(names[4], {third}, {backBuffer}));
+    graph.compile(backend);
+    graph.execute(backend);
+
+    // Sampled textures are never written again, only the render targets are unbound between passes. The frame
+    // ends with nothing bound.
+    CHECK(describeStream(backend.getSubmittedStream()) == std::vector<std::string>({
+        "acquire 1", "begin Write first", "end",
+        "unbind targets", "acquire 2", "begin First to second", "end",
+        "unbind targets", "acquire 3 aliased", "begin Second to third", "end",
+        "unbind targets", "begin Present", "end",
+        "unbind targets", "unbind resources"
+    }));
+}
+
+TEST_CASE(passCommandsLandBetweenBeginAndEnd)
+{
+    RenderGraph graph;
+    CommandStreamBackend backend(0);
+    declareChain(graph, backend, 3);
+    graph.compile(backend);
+    graph.execute(backend);
+    CHECK(describeStream(backend.getSubmittedStream()) == std::vector<std::string>({
+        "acquire 1", "begin Pass 0", "draw first 0", "draw second 0", "end",
+        "unbind targets", "acquire 2", "begin Pass 1", "draw first 1", "draw second 1", "end",
+        "unbind targets", "begin Pass 2", "draw first 2", "draw second 2", "end",
+        "unbind targets", "unbind resources"
+    }));
+
+    // A second execution of the same compiled graph records the same frame
+    backend.clearSubmittedStream();
+    graph.execute(backend);
+    CHECK_EQUAL(18u, backend.getSubmittedStream().size());
+}
+
+TEST_CASE(immediatePassDrawsIntoItsWrites)
+{
+    // The end of the renderer frame: tone mapping records on a deferred context, the UI only knows the immediate
+    // one and draws after the recorded list was submitted
+    JobSystem jobs(2);
+    RenderGraph graph;
+    CommandStreamBackend backend(2);
+    RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+    RenderGraphResource hdrFrame = graph.createTexture("HDR frame", colorDesc);
+    graph.addPass(makePass("Scene", {}, {hdrFrame}));
+    graph.addPass(makePass("Tone mapping", {hdrFrame}, {backBuffer}));
+    RenderGraphPassDesc ui = makePass("UI", {}, {backBuffer});
+    ui.immediate = true;
+    ui.execute = [&backend](RenderGraphContext context)
+    {
+        backend.record(context, 0, "ui");
+    };
+    graph.addPass(ui);
+    graph.compile(backend);
+    graph.execute(backend, &jobs);
+
+    CHECK(describeStream(backend.getSubmittedStream()) == std::vector<std::string>({
+        "acquire 1", "begin Scene", "end",
+        "unbind targets", "begin Tone mapping", "end",
+        "bind 0", "begin UI", "draw ui 0", "end",
+        "unbind targets", "unbind resources"
+    }));
+}
+
+TEST_CASE(parallelRecordingMatchesSerial)
+{
+    JobSystem jobs(4);
+    for (uint32_t contextsAmount : {1u, 2u, 3u, 8u, 40u})
+    {
+        for (uint32_t immediatePass : {RENDER_GRAPH_NO_RESOURCE, 0u, 5u, 11u})
+        {
+            RenderGraph serialGraph;
+            CommandStreamBackend serialBackend(0);
+            declareChain(serialGraph, serialBackend, 12, immediatePass);
+            serialGraph.compile(serialBackend);
+            serialGraph.execute(serialBackend);
+
+            RenderGraph parallelGraph;
+            CommandStreamBackend parallelBackend(contextsAmount);
+            declareChain(parallelGraph, parallelBackend, 12, immediatePass);
+            parallelGraph.compile(parallelBackend);
+            for (uint32_t frame = 0; frame < 3; frame++)
+            {
+                parallelBackend.clearSubmittedStream();
+                parallelGraph.execute(parallelBackend, &jobs);
+                CHECK(describeStream(parallelBackend.getSubmittedStream()) ==
+                      describeStream(serialBackend.getSubmittedStream()));
+            }
+        }
+    }
+}
+
+TEST_CASE(passErrorsReachExecute)
+{
+    JobSystem jobs(3);
+    for (uint32_t contextsAmount : {0u, 2u})
+    {
+        RenderGraph graph;
+        CommandStreamBackend backend(contextsAmount);
+        RenderGraphResource backBuffer = graph.importTexture("Back buffer");
+        RenderGraphPassDesc pass = makePass("Failing", {}, {backBuffer});
+        pass.execute = [](RenderGraphContext)
+        {
+            throw std::runtime_error("pass failed");
+        };
+        graph.addPass(pass);
+        graph.compile(backend);
+        CHECK_THROWS(graph.execute(backend, &jobs), std::runtime_error);
+    }
+}
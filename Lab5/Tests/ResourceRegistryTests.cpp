@@ -0,0 +1,160 @@
+#include "TestFramework.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "Engine/Resources/ResourceRegistry.h"
+#include "Utils/DXGIFormatSize.h"
+
+namespace
+{
+    ResourceRecord makeTexture(const std::string& name, const std::string& owner, ResourceCategory category,
+                               DXGI_FORMAT format, uint32_t size, uint32_t arraySize = 1)
+    {
+        ResourceRecord record;
+        record.name = name;
+        record.owner = owner;
+        record.category = category;
+        record.format = format;
+        record.width = size;
+        record.height = size;
+        record.arraySize = arraySize;
+        record.mipLevels = 1;
+        record.bytes = getDXGITextureBytes(format, size, size, arraySize, 1);
+        return record;
+    }
+
+    ResourceRecord makeRecord(const std::string& name, const std::string& owner, ResourceCategory category,
+                              uint64_t bytes)
+    {
+        ResourceRecord record;
+        record.name = name;
+        record.owner = owner;
+        record.category = category;
+        record.bytes = bytes;
+        return record;
+    }
+
+    void checkTotal(const ResourceRegistry& registry, ResourceCategory category, uint32_t resourcesAmount,
+                    uint64_t bytes)
+    {
+        ResourceTotal total = registry.getTotal(category);
+        CHECK_EQUAL(resourcesAmount, total.resourcesAmount);
+        CHECK_EQUAL(bytes, total.bytes);
+    }
+
+    // Stand-ins for the API objects, the registry only keys by address
+    int albedo, sky, sceneTarget, sceneView, vertices, constants;
+}
+
+TEST_CASE(totalsFollowCreationAndRelease)
+{
+    ResourceRegistry registry;
+    registry.add(&albedo, makeTexture("Albedo", "Assets", RESOURCE_CATEGORY_TEXTURE, DXGI_FORMAT_BC7_UNORM, 512));
+    registry.add(&sky, makeTexture("Sky", "Environment", RESOURCE_CATEGORY_TEXTURE,
+                                   DXGI_FORMAT_R16G16B16A16_FLOAT, 128, 6));
+    registry.add(&sceneTarget, makeTexture("Scene", "Renderer", RESOURCE_CATEGORY_RENDER_TARGET,
+                                           DXGI_FORMAT_R16G16B16A16_FLOAT, 1024));
+    registry.add(&sceneView, makeRecord("Scene SRV", "Renderer", RESOURCE_CATEGORY_VIEW, 0));
+    registry.add(&vertices, makeRecord("Sphere vertices", "Assets", RESOURCE_CATEGORY_BUFFER, 4096));
+    registry.add(&constants, makeRecord("Frame constants", "Renderer", RESOURCE_CATEGORY_BUFFER, 256));
+
+    const uint64_t albedoBytes = 262144;
+    const uint64_t skyBytes = 786432;
+    const uint64_t sceneBytes = 8388608;
+    checkTotal(registry, RESOURCE_CATEGORY_TEXTURE, 2, albedoBytes + skyBytes);
+    checkTotal(registry, RESOURCE_CATEGORY_RENDER_TARGET, 1, sceneBytes);
+    checkTotal(registry, RESOURCE_CATEGORY_BUFFER, 2, 4352);
+    checkTotal(registry, RESOURCE_CATEGORY_VIEW, 1, 0);
+    const uint64_t allBytes = albedoBytes + skyBytes + sceneBytes + 4352;
+    CHECK_EQUAL(allBytes, registry.getBytes());
+
+    std::map<std::string, ResourceTotal> owners = registry.getOwnerTotals();
+    REQUIRE(owners.size() == 3);
+    CHECK_EQUAL(2u, owners["Assets"].resourcesAmount);
+    CHECK_EQUAL(albedoBytes + 4096, owners["Assets"].bytes);
+    CHECK_EQUAL(3u, owners["Renderer"].resourcesAmount);
+    CHECK_EQUAL(sceneBytes + 256, owners["Renderer"].bytes);
+
+    // The UI refreshes the same vector every frame, in owner order
+    std::vector<ResourceOwnerTotal> ownerTotals;
+    registry.getOwnerTotals(ownerTotals);
+    REQUIRE(ownerTotals.size() == 3);
+    const ResourceOwnerTotal* pFirstTotal = ownerTotals.data();
+    registry.getOwnerTotals(ownerTotals);
+    CHECK(ownerTotals.data() == pFirstTotal);
+    CHECK_EQUAL(std::string("Assets"), ownerTotals[0].owner);
+    CHECK_EQUAL(albedoBytes + 4096, ownerTotals[0].total.bytes);
+    CHECK_EQUAL(std::string("Renderer"), ownerTotals[2].owner);
+    CHECK_EQUAL(3u, ownerTotals[2].total.resourcesAmount);
+
+    // Recreating the scene target at a new size under the same address replaces its record
+    registry.add(&sceneTarget, makeTexture("Scene", "Renderer", RESOURCE_CATEGORY_RENDER_TARGET,
+                                           DXGI_FORMAT_R16G16B16A16_FLOAT, 512));
+    checkTotal(registry, RESOURCE_CATEGORY_RENDER_TARGET, 1, sceneBytes / 4);
+    CHECK_EQUAL(allBytes, registry.getPeakBytes());
+
+    registry.remove(&sky);
+    registry.remove(&sky);
+    registry.remove(&sceneView);
+    int unknown;
+    registry.remove(&unknown);
+    checkTotal(registry, RESOURCE_CATEGORY_TEXTURE, 1, albedoBytes);
+    checkTotal(registry, RESOURCE_CATEGORY_VIEW, 0, 0);
+    CHECK_EQUAL(albedoBytes + sceneBytes / 4 + 4352, registry.getBytes());
+    CHECK_EQUAL(allBytes, registry.getPeakBytes());
+    CHECK(registry.getOwnerTotals().count("Environment") == 0);
+    registry.getOwnerTotals(ownerTotals);
+    REQUIRE(ownerTotals.size() == 2);
+    CHECK_EQUAL(std::string("Renderer"), ownerTotals[1].owner);
+    CHECK_EQUAL(2u, ownerTotals[1].total.resourcesAmount);
+    CHECK_EQUAL(sceneBytes / 4 + 256, ownerTotals[1].total.bytes);
+
+    for (const void* resource : {(const void*)&albedo, (const void*)&sceneTarget, (const void*)&vertices,
+                                 (const void*)&constants})
+    {
+        registry.remove(resource);
+    }
+    for (uint32_t category = 0; category < RESOURCE_CATEGORIES_AMOUNT; category++)
+    {
+        checkTotal(registry, (ResourceCategory)category, 0, 0);
+    }
+    CHECK_EQUAL(0u, registry.getBytes());
+}
+
+TEST_CASE(leakReportListsWhatIsLeft)
+{
+    ResourceRegistry registry;
+    std::ostringstream empty;
+    CHECK_EQUAL(0u, registry.reportLeaks(empty));
+    CHECK(empty.str().empty());
+
+    registry.add(&vertices, makeRecord("Sphere vertices", "Assets", RESOURCE_CATEGORY_BUFFER, 4096));
+    registry.add(&albedo, makeTexture("Albedo", "Assets", RESOURCE_CATEGORY_TEXTURE, DXGI_FORMAT_BC1_UNORM, 64));
+    registry.add(&sceneView, makeRecord("Scene SRV", "Renderer", RESOURCE_CATEGORY_VIEW, 0));
+    registry.add(&constants, makeRecord("Frame constants", "Renderer", RESOURCE_CATEGORY_BUFFER, 256));
+    registry.remove(&constants);
+
+    // In creation order, whatever order the map keeps them in
+    std::ostringstream report;
+    CHECK_EQUAL(3u, registry.reportLeaks(report));
+    CHECK_EQUAL(std::string(
+        "Leaked buffer \"Sphere vertices\" of Assets, 4096 bytes\n"
+        "Leaked texture \"Albedo\" of Assets, 2048 bytes\n"
+        "Leaked view \"Scene SRV\" of Renderer, 0 bytes\n"), report.str());
+
+    std::string path = Testing::makeTemporaryDirectory("ResourceRegistryTests") + "/resources.csv";
+    registry.add(&sky, makeTexture("Sky \"HDR\", baked", "Environment", RESOURCE_CATEGORY_TEXTURE,
+                                   DXGI_FORMAT_R16G16B16A16_FLOAT, 16, 6));
+    registry.writeCsv(path);
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream csv;
+    csv << file.rdbuf();
+    CHECK_EQUAL(std::string(
+        "name,owner,category,format,width,height,array_size,mip_levels,bytes\n"
+        "\"Sphere vertices\",\"Assets\",buffer,,0,0,0,0,4096\n"
+        "\"Albedo\",\"Assets\",texture,BC1_UNORM,64,64,1,1,2048\n"
+        "\"Scene SRV\",\"Renderer\",view,,0,0,0,0,0\n"
+        "\"Sky \"\"HDR\"\", baked\",\"Environment\",texture,R16G16B16A16_FLOAT,16,16,6,1,12288\n"), csv.str());
+    CHECK_THROWS(registry.writeCsv(path + "/missing/resources.csv"), std::runtime_error);
+}
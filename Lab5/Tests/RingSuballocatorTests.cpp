@@ -0,0 +1,384 @@
+#include "TestFramework.h"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include "DXShader/ConstantRing.h"
+#include "RecordingGraphicsContext.h"
+#include "Utils/RingSuballocator.h"
+
+namespace
+{
+    typedef std::vector<std::string> Calls;
+
+    /*
+     * Hands out handles named in the recording context, "Buffer0" for the first buffer and "Fence0" onwards for
+     * fences, and counts the ones not released yet
+     */
+    class RecordingGraphicsDevice : public GraphicsDevice
+    {
+    private:
+        GraphicsCapabilities capabilities;
+        RecordingGraphicsContext context;
+        std::vector<std::unique_ptr<int>> objects;
+        std::vector<StateHandle> fences;
+        uint32_t buffersAmount = 0;
+
+    public:
+        uint32_t liveObjectsAmount = 0;
+
+        explicit RecordingGraphicsDevice(bool noOverwrite, bool offsets = true)
+        {
+            capabilities.constantBufferOffsets = offsets;
+            capabilities.constantBufferPartialUpdates = true;
+            capabilities.constantBufferNoOverwrite = noOverwrite;
+        }
+
+        const GraphicsCapabilities& getCapabilities() const override
+        {
+            return capabilities;
+        }
+
+        GraphicsBuffer createBuffer(const GraphicsBufferDesc& desc, const void*, const char*) override
+        {
+            GraphicsBuffer buffer;
+            buffer.buffer = createObject("Buffer" + std::to_string(buffersAmount++));
+            buffer.size = desc.size;
+            return buffer;
+        }
+
+        void releaseBuffer(GraphicsBuffer& buffer) override
+        {
+            buffer = GraphicsBuffer();
+            liveObjectsAmount--;
+        }
+
+        StateHandle createFence() override
+        {
+            fences.push_back(createObject("Fence" + std::to_string(fences.size())));
+            return fences.back();
+        }
+
+        void releaseFence(StateHandle) override
+        {
+            liveObjectsAmount--;
+        }
+
+        GraphicsContext* getImmediateContext() override
+        {
+            return &context;
+        }
+
+        RecordingGraphicsContext& getContext()
+        {
+            return context;
+        }
+
+        StateHandle getFence(uint32_t index) const
+        {
+            return fences[index];
+        }
+
+    private:
+        StateHandle createObject(const std::string& name)
+        {
+            objects.push_back(std::make_unique<int>());
+            context.nameHandle(objects.back().get(), name);
+            liveObjectsAmount++;
+            return objects.back().get();
+        }
+    };
+
+    struct Constants
+    {
+        float values[20];
+    };
+
+    Constants makeConstants(float value)
+    {
+        Constants constants;
+        for (auto& constant : constants.values)
+        {
+            constant = value;
+        }
+        return constants;
+    }
+}
+
+TEST_CASE(allocationsAreAligned)
+{
+    RingSuballocator ring(4096, 256);
+    CHECK_EQUAL(0u, ring.allocate(1));
+    CHECK_EQUAL(256u, ring.allocate(256));
+    CHECK_EQUAL(512u, ring.allocate(300));
+    CHECK_EQUAL(1024u, ring.allocate(16));
+    // Padding in front of an allocation counts as used until the frame is released
+    CHECK_EQUAL(1040u, ring.getUsedBytes());
+    ring.finishFrame(1);
+    ring.releaseCompleted(1);
+    CHECK_EQUAL(0u, ring.getUsedBytes());
+    CHECK_EQUAL(1280u, ring.allocate(1));
+
+    CHECK_THROWS(RingSuballocator(4096, 96), std::runtime_error);
+    CHECK_THROWS(RingSuballocator(4096, 0), std::runtime_error);
+    CHECK_THROWS(RingSuballocator(1000, 256), std::runtime_error);
+    CHECK_THROWS(RingSuballocator(0, 256), std::runtime_error);
+}
+
+TEST_CASE(wrapAroundWaitsForFencedTail)
+{
+    RingSuballocator ring(1024, 256);
+    CHECK_EQUAL(0u, ring.allocate(512));
+    ring.finishFrame(1);
+    CHECK_EQUAL(512u, ring.allocate(256));
+    ring.finishFrame(2);
+    ring.releaseCompleted(1);
+    CHECK_EQUAL(256u, ring.getUsedBytes());
+
+    // 512 bytes do not fit behind frame 2, the allocation skips the last 256 bytes of the ring and starts over
+    CHECK_EQUAL(0u, ring.allocate(512));
+    CHECK_EQUAL(1024u, ring.getUsedBytes());
+    // Frame 2 still owns [512, 768), nothing fits until its fence passes
+    CHECK_EQUAL(RING_SUBALLOCATOR_FULL, ring.allocate(256));
+    ring.finishFrame(3);
+    ring.releaseCompleted(2);
+    CHECK_EQUAL(512u, ring.allocate(256));
+    // The skipped tail came back with frame 3, not before
+    CHECK_EQUAL(RING_SUBALLOCATOR_FULL, ring.allocate(256));
+    ring.finishFrame(4);
+    ring.releaseCompleted(3);
+    CHECK_EQUAL(768u, ring.allocate(256));
+    CHECK_EQUAL(0u, ring.allocate(256));
+}
+
+TEST_CASE(allocationsLargerThanFreeSpanFail)
+{
+    RingSuballocator ring(1024, 256);
+    CHECK_EQUAL(RING_SUBALLOCATOR_FULL, ring.allocate(1025));
+    CHECK_EQUAL(RING_SUBALLOCATOR_FULL, ring.allocate(0));
+    CHECK_EQUAL(0u, ring.allocate(768));
+    ring.finishFrame(1);
+
+    // A failed allocation leaves the ring as it was
+    CHECK_EQUAL(RING_SUBALLOCATOR_FULL, ring.allocate(512));
+    CHECK_EQUAL(768u, ring.getUsedBytes());
+    CHECK_EQUAL(768u, ring.allocate(256));
+    CHECK_EQUAL(RING_SUBALLOCATOR_FULL, ring.allocate(1));
+    ring.finishFrame(2);
+
+    ring.releaseCompleted(2);
+    CHECK_EQUAL(0u, ring.getUsedBytes());
+    CHECK_EQUAL(0u, ring.allocate(1024));
+}
+
+TEST_CASE(framesRetireInFenceOrder)
+{
+    RingSuballocator ring(4096, 256);
+    for (uint64_t fence = 10; fence <= 50; fence += 10)
+    {
+        ring.allocate(256);
+        ring.finishFrame(fence);
+    }
+    CHECK_THROWS(ring.finishFrame(50), std::runtime_error);
+    CHECK_THROWS(ring.finishFrame(20), std::runtime_error);
+    CHECK_EQUAL(10u, ring.getOldestPendingFence());
+
+    // A completed value between two fences releases every frame up to it
+    ring.releaseCompleted(25);
+    CHECK_EQUAL(30u, ring.getOldestPendingFence());
+    CHECK_EQUAL(768u, ring.getUsedBytes());
+    // Completion never goes back
+    ring.releaseCompleted(5);
+    CHECK_EQUAL(768u, ring.getUsedBytes());
+    ring.releaseCompleted(50);
+    CHECK(!ring.hasPendingFrames());
+    CHECK_EQUAL(0u, ring.getUsedBytes());
+}
+
+TEST_CASE(manyFramesInFlight)
+{
+    RingSuballocator ring(65536, 256);
+    uint64_t released = 0;
+    // More pending frames than the queue starts with, released in batches so the queue wraps around
+    for (uint64_t fence = 1; fence <= 200; fence++)
+    {
+        REQUIRE(ring.allocate(256) != RING_SUBALLOCATOR_FULL);
+        ring.finishFrame(fence);
+        if (fence % 7 == 0)
+        {
+            released = fence - 3;
+            ring.releaseCompleted(released);
+            CHECK_EQUAL(released + 1, ring.getOldestPendingFence());
+            CHECK_EQUAL(3 * 256u, ring.getUsedBytes());
+        }
+    }
+    ring.reset();
+    CHECK(!ring.hasPendingFrames());
+    CHECK_EQUAL(0u, ring.getUsedBytes());
+    CHECK_EQUAL(0u, ring.allocate(256));
+}
+
+TEST_CASE(constantRingPushesAlignedWindows)
+{
+    RecordingGraphicsDevice device(true);
+    RecordingGraphicsContext& context = device.getContext();
+    {
+        ConstantRing ring(&device, 4096);
+        ring.map(&context);
+        Constants first = makeConstants(1.0f);
+        Constants second = makeConstants(2.0f);
+        ConstantRingAllocation firstAllocation = ring.push(first);
+        ConstantRingAllocation secondAllocation = ring.push(second);
+        ring.unmap();
+
+        // 80 bytes of constants take a whole 256 byte window, 16 constants
+        CHECK_EQUAL(0u, firstAllocation.firstConstant);
+        CHECK_EQUAL(16u, firstAllocation.constantsAmount);
+        CHECK_EQUAL(16u, secondAllocation.firstConstant);
+        CHECK_EQUAL(16u, secondAllocation.constantsAmount);
+        CHECK(memcmp(context.getMappedMemory().data() + 256, &second, sizeof(second)) == 0);
+
+        ring.bindToVertexShader(&context, firstAllocation);
+        ring.bindToPixelShader(&context, secondAllocation, 2);
+        ring.endFrame(&context);
+        CHECK(context.takeCalls() == Calls({
+            "map Buffer0 discard", "unmap Buffer0", "setConstantBuffers vertex 0 Buffer0[0+16]",
+            "setConstantBuffers pixel 2 Buffer0[16+16]", "signalFence Fence1"
+        }));
+
+        // Later frames append behind the earlier ones without discarding
+        ring.map(&context);
+        CHECK_EQUAL(32u, ring.push(first).firstConstant);
+        ring.unmap();
+        ring.endFrame(&context);
+        CHECK(context.takeCalls() == Calls({"map Buffer0 no overwrite", "unmap Buffer0", "signalFence Fence2"}));
+    }
+    CHECK_EQUAL(0u, device.liveObjectsAmount);
+}
+
+TEST_CASE(constantRingDiscardsWithoutNoOverwrite)
+{
+    RecordingGraphicsDevice device(false);
+    RecordingGraphicsContext& context = device.getContext();
+    ConstantRing ring(&device, 1024);
+    Constants constants = makeConstants(2.0f);
+    for (uint32_t frame = 0; frame < 3; frame++)
+    {
+        ring.map(&context);
+        // Every frame starts over in a renamed buffer
+        CHECK_EQUAL(0u, ring.push(constants).firstConstant);
+        ring.unmap();
+        ring.endFrame(&context);
+    }
+    CHECK(context.takeCalls() == Calls({
+        "map Buffer0 discard", "unmap Buffer0", "signalFence Fence1",
+        "map Buffer0 discard", "unmap Buffer0", "signalFence Fence2",
+        "map Buffer0 discard", "unmap Buffer0", "signalFence Fence3"
+    }));
+
+    RecordingGraphicsDevice unsupported(true, false);
+    CHECK_THROWS(ConstantRing(&unsupported, 1024), std::runtime_error);
+    CHECK_EQUAL(0u, unsupported.liveObjectsAmount);
+}
+
+TEST_CASE(constantRingWaitsForTheOldestFrameWhenFull)
+{
+    RecordingGraphicsDevice device(true);
+    RecordingGraphicsContext& context = device.getContext();
+    context.holdFences(true);
+    ConstantRing ring(&device, 1024);
+    Constants constants = makeConstants(3.0f);
+
+    ring.map(&context);
+    ring.push(constants);
+    ring.push(constants);
+    ring.push(constants);
+    ring.unmap();
+    ring.endFrame(&context);
+    context.takeCalls();
+
+    // The second frame wraps into the first one's windows and has to wait for its fence
+    ring.map(&context);
+    CHECK_EQUAL(48u, ring.push(constants).firstConstant);
+    CHECK_EQUAL(0u, ring.push(constants).firstConstant);
+    ring.unmap();
+    ring.endFrame(&context);
+    CHECK(context.takeCalls() == Calls({
+        "map Buffer0 no overwrite", "waitFence Fence1", "unmap Buffer0", "signalFence Fence2"
+    }));
+}
+
+TEST_CASE(constantRingRejectsFramesLargerThanTheRing)
+{
+    RecordingGraphicsDevice device(true);
+    RecordingGraphicsContext& context = device.getContext();
+    ConstantRing ring(&device, 1000);
+    Constants constants = makeConstants(4.0f);
+    CHECK_THROWS(ring.push(constants), std::runtime_error);
+
+    // The capacity is rounded up to whole windows, four of them
+    ring.map(&context);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        CHECK_EQUAL(i * 16, ring.push(constants).firstConstant);
+    }
+    CHECK_THROWS(ring.push(constants), std::runtime_error);
+}
+
+TEST_CASE(constantRingReleasesFramesInOrder)
+{
+    RecordingGraphicsDevice device(true);
+    RecordingGraphicsContext& context = device.getContext();
+    context.holdFences(true);
+    ConstantRing ring(&device, 4096);
+    Constants constants = makeConstants(5.0f);
+    for (uint32_t frame = 0; frame < 3; frame++)
+    {
+        ring.map(&context);
+        ring.push(constants);
+        ring.unmap();
+        ring.endFrame(&context);
+    }
+    CHECK_EQUAL(768u, ring.getUsedBytes());
+
+    // Frame 2 finishing first frees nothing, space only comes back behind the oldest frame
+    context.completeFence(device.getFence(2));
+    ring.map(&context);
+    ring.unmap();
+    CHECK_EQUAL(768u, ring.getUsedBytes());
+
+    context.completeFence(device.getFence(1));
+    ring.map(&context);
+    ring.unmap();
+    CHECK_EQUAL(256u, ring.getUsedBytes());
+    CHECK(context.takeCalls().back() == "unmap Buffer0");
+}
+
+TEST_CASE(constantRingLimitsFramesInFlight)
+{
+    RecordingGraphicsDevice device(true);
+    RecordingGraphicsContext& context = device.getContext();
+    context.holdFences(true);
+    ConstantRing ring(&device, 65536);
+    Constants constants = makeConstants(6.0f);
+    for (uint32_t frame = 1; frame <= CONSTANT_RING_FENCES_AMOUNT + 2; frame++)
+    {
+        ring.map(&context);
+        ring.push(constants);
+        ring.unmap();
+        ring.endFrame(&context);
+    }
+    // A fence is only signaled again once the frame that used it before is done
+    Calls calls = context.takeCalls();
+    Calls waits;
+    for (auto& call : calls)
+    {
+        if (call.compare(0, 9, "waitFence") == 0)
+        {
+            waits.push_back(call);
+        }
+    }
+    CHECK(waits == Calls({"waitFence Fence1", "waitFence Fence2"}));
+    CHECK(calls.back() == "signalFence Fence2");
+    CHECK_EQUAL(CONSTANT_RING_FENCES_AMOUNT * 256u, ring.getUsedBytes());
+}
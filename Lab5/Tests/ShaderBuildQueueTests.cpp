@@ -0,0 +1,287 @@
+#include "TestFramework.h"
+
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include "DXShader/ShaderBuildQueue.h"
+
+namespace
+{
+    /*
+     * Stands in for D3DCompile. The bytecode spells out the request, targets can be made to fail or to block until
+     * released, and every compilation is counted per stage.
+     */
+    class FakeShaderCompiler
+    {
+    private:
+        std::mutex mutex;
+        std::map<std::string, uint32_t> compilations;
+        std::set<std::string> failingTargets;
+        std::map<std::string, std::shared_future<void>> heldTargets;
+        std::map<std::string, std::promise<void>> releases;
+
+    public:
+        static std::string describe(const ShaderStageRequest& request)
+        {
+            std::string description(request.sourcePath.begin(), request.sourcePath.end());
+            for (auto& define : request.defines)
+            {
+                description += " " + define.first + "=" + define.second;
+            }
+            return description + " " + request.entryPoint + " " + request.target;
+        }
+
+        ShaderBuildQueue::Compiler getCompiler()
+        {
+            return [this](const ShaderStageRequest& request) { return compile(request); };
+        }
+
+        void fail(const std::string& target)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failingTargets.insert(target);
+        }
+
+        void hold(const std::string& target)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            heldTargets[target] = releases[target].get_future().share();
+        }
+
+        void release(const std::string& target)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            releases[target].set_value();
+            heldTargets.erase(target);
+        }
+
+        uint32_t getCompilations(const ShaderStageRequest& request)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return compilations[describe(request)];
+        }
+
+    private:
+        CompiledShaderStage compile(const ShaderStageRequest& request)
+        {
+            std::shared_future<void> held;
+            bool failing;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                compilations[describe(request)]++;
+                auto found = heldTargets.find(request.target);
+                if (found != heldTargets.end())
+                {
+                    held = found->second;
+                }
+                failing = failingTargets.count(request.target) != 0;
+            }
+            if (held.valid())
+            {
+                held.wait();
+            }
+            if (failing)
+            {
+                throw std::runtime_error("error X3000: " + describe(request));
+            }
+            std::string description = describe(request);
+            CompiledShaderStage stage;
+            stage.bytecode.assign(description.begin(), description.end());
+            stage.includedFiles.push_back("Common.hlsli");
+            return stage;
+        }
+    };
+
+    ShaderStageRequest makeStage(const wchar_t* sourcePath, const char* target)
+    {
+        ShaderStageRequest request;
+        request.sourcePath = sourcePath;
+        request.target = target;
+        return request;
+    }
+
+    std::string toText(const ShaderStageResult& stage)
+    {
+        return std::string(stage->bytecode.begin(), stage->bytecode.end());
+    }
+
+    std::string joinStages(const std::vector<ShaderStageResult>& stages)
+    {
+        std::string joined;
+        for (auto& stage : stages)
+        {
+            joined += (joined.empty() ? "" : "|") + toText(stage);
+        }
+        return joined;
+    }
+}
+
+TEST_CASE(identicalStagesCompileOnce)
+{
+    FakeShaderCompiler compiler;
+    JobSystem jobs(4);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    ShaderStageRequest vertex = makeStage(L"Vertex.hlsl", "vs_5_0");
+    std::vector<std::shared_future<std::string>> programs;
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        ShaderStageRequest pixel = makeStage(L"Pixel.hlsl", "ps_5_0");
+        pixel.defines = {{"MODE", std::to_string(i % 4)}};
+        programs.push_back(queue.buildProgram<std::string>({vertex, pixel}, joinStages));
+    }
+    for (uint32_t i = 0; i < programs.size(); i++)
+    {
+        CHECK_EQUAL("Vertex.hlsl main vs_5_0|Pixel.hlsl MODE=" + std::to_string(i % 4) + " main ps_5_0",
+                    programs[i].get());
+    }
+    queue.waitIdle();
+
+    CHECK_EQUAL(1u, compiler.getCompilations(vertex));
+    for (uint32_t mode = 0; mode < 4; mode++)
+    {
+        ShaderStageRequest pixel = makeStage(L"Pixel.hlsl", "ps_5_0");
+        pixel.defines = {{"MODE", std::to_string(mode)}};
+        CHECK_EQUAL(1u, compiler.getCompilations(pixel));
+    }
+    CHECK_EQUAL(5u, queue.getCompiledStagesAmount());
+    CHECK_EQUAL(75u, queue.getSharedStagesAmount());
+}
+
+TEST_CASE(sharedStageIsOneResult)
+{
+    FakeShaderCompiler compiler;
+    JobSystem jobs(2);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    ShaderStageRequest pixel = makeStage(L"Pixel.hlsl", "ps_5_0");
+    ShaderStageResult first = queue.buildStage(pixel).get();
+    ShaderStageResult second = queue.buildStage(pixel).get();
+    CHECK(first == second);
+    CHECK_EQUAL(1u, queue.getCompiledStagesAmount());
+
+    // Anything that changes the bytecode is a different stage
+    ShaderStageRequest otherEntryPoint = pixel;
+    otherEntryPoint.entryPoint = "mainAlpha";
+    ShaderStageRequest otherTarget = pixel;
+    otherTarget.target = "ps_5_1";
+    CHECK(queue.buildStage(otherEntryPoint).get() != first);
+    CHECK(queue.buildStage(otherTarget).get() != first);
+    CHECK_EQUAL(3u, queue.getCompiledStagesAmount());
+}
+
+TEST_CASE(invalidatedStageCompilesAgain)
+{
+    FakeShaderCompiler compiler;
+    JobSystem jobs(2);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    ShaderStageRequest pixel = makeStage(L"Pixel.hlsl", "ps_5_0");
+    ShaderStageResult first = queue.buildStage(pixel).get();
+    queue.invalidateStage(pixel);
+    ShaderStageResult second = queue.buildStage(pixel).get();
+    CHECK(first != second);
+    CHECK_EQUAL(2u, compiler.getCompilations(pixel));
+}
+
+TEST_CASE(compilerErrorReachesFutures)
+{
+    FakeShaderCompiler compiler;
+    compiler.fail("ps_5_0");
+    JobSystem jobs(4);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    ShaderStageRequest vertex = makeStage(L"Vertex.hlsl", "vs_5_0");
+    ShaderStageRequest pixel = makeStage(L"Broken.hlsl", "ps_5_0");
+    std::atomic<uint32_t> createdAmount{0};
+    auto create = [&](const std::vector<ShaderStageResult>& stages)
+    {
+        createdAmount++;
+        return (uint32_t)stages.size();
+    };
+    std::shared_future<uint32_t> failed = queue.buildProgram<uint32_t>({vertex, pixel}, create);
+    // Both stages fail, the program still reports once
+    std::shared_future<uint32_t> bothFailed = queue.buildProgram<uint32_t>({pixel, pixel}, create);
+    std::shared_future<uint32_t> working = queue.buildProgram<uint32_t>({vertex}, create);
+
+    try
+    {
+        failed.get();
+        CHECK(false);
+    }
+    catch (const std::runtime_error& e)
+    {
+        CHECK_EQUAL(std::string("error X3000: Broken.hlsl main ps_5_0"), std::string(e.what()));
+    }
+    CHECK_THROWS(bothFailed.get(), std::runtime_error);
+    CHECK_THROWS(queue.buildStage(pixel).get(), std::runtime_error);
+    CHECK_EQUAL(1u, working.get());
+    queue.waitIdle();
+    CHECK_EQUAL(1u, createdAmount.load());
+    CHECK_EQUAL(1u, compiler.getCompilations(pixel));
+    CHECK_EQUAL(1u, queue.getCompiledStagesAmount());
+}
+
+TEST_CASE(createErrorReachesFuture)
+{
+    FakeShaderCompiler compiler;
+    JobSystem jobs(2);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    std::shared_future<int> program = queue.buildProgram<int>({makeStage(L"Vertex.hlsl", "vs_5_0")},
+        [](const std::vector<ShaderStageResult>&) -> int
+        {
+            throw std::invalid_argument("input layout does not match");
+        });
+    CHECK_THROWS(program.get(), std::invalid_argument);
+}
+
+TEST_CASE(stagesArriveInRequestOrder)
+{
+    FakeShaderCompiler compiler;
+    compiler.hold("vs_5_0");
+    JobSystem jobs(3);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    ShaderStageRequest vertex = makeStage(L"Vertex.hlsl", "vs_5_0");
+    ShaderStageRequest pixel = makeStage(L"Pixel.hlsl", "ps_5_0");
+    std::atomic<bool> created{false};
+    std::shared_future<std::string> program = queue.buildProgram<std::string>({vertex, pixel},
+        [&](const std::vector<ShaderStageResult>& stages)
+        {
+            created = true;
+            return joinStages(stages);
+        });
+
+    // The pixel stage finishes first, the program waits for the held vertex stage
+    CHECK_EQUAL(std::string("Pixel.hlsl main ps_5_0"), toText(queue.buildStage(pixel).get()));
+    CHECK(program.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout);
+    CHECK(!created);
+
+    compiler.release("vs_5_0");
+    CHECK_EQUAL(std::string("Vertex.hlsl main vs_5_0|Pixel.hlsl main ps_5_0"), program.get());
+}
+
+TEST_CASE(finishedStagesStartProgramsRightAway)
+{
+    FakeShaderCompiler compiler;
+    JobSystem jobs(2);
+    ShaderBuildQueue queue(compiler.getCompiler(), jobs);
+
+    ShaderStageRequest vertex = makeStage(L"Vertex.hlsl", "vs_5_0");
+    ShaderStageRequest pixel = makeStage(L"Pixel.hlsl", "ps_5_0");
+    queue.buildStage(vertex).get();
+    queue.buildStage(pixel).get();
+    queue.waitIdle();
+
+    std::shared_future<std::string> program = queue.buildProgram<std::string>({pixel, vertex}, joinStages);
+    CHECK_EQUAL(std::string("Pixel.hlsl main ps_5_0|Vertex.hlsl main vs_5_0"), program.get());
+    CHECK_EQUAL(2u, queue.getCompiledStagesAmount());
+
+    std::shared_future<size_t> empty = queue.buildProgram<size_t>({},
+        [](const std::vector<ShaderStageResult>& stages) { return stages.size(); });
+    CHECK_EQUAL(0u, empty.get());
+}
@@ -0,0 +1,208 @@
+#include "TestFramework.h"
+
+#include <filesystem>
+#include "DXShader/ShaderCache.h"
+
+namespace
+{
+    struct CacheFixture
+    {
+        std::string directory;
+        std::string sourcePath;
+        std::string includePath;
+        ShaderCacheRequest request;
+        std::vector<uint8_t> bytecode = {0x44, 0x58, 0x42, 0x43, 1, 2, 3, 4};
+
+        CacheFixture()
+        {
+            directory = Testing::makeTemporaryDirectory("shadercache");
+            sourcePath = directory + "/Shader.hlsl";
+            includePath = directory + "/Common.hlsli";
+            Testing::writeTextFile(sourcePath, "#include \"Common.hlsli\"\nfloat4 main() : SV_Target { return c; }\n");
+            Testing::writeTextFile(includePath, "static const float4 c = 1;\n");
+            request.sourcePath = sourcePath;
+            request.defines = {{"USE_SHADOWS", "1"}};
+            request.entryPoint = "main";
+            request.target = "ps_5_0";
+            request.compilerTag = "test";
+        }
+
+        std::string cacheDirectory() const
+        {
+            return directory + "/cache";
+        }
+
+        void store(ShaderCache& cache) const
+        {
+            cache.store(request, {includePath}, bytecode.data(), bytecode.size(), 12.0);
+        }
+
+        std::vector<std::string> findCacheFiles(const char* extension) const
+        {
+            std::vector<std::string> paths;
+            for (auto& entry : std::filesystem::directory_iterator(cacheDirectory()))
+            {
+                if (entry.path().extension() == extension)
+                {
+                    paths.push_back(entry.path().string());
+                }
+            }
+            return paths;
+        }
+    };
+}
+
+TEST_CASE(storedEntryIsHit)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+
+    std::vector<uint8_t> bytecode;
+    std::vector<std::string> includedFiles;
+    CHECK(cache.load(fixture.request, bytecode, &includedFiles));
+    CHECK(bytecode == fixture.bytecode);
+    REQUIRE(includedFiles.size() == 1);
+    CHECK_EQUAL(fixture.includePath, includedFiles[0]);
+
+    ShaderCacheStats stats = cache.getStats();
+    CHECK_EQUAL(1u, stats.hits);
+    CHECK_EQUAL(0u, stats.misses);
+    CHECK_EQUAL(12.0, stats.savedMilliseconds);
+}
+
+TEST_CASE(storeLeavesNoTemporaryFiles)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+    fixture.store(cache);
+
+    CHECK_EQUAL(1u, fixture.findCacheFiles(".manifest").size());
+    CHECK_EQUAL(1u, fixture.findCacheFiles(".cso").size());
+    CHECK_EQUAL(0u, fixture.findCacheFiles(".tmp").size());
+}
+
+TEST_CASE(emptyCacheIsMiss)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+
+    std::vector<uint8_t> bytecode;
+    CHECK(!cache.load(fixture.request, bytecode));
+    CHECK_EQUAL(1u, cache.getStats().misses);
+}
+
+TEST_CASE(editedIncludeIsMiss)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+
+    Testing::writeTextFile(fixture.includePath, "static const float4 c = 0.5;\n");
+    std::vector<uint8_t> bytecode;
+    CHECK(!cache.load(fixture.request, bytecode));
+
+    // Storing the recompiled shader makes the edited content a hit again
+    fixture.store(cache);
+    CHECK(cache.load(fixture.request, bytecode));
+}
+
+TEST_CASE(editedSourceIsMiss)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+
+    Testing::writeTextFile(fixture.sourcePath, "float4 main() : SV_Target { return 0; }\n");
+    std::vector<uint8_t> bytecode;
+    CHECK(!cache.load(fixture.request, bytecode));
+}
+
+TEST_CASE(deletedIncludeIsMiss)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+
+    std::filesystem::remove(fixture.includePath);
+    std::vector<uint8_t> bytecode;
+    CHECK(!cache.load(fixture.request, bytecode));
+}
+
+TEST_CASE(changedDefineOrTargetIsMiss)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+    std::vector<uint8_t> bytecode;
+
+    ShaderCacheRequest changedDefine = fixture.request;
+    changedDefine.defines[0].second = "0";
+    CHECK(!cache.load(changedDefine, bytecode));
+
+    ShaderCacheRequest addedDefine = fixture.request;
+    addedDefine.defines.push_back({"USE_FOG", "1"});
+    CHECK(!cache.load(addedDefine, bytecode));
+
+    ShaderCacheRequest changedTarget = fixture.request;
+    changedTarget.target = "ps_5_1";
+    CHECK(!cache.load(changedTarget, bytecode));
+
+    ShaderCacheRequest changedEntryPoint = fixture.request;
+    changedEntryPoint.entryPoint = "mainAlpha";
+    CHECK(!cache.load(changedEntryPoint, bytecode));
+
+    ShaderCacheRequest changedCompiler = fixture.request;
+    changedCompiler.compilerTag = "test2";
+    CHECK(!cache.load(changedCompiler, bytecode));
+
+    CHECK(cache.load(fixture.request, bytecode));
+    CHECK_EQUAL(5u, cache.getStats().misses);
+}
+
+TEST_CASE(corruptManifestIsMiss)
+{
+    const char* corruptManifests[] = {
+        "",
+        "shadercache 1\n",
+        "shadercache 2\ncontent 0000000000000000\ncompile 1\n",
+        "shadercache 1\ncontent \ncompile 1\n",
+        "shadercache 1\ncontent zzzzzzzzzzzzzzzz\ncompile 1\n",
+        "shadercache 1\ncontent 123\ncompile 1\n",
+        "shadercache 1\ncontent 00000000000000001234\ncompile 1\n",
+        "shadercache 1\ncontent -000000000000001\ncompile 1\n",
+        "shadercache 1\ncontent 0000000000000000\ncompile x\n",
+        "\x01\x02\x03\xff garbage",
+    };
+    for (const char* corruptManifest : corruptManifests)
+    {
+        CacheFixture fixture;
+        ShaderCache cache(fixture.cacheDirectory());
+        fixture.store(cache);
+        std::vector<std::string> manifests = fixture.findCacheFiles(".manifest");
+        REQUIRE(manifests.size() == 1);
+        Testing::writeTextFile(manifests[0], corruptManifest);
+
+        std::vector<uint8_t> bytecode;
+        CHECK(!cache.load(fixture.request, bytecode));
+
+        // The next store replaces the damaged manifest
+        fixture.store(cache);
+        CHECK(cache.load(fixture.request, bytecode));
+    }
+}
+
+TEST_CASE(missingBytecodeIsMiss)
+{
+    CacheFixture fixture;
+    ShaderCache cache(fixture.cacheDirectory());
+    fixture.store(cache);
+    for (auto& path : fixture.findCacheFiles(".cso"))
+    {
+        std::filesystem::remove(path);
+    }
+
+    std::vector<uint8_t> bytecode;
+    CHECK(!cache.load(fixture.request, bytecode));
+}
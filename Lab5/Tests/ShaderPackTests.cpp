@@ -0,0 +1,257 @@
+#include "TestFramework.h"
+
+#include <cstring>
+#include <stdexcept>
+#include "DXShader/ShaderPack.h"
+
+namespace
+{
+    std::vector<uint8_t> makeBlob(const std::string& text)
+    {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    std::vector<uint8_t> makePack(const std::vector<std::pair<uint64_t, std::string>>& blobs)
+    {
+        ShaderPackWriter writer;
+        for (auto& blob : blobs)
+        {
+            writer.add(blob.first, blob.second.data(), blob.second.size());
+        }
+        return writer.serialize();
+    }
+
+    std::string findText(const ShaderPackReader& reader, uint64_t key)
+    {
+        const uint8_t* pBytecode = nullptr;
+        size_t size = 0;
+        if (!reader.find(key, &pBytecode, &size))
+        {
+            return "<missing>";
+        }
+        return std::string((const char*)pBytecode, size);
+    }
+
+    ShaderPackEntry readEntry(const std::vector<uint8_t>& pack, uint32_t index)
+    {
+        ShaderPackEntry entry;
+        memcpy(&entry, pack.data() + sizeof(ShaderPackHeader) + sizeof(ShaderPackEntry) * index, sizeof(entry));
+        return entry;
+    }
+
+    void writeEntry(std::vector<uint8_t>& pack, uint32_t index, const ShaderPackEntry& entry)
+    {
+        memcpy(pack.data() + sizeof(ShaderPackHeader) + sizeof(ShaderPackEntry) * index, &entry, sizeof(entry));
+    }
+
+    std::string describe(const ShaderPackSource& source)
+    {
+        std::string description = source.sourcePath + " " + source.target;
+        for (auto& define : source.defines)
+        {
+            description += " " + define.first + "=" + define.second;
+        }
+        return description;
+    }
+}
+
+TEST_CASE(serializedPackFindsEveryEntry)
+{
+    // Added out of key order, one of them empty
+    std::vector<uint8_t> pack = makePack({{30, "pixel"}, {10, "vertex shader"}, {20, ""}, {40, "compute"}});
+    ShaderPackReader reader;
+    reader.openMemory(pack.data(), pack.size());
+    CHECK_EQUAL(4u, reader.getEntriesAmount());
+    CHECK_EQUAL(std::string("vertex shader"), findText(reader, 10));
+    CHECK_EQUAL(std::string(""), findText(reader, 20));
+    CHECK_EQUAL(std::string("pixel"), findText(reader, 30));
+    CHECK_EQUAL(std::string("compute"), findText(reader, 40));
+    CHECK_EQUAL(std::string("<missing>"), findText(reader, 0));
+    CHECK_EQUAL(std::string("<missing>"), findText(reader, 25));
+    CHECK_EQUAL(std::string("<missing>"), findText(reader, 50));
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        CHECK_EQUAL(0u, readEntry(pack, i).offset % SHADER_PACK_ALIGNMENT);
+    }
+}
+
+TEST_CASE(emptyPackFindsNothing)
+{
+    std::vector<uint8_t> pack = makePack({});
+    ShaderPackReader reader;
+    reader.openMemory(pack.data(), pack.size());
+    CHECK_EQUAL(0u, reader.getEntriesAmount());
+    CHECK_EQUAL(std::string("<missing>"), findText(reader, 1));
+}
+
+TEST_CASE(unalignedPackIsRead)
+{
+    std::vector<uint8_t> pack = makePack({{1, "a"}, {2, "bc"}, {3, "def"}});
+    std::vector<uint8_t> shifted(pack.size() + 1);
+    memcpy(shifted.data() + 1, pack.data(), pack.size());
+    ShaderPackReader reader;
+    reader.openMemory(shifted.data() + 1, pack.size());
+    CHECK_EQUAL(std::string("bc"), findText(reader, 2));
+    CHECK_EQUAL(std::string("def"), findText(reader, 3));
+}
+
+TEST_CASE(writtenPackIsMapped)
+{
+    std::string path = Testing::makeTemporaryDirectory("shaderpack") + "/" + SHADER_PACK_FILE_NAME;
+    ShaderPackWriter writer;
+    std::vector<uint8_t> blob = makeBlob("bytecode");
+    writer.add(7, blob.data(), blob.size());
+    REQUIRE(writer.write(path));
+
+    ShaderPackReader reader;
+    REQUIRE(reader.open(path));
+    CHECK_EQUAL(std::string("bytecode"), findText(reader, 7));
+
+    ShaderPackReader missing;
+    CHECK(!missing.open(path + ".missing"));
+}
+
+TEST_CASE(duplicateKeyThrows)
+{
+    ShaderPackWriter writer;
+    writer.add(5, "a", 1);
+    writer.add(6, "b", 1);
+    CHECK_THROWS(writer.add(5, "c", 1), std::runtime_error);
+
+    // The rejected blob left the pack as it was
+    std::vector<uint8_t> pack = writer.serialize();
+    ShaderPackReader reader;
+    reader.openMemory(pack.data(), pack.size());
+    CHECK_EQUAL(2u, reader.getEntriesAmount());
+    CHECK_EQUAL(std::string("a"), findText(reader, 5));
+}
+
+TEST_CASE(damagedHeaderThrows)
+{
+    std::vector<uint8_t> pack = makePack({{1, "a"}});
+    ShaderPackReader reader;
+    CHECK_THROWS(reader.openMemory(pack.data(), sizeof(ShaderPackHeader) - 1), std::runtime_error);
+
+    std::vector<uint8_t> wrongMagic = pack;
+    wrongMagic[0] ^= 0xFF;
+    CHECK_THROWS(reader.openMemory(wrongMagic.data(), wrongMagic.size()), std::runtime_error);
+
+    std::vector<uint8_t> wrongVersion = pack;
+    ShaderPackHeader header;
+    memcpy(&header, wrongVersion.data(), sizeof(header));
+    header.version = SHADER_PACK_VERSION + 1;
+    memcpy(wrongVersion.data(), &header, sizeof(header));
+    CHECK_THROWS(reader.openMemory(wrongVersion.data(), wrongVersion.size()), std::runtime_error);
+}
+
+TEST_CASE(truncatedTableOfContentsThrows)
+{
+    std::vector<uint8_t> pack = makePack({{1, "a"}, {2, "b"}});
+    ShaderPackReader reader;
+    CHECK_THROWS(reader.openMemory(pack.data(), sizeof(ShaderPackHeader) + sizeof(ShaderPackEntry) + 8),
+                 std::runtime_error);
+
+    // An entry count far past the end of the data
+    std::vector<uint8_t> huge = pack;
+    ShaderPackHeader header;
+    memcpy(&header, huge.data(), sizeof(header));
+    header.entriesAmount = 0xFFFFFFFFu;
+    memcpy(huge.data(), &header, sizeof(header));
+    CHECK_THROWS(reader.openMemory(huge.data(), huge.size()), std::runtime_error);
+    CHECK_EQUAL(0u, reader.getEntriesAmount());
+}
+
+TEST_CASE(unsortedTableOfContentsThrows)
+{
+    std::vector<uint8_t> pack = makePack({{1, "a"}, {2, "b"}, {3, "c"}});
+    ShaderPackEntry first = readEntry(pack, 0);
+    ShaderPackEntry last = readEntry(pack, 2);
+    writeEntry(pack, 0, last);
+    writeEntry(pack, 2, first);
+    ShaderPackReader reader;
+    CHECK_THROWS(reader.openMemory(pack.data(), pack.size()), std::runtime_error);
+
+    std::vector<uint8_t> duplicated = makePack({{1, "a"}, {2, "b"}});
+    ShaderPackEntry second = readEntry(duplicated, 1);
+    second.key = 1;
+    writeEntry(duplicated, 1, second);
+    CHECK_THROWS(reader.openMemory(duplicated.data(), duplicated.size()), std::runtime_error);
+}
+
+TEST_CASE(outOfBoundsEntryThrows)
+{
+    std::vector<uint8_t> pack = makePack({{1, "a"}, {2, "bytes"}});
+    ShaderPackReader reader;
+
+    std::vector<uint8_t> pastEnd = pack;
+    ShaderPackEntry entry = readEntry(pastEnd, 1);
+    entry.offset = pastEnd.size() + 1;
+    writeEntry(pastEnd, 1, entry);
+    CHECK_THROWS(reader.openMemory(pastEnd.data(), pastEnd.size()), std::runtime_error);
+
+    std::vector<uint8_t> tooLong = pack;
+    entry = readEntry(tooLong, 1);
+    entry.size = tooLong.size() - entry.offset + 1;
+    writeEntry(tooLong, 1, entry);
+    CHECK_THROWS(reader.openMemory(tooLong.data(), tooLong.size()), std::runtime_error);
+
+    // offset + size wraps around
+    std::vector<uint8_t> wrapping = pack;
+    entry = readEntry(wrapping, 1);
+    entry.size = ~0ull - entry.offset + 2;
+    writeEntry(wrapping, 1, entry);
+    CHECK_THROWS(reader.openMemory(wrapping.data(), wrapping.size()), std::runtime_error);
+
+    // The last blob ends exactly at the end of the file
+    entry = readEntry(pack, 1);
+    CHECK_THROWS(reader.openMemory(pack.data(), (size_t)(entry.offset + entry.size - 1)), std::runtime_error);
+    reader.openMemory(pack.data(), (size_t)(entry.offset + entry.size));
+    CHECK_EQUAL(std::string("bytes"), findText(reader, 2));
+}
+
+TEST_CASE(makeKeyCoversTheRequest)
+{
+    std::vector<std::pair<std::string, std::string>> defines = {{"MODE", "1"}};
+    uint64_t key = ShaderPack::makeKey("Shaders/Pixel.hlsl", defines, "main", "ps_5_0");
+    CHECK_EQUAL(key, ShaderPack::makeKey("Shaders/Pixel.hlsl", defines, "main", "ps_5_0"));
+    CHECK(key != ShaderPack::makeKey("Shaders/Pixel2.hlsl", defines, "main", "ps_5_0"));
+    CHECK(key != ShaderPack::makeKey("Shaders/Pixel.hlsl", {{"MODE", "2"}}, "main", "ps_5_0"));
+    CHECK(key != ShaderPack::makeKey("Shaders/Pixel.hlsl", {}, "main", "ps_5_0"));
+    CHECK(key != ShaderPack::makeKey("Shaders/Pixel.hlsl", defines, "mainAlpha", "ps_5_0"));
+    CHECK(key != ShaderPack::makeKey("Shaders/Pixel.hlsl", defines, "main", "ps_5_1"));
+}
+
+TEST_CASE(manifestExpandsDefineCombinations)
+{
+    std::vector<ShaderPackSource> sources;
+    std::string error;
+    REQUIRE(ShaderPack::parseManifest(
+        "# stages\n"
+        "\n"
+        "Shaders/Vertex.hlsl vs_5_0\n"
+        "Shaders/Pixel.hlsl ps_5_0 MODE=0,1,2 SHADOWS=0,1 # six permutations\n"
+        "   Shaders/Copy.hlsl   ps_5_0   FORMAT=rgba8  \n",
+        sources, error));
+    REQUIRE(sources.size() == 8);
+    CHECK_EQUAL(std::string("Shaders/Vertex.hlsl vs_5_0"), describe(sources[0]));
+    CHECK_EQUAL(std::string("Shaders/Pixel.hlsl ps_5_0 MODE=0 SHADOWS=0"), describe(sources[1]));
+    CHECK_EQUAL(std::string("Shaders/Pixel.hlsl ps_5_0 MODE=0 SHADOWS=1"), describe(sources[2]));
+    CHECK_EQUAL(std::string("Shaders/Pixel.hlsl ps_5_0 MODE=1 SHADOWS=0"), describe(sources[3]));
+    CHECK_EQUAL(std::string("Shaders/Pixel.hlsl ps_5_0 MODE=2 SHADOWS=1"), describe(sources[6]));
+    CHECK_EQUAL(std::string("Shaders/Copy.hlsl ps_5_0 FORMAT=rgba8"), describe(sources[7]));
+}
+
+TEST_CASE(manifestErrorsNameTheLine)
+{
+    std::vector<ShaderPackSource> sources;
+    std::string error;
+    CHECK(!ShaderPack::parseManifest("Shaders/Vertex.hlsl vs_5_0\n# comment\nShaders/Pixel.hlsl\n", sources, error));
+    CHECK_EQUAL(std::string("line 3: missing target for Shaders/Pixel.hlsl"), error);
+
+    CHECK(!ShaderPack::parseManifest("\nShaders/Pixel.hlsl ps_5_0 MODE\n", sources, error));
+    CHECK_EQUAL(std::string("line 2: expected NAME=VALUE, got MODE"), error);
+
+    CHECK(!ShaderPack::parseManifest("Shaders/Pixel.hlsl ps_5_0 =1\n", sources, error));
+    CHECK_EQUAL(std::string("line 1: expected NAME=VALUE, got =1"), error);
+}
@@ -0,0 +1,306 @@
+#include "TestFramework.h"
+
+#include <cstring>
+#include <memory>
+#include "../Engine/Software/SoftwareGraphicsDevice.h"
+#include "../Engine/Software/SoftwareRasterizer.h"
+
+// 2 x 2 tiles
+#define TEST_TARGET_SIZE (2u * SOFTWARE_TILE_SIZE)
+
+namespace
+{
+    /*
+     * Writes the 4 varyings as the color
+     */
+    class ColorPixelShader : public SoftwarePixelShader
+    {
+    public:
+        void shade(const SoftwareBindings&, const float*, const float* pVaryings, float* pColor) const override
+        {
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                pColor[i] = pVaryings[i];
+            }
+        }
+    };
+
+    const float clearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const float red[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+    const float green[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+    const float blue[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+    /*
+     * A quad over the pixels [left, right) x [top, bottom) at depth z, two clockwise triangles sharing a diagonal
+     */
+    struct Quad
+    {
+        SoftwareVertex vertices[4];
+
+        Quad(float left, float top, float right, float bottom, float z, const float* pColor)
+        {
+            const float corners[4][2] = {{left, top}, {right, top}, {right, bottom}, {left, bottom}};
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                SoftwareVertex& vertex = vertices[i];
+                vertex.position[0] = corners[i][0] / TEST_TARGET_SIZE * 2.0f - 1.0f;
+                vertex.position[1] = 1.0f - corners[i][1] / TEST_TARGET_SIZE * 2.0f;
+                vertex.position[2] = z;
+                vertex.position[3] = 1.0f;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    vertex.varyings[c] = pColor[c];
+                }
+            }
+        }
+    };
+
+    const uint32_t quadIndices[6] = {0, 1, 2, 0, 2, 3};
+
+    /*
+     * The clip space rectangle and color of QuadVertexShader, one 16 byte register each
+     */
+    struct QuadConstants
+    {
+        float rectangle[4];
+        float color[4];
+    };
+
+    /*
+     * Draws QuadConstants::rectangle from vertex ids 0 to 5 without a vertex buffer
+     */
+    class QuadVertexShader : public SoftwareVertexShader
+    {
+    public:
+        uint32_t getVaryingsAmount() const override
+        {
+            return 4;
+        }
+
+        void shade(const SoftwareBindings& bindings, const float*, uint32_t vertexId, uint32_t,
+                   SoftwareVertex& output) const override
+        {
+            const QuadConstants& constants = bindings.getConstants<QuadConstants>(STATE_TRACKER_VERTEX_STAGE, 0);
+            uint32_t corner = quadIndices[vertexId % 6];
+            output.position[0] = constants.rectangle[corner == 1 || corner == 2 ? 2 : 0];
+            output.position[1] = constants.rectangle[corner >= 2 ? 3 : 1];
+            output.position[2] = 0.5f;
+            output.position[3] = 1.0f;
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                output.varyings[c] = constants.color[c];
+            }
+        }
+    };
+    const uint32_t counterClockwiseIndices[3] = {0, 2, 1};
+
+    struct Scene
+    {
+        JobSystem jobs{2};
+        SoftwareRasterizer rasterizer{jobs};
+        SoftwareTexture color{TEST_TARGET_SIZE, TEST_TARGET_SIZE, 4};
+        SoftwareTexture depth{TEST_TARGET_SIZE, TEST_TARGET_SIZE, 1};
+        ColorPixelShader pixelShader;
+        SoftwareBindings bindings;
+        SoftwareDrawState state;
+
+        Scene()
+        {
+            const float farDepth = 1.0f;
+            color.clear(clearColor);
+            depth.clear(&farDepth);
+            rasterizer.setTargets(&color, &depth, {0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE, 0.0f, 1.0f});
+            state.pixelShader = &pixelShader;
+            state.bindings = &bindings;
+            state.varyingsAmount = 4;
+        }
+
+        void draw(const Quad& quad, const uint32_t* pIndices = quadIndices, uint32_t indicesAmount = 6)
+        {
+            rasterizer.drawIndexed(state, quad.vertices, 4, pIndices, indicesAmount, 1);
+        }
+
+        const SoftwareRasterizerStats& finish()
+        {
+            rasterizer.beginFrame();
+            return rasterizer.getLastFrameStats();
+        }
+
+        const float* pixel(uint32_t x, uint32_t y) const
+        {
+            return color.getTexels() + ((size_t)y * TEST_TARGET_SIZE + x) * 4;
+        }
+
+        float depthAt(uint32_t x, uint32_t y) const
+        {
+            return depth.getTexels()[(size_t)y * TEST_TARGET_SIZE + x];
+        }
+
+        /*
+         * How many pixels of [left, right) x [top, bottom) have exactly pColor
+         */
+        uint32_t countColor(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom, const float* pColor) const
+        {
+            uint32_t amount = 0;
+            for (uint32_t y = top; y < bottom; y++)
+            {
+                for (uint32_t x = left; x < right; x++)
+                {
+                    const float* value = pixel(x, y);
+                    bool equal = true;
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        equal = equal && value[c] == pColor[c];
+                    }
+                    amount += equal ? 1 : 0;
+                }
+            }
+            return amount;
+        }
+    };
+}
+
+TEST_CASE(quadCoversExactlyItsPixelsAcrossTiles)
+{
+    Scene scene;
+    scene.state.depth.depthEnable = false;
+    // Crosses the tile borders at 64 in both directions
+    scene.draw(Quad(16, 16, 112, 112, 0.5f, red));
+    const SoftwareRasterizerStats& stats = scene.finish();
+
+    CHECK_EQUAL(96u * 96u, scene.countColor(16, 16, 112, 112, red));
+    CHECK_EQUAL(TEST_TARGET_SIZE * TEST_TARGET_SIZE - 96u * 96u,
+                scene.countColor(0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE, clearColor));
+    // The top-left rule gives the shared diagonal to one of the triangles, nothing is shaded twice
+    CHECK_EQUAL((uint64_t)96 * 96, stats.shadedPixels);
+    CHECK_EQUAL((uint64_t)2, stats.submittedTriangles);
+    CHECK_EQUAL((uint64_t)0, stats.culledTriangles);
+    CHECK_EQUAL((uint64_t)0, stats.clippedTriangles);
+    // Both triangles touch all 4 tiles
+    CHECK_EQUAL((uint64_t)8, stats.binnedTriangles);
+}
+
+TEST_CASE(triangleInsideOneTileIsBinnedOnce)
+{
+    Scene scene;
+    scene.draw(Quad(70, 8, 120, 40, 0.5f, green), quadIndices, 3);
+    const SoftwareRasterizerStats& stats = scene.finish();
+
+    CHECK_EQUAL((uint64_t)1, stats.binnedTriangles);
+    // Upper right half of the 50 x 32 rectangle, the diagonal runs through pixel corners every 25 / 16 pixels
+    CHECK(stats.shadedPixels > 50 * 32 / 2 - 50 && stats.shadedPixels < 50 * 32 / 2 + 50);
+    CHECK_EQUAL((uint32_t)stats.shadedPixels, scene.countColor(64, 0, TEST_TARGET_SIZE, 64, green));
+    CHECK_EQUAL(0u, scene.countColor(0, 0, 64, TEST_TARGET_SIZE, green));
+    // The upper right corner pixel is inside, the lower left one is not
+    CHECK(scene.pixel(119, 8)[1] == 1.0f);
+    CHECK(scene.pixel(70, 39)[1] == 0.0f);
+}
+
+TEST_CASE(depthTestKeepsTheNearestSurface)
+{
+    Scene scene;
+    scene.draw(Quad(0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE, 0.8f, red));
+    scene.draw(Quad(32, 32, 96, 96, 0.2f, green));
+    // Drawn last but behind the green quad, it only replaces the red background
+    scene.draw(Quad(0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE, 0.5f, blue));
+    scene.finish();
+
+    CHECK_EQUAL(64u * 64u, scene.countColor(32, 32, 96, 96, green));
+    CHECK_EQUAL(TEST_TARGET_SIZE * TEST_TARGET_SIZE - 64u * 64u,
+                scene.countColor(0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE, blue));
+    CHECK_EQUAL(0u, scene.countColor(0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE, red));
+    CHECK(fabsf(scene.depthAt(64, 64) - 0.2f) < 1e-6f);
+    CHECK(fabsf(scene.depthAt(8, 8) - 0.5f) < 1e-6f);
+}
+
+TEST_CASE(equalDepthFailsLess)
+{
+    Scene scene;
+    scene.draw(Quad(0, 0, 64, 64, 0.5f, red));
+    scene.draw(Quad(0, 0, 64, 64, 0.5f, green));
+    scene.finish();
+
+    CHECK_EQUAL(64u * 64u, scene.countColor(0, 0, 64, 64, red));
+}
+
+TEST_CASE(backFacesAreCulled)
+{
+    Scene scene;
+    scene.draw(Quad(16, 16, 112, 112, 0.5f, red), counterClockwiseIndices, 3);
+    const SoftwareRasterizerStats& stats = scene.finish();
+
+    CHECK_EQUAL((uint64_t)1, stats.culledTriangles);
+    CHECK_EQUAL((uint64_t)0, stats.shadedPixels);
+    CHECK_EQUAL(TEST_TARGET_SIZE * TEST_TARGET_SIZE, scene.countColor(0, 0, TEST_TARGET_SIZE, TEST_TARGET_SIZE,
+                                                                      clearColor));
+
+    scene.state.raster.cullMode = SOFTWARE_CULL_NONE;
+    scene.draw(Quad(16, 16, 112, 112, 0.5f, red), counterClockwiseIndices, 3);
+    CHECK(scene.finish().shadedPixels > 0);
+}
+
+TEST_CASE(trianglesCrossingTheNearPlaneAreClipped)
+{
+    Scene scene;
+    Quad quad(16, 16, 112, 112, 0.5f, red);
+    // The lower vertices move behind the near plane
+    quad.vertices[2].position[2] = -0.5f;
+    quad.vertices[3].position[2] = -0.5f;
+    scene.draw(quad);
+    const SoftwareRasterizerStats& stats = scene.finish();
+
+    CHECK_EQUAL((uint64_t)2, stats.clippedTriangles);
+    // Depth runs linearly from 0.5 at the top to -0.5 at the bottom, the visible half ends at z = 0 on row 64
+    CHECK_EQUAL(96u * 48u, scene.countColor(16, 16, 112, 112, red));
+    CHECK(scene.pixel(64, 63)[0] == 1.0f);
+    CHECK(scene.pixel(64, 64)[0] == 0.0f);
+}
+
+TEST_CASE(deviceDrawReadsTheBoundConstantWindow)
+{
+    JobSystem jobs(2);
+    SoftwareGraphicsDevice device(jobs);
+    SoftwareGraphicsContext* context = device.getSoftwareContext();
+    SoftwareTexture* target = device.createTexture(TEST_TARGET_SIZE, TEST_TARGET_SIZE, 4);
+    target->clear(clearColor);
+    StateHandle targetView = device.createView(target);
+    GraphicsProgram program = {device.createVertexShader(std::make_unique<QuadVertexShader>()),
+                               device.createPixelShader(std::make_unique<ColorPixelShader>()), nullptr};
+
+    // Register 0 is another draw's window, the quad's constants start at register 1. Pixels 32 to 96 in both
+    // directions.
+    float registers[12] = {};
+    QuadConstants constants = {{-0.5f, 0.5f, 0.5f, -0.5f}, {0.0f, 1.0f, 0.0f, 1.0f}};
+    memcpy(registers + 4, &constants, sizeof(constants));
+    GraphicsBufferDesc bufferDesc;
+    bufferDesc.size = sizeof(registers);
+    bufferDesc.bindFlags = GRAPHICS_BIND_CONSTANT_BUFFER;
+    GraphicsBuffer buffer = device.createBuffer(bufferDesc, registers);
+    StateConstantBuffer binding = {buffer.buffer, 1, 2};
+
+    context->setRenderTargets(1, &targetView, nullptr);
+    context->setViewport({0.0f, 0.0f, (float)TEST_TARGET_SIZE, (float)TEST_TARGET_SIZE, 0.0f, 1.0f});
+    context->setProgram(program);
+    context->setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, 0, 1, &binding);
+    context->draw(6, 0);
+    context->beginFrame();
+
+    const SoftwareRasterizerStats& stats = context->getLastFrameRasterStats();
+    CHECK_EQUAL((uint64_t)0, stats.culledTriangles);
+    CHECK_EQUAL((uint64_t)64 * 64, stats.shadedPixels);
+    uint32_t greenPixels = 0;
+    for (uint32_t i = 0; i < TEST_TARGET_SIZE * TEST_TARGET_SIZE; i++)
+    {
+        const float* texel = target->getTexels() + (size_t)i * 4;
+        greenPixels += texel[0] == 0.0f && texel[1] == 1.0f && texel[3] == 1.0f ? 1 : 0;
+    }
+    CHECK_EQUAL(64u * 64u, greenPixels);
+    CHECK(target->getTexels()[((size_t)32 * TEST_TARGET_SIZE + 32) * 4 + 1] == 1.0f);
+
+    // A window shorter than the constants reads zeros, the quad collapses to a point
+    binding.constantsAmount = 1;
+    context->setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, 0, 1, &binding);
+    context->draw(6, 0);
+    context->beginFrame();
+    CHECK_EQUAL((uint64_t)0, context->getLastFrameRasterStats().shadedPixels);
+}
@@ -0,0 +1,111 @@
+#include "TestFramework.h"
+
+#include <memory>
+#include <thread>
+#include "Utils/SpscQueue.h"
+
+TEST_CASE(queueFailsWhenFullOrEmpty)
+{
+    SpscQueue<uint32_t> queue(3);
+    CHECK_EQUAL(4u, queue.getCapacity());
+    uint32_t item = 0;
+    CHECK(queue.isEmpty());
+    CHECK(!queue.pop(item));
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        CHECK(queue.push(i));
+    }
+    CHECK(!queue.push(4));
+    CHECK(!queue.isEmpty());
+
+    // The indices keep counting past the capacity, the slots are reused in order
+    for (uint32_t round = 0; round < 10; round++)
+    {
+        REQUIRE(queue.pop(item));
+        CHECK_EQUAL(round, item);
+        CHECK(queue.push(round + 4));
+        CHECK(!queue.push(0));
+    }
+    for (uint32_t i = 10; i < 14; i++)
+    {
+        REQUIRE(queue.pop(item));
+        CHECK_EQUAL(i, item);
+    }
+    CHECK(!queue.pop(item));
+    CHECK(queue.isEmpty());
+}
+
+TEST_CASE(queueKeepsOrderBetweenThreads)
+{
+    const uint64_t itemsAmount = 300000;
+    for (uint32_t capacity : {1u, 4u, 1024u})
+    {
+        SpscQueue<uint64_t> queue(capacity);
+        uint64_t fullAmount = 0;
+        std::thread producer([&]()
+        {
+            for (uint64_t i = 1; i <= itemsAmount; i++)
+            {
+                while (!queue.push(i))
+                {
+                    fullAmount++;
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        // Items arrive exactly once and in the order they were pushed
+        uint64_t expected = 1;
+        uint64_t outOfOrderAmount = 0;
+        uint64_t emptyAmount = 0;
+        uint64_t item = 0;
+        while (expected <= itemsAmount)
+        {
+            if (!queue.pop(item))
+            {
+                emptyAmount++;
+                std::this_thread::yield();
+                continue;
+            }
+            outOfOrderAmount += item != expected;
+            expected = item + 1;
+        }
+        producer.join();
+        CHECK_EQUAL(0u, outOfOrderAmount);
+        CHECK_EQUAL(itemsAmount + 1, expected);
+        CHECK(!queue.pop(item));
+        // Both sides ran into the other one at some point, otherwise the test did not race
+        CHECK(capacity > 1 || (fullAmount > 0 && emptyAmount > 0));
+    }
+}
+
+TEST_CASE(queueMovesItems)
+{
+    SpscQueue<std::unique_ptr<uint32_t>> queue(2);
+    const uint32_t itemsAmount = 100000;
+    std::thread producer([&]()
+    {
+        for (uint32_t i = 0; i < itemsAmount; i++)
+        {
+            std::unique_ptr<uint32_t> item(new uint32_t(i));
+            while (!queue.push(std::move(item)))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint32_t mismatchedAmount = 0;
+    std::unique_ptr<uint32_t> item;
+    for (uint32_t i = 0; i < itemsAmount;)
+    {
+        if (!queue.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        mismatchedAmount += !item || *item != i;
+        i++;
+    }
+    producer.join();
+    CHECK_EQUAL(0u, mismatchedAmount);
+}
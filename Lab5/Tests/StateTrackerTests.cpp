@@ -0,0 +1,225 @@
+#include "TestFramework.h"
+
+#include "RecordingGraphicsContext.h"
+
+namespace
+{
+    typedef std::vector<std::string> Calls;
+
+    /*
+     * Named stand-ins for API objects, the tracker only compares their addresses
+     */
+    struct Objects
+    {
+        int vertexShader, pixelShader, otherPixelShader, layout;
+        int sceneTarget, bloomTarget, backBuffer, depth;
+        int albedo, normals, environment;
+        int linearSampler, pointSampler;
+        int frameConstants, objectConstants;
+        int vertexBuffer, indexBuffer;
+        int blend, rasterizer;
+
+        void name(RecordingGraphicsContext& context)
+        {
+            const std::pair<const int*, const char*> names[] = {
+                {&vertexShader, "VS"}, {&pixelShader, "PS"}, {&otherPixelShader, "PS2"}, {&layout, "Layout"},
+                {&sceneTarget, "Scene"}, {&bloomTarget, "Bloom"}, {&backBuffer, "BackBuffer"}, {&depth, "Depth"},
+                {&albedo, "Albedo"}, {&normals, "Normals"}, {&environment, "Environment"},
+                {&linearSampler, "Linear"}, {&pointSampler, "Point"}, {&frameConstants, "Frame"},
+                {&objectConstants, "Object"}, {&vertexBuffer, "VB"}, {&indexBuffer, "IB"}, {&blend, "Blend"},
+                {&rasterizer, "Rasterizer"}
+            };
+            for (auto& name : names)
+            {
+                context.nameHandle(name.first, name.second);
+            }
+        }
+    };
+}
+
+TEST_CASE(redundantBindsAreDropped)
+{
+    RecordingGraphicsContext context;
+    Objects objects;
+    objects.name(context);
+    GraphicsProgram program = {&objects.vertexShader, &objects.pixelShader, &objects.layout};
+    StateHandle textures[] = {&objects.albedo, &objects.normals};
+    StateViewport viewport = {0, 0, 1280, 720, 0, 1};
+
+    for (uint32_t draw = 0; draw < 3; draw++)
+    {
+        context.setProgram(program);
+        context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 2, textures);
+        context.setViewport(viewport);
+        context.setPrimitiveTopology(GRAPHICS_TOPOLOGY_TRIANGLE_LIST);
+        context.setVertexBuffer(0, &objects.vertexBuffer, 36, 0);
+        context.setIndexBuffer(&objects.indexBuffer, GRAPHICS_FORMAT_R32_UINT, 0);
+        context.setBlendState(nullptr, nullptr, 0xFFFFFFFFu);
+        context.setRasterizerState(&objects.rasterizer);
+        context.drawIndexed(96, 0, 0);
+    }
+    CHECK(context.takeCalls() == Calls({
+        "setShader vertex VS", "setShader pixel PS", "setInputLayout Layout",
+        "setShaderResources pixel 0 Albedo Normals", "setViewport 1280x720", "setPrimitiveTopology 4",
+        "setVertexBuffer 0 VB 36 0", "setIndexBuffer IB 42 0", "setBlendState null", "setRasterizerState Rasterizer",
+        "drawIndexed 96 0 0", "drawIndexed 96 0 0", "drawIndexed 96 0 0"
+    }));
+    CHECK_EQUAL(10u, context.getFrameStats().issuedCalls);
+    CHECK_EQUAL(20u, context.getFrameStats().filteredCalls);
+
+    // A default blend factor spelled out is the same state
+    const float ones[4] = {1, 1, 1, 1};
+    context.setBlendState(nullptr, ones, 0xFFFFFFFFu);
+    const float half[4] = {0.5f, 0.5f, 0.5f, 0.5f};
+    context.setBlendState(nullptr, half, 0xFFFFFFFFu);
+    // Only what changed reaches the API
+    context.setShader(STATE_TRACKER_PIXEL_STAGE, &objects.otherPixelShader);
+    context.setProgram(program);
+    context.setVertexBuffer(0, &objects.vertexBuffer, 36, 72);
+    CHECK(context.takeCalls() == Calls({
+        "setBlendState null", "setShader pixel PS2", "setShader pixel PS", "setVertexBuffer 0 VB 36 72"
+    }));
+}
+
+TEST_CASE(slotRangesAreNarrowed)
+{
+    RecordingGraphicsContext context;
+    Objects objects;
+    objects.name(context);
+    StateHandle first[] = {&objects.albedo, &objects.normals, &objects.environment};
+    StateHandle middleChanged[] = {&objects.albedo, &objects.environment, &objects.environment};
+    StateHandle endsChanged[] = {&objects.normals, &objects.environment, &objects.albedo};
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 3, first);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 3, middleChanged);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 3, endsChanged);
+    // Stages keep their own slots
+    context.setShaderResources(STATE_TRACKER_VERTEX_STAGE, 0, 3, endsChanged);
+    // Slots past the tracked ones are always issued
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, STATE_TRACKER_SHADER_RESOURCE_SLOTS, 1, first);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, STATE_TRACKER_SHADER_RESOURCE_SLOTS, 1, first);
+    CHECK(context.takeCalls() == Calls({
+        "setShaderResources pixel 0 Albedo Normals Environment", "setShaderResources pixel 1 Environment",
+        "setShaderResources pixel 0 Normals Environment Albedo",
+        "setShaderResources vertex 0 Normals Environment Albedo", "setShaderResources pixel 16 Albedo",
+        "setShaderResources pixel 16 Albedo"
+    }));
+
+    StateHandle samplers[] = {&objects.linearSampler, &objects.pointSampler};
+    context.setSamplers(STATE_TRACKER_PIXEL_STAGE, 0, 2, samplers);
+    context.setSamplers(STATE_TRACKER_PIXEL_STAGE, 1, 1, samplers + 1);
+    StateConstantBuffer constants[] = {{&objects.frameConstants, 0, 0}, {&objects.objectConstants, 16, 16}};
+    context.setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, 0, 2, constants);
+    constants[1].firstConstant = 32;
+    context.setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, 0, 2, constants);
+    context.setConstantBuffers(STATE_TRACKER_VERTEX_STAGE, 0, 2, constants);
+    CHECK(context.takeCalls() == Calls({
+        "setSamplers pixel 0 Linear Point", "setConstantBuffers vertex 0 Frame Object[16+16]",
+        "setConstantBuffers vertex 1 Object[32+16]"
+    }));
+}
+
+TEST_CASE(renderTargetsInvalidateShaderResources)
+{
+    RecordingGraphicsContext context;
+    Objects objects;
+    objects.name(context);
+    StateHandle scene[] = {&objects.sceneTarget};
+    StateHandle bloom[] = {&objects.bloomTarget};
+    StateHandle sceneTexture[] = {&objects.sceneTarget};
+    StateHandle environment[] = {&objects.environment};
+
+    context.setRenderTargets(1, scene, &objects.depth);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 1, environment);
+    // The runtime unbinds shader resources whose textures become render targets, so after any target change the
+    // cache no longer knows what is bound and the same views are sent again
+    context.setRenderTargets(1, bloom, nullptr);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 1, environment);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 1, 1, sceneTexture);
+    // Setting the same targets changes nothing and keeps the cache
+    context.setRenderTargets(1, bloom, nullptr);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 1, environment);
+    CHECK(context.takeCalls() == Calls({
+        "setRenderTargets Scene depth Depth", "setShaderResources pixel 0 Environment",
+        "setRenderTargets Bloom depth null", "setShaderResources pixel 0 Environment",
+        "setShaderResources pixel 1 Scene"
+    }));
+
+    // Unused target slots are unbound, so a shorter list with nullptr past the end is the same binding
+    StateHandle bloomAndNothing[] = {&objects.bloomTarget, nullptr};
+    context.setRenderTargets(2, bloomAndNothing, nullptr);
+    context.setRenderTargets(1, bloom, &objects.depth);
+    CHECK(context.takeCalls() == Calls({"setRenderTargets Bloom depth Depth"}));
+}
+
+TEST_CASE(hazardUnbindsReachTheApi)
+{
+    RecordingGraphicsContext context;
+    Objects objects;
+    objects.name(context);
+    StateHandle scene[] = {&objects.sceneTarget};
+    StateHandle backBuffer[] = {&objects.backBuffer};
+    StateHandle sceneTexture[] = {&objects.sceneTarget, &objects.environment};
+    StateHandle nothing[] = {nullptr, nullptr};
+
+    // Scene pass, then a pass that samples the scene, then the scene is a target again
+    context.setRenderTargets(1, scene, nullptr);
+    context.setRenderTargets(1, backBuffer, nullptr);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 2, sceneTexture);
+    // What the render graph issues before writing a texture that is still bound for reading
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 2, nothing);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 2, nothing);
+    context.setRenderTargets(1, scene, nullptr);
+    // Binding the views again after the unbind is issued even though they match what was bound before it
+    context.setRenderTargets(1, backBuffer, nullptr);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 2, sceneTexture);
+    CHECK(context.takeCalls() == Calls({
+        "setRenderTargets Scene depth null", "setRenderTargets BackBuffer depth null",
+        "setShaderResources pixel 0 Scene Environment", "setShaderResources pixel 0 null null",
+        "setRenderTargets Scene depth null", "setRenderTargets BackBuffer depth null",
+        "setShaderResources pixel 0 Scene Environment"
+    }));
+
+    // Unbinding the targets before sampling the last one
+    context.setRenderTargets(0, nullptr, nullptr);
+    context.setRenderTargets(0, nullptr, nullptr);
+    CHECK(context.takeCalls() == Calls({"setRenderTargets depth null"}));
+}
+
+TEST_CASE(invalidateReissuesEverything)
+{
+    RecordingGraphicsContext context;
+    Objects objects;
+    objects.name(context);
+    GraphicsProgram program = {&objects.vertexShader, &objects.pixelShader, &objects.layout};
+    StateHandle textures[] = {&objects.albedo};
+    context.setProgram(program);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 1, textures);
+    context.takeCalls();
+
+    // Code outside of the tracker, like the UI, bound its own state
+    context.invalidate();
+    context.setProgram(program);
+    context.setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 1, textures);
+    CHECK(context.takeCalls() == Calls({
+        "setShader vertex VS", "setShader pixel PS", "setInputLayout Layout", "setShaderResources pixel 0 Albedo"
+    }));
+}
+
+TEST_CASE(frameStatsRollOver)
+{
+    RecordingGraphicsContext context;
+    Objects objects;
+    context.setRasterizerState(&objects.rasterizer);
+    context.setRasterizerState(&objects.rasterizer);
+    context.setRasterizerState(&objects.rasterizer);
+    context.beginFrame();
+    CHECK_EQUAL(1u, context.getLastFrameStats().issuedCalls);
+    CHECK_EQUAL(2u, context.getLastFrameStats().filteredCalls);
+    CHECK_EQUAL(0u, context.getFrameStats().issuedCalls);
+
+    // The cache survives the frame boundary
+    context.setRasterizerState(&objects.rasterizer);
+    context.beginFrame();
+    CHECK_EQUAL(0u, context.getLastFrameStats().issuedCalls);
+    CHECK_EQUAL(1u, context.getLastFrameStats().filteredCalls);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * Registry behind the portable test executables. Every test file is an executable of its own linked with
+ * TestMain.cpp, a failed CHECK reports its location and fails the test without stopping it, REQUIRE stops it.
+ */
+#define TEST_CASE(name) \
+    static void name(); \
+    static const TestRegistration name##Registration(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            Testing::fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+        } \
+    } \
+    while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+    do \
+    { \
+        auto&& checkExpected = (expected); \
+        auto&& checkActual = (actual); \
+        if (!(checkExpected == checkActual)) \
+        { \
+            std::ostringstream checkMessage; \
+            checkMessage << "CHECK_EQUAL(" #expected ", " #actual "): expected " << checkExpected << ", got " << \
+                checkActual; \
+            Testing::fail(__FILE__, __LINE__, checkMessage.str()); \
+        } \
+    } \
+    while (0)
+
+#define CHECK_THROWS(expression, exceptionType) \
+    do \
+    { \
+        bool checkThrown = false; \
+        try \
+        { \
+            expression; \
+        } \
+        catch (const exceptionType&) \
+        { \
+            checkThrown = true; \
+        } \
+        if (!checkThrown) \
+        { \
+            Testing::fail(__FILE__, __LINE__, "CHECK_THROWS(" #expression ", " #exceptionType ")"); \
+        } \
+    } \
+    while (0)
+
+#define REQUIRE(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            Testing::fail(__FILE__, __LINE__, "REQUIRE(" #condition ")"); \
+            throw Testing::Abort(); \
+        } \
+    } \
+    while (0)
+
+struct TestCase
+{
+    const char* name;
+    void (*function)();
+};
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, void (*function)());
+};
+
+namespace Testing
+{
+    // Thrown by REQUIRE, the failure is already reported
+    struct Abort
+    {
+    };
+
+    std::vector<TestCase>& getTests();
+    void fail(const char* file, int line, const std::string& message);
+    /*
+     * Fresh empty directory under the system temp directory, removed when the executable exits
+     */
+    std::string makeTemporaryDirectory(const std::string& name);
+    void writeTextFile(const std::string& path, const std::string& content);
+}
@@ -0,0 +1,104 @@
+#include "TestFramework.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    bool currentTestFailed = false;
+    std::vector<std::string> temporaryDirectories;
+    std::atomic<uint32_t> nextTemporaryDirectory{0};
+
+    void removeTemporaryDirectories()
+    {
+        for (auto& directory : temporaryDirectories)
+        {
+            std::error_code error;
+            std::filesystem::remove_all(directory, error);
+        }
+        temporaryDirectories.clear();
+    }
+}
+
+TestRegistration::TestRegistration(const char* name, void (*function)())
+{
+    Testing::getTests().push_back({name, function});
+}
+
+std::vector<TestCase>& Testing::getTests()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void Testing::fail(const char* file, int line, const std::string& message)
+{
+    currentTestFailed = true;
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+}
+
+std::string Testing::makeTemporaryDirectory(const std::string& name)
+{
+    // Runs of the same test in parallel must not share a directory
+    uint64_t tag = (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+        ("lab5-" + name + "-" + std::to_string(tag) + "-" + std::to_string(nextTemporaryDirectory++));
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    temporaryDirectories.push_back(path.string());
+    return path.string();
+}
+
+void Testing::writeTextFile(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.write(content.data(), (std::streamsize)content.size()))
+    {
+        throw std::runtime_error("Failed to write test file " + path);
+    }
+}
+
+/*
+ * Runs every test, or those whose name contains the first argument
+ */
+int main(int argc, char** argv)
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    uint32_t failedAmount = 0;
+    uint32_t ranAmount = 0;
+    for (const TestCase& test : Testing::getTests())
+    {
+        if (filter && !strstr(test.name, filter))
+        {
+            continue;
+        }
+        currentTestFailed = false;
+        try
+        {
+            test.function();
+        }
+        catch (const Testing::Abort&)
+        {
+        }
+        catch (const std::exception& e)
+        {
+            Testing::fail(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+        catch (...)
+        {
+            Testing::fail(__FILE__, __LINE__, "unexpected exception");
+        }
+        ranAmount++;
+        failedAmount += currentTestFailed ? 1 : 0;
+        std::cout << (currentTestFailed ? "[FAIL] " : "[ OK ] ") << test.name << std::endl;
+    }
+    removeTemporaryDirectories();
+    std::cout << ranAmount - failedAmount << " of " << ranAmount << " tests passed" << std::endl;
+    return failedAmount > 0 || ranAmount == 0 ? 1 : 0;
+}
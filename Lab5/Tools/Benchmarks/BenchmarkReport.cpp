@@ -0,0 +1,472 @@
+#include "BenchmarkReport.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#define BENCHMARK_REPORT_VERSION 1u
+
+namespace
+{
+    void writeJsonString(std::ostream& stream, const std::string& text)
+    {
+        stream << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec <<
+                    std::setfill(' ');
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+
+    /*
+     * Just enough JSON for the reports: objects, arrays, strings, numbers and literals
+     */
+    class JsonReader
+    {
+    public:
+        JsonReader(const std::string& text, const std::string& path) : text(text), path(path)
+        {
+        }
+
+    private:
+        const std::string& text;
+        const std::string& path;
+        size_t position = 0;
+
+    public:
+        /*
+         * Calls onKey(key) for every key of the object at the reader, onKey reads the value
+         */
+        template <typename Function>
+        void readObject(const Function& onKey)
+        {
+            expect('{');
+            if (consume('}'))
+            {
+                return;
+            }
+            do
+            {
+                std::string key = readString();
+                expect(':');
+                onKey(key);
+            }
+            while (consume(','));
+            expect('}');
+        }
+
+        template <typename Function>
+        void readArray(const Function& onElement)
+        {
+            expect('[');
+            if (consume(']'))
+            {
+                return;
+            }
+            do
+            {
+                onElement();
+            }
+            while (consume(','));
+            expect(']');
+        }
+
+        std::string readString()
+        {
+            expect('"');
+            std::string result;
+            while (position < text.size() && text[position] != '"')
+            {
+                char c = text[position++];
+                if (c == '\\')
+                {
+                    if (position >= text.size())
+                    {
+                        break;
+                    }
+                    char escaped = text[position++];
+                    switch (escaped)
+                    {
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'u':
+                        // Only control characters are written escaped, they fit in one byte
+                        if (position + 4 > text.size())
+                        {
+                            fail("truncated escape");
+                        }
+                        result += (char)strtol(text.substr(position, 4).c_str(), nullptr, 16);
+                        position += 4;
+                        break;
+                    default:
+                        result += escaped;
+                        break;
+                    }
+                }
+                else
+                {
+                    result += c;
+                }
+            }
+            expect('"');
+            return result;
+        }
+
+        double readNumber()
+        {
+            skipWhitespace();
+            const char* start = text.c_str() + position;
+            char* end;
+            double value = strtod(start, &end);
+            if (end == start)
+            {
+                fail("expected a number");
+            }
+            position += end - start;
+            return value;
+        }
+
+        void skipValue()
+        {
+            skipWhitespace();
+            char c = position < text.size() ? text[position] : '\0';
+            if (c == '{')
+            {
+                readObject([this](const std::string&)
+                {
+                    skipValue();
+                });
+            }
+            else if (c == '[')
+            {
+                readArray([this]()
+                {
+                    skipValue();
+                });
+            }
+            else if (c == '"')
+            {
+                readString();
+            }
+            else if (c == 't' || c == 'f' || c == 'n')
+            {
+                while (position < text.size() && isalpha((unsigned char)text[position]))
+                {
+                    position++;
+                }
+            }
+            else
+            {
+                readNumber();
+            }
+        }
+
+        void expectEnd()
+        {
+            skipWhitespace();
+            if (position != text.size())
+            {
+                fail("unexpected data after the report");
+            }
+        }
+
+    private:
+        void skipWhitespace()
+        {
+            while (position < text.size() && isspace((unsigned char)text[position]))
+            {
+                position++;
+            }
+        }
+
+        bool consume(char c)
+        {
+            skipWhitespace();
+            if (position < text.size() && text[position] == c)
+            {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!consume(c))
+            {
+                fail(std::string("expected '") + c + "'");
+            }
+        }
+
+        [[noreturn]] void fail(const std::string& message)
+        {
+            throw std::runtime_error("Failed to read benchmark report " + path + ": " + message + " at offset " +
+                std::to_string(position));
+        }
+    };
+
+    const BenchmarkResult* findResult(const BenchmarkRun& run, const std::string& name)
+    {
+        for (auto& result : run.results)
+        {
+            if (result.name == name)
+            {
+                return &result;
+            }
+        }
+        return nullptr;
+    }
+
+    const BenchmarkSkip* findSkip(const BenchmarkRun& run, const std::string& name)
+    {
+        for (auto& skip : run.skipped)
+        {
+            if (skip.name == name)
+            {
+                return &skip;
+            }
+        }
+        return nullptr;
+    }
+
+    void compareProvenance(const char* what, const std::string& baseline, const std::string& current,
+                           std::ostream& stream)
+    {
+        if (baseline != current)
+        {
+            stream << "Baseline " << what << ": " << (baseline.empty() ? "unknown" : baseline) << "\n" <<
+                "Current " << what << ": " << (current.empty() ? "unknown" : current) << std::endl;
+        }
+    }
+}
+
+void BenchmarkReport::write(std::ostream& stream, const BenchmarkRun& run)
+{
+    stream << "{\n  \"version\": " << BENCHMARK_REPORT_VERSION << ",\n  \"threads\": " << run.threadsAmount <<
+        ",\n  \"compiler\": ";
+    writeJsonString(stream, run.compiler);
+    stream << ",\n  \"machine\": ";
+    writeJsonString(stream, run.machine);
+    stream << ",\n  \"math_library\": ";
+    writeJsonString(stream, run.mathLibrary);
+    stream << ",\n  \"benchmarks\": [";
+    stream << std::fixed << std::setprecision(6);
+    for (size_t i = 0; i < run.results.size(); i++)
+    {
+        const BenchmarkResult& result = run.results[i];
+        stream << (i ? ",\n" : "\n") << "    {\"name\": ";
+        writeJsonString(stream, result.name);
+        stream << ", \"iterations\": " << result.iterations << ", \"samples\": " << result.samplesAmount <<
+            ", \"min_ms\": " << result.minMilliseconds << ", \"median_ms\": " << result.medianMilliseconds <<
+            ", \"mean_ms\": " << result.meanMilliseconds << "}";
+    }
+    stream << "\n  ],\n  \"skipped\": [";
+    for (size_t i = 0; i < run.skipped.size(); i++)
+    {
+        stream << (i ? ",\n" : "\n") << "    {\"name\": ";
+        writeJsonString(stream, run.skipped[i].name);
+        stream << ", \"reason\": ";
+        writeJsonString(stream, run.skipped[i].reason);
+        stream << "}";
+    }
+    stream << (run.skipped.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+void BenchmarkReport::write(const std::string& path, const BenchmarkRun& run)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open benchmark report " + path);
+    }
+    write(file, run);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write benchmark report " + path);
+    }
+}
+
+BenchmarkRun BenchmarkReport::read(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open benchmark report " + path);
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string text = contents.str();
+
+    BenchmarkRun run;
+    JsonReader reader(text, path);
+    reader.readObject([&](const std::string& key)
+    {
+        if (key == "version")
+        {
+            if (reader.readNumber() != BENCHMARK_REPORT_VERSION)
+            {
+                throw std::runtime_error("Benchmark report " + path + " has an unsupported version");
+            }
+        }
+        else if (key == "threads")
+        {
+            run.threadsAmount = (uint32_t)reader.readNumber();
+        }
+        else if (key == "compiler")
+        {
+            run.compiler = reader.readString();
+        }
+        else if (key == "machine")
+        {
+            run.machine = reader.readString();
+        }
+        else if (key == "math_library")
+        {
+            run.mathLibrary = reader.readString();
+        }
+        else if (key == "benchmarks")
+        {
+            reader.readArray([&]()
+            {
+                BenchmarkResult result;
+                reader.readObject([&](const std::string& field)
+                {
+                    if (field == "name")
+                    {
+                        result.name = reader.readString();
+                    }
+                    else if (field == "iterations")
+                    {
+                        result.iterations = (uint32_t)reader.readNumber();
+                    }
+                    else if (field == "samples")
+                    {
+                        result.samplesAmount = (uint32_t)reader.readNumber();
+                    }
+                    else if (field == "min_ms")
+                    {
+                        result.minMilliseconds = reader.readNumber();
+                    }
+                    else if (field == "median_ms")
+                    {
+                        result.medianMilliseconds = reader.readNumber();
+                    }
+                    else if (field == "mean_ms")
+                    {
+                        result.meanMilliseconds = reader.readNumber();
+                    }
+                    else
+                    {
+                        reader.skipValue();
+                    }
+                });
+                run.results.push_back(result);
+            });
+        }
+        else if (key == "skipped")
+        {
+            reader.readArray([&]()
+            {
+                BenchmarkSkip skip;
+                reader.readObject([&](const std::string& field)
+                {
+                    if (field == "name")
+                    {
+                        skip.name = reader.readString();
+                    }
+                    else if (field == "reason")
+                    {
+                        skip.reason = reader.readString();
+                    }
+                    else
+                    {
+                        reader.skipValue();
+                    }
+                });
+                run.skipped.push_back(skip);
+            });
+        }
+        else
+        {
+            reader.skipValue();
+        }
+    });
+    reader.expectEnd();
+    return run;
+}
+
+uint32_t BenchmarkReport::compare(const BenchmarkRun& baseline, const BenchmarkRun& current, double threshold,
+                                  std::ostream& stream)
+{
+    if (baseline.threadsAmount != current.threadsAmount)
+    {
+        stream << "Baseline ran on " << baseline.threadsAmount << " threads, this run on " << current.threadsAmount <<
+            std::endl;
+    }
+    compareProvenance("compiler", baseline.compiler, current.compiler, stream);
+    compareProvenance("machine", baseline.machine, current.machine, stream);
+    compareProvenance("math library", baseline.mathLibrary, current.mathLibrary, stream);
+    std::ios::fmtflags flags = stream.flags();
+    stream << std::fixed << std::setprecision(3) << std::left << std::setw(28) << "benchmark" << std::right <<
+        std::setw(14) << "baseline ms" << std::setw(14) << "current ms" << std::setw(10) << "change" << std::endl;
+    uint32_t regressionsAmount = 0;
+    for (auto& result : current.results)
+    {
+        stream << std::left << std::setw(28) << result.name << std::right;
+        const BenchmarkResult* previous = findResult(baseline, result.name);
+        if (!previous || previous->minMilliseconds <= 0)
+        {
+            stream << std::setw(14) << "-" << std::setw(14) << result.minMilliseconds << std::setw(10) << "new" <<
+                std::endl;
+            continue;
+        }
+        double change = result.minMilliseconds / previous->minMilliseconds - 1.0;
+        bool regressed = change > threshold;
+        regressionsAmount += regressed ? 1 : 0;
+        stream << std::setw(14) << previous->minMilliseconds << std::setw(14) << result.minMilliseconds <<
+            std::setw(8) << std::showpos << std::setprecision(1) << change * 100.0 << std::noshowpos <<
+            std::setprecision(3) << " %" << (regressed ? "  regression" : "") << std::endl;
+    }
+    // A benchmark that stopped running, or was renamed, would hide its regressions otherwise. One this machine cannot
+    // run is reported but does not fail the comparison.
+    for (auto& previous : baseline.results)
+    {
+        if (findResult(current, previous.name))
+        {
+            continue;
+        }
+        if (const BenchmarkSkip* skip = findSkip(current, previous.name))
+        {
+            stream << std::left << std::setw(28) << previous.name << std::right << std::setw(14) <<
+                previous.minMilliseconds << std::setw(14) << "-" << std::setw(10) << "skipped" << "  " <<
+                skip->reason << std::endl;
+        }
+        else
+        {
+            regressionsAmount++;
+            stream << std::left << std::setw(28) << previous.name << std::right << std::setw(14) <<
+                previous.minMilliseconds << std::setw(14) << "-" << std::setw(10) << "missing" << std::endl;
+        }
+    }
+    stream.flags(flags);
+    return regressionsAmount;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ * Timings of one benchmark in milliseconds per iteration over all its samples
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    // Runs of the workload timed together as one sample
+    uint32_t iterations = 0;
+    uint32_t samplesAmount = 0;
+    double minMilliseconds = 0;
+    double medianMilliseconds = 0;
+    double meanMilliseconds = 0;
+};
+
+/*
+ * A benchmark the machine cannot run, e.g. an AVX2 path on a CPU without it
+ */
+struct BenchmarkSkip
+{
+    std::string name;
+    std::string reason;
+};
+
+struct BenchmarkRun
+{
+    uint32_t threadsAmount = 1;
+    // Where the timings come from, they are only comparable with runs of the same build on the same machine
+    std::string compiler;
+    std::string machine;
+    std::string mathLibrary;
+    std::vector<BenchmarkResult> results;
+    std::vector<BenchmarkSkip> skipped;
+};
+
+/*
+ * JSON reports of the Benchmarks tool and the comparison of two of them. Reading understands the layout write
+ * produces, unknown keys are skipped. Both throw std::runtime_error when the file cannot be used.
+ */
+namespace BenchmarkReport
+{
+    void write(std::ostream& stream, const BenchmarkRun& run);
+    void write(const std::string& path, const BenchmarkRun& run);
+    BenchmarkRun read(const std::string& path);
+    /*
+     * One line per result of current. The best samples are compared, the quietest measure of a workload on a busy
+     * machine, and a benchmark more than threshold slower (0.1 for 10 %) counts as a regression. So does one of the
+     * baseline missing from current, unless current skipped it. Returns how many regressed.
+     */
+    uint32_t compare(const BenchmarkRun& baseline, const BenchmarkRun& current, double threshold,
+                     std::ostream& stream);
+}
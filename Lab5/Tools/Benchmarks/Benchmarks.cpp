@@ -0,0 +1,720 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BenchmarkReport.h"
+#include "../../Engine/Assets/AssetDecoders.h"
+#include "../../Engine/Camera/CameraMath.h"
+#include "../../Engine/SceneRenderer.h"
+#include "../../Engine/Software/SoftwareEnvironment.h"
+#include "../../Engine/Software/SoftwareSceneShaders.h"
+#include "../../Utils/CpuFeatures.h"
+#include "../../Utils/Profiler.h"
+#include "../../Window/InputDispatcher.h"
+
+// Every dataset is generated from this seed, runs on different machines and commits measure the same work
+#define BENCHMARK_SEED 1234u
+#define BENCHMARK_SAMPLES 15u
+#define BENCHMARK_THRESHOLD_PERCENT 10.0
+#define BENCHMARK_OBJ_SEGMENTS 128u
+#define BENCHMARK_HDR_WIDTH 1024u
+#define BENCHMARK_HDR_HEIGHT 512u
+#define BENCHMARK_SKY_SIZE 64u
+#define BENCHMARK_IRRADIANCE_SIZE 8u
+#define BENCHMARK_PREFILTERED_SIZE 16u
+#define BENCHMARK_PREFILTERED_MIPS 5u
+#define BENCHMARK_BRDF_SIZE 16u
+#define BENCHMARK_FRAME_WIDTH 1920u
+#define BENCHMARK_FRAME_HEIGHT 1080u
+#define BENCHMARK_CAMERA_UPDATES 10000u
+#define BENCHMARK_INSTANCES 100000u
+// The largest material grid the scene settings allow
+#define BENCHMARK_MATERIAL_GRID_SIZE 64u
+// Culling instances are spread over a cube this wide, the camera looks at it from one side
+#define BENCHMARK_CULLING_EXTENT 1000.0f
+// Scattered lights fill a cube this wide like SceneRenderer::scatterLights, the camera sits just outside it
+#define BENCHMARK_LIGHTS_EXTENT 80.0f
+// Snapshots dispatched per run, callbacks and the keys each of them subscribes to
+#define BENCHMARK_INPUT_FRAMES 10000u
+#define BENCHMARK_INPUT_CALLBACKS 8u
+#define BENCHMARK_INPUT_KEYS 32u
+// Zones opened per run, so the milliseconds of a run read as the nanoseconds of one zone
+#define BENCHMARK_PROFILE_ZONES 1000000u
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    struct Benchmark
+    {
+        std::string name;
+        uint32_t iterations;
+        std::function<void()> run;
+    };
+
+    // Every workload folds its output in here so the optimizer cannot drop the work
+    volatile float benchmarkSink;
+
+    class InputCounter : public IWindowKeyCallback, public IWindowMouseCallback
+    {
+    public:
+        std::vector<WindowKey> keys;
+        uint32_t eventsAmount = 0;
+
+        void keyEvents(const WindowKey*, uint32_t keysAmount) override
+        {
+            eventsAmount += keysAmount;
+        }
+
+        WindowKey* getKeys(uint32_t* pKeysAmountOut) override
+        {
+            *pKeysAmountOut = (uint32_t)keys.size();
+            return keys.data();
+        }
+
+        void mouseMove(int32_t, int32_t) override
+        {
+            eventsAmount++;
+        }
+    };
+
+    /*
+     * A UV sphere in the layout of sphere.wvf: shared positions, uvs and normals and triangles indexing all three
+     */
+    std::vector<uint8_t> makeObj(uint32_t segments)
+    {
+        const float pi = 3.14159265359f;
+        const uint32_t rings = segments / 2;
+        std::ostringstream obj;
+        obj << std::fixed << std::setprecision(6);
+        for (uint32_t ring = 0; ring <= rings; ring++)
+        {
+            float theta = pi * ring / rings;
+            for (uint32_t segment = 0; segment <= segments; segment++)
+            {
+                float phi = 2 * pi * segment / segments;
+                float normal[3] = {sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)};
+                obj << "v " << normal[0] << " " << normal[1] << " " << normal[2] << "\n";
+                obj << "vt " << (float)segment / segments << " " << (float)ring / rings << "\n";
+                obj << "vn " << normal[0] << " " << normal[1] << " " << normal[2] << "\n";
+            }
+        }
+        for (uint32_t ring = 0; ring < rings; ring++)
+        {
+            for (uint32_t segment = 0; segment < segments; segment++)
+            {
+                uint32_t first = ring * (segments + 1) + segment + 1;
+                uint32_t second = first + segments + 1;
+                uint32_t triangles[2][3] = {{first, first + 1, second}, {second, first + 1, second + 1}};
+                for (auto& triangle : triangles)
+                {
+                    obj << "f";
+                    for (uint32_t corner : triangle)
+                    {
+                        obj << " " << corner << "/" << corner << "/" << corner;
+                    }
+                    obj << "\n";
+                }
+            }
+        }
+        std::string text = obj.str();
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    /*
+     * Radiance HDR of a noisy sky gradient, scanlines run length encoded the way image editors write them. Only
+     * literal chunks are emitted, the noise leaves nothing to repeat.
+     */
+    std::vector<uint8_t> makeHdr(uint32_t width, uint32_t height, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> noise(0.8f, 1.2f);
+        std::string header = "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " + std::to_string(height) + " +X " +
+            std::to_string(width) + "\n";
+        std::vector<uint8_t> file(header.begin(), header.end());
+        std::vector<uint8_t> channels[4];
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (auto& channel : channels)
+            {
+                channel.clear();
+            }
+            for (uint32_t x = 0; x < width; x++)
+            {
+                float up = 1.0f - (float)y / height;
+                float rgb[3] = {
+                    (0.2f + up * 2.0f) * noise(random), (0.3f + up * 3.0f) * noise(random),
+                    (0.5f + up * 6.0f) * noise(random)
+                };
+                float largest = std::max(rgb[0], std::max(rgb[1], rgb[2]));
+                int exponent;
+                float scale = frexpf(largest, &exponent) * 256.0f / largest;
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    channels[c].push_back((uint8_t)(rgb[c] * scale));
+                }
+                channels[3].push_back((uint8_t)(exponent + 128));
+            }
+            const uint8_t scanlineHeader[4] = {2, 2, (uint8_t)(width >> 8), (uint8_t)(width & 0xFF)};
+            file.insert(file.end(), scanlineHeader, scanlineHeader + 4);
+            for (auto& channel : channels)
+            {
+                for (size_t start = 0; start < channel.size(); start += 128)
+                {
+                    size_t count = std::min<size_t>(128, channel.size() - start);
+                    file.push_back((uint8_t)count);
+                    file.insert(file.end(), channel.begin() + start, channel.begin() + start + count);
+                }
+            }
+        }
+        return file;
+    }
+
+    /*
+     * Dataset sizes in benchmark names, 10000 is 10k
+     */
+    std::string formatAmount(uint32_t amount)
+    {
+        if (amount >= 1000000 && amount % 1000000 == 0)
+        {
+            return std::to_string(amount / 1000000) + "M";
+        }
+        if (amount >= 1000 && amount % 1000 == 0)
+        {
+            return std::to_string(amount / 1000) + "k";
+        }
+        return std::to_string(amount);
+    }
+
+    double medianOf(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+    }
+
+    /*
+     * One untimed sample warms caches, then samplesAmount samples of benchmark.iterations runs each
+     */
+    BenchmarkResult measure(const Benchmark& benchmark, uint32_t samplesAmount)
+    {
+        benchmark.run();
+        std::vector<double> samples;
+        for (uint32_t i = 0; i < samplesAmount; i++)
+        {
+            auto start = Clock::now();
+            for (uint32_t iteration = 0; iteration < benchmark.iterations; iteration++)
+            {
+                benchmark.run();
+            }
+            samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count() /
+                benchmark.iterations);
+        }
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        result.iterations = benchmark.iterations;
+        result.samplesAmount = samplesAmount;
+        result.minMilliseconds = *std::min_element(samples.begin(), samples.end());
+        result.medianMilliseconds = medianOf(samples);
+        for (double sample : samples)
+        {
+            result.meanMilliseconds += sample / samples.size();
+        }
+        return result;
+    }
+
+    std::string describeCompiler()
+    {
+#if defined(_MSC_VER)
+        std::string compiler = "MSVC " + std::to_string(_MSC_FULL_VER);
+#elif defined(__clang__)
+        std::string compiler = std::string("Clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        std::string compiler = std::string("GCC ") + __VERSION__;
+#else
+        std::string compiler = "unknown compiler";
+#endif
+#if defined(NDEBUG)
+        return compiler + ", optimized";
+#else
+        return compiler + ", debug";
+#endif
+    }
+
+    std::string describeMachine()
+    {
+        std::string processor = CpuFeatures::getProcessorName();
+#if defined(_WIN32)
+        const char* system = "Windows";
+#elif defined(__linux__)
+        const char* system = "Linux";
+#else
+        const char* system = "unknown system";
+#endif
+        return (processor.empty() ? "unknown processor" : processor) + ", " +
+            std::to_string(std::thread::hardware_concurrency()) + " hardware threads, " + system;
+    }
+
+    /*
+     * The packing, culling and camera cases time DirectXMath itself, its version and vector path matter
+     */
+    std::string describeMathLibrary()
+    {
+#if defined(DIRECTX_MATH_VERSION)
+        std::string library = "DirectXMath " + std::to_string(DIRECTX_MATH_VERSION / 100) + "." +
+            std::to_string(DIRECTX_MATH_VERSION % 100);
+#else
+        std::string library = "DirectXMath.h without DIRECTX_MATH_VERSION";
+#endif
+#if defined(_XM_NO_INTRINSICS_)
+        return library + ", no intrinsics";
+#elif defined(_XM_AVX2_INTRINSICS_)
+        return library + ", AVX2";
+#elif defined(_XM_AVX_INTRINSICS_)
+        return library + ", AVX";
+#elif defined(_XM_SSE4_INTRINSICS_)
+        return library + ", SSE4";
+#elif defined(_XM_SSE_INTRINSICS_)
+        return library + ", SSE2";
+#elif defined(_XM_ARM_NEON_INTRINSICS_)
+        return library + ", NEON";
+#else
+        return library + ", unknown vector path";
+#endif
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Usage: Benchmarks [--filter text] [--samples n] [--threads n] [--output report.json]\n"
+            "                  [--baseline report.json] [--threshold percent]\n"
+            "With a baseline the exit code is 2 when a benchmark is more than threshold percent slower or missing\n"
+            "Lab5/Tools/Benchmarks/Baseline.json is the reference report" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    uint32_t samplesAmount = BENCHMARK_SAMPLES;
+    // The IBL bakes run on a job system, one thread keeps their timings comparable between machines
+    uint32_t threadsAmount = 1;
+    const char* outputPath = nullptr;
+    const char* baselinePath = nullptr;
+    double thresholdPercent = BENCHMARK_THRESHOLD_PERCENT;
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            printUsage();
+            return 1;
+        }
+        const char* value = argv[i + 1];
+        if (strcmp(argv[i], "--filter") == 0)
+        {
+            filter = value;
+        }
+        else if (strcmp(argv[i], "--samples") == 0)
+        {
+            samplesAmount = (uint32_t)atoi(value);
+        }
+        else if (strcmp(argv[i], "--threads") == 0)
+        {
+            threadsAmount = (uint32_t)atoi(value);
+        }
+        else if (strcmp(argv[i], "--output") == 0)
+        {
+            outputPath = value;
+        }
+        else if (strcmp(argv[i], "--baseline") == 0)
+        {
+            baselinePath = value;
+        }
+        else if (strcmp(argv[i], "--threshold") == 0)
+        {
+            thresholdPercent = atof(value);
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+        i++;
+    }
+    samplesAmount = samplesAmount ? samplesAmount : 1;
+    threadsAmount = threadsAmount ? threadsAmount : 1;
+
+    try
+    {
+        std::mt19937 random(BENCHMARK_SEED);
+        JobSystem jobs(threadsAmount);
+
+        std::vector<uint8_t> objFile = makeObj(BENCHMARK_OBJ_SEGMENTS);
+        MeshAsset mesh;
+        AssetDecoders::decodeObj(objFile, mesh);
+        const float sphereColor[3] = {0.541f, 0.0f, 0.82745f};
+        std::vector<float> sceneVertices;
+
+        std::vector<uint8_t> hdrFile = makeHdr(BENCHMARK_HDR_WIDTH, BENCHMARK_HDR_HEIGHT, random);
+        ImageAsset image;
+
+        SoftwareTexture sky(BENCHMARK_SKY_SIZE, BENCHMARK_SKY_SIZE, 4, 1, SOFTWARE_CUBE_FACES);
+        SoftwareEnvironment::makeSky(sky, jobs);
+        SoftwareTexture irradiance(BENCHMARK_IRRADIANCE_SIZE, BENCHMARK_IRRADIANCE_SIZE, 4, 1, SOFTWARE_CUBE_FACES);
+        SoftwareTexture prefiltered(BENCHMARK_PREFILTERED_SIZE, BENCHMARK_PREFILTERED_SIZE, 4,
+                                    BENCHMARK_PREFILTERED_MIPS, SOFTWARE_CUBE_FACES);
+        const float prefilteredRoughness[BENCHMARK_PREFILTERED_MIPS] = {0.0f, 0.25f, 0.5f, 0.75f, 1.0f};
+        SoftwareTexture brdfLookup(BENCHMARK_BRDF_SIZE, BENCHMARK_BRDF_SIZE, 4);
+
+        SoftwareTexture hdrFrame(BENCHMARK_FRAME_WIDTH, BENCHMARK_FRAME_HEIGHT, 4);
+        std::uniform_real_distribution<float> brightness(0.0f, 20.0f);
+        float* frameTexels = hdrFrame.getTexels();
+        for (size_t i = 0; i < (size_t)BENCHMARK_FRAME_WIDTH * BENCHMARK_FRAME_HEIGHT * 4; i++)
+        {
+            frameTexels[i] = brightness(random);
+        }
+
+        InstanceStore instances;
+        instances.reserve(BENCHMARK_INSTANCES);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (uint32_t i = 0; i < BENCHMARK_INSTANCES; i++)
+        {
+            float scale = 0.1f + unit(random) * 4.0f;
+            instances.addInstance(XMMatrixMultiply(XMMatrixScaling(scale, scale, scale),
+                                                   XMMatrixTranslation(position(random), position(random),
+                                                                       position(random))),
+                                  unit(random), unit(random), XMFLOAT3(unit(random), unit(random), unit(random)));
+        }
+        // Roughly what a culled frame leaves: a sorted half of the instances
+        std::vector<uint32_t> visibleIndices;
+        for (uint32_t i = 0; i < BENCHMARK_INSTANCES; i++)
+        {
+            if (unit(random) < 0.5f)
+            {
+                visibleIndices.push_back(i);
+            }
+        }
+        std::vector<InstanceData> packedInstances(visibleIndices.size());
+
+        // Laid out like SceneRenderer::buildMaterialGrid, packed whole the way the frame does when nothing is culled
+        InstanceStore gridInstances;
+        gridInstances.reserve(BENCHMARK_MATERIAL_GRID_SIZE * BENCHMARK_MATERIAL_GRID_SIZE);
+        std::vector<uint32_t> gridIndices;
+        for (uint32_t row = 0; row < BENCHMARK_MATERIAL_GRID_SIZE; row++)
+        {
+            for (uint32_t column = 0; column < BENCHMARK_MATERIAL_GRID_SIZE; column++)
+            {
+                float step = 1.0f / (BENCHMARK_MATERIAL_GRID_SIZE - 1);
+                gridIndices.push_back(gridInstances.addInstance(XMMatrixTranslation(0, row * 2.5f, column * 2.5f),
+                                                                column * step, row * step,
+                                                                XMFLOAT3(0.541f, 0.0f, 0.82745f)));
+            }
+        }
+        std::vector<InstanceData> packedGrid(gridIndices.size());
+
+        const uint32_t cullingAmounts[] = {10000, 100000, 1000000};
+        std::vector<BoundingSpheres> cullingSpheres(std::size(cullingAmounts));
+        std::uniform_real_distribution<float> cullingPosition(-BENCHMARK_CULLING_EXTENT / 2,
+                                                              BENCHMARK_CULLING_EXTENT / 2);
+        for (size_t i = 0; i < std::size(cullingAmounts); i++)
+        {
+            for (uint32_t instance = 0; instance < cullingAmounts[i]; instance++)
+            {
+                cullingSpheres[i].push(cullingPosition(random), cullingPosition(random), cullingPosition(random),
+                                       0.1f + unit(random) * 4.0f);
+            }
+        }
+        FrustumPlanes cullingPlanes;
+        {
+            XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -BENCHMARK_CULLING_EXTENT, 0.0f),
+                                             XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+            XMMATRIX projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(90.0f),
+                                                           (float)BENCHMARK_FRAME_WIDTH / BENCHMARK_FRAME_HEIGHT,
+                                                           0.1f, 2 * BENCHMARK_CULLING_EXTENT);
+            XMFLOAT4X4 viewProjection;
+            XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, projection));
+            FrustumCuller::extractPlanes(&viewProjection._11, cullingPlanes);
+        }
+        FrustumCuller culler;
+        std::vector<uint32_t> culledIndices;
+
+        const uint32_t clusterLightAmounts[] = {1000, 4000, 16000, 64000};
+        std::vector<ClusterLight> clusterLights(clusterLightAmounts[std::size(clusterLightAmounts) - 1]);
+        std::uniform_real_distribution<float> lightPosition(-BENCHMARK_LIGHTS_EXTENT / 2, BENCHMARK_LIGHTS_EXTENT / 2);
+        std::uniform_real_distribution<float> lightIntensity(0.5f, 1.0f);
+        for (auto& light : clusterLights)
+        {
+            for (float& coordinate : light.position)
+            {
+                coordinate = lightPosition(random);
+            }
+            light.intensity = lightIntensity(random);
+            light.radius = sqrtf(light.intensity / LIGHT_ATTENUATION_CUTOFF);
+        }
+        ClusterGrid clusterGrid;
+        clusterGrid.build({XMConvertToRadians(90.0f), (float)BENCHMARK_FRAME_WIDTH / BENCHMARK_FRAME_HEIGHT, 0.1f,
+                           2 * BENCHMARK_LIGHTS_EXTENT});
+        XMFLOAT4X4 clusterView;
+        XMStoreFloat4x4(&clusterView, XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -BENCHMARK_LIGHTS_EXTENT, 0.0f),
+                                                       XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+
+        // Callbacks on keys all over the keyboard and the mouse buttons, a few keys held and changed every frame
+        InputDispatcher inputDispatcher;
+        std::vector<InputCounter> inputCounters(BENCHMARK_INPUT_CALLBACKS);
+        std::uniform_int_distribution<uint32_t> inputKey(0, INPUT_MOUSE_MIDDLE);
+        for (auto& counter : inputCounters)
+        {
+            for (uint32_t i = 0; i < BENCHMARK_INPUT_KEYS; i++)
+            {
+                counter.keys.push_back({inputKey(random), (WindowKeyAction)(i % 3)});
+            }
+            inputDispatcher.addKeyCallback(&counter);
+            inputDispatcher.addMouseCallback(&counter);
+        }
+        std::vector<InputSnapshot> inputSnapshots(BENCHMARK_INPUT_FRAMES);
+        for (size_t i = 1; i < inputSnapshots.size(); i++)
+        {
+            inputSnapshots[i] = inputSnapshots[i - 1];
+            inputSnapshots[i].setKey(inputKey(random), unit(random) < 0.5f);
+            inputSnapshots[i].mouseX += i % 2 ? 1 : 0;
+        }
+
+        std::vector<Benchmark> benchmarks = {
+            {
+                "obj decode", 1, [&]()
+                {
+                    AssetDecoders::decodeObj(objFile, mesh);
+                    benchmarkSink = mesh.vertices.back();
+                }
+            },
+            {
+                "sphere vertex expansion", 20, [&]()
+                {
+                    sceneVertices.clear();
+                    SceneRenderer::addVertexColor(mesh.vertices, sphereColor, sceneVertices);
+                    benchmarkSink = sceneVertices.back();
+                }
+            },
+            {
+                "hdr decode", 1, [&]()
+                {
+                    AssetDecoders::decodeStbImage(hdrFile, image);
+                    benchmarkSink = image.data.back();
+                }
+            },
+            {
+                "irradiance bake", 1, [&]()
+                {
+                    SoftwareEnvironment::convolveIrradiance(sky, irradiance, jobs);
+                    benchmarkSink = irradiance.getTexels()[0];
+                }
+            },
+            {
+                "prefilter bake", 1, [&]()
+                {
+                    SoftwareEnvironment::prefilter(sky, prefilteredRoughness, prefiltered, jobs);
+                    benchmarkSink = prefiltered.getTexels()[0];
+                }
+            },
+            {
+                "brdf lookup bake", 1, [&]()
+                {
+                    SoftwareEnvironment::integrateBRDF(brdfLookup, jobs);
+                    benchmarkSink = brdfLookup.getTexels()[0];
+                }
+            },
+            {
+                "luminance reduction", 1, [&]()
+                {
+                    float averageLog, minimum, maximum;
+                    SoftwareToneMapPixelShader::measureBrightness(hdrFrame, averageLog, minimum, maximum);
+                    benchmarkSink = averageLog + minimum + maximum;
+                }
+            },
+            {
+                // A mouse drag turning the camera a full circle: what Camera::rotate and the frame compute per update,
+                // the focus on the orbit, view, projection, their product and the frustum planes culling extracts
+                "camera matrix updates", 1, [&]()
+                {
+                    const float aspectRatio = (float)BENCHMARK_FRAME_WIDTH / BENCHMARK_FRAME_HEIGHT;
+                    const XMFLOAT3 position(-10.02f, -0.09446f, -0.76995f);
+                    const float theta = -XM_PIDIV4;
+                    FrustumPlanes planes;
+                    for (uint32_t i = 0; i < BENCHMARK_CAMERA_UPDATES; i++)
+                    {
+                        float phi = XM_2PI * i / BENCHMARK_CAMERA_UPDATES;
+                        XMFLOAT3 offset = CameraMath::orbitOffset(5.0f, theta, phi);
+                        XMFLOAT3 focus(position.x + offset.x, position.y + offset.y, position.z + offset.z);
+                        XMMATRIX view = CameraMath::viewMatrix(position, focus, theta, phi);
+                        XMMATRIX projection = CameraMath::projectionMatrix(90.0f, aspectRatio, 0.001f, 2000.0f);
+                        XMFLOAT4X4 viewProjection;
+                        XMStoreFloat4x4(&viewProjection, XMMatrixMultiply(view, projection));
+                        FrustumCuller::extractPlanes(&viewProjection._11, planes);
+                    }
+                    benchmarkSink = planes.d[0];
+                }
+            },
+            {
+                "instance packing", 5, [&]()
+                {
+                    instances.pack(visibleIndices.data(), (uint32_t)visibleIndices.size(), packedInstances.data());
+                    benchmarkSink = packedInstances.back().roughness;
+                }
+            },
+            {
+                "material grid packing", 50, [&]()
+                {
+                    gridInstances.pack(gridIndices.data(), (uint32_t)gridIndices.size(), packedGrid.data());
+                    benchmarkSink = packedGrid.back().metallic;
+                }
+            },
+            {
+                "input dispatch", 1, [&]()
+                {
+                    for (const auto& snapshot : inputSnapshots)
+                    {
+                        inputDispatcher.dispatch(snapshot);
+                    }
+                    benchmarkSink = (float)inputCounters[0].eventsAmount;
+                }
+            },
+            {
+                // Both clock reads and the record, cleared first so the thread buffer never drops events
+                "profile zone", 1, [&]()
+                {
+                    bool enabled = Profiler::isEnabled();
+                    Profiler::clear();
+                    Profiler::setEnabled(true);
+                    for (uint32_t i = 0; i < BENCHMARK_PROFILE_ZONES; i++)
+                    {
+                        PROFILE_ZONE("Benchmark zone");
+                    }
+                    Profiler::setEnabled(enabled);
+                    benchmarkSink = (float)enabled;
+                }
+            },
+            {
+                "profile zone disabled", 1, [&]()
+                {
+                    bool enabled = Profiler::isEnabled();
+                    Profiler::setEnabled(false);
+                    for (uint32_t i = 0; i < BENCHMARK_PROFILE_ZONES; i++)
+                    {
+                        PROFILE_ZONE("Benchmark zone");
+                    }
+                    Profiler::setEnabled(enabled);
+                    benchmarkSink = (float)enabled;
+                }
+            }
+        };
+
+        BenchmarkRun run;
+        run.threadsAmount = threadsAmount;
+        run.compiler = describeCompiler();
+        run.machine = describeMachine();
+        run.mathLibrary = describeMathLibrary();
+
+        // Both vector paths on one thread, the AVX2 cases are recorded as skipped where the CPU lacks it
+        const std::pair<CullingInstructionSet, const char*> cullingPaths[] = {{CULLING_SSE, "sse"},
+                                                                               {CULLING_AVX2, "avx2"}};
+        for (auto& cullingPath : cullingPaths)
+        {
+            bool supported = cullingPath.first != CULLING_AVX2 || CpuFeatures::supportsAVX2();
+            for (size_t i = 0; i < std::size(cullingAmounts); i++)
+            {
+                std::string name = "frustum culling " + formatAmount(cullingAmounts[i]) + " " + cullingPath.second;
+                if (!supported)
+                {
+                    if (filter.empty() || name.find(filter) != std::string::npos)
+                    {
+                        run.skipped.push_back({name, "the CPU does not support AVX2"});
+                    }
+                    continue;
+                }
+                CullingInstructionSet instructionSet = cullingPath.first;
+                const BoundingSpheres& spheres = cullingSpheres[i];
+                benchmarks.push_back({
+                    name, 10000000 / cullingAmounts[i], [&, instructionSet]()
+                    {
+                        culler.setInstructionSet(instructionSet);
+                        culler.cullSpheres(cullingPlanes, spheres, CullingParameters(), culledIndices);
+                        benchmarkSink = (float)culledIndices.size();
+                    }
+                });
+            }
+        }
+
+        // Binned on the job system like the frame does, --threads sets how many workers help
+        for (uint32_t lightsAmount : clusterLightAmounts)
+        {
+            benchmarks.push_back({
+                "cluster light binning " + formatAmount(lightsAmount), 64000 / lightsAmount, [&, lightsAmount]()
+                {
+                    clusterGrid.assignLights(&clusterView._11, clusterLights.data(), lightsAmount, &jobs);
+                    benchmarkSink = (float)clusterGrid.getLightIndices().size();
+                }
+            });
+        }
+
+        std::cout << run.compiler << "\n" << run.machine << "\n" << run.mathLibrary << "\n" << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        for (auto& benchmark : benchmarks)
+        {
+            if (!filter.empty() && std::string(benchmark.name).find(filter) == std::string::npos)
+            {
+                continue;
+            }
+            BenchmarkResult result = measure(benchmark, samplesAmount);
+            std::cout << std::left << std::setw(28) << result.name << std::right << " min " << std::setw(10) <<
+                result.minMilliseconds << " ms, median " << std::setw(10) << result.medianMilliseconds << " ms" <<
+                std::endl;
+            run.results.push_back(result);
+        }
+        for (auto& skip : run.skipped)
+        {
+            std::cout << std::left << std::setw(28) << skip.name << std::right << " skipped, " << skip.reason <<
+                std::endl;
+        }
+
+        if (outputPath)
+        {
+            BenchmarkReport::write(outputPath, run);
+        }
+        if (baselinePath)
+        {
+            BenchmarkRun baseline = BenchmarkReport::read(baselinePath);
+            // Only the benchmarks the filter let run are expected in the run
+            auto skipped = std::remove_if(baseline.results.begin(), baseline.results.end(),
+                                          [&](const BenchmarkResult& result)
+            {
+                return !filter.empty() && result.name.find(filter) == std::string::npos;
+            });
+            baseline.results.erase(skipped, baseline.results.end());
+            std::cout << std::endl;
+            uint32_t regressionsAmount = BenchmarkReport::compare(baseline, run, thresholdPercent / 100.0,
+                                                                  std::cout);
+            if (regressionsAmount)
+            {
+                std::cout << regressionsAmount << " benchmarks are missing or regressed by more than " <<
+                    std::setprecision(1) << thresholdPercent << " %" << std::endl;
+                return 2;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
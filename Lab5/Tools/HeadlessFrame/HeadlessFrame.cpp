@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "HeadlessScene.h"
+#include "../../Utils/ThreadCounters.h"
+
+// One orbit of the camera may still grow containers and pools, the frames after it revisit the same views and must
+// not allocate
+#define HEADLESS_WARMUP_FRAMES 360u
+
+int main(int argc, char** argv)
+{
+    if (argc > 4)
+    {
+        std::cerr << "Usage: HeadlessFrame [frames] [material grid size] [scattered lights]" << std::endl;
+        return 1;
+    }
+    uint32_t framesAmount = argc > 1 ? (uint32_t)atoi(argv[1]) : 100;
+    int gridSize = argc > 2 ? atoi(argv[2]) : 32;
+    int scatteredLights = argc > 3 ? atoi(argv[3]) : 1024;
+
+    HeadlessScene headless(gridSize, scatteredLights);
+    NullGraphicsDevice& device = headless.getDevice();
+    NullGraphicsContext* context = device.getNullContext();
+    SceneRenderer& scene = headless.getScene();
+
+    double totalMilliseconds = 0;
+    uint64_t steadyAllocationsAmount = 0;
+    for (uint32_t frame = 0; frame < framesAmount; frame++)
+    {
+        // Counts the job workers too, the allocation hooks see every thread
+        uint64_t startAllocationsAmount = ThreadCounting::getProcessAllocationsAmount();
+        auto start = std::chrono::steady_clock::now();
+        headless.drawFrame(headless.makeView(frame));
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+        uint64_t allocationsAmount = ThreadCounting::getProcessAllocationsAmount() - startAllocationsAmount;
+        totalMilliseconds += milliseconds;
+        if (frame >= HEADLESS_WARMUP_FRAMES)
+        {
+            steadyAllocationsAmount += allocationsAmount;
+        }
+
+        // Closes the counters of this frame, the timed part already ended
+        context->beginFrame();
+        const NullGraphicsStats& calls = context->getLastFrameCalls();
+        const StateTrackerStats& stateStats = context->getLastFrameStats();
+        std::cout << "Frame " << frame << ": " << milliseconds << " ms, " << scene.getVisibleInstancesAmount()
+            << " visible instances, " << calls.drawCalls << " draws, " << stateStats.issuedCalls << " binds ("
+            << stateStats.filteredCalls << " filtered), " << calls.mapCalls << " maps, " << calls.updateCalls
+            << " updates, " << calls.uploadedBytes << " bytes uploaded, " << allocationsAmount << " allocations"
+            << std::endl;
+    }
+    if (framesAmount > 0)
+    {
+        std::cout << "Average: " << totalMilliseconds / framesAmount << " ms per frame, "
+            << device.getLiveBuffersAmount() << " buffers holding " << device.getLiveBufferBytes() / 1024 << " KB"
+            << std::endl;
+    }
+    if (framesAmount > HEADLESS_WARMUP_FRAMES)
+    {
+        std::cout << "Steady state: " << steadyAllocationsAmount << " allocations in "
+            << framesAmount - HEADLESS_WARMUP_FRAMES << " frames after " << HEADLESS_WARMUP_FRAMES << " warm-up frames"
+            << std::endl;
+        if (steadyAllocationsAmount > 0)
+        {
+            std::cerr << "Steady-state frames allocated on the heap" << std::endl;
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "HeadlessScene.h"
+
+#include <cmath>
+#include <vector>
+
+HeadlessScene::HeadlessScene(int gridSize, int scatteredLights)
+{
+    std::vector<float> vertices;
+    std::vector<uint32_t> indices;
+    SceneRenderer::makeSphere(HEADLESS_SPHERE_SEGMENTS, vertices, indices);
+    scene = std::make_unique<SceneRenderer>(&device, vertices, indices);
+    scene->getSettings().materialGridSize = gridSize;
+    scene->getSettings().scatteredLightsAmount = scatteredLights;
+    scene->buildMaterialGrid();
+    scene->scatterLights();
+
+    resources.pbrProgram = {device.createObject("PBR vertex shader"), device.createObject("PBR pixel shader"),
+                            device.createObject("PBR input layout")};
+    resources.skyboxProgram = {device.createObject("Skybox vertex shader"),
+                               device.createObject("Skybox pixel shader"), resources.pbrProgram.inputLayout};
+    resources.samplers[0] = device.createObject("Anisotropic sampler");
+    resources.samplers[1] = device.createObject("Linear sampler");
+    resources.environmentView = device.createObject("Environment cubemap");
+    resources.lightingViews[0] = device.createObject("Irradiance map");
+    resources.lightingViews[1] = device.createObject("Prefiltered map");
+    resources.lightingViews[2] = device.createObject("BRDF lookup");
+    resources.skyboxDepthState = device.createObject("Skybox depth state");
+    resources.skyboxRasterState = device.createObject("Skybox raster state");
+    colorView = device.createObject("HDR frame");
+    depthView = device.createObject("Depth");
+}
+
+SceneView HeadlessScene::makeView(uint32_t frame)
+{
+    float orbitRadius = scene->getSettings().materialGridSize * scene->getSettings().materialGridSpacing;
+    float angle = XMConvertToRadians((float)(frame % 360));
+    SceneView view;
+    view.cameraPosition = XMFLOAT3(orbitRadius * cosf(angle), orbitRadius * 0.25f, orbitRadius * sinf(angle));
+    view.viewMatrix = XMMatrixLookAtLH(XMLoadFloat3(&view.cameraPosition), XMVectorZero(),
+                                       XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    view.fov = 90.0f;
+    view.nearPlane = 0.001f;
+    view.farPlane = 2000.0f;
+    view.width = HEADLESS_FRAME_WIDTH;
+    view.height = HEADLESS_FRAME_HEIGHT;
+    view.projectionMatrix = XMMatrixPerspectiveFovLH(XMConvertToRadians(view.fov),
+                                                     (float)view.width / (float)view.height, view.nearPlane,
+                                                     view.farPlane);
+    return view;
+}
+
+void HeadlessScene::drawFrame(const SceneView& view)
+{
+    NullGraphicsContext* context = device.getNullContext();
+    StateViewport viewport = {0, 0, (float)view.width, (float)view.height, 0.0f, 1.0f};
+    scene->prepareFrame(context, view);
+    context->setRenderTargets(1, &colorView, depthView);
+    context->setViewport(viewport);
+    scene->drawSkybox(context, resources, colorView, depthView);
+    scene->drawSpheres(context, resources);
+    scene->finishFrame(context);
+}
+
+NullGraphicsDevice& HeadlessScene::getDevice()
+{
+    return device;
+}
+
+SceneRenderer& HeadlessScene::getScene()
+{
+    return *scene;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "../../Engine/Device/NullGraphicsDevice.h"
+#include "../../Engine/SceneRenderer.h"
+
+#define HEADLESS_FRAME_WIDTH 1920u
+#define HEADLESS_FRAME_HEIGHT 1080u
+#define HEADLESS_SPHERE_SEGMENTS 32u
+
+/*
+ * The sphere scene on a NullGraphicsDevice. Shaders, views and states the renderer would create are stand-in objects
+ * of the device, frames are recorded by the SceneRenderer calls the renderer makes.
+ */
+class HeadlessScene
+{
+public:
+    HeadlessScene(int gridSize, int scatteredLights);
+
+private:
+    NullGraphicsDevice device;
+    std::unique_ptr<SceneRenderer> scene;
+    SceneResources resources;
+    StateHandle colorView;
+    StateHandle depthView;
+
+public:
+    /*
+     * Orbits the material grid once every 360 frames, with the field of view and planes of the default camera
+     */
+    SceneView makeView(uint32_t frame);
+    /*
+     * Records one frame into the immediate context, its counters close with the next beginFrame of the context
+     */
+    void drawFrame(const SceneView& view);
+    NullGraphicsDevice& getDevice();
+    SceneRenderer& getScene();
+};
@@ -0,0 +1,158 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../../Engine/Culling/FrustumCuller.h"
+#include "../../Engine/Software/SoftwareEnvironment.h"
+#include "../../Utils/JobSystem.h"
+
+#define JOB_SCALING_SPHERES 1000000u
+#define JOB_SCALING_SMALL_JOBS 100000u
+#define JOB_SCALING_SKY_SIZE 64u
+#define JOB_SCALING_IRRADIANCE_SIZE 16u
+#define JOB_SCALING_SEED 1234u
+
+namespace
+{
+    struct Workload
+    {
+        const char* name;
+        std::function<void(JobSystem& jobs)> run;
+    };
+
+    /*
+     * Best of repeats, the first run warms caches and wakes the workers
+     */
+    double measure(JobSystem& jobs, const Workload& workload, uint32_t repeats)
+    {
+        workload.run(jobs);
+        double best = 0;
+        for (uint32_t i = 0; i < repeats; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            workload.run(jobs);
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                .count();
+            best = i == 0 || milliseconds < best ? milliseconds : best;
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 3)
+    {
+        std::cerr << "Usage: JobScaling [max threads] [repeats]" << std::endl;
+        return 1;
+    }
+    uint32_t maxThreads = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+    uint32_t repeats = argc > 2 ? (uint32_t)atoi(argv[2]) : 5;
+    repeats = repeats ? repeats : 1;
+
+    // Fixed data so runs on different machines and commits compare
+    std::mt19937 random(JOB_SCALING_SEED);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> radius(0.1f, 4.0f);
+    BoundingSpheres spheres;
+    for (uint32_t i = 0; i < JOB_SCALING_SPHERES; i++)
+    {
+        spheres.push(position(random), position(random), position(random), radius(random));
+    }
+    // Perspective with a 90 degree field of view looking down +z, near 0.1 and far 1000
+    const float nearPlane = 0.1f;
+    const float farPlane = 1000.0f;
+    const float viewProjection[16] = {
+        1, 0, 0, 0,
+        0, 1, 0, 0,
+        0, 0, farPlane / (farPlane - nearPlane), 1,
+        0, 0, -nearPlane * farPlane / (farPlane - nearPlane), 0
+    };
+    FrustumPlanes planes;
+    FrustumCuller::extractPlanes(viewProjection, planes);
+    FrustumCuller culler;
+    std::vector<uint32_t> visible;
+
+    SoftwareTexture sky(JOB_SCALING_SKY_SIZE, JOB_SCALING_SKY_SIZE, 4, 1, SOFTWARE_CUBE_FACES);
+    SoftwareTexture irradiance(JOB_SCALING_IRRADIANCE_SIZE, JOB_SCALING_IRRADIANCE_SIZE, 4, 1, SOFTWARE_CUBE_FACES);
+    {
+        JobSystem setupJobs(1);
+        SoftwareEnvironment::makeSky(sky, setupJobs);
+    }
+
+    std::vector<Workload> workloads = {
+        {
+            "cull 1M spheres", [&](JobSystem& jobs)
+            {
+                CullingParameters parameters;
+                parameters.jobs = &jobs;
+                culler.cullSpheres(planes, spheres, parameters, visible);
+            }
+        },
+        {
+            "irradiance bake", [&](JobSystem& jobs)
+            {
+                SoftwareEnvironment::convolveIrradiance(sky, irradiance, jobs);
+            }
+        },
+        {
+            "100k small jobs", [](JobSystem& jobs)
+            {
+                JobCounter counter;
+                std::atomic<uint32_t> sum{0};
+                for (uint32_t i = 0; i < JOB_SCALING_SMALL_JOBS; i++)
+                {
+                    jobs.submit([&sum]()
+                    {
+                        sum.fetch_add(1, std::memory_order_relaxed);
+                    }, &counter);
+                }
+                jobs.wait(counter);
+            }
+        },
+        {
+            "nested parallel for", [](JobSystem& jobs)
+            {
+                std::vector<float> values(1 << 20);
+                uint32_t blockSize = (uint32_t)values.size() / 64;
+                jobs.parallelFor(64, 1, [&](uint32_t begin, uint32_t end)
+                {
+                    for (uint32_t block = begin; block < end; block++)
+                    {
+                        jobs.parallelFor(blockSize, 256, [&, block](uint32_t first, uint32_t last)
+                        {
+                            float* blockValues = values.data() + block * blockSize;
+                            for (uint32_t i = first; i < last; i++)
+                            {
+                                blockValues[i] = sqrtf((float)(block * 7919u + i));
+                            }
+                        });
+                    }
+                });
+            }
+        }
+    };
+
+    std::vector<double> baseline(workloads.size(), 0);
+    std::cout << std::fixed << std::setprecision(2);
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        JobSystem jobs(threads);
+        std::cout << threads << " threads:";
+        for (size_t i = 0; i < workloads.size(); i++)
+        {
+            double milliseconds = measure(jobs, workloads[i], repeats);
+            baseline[i] = threads == 1 ? milliseconds : baseline[i];
+            std::cout << " " << workloads[i].name << " " << milliseconds << " ms (x" << baseline[i] / milliseconds
+                << ")";
+        }
+        JobSystemStats stats = jobs.getStats();
+        std::cout << ", " << stats.executedJobs << " jobs, " << stats.stolenJobs << " stolen" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <d3dcompiler.h>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../../DXShader/D3DInclude.h"
+#include "../../DXShader/ShaderCache.h"
+#include "../../DXShader/ShaderPack.h"
+#include "../../Utils/JobSystem.h"
+
+namespace
+{
+    struct CompiledStage
+    {
+        bool compiled = false;
+        std::vector<uint8_t> bytecode;
+        std::string errors;
+    };
+
+    CompiledStage compileStage(const ShaderPackSource& source)
+    {
+        std::vector<D3D_SHADER_MACRO> macros;
+        for (auto& define : source.defines)
+        {
+            macros.push_back({define.first.c_str(), define.second.c_str()});
+        }
+        macros.push_back({nullptr, nullptr});
+        std::wstring path(source.sourcePath.begin(), source.sourcePath.end());
+
+        CompiledStage stage;
+        ID3DBlob* blob = nullptr;
+        ID3DBlob* errorBlob = nullptr;
+        D3DInclude includeObj;
+        HRESULT result = D3DCompileFromFile(path.c_str(), macros.data(), &includeObj, "main", source.target.c_str(),
+                                            0, 0, &blob, &errorBlob);
+        if (errorBlob)
+        {
+            stage.errors.assign((const char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize());
+            errorBlob->Release();
+        }
+        if (SUCCEEDED(result) && blob)
+        {
+            const uint8_t* pBytecode = (const uint8_t*)blob->GetBufferPointer();
+            stage.bytecode.assign(pBytecode, pBytecode + blob->GetBufferSize());
+            stage.compiled = true;
+        }
+        if (blob)
+        {
+            blob->Release();
+        }
+        return stage;
+    }
+
+    std::string describe(const ShaderPackSource& source)
+    {
+        std::string description = source.sourcePath + " " + source.target;
+        for (auto& define : source.defines)
+        {
+            description += " " + define.first + "=" + define.second;
+        }
+        return description;
+    }
+}
+
+/*
+ * Compiles every stage listed in a pack manifest with the Release compile flags and writes them into one shader
+ * pack. Paths in the manifest are resolved against the working directory, the same way the engine resolves them.
+ *
+ * Usage: ShaderPacker <manifest> <output pack>
+ */
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: ShaderPacker <manifest> <output pack>" << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> manifestContent;
+    if (!ShaderCache::readFile(argv[1], manifestContent))
+    {
+        std::cerr << "Failed to read " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<ShaderPackSource> sources;
+    std::string error;
+    if (!ShaderPack::parseManifest(std::string(manifestContent.begin(), manifestContent.end()), sources, error))
+    {
+        std::cerr << argv[1] << ": " << error << std::endl;
+        return 1;
+    }
+
+    std::vector<CompiledStage> stages(sources.size());
+    JobSystem::getShared().parallelFor((uint32_t)sources.size(), 1, [&stages, &sources](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            stages[i] = compileStage(sources[i]);
+        }
+    });
+
+    ShaderPackWriter writer;
+    bool failed = false;
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (!stages[i].errors.empty())
+        {
+            std::cerr << stages[i].errors << std::endl;
+        }
+        if (!stages[i].compiled)
+        {
+            std::cerr << "Failed to compile " << describe(sources[i]) << std::endl;
+            failed = true;
+            continue;
+        }
+        try
+        {
+            writer.add(ShaderPack::makeKey(sources[i].sourcePath, sources[i].defines, "main", sources[i].target),
+                       stages[i].bytecode.data(), stages[i].bytecode.size());
+        }
+        catch (const std::exception& exception)
+        {
+            std::cerr << describe(sources[i]) << ": " << exception.what() << std::endl;
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        return 1;
+    }
+    if (!writer.write(argv[2]))
+    {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << sources.size() << " shader stages into " << argv[2] << std::endl;
+    return 0;
+}
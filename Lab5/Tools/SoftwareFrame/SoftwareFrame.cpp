@@ -0,0 +1,260 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../DXShader/ConstantBuffer.h"
+#include "../../Engine/SceneRenderer.h"
+#include "../../Engine/Software/SoftwareEnvironment.h"
+#include "../../Engine/Software/SoftwareGraphicsDevice.h"
+#include "../../Engine/Software/SoftwareSceneShaders.h"
+#include "../../STB/stb_image.h"
+
+#define SOFTWARE_FRAME_SPHERE_SEGMENTS 64u
+#define SOFTWARE_FRAME_CUBE_SIZE 256u
+#define SOFTWARE_FRAME_IRRADIANCE_SIZE 32u
+#define SOFTWARE_FRAME_PREFILTERED_SIZE 128u
+#define SOFTWARE_FRAME_PREFILTERED_MIPS 5u
+#define SOFTWARE_FRAME_LIGHT_INTENSITY 25.0f
+
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+
+    double millisecondsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /*
+     * Fills the environment cube from an equirectangular HDR image, or with the procedural sky without one
+     */
+    void loadEnvironment(const char* hdrPath, SoftwareTexture& cubemap, JobSystem& jobs)
+    {
+        if (!hdrPath)
+        {
+            SoftwareEnvironment::makeSky(cubemap, jobs);
+            return;
+        }
+        int width;
+        int height;
+        int componentsAmount;
+        float* data = stbi_loadf(hdrPath, &width, &height, &componentsAmount, 4);
+        if (!data)
+        {
+            throw std::runtime_error(std::string("Failed to load HDR image ") + hdrPath);
+        }
+        SoftwareTexture equirect((uint32_t)width, (uint32_t)height, 4);
+        std::copy(data, data + (size_t)width * height * 4, equirect.getTexels());
+        stbi_image_free(data);
+        SoftwareEnvironment::projectEquirect(equirect, cubemap, jobs);
+    }
+
+    /*
+     * Binary PPM of the first three channels, the swap chain is UNORM so values are written as they are
+     */
+    void writePPM(const char* path, const SoftwareTexture& image)
+    {
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error(std::string("Failed to open ") + path);
+        }
+        uint32_t width = image.getWidth();
+        uint32_t height = image.getHeight();
+        file << "P6\n" << width << " " << height << "\n255\n";
+        std::vector<uint8_t> row(width * 3);
+        const float* texels = image.getTexels();
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                for (uint32_t c = 0; c < 3; c++)
+                {
+                    row[x * 3 + c] = (uint8_t)(saturate(texels[((size_t)y * width + x) * 4 + c]) * 255.0f + 0.5f);
+                }
+            }
+            file.write((const char*)row.data(), row.size());
+        }
+    }
+
+    /*
+     * Looks at the material grid from the side the point lights are on, with the planes of the default camera
+     */
+    SceneView makeView(uint32_t width, uint32_t height, int gridSize, float spacing)
+    {
+        SceneView view;
+        view.fov = 60.0f;
+        view.nearPlane = 0.001f;
+        view.farPlane = 2000.0f;
+        view.width = width;
+        view.height = height;
+        float halfExtent = (gridSize > 1 ? (gridSize - 1) * spacing * 0.5f : 3.0f) + 1.5f;
+        float distance = halfExtent / tanf(XMConvertToRadians(view.fov) * 0.5f);
+        view.cameraPosition = XMFLOAT3(-distance, distance * 0.1f, distance * 0.05f);
+        view.viewMatrix = XMMatrixLookAtLH(XMLoadFloat3(&view.cameraPosition), XMVectorZero(),
+                                           XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+        view.projectionMatrix = XMMatrixPerspectiveFovLH(XMConvertToRadians(view.fov),
+                                                         (float)width / (float)height, view.nearPlane,
+                                                         view.farPlane);
+        return view;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 7)
+    {
+        std::cerr << "Usage: SoftwareFrame [output.ppm] [width] [height] [material grid size] [scattered lights] "
+            "[environment.hdr]" << std::endl;
+        return 1;
+    }
+    const char* outputPath = argc > 1 ? argv[1] : "frame.ppm";
+    uint32_t width = argc > 2 ? (uint32_t)atoi(argv[2]) : 1280;
+    uint32_t height = argc > 3 ? (uint32_t)atoi(argv[3]) : 720;
+    int gridSize = argc > 4 ? atoi(argv[4]) : 7;
+    int scatteredLights = argc > 5 ? atoi(argv[5]) : 0;
+    const char* hdrPath = argc > 6 ? argv[6] : nullptr;
+    if (width == 0 || height == 0)
+    {
+        std::cerr << "Frame size must not be empty" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        JobSystem& jobs = JobSystem::getShared();
+        SoftwareGraphicsDevice device(jobs);
+        SoftwareGraphicsContext* context = device.getSoftwareContext();
+
+        auto environmentStart = Clock::now();
+        SoftwareTexture* environment = device.createTexture(SOFTWARE_FRAME_CUBE_SIZE, SOFTWARE_FRAME_CUBE_SIZE, 4, 1,
+                                                            SOFTWARE_CUBE_FACES);
+        SoftwareTexture* irradiance = device.createTexture(SOFTWARE_FRAME_IRRADIANCE_SIZE,
+                                                           SOFTWARE_FRAME_IRRADIANCE_SIZE, 4, 1,
+                                                           SOFTWARE_CUBE_FACES);
+        SoftwareTexture* prefiltered = device.createTexture(SOFTWARE_FRAME_PREFILTERED_SIZE,
+                                                            SOFTWARE_FRAME_PREFILTERED_SIZE, 4,
+                                                            SOFTWARE_FRAME_PREFILTERED_MIPS, SOFTWARE_CUBE_FACES);
+        SoftwareTexture* brdfLookup = device.createTexture(SOFTWARE_FRAME_PREFILTERED_SIZE,
+                                                           SOFTWARE_FRAME_PREFILTERED_SIZE, 4);
+        const float prefilteredRoughness[SOFTWARE_FRAME_PREFILTERED_MIPS] = {0.0f, 0.25f, 0.5f, 0.75f, 1.0f};
+        loadEnvironment(hdrPath, *environment, jobs);
+        SoftwareEnvironment::convolveIrradiance(*environment, *irradiance, jobs);
+        SoftwareEnvironment::prefilter(*environment, prefilteredRoughness, *prefiltered, jobs);
+        SoftwareEnvironment::integrateBRDF(*brdfLookup, jobs);
+        std::cout << "Environment: " << millisecondsSince(environmentStart) << " ms" << std::endl;
+
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        SceneRenderer::makeSphere(SOFTWARE_FRAME_SPHERE_SEGMENTS, vertices, indices);
+        SceneRenderer scene(&device, vertices, indices);
+        scene.getSettings().materialGridSize = gridSize;
+        scene.getSettings().scatteredLightsAmount = scatteredLights;
+        scene.buildMaterialGrid();
+        scene.scatterLights();
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            scene.getLights()[i].intensity = SOFTWARE_FRAME_LIGHT_INTENSITY;
+        }
+
+        SoftwareSampler wrapSampler;
+        wrapSampler.wrap = true;
+        SoftwareDepthState skyboxDepth;
+        skyboxDepth.depthFunc = SOFTWARE_DEPTH_LESS_EQUAL;
+        SoftwareRasterState skyboxRaster;
+        skyboxRaster.cullMode = SOFTWARE_CULL_NONE;
+
+        SceneResources resources;
+        StateHandle inputLayout = device.createInputLayout();
+        resources.pbrProgram = {device.createVertexShader(std::make_unique<SoftwareSceneVertexShader>()),
+                                device.createPixelShader(std::make_unique<SoftwarePBRPixelShader>()), inputLayout};
+        resources.skyboxProgram = {device.createVertexShader(std::make_unique<SoftwareSkyboxVertexShader>()),
+                                   device.createPixelShader(std::make_unique<SoftwareSkyboxPixelShader>()),
+                                   inputLayout};
+        // The anisotropic sampler of the GPU path filters bilinear here
+        resources.samplers[0] = device.createSampler(wrapSampler);
+        resources.samplers[1] = device.createSampler(SoftwareSampler());
+        resources.environmentView = device.createView(environment);
+        resources.lightingViews[0] = device.createView(irradiance);
+        resources.lightingViews[1] = device.createView(prefiltered);
+        resources.lightingViews[2] = device.createView(brdfLookup);
+        resources.skyboxDepthState = device.createDepthState(skyboxDepth);
+        resources.skyboxRasterState = device.createRasterState(skyboxRaster);
+
+        SoftwareTexture* hdrFrame = device.createTexture(width, height, 4);
+        SoftwareTexture* depth = device.createTexture(width, height, 1);
+        SoftwareTexture* ldrFrame = device.createTexture(width, height, 4);
+        SoftwareTexture* brightness[3] = {
+            device.createTexture(1, 1, 4), device.createTexture(1, 1, 4), device.createTexture(1, 1, 4)
+        };
+        StateHandle hdrView = device.createView(hdrFrame);
+        StateHandle depthView = device.createView(depth);
+        StateHandle ldrView = device.createView(ldrFrame);
+        StateViewport viewport = {0, 0, (float)width, (float)height, 0.0f, 1.0f};
+        GraphicsProgram toneMapProgram = {
+            device.createVertexShader(std::make_unique<SoftwareMappingVertexShader>()),
+            device.createPixelShader(std::make_unique<SoftwareToneMapPixelShader>()), nullptr
+        };
+        StateHandle toneMapViews[4] = {
+            hdrView, device.createView(brightness[0]), device.createView(brightness[1]),
+            device.createView(brightness[2])
+        };
+        SoftwareToneMapConstants toneMapConstants = {};
+        ConstantBuffer<SoftwareToneMapConstants> adaptBuffer(&device, toneMapConstants, "Adapted brightness");
+
+        auto frameStart = Clock::now();
+        scene.prepareFrame(context, makeView(width, height, gridSize, scene.getSettings().materialGridSpacing));
+        context->setRenderTargets(1, &hdrView, depthView);
+        context->setViewport(viewport);
+        scene.drawSkybox(context, resources, hdrView, depthView);
+        scene.drawSpheres(context, resources);
+        scene.finishFrame(context);
+        double sceneMilliseconds = millisecondsSince(frameStart);
+
+        // A single frame has nothing to adapt from, the tone mapping starts at the measured brightness
+        auto toneMapStart = Clock::now();
+        float averageLog;
+        float minimum;
+        float maximum;
+        SoftwareToneMapPixelShader::measureBrightness(*hdrFrame, averageLog, minimum, maximum);
+        float brightnessValues[3] = {averageLog, minimum, maximum};
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            float texel[4] = {brightnessValues[i], brightnessValues[i], brightnessValues[i], 1.0f};
+            brightness[i]->clear(texel);
+        }
+        toneMapConstants.adapt[0] = averageLog;
+        adaptBuffer.updateData(context, toneMapConstants);
+        context->setRenderTargets(1, &ldrView, nullptr);
+        context->setProgram(toneMapProgram);
+        context->setShaderResources(STATE_TRACKER_PIXEL_STAGE, 0, 4, toneMapViews);
+        context->setSamplers(STATE_TRACKER_PIXEL_STAGE, 0, 1, &resources.samplers[1]);
+        adaptBuffer.bindToPixelShader(context);
+        context->setRasterizerState(nullptr);
+        context->draw(6, 0);
+        double toneMapMilliseconds = millisecondsSince(toneMapStart);
+        writePPM(outputPath, *ldrFrame);
+
+        context->beginFrame();
+        const SoftwareRasterizerStats& stats = context->getLastFrameRasterStats();
+        const StateTrackerStats& stateStats = context->getLastFrameStats();
+        std::cout << "Scene: " << sceneMilliseconds << " ms, " << scene.getVisibleInstancesAmount()
+            << " visible instances, tone mapping: " << toneMapMilliseconds << " ms" << std::endl;
+        std::cout << stats.submittedTriangles << " triangles, " << stats.culledTriangles << " culled, "
+            << stats.clippedTriangles << " clipped, " << stats.binnedTriangles << " tile references, "
+            << stats.shadedPixels << " pixels shaded, " << stats.stolenTiles << " tiles stolen, "
+            << stateStats.issuedCalls << " binds (" << stateStats.filteredCalls << " filtered) on "
+            << jobs.getThreadsAmount() << " threads" << std::endl;
+        std::cout << "Wrote " << outputPath << std::endl;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <cstdlib>
+#include <new>
+#include "ThreadCounters.h"
+
+/*
+ * Replaces the global allocation functions so ThreadCounting sees every new of the program. The array forms forward to
+ * these by default. Only linked into programs that want the counts.
+ */
+
+namespace
+{
+    void* allocate(size_t size)
+    {
+        ThreadCounting::addAllocation(size);
+        void* pointer = malloc(size ? size : 1);
+        if (!pointer)
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void* allocateAligned(size_t size, std::align_val_t alignment)
+    {
+        ThreadCounting::addAllocation(size);
+        size = size ? size : 1;
+#if defined(_WIN32)
+        void* pointer = _aligned_malloc(size, (size_t)alignment);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        void* pointer = aligned_alloc((size_t)alignment, (size + (size_t)alignment - 1) & ~((size_t)alignment - 1));
+#endif
+        if (!pointer)
+        {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    void freeAligned(void* pointer)
+    {
+#if defined(_WIN32)
+        _aligned_free(pointer);
+#else
+        free(pointer);
+#endif
+    }
+}
+
+void* operator new(size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    free(pointer);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept
+{
+    freeAligned(pointer);
+}
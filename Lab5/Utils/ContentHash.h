@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/*
+ * Incremental 64-bit FNV-1a hash, stable across runs and platforms so it can key files on disk
+ */
+class ContentHash
+{
+private:
+    uint64_t state = 14695981039346656037ull;
+
+public:
+    void update(const void* pData, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)pData;
+        for (size_t i = 0; i < size; i++)
+        {
+            state ^= bytes[i];
+            state *= 1099511628211ull;
+        }
+    }
+
+    /*
+     * Strings are length-prefixed so ("ab", "c") and ("a", "bc") hash differently
+     */
+    void update(const std::string& value)
+    {
+        update((uint64_t)value.size());
+        update(value.data(), value.size());
+    }
+
+    void update(uint64_t value)
+    {
+        update(&value, sizeof(value));
+    }
+
+    uint64_t digest() const
+    {
+        return state;
+    }
+
+    static std::string toHex(uint64_t value)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string result(16, '0');
+        for (int i = 15; i >= 0; i--, value >>= 4)
+        {
+            result[i] = digits[value & 0xF];
+        }
+        return result;
+    }
+};
@@ -0,0 +1,112 @@
+#include "CpuFeatures.h"
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+namespace
+{
+    bool detectAVX2()
+    {
+#if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    bool detectInvariantTsc()
+    {
+#if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 0x80000000);
+        if ((unsigned int)info[0] < 0x80000007)
+        {
+            return false;
+        }
+        __cpuid(info, 0x80000007);
+        return (info[3] & (1 << 8)) != 0;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007 || !__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        {
+            return false;
+        }
+        return (edx & (1 << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    std::string detectProcessorName()
+    {
+        unsigned int brand[12] = {};
+#if defined(_MSC_VER)
+        int info[4] = {};
+        __cpuid(info, 0x80000000);
+        if ((unsigned int)info[0] < 0x80000004)
+        {
+            return "";
+        }
+        for (int leaf = 0; leaf < 3; leaf++)
+        {
+            __cpuid((int*)&brand[leaf * 4], 0x80000002 + leaf);
+        }
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004)
+        {
+            return "";
+        }
+        for (unsigned int leaf = 0; leaf < 3; leaf++)
+        {
+            __get_cpuid(0x80000002 + leaf, &brand[leaf * 4], &brand[leaf * 4 + 1], &brand[leaf * 4 + 2],
+                        &brand[leaf * 4 + 3]);
+        }
+#endif
+        // 48 characters padded with spaces, zero terminated when shorter
+        std::string name((const char*)brand, strnlen((const char*)brand, sizeof(brand)));
+        size_t first = name.find_first_not_of(' ');
+        size_t last = name.find_last_not_of(' ');
+        return first == std::string::npos ? "" : name.substr(first, last - first + 1);
+    }
+}
+
+bool CpuFeatures::supportsAVX2()
+{
+    static const bool supported = detectAVX2();
+    return supported;
+}
+
+bool CpuFeatures::hasInvariantTsc()
+{
+    static const bool invariant = detectInvariantTsc();
+    return invariant;
+}
+
+std::string CpuFeatures::getProcessorName()
+{
+    static const std::string name = detectProcessorName();
+    return name;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+namespace CpuFeatures
+{
+    bool supportsAVX2();
+    /*
+     * The time stamp counter runs at a constant rate through frequency and power state changes
+     */
+    bool hasInvariantTsc();
+    /*
+     * The brand string the processor reports, empty where it has none
+     */
+    std::string getProcessorName();
+}
@@ -0,0 +1,193 @@
+#include "DXGIFormatSize.h"
+
+// Every DXGI format of the Windows 8 SDK with its bits per texel
+#define DXGI_FORMAT_SIZES(X) \
+    X(R32G32B32A32_TYPELESS, 128) \
+    X(R32G32B32A32_FLOAT, 128) \
+    X(R32G32B32A32_UINT, 128) \
+    X(R32G32B32A32_SINT, 128) \
+    X(R32G32B32_TYPELESS, 96) \
+    X(R32G32B32_FLOAT, 96) \
+    X(R32G32B32_UINT, 96) \
+    X(R32G32B32_SINT, 96) \
+    X(R16G16B16A16_TYPELESS, 64) \
+    X(R16G16B16A16_FLOAT, 64) \
+    X(R16G16B16A16_UNORM, 64) \
+    X(R16G16B16A16_UINT, 64) \
+    X(R16G16B16A16_SNORM, 64) \
+    X(R16G16B16A16_SINT, 64) \
+    X(R32G32_TYPELESS, 64) \
+    X(R32G32_FLOAT, 64) \
+    X(R32G32_UINT, 64) \
+    X(R32G32_SINT, 64) \
+    X(R32G8X24_TYPELESS, 64) \
+    X(D32_FLOAT_S8X24_UINT, 64) \
+    X(R32_FLOAT_X8X24_TYPELESS, 64) \
+    X(X32_TYPELESS_G8X24_UINT, 64) \
+    X(R10G10B10A2_TYPELESS, 32) \
+    X(R10G10B10A2_UNORM, 32) \
+    X(R10G10B10A2_UINT, 32) \
+    X(R11G11B10_FLOAT, 32) \
+    X(R8G8B8A8_TYPELESS, 32) \
+    X(R8G8B8A8_UNORM, 32) \
+    X(R8G8B8A8_UNORM_SRGB, 32) \
+    X(R8G8B8A8_UINT, 32) \
+    X(R8G8B8A8_SNORM, 32) \
+    X(R8G8B8A8_SINT, 32) \
+    X(R16G16_TYPELESS, 32) \
+    X(R16G16_FLOAT, 32) \
+    X(R16G16_UNORM, 32) \
+    X(R16G16_UINT, 32) \
+    X(R16G16_SNORM, 32) \
+    X(R16G16_SINT, 32) \
+    X(R32_TYPELESS, 32) \
+    X(D32_FLOAT, 32) \
+    X(R32_FLOAT, 32) \
+    X(R32_UINT, 32) \
+    X(R32_SINT, 32) \
+    X(R24G8_TYPELESS, 32) \
+    X(D24_UNORM_S8_UINT, 32) \
+    X(R24_UNORM_X8_TYPELESS, 32) \
+    X(X24_TYPELESS_G8_UINT, 32) \
+    X(R8G8_TYPELESS, 16) \
+    X(R8G8_UNORM, 16) \
+    X(R8G8_UINT, 16) \
+    X(R8G8_SNORM, 16) \
+    X(R8G8_SINT, 16) \
+    X(R16_TYPELESS, 16) \
+    X(R16_FLOAT, 16) \
+    X(D16_UNORM, 16) \
+    X(R16_UNORM, 16) \
+    X(R16_UINT, 16) \
+    X(R16_SNORM, 16) \
+    X(R16_SINT, 16) \
+    X(R8_TYPELESS, 8) \
+    X(R8_UNORM, 8) \
+    X(R8_UINT, 8) \
+    X(R8_SNORM, 8) \
+    X(R8_SINT, 8) \
+    X(A8_UNORM, 8) \
+    X(R1_UNORM, 1) \
+    X(R9G9B9E5_SHAREDEXP, 32) \
+    X(R8G8_B8G8_UNORM, 16) \
+    X(G8R8_G8B8_UNORM, 16) \
+    X(BC1_TYPELESS, 4) \
+    X(BC1_UNORM, 4) \
+    X(BC1_UNORM_SRGB, 4) \
+    X(BC2_TYPELESS, 8) \
+    X(BC2_UNORM, 8) \
+    X(BC2_UNORM_SRGB, 8) \
+    X(BC3_TYPELESS, 8) \
+    X(BC3_UNORM, 8) \
+    X(BC3_UNORM_SRGB, 8) \
+    X(BC4_TYPELESS, 4) \
+    X(BC4_UNORM, 4) \
+    X(BC4_SNORM, 4) \
+    X(BC5_TYPELESS, 8) \
+    X(BC5_UNORM, 8) \
+    X(BC5_SNORM, 8) \
+    X(B5G6R5_UNORM, 16) \
+    X(B5G5R5A1_UNORM, 16) \
+    X(B8G8R8A8_UNORM, 32) \
+    X(B8G8R8X8_UNORM, 32) \
+    X(R10G10B10_XR_BIAS_A2_UNORM, 32) \
+    X(B8G8R8A8_TYPELESS, 32) \
+    X(B8G8R8A8_UNORM_SRGB, 32) \
+    X(B8G8R8X8_TYPELESS, 32) \
+    X(B8G8R8X8_UNORM_SRGB, 32) \
+    X(BC6H_TYPELESS, 8) \
+    X(BC6H_UF16, 8) \
+    X(BC6H_SF16, 8) \
+    X(BC7_TYPELESS, 8) \
+    X(BC7_UNORM, 8) \
+    X(BC7_UNORM_SRGB, 8) \
+    X(AYUV, 32) \
+    X(Y410, 32) \
+    X(Y416, 64) \
+    X(NV12, 0) \
+    X(P010, 0) \
+    X(P016, 0) \
+    X(420_OPAQUE, 0) \
+    X(YUY2, 16) \
+    X(Y210, 32) \
+    X(Y216, 32) \
+    X(NV11, 0) \
+    X(AI44, 8) \
+    X(IA44, 8) \
+    X(P8, 8) \
+    X(A8P8, 16) \
+    X(B4G4R4A4_UNORM, 16)
+
+uint32_t getDXGIFormatBitsPerPixel(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+#define DXGI_FORMAT_BITS_CASE(name, bits) \
+    case DXGI_FORMAT_##name: \
+        return bits;
+    DXGI_FORMAT_SIZES(DXGI_FORMAT_BITS_CASE)
+#undef DXGI_FORMAT_BITS_CASE
+    default:
+        return 0;
+    }
+}
+
+bool isDXGIFormatBlockCompressed(DXGI_FORMAT format)
+{
+    return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+        (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+}
+
+bool isDXGIFormatPacked(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_R8G8_B8G8_UNORM || format == DXGI_FORMAT_G8R8_G8B8_UNORM ||
+        format == DXGI_FORMAT_YUY2 || format == DXGI_FORMAT_Y210 || format == DXGI_FORMAT_Y216;
+}
+
+const char* getDXGIFormatName(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+#define DXGI_FORMAT_NAME_CASE(name, bits) \
+    case DXGI_FORMAT_##name: \
+        return #name;
+    DXGI_FORMAT_SIZES(DXGI_FORMAT_NAME_CASE)
+#undef DXGI_FORMAT_NAME_CASE
+    default:
+        return "UNKNOWN";
+    }
+}
+
+uint64_t getDXGISurfaceBytes(DXGI_FORMAT format, uint32_t width, uint32_t height)
+{
+    uint64_t bitsPerPixel = getDXGIFormatBitsPerPixel(format);
+    if (isDXGIFormatBlockCompressed(format))
+    {
+        // A block is 16 texels, even when the surface is smaller than one
+        uint64_t blocksWide = width ? (width + 3ull) / 4 : 0;
+        uint64_t blocksHigh = height ? (height + 3ull) / 4 : 0;
+        return blocksWide * blocksHigh * bitsPerPixel * 2;
+    }
+    if (isDXGIFormatPacked(format))
+    {
+        return (width + 1ull) / 2 * (bitsPerPixel / 4) * height;
+    }
+    return (width * bitsPerPixel + 7) / 8 * height;
+}
+
+uint64_t getDXGITextureBytes(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t arraySize,
+                             uint32_t mipLevels)
+{
+    uint64_t bytes = 0;
+    for (uint32_t mip = 0; mipLevels == 0 || mip < mipLevels; mip++)
+    {
+        bytes += getDXGISurfaceBytes(format, width, height);
+        if (width <= 1 && height <= 1)
+        {
+            break;
+        }
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return bytes * arraySize;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstdint>
+
+/*
+ * Bits of one texel, for block compressed formats the bits of a block divided by its 16 texels. 0 for planar and
+ * video formats, their size is not a texel size.
+ */
+uint32_t getDXGIFormatBitsPerPixel(DXGI_FORMAT format);
+/*
+ * BC1 to BC7, stored as 4x4 texel blocks
+ */
+bool isDXGIFormatBlockCompressed(DXGI_FORMAT format);
+/*
+ * Formats that pack two texels into one 32-bit element, rows are a whole number of texel pairs
+ */
+bool isDXGIFormatPacked(DXGI_FORMAT format);
+/*
+ * Format name without the DXGI_FORMAT_ prefix, "UNKNOWN" for values this table does not know
+ */
+const char* getDXGIFormatName(DXGI_FORMAT format);
+/*
+ * Bytes of one subresource, rows are rounded up to whole blocks and bytes
+ */
+uint64_t getDXGISurfaceBytes(DXGI_FORMAT format, uint32_t width, uint32_t height);
+/*
+ * Bytes of every mip of every array slice of a 2D texture, mipLevels 0 is the full chain down to 1x1
+ */
+uint64_t getDXGITextureBytes(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t arraySize,
+                             uint32_t mipLevels);
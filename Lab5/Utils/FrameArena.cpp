@@ -0,0 +1,155 @@
+#include "FrameArena.h"
+
+namespace
+{
+    std::atomic<uint64_t> nextArenaId{1};
+
+    // Arena the calling thread used last and its arenas in it, saves the lock of the lookup
+    struct ThreadArenasCache
+    {
+        uint64_t arenaId = 0;
+        void* pArenas = nullptr;
+    };
+
+    thread_local ThreadArenasCache threadCache;
+}
+
+LinearArena::LinearArena(size_t blockBytes) : blockBytes(blockBytes ? blockBytes : 1)
+{
+}
+
+void* LinearArena::allocate(size_t size, size_t alignment)
+{
+    while (currentBlock < blocks.size())
+    {
+        Block& block = blocks[currentBlock];
+        uintptr_t address = (uintptr_t)block.data.get() + offset;
+        size_t padding = (size_t)((alignment - address % alignment) % alignment);
+        if (padding + size <= block.size - offset)
+        {
+            offset += padding + size;
+            usedBytes += padding + size;
+            return (void*)(address + padding);
+        }
+        currentBlock++;
+        offset = 0;
+    }
+    // Doubles what the arena holds, so a frame that outgrows it adds few blocks
+    size_t blockSize = capacity > blockBytes ? capacity : blockBytes;
+    blockSize = blockSize > size + alignment ? blockSize : size + alignment;
+    blocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[blockSize]), blockSize});
+    capacity += blockSize;
+    currentBlock = blocks.size() - 1;
+    offset = 0;
+    return allocate(size, alignment);
+}
+
+void LinearArena::reset()
+{
+    if (blocks.size() > 1)
+    {
+        blocks.clear();
+        blocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[capacity]), capacity});
+    }
+    currentBlock = 0;
+    offset = 0;
+    usedBytes = 0;
+}
+
+size_t LinearArena::getUsedBytes() const
+{
+    return usedBytes;
+}
+
+size_t LinearArena::getCapacity() const
+{
+    return capacity;
+}
+
+FrameArena::FrameArena(size_t blockBytes) : id(nextArenaId.fetch_add(1)), blockBytes(blockBytes)
+{
+}
+
+FrameArena& FrameArena::getShared()
+{
+    // Never destroyed, job workers may still allocate while static objects are torn down
+    static FrameArena* arena = new FrameArena();
+    return *arena;
+}
+
+void FrameArena::beginFrame()
+{
+    frameIndex.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t FrameArena::getFrameIndex() const
+{
+    return frameIndex.load(std::memory_order_acquire);
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    ThreadArenas& arenas = getThreadArenas();
+    uint64_t frame = frameIndex.load(std::memory_order_acquire);
+    LinearArena& arena = *arenas.buffers[frame % FRAME_ARENA_BUFFERS];
+    if (arenas.frameIndex != frame)
+    {
+        // The buffer was last used FRAME_ARENA_BUFFERS or more frames ago
+        arenas.frameIndex = frame;
+        arena.reset();
+    }
+    size_t capacity = arena.getCapacity();
+    void* pointer = arena.allocate(size ? size : 1, alignment);
+    if (arena.getCapacity() != capacity)
+    {
+        arenas.capacityBytes.fetch_add(arena.getCapacity() - capacity, std::memory_order_relaxed);
+    }
+    return pointer;
+}
+
+FrameArenaStats FrameArena::getStats()
+{
+    FrameArenaStats stats;
+    stats.frameIndex = getFrameIndex();
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    stats.threadsAmount = (uint32_t)threads.size();
+    for (auto& arenas : threads)
+    {
+        stats.capacityBytes += arenas->capacityBytes.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+FrameArena::ThreadArenas& FrameArena::getThreadArenas()
+{
+    if (threadCache.arenaId == id)
+    {
+        return *(ThreadArenas*)threadCache.pArenas;
+    }
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    std::thread::id thread = std::this_thread::get_id();
+    ThreadArenas* pArenas = nullptr;
+    for (auto& arenas : threads)
+    {
+        if (arenas->thread == thread)
+        {
+            pArenas = arenas.get();
+            break;
+        }
+    }
+    if (!pArenas)
+    {
+        auto arenas = std::make_unique<ThreadArenas>();
+        arenas->thread = thread;
+        arenas->frameIndex = frameIndex.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < FRAME_ARENA_BUFFERS; i++)
+        {
+            arenas->buffers.push_back(std::make_unique<LinearArena>(blockBytes));
+        }
+        pArenas = arenas.get();
+        threads.push_back(std::move(arenas));
+    }
+    threadCache.arenaId = id;
+    threadCache.pArenas = pArenas;
+    return *pArenas;
+}
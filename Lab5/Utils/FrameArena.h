@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Frames an allocation stays valid for, counting the one it was made in
+#define FRAME_ARENA_BUFFERS 3u
+// Smallest block an arena takes from the heap
+#define FRAME_ARENA_BLOCK_BYTES (64u * 1024u)
+
+/*
+ * Bump allocator over heap blocks, nothing is freed on its own. reset keeps the memory, blocks that did not fit the
+ * first one are merged into a single block then, so the next use of the same size takes nothing from the heap.
+ */
+class LinearArena
+{
+public:
+    explicit LinearArena(size_t blockBytes = FRAME_ARENA_BLOCK_BYTES);
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    size_t blockBytes;
+    std::vector<Block> blocks;
+    size_t currentBlock = 0;
+    size_t offset = 0;
+    size_t usedBytes = 0;
+    size_t capacity = 0;
+
+public:
+    /*
+     * alignment has to be a power of two
+     */
+    void* allocate(size_t size, size_t alignment);
+    void reset();
+    size_t getUsedBytes() const;
+    size_t getCapacity() const;
+};
+
+struct FrameArenaStats
+{
+    uint64_t frameIndex = 0;
+    uint32_t threadsAmount = 0;
+    // Heap memory held by the arenas of every thread and buffer
+    uint64_t capacityBytes = 0;
+};
+
+/*
+ * Memory for data that lives a few frames at most: scratch of one frame, or what another thread reads of the frame
+ * being built. Every thread allocates from arenas of its own without locking and resets them itself, the first time
+ * it allocates in a new frame. What a thread allocates while frame N is current stays valid until frame
+ * N + FRAME_ARENA_BUFFERS begins. Threads that allocate outside of frames keep growing the current buffer until the
+ * next one begins.
+ */
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t blockBytes = FRAME_ARENA_BLOCK_BYTES);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /*
+     * The arena the engine frames run on, Renderer begins its frames
+     */
+    static FrameArena& getShared();
+
+private:
+    struct ThreadArenas
+    {
+        std::thread::id thread;
+        uint64_t frameIndex = 0;
+        std::vector<std::unique_ptr<LinearArena>> buffers;
+        // Written by the owning thread, read by getStats
+        std::atomic<uint64_t> capacityBytes{0};
+    };
+
+    // Tells arenas apart in the per-thread lookup cache, addresses may be reused
+    uint64_t id;
+    size_t blockBytes;
+    std::atomic<uint64_t> frameIndex{0};
+    std::mutex threadsMutex;
+    std::vector<std::unique_ptr<ThreadArenas>> threads;
+
+public:
+    /*
+     * Only by the thread that paces the frames, the buffer of frame N - FRAME_ARENA_BUFFERS gets reused
+     */
+    void beginFrame();
+    uint64_t getFrameIndex() const;
+    void* allocate(size_t size, size_t alignment);
+    FrameArenaStats getStats();
+
+private:
+    ThreadArenas& getThreadArenas();
+};
+
+/*
+ * Standard allocator over a FrameArena, deallocate does nothing. Containers using it must not outlive the frames
+ * their memory is valid for.
+ */
+template <typename T>
+class FrameAllocator
+{
+public:
+    typedef T value_type;
+
+    FrameAllocator() : pArena(&FrameArena::getShared())
+    {
+    }
+
+    explicit FrameAllocator(FrameArena& arena) : pArena(&arena)
+    {
+    }
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : pArena(other.getArena())
+    {
+    }
+
+private:
+    FrameArena* pArena;
+
+public:
+    T* allocate(size_t count)
+    {
+        if (count > SIZE_MAX / sizeof(T))
+        {
+            throw std::bad_alloc();
+        }
+        return (T*)pArena->allocate(count * sizeof(T), alignof(T));
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    FrameArena* getArena() const
+    {
+        return pArena;
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const
+    {
+        return pArena == other.getArena();
+    }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const
+    {
+        return pArena != other.getArena();
+    }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,462 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <exception>
+
+struct JobCounter::Job
+{
+    JobFunction function;
+    JobCounter* counter;
+    // Pool of the thread that created the job, it returns there once it ran
+    JobPool* pool;
+    // Next job of the external queue or of a pool list
+    Job* next;
+};
+
+/*
+ * Jobs that ran, for the next submits of the owning thread. The owner pops its free list without atomics, the
+ * threads that ran its jobs push them to returned, which the owner takes over whole once the free list is empty.
+ * Only taking the whole list keeps the pushes safe from ABA.
+ */
+struct JobCounter::JobPool
+{
+    Job* free = nullptr;
+    std::atomic<Job*> returned{nullptr};
+    // Set when the owning thread exited, the next thread without a pool takes it over
+    std::atomic<bool> orphaned{false};
+    // Owner only, jobs are allocated JOB_SYSTEM_POOL_JOBS at a time and never freed
+    std::vector<std::unique_ptr<Job[]>> blocks;
+
+    void addBlock()
+    {
+        blocks.push_back(std::make_unique<Job[]>(JOB_SYSTEM_POOL_JOBS));
+        Job* block = blocks.back().get();
+        for (uint32_t i = 0; i < JOB_SYSTEM_POOL_JOBS; i++)
+        {
+            block[i].pool = this;
+            block[i].next = i + 1 < JOB_SYSTEM_POOL_JOBS ? &block[i + 1] : free;
+        }
+        free = block;
+    }
+};
+
+namespace
+{
+    thread_local const JobSystem* currentSystem = nullptr;
+    thread_local int32_t currentWorker = -1;
+    thread_local uint32_t stealStart = 0;
+
+    /*
+     * Decrements a count above one without locking, such a count cannot reach zero while the caller still looks at
+     * the counter. False when the count is one and the decrement has to go through the counter mutex.
+     */
+    bool decrementAboveOne(std::atomic<uint32_t>& value)
+    {
+        uint32_t current = value.load(std::memory_order_relaxed);
+        while (current > 1)
+        {
+            if (value.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+bool JobCounter::isDone() const
+{
+    return value.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem(uint32_t threadsAmount) : threadsAmount(threadsAmount ? threadsAmount : 1)
+{
+    for (uint32_t i = 1; i < this->threadsAmount; i++)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (uint32_t i = 0; i < (uint32_t)workers.size(); i++)
+    {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+    // Naming a worker and setting up its job pool allocate, neither may happen later in the middle of a frame
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    workerStarted.wait(lock, [this]()
+    {
+        return startedWorkers == (uint32_t)workers.size();
+    });
+}
+
+JobSystem& JobSystem::getShared()
+{
+    // Shader builds are awaited through futures that do not run jobs, at least one worker has to make progress
+    uint32_t cores = std::thread::hardware_concurrency();
+    static JobSystem shared(cores > 2 ? cores : 2);
+    return shared;
+}
+
+void JobSystem::submit(JobFunction function, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    schedule(createJob(std::move(function), counter));
+}
+
+void JobSystem::submitAfter(JobCounter& dependency, JobFunction function, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job* job = createJob(std::move(function), counter);
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.value.load(std::memory_order_acquire) != 0)
+        {
+            dependency.continuations.push_back(job);
+            return;
+        }
+    }
+    schedule(job);
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    int32_t workerIndex = getCurrentWorker();
+    uint32_t failedSearches = 0;
+    while (counter.value.load(std::memory_order_acquire) != 0)
+    {
+        Job* job = findJob(workerIndex);
+        if (job)
+        {
+            execute(job, workerIndex);
+            failedSearches = 0;
+        }
+        else if (++failedSearches > JOB_SYSTEM_WAIT_SPINS)
+        {
+            std::this_thread::yield();
+        }
+    }
+    // The last job may still hold the mutex, after this the caller is free to destroy the counter
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t minGrain,
+                            const std::function<void(uint32_t begin, uint32_t end)>& function)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    uint32_t grain = count / (threadsAmount * JOB_SYSTEM_SPLITS_PER_THREAD);
+    grain = grain > minGrain ? grain : minGrain;
+    grain = grain ? grain : 1;
+    if (threadsAmount == 1 || count <= grain)
+    {
+        function(0, count);
+        return;
+    }
+
+    // The split jobs only capture the state and their range, small enough for std::function to store in place
+    struct Split
+    {
+        JobSystem* system;
+        const std::function<void(uint32_t, uint32_t)>* function;
+        uint32_t grain;
+        JobCounter counter;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+
+        void run(uint32_t begin, uint32_t end)
+        {
+            while (end - begin > grain)
+            {
+                uint32_t middle = begin + (end - begin) / 2;
+                Split* split = this;
+                system->submit([split, middle, end]()
+                {
+                    split->run(middle, end);
+                }, &counter);
+                end = middle;
+            }
+            if (failed.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            try
+            {
+                (*function)(begin, end);
+            }
+            catch (...)
+            {
+                if (!failed.exchange(true))
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    Split split;
+    split.system = this;
+    split.function = &function;
+    split.grain = grain;
+    split.run(0, count);
+    wait(split.counter);
+    if (split.error)
+    {
+        std::rethrow_exception(split.error);
+    }
+}
+
+uint32_t JobSystem::getThreadsAmount() const
+{
+    return threadsAmount;
+}
+
+JobSystemStats JobSystem::getStats() const
+{
+    JobSystemStats stats;
+    stats.executedJobs = externalExecutedJobs.load(std::memory_order_relaxed);
+    for (auto& worker : workers)
+    {
+        stats.executedJobs += worker->executedJobs.load(std::memory_order_relaxed);
+        stats.stolenJobs += worker->stolenJobs.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    jobQueued.notify_all();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    // Jobs still waiting on a counter never became runnable
+}
+
+JobSystem::Job* JobSystem::createJob(JobFunction&& function, JobCounter* counter)
+{
+    JobPool* pool = getThreadJobPool();
+    if (!pool->free)
+    {
+        pool->free = pool->returned.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (!pool->free)
+    {
+        pool->addBlock();
+    }
+    Job* job = pool->free;
+    pool->free = job->next;
+    job->function = std::move(function);
+    job->counter = counter;
+    return job;
+}
+
+void JobSystem::releaseJob(Job* job)
+{
+    // Whatever the function captured goes now, not when the job is reused
+    job->function.reset();
+    JobPool* pool = job->pool;
+    Job* head = pool->returned.load(std::memory_order_relaxed);
+    do
+    {
+        job->next = head;
+    }
+    while (!pool->returned.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+JobSystem::JobPool* JobSystem::getThreadJobPool()
+{
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<JobPool>> pools;
+    };
+
+    // Gives the pool up when the thread exits, its jobs may still be running elsewhere
+    struct ThreadPool
+    {
+        JobPool* pool = nullptr;
+
+        ~ThreadPool()
+        {
+            if (pool)
+            {
+                pool->orphaned.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local ThreadPool threadPool;
+    if (threadPool.pool)
+    {
+        return threadPool.pool;
+    }
+    // Never destroyed, jobs are returned to their pools until the last one ran
+    static Registry* registry = new Registry();
+    std::lock_guard<std::mutex> lock(registry->mutex);
+    for (auto& pool : registry->pools)
+    {
+        bool orphaned = true;
+        if (pool->orphaned.compare_exchange_strong(orphaned, false, std::memory_order_acquire))
+        {
+            threadPool.pool = pool.get();
+            return threadPool.pool;
+        }
+    }
+    registry->pools.push_back(std::make_unique<JobPool>());
+    threadPool.pool = registry->pools.back().get();
+    // Allocated with the pool, so a thread's first frames allocate no jobs either
+    threadPool.pool->addBlock();
+    return threadPool.pool;
+}
+
+void JobSystem::schedule(Job* job)
+{
+    // Counted before it is published, a thief taking it right away must not take queuedJobs below zero
+    queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+    int32_t workerIndex = getCurrentWorker();
+    if (workerIndex >= 0)
+    {
+        workers[workerIndex]->jobs.push(job);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(externalMutex);
+        job->next = nullptr;
+        (externalLast ? externalLast->next : externalFirst) = job;
+        externalLast = job;
+        externalJobsAmount.fetch_add(1, std::memory_order_relaxed);
+    }
+    // A worker counts itself as sleeping before it checks queuedJobs, so one of the two sees the other
+    if (sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        jobQueued.notify_one();
+    }
+}
+
+void JobSystem::execute(Job* job, int32_t workerIndex)
+{
+    job->function();
+    JobCounter* counter = job->counter;
+    releaseJob(job);
+    if (workerIndex >= 0)
+    {
+        workers[workerIndex]->executedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        externalExecutedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (!counter || decrementAboveOne(counter->value))
+    {
+        return;
+    }
+
+    std::vector<Job*> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return;
+        }
+        continuations.swap(counter->continuations);
+    }
+    for (Job* continuation : continuations)
+    {
+        schedule(continuation);
+    }
+}
+
+JobSystem::Job* JobSystem::findJob(int32_t workerIndex)
+{
+    if (queuedJobs.load(std::memory_order_acquire) == 0)
+    {
+        return nullptr;
+    }
+    Job* job = nullptr;
+    if (workerIndex >= 0 && workers[workerIndex]->jobs.pop(job))
+    {
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+    if (externalJobsAmount.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(externalMutex);
+        if (externalFirst)
+        {
+            job = externalFirst;
+            externalFirst = job->next;
+            externalLast = externalFirst ? externalLast : nullptr;
+            externalJobsAmount.fetch_sub(1, std::memory_order_relaxed);
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    uint32_t workersAmount = (uint32_t)workers.size();
+    uint32_t start = workerIndex >= 0 ? (uint32_t)workerIndex : stealStart++;
+    for (uint32_t i = 1; i <= workersAmount; i++)
+    {
+        uint32_t victim = (start + i) % workersAmount;
+        if ((int32_t)victim != workerIndex && workers[victim]->jobs.steal(job))
+        {
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            if (workerIndex >= 0)
+            {
+                workers[workerIndex]->stolenJobs.fetch_add(1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex)
+{
+    currentSystem = this;
+    currentWorker = (int32_t)workerIndex;
+    Profiler::setThreadName("Job worker " + std::to_string(workerIndex));
+    getThreadJobPool();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        startedWorkers++;
+    }
+    workerStarted.notify_all();
+    while (true)
+    {
+        Job* job = findJob((int32_t)workerIndex);
+        if (job)
+        {
+            execute(job, (int32_t)workerIndex);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        jobQueued.wait(lock, [this]()
+        {
+            return stopping || queuedJobs.load(std::memory_order_seq_cst) > 0;
+        });
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping && queuedJobs.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+int32_t JobSystem::getCurrentWorker() const
+{
+    return currentSystem == this ? currentWorker : -1;
+}
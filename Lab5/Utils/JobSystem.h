@@ -0,0 +1,236 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "WorkStealingDeque.h"
+
+// parallelFor cuts a range into about this many pieces per thread before the minimum grain takes over
+#define JOB_SYSTEM_SPLITS_PER_THREAD 4u
+// Failed searches a waiting thread spins through before it starts yielding
+#define JOB_SYSTEM_WAIT_SPINS 64u
+// Jobs a thread's pool starts with and grows by, more than a frame keeps in flight per submitting thread
+#define JOB_SYSTEM_POOL_JOBS 256u
+// Bytes a job may capture, larger state has to be reached through a pointer
+#define JOB_FUNCTION_STORAGE 64u
+
+class JobSystem;
+
+/*
+ * Move-only void() callable stored inside the job, submitting never allocates for what a job captures. Callables
+ * larger than JOB_FUNCTION_STORAGE do not compile.
+ */
+class JobFunction
+{
+public:
+    JobFunction() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, JobFunction>::value>>
+    JobFunction(F&& function)
+    {
+        typedef std::decay_t<F> Callable;
+        static_assert(sizeof(Callable) <= JOB_FUNCTION_STORAGE, "Job captures too much, capture a pointer instead");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Job capture is over-aligned");
+        static_assert(std::is_nothrow_move_constructible<Callable>::value, "Job capture must move without throwing");
+        new (storage) Callable(std::forward<F>(function));
+        invoke = [](void* pCallable)
+        {
+            (*static_cast<Callable*>(pCallable))();
+        };
+        relocate = [](void* pSource, void* pDestination)
+        {
+            Callable* pCallable = static_cast<Callable*>(pSource);
+            if (pDestination)
+            {
+                new (pDestination) Callable(std::move(*pCallable));
+            }
+            pCallable->~Callable();
+        };
+    }
+
+    JobFunction(JobFunction&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    JobFunction& operator=(JobFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.invoke)
+            {
+                other.relocate(other.storage, storage);
+                invoke = other.invoke;
+                relocate = other.relocate;
+                other.invoke = nullptr;
+                other.relocate = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    JobFunction(const JobFunction&) = delete;
+    JobFunction& operator=(const JobFunction&) = delete;
+
+    ~JobFunction()
+    {
+        reset();
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage[JOB_FUNCTION_STORAGE];
+    void (*invoke)(void* pCallable) = nullptr;
+    // Moves the callable to pDestination and destroys the source, only destroys it when pDestination is null
+    void (*relocate)(void* pSource, void* pDestination) = nullptr;
+
+public:
+    void operator()()
+    {
+        invoke(storage);
+    }
+
+    explicit operator bool() const
+    {
+        return invoke != nullptr;
+    }
+
+    void reset()
+    {
+        if (invoke)
+        {
+            relocate(storage, nullptr);
+            invoke = nullptr;
+            relocate = nullptr;
+        }
+    }
+};
+
+/*
+ * Counts unfinished jobs, a job submitted with a counter increments it and decrements it once it ran. Jobs submitted
+ * after a counter start when it reaches zero. Must outlive the jobs that reference it.
+ */
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+private:
+    friend class JobSystem;
+    struct Job;
+    struct JobPool;
+
+    std::atomic<uint32_t> value{0};
+    std::mutex mutex;
+    std::vector<Job*> continuations;
+
+public:
+    bool isDone() const;
+};
+
+struct JobSystemStats
+{
+    uint64_t executedJobs = 0;
+    // Jobs a worker took from another worker's deque
+    uint64_t stolenJobs = 0;
+};
+
+/*
+ * Work-stealing scheduler shared by everything that runs on more than one core. Every worker owns a Chase-Lev deque
+ * it pushes its own jobs to and pops from, idle workers steal the oldest jobs of the others and jobs from threads
+ * outside the system go through a locked queue. Waiting for a counter runs other jobs until it reaches zero, so a
+ * job may wait on jobs it submitted without tying up its thread. Jobs must not throw, parallelFor is the exception.
+ */
+class JobSystem
+{
+public:
+    /*
+     * threadsAmount counts the thread that waits, threadsAmount - 1 workers are started
+     */
+    explicit JobSystem(uint32_t threadsAmount);
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /*
+     * One system for the engine and its tools, sized to the cores of the machine and never without a worker
+     */
+    static JobSystem& getShared();
+
+private:
+    typedef JobCounter::Job Job;
+    typedef JobCounter::JobPool JobPool;
+
+    struct alignas(64) Worker
+    {
+        WorkStealingDeque<Job*> jobs;
+        std::atomic<uint64_t> executedJobs{0};
+        std::atomic<uint64_t> stolenJobs{0};
+    };
+
+    uint32_t threadsAmount;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::mutex externalMutex;
+    // Intrusive list through Job::next, queueing allocates nothing
+    Job* externalFirst = nullptr;
+    Job* externalLast = nullptr;
+    std::atomic<uint32_t> externalJobsAmount{0};
+    std::atomic<uint64_t> externalExecutedJobs{0};
+    // Submitted jobs no thread took yet, idle workers sleep while it is zero
+    std::atomic<uint32_t> queuedJobs{0};
+    std::atomic<uint32_t> sleepingWorkers{0};
+    std::mutex sleepMutex;
+    std::condition_variable jobQueued;
+    // Workers that set up their thread, the constructor returns once all did
+    uint32_t startedWorkers = 0;
+    std::condition_variable workerStarted;
+    std::atomic<bool> stopping{false};
+
+public:
+    void submit(JobFunction function, JobCounter* counter = nullptr);
+    /*
+     * Queues function once dependency reaches zero, right away when it already is
+     */
+    void submitAfter(JobCounter& dependency, JobFunction function, JobCounter* counter = nullptr);
+    /*
+     * Runs queued jobs on the calling thread until counter reaches zero
+     */
+    void wait(JobCounter& counter);
+    /*
+     * Calls function on subranges of [0, count) no smaller than minGrain and returns when all are done. Ranges are
+     * split in halves on demand so idle threads steal the large pieces. The first exception thrown is rethrown here.
+     */
+    void parallelFor(uint32_t count, uint32_t minGrain, const std::function<void(uint32_t begin, uint32_t end)>&
+                     function);
+    uint32_t getThreadsAmount() const;
+    JobSystemStats getStats() const;
+    ~JobSystem();
+
+private:
+    /*
+     * Jobs are recycled through the pool of the thread that submits them. A pool starts with JOB_SYSTEM_POOL_JOBS
+     * jobs and only allocates another block when a thread has more than that in flight.
+     */
+    static Job* createJob(JobFunction&& function, JobCounter* counter);
+    static void releaseJob(Job* job);
+    static JobPool* getThreadJobPool();
+    void schedule(Job* job);
+    void execute(Job* job, int32_t workerIndex);
+    /*
+     * Own deque first, then the external queue, then the other workers. workerIndex is -1 outside the system
+     */
+    Job* findJob(int32_t workerIndex);
+    void workerLoop(uint32_t workerIndex);
+    int32_t getCurrentWorker() const;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * Read-only memory mapping of a whole file, the contents stay valid until close or destruction
+ */
+class MappedFile
+{
+private:
+    const uint8_t* pData = nullptr;
+    size_t dataSize = 0;
+#if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    /*
+     * Returns false when the file is missing, empty or cannot be mapped
+     */
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const;
+    size_t size() const;
+};
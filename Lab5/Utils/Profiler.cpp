@@ -0,0 +1,292 @@
+#include "Profiler.h"
+
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "CpuFeatures.h"
+
+std::atomic<bool> Profiler::enabled{false};
+#if defined(PROFILER_TSC)
+const bool Profiler::tscClock = CpuFeatures::hasInvariantTsc();
+#else
+const bool Profiler::tscClock = false;
+#endif
+
+namespace
+{
+    struct ProfileEvent
+    {
+        const ProfileZoneDesc* zone;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    struct Chunk
+    {
+        ProfileEvent events[PROFILER_CHUNK_EVENTS];
+        // Events are published by the release store of the count
+        std::atomic<uint32_t> count{0};
+        std::atomic<Chunk*> next{nullptr};
+    };
+
+    struct ThreadBuffer
+    {
+        uint32_t id = 0;
+        std::string name;
+        // Only the recording thread touches it
+        Chunk* current = nullptr;
+        // Under the registry lock, events of first before skipped were cleared
+        Chunk* first = nullptr;
+        uint32_t skipped = 0;
+        std::atomic<uint32_t> chunksAmount{1};
+        std::atomic<uint64_t> droppedEvents{0};
+    };
+
+    struct RuntimeZone
+    {
+        std::string name;
+        std::wstring wideName;
+        ProfileZoneDesc desc;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        // A deque keeps the zones in place while it grows
+        std::deque<RuntimeZone> runtimeZones;
+        std::map<std::string, const ProfileZoneDesc*> runtimeZoneIndices;
+    };
+
+    thread_local ThreadBuffer* threadBuffer = nullptr;
+
+    Registry& getRegistry()
+    {
+        // Never destroyed, job workers may still record while static objects are torn down
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    ThreadBuffer* getThreadBuffer()
+    {
+        if (!threadBuffer)
+        {
+            Registry& registry = getRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->id = (uint32_t)registry.threads.size();
+            buffer->name = "Thread " + std::to_string(buffer->id);
+            buffer->current = buffer->first = new Chunk();
+            threadBuffer = buffer.get();
+            registry.threads.push_back(std::move(buffer));
+        }
+        return threadBuffer;
+    }
+
+    /*
+     * Calls visit for every event not cleared yet, registry lock held
+     */
+    template <typename Visit>
+    void forEachEvent(const ThreadBuffer& buffer, Visit visit)
+    {
+        uint32_t begin = buffer.skipped;
+        for (Chunk* chunk = buffer.first; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            uint32_t count = chunk->count.load(std::memory_order_acquire);
+            for (uint32_t i = begin; i < count; i++)
+            {
+                visit(chunk->events[i]);
+            }
+            begin = 0;
+        }
+    }
+
+    double measureTicksPerSecond()
+    {
+        if (!Profiler::tscClock)
+        {
+            return 1e9;
+        }
+        auto clockStart = std::chrono::steady_clock::now();
+        uint64_t ticksStart = Profiler::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(PROFILER_CALIBRATION_MILLISECONDS));
+        uint64_t ticks = Profiler::now() - ticksStart;
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - clockStart).count();
+        return (double)ticks / seconds;
+    }
+
+    void writeJsonString(std::ostream& stream, const std::string& text)
+    {
+        stream << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                stream << '\\' << c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+            }
+            else
+            {
+                stream << c;
+            }
+        }
+        stream << '"';
+    }
+}
+
+void Profiler::setEnabled(bool enable)
+{
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const std::string& name)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(getRegistry().mutex);
+    buffer->name = name;
+}
+
+const ProfileZoneDesc* Profiler::registerZone(const std::string& name)
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto existing = registry.runtimeZoneIndices.find(name);
+    if (existing != registry.runtimeZoneIndices.end())
+    {
+        return existing->second;
+    }
+    registry.runtimeZones.emplace_back();
+    RuntimeZone& zone = registry.runtimeZones.back();
+    zone.name = name;
+    zone.wideName = std::wstring(name.begin(), name.end());
+    zone.desc = {zone.name.c_str(), zone.wideName.c_str(), "", 0};
+    registry.runtimeZoneIndices[name] = &zone.desc;
+    return &zone.desc;
+}
+
+void Profiler::clear()
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto& buffer : registry.threads)
+    {
+        // Only the last chunk can still be written, the full ones before it are freed
+        Chunk* chunk = buffer->first;
+        Chunk* next;
+        while ((next = chunk->next.load(std::memory_order_acquire)))
+        {
+            delete chunk;
+            buffer->chunksAmount.fetch_sub(1, std::memory_order_relaxed);
+            chunk = next;
+        }
+        buffer->first = chunk;
+        buffer->skipped = chunk->count.load(std::memory_order_acquire);
+        buffer->droppedEvents.store(0, std::memory_order_relaxed);
+    }
+}
+
+ProfilerStats Profiler::getStats()
+{
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ProfilerStats stats;
+    stats.threadsAmount = (uint32_t)registry.threads.size();
+    for (auto& buffer : registry.threads)
+    {
+        forEachEvent(*buffer, [&stats](const ProfileEvent&)
+        {
+            stats.eventsAmount++;
+        });
+        stats.droppedEventsAmount += buffer->droppedEvents.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+double Profiler::getTicksPerSecond()
+{
+    static const double ticksPerSecond = measureTicksPerSecond();
+    return ticksPerSecond;
+}
+
+void Profiler::writeChromeTrace(const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open trace file " + path);
+    }
+    // The first call sleeps, outside the lock so threads registering meanwhile do not wait
+    double ticksPerMicrosecond = getTicksPerSecond() / 1e6;
+    Registry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    uint64_t origin = UINT64_MAX;
+    for (auto& buffer : registry.threads)
+    {
+        forEachEvent(*buffer, [&origin](const ProfileEvent& event)
+        {
+            origin = event.start < origin ? event.start : origin;
+        });
+    }
+
+    // Microseconds with nanosecond decimals
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::fixed << std::setprecision(3);
+    bool firstEvent = true;
+    for (auto& buffer : registry.threads)
+    {
+        file << (firstEvent ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" <<
+            buffer->id << ",\"args\":{\"name\":";
+        writeJsonString(file, buffer->name);
+        file << "}}";
+        firstEvent = false;
+        forEachEvent(*buffer, [&](const ProfileEvent& event)
+        {
+            file << ",\n{\"name\":";
+            writeJsonString(file, event.zone->name);
+            file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" <<
+                (double)(event.start - origin) / ticksPerMicrosecond << ",\"dur\":" <<
+                (double)(event.end - event.start) / ticksPerMicrosecond << "}";
+        });
+    }
+    file << "\n]}\n";
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write trace file " + path);
+    }
+}
+
+void Profiler::record(const ProfileZoneDesc* zone, uint64_t start, uint64_t end)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    Chunk* chunk = buffer->current;
+    uint32_t count = chunk->count.load(std::memory_order_relaxed);
+    if (count == PROFILER_CHUNK_EVENTS)
+    {
+        if (buffer->chunksAmount.load(std::memory_order_relaxed) >= PROFILER_MAX_CHUNKS_PER_THREAD)
+        {
+            buffer->droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Chunk* next = new Chunk();
+        buffer->chunksAmount.fetch_add(1, std::memory_order_relaxed);
+        // The chunk is never touched by this thread again, so clear may free it from now on
+        chunk->next.store(next, std::memory_order_release);
+        buffer->current = chunk = next;
+        count = 0;
+    }
+    chunk->events[count] = {zone, start, end};
+    chunk->count.store(count + 1, std::memory_order_release);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_TSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILER_TSC
+#endif
+
+// Events a thread buffer grows by, and the most it keeps before dropping the rest
+#define PROFILER_CHUNK_EVENTS 4096u
+#define PROFILER_MAX_CHUNKS_PER_THREAD 256u
+// How long the time stamp counter is compared against steady_clock to find its rate
+#define PROFILER_CALIBRATION_MILLISECONDS 20u
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+/*
+ * Times the rest of the enclosing scope, name must be a string literal
+ */
+#define PROFILE_ZONE(name) PROFILE_ZONE_ANNOTATED(name, nullptr)
+/*
+ * Also opens an event on annotation for graphics debuggers
+ */
+#define PROFILE_ZONE_ANNOTATED(name, annotation) \
+    static const ProfileZoneDesc PROFILER_CONCAT(profileZoneDesc, __LINE__) = { \
+        name, PROFILER_CONCAT(L, name), __FILE__, __LINE__ \
+    }; \
+    ProfileZone PROFILER_CONCAT(profileZone, __LINE__)(&PROFILER_CONCAT(profileZoneDesc, __LINE__), annotation)
+
+/*
+ * One per call site, must outlive the profiler. The wide name is what graphics debuggers take.
+ */
+struct ProfileZoneDesc
+{
+    const char* name;
+    const wchar_t* wideName;
+    const char* file;
+    uint32_t line;
+};
+
+/*
+ * Forwards zones to a graphics debugger, e.g. ID3DUserDefinedAnnotation
+ */
+class IProfilerAnnotation
+{
+public:
+    virtual void beginEvent(const ProfileZoneDesc* zone) = 0;
+    virtual void endEvent() = 0;
+};
+
+struct ProfilerStats
+{
+    uint32_t threadsAmount = 0;
+    uint64_t eventsAmount = 0;
+    // Events lost because a thread buffer was full
+    uint64_t droppedEventsAmount = 0;
+};
+
+/*
+ * Collects the zones of every thread while enabled. Each thread appends to its own buffer without locks and
+ * publishes every event with a release store, so the trace can be written while the threads keep recording. Only
+ * registering a thread and the calls below take a lock.
+ */
+namespace Profiler
+{
+    void setEnabled(bool enabled);
+    bool isEnabled();
+    /*
+     * Shown as the thread name in the trace
+     */
+    void setThreadName(const std::string& name);
+    /*
+     * Zone for a name only known at runtime, the same name returns the same zone
+     */
+    const ProfileZoneDesc* registerZone(const std::string& name);
+    /*
+     * Drops the recorded events
+     */
+    void clear();
+    ProfilerStats getStats();
+    /*
+     * Chrome trace event format, opens in chrome://tracing and Perfetto. Throws std::runtime_error when the file
+     * cannot be written.
+     */
+    void writeChromeTrace(const std::string& path);
+
+    // Decided once when the program starts
+    extern const bool tscClock;
+
+    /*
+     * Ticks of the clock zones are timed with. That is the time stamp counter where it is invariant, reading it costs
+     * a fraction of steady_clock, and steady_clock nanoseconds elsewhere.
+     */
+    inline uint64_t now()
+    {
+#if defined(PROFILER_TSC)
+        if (tscClock)
+        {
+            return __rdtsc();
+        }
+#endif
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*
+     * Rate of now, the first call on the time stamp counter measures it for PROFILER_CALIBRATION_MILLISECONDS
+     */
+    double getTicksPerSecond();
+
+    void record(const ProfileZoneDesc* zone, uint64_t start, uint64_t end);
+
+    extern std::atomic<bool> enabled;
+}
+
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const ProfileZoneDesc* zone, IProfilerAnnotation* annotation = nullptr)
+        : zone(zone), annotation(annotation)
+    {
+        if (annotation)
+        {
+            annotation->beginEvent(zone);
+        }
+        start = Profiler::enabled.load(std::memory_order_relaxed) ? Profiler::now() : 0;
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    ~ProfileZone()
+    {
+        if (start)
+        {
+            Profiler::record(zone, start, Profiler::now());
+        }
+        if (annotation)
+        {
+            annotation->endEvent();
+        }
+    }
+
+private:
+    const ProfileZoneDesc* zone;
+    IProfilerAnnotation* annotation;
+    uint64_t start;
+};
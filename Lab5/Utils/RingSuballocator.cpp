@@ -0,0 +1,100 @@
+#include "RingSuballocator.h"
+#include <stdexcept>
+
+RingSuballocator::RingSuballocator(uint64_t capacity, uint64_t alignment) : capacity(capacity), alignment(alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        throw std::runtime_error("Ring suballocator alignment has to be a power of two");
+    }
+    if (capacity == 0 || capacity % alignment != 0)
+    {
+        throw std::runtime_error("Ring suballocator capacity has to be a multiple of the alignment");
+    }
+}
+
+uint64_t RingSuballocator::allocate(uint64_t size)
+{
+    if (size == 0 || size > capacity)
+    {
+        return RING_SUBALLOCATOR_FULL;
+    }
+    uint64_t freeBytes = capacity - usedBytes;
+    uint64_t offset = (head + alignment - 1) & ~(alignment - 1);
+    uint64_t consumed = offset - head + size;
+    if (offset + size > capacity)
+    {
+        // Does not fit before the end, skip the rest of the ring and start over at 0
+        offset = 0;
+        consumed = capacity - head + size;
+    }
+    if (consumed > freeBytes)
+    {
+        return RING_SUBALLOCATOR_FULL;
+    }
+    usedBytes += consumed;
+    frameBytes += consumed;
+    head = offset + size == capacity ? 0 : offset + size;
+    return offset;
+}
+
+void RingSuballocator::finishFrame(uint64_t fence)
+{
+    if (framesAmount > 0 && fence <= frames[(firstFrame + framesAmount - 1) % frames.size()].fence)
+    {
+        throw std::runtime_error("Ring suballocator fences have to grow");
+    }
+    if (framesAmount == frames.size())
+    {
+        // Unrolls the queue so the new slots come after the newest frame
+        std::vector<FrameRange> grown(frames.size() ? frames.size() * 2 : 4);
+        for (size_t i = 0; i < framesAmount; i++)
+        {
+            grown[i] = frames[(firstFrame + i) % frames.size()];
+        }
+        frames.swap(grown);
+        firstFrame = 0;
+    }
+    frames[(firstFrame + framesAmount) % frames.size()] = {fence, frameBytes};
+    framesAmount++;
+    frameBytes = 0;
+}
+
+void RingSuballocator::releaseCompleted(uint64_t completedFence)
+{
+    while (framesAmount > 0 && frames[firstFrame].fence <= completedFence)
+    {
+        usedBytes -= frames[firstFrame].size;
+        firstFrame = (firstFrame + 1) % frames.size();
+        framesAmount--;
+    }
+}
+
+void RingSuballocator::reset()
+{
+    head = 0;
+    usedBytes = 0;
+    frameBytes = 0;
+    firstFrame = 0;
+    framesAmount = 0;
+}
+
+bool RingSuballocator::hasPendingFrames() const
+{
+    return framesAmount > 0;
+}
+
+uint64_t RingSuballocator::getOldestPendingFence() const
+{
+    return frames[firstFrame].fence;
+}
+
+uint64_t RingSuballocator::getUsedBytes() const
+{
+    return usedBytes;
+}
+
+uint64_t RingSuballocator::getCapacity() const
+{
+    return capacity;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define RING_SUBALLOCATOR_FULL UINT64_MAX
+
+/*
+ * Hands out aligned ranges of one ring shaped buffer. Everything allocated between two finishFrame calls is owned by
+ * the fence value passed to the second one and comes back once releaseCompleted sees that fence. Frames are released
+ * in the order they were finished, so the free space is always the single range from the newest allocation to the
+ * oldest one still in use.
+ */
+class RingSuballocator
+{
+public:
+    /*
+     * capacity has to be a multiple of alignment, alignment a power of two
+     */
+    RingSuballocator(uint64_t capacity, uint64_t alignment);
+
+private:
+    struct FrameRange
+    {
+        uint64_t fence;
+        // Allocated bytes including alignment padding and the tail skipped when wrapping
+        uint64_t size;
+    };
+
+    uint64_t capacity;
+    uint64_t alignment;
+    uint64_t head = 0;
+    uint64_t usedBytes = 0;
+    uint64_t frameBytes = 0;
+    // Circular queue of the pending frames, grows only when more frames are in flight than ever before
+    std::vector<FrameRange> frames;
+    size_t firstFrame = 0;
+    size_t framesAmount = 0;
+
+public:
+    /*
+     * Offset of size free bytes, RING_SUBALLOCATOR_FULL while the unreleased frames hold too much of the ring
+     */
+    uint64_t allocate(uint64_t size);
+    /*
+     * Hands the allocations since the previous call to fence, fence values have to grow
+     */
+    void finishFrame(uint64_t fence);
+    /*
+     * Recycles every finished frame whose fence is not greater than completedFence
+     */
+    void releaseCompleted(uint64_t completedFence);
+    /*
+     * Forgets every allocation, for when the memory behind the ring got replaced
+     */
+    void reset();
+
+    bool hasPendingFrames() const;
+    /*
+     * Fence of the oldest frame still in use, only valid with pending frames
+     */
+    uint64_t getOldestPendingFence() const;
+    uint64_t getUsedBytes() const;
+    uint64_t getCapacity() const;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * Bounded lock-free queue between exactly one producer thread and one consumer thread. The capacity is rounded up to
+ * a power of two, push fails while the queue is full and pop while it is empty, neither ever blocks.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(uint32_t capacity)
+    {
+        uint32_t rounded = 1;
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+        items.resize(rounded);
+        mask = rounded - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+private:
+    std::vector<T> items;
+    uint32_t mask;
+    // Each side writes only its own index and keeps a copy of the other one, refreshed when the copy says it must wait
+    alignas(64) std::atomic<uint32_t> head{0};
+    uint32_t cachedTail = 0;
+    alignas(64) std::atomic<uint32_t> tail{0};
+    uint32_t cachedHead = 0;
+
+public:
+    /*
+     * Producer only, item is only moved from when it was queued so a full queue can be retried with it
+     */
+    template <typename U>
+    bool push(U&& item)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == items.size())
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == items.size())
+            {
+                return false;
+            }
+        }
+        items[t & mask] = std::forward<U>(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Consumer only, takes the oldest item
+     */
+    bool pop(T& itemOutput)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail)
+            {
+                return false;
+            }
+        }
+        itemOutput = std::move(items[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Exact on the consumer side, elsewhere it may already be stale
+     */
+    bool isEmpty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t getCapacity() const
+    {
+        return (uint32_t)items.size();
+    }
+};
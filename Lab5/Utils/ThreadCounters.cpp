@@ -0,0 +1,67 @@
+#include "ThreadCounters.h"
+
+#include <atomic>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace
+{
+    // Plain counters need no constructor, so allocations made while a thread is set up can count too
+    thread_local uint64_t threadBytesRead = 0;
+    thread_local uint64_t threadAllocationsAmount = 0;
+    thread_local uint64_t threadAllocatedBytes = 0;
+    std::atomic<uint64_t> processAllocationsAmount{0};
+
+    double getThreadCpuMilliseconds()
+    {
+#if defined(_WIN32)
+        FILETIME creation, exitTime, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exitTime, &kernel, &user))
+        {
+            return 0;
+        }
+        // 100 ns units
+        uint64_t kernelTime = (uint64_t)kernel.dwHighDateTime << 32 | kernel.dwLowDateTime;
+        uint64_t userTime = (uint64_t)user.dwHighDateTime << 32 | user.dwLowDateTime;
+        return (kernelTime + userTime) / 10000.0;
+#else
+        timespec time;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+        {
+            return 0;
+        }
+        return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+#endif
+    }
+}
+
+ThreadCounters ThreadCounting::get()
+{
+    ThreadCounters counters;
+    counters.cpuMilliseconds = getThreadCpuMilliseconds();
+    counters.bytesRead = threadBytesRead;
+    counters.allocationsAmount = threadAllocationsAmount;
+    counters.allocatedBytes = threadAllocatedBytes;
+    return counters;
+}
+
+uint64_t ThreadCounting::getProcessAllocationsAmount()
+{
+    return processAllocationsAmount.load(std::memory_order_relaxed);
+}
+
+void ThreadCounting::addBytesRead(uint64_t bytes)
+{
+    threadBytesRead += bytes;
+}
+
+void ThreadCounting::addAllocation(size_t bytes)
+{
+    threadAllocationsAmount++;
+    threadAllocatedBytes += bytes;
+    processAllocationsAmount.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Running totals of the calling thread since it started. Allocations are only counted in programs that link
+ * AllocationHooks.cpp, which replaces the global operator new, bytes read only where file reads report them.
+ */
+struct ThreadCounters
+{
+    double cpuMilliseconds = 0;
+    uint64_t bytesRead = 0;
+    uint64_t allocationsAmount = 0;
+    uint64_t allocatedBytes = 0;
+};
+
+namespace ThreadCounting
+{
+    ThreadCounters get();
+    /*
+     * Allocations of every thread since the program started
+     */
+    uint64_t getProcessAllocationsAmount();
+    void addBytesRead(uint64_t bytes);
+    /*
+     * Called by the allocation hooks, must not allocate
+     */
+    void addAllocation(size_t bytes);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Chase-Lev deque with the memory orders of Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models".
+ * The owning thread pushes and pops at the bottom, any other thread steals from the top. The buffer grows when full,
+ * replaced buffers stay alive until the deque is destroyed because a thief may still read from them.
+ */
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Deque items are copied without synchronization");
+
+public:
+    explicit WorkStealingDeque(uint32_t capacity = 256)
+    {
+        uint32_t rounded = 1;
+        while (rounded < capacity)
+        {
+            rounded <<= 1;
+        }
+        buffers.push_back(std::make_unique<Buffer>(rounded));
+        buffer.store(buffers.back().get(), std::memory_order_relaxed);
+    }
+
+private:
+    struct Buffer
+    {
+        explicit Buffer(int64_t capacity) : capacity(capacity), items(new std::atomic<T>[capacity])
+        {
+        }
+
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        T get(int64_t index) const
+        {
+            return items[index & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T item)
+        {
+            items[index & (capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Buffer*> buffer;
+    // Only the owner touches the list
+    std::vector<std::unique_ptr<Buffer>> buffers;
+
+public:
+    /*
+     * Owner only
+     */
+    void push(T item)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Buffer* current = buffer.load(std::memory_order_relaxed);
+        if (b - t > current->capacity - 1)
+        {
+            current = grow(current, t, b);
+        }
+        current->put(b, item);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    /*
+     * Owner only, takes the most recently pushed item
+     */
+    bool pop(T& itemOutput)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Buffer* current = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        itemOutput = current->get(b);
+        if (t == b)
+        {
+            // Last item, a thief may be taking it at the same time
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /*
+     * Any thread, takes the oldest item. Fails when empty or when another thread won the race for it
+     */
+    bool steal(T& itemOutput)
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+        {
+            return false;
+        }
+        Buffer* current = buffer.load(std::memory_order_acquire);
+        T item = current->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return false;
+        }
+        itemOutput = item;
+        return true;
+    }
+
+private:
+    Buffer* grow(Buffer* current, int64_t t, int64_t b)
+    {
+        buffers.push_back(std::make_unique<Buffer>(current->capacity * 2));
+        Buffer* grown = buffers.back().get();
+        for (int64_t i = t; i < b; i++)
+        {
+            grown->put(i, current->get(i));
+        }
+        buffer.store(grown, std::memory_order_release);
+        return grown;
+    }
+};
@@ -0,0 +1,126 @@
+#include "InputDispatcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    inline uint32_t firstBit(uint64_t mask)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+        return (uint32_t)index;
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, (unsigned long)mask))
+        {
+            return (uint32_t)index;
+        }
+        _BitScanForward(&index, (unsigned long)(mask >> 32));
+        return (uint32_t)index + 32;
+#else
+        return (uint32_t)__builtin_ctzll(mask);
+#endif
+    }
+}
+
+void InputDispatcher::addKeyCallback(IWindowKeyCallback* keyCallback)
+{
+    uint32_t keysAmount = 0;
+    WindowKey* keys = keyCallback->getKeys(&keysAmount);
+    for (uint32_t i = 0; i < keysAmount; i++)
+    {
+        if (keys[i].key >= INPUT_KEYS_AMOUNT)
+        {
+            throw std::runtime_error("Input key out of range");
+        }
+        subscriptions.push_back({keys[i].key, keys[i].action, (uint32_t)keyCallbacks.size()});
+        uint64_t bit = 1ull << (keys[i].key & 63u);
+        uint64_t* mask = keys[i].action == KEY_DOWN ? heldKeys : edgeKeys;
+        mask[keys[i].key / 64u] |= bit;
+    }
+    keyCallbacks.push_back(keyCallback);
+    batches.resize(keyCallbacks.size());
+
+    // Stable, so the callbacks of a key keep the order they were added in
+    std::stable_sort(subscriptions.begin(), subscriptions.end(), [](const Subscription& a, const Subscription& b)
+    {
+        return a.key < b.key;
+    });
+    uint32_t subscription = 0;
+    for (uint32_t key = 0; key <= INPUT_KEYS_AMOUNT; key++)
+    {
+        firstSubscriptions[key] = subscription;
+        while (subscription < subscriptions.size() && subscriptions[subscription].key == key)
+        {
+            subscription++;
+        }
+    }
+}
+
+void InputDispatcher::addMouseCallback(IWindowMouseCallback* mouseCallback)
+{
+    mouseCallbacks.push_back(mouseCallback);
+}
+
+void InputDispatcher::dispatch(const InputSnapshot& snapshot)
+{
+    for (auto& batch : batches)
+    {
+        batch.clear();
+    }
+    for (uint32_t word = 0; word < INPUT_KEY_WORDS; word++)
+    {
+        uint64_t down = snapshot.keys[word];
+        uint64_t changed = (down ^ previous.keys[word]) & edgeKeys[word];
+        uint64_t keys = changed | (down & heldKeys[word]);
+        while (keys)
+        {
+            uint32_t bit = firstBit(keys);
+            keys &= keys - 1;
+            uint32_t key = word * 64u + bit;
+            bool isDown = (down >> bit) & 1u;
+            bool isChanged = (changed >> bit) & 1u;
+            WindowKeyAction edge = isDown ? KEY_PRESSED : KEY_UP;
+            for (uint32_t i = firstSubscriptions[key]; i < firstSubscriptions[key + 1]; i++)
+            {
+                const Subscription& subscription = subscriptions[i];
+                if ((subscription.action == KEY_DOWN && isDown) || (isChanged && subscription.action == edge))
+                {
+                    batches[subscription.callbackIndex].push_back({key, subscription.action});
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < keyCallbacks.size(); i++)
+    {
+        if (!batches[i].empty())
+        {
+            dispatchedEvents += batches[i].size();
+            keyCallbacks[i]->keyEvents(batches[i].data(), (uint32_t)batches[i].size());
+        }
+    }
+    if (snapshot.mouseX != previous.mouseX || snapshot.mouseY != previous.mouseY)
+    {
+        for (auto& callback : mouseCallbacks)
+        {
+            callback->mouseMove(snapshot.mouseX, snapshot.mouseY);
+        }
+    }
+    previous = snapshot;
+}
+
+const InputSnapshot& InputDispatcher::getLastSnapshot() const
+{
+    return previous;
+}
+
+uint64_t InputDispatcher::getDispatchedEventsAmount() const
+{
+    return dispatchedEvents;
+}
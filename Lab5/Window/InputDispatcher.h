@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// DirectInput keyboard scan codes take the first keys, the mouse buttons follow them
+#define INPUT_KEYBOARD_KEYS 256u
+#define INPUT_KEY_WORDS 5u
+#define INPUT_KEYS_AMOUNT (INPUT_KEY_WORDS * 64u)
+
+enum InputMouseButton
+{
+    INPUT_MOUSE_LEFT = INPUT_KEYBOARD_KEYS,
+    INPUT_MOUSE_RIGHT,
+    INPUT_MOUSE_MIDDLE
+};
+
+enum WindowKeyAction
+{
+    // The frame the key was released
+    KEY_UP = 0,
+    // Every frame the key is held
+    KEY_DOWN = 1,
+    // The frame the key went down
+    KEY_PRESSED = 2
+};
+
+struct WindowKey
+{
+    uint32_t key;
+    WindowKeyAction action;
+};
+
+class IWindowKeyCallback
+{
+public:
+    /*
+     * Every event of one frame for the keys the callback subscribed to, ordered by key
+     */
+    virtual void keyEvents(const WindowKey* pKeys, uint32_t keysAmount) = 0;
+    /*
+     * Read once when the callback is added
+     */
+    virtual WindowKey* getKeys(uint32_t* pKeysAmountOut) = 0;
+};
+
+class IWindowMouseCallback
+{
+public:
+    /*
+     * Once per frame the cursor moved, client area coordinates
+     */
+    virtual void mouseMove(int32_t x, int32_t y) = 0;
+};
+
+/*
+ * Keys held and cursor position at one moment, one bit per key
+ */
+struct InputSnapshot
+{
+    uint64_t keys[INPUT_KEY_WORDS] = {};
+    int32_t mouseX = 0;
+    int32_t mouseY = 0;
+
+    void setKey(uint32_t key, bool down)
+    {
+        uint64_t bit = 1ull << (key & 63u);
+        keys[key / 64u] = down ? keys[key / 64u] | bit : keys[key / 64u] & ~bit;
+    }
+
+    bool isDown(uint32_t key) const
+    {
+        return (keys[key / 64u] >> (key & 63u)) & 1u;
+    }
+};
+
+/*
+ * Turns one snapshot per frame into key events. The snapshot is diffed with the one before, only keys somebody
+ * subscribed to are looked at and every callback gets the events of the frame in a single call. No platform code, the
+ * window fills the snapshots.
+ */
+class InputDispatcher
+{
+public:
+    InputDispatcher() = default;
+    InputDispatcher(const InputDispatcher&) = delete;
+    InputDispatcher& operator=(const InputDispatcher&) = delete;
+
+private:
+    struct Subscription
+    {
+        uint32_t key;
+        WindowKeyAction action;
+        uint32_t callbackIndex;
+    };
+
+    std::vector<IWindowKeyCallback*> keyCallbacks;
+    std::vector<IWindowMouseCallback*> mouseCallbacks;
+    // Sorted by key, the subscriptions of key k are [firstSubscriptions[k], firstSubscriptions[k + 1])
+    std::vector<Subscription> subscriptions;
+    uint32_t firstSubscriptions[INPUT_KEYS_AMOUNT + 1] = {};
+    // Keys with a KEY_UP or KEY_PRESSED subscription and keys with a KEY_DOWN one
+    uint64_t edgeKeys[INPUT_KEY_WORDS] = {};
+    uint64_t heldKeys[INPUT_KEY_WORDS] = {};
+    std::vector<std::vector<WindowKey>> batches;
+    InputSnapshot previous;
+    uint64_t dispatchedEvents = 0;
+
+public:
+    void addKeyCallback(IWindowKeyCallback* keyCallback);
+    void addMouseCallback(IWindowMouseCallback* mouseCallback);
+    /*
+     * Calls the callbacks with the changes since the previous snapshot
+     */
+    void dispatch(const InputSnapshot& snapshot);
+    /*
+     * The snapshot of the last dispatch
+     */
+    const InputSnapshot& getLastSnapshot() const;
+    uint64_t getDispatchedEventsAmount() const;
+};
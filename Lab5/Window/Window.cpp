@@ -100,6 +100,14 @@ void Window::pollEvents() {
 	}
 }
 
+void Window::waitEvents(uint32_t timeoutMs) {
+	MsgWaitForMultipleObjectsEx(0, NULL, timeoutMs, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
+void Window::wake() {
+	PostMessage(windowHandle, WM_NULL, 0, 0);
+}
+
 void Window::addResizeCallback(void(*resizeCallback)(uint32_t, uint32_t)) {
 	resizeCallbacks.push_back(resizeCallback);
 }
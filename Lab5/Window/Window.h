@@ -24,6 +24,14 @@ private:
 	bool windowReady = false;
 public:
 	void pollEvents();
+	/*
+	 * Sleeps until a message arrives, wake is called or timeoutMs passes, the messages are left for pollEvents
+	 */
+	void waitEvents(uint32_t timeoutMs);
+	/*
+	 * Any thread, ends a waitEvents
+	 */
+	void wake();
 	void addResizeCallback(void(*resizeCallback)(uint32_t, uint32_t));
 	bool isNeedToClose();
 	HWND getWindowHandle();
@@ -2,38 +2,15 @@
 
 #include <Windows.h>
 #include <cstdint>
-#include <vector>
 #include <windowsx.h>
 #include <dinput.h>
 #include <stdexcept>
+#include "InputDispatcher.h"
 
-enum WindowKeyAction
-{
-    KEY_UP = 0,
-    KEY_DOWN = 1
-};
-
-struct WindowKey
-{
-    uint32_t key;
-    WindowKeyAction action;
-};
-
-
-class IWindowKeyCallback
-{
-public:
-    virtual void keyEvent(WindowKey key) = 0;
-    virtual WindowKey* getKeys(uint32_t* pKeysAmountOut) = 0;
-};
-
-class IWindowMouseCallback
-{
-public:
-    virtual void mouseMove(uint32_t x, uint32_t y) = 0;
-    virtual void mouseKey(uint32_t key) = 0;
-};
-
+/*
+ * Keeps the input snapshot of the window current: mouse messages update it as they arrive, the keyboard is read from
+ * DirectInput once per update. A button pressed and released between two updates is not seen.
+ */
 class WindowInputSystem
 {
     friend class Window;
@@ -63,61 +40,60 @@ public:
     }
 
 private:
-    std::vector<IWindowKeyCallback*> keyCallbacks;
-    std::vector<IWindowMouseCallback*> mouseCallbacks;
     IDirectInput8* directInputInstance;
     IDirectInputDevice8* keyboard;
-    char keyboardState[256];
+    char keyboardState[INPUT_KEYBOARD_KEYS];
+    InputSnapshot snapshot;
+    InputDispatcher dispatcher;
 
 public:
     void addKeyCallback(IWindowKeyCallback* keyCallback)
     {
-        keyCallbacks.push_back(keyCallback);
+        dispatcher.addKeyCallback(keyCallback);
     }
 
     void addMouseCallback(IWindowMouseCallback* mouseCallback)
     {
-        mouseCallbacks.push_back(mouseCallback);
+        dispatcher.addMouseCallback(mouseCallback);
+    }
+
+    /*
+     * Once per frame on the thread that handles the window messages, calls the callbacks with what changed
+     */
+    void update()
+    {
+        readKeyboard();
+        dispatcher.dispatch(snapshot);
     }
 
 private:
     void handlePollEvents(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
     {
-        VK_ESCAPE;
         switch (msg)
         {
         case WM_MOUSEMOVE:
-            checkMovementCallbacks(GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam));
+            snapshot.mouseX = GET_X_LPARAM(lparam);
+            snapshot.mouseY = GET_Y_LPARAM(lparam);
+            break;
+        case WM_LBUTTONDOWN:
+        case WM_LBUTTONUP:
+            snapshot.setKey(INPUT_MOUSE_LEFT, msg == WM_LBUTTONDOWN);
+            break;
+        case WM_RBUTTONDOWN:
+        case WM_RBUTTONUP:
+            snapshot.setKey(INPUT_MOUSE_RIGHT, msg == WM_RBUTTONDOWN);
+            break;
+        case WM_MBUTTONDOWN:
+        case WM_MBUTTONUP:
+            snapshot.setKey(INPUT_MOUSE_MIDDLE, msg == WM_MBUTTONDOWN);
             break;
         default:
-            if (msg >= 0x0201 && msg <= 0x0209)
-            {
-                checkMouseKeyCallbacks(msg);
-            }
             break;
         }
-        checkKeyCallbacks();
-    }
-
-    void checkMovementCallbacks(uint32_t x, uint32_t y)
-    {
-        for (auto& el : mouseCallbacks)
-        {
-            el->mouseMove(x, y);
-        }
-    }
-
-    void checkMouseKeyCallbacks(uint32_t msg)
-    {
-        for (auto& el : mouseCallbacks)
-        {
-            el->mouseKey(msg);
-        }
     }
 
-    void checkKeyCallbacks()
+    void readKeyboard()
     {
-        uint32_t keysAmount = 0;
         if (FAILED(keyboard->GetDeviceState(sizeof(keyboardState), (LPVOID)&keyboardState)))
         {
             keyboard->Acquire();
@@ -126,18 +102,15 @@ private:
                 throw std::runtime_error("Failed to read keyboard keys");
             }
         }
-        for (auto& el : keyCallbacks)
+        for (uint32_t word = 0; word < INPUT_KEYBOARD_KEYS / 64u; word++)
         {
-            auto keys = el->getKeys(&keysAmount);
-            WindowKey key;
-            for (uint32_t i = 0; i < keysAmount; i++)
+            uint64_t keys = 0;
+            for (uint32_t bit = 0; bit < 64; bit++)
             {
-                key = keys[i];
-                if (keyboardState[key.key])
-                {
-                    el->keyEvent(key);
-                }
+                // DirectInput sets the high bit of held keys
+                keys |= (uint64_t)((keyboardState[word * 64u + bit] & 0x80) != 0) << bit;
             }
+            snapshot.keys[word] = keys;
         }
     }
 };